@@ -0,0 +1,125 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include "Fusion.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define SAMPLE_RATE (100) // sample rate of sensor_data.csv
+
+#define REPETITIONS (100) // number of times the data is replayed for each path
+
+typedef struct {
+    FusionVector *gyroscope;
+    FusionVector *accelerometer;
+    float *timestamps;
+    size_t numberOfSamples;
+} SensorData;
+
+static int LoadSensorData(const char *const path, SensorData *const data) {
+    FILE *const file = fopen(path, "r");
+    if (file == NULL) {
+        return -1;
+    }
+
+    size_t capacity = 1024;
+    data->gyroscope = malloc(capacity * sizeof(FusionVector));
+    data->accelerometer = malloc(capacity * sizeof(FusionVector));
+    data->timestamps = malloc(capacity * sizeof(float));
+    data->numberOfSamples = 0;
+
+    char line[512];
+    fgets(line, sizeof(line), file); // skip header
+    while (fgets(line, sizeof(line), file) != NULL) {
+        float t, gx, gy, gz, ax, ay, az;
+        if (sscanf(line, "%f,%f,%f,%f,%f,%f,%f", &t, &gx, &gy, &gz, &ax, &ay, &az) != 7) {
+            continue;
+        }
+        if (data->numberOfSamples == capacity) {
+            capacity *= 2;
+            data->gyroscope = realloc(data->gyroscope, capacity * sizeof(FusionVector));
+            data->accelerometer = realloc(data->accelerometer, capacity * sizeof(FusionVector));
+            data->timestamps = realloc(data->timestamps, capacity * sizeof(float));
+        }
+        const size_t index = data->numberOfSamples++;
+        data->gyroscope[index] = (FusionVector) {.axis = {gx, gy, gz}};
+        data->accelerometer[index] = (FusionVector) {.axis = {ax, ay, az}};
+        data->timestamps[index] = t;
+    }
+    fclose(file);
+    return data->numberOfSamples == 0 ? -1 : 0;
+}
+
+static void Initialise(FusionAhrs *const ahrs, FusionOffset *const offset) {
+    FusionOffsetInitialise(offset, SAMPLE_RATE);
+    FusionAhrsInitialise(ahrs);
+    const FusionAhrsSettings settings = {
+            .convention = FusionConventionNwu,
+            .gain = 0.5f,
+            .gyroscopeRange = 2000.0f,
+            .accelerationRejection = 10.0f,
+            .magneticRejection = 0.0f,
+            .recoveryTriggerPeriod = 5 * SAMPLE_RATE,
+    };
+    FusionAhrsSetSettings(ahrs, &settings);
+}
+
+static double Now(void) {
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double) time.tv_sec * 1e9 + (double) time.tv_nsec;
+}
+
+int main(int argc, char *argv[]) {
+    const char *const path = argc > 1 ? argv[1] : "../../Python/sensor_data.csv";
+
+    SensorData data;
+    if (LoadSensorData(path, &data) != 0) {
+        printf("Unable to load %s\n", path);
+        return 1;
+    }
+
+    FusionAhrs ahrs;
+    FusionOffset offset;
+    volatile float sink = 0.0f; // prevent results being optimised away
+
+    // Single-sample path: offset, update and Euler conversion for every sample
+    FusionEuler singleEuler = {0};
+    double start = Now();
+    for (int repetition = 0; repetition < REPETITIONS; repetition++) {
+        Initialise(&ahrs, &offset);
+        float previousTimestamp = data.timestamps[0];
+        for (size_t index = 0; index < data.numberOfSamples; index++) {
+            const FusionVector gyroscope = FusionOffsetUpdate(&offset, data.gyroscope[index]);
+            const float deltaTime = data.timestamps[index] - previousTimestamp;
+            previousTimestamp = data.timestamps[index];
+            FusionAhrsUpdateNoMagnetometer(&ahrs, gyroscope, data.accelerometer[index], deltaTime);
+            singleEuler = FusionQuaternionToEuler(FusionAhrsGetQuaternion(&ahrs));
+            sink += singleEuler.angle.yaw;
+        }
+    }
+    const double singleTime = (Now() - start) / ((double) REPETITIONS * (double) data.numberOfSamples);
+
+    // Batch path: whole array in one call, Euler conversion once at the end
+    FusionEuler batchEuler = {0};
+    start = Now();
+    for (int repetition = 0; repetition < REPETITIONS; repetition++) {
+        Initialise(&ahrs, &offset);
+        float previousTimestamp = data.timestamps[0];
+        FusionAhrsUpdateNoMagnetometerBatch(&ahrs, &offset, data.gyroscope, data.accelerometer, data.timestamps, data.numberOfSamples, &previousTimestamp);
+        batchEuler = FusionQuaternionToEuler(FusionAhrsGetQuaternion(&ahrs));
+        sink += batchEuler.angle.yaw;
+    }
+    const double batchTime = (Now() - start) / ((double) REPETITIONS * (double) data.numberOfSamples);
+
+    printf("Samples: %zu x %d repetitions\n", data.numberOfSamples, REPETITIONS);
+    printf("Single-sample: %6.1f ns/sample\n", singleTime);
+    printf("Batch:         %6.1f ns/sample (%.2fx)\n", batchTime, singleTime / batchTime);
+    printf("Final Euler single: Roll %0.3f, Pitch %0.3f, Yaw %0.3f\n", singleEuler.angle.roll, singleEuler.angle.pitch, singleEuler.angle.yaw);
+    printf("Final Euler batch:  Roll %0.3f, Pitch %0.3f, Yaw %0.3f\n", batchEuler.angle.roll, batchEuler.angle.pitch, batchEuler.angle.yaw);
+
+    free(data.gyroscope);
+    free(data.accelerometer);
+    free(data.timestamps);
+    return 0;
+}
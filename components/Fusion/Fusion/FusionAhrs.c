@@ -36,6 +36,8 @@ static inline FusionVector Feedback(const FusionVector sensor, const FusionVecto
 
 static inline int Clamp(const int value, const int min, const int max);
 
+static inline void Update(FusionAhrs *const ahrs, const FusionVector gyroscope, const FusionVector accelerometer, const FusionVector magnetometer, const float deltaTime);
+
 //------------------------------------------------------------------------------
 // Functions
 
@@ -111,6 +113,19 @@ void FusionAhrsSetSettings(FusionAhrs *const ahrs, const FusionAhrsSettings *con
  * @param deltaTime Delta time in seconds.
  */
 void FusionAhrsUpdate(FusionAhrs *const ahrs, const FusionVector gyroscope, const FusionVector accelerometer, const FusionVector magnetometer, const float deltaTime) {
+    Update(ahrs, gyroscope, accelerometer, magnetometer, deltaTime);
+}
+
+/**
+ * @brief Updates the AHRS algorithm. Inlined into both the single-sample and
+ * batch functions so that the batch loop can be optimised as a whole.
+ * @param ahrs AHRS algorithm structure.
+ * @param gyroscope Gyroscope measurement in degrees per second.
+ * @param accelerometer Accelerometer measurement in g.
+ * @param magnetometer Magnetometer measurement in arbitrary units.
+ * @param deltaTime Delta time in seconds.
+ */
+static inline void Update(FusionAhrs *const ahrs, const FusionVector gyroscope, const FusionVector accelerometer, const FusionVector magnetometer, const float deltaTime) {
 #define Q ahrs->quaternion.element
 
     // Store accelerometer
@@ -332,6 +347,59 @@ void FusionAhrsUpdateNoMagnetometer(FusionAhrs *const ahrs, const FusionVector g
     }
 }
 
+/**
+ * @brief Updates the AHRS algorithm using an array of gyroscope and
+ * accelerometer measurements only. This is equivalent to calling
+ * FusionOffsetUpdate and FusionAhrsUpdateNoMagnetometer for each sample but
+ * the algorithm state is held in a local copy for the duration of the loop.
+ * The orientation is only converted to other representations (e.g. Euler
+ * angles) when requested by the application after the call.
+ * @param ahrs AHRS algorithm structure.
+ * @param offset Gyroscope offset algorithm structure. May be NULL if offset
+ * correction is not required.
+ * @param gyroscope Gyroscope measurements in degrees per second.
+ * @param accelerometer Accelerometer measurements in g.
+ * @param timestamps Timestamps in seconds.
+ * @param numberOfSamples Number of samples.
+ * @param previousTimestamp Timestamp of the sample preceding the array, used
+ * to calculate the delta time of the first sample. Updated to the timestamp of
+ * the last sample.
+ */
+void FusionAhrsUpdateNoMagnetometerBatch(FusionAhrs *const ahrs, FusionOffset *const offset, const FusionVector *const gyroscope, const FusionVector *const accelerometer, const float *const timestamps, const size_t numberOfSamples, float *const previousTimestamp) {
+    if (numberOfSamples == 0) {
+        return;
+    }
+
+    // Work on local copies so that the state can be held in registers
+    FusionAhrs localAhrs = *ahrs;
+    FusionOffset localOffset;
+    if (offset != NULL) {
+        localOffset = *offset;
+    }
+    float previous = *previousTimestamp;
+
+    for (size_t index = 0; index < numberOfSamples; index++) {
+        const float deltaTime = timestamps[index] - previous;
+        previous = timestamps[index];
+
+        const FusionVector correctedGyroscope = offset == NULL ? gyroscope[index] : FusionOffsetUpdate(&localOffset, gyroscope[index]);
+
+        // Update AHRS algorithm
+        Update(&localAhrs, correctedGyroscope, accelerometer[index], FUSION_VECTOR_ZERO, deltaTime);
+
+        // Zero heading during initialisation
+        if (localAhrs.initialising) {
+            FusionAhrsSetHeading(&localAhrs, 0.0f);
+        }
+    }
+
+    *ahrs = localAhrs;
+    if (offset != NULL) {
+        *offset = localOffset;
+    }
+    *previousTimestamp = previous;
+}
+
 /**
  * @brief Updates the AHRS algorithm using the gyroscope, accelerometer, and
  * heading measurements.
@@ -13,7 +13,9 @@
 
 #include "FusionConvention.h"
 #include "FusionMath.h"
+#include "FusionOffset.h"
 #include <stdbool.h>
+#include <stddef.h>
 
 //------------------------------------------------------------------------------
 // Definitions
@@ -87,6 +89,8 @@ void FusionAhrsUpdate(FusionAhrs *const ahrs, const FusionVector gyroscope, cons
 
 void FusionAhrsUpdateNoMagnetometer(FusionAhrs *const ahrs, const FusionVector gyroscope, const FusionVector accelerometer, const float deltaTime);
 
+void FusionAhrsUpdateNoMagnetometerBatch(FusionAhrs *const ahrs, FusionOffset *const offset, const FusionVector *const gyroscope, const FusionVector *const accelerometer, const float *const timestamps, const size_t numberOfSamples, float *const previousTimestamp);
+
 void FusionAhrsUpdateExternalHeading(FusionAhrs *const ahrs, const FusionVector gyroscope, const FusionVector accelerometer, const float heading, const float deltaTime);
 
 FusionQuaternion FusionAhrsGetQuaternion(const FusionAhrs *const ahrs);
@@ -5,6 +5,7 @@
 #include "Flags.h"
 #include "Helpers.h"
 #include "InternalStates.h"
+#include "Offset.h"
 #include <Python.h>
 #include "Quaternion.h"
 #include "Settings.h"
@@ -200,6 +201,134 @@ static PyObject *ahrs_update_external_heading(Ahrs *self, PyObject *args) {
     return Py_None;
 }
 
+static PyObject *ahrs_update_batch_arrays(Ahrs *self, PyObject *gyroscope_object, PyObject *accelerometer_object, PyObject *magnetometer_object, PyObject *timestamp_object, Offset *offset) {
+    npy_intp rows = -1;
+    const char *error = NULL;
+    PyArrayObject *magnetometer_array = NULL;
+    PyObject *result = NULL;
+
+    PyArrayObject *const gyroscope_array = parse_batch_array(gyroscope_object, NPY_FLOAT, 3, &rows, &error);
+    PyArrayObject *const accelerometer_array = gyroscope_array == NULL ? NULL : parse_batch_array(accelerometer_object, NPY_FLOAT, 3, &rows, &error);
+    if ((accelerometer_array != NULL) && (magnetometer_object != NULL)) {
+        magnetometer_array = parse_batch_array(magnetometer_object, NPY_FLOAT, 3, &rows, &error);
+    }
+    PyArrayObject *const timestamp_array = (error != NULL) ? NULL : parse_batch_array(timestamp_object, NPY_DOUBLE, 0, &rows, &error);
+    if (error != NULL) {
+        PyErr_SetString(PyExc_TypeError, error);
+        goto cleanup;
+    }
+
+    const npy_intp quaternion_dims[] = {rows, 4};
+    const npy_intp euler_dims[] = {rows, 3};
+    const npy_intp internal_states_dims[] = {rows, 6};
+    const npy_intp flags_dims[] = {rows, 4};
+    PyArrayObject *const quaternion_array = (PyArrayObject *) PyArray_SimpleNew(2, quaternion_dims, NPY_FLOAT);
+    PyArrayObject *const euler_array = (PyArrayObject *) PyArray_SimpleNew(2, euler_dims, NPY_FLOAT);
+    PyArrayObject *const internal_states_array = (PyArrayObject *) PyArray_SimpleNew(2, internal_states_dims, NPY_FLOAT);
+    PyArrayObject *const flags_array = (PyArrayObject *) PyArray_SimpleNew(2, flags_dims, NPY_BOOL);
+    if ((quaternion_array == NULL) || (euler_array == NULL) || (internal_states_array == NULL) || (flags_array == NULL)) {
+        Py_XDECREF(quaternion_array);
+        Py_XDECREF(euler_array);
+        Py_XDECREF(internal_states_array);
+        Py_XDECREF(flags_array);
+        goto cleanup;
+    }
+
+    const FusionVector *const gyroscope = (const FusionVector *) PyArray_DATA(gyroscope_array);
+    const FusionVector *const accelerometer = (const FusionVector *) PyArray_DATA(accelerometer_array);
+    const FusionVector *const magnetometer = magnetometer_array == NULL ? NULL : (const FusionVector *) PyArray_DATA(magnetometer_array);
+    const double *const timestamp = (const double *) PyArray_DATA(timestamp_array);
+    FusionQuaternion *const quaternion = (FusionQuaternion *) PyArray_DATA(quaternion_array);
+    FusionEuler *const euler = (FusionEuler *) PyArray_DATA(euler_array);
+    float *const internal_states = (float *) PyArray_DATA(internal_states_array);
+    npy_bool *const flags = (npy_bool *) PyArray_DATA(flags_array);
+
+    // Process all samples without the GIL using local copies of the algorithm state
+    FusionAhrs ahrs = self->ahrs;
+    FusionOffset fusion_offset;
+    if (offset != NULL) {
+        fusion_offset = offset->offset;
+    }
+
+    Py_BEGIN_ALLOW_THREADS
+    for (npy_intp index = 0; index < rows; index++) {
+        const float delta_time = index == 0 ? 0.0f : (float) (timestamp[index] - timestamp[index - 1]);
+
+        const FusionVector gyroscope_vector = offset == NULL ? gyroscope[index] : FusionOffsetUpdate(&fusion_offset, gyroscope[index]);
+
+        if (magnetometer == NULL) {
+            FusionAhrsUpdateNoMagnetometer(&ahrs, gyroscope_vector, accelerometer[index], delta_time);
+        } else {
+            FusionAhrsUpdate(&ahrs, gyroscope_vector, accelerometer[index], magnetometer[index], delta_time);
+        }
+
+        quaternion[index] = FusionAhrsGetQuaternion(&ahrs);
+        euler[index] = FusionQuaternionToEuler(quaternion[index]);
+
+        const FusionAhrsInternalStates ahrs_internal_states = FusionAhrsGetInternalStates(&ahrs);
+        float *const internal_states_row = &internal_states[6 * index];
+        internal_states_row[0] = ahrs_internal_states.accelerationError;
+        internal_states_row[1] = ahrs_internal_states.accelerometerIgnored;
+        internal_states_row[2] = ahrs_internal_states.accelerationRecoveryTrigger;
+        internal_states_row[3] = ahrs_internal_states.magneticError;
+        internal_states_row[4] = ahrs_internal_states.magnetometerIgnored;
+        internal_states_row[5] = ahrs_internal_states.magneticRecoveryTrigger;
+
+        const FusionAhrsFlags ahrs_flags = FusionAhrsGetFlags(&ahrs);
+        npy_bool *const flags_row = &flags[4 * index];
+        flags_row[0] = ahrs_flags.initialising;
+        flags_row[1] = ahrs_flags.angularRateRecovery;
+        flags_row[2] = ahrs_flags.accelerationRecovery;
+        flags_row[3] = ahrs_flags.magneticRecovery;
+    }
+    Py_END_ALLOW_THREADS
+
+    self->ahrs = ahrs;
+    if (offset != NULL) {
+        offset->offset = fusion_offset;
+    }
+
+    result = Py_BuildValue("(NNNN)", quaternion_array, euler_array, internal_states_array, flags_array);
+
+cleanup:
+    Py_XDECREF(gyroscope_array);
+    Py_XDECREF(accelerometer_array);
+    Py_XDECREF(magnetometer_array);
+    Py_XDECREF(timestamp_array);
+    return result;
+}
+
+static PyObject *ahrs_update_batch(Ahrs *self, PyObject *args) {
+    PyObject *gyroscope_object;
+    PyObject *accelerometer_object;
+    PyObject *magnetometer_object;
+    PyObject *timestamp_object;
+    Offset *offset = NULL;
+
+    const char *error = PARSE_TUPLE(args, "OOOO|O!", &gyroscope_object, &accelerometer_object, &magnetometer_object, &timestamp_object, &offset_object, &offset);
+    if (error != NULL) {
+        PyErr_SetString(PyExc_TypeError, error);
+        return NULL;
+    }
+
+    return ahrs_update_batch_arrays(self, gyroscope_object, accelerometer_object, magnetometer_object, timestamp_object, offset);
+}
+
+static PyObject *ahrs_update_no_magnetometer_batch(Ahrs *self, PyObject *args) {
+    PyObject *gyroscope_object;
+    PyObject *accelerometer_object;
+    PyObject *timestamp_object;
+    Offset *offset = NULL;
+
+    const char *error = PARSE_TUPLE(args, "OOO|O!", &gyroscope_object, &accelerometer_object, &timestamp_object, &offset_object, &offset);
+    if (error != NULL) {
+        PyErr_SetString(PyExc_TypeError, error);
+        return NULL;
+    }
+
+    return ahrs_update_batch_arrays(self, gyroscope_object, accelerometer_object, NULL, timestamp_object, offset);
+}
+
 static int ahrs_set_heading(Ahrs *self, PyObject *value, void *closure) {
     const float heading = (float) PyFloat_AsDouble(value);
 
@@ -228,6 +357,8 @@ static PyMethodDef ahrs_methods[] = {
         {"update",                  (PyCFunction) ahrs_update,                  METH_VARARGS, ""},
         {"update_no_magnetometer",  (PyCFunction) ahrs_update_no_magnetometer,  METH_VARARGS, ""},
         {"update_external_heading", (PyCFunction) ahrs_update_external_heading, METH_VARARGS, ""},
+        {"update_batch",                 (PyCFunction) ahrs_update_batch,                 METH_VARARGS, ""},
+        {"update_no_magnetometer_batch", (PyCFunction) ahrs_update_no_magnetometer_batch, METH_VARARGS, ""},
         {NULL} /* sentinel */
 };
 
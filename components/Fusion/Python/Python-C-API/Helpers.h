@@ -36,7 +36,7 @@ static char *const create_parse_tuple_error_string(const char *format) {
 
         do {
             format++;
-        } while (*format == '!');
+        } while ((*format == '!') || (*format == '|'));
 
         if (*format != '\0') {
             concatenate(string, sizeof(string), ", ");
@@ -76,6 +76,32 @@ static char *const parse_array(float *const destination, const PyArrayObject *co
     return NULL;
 }
 
+static PyArrayObject *const parse_batch_array(PyObject *const object, const int type, const npy_intp columns, npy_intp *const rows, const char **const error) {
+    PyArrayObject *const array = (PyArrayObject *) PyArray_FROMANY(object, type, columns == 0 ? 1 : 2, columns == 0 ? 1 : 2, NPY_ARRAY_IN_ARRAY | NPY_ARRAY_FORCECAST);
+    if (array == NULL) {
+        PyErr_Clear();
+        *error = columns == 0 ? "Array dimensions is not 1" : "Array dimensions is not 2";
+        return NULL;
+    }
+
+    if ((columns != 0) && (PyArray_DIM(array, 1) != columns)) {
+        static char string[48];
+        snprintf(string, sizeof(string), "Array shape is not (n, %u)", (unsigned int) columns);
+        *error = string;
+        Py_DECREF(array);
+        return NULL;
+    }
+
+    if ((*rows >= 0) && (PyArray_DIM(array, 0) != *rows)) {
+        *error = "Array lengths are not equal";
+        Py_DECREF(array);
+        return NULL;
+    }
+
+    *rows = PyArray_DIM(array, 0);
+    return array;
+}
+
 static PyObject *const build_bool(const bool value) {
     return Py_BuildValue("O", value ? Py_True : Py_False);
 }
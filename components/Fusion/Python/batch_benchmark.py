@@ -0,0 +1,84 @@
+import imufusion
+import numpy as np
+import time
+
+# Import sensor data
+data = np.genfromtxt("sensor_data.csv", delimiter=",", skip_header=1)
+
+sample_rate = 100  # 100 Hz
+
+timestamp = data[:, 0]
+gyroscope = data[:, 1:4]
+accelerometer = data[:, 4:7]
+magnetometer = data[:, 7:10]
+
+
+def create_algorithms():
+    offset = imufusion.Offset(sample_rate)
+    ahrs = imufusion.Ahrs()
+
+    ahrs.settings = imufusion.Settings(
+        imufusion.CONVENTION_NWU,  # convention
+        0.5,  # gain
+        2000,  # gyroscope range
+        10,  # acceleration rejection
+        10,  # magnetic rejection
+        5 * sample_rate,  # recovery trigger period = 5 seconds
+    )
+    return offset, ahrs
+
+
+def per_sample():
+    offset, ahrs = create_algorithms()
+
+    delta_time = np.diff(timestamp, prepend=timestamp[0])
+
+    euler = np.empty((len(timestamp), 3))
+    internal_states = np.empty((len(timestamp), 6))
+
+    for index in range(len(timestamp)):
+        corrected = offset.update(gyroscope[index])
+
+        ahrs.update(corrected, accelerometer[index], magnetometer[index], delta_time[index])
+
+        euler[index] = ahrs.quaternion.to_euler()
+
+        ahrs_internal_states = ahrs.internal_states
+        internal_states[index] = np.array(
+            [
+                ahrs_internal_states.acceleration_error,
+                ahrs_internal_states.accelerometer_ignored,
+                ahrs_internal_states.acceleration_recovery_trigger,
+                ahrs_internal_states.magnetic_error,
+                ahrs_internal_states.magnetometer_ignored,
+                ahrs_internal_states.magnetic_recovery_trigger,
+            ]
+        )
+    return euler, internal_states
+
+
+def batch():
+    offset, ahrs = create_algorithms()
+
+    _, euler, internal_states, _ = ahrs.update_batch(gyroscope, accelerometer, magnetometer, timestamp, offset)
+    return euler, internal_states
+
+
+def benchmark(function, repetitions):
+    best = float("inf")
+    for _ in range(repetitions):
+        start = time.perf_counter()
+        result = function()
+        best = min(best, time.perf_counter() - start)
+    return best, result
+
+
+per_sample_time, (per_sample_euler, per_sample_internal_states) = benchmark(per_sample, 3)
+batch_time, (batch_euler, batch_internal_states) = benchmark(batch, 20)
+
+samples = len(timestamp)
+print(f"Samples:    {samples}")
+print(f"Per-sample: {per_sample_time * 1e3:8.2f} ms ({per_sample_time / samples * 1e9:8.1f} ns/sample)")
+print(f"Batch:      {batch_time * 1e3:8.2f} ms ({batch_time / samples * 1e9:8.1f} ns/sample, {per_sample_time / batch_time:.0f}x)")
+print(f"Max Euler difference: {np.max(np.abs(per_sample_euler - batch_euler)):.6f} degrees")
+print(f"Max internal state difference: {np.max(np.abs(per_sample_internal_states - batch_internal_states)):.6f}")
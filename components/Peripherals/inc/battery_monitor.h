@@ -12,14 +12,15 @@
 extern "C" {
 #endif
 
-#include "driver/adc.h"
 #include "esp_err.h"
+#include "joystick_adc.h"
 
 // ========================================
 // 硬件配置
 // ========================================
-#define BATTERY_ADC_CHANNEL ADC1_CHANNEL_7 // GPIO8
-#define BATTERY_ADC_ATTEN ADC_ATTEN_DB_12  // 0-3.3V (使用新的衰减值)
+// ADC1 由摇杆驱动以连续模式独占，电池通道在其 DMA 序列中采样
+#define BATTERY_ADC_CHANNEL JOYSTICK_ADC_BATTERY_CHANNEL // GPIO8
+#define BATTERY_ADC_ATTEN JOYSTICK_ADC_ATTEN              // 0-3.3V
 
 // 电池电压分压比例 (如果使用分压电路)
 #define BATTERY_VOLTAGE_DIVIDER_RATIO 2.0f // 根据实际分压电路调整
@@ -0,0 +1,108 @@
+/**
+ * @file boot_graph.h
+ * @brief 启动依赖图 - 各组件声明依赖，按就绪事件在两个核上并行初始化，并记录启动耗时
+ *
+ * 每个步骤是一个初始化函数 (或一个外部事件，如 "网络已连接")，依赖用逗号分隔的步骤名声明。
+ * boot_graph_start 为每个核创建一个工作任务，依赖全部成功的步骤立即被空闲的工作任务取走执行；
+ * 依赖失败的步骤标记为跳过，其后继同样跳过。所有函数步骤结束后工作任务退出并打印耗时报告。
+ *
+ * 图外的任务用 boot_graph_wait 等待某一步完成 (代替固定延时)，外部事件用 boot_graph_signal 置就绪。
+ * 步骤函数运行在工作任务中，不应长时间阻塞；需要常驻的服务应在步骤中创建自己的任务。
+ */
+
+#ifndef BOOT_GRAPH_H
+#define BOOT_GRAPH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#define BOOT_GRAPH_MAX_STEPS 24 // 受事件组可用位数限制
+#define BOOT_CORE_ANY (-1)
+
+typedef esp_err_t (*boot_step_fn_t)(void* arg);
+
+typedef struct {
+    const char* name; // 步骤名，需为常量字符串
+    boot_step_fn_t fn; // NULL 表示外部事件，由 boot_graph_signal 置就绪
+    void* arg;
+    const char* deps; // 依赖的步骤名，逗号分隔，NULL 或 "" 表示无依赖
+    int8_t core;      // 0/1 绑定到该核的工作任务，BOOT_CORE_ANY 任一核
+} boot_step_t;
+
+typedef enum {
+    BOOT_STEP_PENDING = 0,
+    BOOT_STEP_RUNNING,
+    BOOT_STEP_OK,
+    BOOT_STEP_FAILED,
+    BOOT_STEP_SKIPPED, // 依赖失败
+} boot_step_state_t;
+
+/**
+ * @brief 单个步骤的执行记录 (时间均为上电后的微秒数)
+ */
+typedef struct {
+    const char* name;
+    boot_step_state_t state;
+    bool is_event;
+    int8_t core;      // 实际运行的核，事件为 -1
+    esp_err_t err;
+    int64_t ready_us; // 依赖全部满足的时刻
+    int64_t start_us;
+    int64_t end_us;   // 完成 (或事件置位) 的时刻
+} boot_step_record_t;
+
+typedef void (*boot_progress_cb_t)(uint32_t done, uint32_t total);
+
+/**
+ * @brief 添加步骤，须在 boot_graph_start 之前调用
+ * @return ESP_ERR_NO_MEM 超过 BOOT_GRAPH_MAX_STEPS；ESP_ERR_INVALID_STATE 已启动或重名
+ */
+esp_err_t boot_graph_add(const boot_step_t* steps, size_t count);
+
+/**
+ * @brief 每个函数步骤结束后回调，done 计入因依赖失败而跳过的步骤 (在工作任务中持锁串行调用，应尽快返回)
+ */
+void boot_graph_set_progress_cb(boot_progress_cb_t cb);
+
+/**
+ * @brief 解析依赖并启动工作任务，立即返回
+ * @param stack_size 工作任务栈大小，需满足最深的步骤函数
+ * @param priority 工作任务优先级
+ * @return ESP_ERR_NOT_FOUND 依赖了不存在的步骤；ESP_ERR_INVALID_STATE 存在依赖环
+ */
+esp_err_t boot_graph_start(uint32_t stack_size, UBaseType_t priority);
+
+/**
+ * @brief 外部事件就绪，可在任意任务中调用，重复调用无副作用
+ */
+esp_err_t boot_graph_signal(const char* name);
+
+/**
+ * @brief 等待某一步结束
+ * @return 该步成功 (或事件已置位) 返回 true；失败、跳过、超时或不存在返回 false
+ */
+bool boot_graph_wait(const char* name, TickType_t ticks_to_wait);
+
+/**
+ * @brief 复制所有步骤的执行记录，按添加顺序
+ * @return 写入个数
+ */
+size_t boot_graph_get_records(boot_step_record_t* out, size_t max);
+
+/**
+ * @brief 打印按开始时间排序的耗时表与关键路径
+ */
+void boot_graph_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BOOT_GRAPH_H
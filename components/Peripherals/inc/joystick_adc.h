@@ -12,44 +12,46 @@
 extern "C" {
 #endif
 
+#include "esp_adc/adc_continuous.h"
 #include "esp_err.h"
-#include "driver/adc.h"
+#include "joystick_filter.h"
 
 // ========================================
 // 摇杆硬件配置
 // ========================================
 // 摇杆1
-#define JOYSTICK1_ADC_X_CHANNEL ADC1_CHANNEL_2 // IO3
-#define JOYSTICK1_ADC_Y_CHANNEL ADC1_CHANNEL_8 // IO9
+#define JOYSTICK1_ADC_X_CHANNEL ADC_CHANNEL_2 // IO3
+#define JOYSTICK1_ADC_Y_CHANNEL ADC_CHANNEL_8 // IO9
+
+// 电池分压通道 (ADC1 由连续模式独占，电池采样也由本驱动的 DMA 完成)
+#define JOYSTICK_ADC_BATTERY_CHANNEL ADC_CHANNEL_7 // IO8
 
 // ADC衰减配置
-#define JOYSTICK_ADC_ATTEN      ADC_ATTEN_DB_11
+#define JOYSTICK_ADC_ATTEN      ADC_ATTEN_DB_12
 
-// ADC低通滤波系数 (0.0 < alpha < 1.0)
+// ========================================
+// 连续采样 (DMA) 配置
+// ========================================
+// 转换序列: X, Y, 电池，总采样率为三个通道之和
+#define JOYSTICK_ADC_SAMPLE_FREQ_HZ 20000
+// 每帧每通道的转换次数 (软件过采样倍数)
+#define JOYSTICK_ADC_OVERSAMPLE 16
+#define JOYSTICK_ADC_PATTERN_NUM 3
+#define JOYSTICK_ADC_FRAME_SIZE                                                                    \
+    (JOYSTICK_ADC_PATTERN_NUM * JOYSTICK_ADC_OVERSAMPLE * SOC_ADC_DIGI_RESULT_BYTES)
+// 帧率约 20000 / 48 ≈ 416Hz
+
+// 帧率下的低通滤波系数 (0.0 < alpha < 1.0)
 // 值越小，平滑效果越好，但延迟越高
-#define JOYSTICK_LOW_PASS_ALPHA 0.2f
+#define JOYSTICK_LOW_PASS_ALPHA 0.25f
+
+// 硬件 IIR 滤波系数 (仅在芯片支持时启用)
+#define JOYSTICK_ADC_HW_IIR_COEFF ADC_DIGI_IIR_FILTER_COEFF_4
 
 // ========================================
 // 数据结构定义
 // ========================================
 
-/**
- * @brief 单个摇杆轴的校准数据
- */
-typedef struct {
-    int min;      // 采集到的最小值
-    int max;      // 采集到的最大值
-    int center;   // 中心点
-} joystick_axis_cal_t;
-
-/**
- * @brief 摇杆的校准数据
- */
-typedef struct {
-    joystick_axis_cal_t joy1_x;
-    joystick_axis_cal_t joy1_y;
-} joystick_cal_data_t;
-
 /**
  * @brief 摇杆最终输出数据
  */
@@ -87,7 +89,8 @@ esp_err_t joystick_adc_init(void);
 esp_err_t joystick_adc_deinit(void);
 
 /**
- * @brief 从两个摇杆读取经过滤波和校准的数据
+ * @brief 读取最近一帧经过滤波和校准的摇杆数据
+ *        数据由 DMA 帧完成回调发布，本函数只做无锁快照拷贝，可在任意任务中高频调用
  *
  * @param[out] data 指向joystick_data_t结构体的指针，用于存储读取的数据
  * @return
@@ -97,6 +100,25 @@ esp_err_t joystick_adc_deinit(void);
  */
 esp_err_t joystick_adc_read(joystick_data_t *data);
 
+/**
+ * @brief 读取最近一帧电池通道的过采样原始值
+ *
+ * @param[out] raw 原始值 (0 ~ 4095)
+ * @return
+ *     - ESP_OK: 成功
+ *     - ESP_ERR_INVALID_ARG: 参数错误
+ *     - ESP_ERR_INVALID_STATE: 驱动未初始化或尚未采到数据
+ */
+esp_err_t joystick_adc_read_battery_raw(int *raw);
+
+/**
+ * @brief 获取已处理的 DMA 帧数与丢帧数
+ *
+ * @param[out] frames 已发布的帧数，可为 NULL
+ * @param[out] dropped 因缺少摇杆轴样本而未发布的帧数，可为 NULL
+ */
+void joystick_adc_get_frame_stats(uint32_t *frames, uint32_t *dropped);
+
 /**
  * @brief 开始摇杆校准
  *        会重置当前的校准数据
@@ -0,0 +1,147 @@
+/**
+ * @file joystick_filter.h
+ * @brief 摇杆定点滤波与归一化
+ *
+ * 只用到 C 标准库，others/py_test_demo/joystick_filter_bench.py 在主机上校验滤波与归一化结果。
+ *
+ * @author Your Name
+ * @date 2024
+ */
+
+#ifndef JOYSTICK_FILTER_H
+#define JOYSTICK_FILTER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// ========================================
+// 滤波参数
+// ========================================
+#define JOYSTICK_FILTER_ADC_MAX 4095   // 12 位 ADC 满量程
+#define JOYSTICK_FILTER_ADC_CENTER 2048
+#define JOYSTICK_FILTER_FULL_SCALE_MV 3300
+#define JOYSTICK_FILTER_DEAD_ZONE 50   // 中心死区范围 (原始值)
+#define JOYSTICK_FILTER_NORM_MAX 100   // 归一化输出范围 -100 ~ 100
+
+#define JOYSTICK_FILTER_ALPHA_SHIFT 15 // 滤波系数为 Q15
+#define JOYSTICK_FILTER_STATE_SHIFT 8  // 滤波状态额外保留 8 位小数，避免小步长被截断
+
+// 将 0.0 ~ 1.0 的浮点系数转换为 Q15 (编译期常量)
+#define JOYSTICK_FILTER_ALPHA_Q15(a) ((uint16_t)((a) * (1 << JOYSTICK_FILTER_ALPHA_SHIFT) + 0.5f))
+
+// ========================================
+// 数据结构定义
+// ========================================
+
+/**
+ * @brief 单个摇杆轴的校准数据
+ */
+typedef struct {
+    int min;    // 采集到的最小值
+    int max;    // 采集到的最大值
+    int center; // 中心点
+} joystick_axis_cal_t;
+
+/**
+ * @brief 摇杆的校准数据
+ */
+typedef struct {
+    joystick_axis_cal_t joy1_x;
+    joystick_axis_cal_t joy1_y;
+} joystick_cal_data_t;
+
+/**
+ * @brief 单通道帧内累加器 (软件过采样)
+ */
+typedef struct {
+    uint32_t sum;
+    uint32_t count;
+} joystick_filter_acc_t;
+
+/**
+ * @brief 一阶定点 IIR 低通滤波器
+ *        y += alpha * (x - y)，alpha 为 Q15，状态为 Q(JOYSTICK_FILTER_STATE_SHIFT)
+ */
+typedef struct {
+    int32_t state;
+    uint16_t alpha_q15;
+} joystick_filter_iir_t;
+
+// ========================================
+// 函数声明
+// ========================================
+
+/**
+ * @brief 清空累加器
+ */
+static inline void joystick_filter_acc_reset(joystick_filter_acc_t* acc) {
+    acc->sum = 0;
+    acc->count = 0;
+}
+
+/**
+ * @brief 向累加器加入一个转换结果
+ */
+static inline void joystick_filter_acc_add(joystick_filter_acc_t* acc, uint32_t value) {
+    acc->sum += value;
+    acc->count++;
+}
+
+/**
+ * @brief 取出累加器的平均值 (四舍五入)
+ * @param acc 累加器
+ * @param[out] avg 平均值
+ * @return true - 有数据, false - 本帧没有该通道的数据
+ */
+bool joystick_filter_acc_average(const joystick_filter_acc_t* acc, int* avg);
+
+/**
+ * @brief 初始化 IIR 滤波器
+ * @param iir 滤波器
+ * @param alpha_q15 滤波系数 (Q15，1 ~ 32768)
+ * @param initial 初始输出值
+ */
+void joystick_filter_iir_init(joystick_filter_iir_t* iir, uint16_t alpha_q15, int initial);
+
+/**
+ * @brief 输入一个新样本并返回滤波后的整数值
+ */
+int joystick_filter_iir_update(joystick_filter_iir_t* iir, int sample);
+
+/**
+ * @brief 将原始值归一化到 -100 ~ 100
+ * @param value 滤波后的原始值
+ * @param cal 校准数据，calibrated 为 false 时忽略
+ * @param calibrated 是否使用校准数据
+ * @return 归一化结果
+ */
+int joystick_filter_normalize(int value, const joystick_axis_cal_t* cal, bool calibrated);
+
+/**
+ * @brief 原始值转换为电压 (mV)
+ */
+static inline int joystick_filter_raw_to_mv(int raw) {
+    return (raw * JOYSTICK_FILTER_FULL_SCALE_MV) / JOYSTICK_FILTER_ADC_MAX;
+}
+
+/**
+ * @brief 校准过程中用新值扩展最大/最小值
+ */
+static inline void joystick_filter_cal_track(joystick_axis_cal_t* cal, int value) {
+    if (value < cal->min) {
+        cal->min = value;
+    }
+    if (value > cal->max) {
+        cal->max = value;
+    }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // JOYSTICK_FILTER_H
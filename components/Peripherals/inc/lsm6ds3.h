@@ -13,6 +13,7 @@ extern "C" {
 #endif
 
 #include "bsp_i2c.h"
+#include "lsm6ds3_fifo.h"
 #include "driver/gpio.h"
 #include "driver/i2c.h"
 #include "driver/i2c_master.h"
@@ -33,6 +34,13 @@ extern "C" {
 // 通信模式选择 - 推荐使用I2C模式避免SPI冲突
 #define LSM6DS3_USE_I2C 1 // 1=I2C, 0=SPI
 
+// INT1 中断引脚 (FIFO 水位线中断)，-1 表示未连接，此时按水位线周期定时读取
+#define LSM6DS3_INT1_PIN -1
+
+// FIFO 配置
+#define LSM6DS3_FIFO_DEFAULT_WATERMARK 8 // 默认水位线 (样本数)，416Hz 下约 19ms 触发一次
+#define LSM6DS3_FIFO_MAX_BURST_SAMPLES 64 // 单次突发读取的最大样本数
+
 // ========================================
 // LSM6DS3 寄存器地址定义
 // ========================================
@@ -177,6 +185,25 @@ typedef enum {
     LSM6DS3_COMM_MODE_SPI,
 } lsm6ds3_comm_mode_t;
 
+/**
+ * @brief FIFO 配置
+ */
+typedef struct {
+    uint8_t odr;        // FIFO/传感器输出数据率 (LSM6DS3_ODR_xxx)
+    uint16_t watermark; // 水位线 (样本数，每个样本包含陀螺仪+加速度计)
+    int int1_pin;       // INT1 引脚，-1 表示定时读取
+} lsm6ds3_fifo_config_t;
+
+/**
+ * @brief FIFO 运行统计
+ */
+typedef struct {
+    uint32_t bursts;          // 突发读取次数
+    uint32_t samples;         // 送入 AHRS 的样本总数
+    uint32_t overruns;        // FIFO 溢出次数
+    uint32_t last_burst_size; // 最近一次突发读取的样本数
+} lsm6ds3_fifo_stats_t;
+
 // ========================================
 // 结构体和枚举
 // ========================================
@@ -264,6 +291,45 @@ esp_err_t lsm6ds3_read_all(lsm6ds3_data_t* data);
  */
 esp_err_t lsm6ds3_read_euler(lsm6ds3_euler_t* euler);
 
+/**
+ * @brief 启用FIFO连续模式 (陀螺仪+加速度计，不抽取)
+ *        启用后应使用 lsm6ds3_fifo_wait() + lsm6ds3_fifo_read_euler() 代替 lsm6ds3_read_euler()，
+ *        AHRS 会按 FIFO ODR 重新初始化。
+ * @param config FIFO 配置，NULL 使用默认值 (416Hz, LSM6DS3_FIFO_DEFAULT_WATERMARK, LSM6DS3_INT1_PIN)
+ * @return ESP_OK 成功, 其他值表示错误
+ */
+esp_err_t lsm6ds3_fifo_enable(const lsm6ds3_fifo_config_t* config);
+
+/**
+ * @brief 关闭FIFO (切回 Bypass 模式)
+ * @return ESP_OK 成功, 其他值表示错误
+ */
+esp_err_t lsm6ds3_fifo_disable(void);
+
+/**
+ * @brief 等待FIFO达到水位线
+ *        配置了 INT1 引脚时等待中断通知，否则按水位线对应的时间周期延时。
+ * @param timeout_ms 超时时间 (ms)，仅中断模式有效
+ * @return ESP_OK 水位线已到达, ESP_ERR_TIMEOUT 超时
+ */
+esp_err_t lsm6ds3_fifo_wait(uint32_t timeout_ms);
+
+/**
+ * @brief 一次突发读取FIFO中的全部样本，逐个送入 Fusion AHRS 后返回最新欧拉角
+ *        每个样本使用 1/ODR 作为 deltaTime，经 FusionAhrsUpdateNoMagnetometerBatch 批量解算，
+ *        欧拉角仅在批处理结束时计算一次。
+ * @param euler 欧拉角输出指针 (单位: 度)
+ * @param samples 实际处理的样本数输出，可为 NULL
+ * @return ESP_OK 成功, ESP_ERR_NOT_FOUND FIFO 中没有完整样本, 其他值表示错误
+ */
+esp_err_t lsm6ds3_fifo_read_euler(lsm6ds3_euler_t* euler, size_t* samples);
+
+/**
+ * @brief 获取FIFO运行统计
+ * @param stats 统计输出指针
+ */
+void lsm6ds3_fifo_get_stats(lsm6ds3_fifo_stats_t* stats);
+
 /**
  * @brief 检查传感器是否就绪
  * @return true 就绪, false 未就绪
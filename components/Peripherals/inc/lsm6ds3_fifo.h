@@ -0,0 +1,132 @@
+/**
+ * @file lsm6ds3_fifo.h
+ * @brief LSM6DS3 FIFO 寄存器定义与数据解码
+ *
+ * 解码部分不访问总线，由 others/py_test_demo/lsm6ds3_fifo_bench.py 用一段 FIFO 读出在主机上校验。
+ *
+ * @author Your Name
+ * @date 2024
+ */
+
+#ifndef LSM6DS3_FIFO_H
+#define LSM6DS3_FIFO_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// ========================================
+// FIFO 相关寄存器地址
+// ========================================
+#define LSM6DS3_REG_FIFO_STATUS1 0x3A
+#define LSM6DS3_REG_FIFO_STATUS2 0x3B
+#define LSM6DS3_REG_FIFO_STATUS3 0x3C
+#define LSM6DS3_REG_FIFO_STATUS4 0x3D
+#define LSM6DS3_REG_FIFO_DATA_OUT_L 0x3E
+#define LSM6DS3_REG_FIFO_DATA_OUT_H 0x3F
+
+// ========================================
+// FIFO 寄存器位定义
+// ========================================
+// FIFO_CTRL2: FTH[11:8]
+#define LSM6DS3_FIFO_CTRL2_FTH_MASK 0x0F
+
+// FIFO_CTRL3: 陀螺仪/加速度计抽取系数 (001 = 不抽取)
+#define LSM6DS3_FIFO_CTRL3_DEC_GYRO_NONE 0x08
+#define LSM6DS3_FIFO_CTRL3_DEC_XL_NONE 0x01
+
+// FIFO_CTRL5: ODR_FIFO[6:3] + FIFO_MODE[2:0]
+#define LSM6DS3_FIFO_CTRL5_ODR_MASK 0x78
+#define LSM6DS3_FIFO_MODE_BYPASS 0x00
+#define LSM6DS3_FIFO_MODE_FIFO 0x01
+#define LSM6DS3_FIFO_MODE_CONTINUOUS 0x06
+
+// INT1_CTRL
+#define LSM6DS3_INT1_CTRL_FTH 0x08
+#define LSM6DS3_INT1_CTRL_FIFO_OVR 0x10
+
+// FIFO_STATUS2
+#define LSM6DS3_FIFO_STATUS2_DIFF_MASK 0x0F
+#define LSM6DS3_FIFO_STATUS2_EMPTY 0x10
+#define LSM6DS3_FIFO_STATUS2_FULL 0x20
+#define LSM6DS3_FIFO_STATUS2_OVER_RUN 0x40
+#define LSM6DS3_FIFO_STATUS2_FTH 0x80
+
+// FIFO_STATUS4: FIFO_PATTERN[9:8]
+#define LSM6DS3_FIFO_STATUS4_PATTERN_MASK 0x03
+
+// ========================================
+// FIFO 数据格式
+// ========================================
+// 陀螺仪与加速度计同 ODR 且不抽取时，FIFO 按 Gx Gy Gz Ax Ay Az 的顺序循环写入，
+// 每个字 (word) 为 16 位小端数据
+#define LSM6DS3_FIFO_WORDS_PER_SAMPLE 6
+#define LSM6DS3_FIFO_BYTES_PER_WORD 2
+#define LSM6DS3_FIFO_BYTES_PER_SAMPLE (LSM6DS3_FIFO_WORDS_PER_SAMPLE * LSM6DS3_FIFO_BYTES_PER_WORD)
+#define LSM6DS3_FIFO_MAX_WATERMARK 0x0FFF // FTH 为 12 位 (单位: 字)
+
+/**
+ * @brief FIFO_STATUS1..4 解析结果
+ */
+typedef struct {
+    uint16_t unread_words; // FIFO 中未读的字数 (DIFF_FIFO)
+    uint16_t pattern;      // 下一个读出字在模式中的位置 (0 = 陀螺仪 X)
+    bool watermark;        // 达到水位线
+    bool overrun;          // FIFO 溢出 (旧数据已被覆盖)
+    bool full;             // FIFO 已满
+    bool empty;            // FIFO 为空
+} lsm6ds3_fifo_status_t;
+
+/**
+ * @brief 单个 FIFO 样本的原始数据
+ */
+typedef struct {
+    int16_t gyro[3];  // 陀螺仪原始值 X/Y/Z
+    int16_t accel[3]; // 加速度计原始值 X/Y/Z
+} lsm6ds3_fifo_raw_sample_t;
+
+/**
+ * @brief 解析从 FIFO_STATUS1 开始连续读取的 4 个状态寄存器
+ * @param regs FIFO_STATUS1..FIFO_STATUS4 原始值
+ * @param status 解析结果输出
+ */
+void lsm6ds3_fifo_parse_status(const uint8_t regs[4], lsm6ds3_fifo_status_t* status);
+
+/**
+ * @brief 计算本次突发读取的字节数
+ *        会先跳过不完整样本的剩余字，再读取最多 max_samples 个完整样本，
+ *        保证下次读取时 FIFO 模式位置对齐到陀螺仪 X。
+ * @param status FIFO 状态
+ * @param max_samples 最多读取的完整样本数
+ * @return 需要从 FIFO_DATA_OUT_L 连续读取的字节数
+ */
+size_t lsm6ds3_fifo_burst_len(const lsm6ds3_fifo_status_t* status, size_t max_samples);
+
+/**
+ * @brief 解码一次突发读取得到的 FIFO 数据
+ * @param buf 从 FIFO_DATA_OUT_L 连续读取的字节流
+ * @param len 字节数
+ * @param start_pattern 读取前 FIFO_STATUS3/4 给出的模式位置
+ * @param samples 样本输出数组
+ * @param max_samples 输出数组容量
+ * @return 解码得到的完整样本数
+ */
+size_t lsm6ds3_fifo_decode(const uint8_t* buf, size_t len, uint16_t start_pattern,
+                           lsm6ds3_fifo_raw_sample_t* samples, size_t max_samples);
+
+/**
+ * @brief 将 ODR 寄存器值 (LSM6DS3_ODR_xxx) 转换为频率
+ * @param odr ODR 寄存器值
+ * @return 频率 (Hz)，掉电时返回 0
+ */
+float lsm6ds3_fifo_odr_to_hz(uint8_t odr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LSM6DS3_FIFO_H
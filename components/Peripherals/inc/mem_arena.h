@@ -0,0 +1,164 @@
+/**
+ * @file mem_arena.h
+ * @brief 子系统内存区 - 初始化时一次性申请，运行期只做指针运算，带高水位与失败统计
+ *
+ * 两种形式:
+ *   - 线性区 (mem_arena_t): 顺序分配、整体 reset，适合每帧临时结构。只允许拥有它的单个任务使用，不加锁。
+ *   - 定长块池 (mem_pool_t): 固定大小的块，任意任务申请、任意任务归还 (如解码任务申请、UI 释放)，
+ *     自旋锁保护空闲链表，临界区只有几条指令。
+ *
+ * 每个区初始化后挂到全局列表 (mem_arena_get_all) 并注册到指标表:
+ *   mem_arena_capacity_bytes / mem_arena_used_bytes / mem_arena_high_water_bytes / mem_arena_alloc_failures_total
+ * 区对象本身必须是静态存储 (指标表持有其地址)；deinit 后可再次 init，统计与注册保留。
+ */
+
+#ifndef MEM_ARENA_H
+#define MEM_ARENA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+#include "metrics.h"
+
+#define MEM_ARENA_ALIGN 16 // 区基址与池块大小的对齐 (满足 JPEG 编解码器的缓冲要求)
+
+typedef enum {
+    MEM_ARENA_KIND_BUMP = 0,
+    MEM_ARENA_KIND_POOL,
+} mem_arena_kind_t;
+
+/**
+ * @brief 两种区共用的头部与统计 (字节数；池的 used 按整块计)
+ */
+typedef struct mem_arena_info {
+    const char* name;
+    mem_arena_kind_t kind;
+    uint32_t caps;       // 申请时使用的 heap_caps
+    uint32_t capacity;
+    uint32_t used;
+    uint32_t high_water;
+    uint32_t allocs;     // 成功分配次数
+    uint32_t failures;   // 空间不足导致的失败次数
+    char labels[32];
+    metrics_desc_t metrics[4];
+    bool listed;
+    struct mem_arena_info* next;
+} mem_arena_info_t;
+
+typedef struct {
+    mem_arena_info_t info;
+    uint8_t* base;
+} mem_arena_t;
+
+typedef struct {
+    mem_arena_info_t info;
+    uint8_t* base;
+    uint32_t block_size;
+    uint32_t block_count;
+    void* free_list;     // 空闲块首字存放下一个空闲块地址
+    portMUX_TYPE lock;
+} mem_pool_t;
+
+/**
+ * @brief 统计快照 (mem_arena_get_all 输出)
+ */
+typedef struct {
+    const char* name;
+    mem_arena_kind_t kind;
+    uint32_t caps;
+    uint32_t capacity;
+    uint32_t used;
+    uint32_t high_water;
+    uint32_t allocs;
+    uint32_t failures;
+} mem_arena_stats_t;
+
+/**
+ * @brief 申请线性区
+ * @param name 区名，同时用作指标标签，需为常量字符串
+ * @param caps heap_caps 能力位，如 MALLOC_CAP_SPIRAM
+ * @return ESP_ERR_INVALID_STATE 已初始化；ESP_ERR_NO_MEM 申请失败
+ */
+esp_err_t mem_arena_init(mem_arena_t* arena, const char* name, size_t size, uint32_t caps);
+
+void mem_arena_deinit(mem_arena_t* arena);
+
+/**
+ * @brief 从线性区分配，align 为 2 的幂 (0 表示 sizeof(void*))；空间不足返回 NULL 并计一次失败
+ */
+void* mem_arena_alloc(mem_arena_t* arena, size_t size, size_t align);
+
+/**
+ * @brief 分配并清零
+ */
+void* mem_arena_calloc(mem_arena_t* arena, size_t size, size_t align);
+
+/**
+ * @brief 当前分配位置，配合 mem_arena_rewind 释放其后的所有分配
+ */
+static inline uint32_t mem_arena_mark(const mem_arena_t* arena)
+{
+    return arena->info.used;
+}
+
+void mem_arena_rewind(mem_arena_t* arena, uint32_t mark);
+
+/**
+ * @brief 整体释放，高水位保留
+ */
+static inline void mem_arena_reset(mem_arena_t* arena)
+{
+    mem_arena_rewind(arena, 0);
+}
+
+/**
+ * @brief 申请定长块池，block_size 向上取整到 MEM_ARENA_ALIGN
+ */
+esp_err_t mem_pool_init(mem_pool_t* pool, const char* name, size_t block_size, size_t block_count, uint32_t caps);
+
+/**
+ * @brief 释放池内存；调用者需保证所有块已归还
+ */
+void mem_pool_deinit(mem_pool_t* pool);
+
+/**
+ * @brief 取一块，池空返回 NULL 并计一次失败；可在任意任务调用
+ */
+void* mem_pool_alloc(mem_pool_t* pool);
+
+/**
+ * @brief 归还一块
+ * @return 指针不属于该池时返回 false (不做任何处理)，调用者可据此回退到其它释放方式
+ */
+bool mem_pool_free(mem_pool_t* pool, void* block);
+
+/**
+ * @brief 判断指针是否是该池中某块的起始地址
+ */
+bool mem_pool_owns(const mem_pool_t* pool, const void* block);
+
+/**
+ * @brief 池的块大小，未初始化时为 0
+ */
+static inline size_t mem_pool_block_size(const mem_pool_t* pool)
+{
+    return pool->base ? pool->block_size : 0;
+}
+
+/**
+ * @brief 复制所有已注册区的统计
+ * @return 写入个数
+ */
+size_t mem_arena_get_all(mem_arena_stats_t* out, size_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MEM_ARENA_H
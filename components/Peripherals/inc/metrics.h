@@ -0,0 +1,128 @@
+/**
+ * @file metrics.h
+ * @brief 统一指标注册表 - 计数器、仪表与直方图，按 Prometheus 文本格式导出
+ *
+ * 指标对象由各模块静态定义并调用 metrics_register 挂到全局链表上 (无动态分配，注册可在任意时刻、任意任务中进行)。
+ * 更新只是一条 32 位原子操作，可在中断中调用；导出时逐个读取，不暂停写入。
+ * 模块已有的统计结构体字段可用 ref 方式注册，导出时直接读取该 uint32_t，热路径不需要任何改动。
+ *
+ * 本文件与 metrics.c 除 esp_err.h 外只依赖 C 标准库，可在主机上编译 (others/py_test_demo/metrics_bench.py)。
+ * 数值均为 32 位: 计数器回绕时 Prometheus 会当作一次重置处理。
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define METRICS_MAX_BUCKETS 12 // 直方图上界个数上限 (另有 +Inf 桶)
+
+typedef enum {
+    METRICS_TYPE_COUNTER = 0,
+    METRICS_TYPE_GAUGE,
+    METRICS_TYPE_HISTOGRAM,
+} metrics_type_t;
+
+/**
+ * @brief 所有指标的公共头
+ *
+ * 同名指标可以注册多个 (标签不同)，导出时共用一组 HELP/TYPE 行，help 只需在其中一个上填写。
+ */
+typedef struct metrics_desc {
+    const char* name;             // 指标名，计数器按惯例以 _total 结尾
+    const char* help;
+    const char* labels;           // 常量标签，如 "heap=\"dma\""，NULL 表示无标签
+    metrics_type_t type;
+    const volatile uint32_t* ref; // 非 NULL 时导出该变量的值 (仅计数器/仪表)
+    bool registered;
+    struct metrics_desc* next;
+} metrics_desc_t;
+
+typedef struct {
+    metrics_desc_t desc;
+    uint32_t value;
+} metrics_counter_t;
+
+typedef struct {
+    metrics_desc_t desc;
+    int32_t value;
+} metrics_gauge_t;
+
+typedef struct {
+    metrics_desc_t desc;
+    const uint32_t* bounds; // 各桶上界 (含)，递增
+    uint8_t bucket_count;   // bounds 个数，不超过 METRICS_MAX_BUCKETS
+    uint32_t buckets[METRICS_MAX_BUCKETS + 1]; // 非累计计数，最后一个为 +Inf；总数即各桶之和
+    uint32_t sum;
+} metrics_histogram_t;
+
+// 静态初始化
+#define METRICS_COUNTER_INIT(n, h) {.desc = {.name = (n), .help = (h), .type = METRICS_TYPE_COUNTER}}
+#define METRICS_GAUGE_INIT(n, h) {.desc = {.name = (n), .help = (h), .type = METRICS_TYPE_GAUGE}}
+#define METRICS_HISTOGRAM_INIT(n, h, b)                                                                        \
+    {.desc = {.name = (n), .help = (h), .type = METRICS_TYPE_HISTOGRAM}, .bounds = (b),                     \
+     .bucket_count = (uint8_t)(sizeof(b) / sizeof((b)[0]))}
+// 引用已有统计字段的指标 (t 为 METRICS_TYPE_COUNTER 或 METRICS_TYPE_GAUGE)
+#define METRICS_REF_INIT(n, h, t, p) {.name = (n), .help = (h), .type = (t), .ref = (const volatile uint32_t*)(p)}
+
+typedef int (*metrics_write_fn_t)(void* ctx, const char* data, size_t len);
+
+/**
+ * @brief 注册指标，重复注册同一对象直接返回
+ * @return ESP_ERR_INVALID_ARG 名称为空或直方图桶数超限
+ */
+esp_err_t metrics_register(metrics_desc_t* desc);
+
+/**
+ * @brief 批量注册 ref 指标数组
+ */
+esp_err_t metrics_register_refs(metrics_desc_t* descs, size_t count);
+
+static inline void metrics_counter_add(metrics_counter_t* c, uint32_t n)
+{
+    __atomic_fetch_add(&c->value, n, __ATOMIC_RELAXED);
+}
+
+static inline void metrics_counter_inc(metrics_counter_t* c)
+{
+    __atomic_fetch_add(&c->value, 1, __ATOMIC_RELAXED);
+}
+
+static inline void metrics_gauge_set(metrics_gauge_t* g, int32_t v)
+{
+    __atomic_store_n(&g->value, v, __ATOMIC_RELAXED);
+}
+
+static inline void metrics_gauge_add(metrics_gauge_t* g, int32_t n)
+{
+    __atomic_fetch_add(&g->value, n, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief 记录一个观测值 (落入第一个 >= v 的桶)
+ */
+void metrics_histogram_observe(metrics_histogram_t* h, uint32_t v);
+
+/**
+ * @brief 按 Prometheus 文本格式 (0.0.4) 输出所有已注册指标
+ * @return write 返回负值时中止并返回 ESP_FAIL
+ */
+esp_err_t metrics_write_text(metrics_write_fn_t write, void* ctx);
+
+/**
+ * @brief 已注册的指标个数
+ */
+size_t metrics_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // METRICS_H
@@ -0,0 +1,33 @@
+/**
+ * @file metrics_server.h
+ * @brief 指标抓取服务 - 以 HTTP 响应返回 Prometheus 文本格式的全部已注册指标
+ *
+ * 单连接、短连接: 读取请求头后忽略路径，返回 200 与 metrics_write_text 的输出并关闭，例如:
+ *   curl http://<ip>:9100/metrics
+ */
+
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define METRICS_SERVER_PORT 9100 // 默认端口 (与 node_exporter 一致，便于直接加入抓取配置)
+
+/**
+ * @brief 启动/停止抓取服务 (需在网络协议栈初始化之后)，重复启动直接返回
+ */
+esp_err_t metrics_server_start(uint16_t port);
+void metrics_server_stop(void);
+bool metrics_server_is_running(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // METRICS_SERVER_H
@@ -19,6 +19,7 @@ extern "C" {
 #include "driver/ledc.h" // 新增头文件
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "st7789_dirty.h"
 
 // ========================================
 // 硬件连接配置 (可根据实际连接修改)
@@ -53,7 +54,13 @@ extern "C" {
 // SPI传输配置
 // ========================================
 #define ST7789_SPI_CLOCK_HZ     80000000    // 80MHz SPI时钟 (最大速度)
-#define ST7789_SPI_QUEUE_SIZE   7           // SPI队列大小
+#define ST7789_SPI_QUEUE_SIZE   16          // SPI队列大小 (每个窗口的命令占5个事务，留出多窗口连续排队的余量)
+#define ST7789_WINDOW_COST_PX   64          // 每个窗口的命令开销折算像素数 (5个排队事务约12us，80MHz下每像素0.2us)
+
+// 异步刷屏任务 (源缓冲不可DMA时负责弹跳复制，放在LVGL所在核之外与渲染并行)
+#define ST7789_FLUSH_TASK_STACK     3072
+#define ST7789_FLUSH_TASK_PRIORITY  9
+#define ST7789_FLUSH_TASK_CORE      0
 
 // ========================================
 // ST7789 命令定义
@@ -122,6 +129,23 @@ typedef struct {
     uint8_t rotation;
 } st7789_handle_t;
 
+/**
+ * @brief 异步刷屏完成回调
+ * @note 通常在SPI中断中 (post_cb) 调用，需放在IRAM且只调用ISR安全的函数；
+ *       排队失败退化为阻塞发送时在任务上下文中调用
+ */
+typedef void (*st7789_done_cb_t)(void *arg);
+
+typedef struct {
+    uint32_t flushes;           // 异步刷屏次数
+    uint32_t direct_flushes;    // 其中源缓冲DMA可达、未经弹跳复制的次数
+    uint32_t rects;             // st7789_flush_rects 收到的脏区数
+    uint32_t windows;           // 实际发送的窗口数 (脏区合并后)
+    uint64_t bytes;
+    uint64_t xfer_us;           // 排队到最后一个事务完成的累计时间
+    uint64_t wait_us;           // 调用者等待上一次传输结束的累计时间
+} st7789_async_stats_t;
+
 // ========================================
 // 函数声明
 // ========================================
@@ -140,6 +164,7 @@ esp_err_t st7789_deinit(void);
 
 /**
  * @brief 设置显示窗口
+ * @note 只记录窗口，窗口命令随下一次像素写入一起排队发送
  * @param x0 起始X坐标
  * @param y0 起始Y坐标  
  * @param x1 结束X坐标
@@ -153,6 +178,46 @@ void st7789_set_window(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
  * @param length 数据长度(像素数量)
  */
 void st7789_write_pixels(const uint16_t *data, size_t length);
+
+/**
+ * @brief 异步写入像素数据 (需先调用 st7789_set_window)
+ *
+ * 排队后立即返回，最后一个SPI事务完成时调用 done_cb。
+ * 源缓冲DMA可达时直接引用，否则由刷屏任务经内部DMA缓冲分块复制发送；
+ * 回调之前 data 必须保持有效且不被修改。下一条命令或像素写入会先等待本次传输结束。
+ * @param data 像素数据缓冲区
+ * @param length 数据长度(像素数量)
+ * @param done_cb 完成回调，可为NULL
+ * @param arg 回调参数
+ * @return ESP_OK 已排队; ESP_ERR_INVALID_ARG 参数无效 (不会回调)
+ */
+esp_err_t st7789_write_pixels_async(const uint16_t *data, size_t length, st7789_done_cb_t done_cb, void *arg);
+
+/**
+ * @brief 异步发送一帧的多个脏区
+ *
+ * 脏区按代价模型合并 (见 st7789_dirty.h)，每个窗口的 CASET/RASET/RAMWR 与像素在同一DMA队列中排队，
+ * 非整行宽的窗口在复制到内部DMA缓冲时逐行收集。最后一个窗口发送完成时调用 done_cb。
+ * @param fb 整屏帧缓冲 (ST7789_WIDTH x ST7789_HEIGHT)，回调之前保持有效且不被修改
+ * @param rects 脏区，超出屏幕的部分被裁掉
+ * @param count 脏区数，不超过 ST7789_DIRTY_MAX_RECTS
+ * @param done_cb 完成回调，可为NULL
+ * @param arg 回调参数
+ * @return ESP_OK 已排队; ESP_ERR_INVALID_ARG 参数无效或裁剪后没有脏区 (不会回调)
+ */
+esp_err_t st7789_flush_rects(const uint16_t *fb, const st7789_rect_t *rects, size_t count,
+                             st7789_done_cb_t done_cb, void *arg);
+
+/**
+ * @brief 等待异步像素传输结束
+ */
+void st7789_wait_idle(void);
+
+/**
+ * @brief 获取异步刷屏统计
+ */
+void st7789_get_async_stats(st7789_async_stats_t *stats);
+
 void st7789_fill_area(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1, uint16_t color);
 
 /**
@@ -0,0 +1,58 @@
+/**
+ * @file st7789_dirty.h
+ * @brief ST7789 脏区合并与窗口代价模型
+ *
+ * 一帧的脏区发送代价按像素计: 每个窗口发送其全部像素，另加一次窗口切换开销
+ * (CASET/RASET/RAMWR 三条命令及其参数的事务开销，折算成等价像素数 window_cost_px)。
+ * 重叠的脏区分开发送时重叠部分会发两次。
+ * 合并时每次选出节省最多的一对矩形换成它们的外接矩形，直到任何合并都不再省，
+ * 因此相邻或重叠的脏区总会合并，相距较远的小脏区保持分开。
+ * 合并效果与耗时可用 others/py_test_demo/st7789_dirty_bench.py 在主机上评估。
+ */
+
+#ifndef ST7789_DIRTY_H
+#define ST7789_DIRTY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define ST7789_DIRTY_MAX_RECTS 32 // 一帧最多脏区数 (与 LVGL 的 LV_INV_BUF_SIZE 一致)
+
+/**
+ * @brief 屏幕矩形，坐标含端点
+ */
+typedef struct {
+    int16_t x1;
+    int16_t y1;
+    int16_t x2;
+    int16_t y2;
+} st7789_rect_t;
+
+/**
+ * @brief 矩形像素数，空矩形为 0
+ */
+uint32_t st7789_rect_area(const st7789_rect_t *r);
+
+/**
+ * @brief 按给定窗口分别发送的代价 (像素数 + 每个窗口 window_cost_px)
+ */
+uint32_t st7789_dirty_cost(const st7789_rect_t *rects, size_t n, uint32_t window_cost_px);
+
+/**
+ * @brief 原地合并脏区并按 y1、x1 排序 (自上而下扫描)
+ * @param rects 脏区，合并结果写回前若干项；空矩形被丢弃
+ * @param n 脏区数
+ * @param window_cost_px 每个窗口的固定开销 (等价像素数)
+ * @return 合并后的窗口数
+ */
+size_t st7789_dirty_merge(st7789_rect_t *rects, size_t n, uint32_t window_cost_px);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ST7789_DIRTY_H
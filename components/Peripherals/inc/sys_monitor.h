@@ -0,0 +1,98 @@
+/**
+ * @file sys_monitor.h
+ * @brief 系统资源采样 - 按固定周期记录各任务 CPU 占用、栈水位，各类堆的空闲/最大块与分配失败次数
+ *
+ * CPU 占用取两次采样之间 FreeRTOS 运行时间统计的增量，按单核 100% 计；
+ * 核负载 = 100% - 该核空闲任务的占用。
+ * 汇总数据 (核负载、堆、分配失败) 存入最近 SYS_MONITOR_HISTORY 次采样的环；
+ * 每个任务另保留最近 SYS_MONITOR_TASK_HISTORY 次的 CPU 占用。
+ */
+
+#ifndef SYS_MONITOR_H
+#define SYS_MONITOR_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define SYS_MONITOR_DEFAULT_PERIOD_MS 1000
+#define SYS_MONITOR_HISTORY 60       // 汇总采样环长度
+#define SYS_MONITOR_TASK_HISTORY 16  // 每个任务的 CPU 占用历史
+#define SYS_MONITOR_MAX_TASKS 32     // 跟踪的任务数上限
+#define SYS_MONITOR_MAX_CORES 2
+#define SYS_MONITOR_TASK_NAME_LEN 16
+
+typedef enum {
+    SYS_MONITOR_HEAP_INTERNAL = 0, // 内部 RAM (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+    SYS_MONITOR_HEAP_DMA,          // DMA 可用 (MALLOC_CAP_DMA)
+    SYS_MONITOR_HEAP_SPIRAM,       // PSRAM (MALLOC_CAP_SPIRAM)
+    SYS_MONITOR_HEAP_MAX
+} sys_monitor_heap_t;
+
+typedef struct {
+    uint32_t free_bytes;
+    uint32_t largest_block; // 最大连续空闲块
+    uint32_t min_free;      // 启动以来最低空闲
+    uint32_t alloc_failures;
+} sys_monitor_heap_stats_t;
+
+typedef struct {
+    uint32_t timestamp_ms;
+    uint16_t core_load_x10[SYS_MONITOR_MAX_CORES]; // 0.1% 单位
+    sys_monitor_heap_stats_t heap[SYS_MONITOR_HEAP_MAX];
+    uint32_t last_failed_size; // 最近一次分配失败的请求大小
+    uint16_t task_count;
+} sys_monitor_sample_t;
+
+typedef struct {
+    char name[SYS_MONITOR_TASK_NAME_LEN];
+    uint32_t task_number; // FreeRTOS 任务编号 (不复用)
+    int8_t core;          // 绑定的核，-1 表示不绑定
+    uint8_t priority;
+    uint16_t cpu_x10;     // 最近一个周期的占用，0.1% 单位 (单核 100%)
+    uint32_t stack_hwm;   // 栈剩余最低值 (字节)
+    uint8_t cpu_history[SYS_MONITOR_TASK_HISTORY]; // 0.5% 单位，按时间先后排列，最后一项最新
+} sys_monitor_task_t;
+
+/**
+ * @brief 启动采样任务并注册分配失败回调，重复调用直接返回
+ * @param period_ms 采样周期，0 为 SYS_MONITOR_DEFAULT_PERIOD_MS
+ */
+esp_err_t sys_monitor_start(uint32_t period_ms);
+void sys_monitor_stop(void);
+bool sys_monitor_is_running(void);
+
+/**
+ * @brief 最近一次汇总采样，尚无采样时返回 false
+ */
+bool sys_monitor_get_latest(sys_monitor_sample_t *sample);
+
+/**
+ * @brief 汇总采样历史 (从旧到新)
+ * @return 复制的采样数
+ */
+size_t sys_monitor_get_history(sys_monitor_sample_t *samples, size_t max);
+
+/**
+ * @brief 各任务最近一次的统计，按 CPU 占用从高到低
+ * @return 复制的任务数
+ */
+size_t sys_monitor_get_tasks(sys_monitor_task_t *tasks, size_t max);
+
+/**
+ * @brief 堆碎片率: 100 - 最大块占空闲的百分比 (空闲为 0 时为 0)
+ */
+uint8_t sys_monitor_fragmentation(const sys_monitor_heap_stats_t *heap);
+
+const char *sys_monitor_heap_name(sys_monitor_heap_t heap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SYS_MONITOR_H
@@ -0,0 +1,109 @@
+/**
+ * @file sys_trace.h
+ * @brief 系统级事件追踪 - 每核无锁环形缓冲记录区间/计数/瞬时事件，导出为 Chrome trace JSON
+ *
+ * 事件只记录时间戳 (esp_timer_get_time 的低 32 位，微秒)、名字指针、任务与一个整数值，
+ * 名字必须是字符串常量 (只存指针，导出时才读)，并且不含引号和反斜杠。
+ * 每个核一个环，写入方用原子自增取槽位，同核的任务与中断之间无需加锁；
+ * 槽位写完后才置序号，导出时用序号丢弃写了一半或已被覆盖的事件。环满后覆盖最旧的事件。
+ *
+ * 编译时以 SYS_TRACE_ENABLE=0 (顶层 CMake 选项 EN_SYS_TRACE=OFF) 去掉所有追踪宏。
+ * JSON 可直接在 chrome://tracing 或 https://ui.perfetto.dev 中打开。
+ */
+
+#ifndef SYS_TRACE_H
+#define SYS_TRACE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifndef SYS_TRACE_ENABLE
+#define SYS_TRACE_ENABLE 1
+#endif
+
+#define SYS_TRACE_DEFAULT_EVENTS 1024 // 每核默认事件数 (向上取 2 的幂)，每个事件 24 字节
+#define SYS_TRACE_TID_ISR 0xFFFFFF00u // 中断中的事件: tid = SYS_TRACE_TID_ISR | core
+
+typedef enum {
+    SYS_TRACE_EV_BEGIN = 0, // 区间开始 (同一任务内与 END 成对、可嵌套)
+    SYS_TRACE_EV_END,       // 区间结束
+    SYS_TRACE_EV_INSTANT,   // 瞬时事件
+    SYS_TRACE_EV_COUNTER,   // 计数器取值 (value)
+} sys_trace_type_t;
+
+typedef struct {
+    uint32_t seq;     // 0 表示空或正在写，写完后为槽位序号 + 1
+    uint32_t ts_us;   // esp_timer_get_time() 低 32 位
+    const char* name; // 字符串常量
+    uint32_t tid;     // 任务句柄，中断中为 SYS_TRACE_TID_ISR | core
+    int32_t value;    // 计数器值
+    uint8_t type;     // sys_trace_type_t
+    uint8_t reserved[3];
+} sys_trace_event_t;
+
+typedef struct {
+    uint32_t capacity; // 每核事件数
+    uint32_t recorded; // 自上次清空以来记录的事件数 (各核合计)
+    uint32_t lost;     // 被覆盖的事件数
+} sys_trace_stats_t;
+
+/**
+ * @brief 导出时的输出函数，返回负数表示失败并中止导出
+ */
+typedef int (*sys_trace_write_fn_t)(void* ctx, const char* data, size_t len);
+
+/**
+ * @brief 分配各核事件环 (内部 RAM)，重复调用直接返回
+ * @param events_per_core 每核事件数，0 为 SYS_TRACE_DEFAULT_EVENTS
+ */
+esp_err_t sys_trace_init(size_t events_per_core);
+
+/**
+ * @brief 开始/停止记录；未初始化或停止时追踪宏只读一次标志
+ */
+void sys_trace_start(void);
+void sys_trace_stop(void);
+bool sys_trace_is_recording(void);
+
+/**
+ * @brief 清空所有事件 (记录中调用会先暂停，清空后恢复)
+ */
+void sys_trace_clear(void);
+
+/**
+ * @brief 记录一个事件 (任务与中断中均可调用)
+ */
+void sys_trace_emit(sys_trace_type_t type, const char* name, int32_t value);
+
+void sys_trace_get_stats(sys_trace_stats_t* stats);
+
+/**
+ * @brief 把当前环中的事件按 Chrome trace-event JSON 输出
+ *
+ * 导出期间暂停记录，结束后恢复原状态。
+ */
+esp_err_t sys_trace_write_json(sys_trace_write_fn_t write, void* ctx);
+
+#if SYS_TRACE_ENABLE
+#define SYS_TRACE_BEGIN(name) sys_trace_emit(SYS_TRACE_EV_BEGIN, (name), 0)
+#define SYS_TRACE_END(name) sys_trace_emit(SYS_TRACE_EV_END, (name), 0)
+#define SYS_TRACE_INSTANT(name) sys_trace_emit(SYS_TRACE_EV_INSTANT, (name), 0)
+#define SYS_TRACE_COUNTER(name, value) sys_trace_emit(SYS_TRACE_EV_COUNTER, (name), (int32_t)(value))
+#else
+#define SYS_TRACE_BEGIN(name) ((void)0)
+#define SYS_TRACE_END(name) ((void)0)
+#define SYS_TRACE_INSTANT(name) ((void)0)
+#define SYS_TRACE_COUNTER(name, value) ((void)sizeof(value)) // 不对 value 求值
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SYS_TRACE_H
@@ -1,5 +1,4 @@
 #include "battery_monitor.h"
-#include "driver/adc.h"
 #include "esp_log.h"
 #include "nvs.h"
 #include "nvs_flash.h"
@@ -8,6 +7,7 @@
 static const char* TAG = "BATTERY_MONITOR";
 static bool s_is_initialized = false;
 static float s_filtered_voltage = 0.0f;
+static bool s_filter_primed = false;
 
 // 校准相关变量
 static battery_cal_data_t s_cal_data = {.voltage_offset = 0.0f,
@@ -64,26 +64,18 @@ esp_err_t battery_monitor_init(void) {
         return ESP_OK;
     }
 
-    esp_err_t ret;
-
-    // 配置ADC1
-    ret = adc1_config_width(ADC_WIDTH_BIT_DEFAULT);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to config ADC width: %s", esp_err_to_name(ret));
-        return ret;
-    }
-
-    // 配置ADC通道
-    ret = adc1_config_channel_atten(BATTERY_ADC_CHANNEL, BATTERY_ADC_ATTEN);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to config ADC channel: %s", esp_err_to_name(ret));
-        return ret;
+    // 读取初始ADC值 (ADC 由摇杆驱动的连续采样提供)
+    int adc_reading = 0;
+    esp_err_t ret = joystick_adc_read_battery_raw(&adc_reading);
+    if (ret == ESP_OK) {
+        s_filtered_voltage = (float)adc_raw_to_voltage_mv(adc_reading);
+        s_filter_primed = true;
+    } else {
+        // 第一帧尚未完成，首次读取时再初始化滤波器
+        ESP_LOGW(TAG, "Battery ADC sample not ready yet: %s", esp_err_to_name(ret));
+        s_filter_primed = false;
     }
 
-    // 读取初始ADC值
-    int adc_reading = adc1_get_raw(BATTERY_ADC_CHANNEL);
-    s_filtered_voltage = (float)adc_raw_to_voltage_mv(adc_reading);
-
     // 尝试从NVS加载校准数据
     if (battery_monitor_load_calibration_from_nvs() == ESP_OK) {
         ESP_LOGI(TAG, "Successfully loaded calibration data from NVS");
@@ -110,9 +102,17 @@ esp_err_t battery_monitor_read(battery_info_t* info) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    int adc_reading = adc1_get_raw(BATTERY_ADC_CHANNEL);
+    int adc_reading = 0;
+    esp_err_t ret = joystick_adc_read_battery_raw(&adc_reading);
+    if (ret != ESP_OK) {
+        return ret;
+    }
     int voltage_mv = adc_raw_to_voltage_mv(adc_reading);
 
+    if (!s_filter_primed) {
+        s_filtered_voltage = (float)voltage_mv;
+        s_filter_primed = true;
+    }
     s_filtered_voltage = BATTERY_FILTER_ALPHA * voltage_mv + (1.0f - BATTERY_FILTER_ALPHA) * s_filtered_voltage;
     voltage_mv = (int)s_filtered_voltage;
 
@@ -209,7 +209,11 @@ esp_err_t battery_monitor_finish_calibration(void) {
     }
 
     // 读取当前ADC值
-    int adc_reading = adc1_get_raw(BATTERY_ADC_CHANNEL);
+    int adc_reading = 0;
+    esp_err_t ret = joystick_adc_read_battery_raw(&adc_reading);
+    if (ret != ESP_OK) {
+        return ret;
+    }
 
     // 计算校准参数
     int raw_voltage = adc_raw_to_voltage_mv(adc_reading);
@@ -0,0 +1,456 @@
+/**
+ * @file boot_graph.c
+ * @brief 启动依赖图 - 每核一个工作任务按依赖取步骤执行
+ */
+
+#include "boot_graph.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+static const char *TAG = "BOOT_GRAPH";
+
+typedef struct {
+    boot_step_t def;
+    uint32_t dep_mask;
+    boot_step_record_t rec;
+} boot_slot_t;
+
+static boot_slot_t s_slots[BOOT_GRAPH_MAX_STEPS];
+static uint32_t s_count = 0;
+static uint32_t s_ok_mask = 0;   // 成功 (或已置位) 的步骤
+static uint32_t s_done_mask = 0; // 已到终态的步骤
+static uint32_t s_fn_total = 0;
+static uint32_t s_fn_done = 0;
+static bool s_started = false;
+static int64_t s_start_us = 0;
+static SemaphoreHandle_t s_lock = NULL;
+static EventGroupHandle_t s_events = NULL; // 每步一位，终态时置位
+static TaskHandle_t s_workers[portNUM_PROCESSORS];
+static uint32_t s_workers_alive = 0;
+static boot_progress_cb_t s_progress_cb = NULL;
+
+static const char *state_name(boot_step_state_t state)
+{
+    switch (state) {
+    case BOOT_STEP_PENDING:
+        return "pending";
+    case BOOT_STEP_RUNNING:
+        return "running";
+    case BOOT_STEP_OK:
+        return "ok";
+    case BOOT_STEP_FAILED:
+        return "FAILED";
+    default:
+        return "skipped";
+    }
+}
+
+static int find_step(const char *name, size_t len)
+{
+    for (uint32_t i = 0; i < s_count; i++) {
+        if (strncmp(s_slots[i].def.name, name, len) == 0 && s_slots[i].def.name[len] == '\0') {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+static esp_err_t resolve_deps(boot_slot_t *slot)
+{
+    slot->dep_mask = 0;
+    const char *p = slot->def.deps;
+    while (p != NULL && *p != '\0') {
+        while (*p == ' ' || *p == ',') {
+            p++;
+        }
+        const char *end = p;
+        while (*end != '\0' && *end != ',' && *end != ' ') {
+            end++;
+        }
+        if (end > p) {
+            const int dep = find_step(p, (size_t)(end - p));
+            if (dep < 0) {
+                ESP_LOGE(TAG, "Step %s depends on unknown step '%.*s'", slot->def.name, (int)(end - p), p);
+                return ESP_ERR_NOT_FOUND;
+            }
+            slot->dep_mask |= 1u << dep;
+        }
+        p = end;
+    }
+    return ESP_OK;
+}
+
+// 拓扑排序检查依赖环
+static bool has_cycle(void)
+{
+    const uint32_t all = (s_count >= 32) ? UINT32_MAX : ((1u << s_count) - 1);
+    uint32_t resolved = 0;
+    bool progress = true;
+    while (progress && resolved != all) {
+        progress = false;
+        for (uint32_t i = 0; i < s_count; i++) {
+            if (!(resolved & (1u << i)) && (s_slots[i].dep_mask & ~resolved) == 0) {
+                resolved |= 1u << i;
+                progress = true;
+            }
+        }
+    }
+    for (uint32_t i = 0; i < s_count; i++) {
+        if (!(resolved & (1u << i))) {
+            ESP_LOGE(TAG, "Dependency cycle through step %s", s_slots[i].def.name);
+        }
+    }
+    return resolved != all;
+}
+
+static void notify_workers_locked(void)
+{
+    for (int i = 0; i < portNUM_PROCESSORS; i++) {
+        if (s_workers[i] != NULL) {
+            xTaskNotifyGive(s_workers[i]);
+        }
+    }
+}
+
+// 记录依赖刚刚全部满足的步骤
+static void stamp_ready_locked(int64_t now)
+{
+    for (uint32_t i = 0; i < s_count; i++) {
+        boot_slot_t *slot = &s_slots[i];
+        if (slot->rec.state == BOOT_STEP_PENDING && slot->rec.ready_us == 0 &&
+            (slot->dep_mask & ~s_ok_mask) == 0) {
+            slot->rec.ready_us = now;
+        }
+    }
+}
+
+// 置终态并把失败传播给后继，返回本次进入终态的步骤位
+static uint32_t finish_locked(uint32_t idx, boot_step_state_t state, esp_err_t err, int64_t now)
+{
+    uint32_t finished = 1u << idx;
+    s_slots[idx].rec.state = state;
+    s_slots[idx].rec.err = err;
+    s_slots[idx].rec.end_us = now;
+    s_done_mask |= 1u << idx;
+    if (state == BOOT_STEP_OK) {
+        s_ok_mask |= 1u << idx;
+    }
+    if (s_slots[idx].def.fn != NULL) {
+        s_fn_done++;
+    }
+
+    bool changed = state != BOOT_STEP_OK;
+    while (changed) {
+        changed = false;
+        const uint32_t bad = s_done_mask & ~s_ok_mask;
+        for (uint32_t i = 0; i < s_count; i++) {
+            boot_slot_t *slot = &s_slots[i];
+            if (slot->rec.state == BOOT_STEP_PENDING && slot->def.fn != NULL && (slot->dep_mask & bad) != 0) {
+                slot->rec.state = BOOT_STEP_SKIPPED;
+                slot->rec.end_us = now;
+                s_done_mask |= 1u << i;
+                s_fn_done++;
+                finished |= 1u << i;
+                changed = true;
+            }
+        }
+    }
+    stamp_ready_locked(now);
+    return finished;
+}
+
+static void boot_worker_task(void *arg)
+{
+    const int core = (int)(intptr_t)arg;
+
+    while (true) {
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        int pick = -1;
+        bool remaining = false;
+        for (uint32_t i = 0; i < s_count; i++) {
+            const boot_slot_t *slot = &s_slots[i];
+            if (slot->def.fn == NULL || slot->rec.state != BOOT_STEP_PENDING) {
+                continue;
+            }
+            remaining = true;
+            if ((slot->def.core == BOOT_CORE_ANY || slot->def.core == core) && (slot->dep_mask & ~s_ok_mask) == 0) {
+                pick = (int)i;
+                break;
+            }
+        }
+
+        if (pick < 0) {
+            if (!remaining) {
+                s_workers[core] = NULL;
+                const bool last = --s_workers_alive == 0;
+                xSemaphoreGive(s_lock);
+                if (last) {
+                    ESP_LOGI(TAG, "All boot steps finished in %lld ms", (esp_timer_get_time() - s_start_us) / 1000);
+                    boot_graph_report();
+                }
+                vTaskDelete(NULL);
+                return;
+            }
+            xSemaphoreGive(s_lock);
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        boot_slot_t *slot = &s_slots[pick];
+        slot->rec.state = BOOT_STEP_RUNNING;
+        slot->rec.core = (int8_t)core;
+        slot->rec.start_us = esp_timer_get_time();
+        xSemaphoreGive(s_lock);
+
+        const esp_err_t err = slot->def.fn(slot->def.arg);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Step %s failed: %s", slot->def.name, esp_err_to_name(err));
+        }
+
+        xSemaphoreTake(s_lock, portMAX_DELAY);
+        const uint32_t finished =
+            finish_locked((uint32_t)pick, err == ESP_OK ? BOOT_STEP_OK : BOOT_STEP_FAILED, err, esp_timer_get_time());
+        notify_workers_locked();
+        if (s_progress_cb != NULL) {
+            s_progress_cb(s_fn_done, s_fn_total);
+        }
+        xSemaphoreGive(s_lock);
+        xEventGroupSetBits(s_events, finished);
+    }
+}
+
+static esp_err_t ensure_sync_objects(void)
+{
+    if (s_lock == NULL) {
+        s_lock = xSemaphoreCreateMutex();
+    }
+    if (s_events == NULL) {
+        s_events = xEventGroupCreate();
+    }
+    return (s_lock != NULL && s_events != NULL) ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+esp_err_t boot_graph_add(const boot_step_t *steps, size_t count)
+{
+    if (steps == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t ret = ensure_sync_objects();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (size_t i = 0; i < count && ret == ESP_OK; i++) {
+        if (steps[i].name == NULL) {
+            ret = ESP_ERR_INVALID_ARG;
+        } else if (s_started || find_step(steps[i].name, strlen(steps[i].name)) >= 0) {
+            ret = ESP_ERR_INVALID_STATE;
+        } else if (s_count >= BOOT_GRAPH_MAX_STEPS) {
+            ret = ESP_ERR_NO_MEM;
+        } else {
+            boot_slot_t *slot = &s_slots[s_count++];
+            memset(slot, 0, sizeof(*slot));
+            slot->def = steps[i];
+            slot->rec.name = steps[i].name;
+            slot->rec.is_event = steps[i].fn == NULL;
+            slot->rec.core = -1;
+            if (slot->def.core >= portNUM_PROCESSORS) {
+                slot->def.core = BOOT_CORE_ANY;
+            }
+        }
+    }
+    xSemaphoreGive(s_lock);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to add boot steps: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+void boot_graph_set_progress_cb(boot_progress_cb_t cb)
+{
+    s_progress_cb = cb;
+}
+
+esp_err_t boot_graph_start(uint32_t stack_size, UBaseType_t priority)
+{
+    esp_err_t ret = ensure_sync_objects();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (s_started) {
+        xSemaphoreGive(s_lock);
+        return ESP_ERR_INVALID_STATE;
+    }
+    for (uint32_t i = 0; i < s_count && ret == ESP_OK; i++) {
+        ret = s_slots[i].def.fn != NULL ? resolve_deps(&s_slots[i]) : ESP_OK; // 事件不声明依赖
+    }
+    if (ret == ESP_OK && has_cycle()) {
+        ret = ESP_ERR_INVALID_STATE;
+    }
+    if (ret != ESP_OK) {
+        xSemaphoreGive(s_lock);
+        return ret;
+    }
+
+    s_fn_total = 0;
+    for (uint32_t i = 0; i < s_count; i++) {
+        s_fn_total += s_slots[i].def.fn != NULL;
+    }
+    s_started = true;
+    s_start_us = esp_timer_get_time();
+    stamp_ready_locked(s_start_us);
+
+    // 工作任务在持锁期间创建，拿到锁之前不会开始取步骤
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        char name[12] = "boot_w0";
+        name[6] = (char)('0' + core);
+        if (xTaskCreatePinnedToCore(boot_worker_task, name, stack_size, (void *)(intptr_t)core, priority,
+                                    &s_workers[core], core) == pdPASS) {
+            s_workers_alive++;
+        } else {
+            s_workers[core] = NULL;
+            ESP_LOGE(TAG, "Failed to create boot worker on core %d", core);
+        }
+    }
+    ret = s_workers_alive > 0 ? ESP_OK : ESP_ERR_NO_MEM;
+    xSemaphoreGive(s_lock);
+    ESP_LOGI(TAG, "Boot graph started: %lu steps on %lu workers", (unsigned long)s_count,
+             (unsigned long)s_workers_alive);
+    return ret;
+}
+
+esp_err_t boot_graph_signal(const char *name)
+{
+    if (name == NULL || s_lock == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    const int idx = find_step(name, strlen(name));
+    if (idx < 0 || s_slots[idx].def.fn != NULL) {
+        xSemaphoreGive(s_lock);
+        return ESP_ERR_NOT_FOUND;
+    }
+    uint32_t finished = 0;
+    if (s_slots[idx].rec.state == BOOT_STEP_PENDING) {
+        finished = finish_locked((uint32_t)idx, BOOT_STEP_OK, ESP_OK, esp_timer_get_time());
+        notify_workers_locked();
+    }
+    xSemaphoreGive(s_lock);
+    if (finished != 0) {
+        xEventGroupSetBits(s_events, finished);
+    }
+    return ESP_OK;
+}
+
+bool boot_graph_wait(const char *name, TickType_t ticks_to_wait)
+{
+    if (name == NULL || s_lock == NULL) {
+        return false;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    const int idx = find_step(name, strlen(name));
+    xSemaphoreGive(s_lock);
+    if (idx < 0) {
+        return false;
+    }
+    const EventBits_t bit = 1u << idx;
+    if (!(xEventGroupWaitBits(s_events, bit, pdFALSE, pdTRUE, ticks_to_wait) & bit)) {
+        return false;
+    }
+    return s_slots[idx].rec.state == BOOT_STEP_OK;
+}
+
+size_t boot_graph_get_records(boot_step_record_t *out, size_t max)
+{
+    if (out == NULL || s_lock == NULL) {
+        return 0;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    size_t n = 0;
+    for (; n < s_count && n < max; n++) {
+        out[n] = s_slots[n].rec;
+    }
+    xSemaphoreGive(s_lock);
+    return n;
+}
+
+static int64_t rel_ms(int64_t us)
+{
+    return us > 0 ? (us - s_start_us) / 1000 : -1;
+}
+
+void boot_graph_report(void)
+{
+    boot_step_record_t recs[BOOT_GRAPH_MAX_STEPS];
+    const size_t n = boot_graph_get_records(recs, BOOT_GRAPH_MAX_STEPS);
+    uint8_t order[BOOT_GRAPH_MAX_STEPS];
+    for (size_t i = 0; i < n; i++) {
+        order[i] = (uint8_t)i;
+    }
+    // 按开始时间排序 (事件按置位时间)，未开始的排在最后
+    for (size_t i = 1; i < n; i++) {
+        for (size_t j = i; j > 0; j--) {
+            const boot_step_record_t *a = &recs[order[j - 1]];
+            const boot_step_record_t *b = &recs[order[j]];
+            const int64_t ta = a->is_event ? a->end_us : a->start_us;
+            const int64_t tb = b->is_event ? b->end_us : b->start_us;
+            if ((ta == 0 ? INT64_MAX : ta) <= (tb == 0 ? INT64_MAX : tb)) {
+                break;
+            }
+            const uint8_t t = order[j];
+            order[j] = order[j - 1];
+            order[j - 1] = t;
+        }
+    }
+
+    ESP_LOGI(TAG, "Boot profile (ms from graph start, boot at +%lld ms):", s_start_us / 1000);
+    ESP_LOGI(TAG, "%-14s %-7s %4s %6s %6s %6s %6s", "step", "state", "core", "ready", "start", "dur", "wait");
+    for (size_t k = 0; k < n; k++) {
+        const boot_step_record_t *r = &recs[order[k]];
+        if (r->is_event) {
+            ESP_LOGI(TAG, "%-14s %-7s %4s %6s %6lld %6s %6s", r->name, r->state == BOOT_STEP_OK ? "signal" : "pending",
+                     "-", "-", rel_ms(r->end_us), "-", "-");
+            continue;
+        }
+        const bool ran = r->start_us > 0;
+        ESP_LOGI(TAG, "%-14s %-7s %4d %6lld %6lld %6lld %6lld", r->name, state_name(r->state), r->core,
+                 rel_ms(r->ready_us), rel_ms(r->start_us),
+                 ran && r->end_us > 0 ? (r->end_us - r->start_us) / 1000 : -1,
+                 ran && r->ready_us > 0 ? (r->start_us - r->ready_us) / 1000 : -1);
+    }
+
+    // 关键路径: 从最晚结束的函数步骤沿最晚结束的依赖回溯
+    int cur = -1;
+    for (size_t i = 0; i < n; i++) {
+        if (!recs[i].is_event && recs[i].end_us > 0 && (cur < 0 || recs[i].end_us > recs[cur].end_us)) {
+            cur = (int)i;
+        }
+    }
+    if (cur < 0) {
+        return;
+    }
+    char path[160];
+    size_t pos = 0;
+    path[0] = '\0';
+    const int64_t total_ms = rel_ms(recs[cur].end_us);
+    while (cur >= 0 && pos < sizeof(path) - 1) {
+        const int written = snprintf(path + pos, sizeof(path) - pos, "%s%s", pos ? " <- " : "", recs[cur].name);
+        pos += written > 0 ? (size_t)written : 0;
+        int next = -1;
+        for (size_t i = 0; i < n; i++) {
+            if ((s_slots[cur].dep_mask & (1u << i)) && (next < 0 || recs[i].end_us > recs[next].end_us)) {
+                next = (int)i;
+            }
+        }
+        cur = next;
+    }
+    ESP_LOGI(TAG, "Critical path (%lld ms): %s", total_ms, path);
+}
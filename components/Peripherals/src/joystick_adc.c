@@ -1,33 +1,225 @@
 /**
  * @file joystick_adc.c
- * @brief 使用旧版ADC API采集摇杆数据的驱动实现
+ * @brief 使用ADC连续模式 (DMA) 采集摇杆数据的驱动实现
+ *        每个 DMA 帧在完成回调中做过采样平均、定点 IIR 滤波与归一化，
+ *        结果通过顺序锁 (seqlock) 发布，读取端无需加锁
  * @author Your Name
  * @date 2024
  */
 
 #include "joystick_adc.h"
+#include "esp_adc/adc_filter.h"
 #include "esp_log.h"
-#include "driver/adc.h"
-#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
 #include "nvs_flash.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <string.h>
 
 static const char *TAG = "JOYSTICK_ADC";
 #define NVS_NAMESPACE "joystick_cal"
 #define NVS_CAL_KEY "cal_data"
 
-// 校准数据
-static joystick_cal_data_t s_cal_data;
-// 滤波后的值
-static float s_filtered_joy1_x = 0.0f;
-static float s_filtered_joy1_y = 0.0f;
+// 帧内通道槽位
+enum {
+    SLOT_JOY1_X = 0,
+    SLOT_JOY1_Y,
+    SLOT_BATTERY,
+    SLOT_NUM,
+};
+
+/**
+ * @brief 每帧发布的快照
+ */
+typedef struct {
+    joystick_data_t joystick;
+    int battery_raw;
+    bool battery_valid;
+} joystick_snapshot_t;
+
+// ADC 连续模式句柄
+static adc_continuous_handle_t s_adc_handle = NULL;
+#if SOC_ADC_DIG_IIR_FILTER_SUPPORTED
+static adc_iir_filter_handle_t s_hw_filter[2] = {NULL, NULL};
+#endif
+
+// 软件滤波器 (仅在 DMA 回调中访问)
+static joystick_filter_iir_t s_iir_x;
+static joystick_filter_iir_t s_iir_y;
+
+// 顺序锁发布的最新数据: 写端为 DMA 回调，读端为任意任务
+static joystick_snapshot_t s_snapshot;
+static atomic_uint s_snapshot_seq = 0;
+static atomic_bool s_has_snapshot = false;
+
+// 校准数据: 双缓冲，任务侧写入非活动缓冲后切换下标，DMA 回调只读活动缓冲
+static joystick_cal_data_t s_cal_bufs[2];
+static atomic_int s_cal_active = 0;
+// 校准过程中记录的最大/最小值 (回调写，任务读，用自旋锁保护)
+static joystick_cal_data_t s_cal_track;
+static portMUX_TYPE s_cal_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// 统计
+static atomic_uint s_frame_count = 0;
+static atomic_uint s_dropped_count = 0; // 缺少摇杆轴样本、未发布的帧
 
 // 状态标志
-static bool s_is_calibrating = false;
-static bool s_is_calibrated = false;
+static atomic_bool s_is_calibrating = false;
+static atomic_bool s_is_calibrated = false;
 static bool s_is_initialized = false;
 
 // 私有函数声明
-static int normalize_value(int value, joystick_axis_cal_t* cal);
+static void cal_publish(const joystick_cal_data_t *cal);
+static void cal_set_defaults(joystick_cal_data_t *cal);
+
+/**
+ * @brief 发布一帧快照 (单写者)
+ */
+static void snapshot_publish(const joystick_snapshot_t *snap) {
+    const unsigned seq = atomic_load_explicit(&s_snapshot_seq, memory_order_relaxed);
+    atomic_store_explicit(&s_snapshot_seq, seq + 1, memory_order_relaxed); // 奇数: 写入中
+    atomic_thread_fence(memory_order_release);
+    s_snapshot = *snap;
+    atomic_store_explicit(&s_snapshot_seq, seq + 2, memory_order_release);
+}
+
+/**
+ * @brief 读取一帧快照，遇到并发写入时重试
+ */
+static void snapshot_read(joystick_snapshot_t *snap) {
+    unsigned begin;
+    unsigned end;
+    do {
+        begin = atomic_load_explicit(&s_snapshot_seq, memory_order_acquire);
+        if (begin & 1U) {
+            continue;
+        }
+        *snap = s_snapshot;
+        atomic_thread_fence(memory_order_acquire);
+        end = atomic_load_explicit(&s_snapshot_seq, memory_order_relaxed);
+    } while ((begin & 1U) || begin != end);
+}
+
+/**
+ * @brief DMA 帧完成回调 (中断上下文)
+ */
+static bool on_conv_done(adc_continuous_handle_t handle, const adc_continuous_evt_data_t *edata,
+                         void *user_data) {
+    joystick_filter_acc_t acc[SLOT_NUM];
+    for (int i = 0; i < SLOT_NUM; i++) {
+        joystick_filter_acc_reset(&acc[i]);
+    }
+
+    // 1. 按通道累加整帧转换结果 (ESP32-S3 为 TYPE2 输出格式)
+    const adc_digi_output_data_t *p = (const adc_digi_output_data_t *)edata->conv_frame_buffer;
+    const uint32_t n = edata->size / SOC_ADC_DIGI_RESULT_BYTES;
+    for (uint32_t i = 0; i < n; i++) {
+        switch (p[i].type2.channel) {
+        case JOYSTICK1_ADC_X_CHANNEL:
+            joystick_filter_acc_add(&acc[SLOT_JOY1_X], p[i].type2.data);
+            break;
+        case JOYSTICK1_ADC_Y_CHANNEL:
+            joystick_filter_acc_add(&acc[SLOT_JOY1_Y], p[i].type2.data);
+            break;
+        case JOYSTICK_ADC_BATTERY_CHANNEL:
+            joystick_filter_acc_add(&acc[SLOT_BATTERY], p[i].type2.data);
+            break;
+        default:
+            break;
+        }
+    }
+
+    int avg_x;
+    int avg_y;
+    if (!joystick_filter_acc_average(&acc[SLOT_JOY1_X], &avg_x) ||
+        !joystick_filter_acc_average(&acc[SLOT_JOY1_Y], &avg_y)) {
+        atomic_fetch_add_explicit(&s_dropped_count, 1, memory_order_relaxed);
+        return false;
+    }
+
+    // 2. 帧率下的定点低通滤波
+    const int joy1_x_int = joystick_filter_iir_update(&s_iir_x, avg_x);
+    const int joy1_y_int = joystick_filter_iir_update(&s_iir_y, avg_y);
+
+    // 3. 如果在校准模式，更新最大/最小值
+    if (atomic_load_explicit(&s_is_calibrating, memory_order_relaxed)) {
+        portENTER_CRITICAL_ISR(&s_cal_lock);
+        joystick_filter_cal_track(&s_cal_track.joy1_x, joy1_x_int);
+        joystick_filter_cal_track(&s_cal_track.joy1_y, joy1_y_int);
+        portEXIT_CRITICAL_ISR(&s_cal_lock);
+    }
+
+    // 4. 计算电压并归一化
+    const joystick_cal_data_t *cal = &s_cal_bufs[atomic_load_explicit(&s_cal_active, memory_order_acquire)];
+    const bool calibrated = atomic_load_explicit(&s_is_calibrated, memory_order_relaxed);
+
+    joystick_snapshot_t snap;
+    snap.joystick.raw_joy1_x = avg_x;
+    snap.joystick.raw_joy1_y = avg_y;
+    snap.joystick.joy1_x_mv = joystick_filter_raw_to_mv(joy1_x_int);
+    snap.joystick.joy1_y_mv = joystick_filter_raw_to_mv(joy1_y_int);
+    snap.joystick.norm_joy1_x = joystick_filter_normalize(joy1_x_int, &cal->joy1_x, calibrated);
+    snap.joystick.norm_joy1_y = joystick_filter_normalize(joy1_y_int, &cal->joy1_y, calibrated);
+    snap.battery_valid = joystick_filter_acc_average(&acc[SLOT_BATTERY], &snap.battery_raw);
+    if (!snap.battery_valid) {
+        snap.battery_raw = 0;
+    }
+
+    // 5. 无锁发布
+    snapshot_publish(&snap);
+    atomic_store_explicit(&s_has_snapshot, true, memory_order_release);
+    atomic_fetch_add_explicit(&s_frame_count, 1, memory_order_relaxed);
+
+    return false;
+}
+
+#if SOC_ADC_DIG_IIR_FILTER_SUPPORTED
+/**
+ * @brief 为两个摇杆轴启用硬件 IIR 滤波
+ */
+static esp_err_t hw_filter_enable(void) {
+    const adc_channel_t channels[2] = {JOYSTICK1_ADC_X_CHANNEL, JOYSTICK1_ADC_Y_CHANNEL};
+    for (int i = 0; i < 2; i++) {
+        adc_continuous_iir_filter_config_t filter_cfg = {
+            .unit = ADC_UNIT_1,
+            .channel = channels[i],
+            .coeff = JOYSTICK_ADC_HW_IIR_COEFF,
+        };
+        esp_err_t ret = adc_new_continuous_iir_filter(s_adc_handle, &filter_cfg, &s_hw_filter[i]);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+        ret = adc_continuous_iir_filter_enable(s_hw_filter[i]);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    return ESP_OK;
+}
+
+static void hw_filter_release(void) {
+    for (int i = 0; i < 2; i++) {
+        if (s_hw_filter[i] != NULL) {
+            adc_continuous_iir_filter_disable(s_hw_filter[i]);
+            adc_del_continuous_iir_filter(s_hw_filter[i]);
+            s_hw_filter[i] = NULL;
+        }
+    }
+}
+#endif
+
+/**
+ * @brief 释放 ADC 连续模式资源
+ */
+static void adc_release(void) {
+#if SOC_ADC_DIG_IIR_FILTER_SUPPORTED
+    hw_filter_release();
+#endif
+    if (s_adc_handle != NULL) {
+        adc_continuous_deinit(s_adc_handle);
+        s_adc_handle = NULL;
+    }
+}
 
 /**
  * @brief 初始化ADC
@@ -37,34 +229,90 @@ esp_err_t joystick_adc_init(void) {
         return ESP_OK;
     }
 
-    esp_err_t ret = adc1_config_width(ADC_WIDTH_BIT_DEFAULT);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to config ADC width: %s", esp_err_to_name(ret));
-        return ret;
-    }
-
-    ret = adc1_config_channel_atten(JOYSTICK1_ADC_X_CHANNEL, JOYSTICK_ADC_ATTEN);
-    if (ret != ESP_OK) { return ret; }
-    ret = adc1_config_channel_atten(JOYSTICK1_ADC_Y_CHANNEL, JOYSTICK_ADC_ATTEN);
-    if (ret != ESP_OK) { return ret; }
-
     // 尝试从NVS加载校准数据
     if (joystick_load_calibration_from_nvs() == ESP_OK) {
         ESP_LOGI(TAG, "Successfully loaded calibration data from NVS.");
     } else {
         ESP_LOGI(TAG, "No calibration data found in NVS, using default values.");
         // 使用默认值
-        s_cal_data.joy1_x = (joystick_axis_cal_t){.min = 0, .max = 4095, .center = 2048};
-        s_cal_data.joy1_y = (joystick_axis_cal_t){.min = 0, .max = 4095, .center = 2048};
-        s_is_calibrated = false; // 明确未校准
+        joystick_cal_data_t cal;
+        cal_set_defaults(&cal);
+        cal_publish(&cal);
+        atomic_store(&s_is_calibrated, false); // 明确未校准
     }
 
     // 初始化滤波器的初始值
-    s_filtered_joy1_x = s_cal_data.joy1_x.center;
-    s_filtered_joy1_y = s_cal_data.joy1_y.center;
+    const joystick_cal_data_t *cal = &s_cal_bufs[atomic_load(&s_cal_active)];
+    const uint16_t alpha = JOYSTICK_FILTER_ALPHA_Q15(JOYSTICK_LOW_PASS_ALPHA);
+    joystick_filter_iir_init(&s_iir_x, alpha, cal->joy1_x.center);
+    joystick_filter_iir_init(&s_iir_y, alpha, cal->joy1_y.center);
+    atomic_store(&s_has_snapshot, false);
+
+    // 帧在完成回调中直接消费，不调用 adc_continuous_read；驱动缓冲池写满后由 flush_pool 自动清空
+    adc_continuous_handle_cfg_t handle_cfg = {
+        .max_store_buf_size = JOYSTICK_ADC_FRAME_SIZE * 2,
+        .conv_frame_size = JOYSTICK_ADC_FRAME_SIZE,
+        .flags.flush_pool = true,
+    };
+    esp_err_t ret = adc_continuous_new_handle(&handle_cfg, &s_adc_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create ADC continuous handle: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    const adc_channel_t channels[JOYSTICK_ADC_PATTERN_NUM] = {
+        JOYSTICK1_ADC_X_CHANNEL, JOYSTICK1_ADC_Y_CHANNEL, JOYSTICK_ADC_BATTERY_CHANNEL};
+    adc_digi_pattern_config_t pattern[JOYSTICK_ADC_PATTERN_NUM] = {0};
+    for (int i = 0; i < JOYSTICK_ADC_PATTERN_NUM; i++) {
+        pattern[i].atten = JOYSTICK_ADC_ATTEN;
+        pattern[i].channel = channels[i];
+        pattern[i].unit = ADC_UNIT_1;
+        pattern[i].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    }
+
+    adc_continuous_config_t adc_cfg = {
+        .pattern_num = JOYSTICK_ADC_PATTERN_NUM,
+        .adc_pattern = pattern,
+        .sample_freq_hz = JOYSTICK_ADC_SAMPLE_FREQ_HZ,
+        .conv_mode = ADC_CONV_SINGLE_UNIT_1,
+        .format = ADC_DIGI_OUTPUT_FORMAT_TYPE2,
+    };
+    ret = adc_continuous_config(s_adc_handle, &adc_cfg);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to config ADC continuous mode: %s", esp_err_to_name(ret));
+        adc_release();
+        return ret;
+    }
+
+#if SOC_ADC_DIG_IIR_FILTER_SUPPORTED
+    ret = hw_filter_enable();
+    if (ret != ESP_OK) {
+        // 硬件滤波只是锦上添花，失败时仅依赖软件过采样
+        ESP_LOGW(TAG, "Hardware IIR filter unavailable: %s", esp_err_to_name(ret));
+        hw_filter_release();
+    }
+#endif
+
+    adc_continuous_evt_cbs_t cbs = {
+        .on_conv_done = on_conv_done,
+    };
+    ret = adc_continuous_register_event_callbacks(s_adc_handle, &cbs, NULL);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register ADC callbacks: %s", esp_err_to_name(ret));
+        adc_release();
+        return ret;
+    }
+
+    ret = adc_continuous_start(s_adc_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start ADC continuous mode: %s", esp_err_to_name(ret));
+        adc_release();
+        return ret;
+    }
 
     s_is_initialized = true;
-    ESP_LOGI(TAG, "Joystick ADC initialized successfully.");
+    ESP_LOGI(TAG, "Joystick ADC initialized successfully (DMA %dHz, %dx oversampling).",
+             JOYSTICK_ADC_SAMPLE_FREQ_HZ, JOYSTICK_ADC_OVERSAMPLE);
     return ESP_OK;
 }
 
@@ -72,6 +320,12 @@ esp_err_t joystick_adc_init(void) {
  * @brief 反初始化ADC
  */
 esp_err_t joystick_adc_deinit(void) {
+    if (!s_is_initialized) {
+        return ESP_OK;
+    }
+    adc_continuous_stop(s_adc_handle);
+    adc_release();
+    atomic_store(&s_has_snapshot, false);
     s_is_initialized = false;
     ESP_LOGI(TAG, "Joystick ADC de-initialized.");
     return ESP_OK;
@@ -87,41 +341,63 @@ esp_err_t joystick_adc_read(joystick_data_t *data) {
     if (data == NULL) {
         return ESP_ERR_INVALID_ARG;
     }
+    if (!atomic_load_explicit(&s_has_snapshot, memory_order_acquire)) {
+        return ESP_ERR_INVALID_STATE; // 第一帧尚未完成
+    }
 
-    // 1. 读取原始值
-    data->raw_joy1_x = adc1_get_raw(JOYSTICK1_ADC_X_CHANNEL);
-    data->raw_joy1_y = adc1_get_raw(JOYSTICK1_ADC_Y_CHANNEL);
-
-    // 2. 应用低通滤波器
-    s_filtered_joy1_x = JOYSTICK_LOW_PASS_ALPHA * data->raw_joy1_x + (1.0f - JOYSTICK_LOW_PASS_ALPHA) * s_filtered_joy1_x;
-    s_filtered_joy1_y = JOYSTICK_LOW_PASS_ALPHA * data->raw_joy1_y + (1.0f - JOYSTICK_LOW_PASS_ALPHA) * s_filtered_joy1_y;
+    joystick_snapshot_t snap;
+    snapshot_read(&snap);
+    *data = snap.joystick;
+    return ESP_OK;
+}
 
-    int joy1_x_int = (int)s_filtered_joy1_x;
-    int joy1_y_int = (int)s_filtered_joy1_y;
+/**
+ * @brief 读取电池通道原始值
+ */
+esp_err_t joystick_adc_read_battery_raw(int *raw) {
+    if (raw == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_is_initialized || !atomic_load_explicit(&s_has_snapshot, memory_order_acquire)) {
+        return ESP_ERR_INVALID_STATE;
+    }
 
-    // 3. 如果在校准模式，更新最大/最小值
-    if (s_is_calibrating) {
-        if (joy1_x_int < s_cal_data.joy1_x.min) s_cal_data.joy1_x.min = joy1_x_int;
-        if (joy1_x_int > s_cal_data.joy1_x.max) s_cal_data.joy1_x.max = joy1_x_int;
-        if (joy1_y_int < s_cal_data.joy1_y.min) s_cal_data.joy1_y.min = joy1_y_int;
-        if (joy1_y_int > s_cal_data.joy1_y.max) s_cal_data.joy1_y.max = joy1_y_int;
+    joystick_snapshot_t snap;
+    snapshot_read(&snap);
+    if (!snap.battery_valid) {
+        return ESP_ERR_INVALID_STATE;
     }
+    *raw = snap.battery_raw;
+    return ESP_OK;
+}
 
-    // 4. 计算电压值 (基于滤波后的值)
-    data->joy1_x_mv = (joy1_x_int * 3300) / 4095;
-    data->joy1_y_mv = (joy1_y_int * 3300) / 4095;
-    
-    // 5. 应用校准并归一化
-    if (s_is_calibrated) {
-        data->norm_joy1_x = normalize_value(joy1_x_int, &s_cal_data.joy1_x);
-        data->norm_joy1_y = normalize_value(joy1_y_int, &s_cal_data.joy1_y);
-    } else {
-        // 如果未校准，提供一个基于默认中心点的粗略归一化
-        data->norm_joy1_x = ((joy1_x_int - 2048) * 100) / 2048;
-        data->norm_joy1_y = ((joy1_y_int - 2048) * 100) / 2048;
+/**
+ * @brief 获取帧统计
+ */
+void joystick_adc_get_frame_stats(uint32_t *frames, uint32_t *dropped) {
+    if (frames != NULL) {
+        *frames = atomic_load_explicit(&s_frame_count, memory_order_relaxed);
+    }
+    if (dropped != NULL) {
+        *dropped = atomic_load_explicit(&s_dropped_count, memory_order_relaxed);
     }
+}
 
-    return ESP_OK;
+/**
+ * @brief 默认校准数据
+ */
+static void cal_set_defaults(joystick_cal_data_t *cal) {
+    cal->joy1_x = (joystick_axis_cal_t){.min = 0, .max = JOYSTICK_FILTER_ADC_MAX, .center = JOYSTICK_FILTER_ADC_CENTER};
+    cal->joy1_y = (joystick_axis_cal_t){.min = 0, .max = JOYSTICK_FILTER_ADC_MAX, .center = JOYSTICK_FILTER_ADC_CENTER};
+}
+
+/**
+ * @brief 写入非活动缓冲并切换，DMA 回调下一帧开始使用新数据
+ */
+static void cal_publish(const joystick_cal_data_t *cal) {
+    const int next = atomic_load_explicit(&s_cal_active, memory_order_relaxed) ^ 1;
+    s_cal_bufs[next] = *cal;
+    atomic_store_explicit(&s_cal_active, next, memory_order_release);
 }
 
 /**
@@ -129,38 +405,46 @@ esp_err_t joystick_adc_read(joystick_data_t *data) {
  */
 void joystick_start_calibration(void) {
     ESP_LOGI(TAG, "Starting joystick calibration...");
-    s_is_calibrating = true;
-    s_is_calibrated = false;
 
     // 重置校准数据
-    s_cal_data.joy1_x = (joystick_axis_cal_t){.min = 4095, .max = 0, .center = 2048};
-    s_cal_data.joy1_y = (joystick_axis_cal_t){.min = 4095, .max = 0, .center = 2048};
+    portENTER_CRITICAL(&s_cal_lock);
+    s_cal_track.joy1_x = (joystick_axis_cal_t){.min = JOYSTICK_FILTER_ADC_MAX, .max = 0, .center = JOYSTICK_FILTER_ADC_CENTER};
+    s_cal_track.joy1_y = (joystick_axis_cal_t){.min = JOYSTICK_FILTER_ADC_MAX, .max = 0, .center = JOYSTICK_FILTER_ADC_CENTER};
+    portEXIT_CRITICAL(&s_cal_lock);
+
+    atomic_store(&s_is_calibrated, false);
+    atomic_store(&s_is_calibrating, true);
 }
 
 /**
  * @brief 结束校准
  */
 void joystick_stop_calibration(void) {
-    if (!s_is_calibrating) {
+    if (!atomic_exchange(&s_is_calibrating, false)) {
         return;
     }
-    s_is_calibrating = false;
-    
+
+    joystick_cal_data_t cal;
+    portENTER_CRITICAL(&s_cal_lock);
+    cal = s_cal_track;
+    portEXIT_CRITICAL(&s_cal_lock);
+
     // 简单的有效性检查
-    if (s_cal_data.joy1_x.min >= s_cal_data.joy1_x.max || s_cal_data.joy1_y.min >= s_cal_data.joy1_y.max) {
+    if (cal.joy1_x.min >= cal.joy1_x.max || cal.joy1_y.min >= cal.joy1_y.max) {
         ESP_LOGE(TAG, "Calibration failed: Invalid min/max values. Please try again.");
         joystick_load_calibration_from_nvs(); // 恢复上次的校准
         return;
     }
 
     // 计算中心点
-    s_cal_data.joy1_x.center = (s_cal_data.joy1_x.min + s_cal_data.joy1_x.max) / 2;
-    s_cal_data.joy1_y.center = (s_cal_data.joy1_y.min + s_cal_data.joy1_y.max) / 2;
-    
-    s_is_calibrated = true;
+    cal.joy1_x.center = (cal.joy1_x.min + cal.joy1_x.max) / 2;
+    cal.joy1_y.center = (cal.joy1_y.min + cal.joy1_y.max) / 2;
+
+    cal_publish(&cal);
+    atomic_store(&s_is_calibrated, true);
     ESP_LOGI(TAG, "Joystick calibration finished.");
-    ESP_LOGI(TAG, "J1X: min=%d max=%d center=%d", s_cal_data.joy1_x.min, s_cal_data.joy1_x.max, s_cal_data.joy1_x.center);
-    ESP_LOGI(TAG, "J1Y: min=%d max=%d center=%d", s_cal_data.joy1_y.min, s_cal_data.joy1_y.max, s_cal_data.joy1_y.center);
+    ESP_LOGI(TAG, "J1X: min=%d max=%d center=%d", cal.joy1_x.min, cal.joy1_x.max, cal.joy1_x.center);
+    ESP_LOGI(TAG, "J1Y: min=%d max=%d center=%d", cal.joy1_y.min, cal.joy1_y.max, cal.joy1_y.center);
     
     // 自动保存到NVS
     if (joystick_save_calibration_to_nvs() != ESP_OK) {
@@ -174,31 +458,9 @@ void joystick_stop_calibration(void) {
  * @brief 检查是否已校准
  */
 bool joystick_is_calibrated(void) {
-    return s_is_calibrated;
+    return atomic_load(&s_is_calibrated);
 }
 
-/**
- * @brief 归一化处理函数
- */
-static int normalize_value(int value, joystick_axis_cal_t* cal) {
-    int dead_zone = 50; // 中心死区范围
-    if (value > cal->center - dead_zone && value < cal->center + dead_zone) {
-        return 0;
-    }
-
-    long result;
-    if (value > cal->center) {
-        result = (long)(value - cal->center) * 100 / (cal->max - cal->center);
-    } else {
-        result = (long)(value - cal->center) * 100 / (cal->center - cal->min);
-    }
-    
-    if (result > 100) return 100;
-    if (result < -100) return -100;
-    
-    return (int)result;
-} 
-
 /**
  * @brief 从NVS加载校准数据
  */
@@ -215,17 +477,19 @@ esp_err_t joystick_load_calibration_from_nvs(void) {
         return err;
     }
 
-    size_t required_size = sizeof(s_cal_data);
-    err = nvs_get_blob(nvs_handle, NVS_CAL_KEY, &s_cal_data, &required_size);
-    if (err == ESP_OK && required_size == sizeof(s_cal_data)) {
-        s_is_calibrated = true;
+    joystick_cal_data_t cal;
+    size_t required_size = sizeof(cal);
+    err = nvs_get_blob(nvs_handle, NVS_CAL_KEY, &cal, &required_size);
+    if (err == ESP_OK && required_size == sizeof(cal)) {
+        cal_publish(&cal);
+        atomic_store(&s_is_calibrated, true);
     } else {
         if (err == ESP_ERR_NVS_NOT_FOUND) {
             ESP_LOGI(TAG, "Calibration data blob '%s' not found in namespace '%s'.", NVS_CAL_KEY, NVS_NAMESPACE);
         } else {
             ESP_LOGE(TAG, "Error (%s) reading NVS!", esp_err_to_name(err));
         }
-        s_is_calibrated = false;
+        atomic_store(&s_is_calibrated, false);
     }
 
     nvs_close(nvs_handle);
@@ -236,7 +500,7 @@ esp_err_t joystick_load_calibration_from_nvs(void) {
  * @brief 将当前校准数据保存到NVS
  */
 esp_err_t joystick_save_calibration_to_nvs(void) {
-    if (!s_is_calibrated) {
+    if (!atomic_load(&s_is_calibrated)) {
         return ESP_ERR_INVALID_STATE;
     }
     
@@ -247,7 +511,8 @@ esp_err_t joystick_save_calibration_to_nvs(void) {
         return err;
     }
     
-    err = nvs_set_blob(nvs_handle, NVS_CAL_KEY, &s_cal_data, sizeof(s_cal_data));
+    const joystick_cal_data_t *cal = &s_cal_bufs[atomic_load(&s_cal_active)];
+    err = nvs_set_blob(nvs_handle, NVS_CAL_KEY, cal, sizeof(*cal));
     if (err == ESP_OK) {
         err = nvs_commit(nvs_handle);
     } else {
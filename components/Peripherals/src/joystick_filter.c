@@ -0,0 +1,64 @@
+/**
+ * @file joystick_filter.c
+ * @brief 摇杆定点滤波与归一化实现
+ * @author Your Name
+ * @date 2024
+ */
+
+#include "joystick_filter.h"
+
+bool joystick_filter_acc_average(const joystick_filter_acc_t* acc, int* avg) {
+    if (acc->count == 0) {
+        return false;
+    }
+    *avg = (int)((acc->sum + acc->count / 2) / acc->count);
+    return true;
+}
+
+void joystick_filter_iir_init(joystick_filter_iir_t* iir, uint16_t alpha_q15, int initial) {
+    if (alpha_q15 == 0) {
+        alpha_q15 = 1; // alpha 为 0 时输出永远不变
+    }
+    iir->alpha_q15 = alpha_q15;
+    iir->state = (int32_t)initial << JOYSTICK_FILTER_STATE_SHIFT;
+}
+
+int joystick_filter_iir_update(joystick_filter_iir_t* iir, int sample) {
+    const int32_t target = (int32_t)sample << JOYSTICK_FILTER_STATE_SHIFT;
+    // 差值最大 2^20，乘以 Q15 系数需要 64 位中间结果
+    const int64_t step = ((int64_t)(target - iir->state) * iir->alpha_q15) >> JOYSTICK_FILTER_ALPHA_SHIFT;
+    iir->state += (int32_t)step;
+
+    // 四舍五入回整数
+    return (int)((iir->state + (1 << (JOYSTICK_FILTER_STATE_SHIFT - 1))) >> JOYSTICK_FILTER_STATE_SHIFT);
+}
+
+int joystick_filter_normalize(int value, const joystick_axis_cal_t* cal, bool calibrated) {
+    if (!calibrated) {
+        // 如果未校准，提供一个基于默认中心点的粗略归一化
+        return ((value - JOYSTICK_FILTER_ADC_CENTER) * JOYSTICK_FILTER_NORM_MAX) / JOYSTICK_FILTER_ADC_CENTER;
+    }
+
+    if (value > cal->center - JOYSTICK_FILTER_DEAD_ZONE && value < cal->center + JOYSTICK_FILTER_DEAD_ZONE) {
+        return 0;
+    }
+
+    int32_t result;
+    if (value > cal->center) {
+        const int span = cal->max - cal->center;
+        result = span > 0 ? (int32_t)(value - cal->center) * JOYSTICK_FILTER_NORM_MAX / span
+                          : JOYSTICK_FILTER_NORM_MAX;
+    } else {
+        const int span = cal->center - cal->min;
+        result = span > 0 ? (int32_t)(value - cal->center) * JOYSTICK_FILTER_NORM_MAX / span
+                          : -JOYSTICK_FILTER_NORM_MAX;
+    }
+
+    if (result > JOYSTICK_FILTER_NORM_MAX) {
+        return JOYSTICK_FILTER_NORM_MAX;
+    }
+    if (result < -JOYSTICK_FILTER_NORM_MAX) {
+        return -JOYSTICK_FILTER_NORM_MAX;
+    }
+    return (int)result;
+}
@@ -7,6 +7,7 @@
 
 #include "lsm6ds3.h"
 #include "bsp_i2c.h" // 包含新的I2C头文件
+#include "esp_attr.h"
 #include "esp_err.h"
 #include "esp_log.h"
 #include "esp_timer.h"
@@ -29,6 +30,24 @@ static FusionOffset s_offset;      // Fusion 零漂补偿算法
 static bool s_ahrs_inited = false; // AHRS 是否已初始化
 static int64_t s_last_time_us = 0; // 上次更新时间 (us)
 
+// FIFO 模式状态
+static bool s_fifo_enabled = false;             // FIFO 是否已启用
+static lsm6ds3_fifo_config_t s_fifo_config;     // 当前 FIFO 配置
+static float s_fifo_delta_time = 0.0f;          // 每个样本的 deltaTime (s) = 1/ODR
+static volatile TaskHandle_t s_fifo_waiter;     // 等待水位线中断的任务
+static lsm6ds3_fifo_stats_t s_fifo_stats;       // FIFO 统计
+static lsm6ds3_fifo_raw_sample_t s_fifo_samples[LSM6DS3_FIFO_MAX_BURST_SAMPLES];
+static FusionVector s_fifo_gyro[LSM6DS3_FIFO_MAX_BURST_SAMPLES];  // 陀螺仪 (dps)
+static FusionVector s_fifo_accel[LSM6DS3_FIFO_MAX_BURST_SAMPLES]; // 加速度计 (g)
+static float s_fifo_timestamps[LSM6DS3_FIFO_MAX_BURST_SAMPLES];   // 样本时间戳 (s)
+// 突发读取缓冲区：最多 LSM6DS3_FIFO_MAX_BURST_SAMPLES 个样本 + 对齐时丢弃的不完整样本
+static DMA_ATTR uint8_t
+    s_fifo_buf[(LSM6DS3_FIFO_MAX_BURST_SAMPLES + 1) * LSM6DS3_FIFO_BYTES_PER_SAMPLE];
+
+// 用户校准 (calibration_manager.c)
+extern esp_err_t apply_gyroscope_calibration(float* gyro_x, float* gyro_y, float* gyro_z);
+extern esp_err_t apply_accelerometer_calibration(float* accel_x, float* accel_y, float* accel_z);
+
 // I2C设备地址
 #define LSM6DS3_I2C_ADDR 0x6A     // 默认I2C地址 (SDO=GND)
 #define LSM6DS3_I2C_ADDR_ALT 0x6B // 备用I2C地址 (SDO=VDD)
@@ -43,10 +62,16 @@ static esp_err_t lsm6ds3_write_reg(uint8_t reg, uint8_t data);
 static esp_err_t lsm6ds3_read_reg_i2c(uint8_t reg, uint8_t* data, size_t len);
 static esp_err_t lsm6ds3_write_reg_i2c(uint8_t reg, uint8_t data);
 static esp_err_t lsm6ds3_read_reg_spi(uint8_t reg, uint8_t* data, size_t len);
+static esp_err_t lsm6ds3_read_burst_spi(uint8_t reg, uint8_t* data, size_t len);
+static esp_err_t lsm6ds3_read_burst(uint8_t reg, uint8_t* data, size_t len);
 static esp_err_t lsm6ds3_write_reg_spi(uint8_t reg, uint8_t data);
 static float lsm6ds3_convert_accel_raw_to_g(int16_t raw, uint8_t fs);
 static float lsm6ds3_convert_gyro_raw_to_dps(int16_t raw, uint8_t fs);
 static float lsm6ds3_convert_temp_raw_to_celsius(int16_t raw);
+static void lsm6ds3_ahrs_setup(uint32_t sample_rate);
+static void lsm6ds3_fuse_sample(float gx, float gy, float gz, float ax, float ay, float az,
+                                float delta_time);
+static void lsm6ds3_get_euler(lsm6ds3_euler_t* euler);
 
 // ========================================
 // I2C通信函数
@@ -181,6 +206,28 @@ static esp_err_t lsm6ds3_read_reg_spi(uint8_t reg, uint8_t* data, size_t len) {
     return ret;
 }
 
+/**
+ * @brief SPI突发读取 (地址相位单独发送，数据直接DMA到目标缓冲区)
+ */
+static esp_err_t lsm6ds3_read_burst_spi(uint8_t reg, uint8_t* data, size_t len) {
+    esp_err_t ret;
+    spi_transaction_ext_t trans = {0};
+
+    trans.base.flags = SPI_TRANS_VARIABLE_ADDR;
+    trans.base.addr = reg | 0x80;
+    trans.base.length = len * 8;
+    trans.base.rxlength = len * 8;
+    trans.base.rx_buffer = data;
+    trans.address_bits = 8;
+
+    ret = spi_device_transmit(g_lsm6ds3_handle.spi_handle, (spi_transaction_t*)&trans);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "SPI burst read failed: %s", esp_err_to_name(ret));
+    }
+
+    return ret;
+}
+
 /**
  * @brief SPI写入寄存器
  */
@@ -218,6 +265,17 @@ static esp_err_t lsm6ds3_read_reg(uint8_t reg, uint8_t* data, size_t len) {
 #endif
 }
 
+/**
+ * @brief 突发读取 (一次总线事务读取任意长度，用于 FIFO)
+ */
+static esp_err_t lsm6ds3_read_burst(uint8_t reg, uint8_t* data, size_t len) {
+#if LSM6DS3_USE_I2C
+    return lsm6ds3_read_reg_i2c(reg, data, len);
+#else
+    return lsm6ds3_read_burst_spi(reg, data, len);
+#endif
+}
+
 /**
  * @brief 写入寄存器
  */
@@ -293,6 +351,79 @@ static float lsm6ds3_convert_temp_raw_to_celsius(int16_t raw) {
     return (float)raw / 256.0f + 25.0f;
 }
 
+// ========================================
+// Fusion AHRS
+// ========================================
+
+/**
+ * @brief 按实际采样率初始化 AHRS 和零漂补偿
+ */
+static void lsm6ds3_ahrs_setup(uint32_t sample_rate) {
+    FusionAhrsInitialise(&s_ahrs);
+
+    // 配置 AHRS 参数以提高精度和减少漂移
+    const FusionAhrsSettings settings = {
+        .convention = FusionConventionNwu,           // 坐标系：北-西-上
+        .gain = 1.0f,                                // 增益：提高到 1.0，更信任加速度计（减少漂移）
+        .gyroscopeRange = 250.0f,                    // 陀螺仪量程 (dps)
+        .accelerationRejection = 20.0f,              // 提高到 20g，更容忍快速运动
+        .magneticRejection = 0.0f,                   // 磁力拒绝（无磁力计时设为0）
+        .recoveryTriggerPeriod = 5 * sample_rate,    // 5秒（按实际更新频率）
+    };
+    FusionAhrsSetSettings(&s_ahrs, &settings);
+
+    // 初始化零漂补偿算法（这是减少零漂的关键！）
+    FusionOffsetInitialise(&s_offset, sample_rate);
+
+    s_ahrs_inited = true;
+    s_last_time_us = esp_timer_get_time();
+}
+
+/**
+ * @brief 将一个样本 (dps / g) 送入 AHRS，包含用户校准和零漂补偿
+ */
+static void lsm6ds3_fuse_sample(float gx, float gy, float gz, float ax, float ay, float az,
+                                float delta_time) {
+    // 【重要】应用用户校准（如果已校准）
+    // 注意：这些函数内部会检查是否已校准，未校准时不修改数据
+    apply_gyroscope_calibration(&gx, &gy, &gz);
+    apply_accelerometer_calibration(&ax, &ay, &az);
+
+    // 封装为 Fusion 向量（单位：陀螺仪 dps，加速度 g）
+    FusionVector gyroscope = {.axis = {gx, gy, gz}};
+    const FusionVector accelerometer = {.axis = {ax, ay, az}};
+
+    // 【关键】应用零漂补偿算法 - 动态修正陀螺仪零漂
+    gyroscope = FusionOffsetUpdate(&s_offset, gyroscope);
+
+    // 无磁力计更新
+    FusionAhrsUpdateNoMagnetometer(&s_ahrs, gyroscope, accelerometer, delta_time);
+}
+
+/**
+ * @brief 提取欧拉角（单位：度）
+ */
+static void lsm6ds3_get_euler(lsm6ds3_euler_t* euler) {
+    const FusionEuler fe = FusionQuaternionToEuler(FusionAhrsGetQuaternion(&s_ahrs));
+    euler->roll = fe.angle.roll;
+    euler->pitch = fe.angle.pitch;
+    euler->yaw = fe.angle.yaw; // 无磁力计时航向会缓慢漂移
+}
+
+/**
+ * @brief INT1 水位线中断处理，唤醒等待的任务
+ */
+static void IRAM_ATTR lsm6ds3_int1_isr_handler(void* arg) {
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    TaskHandle_t waiter = s_fifo_waiter;
+    if (waiter != NULL) {
+        vTaskNotifyGiveFromISR(waiter, &higher_priority_task_woken);
+    }
+    if (higher_priority_task_woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
 // ========================================
 // 公共函数实现
 // ========================================
@@ -376,26 +507,9 @@ esp_err_t lsm6ds3_init(void) {
     g_lsm6ds3_handle.is_initialized = true;
     ESP_LOGI(TAG, "LSM6DS3 initialized successfully with 416Hz ODR");
 
-    // 初始化 Fusion AHRS
-    FusionAhrsInitialise(&s_ahrs);
-    
-    // 配置 AHRS 参数以提高精度和减少漂移
-    const FusionAhrsSettings settings = {
-        .convention = FusionConventionNwu,           // 坐标系：北-西-上
-        .gain = 1.0f,                                 // 增益：提高到 1.0，更信任加速度计（减少漂移）
-        .gyroscopeRange = 250.0f,                     // 陀螺仪量程 (dps)
-        .accelerationRejection = 20.0f,               // 提高到 20g，更容忍快速运动
-        .magneticRejection = 0.0f,                    // 磁力拒绝（无磁力计时设为0）
-        .recoveryTriggerPeriod = 5 * 50,              // 5秒 @ 50Hz（实际更新频率）
-    };
-    FusionAhrsSetSettings(&s_ahrs, &settings);
-    
-    // 初始化零漂补偿算法（这是减少零漂的关键！）
-    FusionOffsetInitialise(&s_offset, 50);  // 实际采样率 50Hz（lsm6ds_control 以 50Hz 调用）
-    
-    s_ahrs_inited = true;
-    s_last_time_us = esp_timer_get_time();
-    
+    // 初始化 Fusion AHRS（轮询模式下 lsm6ds_control 以 50Hz 调用，启用 FIFO 后按 ODR 重新初始化）
+    lsm6ds3_ahrs_setup(50);
+
     ESP_LOGI(TAG, "Fusion AHRS and Offset initialized with optimized settings");
 
     return ESP_OK;
@@ -409,6 +523,10 @@ esp_err_t lsm6ds3_deinit(void) {
         return ESP_OK;
     }
 
+    if (s_fifo_enabled) {
+        lsm6ds3_fifo_disable();
+    }
+
     // 禁用传感器
     lsm6ds3_accel_enable(false);
     lsm6ds3_gyro_enable(false);
@@ -663,19 +781,7 @@ esp_err_t lsm6ds3_read_euler(lsm6ds3_euler_t* euler) {
 
     // 若 AHRS 未初始化则初始化一次
     if (!s_ahrs_inited) {
-        FusionAhrsInitialise(&s_ahrs);
-        const FusionAhrsSettings settings = {
-            .convention = FusionConventionNwu,
-            .gain = 1.0f,
-            .gyroscopeRange = 250.0f,
-            .accelerationRejection = 20.0f,
-            .magneticRejection = 0.0f,
-            .recoveryTriggerPeriod = 5 * 50,
-        };
-        FusionAhrsSetSettings(&s_ahrs, &settings);
-        FusionOffsetInitialise(&s_offset, 50);
-        s_ahrs_inited = true;
-        s_last_time_us = esp_timer_get_time();
+        lsm6ds3_ahrs_setup(50);
     }
 
     // 读取一次传感器
@@ -693,33 +799,280 @@ esp_err_t lsm6ds3_read_euler(lsm6ds3_euler_t* euler) {
     }
     s_last_time_us = now_us;
 
-    // 【重要】应用用户校准（如果已校准）
-    // 注意：这些函数内部会检查是否已校准，未校准时不修改数据
-    extern esp_err_t apply_gyroscope_calibration(float *gyro_x, float *gyro_y, float *gyro_z);
-    extern esp_err_t apply_accelerometer_calibration(float *accel_x, float *accel_y, float *accel_z);
-    
-    apply_gyroscope_calibration(&data.gyro.x, &data.gyro.y, &data.gyro.z);
-    apply_accelerometer_calibration(&data.accel.x, &data.accel.y, &data.accel.z);
+    lsm6ds3_fuse_sample(data.gyro.x, data.gyro.y, data.gyro.z, data.accel.x, data.accel.y,
+                        data.accel.z, deltaTime);
+    lsm6ds3_get_euler(euler);
 
-    // 封装为 Fusion 向量（单位：陀螺仪 dps，加速度 g）
-    FusionVector gyroscope = {.axis = {data.gyro.x, data.gyro.y, data.gyro.z}};
-    const FusionVector accelerometer = {.axis = {data.accel.x, data.accel.y, data.accel.z}};
+    return ESP_OK;
+}
 
-    // 【关键】应用零漂补偿算法 - 动态修正陀螺仪零漂
-    gyroscope = FusionOffsetUpdate(&s_offset, gyroscope);
+// ========================================
+// FIFO 模式
+// ========================================
 
-    // 无磁力计更新
-    FusionAhrsUpdateNoMagnetometer(&s_ahrs, gyroscope, accelerometer, deltaTime);
+/**
+ * @brief 启用FIFO连续模式
+ */
+esp_err_t lsm6ds3_fifo_enable(const lsm6ds3_fifo_config_t* config) {
+    esp_err_t ret;
+    uint8_t reg;
 
-    // 提取欧拉角（单位：度）
-    const FusionEuler fe = FusionQuaternionToEuler(FusionAhrsGetQuaternion(&s_ahrs));
-    euler->roll = fe.angle.roll;
-    euler->pitch = fe.angle.pitch;
-    euler->yaw = fe.angle.yaw; // 无磁力计时航向会缓慢漂移
+    if (!g_lsm6ds3_handle.is_initialized) {
+        ESP_LOGE(TAG, "LSM6DS3 not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    lsm6ds3_fifo_config_t cfg = {
+        .odr = LSM6DS3_ODR_416_HZ,
+        .watermark = LSM6DS3_FIFO_DEFAULT_WATERMARK,
+        .int1_pin = LSM6DS3_INT1_PIN,
+    };
+    if (config != NULL) {
+        cfg = *config;
+    }
+
+    const float odr_hz = lsm6ds3_fifo_odr_to_hz(cfg.odr);
+    if (odr_hz <= 0.0f) {
+        ESP_LOGE(TAG, "Invalid FIFO ODR: 0x%02X", cfg.odr);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // 水位线不能超过单次突发读取的容量，否则每次都会残留数据
+    if (cfg.watermark == 0) {
+        cfg.watermark = 1;
+    } else if (cfg.watermark > LSM6DS3_FIFO_MAX_BURST_SAMPLES) {
+        cfg.watermark = LSM6DS3_FIFO_MAX_BURST_SAMPLES;
+    }
+    const uint16_t watermark_words = cfg.watermark * LSM6DS3_FIFO_WORDS_PER_SAMPLE;
+
+    // 先切到 Bypass 模式清空 FIFO
+    ret = lsm6ds3_write_reg(LSM6DS3_REG_FIFO_CTRL5, LSM6DS3_FIFO_MODE_BYPASS);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // 传感器 ODR 与 FIFO ODR 保持一致
+    ret = lsm6ds3_config_accel(cfg.odr, g_lsm6ds3_handle.accel_fs);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = lsm6ds3_config_gyro(cfg.odr, g_lsm6ds3_handle.gyro_fs);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // 水位线 (单位: 字)
+    ret = lsm6ds3_write_reg(LSM6DS3_REG_FIFO_CTRL1, watermark_words & 0xFF);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = lsm6ds3_read_reg(LSM6DS3_REG_FIFO_CTRL2, &reg, 1);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    reg &= ~LSM6DS3_FIFO_CTRL2_FTH_MASK;
+    reg |= (watermark_words >> 8) & LSM6DS3_FIFO_CTRL2_FTH_MASK;
+    ret = lsm6ds3_write_reg(LSM6DS3_REG_FIFO_CTRL2, reg);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // 陀螺仪和加速度计均不抽取，不使用第三/第四数据集
+    ret = lsm6ds3_write_reg(LSM6DS3_REG_FIFO_CTRL3,
+                            LSM6DS3_FIFO_CTRL3_DEC_GYRO_NONE | LSM6DS3_FIFO_CTRL3_DEC_XL_NONE);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    ret = lsm6ds3_write_reg(LSM6DS3_REG_FIFO_CTRL4, 0x00);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // 水位线中断输出到 INT1
+    if (cfg.int1_pin >= 0) {
+        gpio_config_t io_conf = {
+            .pin_bit_mask = (1ULL << cfg.int1_pin),
+            .mode = GPIO_MODE_INPUT,
+            .pull_up_en = GPIO_PULLUP_DISABLE,
+            .pull_down_en = GPIO_PULLDOWN_ENABLE,
+            .intr_type = GPIO_INTR_POSEDGE,
+        };
+        ret = gpio_config(&io_conf);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "INT1 GPIO config failed: %s", esp_err_to_name(ret));
+            return ret;
+        }
+        gpio_install_isr_service(0); // 可能已被其他驱动安装
+        ret = gpio_isr_handler_add(cfg.int1_pin, lsm6ds3_int1_isr_handler, NULL);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "INT1 ISR add failed: %s", esp_err_to_name(ret));
+            return ret;
+        }
+        ret = lsm6ds3_write_reg(LSM6DS3_REG_INT1_CTRL, LSM6DS3_INT1_CTRL_FTH);
+        if (ret != ESP_OK) {
+            gpio_isr_handler_remove(cfg.int1_pin);
+            return ret;
+        }
+    }
 
+    // 连续模式：FIFO 满后覆盖最旧数据
+    ret = lsm6ds3_write_reg(LSM6DS3_REG_FIFO_CTRL5, ((cfg.odr >> 1) & LSM6DS3_FIFO_CTRL5_ODR_MASK) |
+                                                        LSM6DS3_FIFO_MODE_CONTINUOUS);
+    if (ret != ESP_OK) {
+        if (cfg.int1_pin >= 0) {
+            gpio_isr_handler_remove(cfg.int1_pin);
+        }
+        return ret;
+    }
+
+    // AHRS 按 FIFO ODR 运行
+    lsm6ds3_ahrs_setup((uint32_t)odr_hz);
+
+    s_fifo_config = cfg;
+    s_fifo_delta_time = 1.0f / odr_hz;
+    memset(&s_fifo_stats, 0, sizeof(s_fifo_stats));
+    s_fifo_enabled = true;
+
+    ESP_LOGI(TAG, "FIFO enabled: ODR=%.0fHz, watermark=%u samples, trigger=%s", odr_hz,
+             cfg.watermark, cfg.int1_pin >= 0 ? "INT1" : "timer");
     return ESP_OK;
 }
 
+/**
+ * @brief 关闭FIFO
+ */
+esp_err_t lsm6ds3_fifo_disable(void) {
+    if (!s_fifo_enabled) {
+        return ESP_OK;
+    }
+
+    if (s_fifo_config.int1_pin >= 0) {
+        lsm6ds3_write_reg(LSM6DS3_REG_INT1_CTRL, 0x00);
+        gpio_isr_handler_remove(s_fifo_config.int1_pin);
+    }
+    s_fifo_enabled = false;
+    s_fifo_waiter = NULL;
+
+    esp_err_t ret = lsm6ds3_write_reg(LSM6DS3_REG_FIFO_CTRL5, LSM6DS3_FIFO_MODE_BYPASS);
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "FIFO disabled");
+    }
+    return ret;
+}
+
+/**
+ * @brief 等待FIFO达到水位线
+ */
+esp_err_t lsm6ds3_fifo_wait(uint32_t timeout_ms) {
+    if (!s_fifo_enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (s_fifo_config.int1_pin >= 0) {
+        s_fifo_waiter = xTaskGetCurrentTaskHandle();
+        if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout_ms)) == 0) {
+            return ESP_ERR_TIMEOUT;
+        }
+        return ESP_OK;
+    }
+
+    // 无中断引脚：按水位线对应的时长定时读取
+    const uint32_t period_ms = (uint32_t)(s_fifo_config.watermark * s_fifo_delta_time * 1000.0f);
+    const TickType_t period = pdMS_TO_TICKS(period_ms);
+    vTaskDelay(period > 0 ? period : 1);
+    return ESP_OK;
+}
+
+/**
+ * @brief 突发读取FIFO并逐样本解算
+ */
+esp_err_t lsm6ds3_fifo_read_euler(lsm6ds3_euler_t* euler, size_t* samples) {
+    esp_err_t ret;
+    uint8_t status_regs[4];
+    lsm6ds3_fifo_status_t status;
+
+    if (samples != NULL) {
+        *samples = 0;
+    }
+    if (!g_lsm6ds3_handle.is_initialized || !euler) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_fifo_enabled) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // 读取 FIFO_STATUS1..4 (未读字数 + 模式位置)
+    ret = lsm6ds3_read_reg(LSM6DS3_REG_FIFO_STATUS1, status_regs, sizeof(status_regs));
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    lsm6ds3_fifo_parse_status(status_regs, &status);
+
+    if (status.overrun) {
+        s_fifo_stats.overruns++;
+        ESP_LOGW(TAG, "FIFO overrun (%lu), samples lost", (unsigned long)s_fifo_stats.overruns);
+    }
+
+    const size_t len = lsm6ds3_fifo_burst_len(&status, LSM6DS3_FIFO_MAX_BURST_SAMPLES);
+    if (len == 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    // 一次总线事务读出全部数据 (IF_INC 下地址在 FIFO_DATA_OUT_L/H 之间自动回绕)
+    ret = lsm6ds3_read_burst(LSM6DS3_REG_FIFO_DATA_OUT_L, s_fifo_buf, len);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    const size_t count = lsm6ds3_fifo_decode(s_fifo_buf, len, status.pattern, s_fifo_samples,
+                                             LSM6DS3_FIFO_MAX_BURST_SAMPLES);
+    const uint8_t accel_fs = g_lsm6ds3_handle.accel_fs;
+    const uint8_t gyro_fs = g_lsm6ds3_handle.gyro_fs;
+
+    // 转换单位并应用用户校准，样本时间戳按 1/ODR 递增 (相对本批次起点)
+    for (size_t i = 0; i < count; i++) {
+        const lsm6ds3_fifo_raw_sample_t* s = &s_fifo_samples[i];
+        FusionVector* g = &s_fifo_gyro[i];
+        FusionVector* a = &s_fifo_accel[i];
+        for (int axis = 0; axis < 3; axis++) {
+            g->array[axis] = lsm6ds3_convert_gyro_raw_to_dps(s->gyro[axis], gyro_fs);
+            a->array[axis] = lsm6ds3_convert_accel_raw_to_g(s->accel[axis], accel_fs);
+        }
+        apply_gyroscope_calibration(&g->axis.x, &g->axis.y, &g->axis.z);
+        apply_accelerometer_calibration(&a->axis.x, &a->axis.y, &a->axis.z);
+        s_fifo_timestamps[i] = (float)(i + 1) * s_fifo_delta_time;
+    }
+
+    // 批量送入 AHRS (含零漂补偿)
+    float previous_timestamp = 0.0f;
+    FusionAhrsUpdateNoMagnetometerBatch(&s_ahrs, &s_offset, s_fifo_gyro, s_fifo_accel,
+                                        s_fifo_timestamps, count, &previous_timestamp);
+    s_last_time_us = esp_timer_get_time();
+
+    s_fifo_stats.bursts++;
+    s_fifo_stats.samples += count;
+    s_fifo_stats.last_burst_size = count;
+    if (samples != NULL) {
+        *samples = count;
+    }
+
+    if (count == 0) {
+        return ESP_ERR_NOT_FOUND; // 仅丢弃了不完整样本
+    }
+
+    lsm6ds3_get_euler(euler);
+    return ESP_OK;
+}
+
+/**
+ * @brief 获取FIFO运行统计
+ */
+void lsm6ds3_fifo_get_stats(lsm6ds3_fifo_stats_t* stats) {
+    if (stats != NULL) {
+        *stats = s_fifo_stats;
+    }
+}
+
 /**
  * @brief 启用/禁用加速度计
  */
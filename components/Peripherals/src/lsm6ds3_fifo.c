@@ -0,0 +1,96 @@
+/**
+ * @file lsm6ds3_fifo.c
+ * @brief LSM6DS3 FIFO 数据解码实现
+ * @author Your Name
+ * @date 2024
+ */
+
+#include "lsm6ds3_fifo.h"
+
+/**
+ * @brief 计算对齐到下一个完整样本需要丢弃的字数
+ */
+static size_t lsm6ds3_fifo_skip_words(uint16_t pattern) {
+    pattern %= LSM6DS3_FIFO_WORDS_PER_SAMPLE;
+    return pattern == 0 ? 0 : (size_t)(LSM6DS3_FIFO_WORDS_PER_SAMPLE - pattern);
+}
+
+void lsm6ds3_fifo_parse_status(const uint8_t regs[4], lsm6ds3_fifo_status_t* status) {
+    status->unread_words =
+        (uint16_t)(((regs[1] & LSM6DS3_FIFO_STATUS2_DIFF_MASK) << 8) | regs[0]);
+    status->pattern =
+        (uint16_t)(((regs[3] & LSM6DS3_FIFO_STATUS4_PATTERN_MASK) << 8) | regs[2]);
+    status->watermark = (regs[1] & LSM6DS3_FIFO_STATUS2_FTH) != 0;
+    status->overrun = (regs[1] & LSM6DS3_FIFO_STATUS2_OVER_RUN) != 0;
+    status->full = (regs[1] & LSM6DS3_FIFO_STATUS2_FULL) != 0;
+    status->empty = (regs[1] & LSM6DS3_FIFO_STATUS2_EMPTY) != 0;
+}
+
+size_t lsm6ds3_fifo_burst_len(const lsm6ds3_fifo_status_t* status, size_t max_samples) {
+    if (status->empty || status->unread_words == 0) {
+        return 0;
+    }
+
+    const size_t skip = lsm6ds3_fifo_skip_words(status->pattern);
+    if (status->unread_words < skip) {
+        return 0; // 不完整样本尚未写满，下次再读
+    }
+
+    size_t samples = (status->unread_words - skip) / LSM6DS3_FIFO_WORDS_PER_SAMPLE;
+    if (samples > max_samples) {
+        samples = max_samples;
+    }
+
+    return (skip + samples * LSM6DS3_FIFO_WORDS_PER_SAMPLE) * LSM6DS3_FIFO_BYTES_PER_WORD;
+}
+
+size_t lsm6ds3_fifo_decode(const uint8_t* buf, size_t len, uint16_t start_pattern,
+                           lsm6ds3_fifo_raw_sample_t* samples, size_t max_samples) {
+    const size_t skip_bytes = lsm6ds3_fifo_skip_words(start_pattern) * LSM6DS3_FIFO_BYTES_PER_WORD;
+    if (buf == NULL || samples == NULL || len <= skip_bytes) {
+        return 0;
+    }
+
+    const uint8_t* p = buf + skip_bytes;
+    size_t count = (len - skip_bytes) / LSM6DS3_FIFO_BYTES_PER_SAMPLE;
+    if (count > max_samples) {
+        count = max_samples;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        for (int axis = 0; axis < 3; axis++) {
+            samples[i].gyro[axis] = (int16_t)(p[2 * axis + 1] << 8 | p[2 * axis]);
+            samples[i].accel[axis] = (int16_t)(p[2 * axis + 7] << 8 | p[2 * axis + 6]);
+        }
+        p += LSM6DS3_FIFO_BYTES_PER_SAMPLE;
+    }
+
+    return count;
+}
+
+float lsm6ds3_fifo_odr_to_hz(uint8_t odr) {
+    switch (odr & 0xF0) {
+    case 0x10:
+        return 12.5f;
+    case 0x20:
+        return 26.0f;
+    case 0x30:
+        return 52.0f;
+    case 0x40:
+        return 104.0f;
+    case 0x50:
+        return 208.0f;
+    case 0x60:
+        return 416.0f;
+    case 0x70:
+        return 833.0f;
+    case 0x80:
+        return 1660.0f;
+    case 0x90:
+        return 3330.0f;
+    case 0xA0:
+        return 6660.0f;
+    default:
+        return 0.0f;
+    }
+}
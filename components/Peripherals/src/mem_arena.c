@@ -0,0 +1,245 @@
+/**
+ * @file mem_arena.c
+ * @brief 子系统内存区 - 线性区与定长块池
+ */
+
+#include "mem_arena.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+static const char *TAG = "MEM_ARENA";
+
+static mem_arena_info_t *s_head = NULL;
+
+static inline uint32_t align_up(uint32_t v, uint32_t align)
+{
+    return (v + align - 1) & ~(align - 1);
+}
+
+// 首次初始化时挂到全局列表并注册指标；再次初始化只更新容量
+static void info_publish(mem_arena_info_t *info, const char *name, mem_arena_kind_t kind, uint32_t caps,
+                         uint32_t capacity)
+{
+    info->name = name;
+    info->kind = kind;
+    info->caps = caps;
+    info->capacity = capacity;
+    info->used = 0;
+    if (info->listed) {
+        return;
+    }
+
+    snprintf(info->labels, sizeof(info->labels), "arena=\"%s\"", name);
+    static const struct {
+        const char *name;
+        const char *help;
+        metrics_type_t type;
+    } defs[4] = {
+        {"mem_arena_capacity_bytes", "Bytes reserved by the arena", METRICS_TYPE_GAUGE},
+        {"mem_arena_used_bytes", "Bytes currently allocated from the arena", METRICS_TYPE_GAUGE},
+        {"mem_arena_high_water_bytes", "Peak bytes allocated from the arena", METRICS_TYPE_GAUGE},
+        {"mem_arena_alloc_failures_total", "Allocations refused because the arena was full", METRICS_TYPE_COUNTER},
+    };
+    const uint32_t *refs[4] = {&info->capacity, &info->used, &info->high_water, &info->failures};
+    for (int i = 0; i < 4; i++) {
+        info->metrics[i] = (metrics_desc_t)METRICS_REF_INIT(defs[i].name, defs[i].help, defs[i].type, refs[i]);
+        info->metrics[i].labels = info->labels;
+    }
+    metrics_register_refs(info->metrics, 4);
+
+    info->listed = true;
+    mem_arena_info_t *head = __atomic_load_n(&s_head, __ATOMIC_RELAXED);
+    do {
+        info->next = head;
+    } while (!__atomic_compare_exchange_n(&s_head, &head, info, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+static inline void info_note_used(mem_arena_info_t *info, uint32_t used)
+{
+    info->used = used;
+    info->allocs++;
+    if (used > info->high_water) {
+        info->high_water = used;
+    }
+}
+
+esp_err_t mem_arena_init(mem_arena_t *arena, const char *name, size_t size, uint32_t caps)
+{
+    if (arena == NULL || name == NULL || size == 0 || size > UINT32_MAX - MEM_ARENA_ALIGN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (arena->base != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    size = align_up((uint32_t)size, MEM_ARENA_ALIGN);
+    arena->base = heap_caps_aligned_alloc(MEM_ARENA_ALIGN, size, caps);
+    if (arena->base == NULL) {
+        ESP_LOGE(TAG, "Arena %s: failed to reserve %u bytes (caps 0x%lx)", name, (unsigned)size,
+                 (unsigned long)caps);
+        return ESP_ERR_NO_MEM;
+    }
+    info_publish(&arena->info, name, MEM_ARENA_KIND_BUMP, caps, (uint32_t)size);
+    ESP_LOGI(TAG, "Arena %s: %u bytes", name, (unsigned)size);
+    return ESP_OK;
+}
+
+void mem_arena_deinit(mem_arena_t *arena)
+{
+    if (arena == NULL || arena->base == NULL) {
+        return;
+    }
+    heap_caps_free(arena->base);
+    arena->base = NULL;
+    arena->info.capacity = 0;
+    arena->info.used = 0;
+}
+
+void *mem_arena_alloc(mem_arena_t *arena, size_t size, size_t align)
+{
+    if (arena->base == NULL) {
+        return NULL;
+    }
+    if (align == 0) {
+        align = sizeof(void *);
+    }
+    const uint32_t capacity = arena->info.capacity;
+    const uint32_t start = align_up(arena->info.used, (uint32_t)align);
+    if (start < arena->info.used || start > capacity || size > capacity - start) {
+        arena->info.failures++;
+        return NULL;
+    }
+    info_note_used(&arena->info, start + (uint32_t)size);
+    return arena->base + start;
+}
+
+void *mem_arena_calloc(mem_arena_t *arena, size_t size, size_t align)
+{
+    void *p = mem_arena_alloc(arena, size, align);
+    if (p != NULL) {
+        memset(p, 0, size);
+    }
+    return p;
+}
+
+void mem_arena_rewind(mem_arena_t *arena, uint32_t mark)
+{
+    if (mark < arena->info.used) {
+        arena->info.used = mark;
+    }
+}
+
+esp_err_t mem_pool_init(mem_pool_t *pool, const char *name, size_t block_size, size_t block_count, uint32_t caps)
+{
+    if (pool == NULL || name == NULL || block_size == 0 || block_count == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (pool->base != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (block_size > UINT32_MAX - MEM_ARENA_ALIGN) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const uint32_t stride = align_up((uint32_t)block_size, MEM_ARENA_ALIGN);
+    if (block_count > UINT32_MAX / stride) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    const uint32_t total = stride * (uint32_t)block_count;
+    pool->base = heap_caps_aligned_alloc(MEM_ARENA_ALIGN, total, caps);
+    if (pool->base == NULL) {
+        ESP_LOGE(TAG, "Pool %s: failed to reserve %u x %u bytes (caps 0x%lx)", name, (unsigned)block_count,
+                 (unsigned)stride, (unsigned long)caps);
+        return ESP_ERR_NO_MEM;
+    }
+    pool->block_size = stride;
+    pool->block_count = (uint32_t)block_count;
+    portMUX_INITIALIZE(&pool->lock);
+
+    // 按地址顺序串成空闲链表
+    pool->free_list = NULL;
+    for (uint32_t i = pool->block_count; i-- > 0;) {
+        void *block = pool->base + (size_t)i * stride;
+        *(void **)block = pool->free_list;
+        pool->free_list = block;
+    }
+    info_publish(&pool->info, name, MEM_ARENA_KIND_POOL, caps, total);
+    ESP_LOGI(TAG, "Pool %s: %u x %u bytes", name, (unsigned)block_count, (unsigned)stride);
+    return ESP_OK;
+}
+
+void mem_pool_deinit(mem_pool_t *pool)
+{
+    if (pool == NULL || pool->base == NULL) {
+        return;
+    }
+    if (pool->info.used != 0) {
+        ESP_LOGW(TAG, "Pool %s released with %u bytes still in use", pool->info.name, (unsigned)pool->info.used);
+    }
+    portENTER_CRITICAL(&pool->lock);
+    uint8_t *base = pool->base;
+    pool->base = NULL;
+    pool->free_list = NULL;
+    pool->info.capacity = 0;
+    pool->info.used = 0;
+    portEXIT_CRITICAL(&pool->lock);
+    heap_caps_free(base);
+}
+
+void *mem_pool_alloc(mem_pool_t *pool)
+{
+    portENTER_CRITICAL(&pool->lock);
+    void *block = pool->free_list;
+    if (block != NULL) {
+        pool->free_list = *(void **)block;
+        info_note_used(&pool->info, pool->info.used + pool->block_size);
+    } else {
+        pool->info.failures++;
+    }
+    portEXIT_CRITICAL(&pool->lock);
+    return block;
+}
+
+bool mem_pool_owns(const mem_pool_t *pool, const void *block)
+{
+    const uint8_t *p = (const uint8_t *)block;
+    if (pool->base == NULL || p < pool->base) {
+        return false;
+    }
+    const size_t offset = (size_t)(p - pool->base);
+    return offset < (size_t)pool->block_size * pool->block_count && offset % pool->block_size == 0;
+}
+
+bool mem_pool_free(mem_pool_t *pool, void *block)
+{
+    if (block == NULL || !mem_pool_owns(pool, block)) {
+        return false;
+    }
+    portENTER_CRITICAL(&pool->lock);
+    *(void **)block = pool->free_list;
+    pool->free_list = block;
+    pool->info.used -= pool->block_size;
+    portEXIT_CRITICAL(&pool->lock);
+    return true;
+}
+
+size_t mem_arena_get_all(mem_arena_stats_t *out, size_t max)
+{
+    size_t n = 0;
+    for (const mem_arena_info_t *info = __atomic_load_n(&s_head, __ATOMIC_ACQUIRE); info != NULL && n < max;
+         info = info->next) {
+        out[n++] = (mem_arena_stats_t){
+            .name = info->name,
+            .kind = info->kind,
+            .caps = info->caps,
+            .capacity = info->capacity,
+            .used = info->used,
+            .high_water = info->high_water,
+            .allocs = info->allocs,
+            .failures = info->failures,
+        };
+    }
+    return n;
+}
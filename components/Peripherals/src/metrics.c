@@ -0,0 +1,198 @@
+/**
+ * @file metrics.c
+ * @brief 统一指标注册表与 Prometheus 文本导出
+ */
+
+#include "metrics.h"
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+static metrics_desc_t *s_head = NULL;
+static uint32_t s_count = 0;
+
+esp_err_t metrics_register(metrics_desc_t *desc)
+{
+    if (desc == NULL || desc->name == NULL || desc->name[0] == '\0') {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (desc->type == METRICS_TYPE_HISTOGRAM) {
+        const metrics_histogram_t *h = (const metrics_histogram_t *)desc;
+        if (desc->ref != NULL || h->bounds == NULL || h->bucket_count > METRICS_MAX_BUCKETS) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    if (__atomic_exchange_n(&desc->registered, true, __ATOMIC_ACQ_REL)) {
+        return ESP_OK;
+    }
+
+    // 无锁头插，导出方只沿 next 读取
+    metrics_desc_t *head = __atomic_load_n(&s_head, __ATOMIC_RELAXED);
+    do {
+        desc->next = head;
+    } while (!__atomic_compare_exchange_n(&s_head, &head, desc, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    __atomic_fetch_add(&s_count, 1, __ATOMIC_RELAXED);
+    return ESP_OK;
+}
+
+esp_err_t metrics_register_refs(metrics_desc_t *descs, size_t count)
+{
+    // 头插，倒序注册使导出顺序与数组顺序一致
+    for (size_t i = count; i-- > 0;) {
+        esp_err_t ret = metrics_register(&descs[i]);
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    return ESP_OK;
+}
+
+void metrics_histogram_observe(metrics_histogram_t *h, uint32_t v)
+{
+    uint8_t i = 0;
+    while (i < h->bucket_count && v > h->bounds[i]) {
+        i++;
+    }
+    __atomic_fetch_add(&h->buckets[i], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->sum, v, __ATOMIC_RELAXED);
+}
+
+size_t metrics_count(void)
+{
+    return __atomic_load_n(&s_count, __ATOMIC_RELAXED);
+}
+
+typedef struct {
+    metrics_write_fn_t write;
+    void *ctx;
+    bool failed;
+} text_out_t;
+
+static void out_printf(text_out_t *out, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static void out_printf(text_out_t *out, const char *fmt, ...)
+{
+    if (out->failed) {
+        return;
+    }
+    char line[256];
+    va_list args;
+    va_start(args, fmt);
+    int len = vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    if (len < 0) {
+        return;
+    }
+    if (len >= (int)sizeof(line)) {
+        len = sizeof(line) - 1;
+        line[len - 1] = '\n';
+    }
+    if (out->write(out->ctx, line, (size_t)len) < 0) {
+        out->failed = true;
+    }
+}
+
+static const char *type_name(metrics_type_t type)
+{
+    switch (type) {
+    case METRICS_TYPE_COUNTER:
+        return "counter";
+    case METRICS_TYPE_GAUGE:
+        return "gauge";
+    default:
+        return "histogram";
+    }
+}
+
+static uint32_t scalar_value(const metrics_desc_t *d)
+{
+    if (d->ref != NULL) {
+        return *d->ref;
+    }
+    // counter 与 gauge 的值紧跟在 desc 之后，布局相同
+    return __atomic_load_n(&((const metrics_counter_t *)d)->value, __ATOMIC_RELAXED);
+}
+
+static void write_histogram(text_out_t *out, const metrics_histogram_t *h)
+{
+    const char *name = h->desc.name;
+    const char *labels = h->desc.labels;
+    const char *sep = labels ? "," : "";
+    labels = labels ? labels : "";
+
+    // +Inf 与 _count 都是桶的累计和
+    uint32_t cumulative = 0;
+    for (uint8_t i = 0; i < h->bucket_count; i++) {
+        cumulative += __atomic_load_n(&h->buckets[i], __ATOMIC_RELAXED);
+        out_printf(out, "%s_bucket{%s%sle=\"%" PRIu32 "\"} %" PRIu32 "\n", name, labels, sep, h->bounds[i],
+                   cumulative);
+    }
+    cumulative += __atomic_load_n(&h->buckets[h->bucket_count], __ATOMIC_RELAXED);
+    out_printf(out, "%s_bucket{%s%sle=\"+Inf\"} %" PRIu32 "\n", name, labels, sep, cumulative);
+    if (labels[0] != '\0') {
+        out_printf(out, "%s_sum{%s} %" PRIu32 "\n", name, labels, __atomic_load_n(&h->sum, __ATOMIC_RELAXED));
+        out_printf(out, "%s_count{%s} %" PRIu32 "\n", name, labels, cumulative);
+    } else {
+        out_printf(out, "%s_sum %" PRIu32 "\n", name, __atomic_load_n(&h->sum, __ATOMIC_RELAXED));
+        out_printf(out, "%s_count %" PRIu32 "\n", name, cumulative);
+    }
+}
+
+static void write_sample(text_out_t *out, const metrics_desc_t *d)
+{
+    if (d->type == METRICS_TYPE_HISTOGRAM) {
+        write_histogram(out, (const metrics_histogram_t *)d);
+        return;
+    }
+    const uint32_t value = scalar_value(d);
+    const char *open = d->labels ? "{" : "";
+    const char *close = d->labels ? "}" : "";
+    if (d->type == METRICS_TYPE_GAUGE && d->ref == NULL) {
+        out_printf(out, "%s%s%s%s %" PRId32 "\n", d->name, open, d->labels ? d->labels : "", close, (int32_t)value);
+    } else {
+        out_printf(out, "%s%s%s%s %" PRIu32 "\n", d->name, open, d->labels ? d->labels : "", close, value);
+    }
+}
+
+esp_err_t metrics_write_text(metrics_write_fn_t write, void *ctx)
+{
+    if (write == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    text_out_t out = {.write = write, .ctx = ctx, .failed = false};
+    metrics_desc_t *const head = __atomic_load_n(&s_head, __ATOMIC_ACQUIRE);
+
+    // 同名指标必须连续输出: 只在某个名字第一次出现时输出整组
+    for (const metrics_desc_t *d = head; d != NULL && !out.failed; d = d->next) {
+        bool seen = false;
+        for (const metrics_desc_t *p = head; p != d; p = p->next) {
+            if (strcmp(p->name, d->name) == 0) {
+                seen = true;
+                break;
+            }
+        }
+        if (seen) {
+            continue;
+        }
+
+        // HELP 只需在组内任一个上给出
+        const char *help = NULL;
+        for (const metrics_desc_t *m = d; m != NULL && help == NULL; m = m->next) {
+            if (strcmp(m->name, d->name) == 0) {
+                help = m->help;
+            }
+        }
+        if (help != NULL) {
+            out_printf(&out, "# HELP %s %s\n", d->name, help);
+        }
+        out_printf(&out, "# TYPE %s %s\n", d->name, type_name(d->type));
+        for (const metrics_desc_t *m = d; m != NULL; m = m->next) {
+            if (strcmp(m->name, d->name) == 0) {
+                write_sample(&out, m);
+            }
+        }
+    }
+    return out.failed ? ESP_FAIL : ESP_OK;
+}
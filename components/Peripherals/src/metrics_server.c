@@ -0,0 +1,147 @@
+/**
+ * @file metrics_server.c
+ * @brief 指标抓取服务 - 最小 HTTP/1.0 响应
+ */
+
+#include "metrics_server.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+#include "metrics.h"
+
+static const char *TAG = "METRICS_SERVER";
+
+static TaskHandle_t s_server_task = NULL;
+static volatile bool s_server_running = false;
+
+static metrics_counter_t s_scrapes = METRICS_COUNTER_INIT("metrics_scrapes_total", "Metrics endpoint requests served");
+
+static int socket_write(void *ctx, const char *data, size_t len)
+{
+    const int sock = (int)(intptr_t)ctx;
+    size_t sent = 0;
+    while (sent < len) {
+        int n = send(sock, data + sent, len - sent, 0);
+        if (n < 0) {
+            return -1;
+        }
+        sent += n;
+    }
+    return (int)sent;
+}
+
+static void handle_client(int sock)
+{
+    // 读到请求头结束 (空行) 或超时，内容本身不解析
+    struct timeval tv = {.tv_sec = 1, .tv_usec = 0};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    char req[512];
+    size_t used = 0;
+    while (used < sizeof(req) - 1) {
+        int n = recv(sock, req + used, sizeof(req) - 1 - used, 0);
+        if (n <= 0) {
+            break;
+        }
+        used += n;
+        req[used] = '\0';
+        if (strstr(req, "\r\n\r\n") != NULL || strstr(req, "\n\n") != NULL) {
+            break;
+        }
+    }
+
+    metrics_counter_inc(&s_scrapes);
+    static const char header[] = "HTTP/1.0 200 OK\r\n"
+                                 "Content-Type: text/plain; version=0.0.4\r\n"
+                                 "Connection: close\r\n\r\n";
+    if (socket_write((void *)(intptr_t)sock, header, sizeof(header) - 1) < 0 ||
+        metrics_write_text(socket_write, (void *)(intptr_t)sock) != ESP_OK) {
+        ESP_LOGW(TAG, "Scrape aborted: errno %d", errno);
+    }
+}
+
+static void metrics_server_task(void *pvParameters)
+{
+    const uint16_t port = (uint16_t)(uintptr_t)pvParameters;
+    struct sockaddr_in dest_addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+
+    int listen_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
+    if (listen_sock < 0) {
+        ESP_LOGE(TAG, "Unable to create socket: errno %d", errno);
+        goto EXIT;
+    }
+    int opt = 1;
+    setsockopt(listen_sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    if (bind(listen_sock, (struct sockaddr *)&dest_addr, sizeof(dest_addr)) != 0 || listen(listen_sock, 2) != 0) {
+        ESP_LOGE(TAG, "Socket unable to bind/listen on port %d: errno %d", port, errno);
+        goto CLEAN_UP;
+    }
+    ESP_LOGI(TAG, "Metrics endpoint listening on port %d (%u metrics)", port, (unsigned)metrics_count());
+
+    while (s_server_running) {
+        fd_set readfds;
+        struct timeval tv = {.tv_sec = 1, .tv_usec = 0};
+        FD_ZERO(&readfds);
+        FD_SET(listen_sock, &readfds);
+        if (select(listen_sock + 1, &readfds, NULL, NULL, &tv) <= 0) {
+            continue;
+        }
+
+        struct sockaddr_in source_addr;
+        socklen_t addr_len = sizeof(source_addr);
+        int sock = accept(listen_sock, (struct sockaddr *)&source_addr, &addr_len);
+        if (sock < 0) {
+            ESP_LOGE(TAG, "Unable to accept connection: errno %d", errno);
+            continue;
+        }
+        handle_client(sock);
+        shutdown(sock, 0);
+        close(sock);
+    }
+
+CLEAN_UP:
+    close(listen_sock);
+EXIT:
+    s_server_running = false;
+    s_server_task = NULL;
+    vTaskDelete(NULL);
+}
+
+esp_err_t metrics_server_start(uint16_t port)
+{
+    if (s_server_task != NULL) {
+        return ESP_OK;
+    }
+    metrics_register(&s_scrapes.desc);
+    s_server_running = true;
+    if (xTaskCreatePinnedToCore(metrics_server_task, "metrics_srv", 4096, (void *)(uintptr_t)port, 2,
+                                &s_server_task, 0) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create metrics server task");
+        s_server_running = false;
+        s_server_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void metrics_server_stop(void)
+{
+    s_server_running = false;
+    // 任务在 1s 内自行退出 (select 超时)
+    for (int i = 0; i < 15 && s_server_task != NULL; i++) {
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+}
+
+bool metrics_server_is_running(void)
+{
+    return s_server_task != NULL;
+}
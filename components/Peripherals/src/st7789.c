@@ -10,7 +10,13 @@
 #include "esp_err.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_attr.h"
 #include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "hal/gpio_ll.h"
+#include "soc/gpio_struct.h"
+#include "sys_trace.h"
 #include <string.h>
 
 // ========================================
@@ -34,8 +40,10 @@ static void st7789_write_data(uint8_t data);
 static void st7789_write_data_buf(const uint8_t *data, size_t length);
 static void st7789_hardware_reset(void);
 static void st7789_init_sequence(void);
-static void st7789_write_bytes_async(const uint8_t *data, size_t size);
 static void st7789_backlight_pwm_init(void);
+static void st7789_spi_pre_cb(spi_transaction_t *t);
+static void st7789_spi_post_cb(spi_transaction_t *t);
+static esp_err_t st7789_async_init(void);
 
 // ========================================
 // SPI传输相关函数
@@ -71,8 +79,8 @@ static esp_err_t st7789_spi_init(void)
         .mode = 0,                              // SPI模式0
         .spics_io_num = ST7789_PIN_CS,
         .queue_size = ST7789_SPI_QUEUE_SIZE,   // 允许排队多个事务
-        .pre_cb = NULL,
-        .post_cb = NULL,
+        .pre_cb = st7789_spi_pre_cb,             // 按事务标志切换DC (命令/数据)
+        .post_cb = st7789_spi_post_cb,           // 刷屏最后一个事务完成时通知上层
     };
     
     // 添加SPI设备
@@ -148,165 +156,400 @@ static void st7789_backlight_pwm_init(void)
     ESP_LOGI(TAG, "Backlight PWM initialized");
 }
 
+// ==========================
+// 异步DMA流水线发送实现
+// ==========================
+#define ST7789_DMA_CHUNK_BYTES 8192   // 8KB 分块
+#define ST7789_DMA_QUEUE_DEPTH 4      // 弹跳缓冲数（四缓冲流水线）
+#define ST7789_DIRECT_CHUNK_BYTES (ST7789_WIDTH * ST7789_HEIGHT * 2) // 直接引用时单事务上限 (max_transfer_sz)
+
+// 事务 user 字段: 低 8 位为弹跳缓冲 slot，以下标志位
+#define ST7789_TRANS_SLOT_MASK 0xFFu
+#define ST7789_TRANS_NO_SLOT 0xFFu    // 不占用弹跳缓冲 (命令、参数、直接引用的像素)
+#define ST7789_TRANS_LAST 0x100u      // 本次刷屏的最后一个事务，完成时回调
+#define ST7789_TRANS_CMD 0x200u       // 命令字节，pre_cb 据此拉低 DC
+
+static uint8_t *s_dma_buf[ST7789_DMA_QUEUE_DEPTH] = {0};
+
 /**
- * @brief 写入命令
+ * @brief 一段待发送的像素: 可选的窗口命令 + rows 行像素 (连续数据 rows=1)
  */
-static void st7789_write_cmd(uint8_t cmd)
+typedef struct {
+    st7789_rect_t win;
+    bool set_win;
+    const uint8_t *data;
+    size_t row_bytes;
+    size_t stride_bytes;
+    size_t rows;
+} st7789_seg_t;
+
+/**
+ * @brief 发送流水线: 事务结构环形复用 (完成顺序与排队顺序一致)，取回结果时释放弹跳缓冲
+ */
+typedef struct {
+    spi_transaction_t trans[ST7789_SPI_QUEUE_SIZE];
+    int next;
+    int inflight;
+    bool buf_busy[ST7789_DMA_QUEUE_DEPTH];
+} st7789_pipe_t;
+
+// 异步刷屏状态
+// - 源缓冲DMA可达: 调用者任务直接排队 (不复制)，结果在下次 st7789_wait_idle 时取回；
+// - 否则交给刷屏任务经弹跳缓冲流水线发送，调用者立即返回；
+// 两种路径都在最后一个事务的 post_cb (SPI中断) 中调用完成回调。
+static SemaphoreHandle_t s_async_idle = NULL;  // 刷屏任务空闲时可获取
+static TaskHandle_t s_flush_task = NULL;
+static st7789_pipe_t s_task_pipe;              // 仅刷屏任务访问
+static st7789_pipe_t s_caller_pipe;            // 仅调用者任务访问
+static st7789_seg_t s_job_segs[ST7789_DIRTY_MAX_RECTS];
+static size_t s_job_nsegs = 0;
+static st7789_rect_t s_window;                 // st7789_set_window 记录、尚未发送的窗口
+static bool s_window_pending = false;
+static volatile st7789_done_cb_t s_done_cb = NULL;
+static void *volatile s_done_arg = NULL;
+static volatile int64_t s_xfer_start_us = 0;
+static st7789_async_stats_t s_async_stats = {0};
+
+static void IRAM_ATTR st7789_spi_pre_cb(spi_transaction_t *t)
 {
-    esp_err_t ret;
-    spi_transaction_t trans = {0};
-    
-    trans.length = 8;                       // 8位数据
-    trans.tx_buffer = &cmd;
-    
-    gpio_set_level(ST7789_PIN_DC, 0);       // DC=0表示命令
-    ret = spi_device_polling_transmit(g_st7789_handle.spi_handle, &trans);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "SPI command write failed");
+    // DC 随事务切换，命令与像素可在同一队列中连续排队
+    gpio_ll_set_level(&GPIO, ST7789_PIN_DC, ((uintptr_t)t->user & ST7789_TRANS_CMD) ? 0 : 1);
+}
+
+static void IRAM_ATTR st7789_spi_post_cb(spi_transaction_t *t)
+{
+    if (((uintptr_t)t->user & ST7789_TRANS_LAST) == 0) {
+        return;
+    }
+    s_async_stats.xfer_us += esp_timer_get_time() - s_xfer_start_us;
+    st7789_done_cb_t cb = s_done_cb;
+    if (cb) {
+        cb(s_done_arg);
     }
 }
 
-/**
- * @brief 写入单字节数据
- */
-static void st7789_write_data(uint8_t data)
+static void st7789_finish_in_task(void)
 {
-    esp_err_t ret;
-    spi_transaction_t trans = {0};
-    
-    trans.length = 8;                       // 8位数据
-    trans.tx_buffer = &data;
-    
-    gpio_set_level(ST7789_PIN_DC, 1);       // DC=1表示数据
-    ret = spi_device_polling_transmit(g_st7789_handle.spi_handle, &trans);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "SPI data write failed");
+    // 无弹跳缓冲退化为阻塞发送时，在任务上下文补发完成回调
+    s_async_stats.xfer_us += esp_timer_get_time() - s_xfer_start_us;
+    st7789_done_cb_t cb = s_done_cb;
+    if (cb) {
+        cb(s_done_arg);
     }
 }
 
 /**
- * @brief 写入数据缓冲区
+ * @brief 轮询发送 (队列中不能有未完成的事务)
  */
-static void st7789_write_data_buf(const uint8_t *data, size_t length)
+static void st7789_tx_polled(const void *data, size_t length, bool is_cmd)
 {
     if (length == 0) return;
-    
-    esp_err_t ret;
+
     spi_transaction_t trans = {0};
-    
     trans.length = length * 8;              // 位数
     trans.tx_buffer = data;
-    
-    gpio_set_level(ST7789_PIN_DC, 1);       // DC=1表示数据
-    ret = spi_device_polling_transmit(g_st7789_handle.spi_handle, &trans);
+    trans.user = (void *)(uintptr_t)(ST7789_TRANS_NO_SLOT | (is_cmd ? ST7789_TRANS_CMD : 0));
+    esp_err_t ret = spi_device_polling_transmit(g_st7789_handle.spi_handle, &trans);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "SPI data buffer write failed");
+        ESP_LOGE(TAG, "SPI %s write failed", is_cmd ? "command" : "data");
     }
 }
 
-// ==========================
-// 异步DMA流水线发送实现
-// ==========================
-#define ST7789_DMA_CHUNK_BYTES 8192   // 8KB 分块
-#define ST7789_DMA_QUEUE_DEPTH 4      // 队列深度4（四缓冲流水线）
-static uint8_t *s_dma_buf[ST7789_DMA_QUEUE_DEPTH] = {0};
+/**
+ * @brief 轮询发送窗口命令 (CASET/RASET/RAMWR)
+ */
+static void st7789_window_polled(const st7789_rect_t *w)
+{
+    const uint16_t x0 = w->x1 + X_SHIFT, x1 = w->x2 + X_SHIFT;
+    const uint16_t y0 = w->y1 + Y_SHIFT, y1 = w->y2 + Y_SHIFT;
+    const uint8_t caset = ST7789_CMD_CASET, raset = ST7789_CMD_RASET, ramwr = ST7789_CMD_RAMWR;
+    const uint8_t cols[4] = {x0 >> 8, x0 & 0xFF, x1 >> 8, x1 & 0xFF};
+    const uint8_t rows[4] = {y0 >> 8, y0 & 0xFF, y1 >> 8, y1 & 0xFF};
+
+    st7789_tx_polled(&caset, 1, true);
+    st7789_tx_polled(cols, sizeof(cols), false);
+    st7789_tx_polled(&raset, 1, true);
+    st7789_tx_polled(rows, sizeof(rows), false);
+    st7789_tx_polled(&ramwr, 1, true);
+}
 
-static void st7789_write_bytes_async(const uint8_t *data, size_t size)
+/**
+ * @brief 写入命令
+ */
+static void st7789_write_cmd(uint8_t cmd)
 {
-    if (size == 0) return;
+    st7789_wait_idle();                     // 命令前等待异步像素传输结束
+    if (s_window_pending) {
+        // 设了窗口但没有写像素，按原顺序先把窗口发出去
+        s_window_pending = false;
+        st7789_window_polled(&s_window);
+    }
+    st7789_tx_polled(&cmd, 1, true);
+}
 
+/**
+ * @brief 写入单字节数据
+ */
+static void st7789_write_data(uint8_t data)
+{
+    st7789_tx_polled(&data, 1, false);
+}
+
+/**
+ * @brief 写入数据缓冲区
+ */
+static void st7789_write_data_buf(const uint8_t *data, size_t length)
+{
+    st7789_tx_polled(data, length, false);
+}
+
+static bool st7789_dma_bufs_ready(void)
+{
     // 确保DMA缓冲已分配
+    bool ok = true;
     for (int i = 0; i < ST7789_DMA_QUEUE_DEPTH; i++) {
         if (!s_dma_buf[i]) s_dma_buf[i] = (uint8_t*)heap_caps_malloc(ST7789_DMA_CHUNK_BYTES, MALLOC_CAP_DMA);
+        ok &= s_dma_buf[i] != NULL;
     }
+    return ok;
+}
 
-    // 如果无法分配DMA缓冲，退化为阻塞发送
-    bool dma_ok = true;
-    for (int i = 0; i < ST7789_DMA_QUEUE_DEPTH; i++) if (!s_dma_buf[i]) dma_ok = false;
-    if (!dma_ok) {
-        st7789_write_data_buf(data, size);
-        return;
-    }
+/**
+ * @brief 取回一个已完成的事务
+ */
+static void st7789_pipe_reap(st7789_pipe_t *p)
+{
+    spi_transaction_t *done;
+    spi_device_get_trans_result(g_st7789_handle.spi_handle, &done, portMAX_DELAY);
+    const uint32_t slot = (uintptr_t)done->user & ST7789_TRANS_SLOT_MASK;
+    if (slot < ST7789_DMA_QUEUE_DEPTH) p->buf_busy[slot] = false;
+    p->inflight--;
+}
 
-    // 置DC为数据模式
-    gpio_set_level(ST7789_PIN_DC, 1);
+static void st7789_pipe_drain(st7789_pipe_t *p)
+{
+    while (p->inflight > 0) {
+        st7789_pipe_reap(p);
+    }
+}
 
-    spi_transaction_t trans[ST7789_DMA_QUEUE_DEPTH];
-    memset(trans, 0, sizeof(trans));
-    bool in_use[ST7789_DMA_QUEUE_DEPTH] = {0};
+static spi_transaction_t *st7789_pipe_alloc(st7789_pipe_t *p)
+{
+    // 队列满时取回最早的事务，它正是下一个要复用的结构
+    if (p->inflight == ST7789_SPI_QUEUE_SIZE) {
+        st7789_pipe_reap(p);
+    }
+    spi_transaction_t *t = &p->trans[p->next];
+    p->next = (p->next + 1) % ST7789_SPI_QUEUE_SIZE;
+    memset(t, 0, sizeof(*t));
+    return t;
+}
 
-    int queued = 0; // in-flight count
-    const uint8_t *src = data;
-    size_t bytes_left = size;
+static void st7789_pipe_queue(st7789_pipe_t *p, spi_transaction_t *t)
+{
+    if (spi_device_queue_trans(g_st7789_handle.spi_handle, t, portMAX_DELAY) == ESP_OK) {
+        p->inflight++;
+        SYS_TRACE_COUNTER("st7789_inflight", p->inflight);
+        return;
+    }
+    // 退化为阻塞发送 (post_cb 照常处理最后一个事务)
+    ESP_LOGE(TAG, "SPI queue failed, sending %u bytes blocking", (unsigned)(t->length / 8));
+    st7789_pipe_drain(p);
+    spi_device_polling_transmit(g_st7789_handle.spi_handle, t);
+    const uint32_t slot = (uintptr_t)t->user & ST7789_TRANS_SLOT_MASK;
+    if (slot < ST7789_DMA_QUEUE_DEPTH) p->buf_busy[slot] = false;
+}
 
-    while (bytes_left > 0) {
-        // 若队列已满，取回一个事务并标记对应slot空闲
-        if (queued == ST7789_DMA_QUEUE_DEPTH) {
-            spi_transaction_t *ret_trans;
-            spi_device_get_trans_result(g_st7789_handle.spi_handle, &ret_trans, portMAX_DELAY);
-            int freed = (int)(uintptr_t)ret_trans->user;
-            if (freed >= 0 && freed < ST7789_DMA_QUEUE_DEPTH) in_use[freed] = false;
-            queued--;
+/**
+ * @brief 窗口命令排队: 命令与参数都用 tx_data 随事务携带，不占缓冲
+ */
+static void st7789_pipe_window(st7789_pipe_t *p, const st7789_rect_t *w)
+{
+    const uint16_t lo[2] = {w->x1 + X_SHIFT, w->y1 + Y_SHIFT};
+    const uint16_t hi[2] = {w->x2 + X_SHIFT, w->y2 + Y_SHIFT};
+    const uint8_t cmds[3] = {ST7789_CMD_CASET, ST7789_CMD_RASET, ST7789_CMD_RAMWR};
+
+    for (int i = 0; i < 3; i++) {
+        spi_transaction_t *t = st7789_pipe_alloc(p);
+        t->flags = SPI_TRANS_USE_TXDATA;
+        t->length = 8;
+        t->tx_data[0] = cmds[i];
+        t->user = (void *)(uintptr_t)(ST7789_TRANS_NO_SLOT | ST7789_TRANS_CMD);
+        st7789_pipe_queue(p, t);
+        if (i == 2) {
+            break;
         }
 
-        // 找到一个空闲slot
-        int slot = -1;
+        t = st7789_pipe_alloc(p);
+        t->flags = SPI_TRANS_USE_TXDATA;
+        t->length = 32;
+        t->tx_data[0] = lo[i] >> 8;
+        t->tx_data[1] = lo[i] & 0xFF;
+        t->tx_data[2] = hi[i] >> 8;
+        t->tx_data[3] = hi[i] & 0xFF;
+        t->user = (void *)(uintptr_t)ST7789_TRANS_NO_SLOT;
+        st7789_pipe_queue(p, t);
+    }
+}
+
+static int st7789_pipe_buf(st7789_pipe_t *p)
+{
+    for (;;) {
         for (int i = 0; i < ST7789_DMA_QUEUE_DEPTH; i++) {
-            if (!in_use[i]) { slot = i; break; }
+            if (!p->buf_busy[i]) return i;
         }
-        if (slot < 0) {
-            // 理论上不会发生，保险等待一个完成
-            spi_transaction_t *ret_trans;
-            spi_device_get_trans_result(g_st7789_handle.spi_handle, &ret_trans, portMAX_DELAY);
-            int freed = (int)(uintptr_t)ret_trans->user;
-            if (freed >= 0 && freed < ST7789_DMA_QUEUE_DEPTH) in_use[freed] = false;
-            queued--;
-            continue;
+        st7789_pipe_reap(p);
+    }
+}
+
+/**
+ * @brief 像素排队: 连续且DMA可达时直接引用，否则分块复制到弹跳缓冲 (非连续的窗口逐行收集)
+ */
+static void st7789_pipe_pixels(st7789_pipe_t *p, const st7789_seg_t *seg, bool notify_last)
+{
+    size_t row_bytes = seg->row_bytes;
+    size_t rows = seg->rows;
+    if (rows == 1 || row_bytes == seg->stride_bytes) {
+        row_bytes *= rows;
+        rows = 1;
+    }
+    size_t bytes_left = row_bytes * rows;
+    const uint8_t *src = seg->data;
+
+    if (rows == 1 && esp_ptr_dma_capable(src)) {
+        while (bytes_left > 0) {
+            const size_t chunk = bytes_left > ST7789_DIRECT_CHUNK_BYTES ? ST7789_DIRECT_CHUNK_BYTES : bytes_left;
+            bytes_left -= chunk;
+            spi_transaction_t *t = st7789_pipe_alloc(p);
+            t->length = chunk * 8;
+            t->tx_buffer = src;
+            t->user = (void *)(uintptr_t)(ST7789_TRANS_NO_SLOT | (notify_last && bytes_left == 0 ? ST7789_TRANS_LAST : 0));
+            st7789_pipe_queue(p, t);
+            src += chunk;
         }
+        return;
+    }
 
-        // 准备一个事务
-        size_t chunk = bytes_left > ST7789_DMA_CHUNK_BYTES ? ST7789_DMA_CHUNK_BYTES : bytes_left;
+    size_t row = 0;
+    size_t col = 0;
+    while (bytes_left > 0) {
+        const int slot = st7789_pipe_buf(p);
         uint8_t *buf = s_dma_buf[slot];
+        size_t fill = 0;
+        while (fill < ST7789_DMA_CHUNK_BYTES && row < rows) {
+            size_t n = row_bytes - col;
+            if (n > ST7789_DMA_CHUNK_BYTES - fill) n = ST7789_DMA_CHUNK_BYTES - fill;
+            memcpy(buf + fill, src + row * seg->stride_bytes + col, n);
+            fill += n;
+            col += n;
+            if (col == row_bytes) {
+                col = 0;
+                row++;
+            }
+        }
+        bytes_left -= fill;
+
+        spi_transaction_t *t = st7789_pipe_alloc(p);
+        t->length = fill * 8;
+        t->tx_buffer = buf;
+        t->user = (void *)(uintptr_t)(slot | (notify_last && bytes_left == 0 ? ST7789_TRANS_LAST : 0));
+        p->buf_busy[slot] = true;
+        st7789_pipe_queue(p, t);
+    }
+}
 
-        // 如果源缓冲区是DMA可达，直接引用；否则复制到DMA缓冲
-        const uint8_t *tx_ptr = NULL;
-        bool src_dma_ok = esp_ptr_dma_capable(src);
-        if (src_dma_ok) {
-            tx_ptr = src;
-        } else {
-            memcpy(buf, src, chunk);
-            tx_ptr = buf;
+/**
+ * @brief 依次排队各段的窗口命令与像素，不等待完成
+ */
+static void st7789_pipe_send(st7789_pipe_t *p, const st7789_seg_t *segs, size_t count, bool notify_last)
+{
+    if (!st7789_dma_bufs_ready()) {
+        // 无法分配DMA缓冲，退化为阻塞发送
+        st7789_pipe_drain(p);
+        for (size_t i = 0; i < count; i++) {
+            if (segs[i].set_win) st7789_window_polled(&segs[i].win);
+            for (size_t r = 0; r < segs[i].rows; r++) {
+                st7789_write_data_buf(segs[i].data + r * segs[i].stride_bytes, segs[i].row_bytes);
+            }
         }
+        if (notify_last) st7789_finish_in_task();
+        return;
+    }
 
-        spi_transaction_t *t = &trans[slot];
-        memset(t, 0, sizeof(*t));
-        t->length = chunk * 8;
-        t->tx_buffer = tx_ptr;
-        t->user = (void*)(uintptr_t)slot;
-
-        esp_err_t ret = spi_device_queue_trans(g_st7789_handle.spi_handle, t, portMAX_DELAY);
-        if (ret != ESP_OK) {
-            // 退化为阻塞发送
-            st7789_write_data_buf(src, chunk);
-        } else {
-            in_use[slot] = true;
-            queued++;
+    for (size_t i = 0; i < count; i++) {
+        if (segs[i].set_win) {
+            st7789_pipe_window(p, &segs[i].win);
         }
+        st7789_pipe_pixels(p, &segs[i], notify_last && i + 1 == count);
+    }
+}
 
-        src += chunk;
-        bytes_left -= chunk;
+/**
+ * @brief 刷屏任务: 源缓冲不可DMA时经弹跳缓冲发送，与LVGL渲染并行
+ */
+static void st7789_flush_task(void *arg)
+{
+    (void)arg;
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        st7789_pipe_send(&s_task_pipe, s_job_segs, s_job_nsegs, true);
+        st7789_pipe_drain(&s_task_pipe);
+        xSemaphoreGive(s_async_idle);
     }
+}
 
-    // 取回所有剩余事务
-    while (queued > 0) {
-        spi_transaction_t *ret_trans;
-        spi_device_get_trans_result(g_st7789_handle.spi_handle, &ret_trans, portMAX_DELAY);
-        int freed = (int)(uintptr_t)ret_trans->user;
-        if (freed >= 0 && freed < ST7789_DMA_QUEUE_DEPTH) in_use[freed] = false;
-        queued--;
+/**
+ * @brief 交给刷屏任务发送，任务不可用时在调用者任务中排队
+ */
+static void st7789_dispatch(const st7789_seg_t *segs, size_t count)
+{
+    if (s_flush_task != NULL && xSemaphoreTake(s_async_idle, 0) == pdTRUE) {
+        memcpy(s_job_segs, segs, count * sizeof(*segs));
+        s_job_nsegs = count;
+        xTaskNotifyGive(s_flush_task);
+    } else {
+        st7789_pipe_send(&s_caller_pipe, segs, count, true);
     }
 }
 
+/**
+ * @brief 取出 st7789_set_window 记录的窗口作为一段连续像素
+ */
+static st7789_seg_t st7789_take_segment(const uint16_t *data, size_t length)
+{
+    st7789_seg_t seg = {
+        .win = s_window,
+        .set_win = s_window_pending,
+        .data = (const uint8_t *)data,
+        .row_bytes = length * 2,
+        .stride_bytes = length * 2,
+        .rows = 1,
+    };
+    s_window_pending = false;
+    return seg;
+}
+
+/**
+ * @brief 创建刷屏任务与空闲信号量
+ */
+static esp_err_t st7789_async_init(void)
+{
+    if (s_async_idle == NULL) {
+        s_async_idle = xSemaphoreCreateBinary();
+        if (s_async_idle == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        xSemaphoreGive(s_async_idle);
+    }
+    if (s_flush_task == NULL &&
+        xTaskCreatePinnedToCore(st7789_flush_task, "st7789_flush", ST7789_FLUSH_TASK_STACK, NULL,
+                                ST7789_FLUSH_TASK_PRIORITY, &s_flush_task, ST7789_FLUSH_TASK_CORE) != pdPASS) {
+        s_flush_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
 /**
  * @brief 硬件复位
  */
@@ -435,6 +678,12 @@ esp_err_t st7789_init(void)
         return ret;
     }
     
+    // 异步刷屏任务 (失败时刷屏退化为阻塞发送)
+    ret = st7789_async_init();
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Async flush unavailable, falling back to blocking writes");
+    }
+
     // 初始化背光PWM
     st7789_backlight_pwm_init();
     
@@ -465,7 +714,7 @@ esp_err_t st7789_deinit(void)
         return ESP_OK;
     }
     
-    // 关闭显示
+    // 关闭显示 (命令会先等待异步传输结束)
     st7789_display_enable(false);
     st7789_set_backlight(0);
     
@@ -484,28 +733,12 @@ esp_err_t st7789_deinit(void)
  */
 void st7789_set_window(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
 {
-    // 应用坐标偏移
-    x0 += X_SHIFT;
-    x1 += X_SHIFT;
-    y0 += Y_SHIFT;
-    y1 += Y_SHIFT;
-
-    // 设置列地址
-    st7789_write_cmd(ST7789_CMD_CASET);
-    st7789_write_data(x0 >> 8);
-    st7789_write_data(x0 & 0xFF);
-    st7789_write_data(x1 >> 8);
-    st7789_write_data(x1 & 0xFF);
-    
-    // 设置行地址
-    st7789_write_cmd(ST7789_CMD_RASET);
-    st7789_write_data(y0 >> 8);
-    st7789_write_data(y0 & 0xFF);
-    st7789_write_data(y1 >> 8);
-    st7789_write_data(y1 & 0xFF);
-    
-    // 准备写入RAM
-    st7789_write_cmd(ST7789_CMD_RAMWR);
+    // 只记录，窗口命令随下一次像素写入排进同一DMA队列
+    s_window.x1 = x0;
+    s_window.y1 = y0;
+    s_window.x2 = x1;
+    s_window.y2 = y1;
+    s_window_pending = true;
 }
 
 /**
@@ -516,8 +749,111 @@ void st7789_write_pixels(const uint16_t *data, size_t length)
     if (data == NULL || length == 0) {
         return;
     }
-    // 零转换路径 + 异步DMA流水线
-    st7789_write_bytes_async((const uint8_t *)data, length * 2);
+    st7789_wait_idle();
+    // 零转换路径 + DMA流水线，返回前发送完毕
+    const st7789_seg_t seg = st7789_take_segment(data, length);
+    st7789_pipe_send(&s_caller_pipe, &seg, 1, false);
+    st7789_pipe_drain(&s_caller_pipe);
+}
+
+static void st7789_async_begin(st7789_done_cb_t done_cb, void *arg, size_t bytes)
+{
+    s_done_cb = done_cb;
+    s_done_arg = arg;
+    s_async_stats.flushes++;
+    s_async_stats.bytes += bytes;
+    s_xfer_start_us = esp_timer_get_time();
+}
+
+/**
+ * @brief 异步写入像素数据
+ */
+esp_err_t st7789_write_pixels_async(const uint16_t *data, size_t length, st7789_done_cb_t done_cb, void *arg)
+{
+    if (data == NULL || length == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    st7789_wait_idle();
+    st7789_async_begin(done_cb, arg, length * 2);
+    s_async_stats.windows += s_window_pending;
+
+    const st7789_seg_t seg = st7789_take_segment(data, length);
+    if (esp_ptr_dma_capable(data)) {
+        st7789_pipe_send(&s_caller_pipe, &seg, 1, true);
+        s_async_stats.direct_flushes++;
+    } else {
+        st7789_dispatch(&seg, 1);
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief 异步发送一帧的多个脏区
+ */
+esp_err_t st7789_flush_rects(const uint16_t *fb, const st7789_rect_t *rects, size_t count,
+                             st7789_done_cb_t done_cb, void *arg)
+{
+    if (fb == NULL || rects == NULL || count == 0 || count > ST7789_DIRTY_MAX_RECTS) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // 裁剪到屏幕后按代价模型合并
+    st7789_rect_t win[ST7789_DIRTY_MAX_RECTS];
+    for (size_t i = 0; i < count; i++) {
+        win[i].x1 = rects[i].x1 < 0 ? 0 : rects[i].x1;
+        win[i].y1 = rects[i].y1 < 0 ? 0 : rects[i].y1;
+        win[i].x2 = rects[i].x2 >= ST7789_WIDTH ? ST7789_WIDTH - 1 : rects[i].x2;
+        win[i].y2 = rects[i].y2 >= ST7789_HEIGHT ? ST7789_HEIGHT - 1 : rects[i].y2;
+    }
+    const size_t nwin = st7789_dirty_merge(win, count, ST7789_WINDOW_COST_PX);
+    if (nwin == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    st7789_seg_t segs[ST7789_DIRTY_MAX_RECTS];
+    size_t bytes = 0;
+    for (size_t i = 0; i < nwin; i++) {
+        const st7789_rect_t *w = &win[i];
+        segs[i] = (st7789_seg_t){
+            .win = *w,
+            .set_win = true,
+            .data = (const uint8_t *)(fb + (size_t)w->y1 * ST7789_WIDTH + w->x1),
+            .row_bytes = (size_t)(w->x2 - w->x1 + 1) * 2,
+            .stride_bytes = ST7789_WIDTH * 2,
+            .rows = (size_t)(w->y2 - w->y1 + 1),
+        };
+        bytes += segs[i].row_bytes * segs[i].rows;
+    }
+
+    st7789_wait_idle();
+    s_window_pending = false; // 各窗口自带命令，之前记录的窗口作废
+    st7789_async_begin(done_cb, arg, bytes);
+    s_async_stats.rects += count;
+    s_async_stats.windows += nwin;
+    st7789_dispatch(segs, nwin);
+    return ESP_OK;
+}
+
+/**
+ * @brief 等待异步传输结束
+ */
+void st7789_wait_idle(void)
+{
+    const int64_t t0 = esp_timer_get_time();
+    if (s_async_idle != NULL) {
+        xSemaphoreTake(s_async_idle, portMAX_DELAY);
+        xSemaphoreGive(s_async_idle);
+    }
+    st7789_pipe_drain(&s_caller_pipe);
+    s_async_stats.wait_us += esp_timer_get_time() - t0;
+}
+
+void st7789_get_async_stats(st7789_async_stats_t *stats)
+{
+    if (stats != NULL) {
+        *stats = s_async_stats;
+    }
 }
 
 /**
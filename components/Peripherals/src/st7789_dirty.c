@@ -0,0 +1,95 @@
+/**
+ * @file st7789_dirty.c
+ * @brief ST7789 脏区合并与窗口代价模型
+ */
+
+#include "st7789_dirty.h"
+
+#include <stdbool.h>
+
+static inline int16_t min16(int16_t a, int16_t b) { return a < b ? a : b; }
+static inline int16_t max16(int16_t a, int16_t b) { return a > b ? a : b; }
+
+uint32_t st7789_rect_area(const st7789_rect_t *r)
+{
+    if (r->x2 < r->x1 || r->y2 < r->y1) {
+        return 0;
+    }
+    return (uint32_t)(r->x2 - r->x1 + 1) * (uint32_t)(r->y2 - r->y1 + 1);
+}
+
+uint32_t st7789_dirty_cost(const st7789_rect_t *rects, size_t n, uint32_t window_cost_px)
+{
+    uint32_t cost = 0;
+    for (size_t i = 0; i < n; i++) {
+        const uint32_t area = st7789_rect_area(&rects[i]);
+        if (area != 0) {
+            cost += area + window_cost_px;
+        }
+    }
+    return cost;
+}
+
+static st7789_rect_t rect_union(const st7789_rect_t *a, const st7789_rect_t *b)
+{
+    st7789_rect_t u = {
+        .x1 = min16(a->x1, b->x1),
+        .y1 = min16(a->y1, b->y1),
+        .x2 = max16(a->x2, b->x2),
+        .y2 = max16(a->y2, b->y2),
+    };
+    return u;
+}
+
+static bool rect_before(const st7789_rect_t *a, const st7789_rect_t *b)
+{
+    return a->y1 < b->y1 || (a->y1 == b->y1 && a->x1 < b->x1);
+}
+
+size_t st7789_dirty_merge(st7789_rect_t *rects, size_t n, uint32_t window_cost_px)
+{
+    // 丢弃空矩形
+    size_t count = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (st7789_rect_area(&rects[i]) != 0) {
+            rects[count++] = rects[i];
+        }
+    }
+
+    // 贪心: 每轮合并节省最多的一对，n <= ST7789_DIRTY_MAX_RECTS 时每帧最多几万次面积计算
+    while (count > 1) {
+        int64_t best_gain = 0;
+        size_t best_i = 0;
+        size_t best_j = 0;
+        for (size_t i = 0; i + 1 < count; i++) {
+            const int64_t cost_i = (int64_t)st7789_rect_area(&rects[i]) + window_cost_px;
+            for (size_t j = i + 1; j < count; j++) {
+                const st7789_rect_t u = rect_union(&rects[i], &rects[j]);
+                const int64_t separate = cost_i + st7789_rect_area(&rects[j]) + window_cost_px;
+                const int64_t merged = (int64_t)st7789_rect_area(&u) + window_cost_px;
+                if (separate - merged > best_gain) {
+                    best_gain = separate - merged;
+                    best_i = i;
+                    best_j = j;
+                }
+            }
+        }
+        if (best_gain <= 0) {
+            break;
+        }
+        rects[best_i] = rect_union(&rects[best_i], &rects[best_j]);
+        rects[best_j] = rects[--count];
+    }
+
+    // 插入排序，按扫描顺序发送
+    for (size_t i = 1; i < count; i++) {
+        const st7789_rect_t r = rects[i];
+        size_t j = i;
+        while (j > 0 && rect_before(&r, &rects[j - 1])) {
+            rects[j] = rects[j - 1];
+            j--;
+        }
+        rects[j] = r;
+    }
+    return count;
+}
@@ -0,0 +1,323 @@
+/**
+ * @file sys_monitor.c
+ * @brief 系统资源采样 - 任务 CPU/栈、堆空闲/最大块、分配失败
+ */
+
+#include "sys_monitor.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "metrics.h"
+
+static const char *TAG = "SYS_MONITOR";
+
+typedef struct {
+    bool used;
+    bool seen;                 // 本次采样中仍存在
+    uint32_t last_runtime;     // 上次采样时的运行时间计数
+    sys_monitor_task_t info;
+} sys_monitor_entry_t;
+
+static const uint32_t s_heap_caps[SYS_MONITOR_HEAP_MAX] = {
+    MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT,
+    MALLOC_CAP_DMA,
+    MALLOC_CAP_SPIRAM,
+};
+static const char *const s_heap_names[SYS_MONITOR_HEAP_MAX] = {"internal", "dma", "spiram"};
+
+static sys_monitor_entry_t s_tasks[SYS_MONITOR_MAX_TASKS];
+static sys_monitor_sample_t s_history[SYS_MONITOR_HISTORY];
+static size_t s_history_head = 0;  // 下一个写入位置
+static size_t s_history_count = 0;
+static uint32_t s_last_total_runtime = 0;
+static TaskStatus_t *s_status = NULL;
+static UBaseType_t s_status_cap = 0;
+
+static SemaphoreHandle_t s_lock = NULL;
+static TaskHandle_t s_task = NULL;
+static volatile bool s_running = false;
+static uint32_t s_period_ms = SYS_MONITOR_DEFAULT_PERIOD_MS;
+
+static volatile uint32_t s_alloc_failures[SYS_MONITOR_HEAP_MAX];
+static volatile uint32_t s_last_failed_size = 0;
+
+// 最近一次采样的导出值 (指标注册表直接读取)
+static uint32_t s_core_load_x10[SYS_MONITOR_MAX_CORES];
+static uint32_t s_heap_free[SYS_MONITOR_HEAP_MAX];
+static uint32_t s_heap_largest[SYS_MONITOR_HEAP_MAX];
+static metrics_desc_t s_metrics[] = {
+    {.name = "cpu_load_permille", .help = "Core load over the last sampling period (0.1%)", .labels = "core=\"0\"",
+     .type = METRICS_TYPE_GAUGE, .ref = &s_core_load_x10[0]},
+    {.name = "cpu_load_permille", .labels = "core=\"1\"", .type = METRICS_TYPE_GAUGE, .ref = &s_core_load_x10[1]},
+    {.name = "heap_free_bytes", .help = "Free heap per capability", .labels = "heap=\"internal\"",
+     .type = METRICS_TYPE_GAUGE, .ref = &s_heap_free[SYS_MONITOR_HEAP_INTERNAL]},
+    {.name = "heap_free_bytes", .labels = "heap=\"dma\"", .type = METRICS_TYPE_GAUGE,
+     .ref = &s_heap_free[SYS_MONITOR_HEAP_DMA]},
+    {.name = "heap_free_bytes", .labels = "heap=\"spiram\"", .type = METRICS_TYPE_GAUGE,
+     .ref = &s_heap_free[SYS_MONITOR_HEAP_SPIRAM]},
+    {.name = "heap_largest_block_bytes", .help = "Largest free block per capability", .labels = "heap=\"internal\"",
+     .type = METRICS_TYPE_GAUGE, .ref = &s_heap_largest[SYS_MONITOR_HEAP_INTERNAL]},
+    {.name = "heap_largest_block_bytes", .labels = "heap=\"dma\"", .type = METRICS_TYPE_GAUGE,
+     .ref = &s_heap_largest[SYS_MONITOR_HEAP_DMA]},
+    {.name = "heap_largest_block_bytes", .labels = "heap=\"spiram\"", .type = METRICS_TYPE_GAUGE,
+     .ref = &s_heap_largest[SYS_MONITOR_HEAP_SPIRAM]},
+    {.name = "heap_alloc_failures_total", .help = "Failed heap allocations per capability",
+     .labels = "heap=\"internal\"", .type = METRICS_TYPE_COUNTER, .ref = &s_alloc_failures[SYS_MONITOR_HEAP_INTERNAL]},
+    {.name = "heap_alloc_failures_total", .labels = "heap=\"dma\"", .type = METRICS_TYPE_COUNTER,
+     .ref = &s_alloc_failures[SYS_MONITOR_HEAP_DMA]},
+    {.name = "heap_alloc_failures_total", .labels = "heap=\"spiram\"", .type = METRICS_TYPE_COUNTER,
+     .ref = &s_alloc_failures[SYS_MONITOR_HEAP_SPIRAM]},
+};
+
+static void alloc_failed_cb(size_t size, uint32_t caps, const char *function_name)
+{
+    // 在分配失败的调用者上下文中执行，只做计数
+    (void)function_name;
+    sys_monitor_heap_t heap = SYS_MONITOR_HEAP_INTERNAL;
+    if (caps & MALLOC_CAP_SPIRAM) {
+        heap = SYS_MONITOR_HEAP_SPIRAM;
+    } else if (caps & MALLOC_CAP_DMA) {
+        heap = SYS_MONITOR_HEAP_DMA;
+    }
+    s_alloc_failures[heap]++;
+    s_last_failed_size = (uint32_t)size;
+}
+
+static sys_monitor_entry_t *entry_for(const TaskStatus_t *st)
+{
+    sys_monitor_entry_t *free_slot = NULL;
+    for (int i = 0; i < SYS_MONITOR_MAX_TASKS; i++) {
+        if (s_tasks[i].used && s_tasks[i].info.task_number == st->xTaskNumber) {
+            return &s_tasks[i];
+        }
+        if (!s_tasks[i].used && free_slot == NULL) {
+            free_slot = &s_tasks[i];
+        }
+    }
+    if (free_slot != NULL) {
+        memset(free_slot, 0, sizeof(*free_slot));
+        free_slot->used = true; // last_runtime 为 0: 首次出现时按创建以来的平均占用计
+        free_slot->info.task_number = st->xTaskNumber;
+        strncpy(free_slot->info.name, st->pcTaskName, SYS_MONITOR_TASK_NAME_LEN - 1);
+    }
+    return free_slot;
+}
+
+static bool sample_tasks(sys_monitor_sample_t *sample)
+{
+    const UBaseType_t count = uxTaskGetNumberOfTasks();
+    if (count + 4 > s_status_cap) {
+        TaskStatus_t *status = realloc(s_status, (count + 8) * sizeof(TaskStatus_t));
+        if (status == NULL) {
+            return false;
+        }
+        s_status = status;
+        s_status_cap = count + 8;
+    }
+
+    configRUN_TIME_COUNTER_TYPE total_runtime = 0;
+    const UBaseType_t n = uxTaskGetSystemState(s_status, s_status_cap, &total_runtime);
+    // 计数器 32 位回绕时无符号差值仍正确
+    const uint32_t period = (uint32_t)total_runtime - s_last_total_runtime;
+    s_last_total_runtime = (uint32_t)total_runtime;
+
+    for (int i = 0; i < SYS_MONITOR_MAX_TASKS; i++) {
+        s_tasks[i].seen = false;
+    }
+
+    for (UBaseType_t i = 0; i < n; i++) {
+        const TaskStatus_t *st = &s_status[i];
+        sys_monitor_entry_t *e = entry_for(st);
+        if (e == NULL) {
+            continue;
+        }
+        const uint32_t runtime = (uint32_t)st->ulRunTimeCounter;
+        const uint32_t delta = runtime - e->last_runtime;
+        e->last_runtime = runtime;
+        e->seen = true;
+
+        uint32_t cpu_x10 = period ? (uint32_t)((uint64_t)delta * 1000 / period) : 0;
+        if (cpu_x10 > 1000) cpu_x10 = 1000;
+        e->info.cpu_x10 = (uint16_t)cpu_x10;
+        e->info.priority = (uint8_t)st->uxCurrentPriority;
+        e->info.stack_hwm = st->usStackHighWaterMark; // ESP-IDF 中栈以字节计
+        const BaseType_t core = xTaskGetCoreID(st->xHandle);
+        e->info.core = core == tskNO_AFFINITY ? -1 : (int8_t)core;
+        memmove(e->info.cpu_history, e->info.cpu_history + 1, SYS_MONITOR_TASK_HISTORY - 1);
+        e->info.cpu_history[SYS_MONITOR_TASK_HISTORY - 1] = (uint8_t)(cpu_x10 / 5);
+
+        for (int c = 0; c < portNUM_PROCESSORS && c < SYS_MONITOR_MAX_CORES; c++) {
+            if (st->xHandle == xTaskGetIdleTaskHandleForCore(c)) {
+                sample->core_load_x10[c] = (uint16_t)(1000 - cpu_x10);
+            }
+        }
+    }
+
+    // 已删除的任务
+    for (int i = 0; i < SYS_MONITOR_MAX_TASKS; i++) {
+        if (s_tasks[i].used && !s_tasks[i].seen) {
+            s_tasks[i].used = false;
+        }
+    }
+    sample->task_count = (uint16_t)n;
+    return true;
+}
+
+static void sample_heaps(sys_monitor_sample_t *sample)
+{
+    for (int i = 0; i < SYS_MONITOR_HEAP_MAX; i++) {
+        sys_monitor_heap_stats_t *h = &sample->heap[i];
+        h->free_bytes = heap_caps_get_free_size(s_heap_caps[i]);
+        h->largest_block = heap_caps_get_largest_free_block(s_heap_caps[i]);
+        h->min_free = heap_caps_get_minimum_free_size(s_heap_caps[i]);
+        h->alloc_failures = s_alloc_failures[i];
+    }
+    sample->last_failed_size = s_last_failed_size;
+}
+
+static void sample_once(void)
+{
+    sys_monitor_sample_t sample;
+    memset(&sample, 0, sizeof(sample));
+    sample.timestamp_ms = (uint32_t)(esp_timer_get_time() / 1000);
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (sample_tasks(&sample)) {
+        sample_heaps(&sample);
+        s_history[s_history_head] = sample;
+        for (int i = 0; i < SYS_MONITOR_MAX_CORES; i++) {
+            s_core_load_x10[i] = sample.core_load_x10[i];
+        }
+        for (int i = 0; i < SYS_MONITOR_HEAP_MAX; i++) {
+            s_heap_free[i] = sample.heap[i].free_bytes;
+            s_heap_largest[i] = sample.heap[i].largest_block;
+        }
+        s_history_head = (s_history_head + 1) % SYS_MONITOR_HISTORY;
+        if (s_history_count < SYS_MONITOR_HISTORY) {
+            s_history_count++;
+        }
+    }
+    xSemaphoreGive(s_lock);
+}
+
+static void sys_monitor_task(void *arg)
+{
+    (void)arg;
+    TickType_t last_wake = xTaskGetTickCount();
+    while (s_running) {
+        sample_once();
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(s_period_ms));
+    }
+    s_task = NULL;
+    vTaskDelete(NULL);
+}
+
+esp_err_t sys_monitor_start(uint32_t period_ms)
+{
+    if (s_task != NULL) {
+        return ESP_OK;
+    }
+    if (s_lock == NULL) {
+        s_lock = xSemaphoreCreateMutex();
+        if (s_lock == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        esp_err_t ret = heap_caps_register_failed_alloc_callback(alloc_failed_cb);
+        if (ret != ESP_OK) {
+            ESP_LOGW(TAG, "Failed to register alloc failure callback: %s", esp_err_to_name(ret));
+        }
+        metrics_register_refs(s_metrics, sizeof(s_metrics) / sizeof(s_metrics[0]));
+    }
+    s_period_ms = period_ms ? period_ms : SYS_MONITOR_DEFAULT_PERIOD_MS;
+    s_running = true;
+    if (xTaskCreatePinnedToCore(sys_monitor_task, "sys_monitor", 3072, NULL, 1, &s_task, 0) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create sampling task");
+        s_running = false;
+        s_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Sampling every %lu ms", (unsigned long)s_period_ms);
+    return ESP_OK;
+}
+
+void sys_monitor_stop(void)
+{
+    s_running = false;
+}
+
+bool sys_monitor_is_running(void)
+{
+    return s_task != NULL;
+}
+
+bool sys_monitor_get_latest(sys_monitor_sample_t *sample)
+{
+    if (s_lock == NULL) {
+        return false;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    const bool ok = s_history_count > 0;
+    if (ok) {
+        *sample = s_history[(s_history_head + SYS_MONITOR_HISTORY - 1) % SYS_MONITOR_HISTORY];
+    }
+    xSemaphoreGive(s_lock);
+    return ok;
+}
+
+size_t sys_monitor_get_history(sys_monitor_sample_t *samples, size_t max)
+{
+    if (s_lock == NULL) {
+        return 0;
+    }
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    const size_t n = s_history_count < max ? s_history_count : max;
+    const size_t first = (s_history_head + SYS_MONITOR_HISTORY - n) % SYS_MONITOR_HISTORY;
+    for (size_t i = 0; i < n; i++) {
+        samples[i] = s_history[(first + i) % SYS_MONITOR_HISTORY];
+    }
+    xSemaphoreGive(s_lock);
+    return n;
+}
+
+size_t sys_monitor_get_tasks(sys_monitor_task_t *tasks, size_t max)
+{
+    if (s_lock == NULL) {
+        return 0;
+    }
+    size_t n = 0;
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    for (int i = 0; i < SYS_MONITOR_MAX_TASKS && n < max; i++) {
+        if (!s_tasks[i].used) {
+            continue;
+        }
+        // 插入排序，CPU 占用从高到低
+        size_t j = n++;
+        while (j > 0 && tasks[j - 1].cpu_x10 < s_tasks[i].info.cpu_x10) {
+            tasks[j] = tasks[j - 1];
+            j--;
+        }
+        tasks[j] = s_tasks[i].info;
+    }
+    xSemaphoreGive(s_lock);
+    return n;
+}
+
+uint8_t sys_monitor_fragmentation(const sys_monitor_heap_stats_t *heap)
+{
+    if (heap->free_bytes == 0) {
+        return 0;
+    }
+    return (uint8_t)(100 - (uint64_t)heap->largest_block * 100 / heap->free_bytes);
+}
+
+const char *sys_monitor_heap_name(sys_monitor_heap_t heap)
+{
+    return heap < SYS_MONITOR_HEAP_MAX ? s_heap_names[heap] : "?";
+}
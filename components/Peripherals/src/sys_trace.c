@@ -0,0 +1,293 @@
+/**
+ * @file sys_trace.c
+ * @brief 系统级事件追踪 - 每核无锁环形缓冲与 Chrome trace JSON 导出
+ */
+
+#include "sys_trace.h"
+
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_attr.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "SYS_TRACE";
+
+#define SYS_TRACE_JSON_CHUNK 512 // 导出时攒够一块再调用输出函数
+#define SYS_TRACE_MAX_THREADS 48 // 导出时记录的不同 tid 数，超出的不输出线程名
+
+typedef struct {
+    uint32_t head; // 下一个写入序号 (原子自增)，槽位 = head & mask
+    uint32_t mask;
+    sys_trace_event_t *events;
+} sys_trace_ring_t;
+
+static sys_trace_ring_t s_rings[portNUM_PROCESSORS];
+static volatile bool s_recording = false;
+static uint32_t s_capacity = 0;
+
+esp_err_t sys_trace_init(size_t events_per_core)
+{
+    if (s_capacity != 0) {
+        return ESP_OK;
+    }
+    if (events_per_core == 0) {
+        events_per_core = SYS_TRACE_DEFAULT_EVENTS;
+    }
+    uint32_t capacity = 16;
+    while (capacity < events_per_core) {
+        capacity <<= 1;
+    }
+
+    for (int i = 0; i < portNUM_PROCESSORS; i++) {
+        // 写入在热路径上，放内部 RAM
+        s_rings[i].events = heap_caps_calloc(capacity, sizeof(sys_trace_event_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (s_rings[i].events == NULL) {
+            ESP_LOGE(TAG, "Failed to allocate %" PRIu32 " events for core %d", capacity, i);
+            for (int j = 0; j < i; j++) {
+                heap_caps_free(s_rings[j].events);
+                s_rings[j].events = NULL;
+            }
+            return ESP_ERR_NO_MEM;
+        }
+        s_rings[i].head = 0;
+        s_rings[i].mask = capacity - 1;
+    }
+    s_capacity = capacity;
+    ESP_LOGI(TAG, "Trace buffers: %" PRIu32 " events x %d cores (%u bytes)", capacity, portNUM_PROCESSORS,
+             (unsigned)(capacity * portNUM_PROCESSORS * sizeof(sys_trace_event_t)));
+    return ESP_OK;
+}
+
+void sys_trace_start(void)
+{
+    s_recording = s_capacity != 0;
+}
+
+void sys_trace_stop(void)
+{
+    s_recording = false;
+}
+
+bool sys_trace_is_recording(void)
+{
+    return s_recording;
+}
+
+void sys_trace_clear(void)
+{
+    if (s_capacity == 0) {
+        return;
+    }
+    const bool was_recording = s_recording;
+    s_recording = false;
+    for (int i = 0; i < portNUM_PROCESSORS; i++) {
+        memset(s_rings[i].events, 0, s_capacity * sizeof(sys_trace_event_t));
+        __atomic_store_n(&s_rings[i].head, 0, __ATOMIC_RELEASE);
+    }
+    s_recording = was_recording;
+}
+
+void IRAM_ATTR sys_trace_emit(sys_trace_type_t type, const char *name, int32_t value)
+{
+    if (!s_recording) {
+        return;
+    }
+    // 取号后被抢占迁到另一核也没关系: 序号是原子分配的，只是事件落在另一核的环里
+    sys_trace_ring_t *ring = &s_rings[xPortGetCoreID()];
+    const uint32_t idx = __atomic_fetch_add(&ring->head, 1, __ATOMIC_RELAXED);
+    sys_trace_event_t *ev = &ring->events[idx & ring->mask];
+
+    __atomic_store_n(&ev->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    ev->ts_us = (uint32_t)esp_timer_get_time();
+    ev->name = name;
+    ev->tid = xPortInIsrContext() ? (SYS_TRACE_TID_ISR | xPortGetCoreID())
+                                  : (uint32_t)(uintptr_t)xTaskGetCurrentTaskHandle();
+    ev->value = value;
+    ev->type = (uint8_t)type;
+    __atomic_store_n(&ev->seq, idx + 1, __ATOMIC_RELEASE);
+}
+
+void sys_trace_get_stats(sys_trace_stats_t *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    stats->capacity = s_capacity;
+    for (int i = 0; i < portNUM_PROCESSORS && s_capacity != 0; i++) {
+        const uint32_t head = __atomic_load_n(&s_rings[i].head, __ATOMIC_ACQUIRE);
+        stats->recorded += head;
+        if (head > s_capacity) {
+            stats->lost += head - s_capacity;
+        }
+    }
+}
+
+/**
+ * @brief 读出序号为 idx 的事件，槽位正在写或已被覆盖时返回 false
+ */
+static bool ring_read(const sys_trace_ring_t *ring, uint32_t idx, sys_trace_event_t *out)
+{
+    const sys_trace_event_t *ev = &ring->events[idx & ring->mask];
+    const uint32_t seq = __atomic_load_n(&ev->seq, __ATOMIC_ACQUIRE);
+    if (seq != idx + 1) {
+        return false;
+    }
+    memcpy(out, ev, sizeof(*out));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&ev->seq, __ATOMIC_RELAXED) == seq;
+}
+
+// ========================================
+// Chrome trace JSON 导出
+// ========================================
+
+typedef struct {
+    sys_trace_write_fn_t write;
+    void *ctx;
+    bool failed;
+    size_t len;
+    char buf[SYS_TRACE_JSON_CHUNK];
+} json_out_t;
+
+static void json_flush(json_out_t *out)
+{
+    if (!out->failed && out->len > 0 && out->write(out->ctx, out->buf, out->len) < 0) {
+        out->failed = true;
+    }
+    out->len = 0;
+}
+
+static void json_printf(json_out_t *out, const char *fmt, ...)
+{
+    for (int attempt = 0; attempt < 2; attempt++) {
+        va_list args;
+        va_start(args, fmt);
+        const int n = vsnprintf(out->buf + out->len, sizeof(out->buf) - out->len, fmt, args);
+        va_end(args);
+        if (n >= 0 && out->len + (size_t)n < sizeof(out->buf)) {
+            out->len += (size_t)n;
+            return;
+        }
+        // 放不下: 先把已有内容发出去再重试一次 (单条记录远小于缓冲)
+        json_flush(out);
+    }
+}
+
+static void thread_name(uint32_t tid, const TaskStatus_t *tasks, UBaseType_t task_count, char *name, size_t size)
+{
+    if ((tid & SYS_TRACE_TID_ISR) == SYS_TRACE_TID_ISR) {
+        snprintf(name, size, "ISR cpu%u", (unsigned)(tid & 0xFF));
+        return;
+    }
+    for (UBaseType_t i = 0; i < task_count; i++) {
+        if ((uint32_t)(uintptr_t)tasks[i].xHandle == tid) {
+            snprintf(name, size, "%s", tasks[i].pcTaskName);
+            return;
+        }
+    }
+    // 任务已删除
+    snprintf(name, size, "task %08" PRIx32, tid);
+}
+
+static void json_thread_names(json_out_t *out, const uint32_t *tids, int tid_count)
+{
+    // 只在导出时查任务名，热路径上只存任务句柄
+    UBaseType_t task_count = uxTaskGetNumberOfTasks() + 4;
+    TaskStatus_t *tasks = malloc(task_count * sizeof(TaskStatus_t));
+    task_count = tasks ? uxTaskGetSystemState(tasks, task_count, NULL) : 0;
+
+    char name[configMAX_TASK_NAME_LEN + 16];
+    for (int i = 0; i < tid_count; i++) {
+        thread_name(tids[i], tasks, task_count, name, sizeof(name));
+        json_printf(out, ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%" PRIu32 ",\"args\":{\"name\":\"%s\"}}",
+                    tids[i], name);
+    }
+    free(tasks);
+}
+
+esp_err_t sys_trace_write_json(sys_trace_write_fn_t write, void *ctx)
+{
+    if (s_capacity == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    json_out_t *out = calloc(1, sizeof(json_out_t));
+    if (out == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    out->write = write;
+    out->ctx = ctx;
+
+    // 导出期间暂停记录，避免边读边被覆盖
+    const bool was_recording = s_recording;
+    s_recording = false;
+
+    sys_trace_stats_t stats;
+    sys_trace_get_stats(&stats);
+    const int64_t now = esp_timer_get_time();
+
+    json_printf(out, "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"capacity\":%" PRIu32 ",\"recorded\":%" PRIu32
+                     ",\"lost\":%" PRIu32 "},\n\"traceEvents\":[\n"
+                     "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"ESP32-S3\"}}",
+                stats.capacity, stats.recorded, stats.lost);
+
+    uint32_t tids[SYS_TRACE_MAX_THREADS];
+    int tid_count = 0;
+    for (int core = 0; core < portNUM_PROCESSORS && !out->failed; core++) {
+        const sys_trace_ring_t *ring = &s_rings[core];
+        const uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        const uint32_t first = head > s_capacity ? head - s_capacity : 0;
+
+        // Chrome 按时间戳排序，各环按写入顺序输出即可
+        for (uint32_t idx = first; idx != head && !out->failed; idx++) {
+            sys_trace_event_t ev;
+            if (!ring_read(ring, idx, &ev) || ev.name == NULL) {
+                continue;
+            }
+            // 低 32 位时间戳还原为 64 位 (事件不早于 71 分钟前)
+            const int64_t ts = now - (int64_t)(uint32_t)((uint32_t)now - ev.ts_us);
+
+            int t = 0;
+            while (t < tid_count && tids[t] != ev.tid) {
+                t++;
+            }
+            if (t == tid_count && tid_count < SYS_TRACE_MAX_THREADS) {
+                tids[tid_count++] = ev.tid;
+            }
+
+            switch (ev.type) {
+            case SYS_TRACE_EV_BEGIN:
+            case SYS_TRACE_EV_END:
+                json_printf(out, ",\n{\"ph\":\"%c\",\"name\":\"%s\",\"ts\":%" PRId64 ",\"pid\":1,\"tid\":%" PRIu32 "}",
+                            ev.type == SYS_TRACE_EV_BEGIN ? 'B' : 'E', ev.name, ts, ev.tid);
+                break;
+            case SYS_TRACE_EV_INSTANT:
+                json_printf(out, ",\n{\"ph\":\"i\",\"s\":\"t\",\"name\":\"%s\",\"ts\":%" PRId64 ",\"pid\":1,\"tid\":%" PRIu32 "}",
+                            ev.name, ts, ev.tid);
+                break;
+            case SYS_TRACE_EV_COUNTER:
+                json_printf(out, ",\n{\"ph\":\"C\",\"name\":\"%s\",\"ts\":%" PRId64 ",\"pid\":1,\"tid\":%" PRIu32
+                                 ",\"args\":{\"value\":%" PRId32 "}}",
+                            ev.name, ts, ev.tid, ev.value);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    json_thread_names(out, tids, tid_count);
+    json_printf(out, "\n]}\n");
+    json_flush(out);
+
+    s_recording = was_recording;
+    const esp_err_t ret = out->failed ? ESP_FAIL : ESP_OK;
+    free(out);
+    return ret;
+}
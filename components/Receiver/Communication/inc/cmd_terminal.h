@@ -1,6 +1,7 @@
 #ifndef CMD_TERMINAL_H
 #define CMD_TERMINAL_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include "tcp_common_protocol.h"
@@ -43,9 +44,10 @@ bool cmd_terminal_confirm_restart(void);
 /**
  * @brief 处理扩展命令
  * @param cmd_data 扩展命令负载数据指针
+ * @param payload_len 帧中负载的实际长度 (协议头 length - 1)，参数按此截断
  * @note 用于处理来自USB/SPI的扩展命令
  */
-void handle_extended_command(const extended_cmd_payload_t* cmd_data);
+void handle_extended_command(const extended_cmd_payload_t* cmd_data, size_t payload_len);
 
 /**
  * @brief 处理文本命令行
@@ -2,6 +2,7 @@
 #define SPI_SLAVE_RECEIVER_H
 
 #include "esp_err.h"
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -14,15 +15,34 @@ extern "C" {
 #define SPI_SLAVE_PIN_SCLK 42
 #define SPI_SLAVE_PIN_CS 39
 
-// 事务与缓冲配置
-#define SPI_RX_QUEUE_SIZE 2
-#define SPI_RX_TRANSACTION_SZ 512 // 单次事务最大接收字节数
-#define SPI_RX_BUFFER_SZ 1024     // 累积解析缓冲
+// 事务与缓冲配置: DMA 缓冲组成环，解析器与编码器按引用使用，全部释放后才重新排队
+#define SPI_RX_QUEUE_SIZE 6          // 环中 DMA 缓冲 (事务) 个数
+#define SPI_RX_TRANSACTION_SZ 4096   // 单次事务最大接收字节数 (4 字节对齐)
+
+// 接收统计
+typedef struct {
+    uint32_t transactions;     // 完成的事务数
+    uint64_t rx_bytes;         // 接收字节数
+    uint32_t frames;           // 有效协议帧数
+    uint32_t split_frames;     // 跨缓冲拼接的协议帧数
+    uint32_t bad_frames;       // 校验失败的候选帧数
+    uint64_t image_bytes;      // 转发给编码器的图像字节数
+    uint32_t image_drops;      // 编码器队列满而丢弃的图像块数
+    uint32_t image_copies;     // 回退为拷贝投递的图像块数 (跨缓冲候选帧校验失败)
+    uint32_t requeue_errors;   // 事务重新排队失败次数
+    uint32_t min_queued_slots; // 观察到的最少已排队缓冲数 (为 0 说明主机可能丢数据)
+} spi_receiver_stats_t;
 
 esp_err_t spi_receiver_init(void);
 void spi_receiver_start(void);
 void spi_receiver_stop(void);
 
+/**
+ * @brief 获取接收统计
+ * @param stats 输出
+ */
+void spi_receiver_get_stats(spi_receiver_stats_t* stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,88 @@
+/**
+ * @file spi_stream_demux.h
+ * @brief SPI 从机字节流解复用: 从连续的 DMA 缓冲中就地分离协议帧与图像数据
+ *
+ * 数据流由原始图像字节和穿插其中的协议帧 ([AA 55 len type payload crc16]) 组成。
+ * 解复用器逐个喂入 DMA 缓冲，不做整体拷贝:
+ *  - 落在单个缓冲内的协议帧直接以缓冲内指针回调；
+ *  - 跨越缓冲边界的协议帧拼接到内部小缓冲 (不超过一帧最大长度) 后回调；
+ *  - 其余字节作为图像数据以 (缓冲, 偏移, 长度) 的形式按引用回调。
+ *
+ * 任意切分下的输出与重同步由 others/py_test_demo/spi_stream_demux_bench.py 在主机上校验。
+ */
+
+#ifndef SPI_STREAM_DEMUX_H
+#define SPI_STREAM_DEMUX_H
+
+#include "tcp_common_protocol.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 协议帧最大长度: 2(帧头) + 1(长度) + 255(类型+负载) + 2(CRC)
+#define SPI_STREAM_FRAME_MAX (2 + 1 + 255 + 2)
+
+/**
+ * @brief 图像数据回调
+ * @param user 用户上下文
+ * @param chunk 数据所在的 DMA 缓冲句柄；为 NULL 时 data 指向解复用器内部的临时缓冲，
+ *              回调返回后即失效，需要自行拷贝
+ * @param data 数据指针
+ * @param len 数据长度
+ */
+typedef void (*spi_stream_image_cb_t)(void* user, void* chunk, const uint8_t* data, size_t len);
+
+/**
+ * @brief 协议帧回调 (帧已通过 CRC 校验，data 仅在回调期间有效)
+ */
+typedef void (*spi_stream_frame_cb_t)(void* user, const uint8_t* frame, size_t len);
+
+typedef struct {
+    uint32_t frames;       // 有效协议帧数
+    uint32_t split_frames; // 跨缓冲拼接的协议帧数
+    uint32_t bad_frames;   // 帧头匹配但校验失败的候选帧数
+    uint64_t image_bytes;  // 转发的图像字节数
+} spi_stream_demux_stats_t;
+
+typedef struct {
+    spi_stream_image_cb_t on_image;
+    spi_stream_frame_cb_t on_frame;
+    void* user;
+
+    // 跨缓冲候选帧的拼接状态
+    uint8_t frame[SPI_STREAM_FRAME_MAX];
+    size_t frame_len;
+
+    spi_stream_demux_stats_t stats;
+} spi_stream_demux_t;
+
+/**
+ * @brief 初始化解复用器
+ */
+void spi_stream_demux_init(spi_stream_demux_t* demux, spi_stream_image_cb_t on_image,
+                           spi_stream_frame_cb_t on_frame, void* user);
+
+/**
+ * @brief 复位解析状态 (丢弃未完成的跨缓冲候选帧)
+ */
+void spi_stream_demux_reset(spi_stream_demux_t* demux);
+
+/**
+ * @brief 喂入一个 DMA 缓冲
+ *        回调在本函数内同步触发，顺序与字节流顺序一致
+ * @param demux 解复用器
+ * @param chunk 缓冲句柄，原样传给图像回调
+ * @param data 缓冲数据
+ * @param len 有效字节数
+ */
+void spi_stream_demux_feed(spi_stream_demux_t* demux, void* chunk, const uint8_t* data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SPI_STREAM_DEMUX_H
@@ -2,6 +2,9 @@
 #define USB_DEVICE_RECEIVER_H
 
 #include "esp_err.h"
+#include "usb_stream_framer.h"
+#include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -11,14 +14,61 @@ extern "C" {
 #define USB_DP_PIN 20
 #define USB_DM_PIN 19
 
-// CDC 接收缓冲
-#define USB_RX_CHUNK_SIZE 256
-#define USB_RX_BUFFER_SIZE 4096
+// CDC 接收: 图传/数据块帧负载直接读入帧缓冲 (PSRAM, 双缓冲)
+#define USB_RX_FRAME_BUF_COUNT 2
+#define USB_RX_FRAME_BUF_SIZE (256 * 1024) // 单帧最大负载，超出的帧整帧丢弃
+#define USB_RX_BUF_WAIT_MS 200             // 等待空闲帧缓冲的时间，期间停止读取 (主机端被 NAK)
+#define USB_RX_UNREAD_BUF_SIZE 4096        // TinyUSB 内部未读缓冲
+
+// CDC 发送
+#define USB_TX_TIMEOUT_MS 500 // 单次 flush 等待主机取走数据的时间
+
+typedef struct {
+    usb_stream_stats_t stream; // 分帧统计
+    uint32_t frames_forwarded; // 转交图传桥的 JPEG 帧
+    uint32_t frames_rejected;  // 图传桥未运行或队列满而丢弃的帧
+    uint32_t bulk_frames;      // 交给数据块接收方的帧
+    uint32_t buffer_waits;     // 因无空闲帧缓冲而暂停读取的次数
+    uint64_t tx_bytes;         // 已发送字节
+    uint32_t tx_stalls;        // 发送超时次数
+    float rx_kbps;             // 最近统计窗口的接收吞吐
+    float tx_kbps;             // 最近统计窗口的发送吞吐
+} usb_receiver_stats_t;
+
+/**
+ * @brief 数据块 (非 JPEG) 帧接收回调，在 USB 接收任务中同步调用，返回后缓冲即被回收
+ * @param info 帧头信息
+ * @param data 负载
+ * @param ctx 注册时传入的参数
+ */
+typedef void (*usb_receiver_bulk_sink_t)(const usb_stream_frame_info_t* info, const uint8_t* data, void* ctx);
 
 esp_err_t usb_receiver_init(void);
 void usb_receiver_start(void);
 void usb_receiver_stop(void);
 
+/**
+ * @brief 注册数据块帧接收方 (NULL 取消注册)
+ */
+void usb_receiver_register_bulk_sink(usb_receiver_bulk_sink_t sink, void* ctx);
+
+/**
+ * @brief 以图传帧格式向主机发送一段数据 (黑匣子/日志下载等)
+ * @param frame_type 帧类型 (USB_STREAM_FRAME_*)
+ * @param data 数据
+ * @param len 长度 (不超过 USB_STREAM_MAX_FRAME)
+ * @return ESP_OK 成功；ESP_ERR_INVALID_STATE 未连接；ESP_ERR_TIMEOUT 主机长时间未取走数据
+ * @note 阻塞直到全部数据写入 TinyUSB 发送缓冲，主机读取速度即为发送速度
+ */
+esp_err_t usb_receiver_stream_send(uint8_t frame_type, const uint8_t* data, size_t len);
+
+/**
+ * @brief 启动一次发送吞吐测试: 后台任务以 BULK 帧向主机发送 kb 千字节测试数据
+ */
+esp_err_t usb_receiver_bench_dump(uint32_t kb);
+
+void usb_receiver_get_stats(usb_receiver_stats_t* stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,129 @@
+/**
+ * @file usb_stream_framer.h
+ * @brief USB CDC 字节流分帧
+ *
+ * 同一条 CDC 链路上混合三类消息，在消息边界按首字节区分:
+ *  - 0x02 开头: 图传帧 [image_transfer_header_t(13B, 同步字 0xAEBC1402)][负载]；
+ *  - 0xAA 开头: 协议帧 [AA 55 len type payload crc16]；
+ *  - 其他: 以 \r 或 \n 结尾的文本命令行。
+ *
+ * 读取方不直接喂数据，而是先向分帧器要一个"读窗口"再把数据读进去:
+ * 解析帧头时窗口指向内部小暂存区；进入负载阶段后窗口直接指向接收方提供的帧缓冲，
+ * 负载从驱动一次读到最终位置，中间不再拷贝。
+ *
+ * others/py_test_demo/usb_stream_bench.py 的 pty 模式把本模块编译到主机上，以伪终端代替 CDC 端口做回环测试。
+ */
+
+#ifndef USB_STREAM_FRAMER_H
+#define USB_STREAM_FRAMER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define USB_STREAM_SYNC_WORD 0xAEBC1402
+#define USB_STREAM_HEADER_SIZE 13
+#define USB_STREAM_SCRATCH_SIZE 512       // 帧头/协议帧/文本行暂存区
+#define USB_STREAM_MAX_FRAME (512 * 1024) // 帧头中允许的最大负载长度
+#define USB_STREAM_LINE_MAX 192           // 文本行最大长度
+
+// 图传帧类型 (与 image_transfer_protocol.h 的 frame_type_t 一致，BULK 为本链路扩展)
+#define USB_STREAM_FRAME_JPEG 0x01
+#define USB_STREAM_FRAME_LZ4 0x02
+#define USB_STREAM_FRAME_BULK 0x10 // 黑匣子/日志等原始数据块
+
+typedef struct {
+    uint8_t frame_type;
+    uint16_t width;
+    uint16_t height;
+    uint32_t len;
+} usb_stream_frame_info_t;
+
+typedef struct {
+    /**
+     * @brief 帧头解析完成，为负载申请目标缓冲 (至少 info->len 字节)
+     * @return 目标缓冲；返回 NULL 时该帧负载被读入暂存区后丢弃
+     */
+    uint8_t* (*frame_begin)(void* user, const usb_stream_frame_info_t* info);
+    /**
+     * @brief 负载接收完成，data 为 frame_begin 返回的缓冲，所有权交回接收方
+     */
+    void (*frame_end)(void* user, const usb_stream_frame_info_t* info, uint8_t* data);
+    // 协议帧 (已通过 CRC 校验，仅在回调期间有效)
+    void (*on_protocol)(void* user, const uint8_t* frame, size_t len);
+    // 文本行 (不含换行，\0 结尾，仅在回调期间有效)
+    void (*on_line)(void* user, char* line);
+    void* user;
+} usb_stream_callbacks_t;
+
+typedef struct {
+    uint64_t rx_bytes;       // 提交的总字节数
+    uint64_t payload_bytes;  // 直接读入帧缓冲的负载字节数
+    uint64_t copied_bytes;   // 从暂存区拷贝到帧缓冲的负载字节数
+    uint32_t frames;         // 完整接收的图传帧
+    uint32_t dropped_frames; // 接收方无缓冲而丢弃的帧
+    uint32_t protocol_frames;
+    uint32_t lines;
+    uint32_t resync_bytes;   // 无法识别而跳过的字节
+} usb_stream_stats_t;
+
+typedef enum {
+    USB_STREAM_STATE_SCRATCH = 0, // 解析帧头/协议帧/文本
+    USB_STREAM_STATE_PAYLOAD,     // 负载直接读入帧缓冲
+    USB_STREAM_STATE_DISCARD,     // 丢弃负载
+} usb_stream_state_t;
+
+typedef struct {
+    usb_stream_callbacks_t cb;
+    usb_stream_state_t state;
+
+    uint8_t scratch[USB_STREAM_SCRATCH_SIZE];
+    size_t scratch_len;
+
+    usb_stream_frame_info_t info; // 当前帧
+    uint8_t* dest;                // 当前帧负载缓冲
+    size_t received;              // 当前帧已接收负载
+    size_t discard_remain;        // 丢弃状态剩余字节
+
+    usb_stream_stats_t stats;
+} usb_stream_framer_t;
+
+/**
+ * @brief 初始化分帧器
+ */
+void usb_stream_framer_init(usb_stream_framer_t* framer, const usb_stream_callbacks_t* cb);
+
+/**
+ * @brief 复位解析状态 (链路断开时调用)；正在接收的帧缓冲以 frame_end 之外的方式无法归还，
+ *        调用者需自行回收 framer->dest
+ */
+void usb_stream_framer_reset(usb_stream_framer_t* framer);
+
+/**
+ * @brief 获取下一次读取的目标窗口
+ * @param framer 分帧器
+ * @param[out] buf 窗口起始
+ * @return 窗口大小 (不会跨越当前帧负载的结尾)
+ */
+size_t usb_stream_framer_window(usb_stream_framer_t* framer, uint8_t** buf);
+
+/**
+ * @brief 提交已读入窗口的字节数，触发解析与回调
+ */
+void usb_stream_framer_commit(usb_stream_framer_t* framer, size_t n);
+
+/**
+ * @brief 生成图传帧头 (发送方向使用)
+ * @param out 至少 USB_STREAM_HEADER_SIZE 字节
+ */
+void usb_stream_framer_make_header(uint8_t* out, uint8_t frame_type, uint16_t width, uint16_t height, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // USB_STREAM_FRAMER_H
@@ -8,11 +8,16 @@
 #include "esp_netif.h"
 #include <ctype.h>
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "mem_arena.h"
+#include "sys_monitor.h"
 #include "tcp_common_protocol.h"
+#include "usb_device_receiver.h"
+#include "video_bridge.h"
 
 static const char* TAG = "cmd_terminal";
 
@@ -91,7 +96,7 @@ __attribute__((weak)) bool cmd_terminal_confirm_restart(void) {
 }
 
 static void respondf(const char* fmt, ...) {
-    char buf[512];  // 增加缓冲区大小以支持更长的help输出
+    char buf[768];  // 增加缓冲区大小以支持更长的help输出
     va_list ap;
     va_start(ap, fmt);
     vsnprintf(buf, sizeof(buf), fmt, ap);
@@ -163,6 +168,92 @@ static void print_task_info(void) {
 #endif
 }
 
+static void print_sys_monitor(const char* arg) {
+    if (!sys_monitor_is_running()) {
+        esp_err_t err = sys_monitor_start(0);
+        if (err != ESP_OK) {
+            respondf("采样启动失败: %s", esp_err_to_name(err));
+            return;
+        }
+    }
+
+    sys_monitor_sample_t sample;
+    if (!sys_monitor_get_latest(&sample)) {
+        respondf("采样已启动，请稍后再试");
+        return;
+    }
+
+    if (arg && strcmp(arg, "tasks") == 0) {
+        static sys_monitor_task_t tasks[SYS_MONITOR_MAX_TASKS];
+        size_t n = sys_monitor_get_tasks(tasks, SYS_MONITOR_MAX_TASKS);
+        respondf("%-16s %4s %4s %7s %8s", "任务名", "核", "优先级", "CPU%", "栈剩余");
+        for (size_t i = 0; i < n; i++) {
+            respondf("%-16s %4d %4u %5u.%u %8lu", tasks[i].name, tasks[i].core, tasks[i].priority,
+                     tasks[i].cpu_x10 / 10, tasks[i].cpu_x10 % 10, (unsigned long)tasks[i].stack_hwm);
+        }
+        return;
+    }
+
+    if (arg && strcmp(arg, "heap") == 0) {
+        respondf("%-8s %9s %9s %9s %5s %6s", "堆", "空闲", "最大块", "最低", "碎片%", "失败");
+        for (int i = 0; i < SYS_MONITOR_HEAP_MAX; i++) {
+            const sys_monitor_heap_stats_t* h = &sample.heap[i];
+            respondf("%-8s %9lu %9lu %9lu %5u %6lu", sys_monitor_heap_name((sys_monitor_heap_t)i),
+                     (unsigned long)h->free_bytes, (unsigned long)h->largest_block, (unsigned long)h->min_free,
+                     sys_monitor_fragmentation(h), (unsigned long)h->alloc_failures);
+        }
+        respondf("最近分配失败大小: %lu bytes", (unsigned long)sample.last_failed_size);
+        return;
+    }
+
+    if (arg && strcmp(arg, "hist") == 0) {
+        static sys_monitor_sample_t history[SYS_MONITOR_HISTORY];
+        size_t n = sys_monitor_get_history(history, SYS_MONITOR_HISTORY);
+        respondf("%10s %6s %6s %8s %8s", "时间ms", "core0", "core1", "int_free", "psram");
+        for (size_t i = 0; i < n; i++) {
+            respondf("%10lu %4u.%u %4u.%u %8lu %8lu", (unsigned long)history[i].timestamp_ms,
+                     history[i].core_load_x10[0] / 10, history[i].core_load_x10[0] % 10,
+                     history[i].core_load_x10[1] / 10, history[i].core_load_x10[1] % 10,
+                     (unsigned long)history[i].heap[SYS_MONITOR_HEAP_INTERNAL].free_bytes,
+                     (unsigned long)history[i].heap[SYS_MONITOR_HEAP_SPIRAM].free_bytes);
+        }
+        return;
+    }
+
+    respondf("core0 %u.%u%% core1 %u.%u%% tasks=%u\n"
+             "internal free=%lu largest=%lu frag=%u%%\n"
+             "dma free=%lu largest=%lu | spiram free=%lu largest=%lu\n"
+             "alloc fail int/dma/psram=%lu/%lu/%lu",
+             sample.core_load_x10[0] / 10, sample.core_load_x10[0] % 10, sample.core_load_x10[1] / 10,
+             sample.core_load_x10[1] % 10, sample.task_count,
+             (unsigned long)sample.heap[SYS_MONITOR_HEAP_INTERNAL].free_bytes,
+             (unsigned long)sample.heap[SYS_MONITOR_HEAP_INTERNAL].largest_block,
+             sys_monitor_fragmentation(&sample.heap[SYS_MONITOR_HEAP_INTERNAL]),
+             (unsigned long)sample.heap[SYS_MONITOR_HEAP_DMA].free_bytes,
+             (unsigned long)sample.heap[SYS_MONITOR_HEAP_DMA].largest_block,
+             (unsigned long)sample.heap[SYS_MONITOR_HEAP_SPIRAM].free_bytes,
+             (unsigned long)sample.heap[SYS_MONITOR_HEAP_SPIRAM].largest_block,
+             (unsigned long)sample.heap[SYS_MONITOR_HEAP_INTERNAL].alloc_failures,
+             (unsigned long)sample.heap[SYS_MONITOR_HEAP_DMA].alloc_failures,
+             (unsigned long)sample.heap[SYS_MONITOR_HEAP_SPIRAM].alloc_failures);
+}
+
+static void print_mem_arenas(void) {
+    mem_arena_stats_t arenas[16];
+    size_t n = mem_arena_get_all(arenas, sizeof(arenas) / sizeof(arenas[0]));
+    if (n == 0) {
+        respondf("未创建内存区");
+        return;
+    }
+    respondf("%-14s %4s %8s %8s %8s %8s %6s", "区", "类型", "容量", "已用", "高水位", "分配", "失败");
+    for (size_t i = 0; i < n; i++) {
+        respondf("%-14s %4s %8lu %8lu %8lu %8lu %6lu", arenas[i].name,
+                 arenas[i].kind == MEM_ARENA_KIND_POOL ? "pool" : "bump", (unsigned long)arenas[i].capacity,
+                 (unsigned long)arenas[i].used, (unsigned long)arenas[i].high_water, (unsigned long)arenas[i].allocs,
+                 (unsigned long)arenas[i].failures);
+    }
+}
+
 static void handle_text_command(char* line) {
     if (!line) return;
 
@@ -185,9 +276,13 @@ static void handle_text_command(char* line) {
                  "  heap                - 打印空闲堆内存\n"
                  "  tasks               - 打印任务数量\n"
                  "  taskinfo            - 显示详细任务信息\n"
+                 "  sysmon [tasks|heap|hist] - CPU/栈/堆采样统计\n"
+                 "  arena               - 子系统内存区用量/高水位\n"
                  "  version             - 打印IDF版本\n"
                  "  echo <text>         - 回显文本\n"
                  "  jpegq <0-100>       - 设置JPEG质量\n"
+                 "  video [test <fps>|stop] - 图传桥统计/合成帧源\n"
+                 "  usb [dump <kb>]     - USB流统计/向主机发送测试数据\n"
                  "  wifi <ssid> <pwd>   - 配置WiFi并保存到NVS\n"
                  "  wifir <ssid> <pwd>  - 配置WiFi并立即重启\n"
                  "  restart             - 软件重启\n"
@@ -210,6 +305,17 @@ static void handle_text_command(char* line) {
         return;
     }
 
+    if (strcmp(cmd, "sysmon") == 0) {
+        char* arg = strtok_r(NULL, " \t", &saveptr);
+        print_sys_monitor(arg);
+        return;
+    }
+
+    if (strcmp(cmd, "arena") == 0) {
+        print_mem_arenas();
+        return;
+    }
+
     if (strcmp(cmd, "version") == 0) {
         respondf("IDF: %s", esp_get_idf_version());
         return;
@@ -242,6 +348,57 @@ static void handle_text_command(char* line) {
         return;
     }
 
+    if (strcmp(cmd, "video") == 0) {
+        char* arg = strtok_r(NULL, " \t", &saveptr);
+        if (arg && strcmp(arg, "test") == 0) {
+            char* fps_str = strtok_r(NULL, " \t", &saveptr);
+            int fps = fps_str ? atoi(fps_str) : 10;
+            esp_err_t err = video_bridge_start_test_pattern((uint32_t)fps);
+            respondf("合成帧源 %d fps: %s", fps, esp_err_to_name(err));
+            return;
+        }
+        if (arg && strcmp(arg, "stop") == 0) {
+            video_bridge_stop_test_pattern();
+            respondf("合成帧源已停止");
+            return;
+        }
+        video_bridge_stats_t st;
+        video_bridge_get_stats(&st);
+        respondf("video %s q=%lu drops enc/q/send=%lu/%lu/%lu\n"
+                 "  enc %.1ffps %lu B/f lat %luus\n"
+                 "  send %.1ffps %.0fkbps lat %luus (queue %luus)",
+                 st.connected ? "up" : "down", (unsigned long)st.queue_depth, (unsigned long)st.encode_drops,
+                 (unsigned long)st.queue_drops, (unsigned long)st.send_drops, st.encode.fps,
+                 (unsigned long)(st.encode.frames ? st.encode.bytes / st.encode.frames : 0),
+                 (unsigned long)st.encode.latency_last_us, st.send.fps, st.send.kbps,
+                 (unsigned long)st.send.latency_last_us, (unsigned long)st.queue.latency_last_us);
+        return;
+    }
+
+    if (strcmp(cmd, "usb") == 0) {
+        char* arg = strtok_r(NULL, " \t", &saveptr);
+        if (arg && strcmp(arg, "dump") == 0) {
+            char* kb_str = strtok_r(NULL, " \t", &saveptr);
+            int kb = kb_str ? atoi(kb_str) : 1024;
+            if (kb <= 0) kb = 1024;
+            esp_err_t err = usb_receiver_bench_dump((uint32_t)kb);
+            respondf("usb dump %dKB: %s", kb, esp_err_to_name(err));
+            return;
+        }
+        usb_receiver_stats_t st;
+        usb_receiver_get_stats(&st);
+        respondf("usb rx %.0fkbps frames=%lu drop=%lu fwd=%lu rej=%lu bulk=%lu waits=%lu\n"
+                 "  proto=%lu lines=%lu resync=%lu copied=%llu\n"
+                 "  tx %.0fkbps bytes=%llu stalls=%lu",
+                 st.rx_kbps, (unsigned long)st.stream.frames, (unsigned long)st.stream.dropped_frames,
+                 (unsigned long)st.frames_forwarded, (unsigned long)st.frames_rejected,
+                 (unsigned long)st.bulk_frames, (unsigned long)st.buffer_waits,
+                 (unsigned long)st.stream.protocol_frames, (unsigned long)st.stream.lines,
+                 (unsigned long)st.stream.resync_bytes, (unsigned long long)st.stream.copied_bytes, st.tx_kbps,
+                 (unsigned long long)st.tx_bytes, (unsigned long)st.tx_stalls);
+        return;
+    }
+
     if (strcmp(cmd, "wifi") == 0 || strcmp(cmd, "wifir") == 0) {
         bool reboot_after = (strcmp(cmd, "wifir") == 0);
         
@@ -290,12 +447,17 @@ static void handle_text_command(char* line) {
 }
 
 // 覆盖弱符号：解析来自USB/SPI的扩展命令
-void handle_extended_command(const extended_cmd_payload_t* cmd_data) {
-    if (!cmd_data) return;
+void handle_extended_command(const extended_cmd_payload_t* cmd_data, size_t payload_len) {
+    if (!cmd_data || payload_len < offsetof(extended_cmd_payload_t, params)) return;
 
     // 约定: cmd_id == 0x01 表示文本终端命令，params中为ASCII命令行
     if (cmd_data->cmd_id == 0x01) {
+        // param_len 由发送端填写，不得超出帧内实际携带的参数
+        const size_t carried = payload_len - offsetof(extended_cmd_payload_t, params);
         size_t len = cmd_data->param_len;
+        if (len > carried) {
+            len = carried;
+        }
         if (len > sizeof(cmd_data->params)) {
             len = sizeof(cmd_data->params);
         }
@@ -5,13 +5,14 @@
 #include "esp_heap_caps.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
-#include "freertos/queue.h"
-#include "freertos/semphr.h"
 #include "freertos/task.h"
 #include "jpeg_stream_encoder.h"
 #include "settings_manager.h"
+#include "spi_stream_demux.h"
 #include "tcp_common_protocol.h"
 #include "cmd_terminal.h"
+#include "video_bridge.h"
+#include <stdatomic.h>
 #include <stdbool.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -19,186 +20,148 @@
 
 static const char* TAG = "spi_rx";
 
-// 接收缓冲与解析缓冲
-static uint8_t* s_rx_dma_bufs[SPI_RX_QUEUE_SIZE];
-static uint8_t* s_parse_buf = NULL;
-static size_t s_parse_len = 0;
+// DMA 缓冲环中的一个槽位
+typedef struct {
+    spi_slave_transaction_t trans;
+    uint8_t* buf;
+    atomic_int refs; // 解析器 + 编码器持有的引用数，归零后重新排队
+} spi_rx_slot_t;
+
+static spi_rx_slot_t s_slots[SPI_RX_QUEUE_SIZE];
+static spi_stream_demux_t s_demux;
 static TaskHandle_t s_task = NULL;
-static SemaphoreHandle_t s_spi_trans_done_sem = NULL;
-static spi_slave_transaction_t s_trans[SPI_RX_QUEUE_SIZE];
+static bool s_slave_ready = false;
+
+// 统计 (rx 任务写，其余任务只读)
+static spi_receiver_stats_t s_stats;
+static atomic_int s_queued_slots = 0;
+static atomic_uint s_image_drops = 0;
+static atomic_uint s_requeue_errors = 0;
 
-// JPEG输出回调函数
+// JPEG输出回调函数: 交给图传桥排队发送 (图传桥未启动时直接丢弃)
 static void jpeg_output_callback(const uint8_t* data, size_t len) {
-    // 这里可以将编码后的JPEG数据发送到其他地方
-    ESP_LOGI(TAG, "JPEG output received: %d bytes", len);
-    // TODO: 实现具体的输出处理逻辑
+    video_bridge_submit_frame(data, len);
 }
 
-// 当SPI传输完成时，在中断上下文中调用此回调
-static void IRAM_ATTR spi_post_trans_callback(spi_slave_transaction_t* trans) {
-    BaseType_t task_woken = pdFALSE;
-    if (s_spi_trans_done_sem) {
-        xSemaphoreGiveFromISR(s_spi_trans_done_sem, &task_woken);
-    }
-    if (task_woken) {
-        portYIELD_FROM_ISR();
+// 将槽位重新排入 SPI 从机队列
+static void spi_rx_slot_queue(spi_rx_slot_t* slot) {
+    slot->trans.length = SPI_RX_TRANSACTION_SZ * 8;
+    slot->trans.trans_len = 0;
+    atomic_fetch_add(&s_queued_slots, 1);
+    // 队列深度等于槽位数，正常情况下不会阻塞
+    if (spi_slave_queue_trans(SPI_RX_HOST, &slot->trans, 0) != ESP_OK) {
+        atomic_fetch_sub(&s_queued_slots, 1);
+        atomic_fetch_add(&s_requeue_errors, 1);
     }
 }
 
-// 解析并回调
-static void spi_parse_and_dispatch(const uint8_t* data, size_t len) {
-    if (!data || !s_parse_buf || len < MIN_FRAME_SIZE)
-        return;
+// 释放一个引用；最后一个使用者释放时把 DMA 缓冲还给驱动
+static void spi_rx_slot_release(void* ctx) {
+    spi_rx_slot_t* slot = (spi_rx_slot_t*)ctx;
+    if (atomic_fetch_sub(&slot->refs, 1) == 1) {
+        spi_rx_slot_queue(slot);
+    }
+}
 
-    size_t pos = 0;
-    while (pos + MIN_FRAME_SIZE <= len) {
-        if (pos + sizeof(protocol_header_t) > len)
-            break;
-        
-        // 检查帧头
-        if (data[pos] != FRAME_HEADER_1 || data[pos + 1] != FRAME_HEADER_2) {
-            pos++;
-            continue;
+// 图像数据: 按引用交给 JPEG 编码器
+static void spi_on_image(void* user, void* chunk, const uint8_t* data, size_t len) {
+    if (chunk == NULL) {
+        // 来自解复用器临时缓冲的少量字节，只能拷贝投递
+        s_stats.image_copies++;
+        if (jpeg_stream_encoder_feed_data(data, len) != ESP_OK) {
+            atomic_fetch_add(&s_image_drops, 1);
         }
+        return;
+    }
 
-        // 获取协议头信息
-        protocol_header_t* header = (protocol_header_t*)&data[pos];
-        size_t frame_size = sizeof(protocol_header_t) + header->length + sizeof(uint16_t);
-        
-        if (pos + frame_size > len)
-            break;
-
-        // 验证帧
-        if (validate_frame(&data[pos], frame_size)) {
-            switch (header->frame_type) {
-            case FRAME_TYPE_COMMAND:
-                // 处理命令帧（如遥控数据）
-                ESP_LOGI(TAG, "Received command frame");
-                break;
-            case FRAME_TYPE_HEARTBEAT:
-                // 处理心跳帧
-                ESP_LOGI(TAG, "Received heartbeat frame");
-                break;
-            case FRAME_TYPE_EXTENDED:
-                // 处理扩展帧
-                ESP_LOGI(TAG, "Received extended frame");
-                if (header->length >= sizeof(extended_cmd_payload_t)) {
-                    handle_extended_command((const extended_cmd_payload_t*)&data[pos + sizeof(protocol_header_t)]);
-                }
-                break;
-            default:
-                ESP_LOGW(TAG, "Unknown frame type: 0x%02X", header->frame_type);
-                break;
-            }
-        } else {
-            ESP_LOGW(TAG, "Frame validation failed");
-        }
-        pos += frame_size;
+    spi_rx_slot_t* slot = (spi_rx_slot_t*)chunk;
+    atomic_fetch_add(&slot->refs, 1);
+    if (jpeg_stream_encoder_feed_ref(data, len, spi_rx_slot_release, slot) != ESP_OK) {
+        // 编码器跟不上时丢弃该块，不阻塞 DMA 环；解析器仍持有引用，这里不会归零
+        atomic_fetch_sub(&slot->refs, 1);
+        atomic_fetch_add(&s_image_drops, 1);
     }
+}
 
-    if (pos < len) {
-        size_t remain = len - pos;
-        if (remain > SPI_RX_BUFFER_SZ)
-            remain = SPI_RX_BUFFER_SZ; // clamp
-        memmove(s_parse_buf, &data[pos], remain);
-        s_parse_len = remain;
-    } else {
-        s_parse_len = 0;
+// 协议帧: 在 DMA 缓冲 (或拼接缓冲) 中就地处理
+static void spi_on_frame(void* user, const uint8_t* frame, size_t len) {
+    const protocol_header_t* header = (const protocol_header_t*)frame;
+    switch (header->frame_type) {
+    case FRAME_TYPE_COMMAND:
+        // 处理命令帧（如遥控数据）
+        ESP_LOGD(TAG, "Received command frame");
+        break;
+    case FRAME_TYPE_HEARTBEAT:
+        // 处理心跳帧
+        ESP_LOGD(TAG, "Received heartbeat frame");
+        break;
+    case FRAME_TYPE_EXTENDED:
+        // 处理扩展帧
+        ESP_LOGD(TAG, "Received extended frame");
+        handle_extended_command((const extended_cmd_payload_t*)&frame[sizeof(protocol_header_t)], header->length - 1);
+        break;
+    default:
+        ESP_LOGD(TAG, "Unhandled frame type: 0x%02X", header->frame_type);
+        break;
     }
 }
 
-// SPI接收任务，现在由事件驱动
+// SPI接收任务: 按完成顺序取回事务，就地解复用
 static void spi_rx_task(void* arg) {
-    ESP_LOGI(TAG, "SPI 从机接收任务启动 (事件驱动)");
-
-    if (!s_parse_buf) {
-        ESP_LOGE(TAG, "Parse buffer not initialized");
-        vTaskDelete(NULL);
-        return;
-    }
+    ESP_LOGI(TAG, "SPI 从机接收任务启动 (DMA 环 %d x %d 字节)", SPI_RX_QUEUE_SIZE, SPI_RX_TRANSACTION_SZ);
 
     // 延迟一小段时间，确保其他初始化可以继续进行，避免潜在的启动死锁
     vTaskDelay(pdMS_TO_TICKS(10));
 
+    spi_stream_demux_init(&s_demux, spi_on_image, spi_on_frame, NULL);
+
     // 预先将所有事务排入队列
     for (int i = 0; i < SPI_RX_QUEUE_SIZE; i++) {
-        memset(&s_trans[i], 0, sizeof(spi_slave_transaction_t));
-        s_trans[i].length = SPI_RX_TRANSACTION_SZ * 8;
-        s_trans[i].rx_buffer = s_rx_dma_bufs[i];
-
-        esp_err_t ret = spi_slave_queue_trans(SPI_RX_HOST, &s_trans[i], portMAX_DELAY);
-        if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "Initial queue_trans err for trans #%d: %s", i, esp_err_to_name(ret));
-        }
+        memset(&s_slots[i].trans, 0, sizeof(spi_slave_transaction_t));
+        s_slots[i].trans.rx_buffer = s_slots[i].buf;
+        s_slots[i].trans.user = &s_slots[i];
+        atomic_store(&s_slots[i].refs, 0);
+        spi_rx_slot_queue(&s_slots[i]);
     }
+    s_stats.min_queued_slots = (uint32_t)atomic_load(&s_queued_slots);
 
     ESP_LOGI(TAG, "SPI transactions queued, waiting for incoming data...");
 
     while (1) {
-        // 等待来自ISR的回调信号，表示一个事务已完成
-        if (xSemaphoreTake(s_spi_trans_done_sem, portMAX_DELAY) == pdTRUE) {
-            spi_slave_transaction_t* ret_trans = NULL;
-            // 获取已完成的事务，超时设为0，因为它应该已经准备好了
-            esp_err_t ret = spi_slave_get_trans_result(SPI_RX_HOST, &ret_trans, 0);
-            if (ret != ESP_OK) {
-                ESP_LOGE(TAG, "get_trans_result err: %s", esp_err_to_name(ret));
-                continue;
-            }
-
-            size_t bytes = ret_trans->trans_len / 8;
-            if (bytes > 0) {
-                uint8_t* rxp = (uint8_t*)ret_trans->rx_buffer;
-
-                if (s_parse_len + bytes > SPI_RX_BUFFER_SZ) {
-                    size_t to_copy = SPI_RX_BUFFER_SZ;
-                    if (bytes < SPI_RX_BUFFER_SZ) {
-                        memmove(s_parse_buf, &s_parse_buf[s_parse_len + bytes - SPI_RX_BUFFER_SZ],
-                                SPI_RX_BUFFER_SZ - bytes);
-                        memcpy(&s_parse_buf[SPI_RX_BUFFER_SZ - bytes], rxp, bytes);
-                    } else {
-                        memcpy(s_parse_buf, &rxp[bytes - SPI_RX_BUFFER_SZ], SPI_RX_BUFFER_SZ);
-                    }
-                    s_parse_len = to_copy;
-                } else {
-                    memcpy(&s_parse_buf[s_parse_len], rxp, bytes);
-                    s_parse_len += bytes;
-                }
-
-                spi_parse_and_dispatch(s_parse_buf, s_parse_len);
-                // 异步通过JPEG编码器处理数据，避免在SPI线程内执行编码
-                if (bytes > 0) {
-                    esp_err_t ret_jpeg = jpeg_stream_encoder_feed_data(ret_trans->rx_buffer, bytes);
-                    if (ret_jpeg != ESP_OK) {
-                        ESP_LOGW(TAG, "JPEG encoder feed failed: %s, drop %d bytes",
-                                 esp_err_to_name(ret_jpeg), bytes);
-                    }
-                }
-            }
-            // 将刚刚处理完的事务重新排入队列，以备下次使用
-            ret = spi_slave_queue_trans(SPI_RX_HOST, ret_trans, portMAX_DELAY);
-            if (ret != ESP_OK) {
-                ESP_LOGE(TAG, "re-queue err: %s", esp_err_to_name(ret));
-            }
+        spi_slave_transaction_t* ret_trans = NULL;
+        esp_err_t ret = spi_slave_get_trans_result(SPI_RX_HOST, &ret_trans, portMAX_DELAY);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "get_trans_result err: %s", esp_err_to_name(ret));
+            continue;
         }
+
+        const int queued = atomic_fetch_sub(&s_queued_slots, 1) - 1;
+        if ((uint32_t)queued < s_stats.min_queued_slots) {
+            s_stats.min_queued_slots = (uint32_t)queued;
+        }
+
+        spi_rx_slot_t* slot = (spi_rx_slot_t*)ret_trans->user;
+        const size_t bytes = ret_trans->trans_len / 8;
+
+        // 解析器持有一个引用，解析期间编码器的释放不会提前把缓冲还给驱动
+        atomic_store(&slot->refs, 1);
+        s_stats.transactions++;
+        s_stats.rx_bytes += bytes;
+        spi_stream_demux_feed(&s_demux, slot, slot->buf, bytes);
+        spi_rx_slot_release(slot);
     }
 }
 
-esp_err_t spi_receiver_init(void) {
-    // 创建用于任务同步的二进制信号量
-    s_spi_trans_done_sem = xSemaphoreCreateBinary();
-    if (!s_spi_trans_done_sem) {
-        ESP_LOGE(TAG, "Failed to create semaphore");
-        return ESP_ERR_NO_MEM;
+static void spi_free_slots(void) {
+    for (int i = 0; i < SPI_RX_QUEUE_SIZE; i++) {
+        if (s_slots[i].buf) {
+            heap_caps_free(s_slots[i].buf);
+            s_slots[i].buf = NULL;
+        }
     }
+}
 
-    // Allocate parse buffer from PSRAM to save internal RAM
-    s_parse_buf = (uint8_t*)heap_caps_malloc(SPI_RX_BUFFER_SZ, MALLOC_CAP_SPIRAM);
-    if (!s_parse_buf) {
-        ESP_LOGE(TAG, "Failed to allocate parse buffer from PSRAM");
-        vSemaphoreDelete(s_spi_trans_done_sem);
-        s_spi_trans_done_sem = NULL;
-        return ESP_ERR_NO_MEM;
-    }
+esp_err_t spi_receiver_init(void) {
     // 初始化JPEG编码器
     if (jpeg_stream_encoder_init(jpeg_output_callback) != ESP_OK) {
         ESP_LOGW(TAG, "JPEG encoder initialization failed");
@@ -219,24 +182,19 @@ esp_err_t spi_receiver_init(void) {
                                 .max_transfer_sz = SPI_RX_TRANSACTION_SZ,
                                 .flags = SPICOMMON_BUSFLAG_GPIO_PINS};
 
+    // 队列深度等于环大小，所有槽位可同时挂在驱动上
     spi_slave_interface_config_t slv_cfg = {.mode = 0,
                                             .spics_io_num = SPI_SLAVE_PIN_CS,
                                             .queue_size = SPI_RX_QUEUE_SIZE,
                                             .flags = 0,
-                                            .post_trans_cb = spi_post_trans_callback};
+                                            .post_trans_cb = NULL};
 
-    // 分配 DMA 缓冲（队列中每个事务一个）
+    // 分配 DMA 缓冲（环中每个槽位一个，内部 RAM）
     for (int i = 0; i < SPI_RX_QUEUE_SIZE; i++) {
-        s_rx_dma_bufs[i] = (uint8_t*)heap_caps_malloc(SPI_RX_TRANSACTION_SZ, MALLOC_CAP_DMA);
-        if (!s_rx_dma_bufs[i]) {
+        s_slots[i].buf = (uint8_t*)heap_caps_malloc(SPI_RX_TRANSACTION_SZ, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+        if (!s_slots[i].buf) {
             ESP_LOGE(TAG, "DMA buffer alloc failed @%d", i);
-            for (int j = 0; j < i; j++) {
-                free(s_rx_dma_bufs[j]);
-            }
-            free(s_parse_buf);
-            s_parse_buf = NULL;
-            vSemaphoreDelete(s_spi_trans_done_sem);
-            s_spi_trans_done_sem = NULL;
+            spi_free_slots();
             return ESP_ERR_NO_MEM;
         }
     }
@@ -245,17 +203,11 @@ esp_err_t spi_receiver_init(void) {
     esp_err_t ret = spi_slave_initialize(SPI_RX_HOST, &bus_cfg, &slv_cfg, SPI_DMA_CH_AUTO);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "spi_slave_initialize fail: %s", esp_err_to_name(ret));
-        for (int i = 0; i < SPI_RX_QUEUE_SIZE; i++) {
-            if (s_rx_dma_bufs[i]) {
-                free(s_rx_dma_bufs[i]);
-            }
-        }
-        free(s_parse_buf);
-        s_parse_buf = NULL;
-        vSemaphoreDelete(s_spi_trans_done_sem);
-        s_spi_trans_done_sem = NULL;
+        spi_free_slots();
         return ret;
     }
+    s_slave_ready = true;
+    memset(&s_stats, 0, sizeof(s_stats));
     ESP_LOGI(TAG, "SPI 从机初始化完成: host=%d, MOSI=%d MISO=%d SCLK=%d CS=%d", SPI_RX_HOST,
              SPI_SLAVE_PIN_MOSI, SPI_SLAVE_PIN_MISO, SPI_SLAVE_PIN_SCLK, SPI_SLAVE_PIN_CS);
 
@@ -263,7 +215,7 @@ esp_err_t spi_receiver_init(void) {
 }
 
 void spi_receiver_start(void) {
-    if (s_task)
+    if (s_task || !s_slave_ready)
         return;
     xTaskCreatePinnedToCore(spi_rx_task, "spi_rx", 4096, NULL, 5, &s_task, 1);
 }
@@ -273,27 +225,29 @@ void spi_receiver_stop(void) {
         vTaskDelete(s_task);
         s_task = NULL;
     }
-    spi_slave_free(SPI_RX_HOST);
 
-    // 停止JPEG编码器
+    // 先停止JPEG编码器，归还其持有的全部缓冲引用
     jpeg_stream_encoder_stop();
 
-    // 释放信号量
-    if (s_spi_trans_done_sem) {
-        vSemaphoreDelete(s_spi_trans_done_sem);
-        s_spi_trans_done_sem = NULL;
+    if (s_slave_ready) {
+        spi_slave_free(SPI_RX_HOST);
+        s_slave_ready = false;
     }
+    atomic_store(&s_queued_slots, 0);
 
     // Free DMA buffers
-    for (int i = 0; i < SPI_RX_QUEUE_SIZE; i++) {
-        if (s_rx_dma_bufs[i]) {
-            free(s_rx_dma_bufs[i]);
-            s_rx_dma_bufs[i] = NULL;
-        }
-    }
+    spi_free_slots();
+}
 
-    if (s_parse_buf) {
-        free(s_parse_buf);
-        s_parse_buf = NULL;
+void spi_receiver_get_stats(spi_receiver_stats_t* stats) {
+    if (!stats) {
+        return;
     }
+    *stats = s_stats;
+    stats->frames = s_demux.stats.frames;
+    stats->split_frames = s_demux.stats.split_frames;
+    stats->bad_frames = s_demux.stats.bad_frames;
+    stats->image_bytes = s_demux.stats.image_bytes;
+    stats->image_drops = atomic_load(&s_image_drops);
+    stats->requeue_errors = atomic_load(&s_requeue_errors);
 }
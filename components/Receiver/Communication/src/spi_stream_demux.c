@@ -0,0 +1,181 @@
+/**
+ * @file spi_stream_demux.c
+ * @brief SPI 从机字节流解复用实现
+ */
+
+#include "spi_stream_demux.h"
+#include <string.h>
+
+typedef enum {
+    PROBE_NOT_FRAME = 0, // 不是协议帧，按图像数据处理
+    PROBE_NEED_MORE,     // 数据不足，无法判断
+    PROBE_FRAME,         // 完整且校验通过的协议帧
+} probe_result_t;
+
+static bool demux_frame_type_valid(uint8_t type) {
+    return type == FRAME_TYPE_COMMAND || type == FRAME_TYPE_TELEMETRY || type == FRAME_TYPE_HEARTBEAT ||
+           type == FRAME_TYPE_EXTENDED;
+}
+
+/**
+ * @brief 检查以 FRAME_HEADER_1 开头的候选帧
+ * @param p 候选帧起始
+ * @param avail 可用字节数
+ * @param[out] size PROBE_NEED_MORE 时为判断所需的字节数，PROBE_FRAME 时为帧长度
+ */
+static probe_result_t demux_probe(spi_stream_demux_t* demux, const uint8_t* p, size_t avail, size_t* size) {
+    if (avail < 2) {
+        *size = 2;
+        return PROBE_NEED_MORE;
+    }
+    if (p[1] != FRAME_HEADER_2) {
+        return PROBE_NOT_FRAME;
+    }
+    if (avail < sizeof(protocol_header_t)) {
+        *size = sizeof(protocol_header_t);
+        return PROBE_NEED_MORE;
+    }
+
+    const protocol_header_t* header = (const protocol_header_t*)p;
+    if (header->length == 0 || !demux_frame_type_valid(header->frame_type)) {
+        return PROBE_NOT_FRAME;
+    }
+
+    // 完整帧长 = 2(帧头) + 1(长度) + length + 2(CRC)
+    const size_t total = 2 + 1 + (size_t)header->length + 2;
+    if (avail < total) {
+        *size = total;
+        return PROBE_NEED_MORE;
+    }
+    if (!validate_frame(p, (uint16_t)total)) {
+        demux->stats.bad_frames++;
+        return PROBE_NOT_FRAME;
+    }
+
+    *size = total;
+    return PROBE_FRAME;
+}
+
+static void demux_emit_image(spi_stream_demux_t* demux, void* chunk, const uint8_t* data, size_t len) {
+    if (len == 0) {
+        return;
+    }
+    demux->stats.image_bytes += len;
+    if (demux->on_image) {
+        demux->on_image(demux->user, chunk, data, len);
+    }
+}
+
+static void demux_emit_frame(spi_stream_demux_t* demux, const uint8_t* frame, size_t len) {
+    demux->stats.frames++;
+    if (demux->on_frame) {
+        demux->on_frame(demux->user, frame, len);
+    }
+}
+
+/**
+ * @brief 用当前缓冲继续拼接上一个缓冲遗留的候选帧
+ * @return 当前缓冲中已被候选帧消费的字节数，主扫描从此处开始
+ */
+static size_t demux_continue_split(spi_stream_demux_t* demux, const uint8_t* data, size_t len) {
+    size_t carried = demux->frame_len;
+
+    while (carried > 0) {
+        size_t pos = 0;
+        size_t size = 0;
+        probe_result_t result;
+
+        demux->frame_len = carried;
+        while ((result = demux_probe(demux, demux->frame, demux->frame_len, &size)) == PROBE_NEED_MORE) {
+            if (pos >= len) {
+                return len; // 整个缓冲都属于候选帧，等待下一个缓冲
+            }
+            size_t n = size - demux->frame_len;
+            if (n > len - pos) {
+                n = len - pos;
+            }
+            memcpy(&demux->frame[demux->frame_len], &data[pos], n);
+            demux->frame_len += n;
+            pos += n;
+        }
+
+        size_t drop;
+        if (result == PROBE_FRAME) {
+            demux->stats.split_frames++;
+            demux_emit_frame(demux, demux->frame, size);
+            if (size >= carried) {
+                demux->frame_len = 0;
+                return pos;
+            }
+            // 重新同步后找到的帧完全落在遗留字节内 (此时 pos 为 0): 其后的遗留字节继续处理
+            carried -= size;
+            memmove(demux->frame, &demux->frame[size], carried);
+            const uint8_t* next = memchr(demux->frame, FRAME_HEADER_1, carried);
+            drop = next ? (size_t)(next - demux->frame) : carried;
+        } else {
+            // 不是协议帧: 之前缓冲中的字节已无法按引用转发，以临时数据交出，
+            // 并在遗留字节中寻找下一个帧头继续尝试；当前缓冲从头重新扫描
+            const uint8_t* next = memchr(&demux->frame[1], FRAME_HEADER_1, carried - 1);
+            drop = next ? (size_t)(next - demux->frame) : carried;
+        }
+        demux_emit_image(demux, NULL, demux->frame, drop);
+        carried -= drop;
+        memmove(demux->frame, &demux->frame[drop], carried);
+    }
+
+    demux->frame_len = 0;
+    return 0;
+}
+
+void spi_stream_demux_init(spi_stream_demux_t* demux, spi_stream_image_cb_t on_image,
+                           spi_stream_frame_cb_t on_frame, void* user) {
+    memset(demux, 0, sizeof(*demux));
+    demux->on_image = on_image;
+    demux->on_frame = on_frame;
+    demux->user = user;
+}
+
+void spi_stream_demux_reset(spi_stream_demux_t* demux) {
+    demux->frame_len = 0;
+}
+
+void spi_stream_demux_feed(spi_stream_demux_t* demux, void* chunk, const uint8_t* data, size_t len) {
+    if (!demux || !data || len == 0) {
+        return;
+    }
+
+    size_t pos = 0;
+    if (demux->frame_len > 0) {
+        pos = demux_continue_split(demux, data, len);
+    }
+
+    size_t span = pos; // 尚未转发的图像数据起点
+    while (pos < len) {
+        const uint8_t* hit = memchr(&data[pos], FRAME_HEADER_1, len - pos);
+        if (!hit) {
+            break;
+        }
+        pos = (size_t)(hit - data);
+
+        size_t size = 0;
+        probe_result_t result = demux_probe(demux, &data[pos], len - pos, &size);
+        if (result == PROBE_FRAME) {
+            // 缓冲内完整帧: 就地回调
+            demux_emit_image(demux, chunk, &data[span], pos - span);
+            demux_emit_frame(demux, &data[pos], size);
+            pos += size;
+            span = pos;
+        } else if (result == PROBE_NEED_MORE) {
+            // 候选帧延伸到缓冲末尾之外: 仅拷贝这一小段，等待下一个缓冲
+            demux_emit_image(demux, chunk, &data[span], pos - span);
+            demux->frame_len = len - pos;
+            memcpy(demux->frame, &data[pos], demux->frame_len);
+            span = len;
+            pos = len;
+        } else {
+            pos++;
+        }
+    }
+
+    demux_emit_image(demux, chunk, &data[span], len - span);
+}
@@ -7,145 +7,166 @@
 
 #include "esp_heap_caps.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "freertos/task.h"
 #include "tcp_common_protocol.h"
 #include "cmd_terminal.h"
+#include "video_bridge.h"
 #include <string.h>
 
 static const char* TAG = "usb_rx";
 
+#define USB_RX_IDLE_WAIT_MS 100              // 无数据时等待接收回调通知的兜底超时
+#define USB_TX_BENCH_FRAME_SIZE (64 * 1024)  // 发送测试单帧大小
+
+// 吞吐统计窗口
+typedef struct {
+    int64_t start_us;
+    uint64_t start_bytes;
+    float kbps;
+} usb_rate_t;
+
 static TaskHandle_t s_usb_task = NULL;
-static uint8_t s_rx_chunk[USB_RX_CHUNK_SIZE];
-static uint8_t* s_parse_buf = NULL;
-static size_t s_parse_len = 0;
-static bool s_usb_connected = false;
+static TaskHandle_t s_bench_task = NULL;
+static volatile bool s_usb_connected = false;
+static volatile bool s_link_reset = false; // 连接断开，接收任务需复位分帧器
+
+static usb_stream_framer_t s_framer;
+static uint8_t* s_frame_bufs[USB_RX_FRAME_BUF_COUNT];
+static QueueHandle_t s_free_bufs = NULL; // 空闲帧缓冲
+static SemaphoreHandle_t s_tx_mutex = NULL;
+
+static usb_receiver_bulk_sink_t s_bulk_sink = NULL;
+static void* s_bulk_ctx = NULL;
+
+static uint32_t s_frames_forwarded = 0;
+static uint32_t s_frames_rejected = 0;
+static uint32_t s_bulk_frames = 0;
+static uint32_t s_buffer_waits = 0;
+static uint64_t s_tx_bytes = 0;
+static uint32_t s_tx_stalls = 0;
+static usb_rate_t s_rx_rate;
+static usb_rate_t s_tx_rate;
+
+static void usb_rate_update(usb_rate_t* rate, uint64_t total) {
+    const int64_t now = esp_timer_get_time();
+    if (rate->start_us == 0) {
+        rate->start_us = now;
+        rate->start_bytes = total;
+        return;
+    }
+    const int64_t elapsed = now - rate->start_us;
+    if (elapsed >= 1000000) {
+        rate->kbps = (float)(total - rate->start_bytes) * 8000.0f / (float)elapsed;
+        rate->start_us = now;
+        rate->start_bytes = total;
+    }
+}
 
 // USB CDC 连接状态回调
 static void usb_line_state_changed_callback(int itf, cdcacm_event_t* event) {
     if (event->type == CDC_EVENT_LINE_STATE_CHANGED) {
         bool dtr = event->line_state_changed_data.dtr;
         bool rts = event->line_state_changed_data.rts;
+        const bool was_connected = s_usb_connected;
         s_usb_connected = (dtr && rts);
+        if (was_connected && !s_usb_connected) {
+            s_link_reset = true;
+        }
         ESP_LOGI(TAG, "USB连接状态: DTR=%d, RTS=%d, 连接=%s", dtr, rts,
                  s_usb_connected ? "已连接" : "断开");
     }
 }
 
-static void parse_and_dispatch(const uint8_t* data, size_t len) {
-    if (!data || !s_parse_buf || len == 0)
-        return;
+// USB CDC 接收回调 (TinyUSB 任务上下文): 唤醒接收任务
+static void usb_rx_callback(int itf, cdcacm_event_t* event) {
+    if (s_usb_task) {
+        xTaskNotifyGive(s_usb_task);
+    }
+}
 
-    // 判断模式：若缓冲区以协议帧头(0xAA55)起始，则按二进制帧解析；否则按ASCII行命令解析
-    if (len >= 2 && data[0] == FRAME_HEADER_1 && data[1] == FRAME_HEADER_2) {
-        size_t pos = 0;
-        while (pos + MIN_FRAME_SIZE <= len) {
-            if (pos + sizeof(protocol_header_t) > len)
-                break;
-            
-            // 检查帧头
-            if (data[pos] != FRAME_HEADER_1 || data[pos + 1] != FRAME_HEADER_2) {
-                // 在二进制模式下遇到非帧头字节，跳过1字节
-                pos++;
-                continue;
-            }
-            
-            // 获取协议头信息
-            protocol_header_t* header = (protocol_header_t*)&data[pos];
-            size_t frame_size = sizeof(protocol_header_t) + header->length + sizeof(uint16_t);
-            
-            if (pos + frame_size > len)
-                break; // 帧不完整，等待更多数据
-
-            // 验证帧
-            if (validate_frame(&data[pos], frame_size)) {
-                switch (header->frame_type) {
-                case FRAME_TYPE_COMMAND:
-                    // 处理命令帧（如遥控数据）
-                    ESP_LOGI(TAG, "Received command frame via USB");
-                    break;
-                case FRAME_TYPE_HEARTBEAT:
-                    // 处理心跳帧
-                    ESP_LOGI(TAG, "Received heartbeat frame via USB");
-                    break;
-                case FRAME_TYPE_EXTENDED:
-                    // 处理扩展帧
-                    ESP_LOGI(TAG, "Received extended frame via USB");
-                    if (header->length >= sizeof(extended_cmd_payload_t)) {
-                        handle_extended_command((const extended_cmd_payload_t*)&data[pos + sizeof(protocol_header_t)]);
-                    }
-                    break;
-                default:
-                    ESP_LOGW(TAG, "Unknown frame type: 0x%02X", header->frame_type);
-                    break;
-                }
-            } else {
-                ESP_LOGW(TAG, "Frame validation failed via USB");
-            }
-            pos += frame_size;
-        }
-        if (pos < len) {
-            size_t remain = len - pos;
-            if (remain > USB_RX_BUFFER_SIZE)
-                remain = USB_RX_BUFFER_SIZE;
-            memmove(s_parse_buf, &data[pos], remain);
-            s_parse_len = remain;
-        } else {
-            s_parse_len = 0;
+// 帧缓冲归还 (图传桥发送完成或丢弃后调用)
+static void usb_frame_release(void* ctx) {
+    uint8_t* buf = (uint8_t*)ctx;
+    xQueueSend(s_free_bufs, &buf, 0);
+}
+
+static uint8_t* usb_on_frame_begin(void* user, const usb_stream_frame_info_t* info) {
+    if (info->len > USB_RX_FRAME_BUF_SIZE) {
+        ESP_LOGW(TAG, "帧过大 (%lu 字节)，丢弃", (unsigned long)info->len);
+        return NULL;
+    }
+    uint8_t* buf = NULL;
+    if (xQueueReceive(s_free_bufs, &buf, 0) == pdTRUE) {
+        return buf;
+    }
+    // 两个缓冲都在下游: 暂停读取，TinyUSB 接收 FIFO 填满后主机被 NAK，形成流控
+    s_buffer_waits++;
+    if (xQueueReceive(s_free_bufs, &buf, pdMS_TO_TICKS(USB_RX_BUF_WAIT_MS)) == pdTRUE) {
+        return buf;
+    }
+    return NULL;
+}
+
+static void usb_on_frame_end(void* user, const usb_stream_frame_info_t* info, uint8_t* data) {
+    if (info->frame_type == USB_STREAM_FRAME_JPEG) {
+        // 按引用交给图传桥，发送完成后由桥归还缓冲
+        if (video_bridge_submit_frame_ref(data, info->len, info->width, info->height, usb_frame_release, data) ==
+            ESP_OK) {
+            s_frames_forwarded++;
+            return;
         }
+        s_frames_rejected++;
+    } else if (s_bulk_sink) {
+        s_bulk_sink(info, data, s_bulk_ctx);
+        s_bulk_frames++;
     } else {
-        // 文本模式：按行(\r/\n)拆分并分发到命令终端
-        size_t start = 0;
-        while (start < len) {
-            size_t i = start;
-            size_t line_end = (size_t)-1;
-            for (; i < len; ++i) {
-                if (data[i] == '\n' || data[i] == '\r') {
-                    line_end = i;
-                    break;
-                }
-            }
-            if (line_end == (size_t)-1) {
-                break; // 无完整行，等待更多数据
-            }
-            size_t line_len = line_end - start;
-            char linebuf[192];
-            if (line_len >= sizeof(linebuf))
-                line_len = sizeof(linebuf) - 1;
-            memcpy(linebuf, &data[start], line_len);
-            linebuf[line_len] = '\0';
-            cmd_terminal_handle_line(linebuf);
-            // 跳过换行符（支持CRLF/ LFCR）
-            size_t skip = 1;
-            if (line_end + 1 < len) {
-                if ((data[line_end] == '\r' && data[line_end + 1] == '\n') ||
-                    (data[line_end] == '\n' && data[line_end + 1] == '\r')) {
-                    skip = 2;
-                }
-            }
-            start = line_end + skip;
-        }
-        // 将未完成的最后一行保留到解析缓冲
-        if (start < len) {
-            size_t remain = len - start;
-            if (remain > USB_RX_BUFFER_SIZE)
-                remain = USB_RX_BUFFER_SIZE;
-            memmove(s_parse_buf, &data[start], remain);
-            s_parse_len = remain;
-        } else {
-            s_parse_len = 0;
-        }
+        ESP_LOGD(TAG, "未处理的帧类型: 0x%02X", info->frame_type);
+        s_frames_rejected++;
     }
+    usb_frame_release(data);
 }
 
-static void usb_rx_task(void* arg) {
-    ESP_LOGI(TAG, "USB CDC 接收任务启动");
+static void usb_on_protocol(void* user, const uint8_t* frame, size_t len) {
+    const protocol_header_t* header = (const protocol_header_t*)frame;
+    switch (header->frame_type) {
+    case FRAME_TYPE_COMMAND:
+        // 处理命令帧（如遥控数据）
+        ESP_LOGI(TAG, "Received command frame via USB");
+        break;
+    case FRAME_TYPE_HEARTBEAT:
+        // 处理心跳帧
+        ESP_LOGI(TAG, "Received heartbeat frame via USB");
+        break;
+    case FRAME_TYPE_EXTENDED:
+        // 处理扩展帧
+        ESP_LOGI(TAG, "Received extended frame via USB");
+        handle_extended_command((const extended_cmd_payload_t*)&frame[sizeof(protocol_header_t)], header->length - 1);
+        break;
+    default:
+        ESP_LOGW(TAG, "Unknown frame type: 0x%02X", header->frame_type);
+        break;
+    }
+}
 
-    if (!s_parse_buf) {
-        ESP_LOGE(TAG, "Parse buffer not initialized");
-        vTaskDelete(NULL);
-        return;
+static void usb_on_line(void* user, char* line) {
+    cmd_terminal_handle_line(line);
+}
+
+// 连接断开: 丢弃半帧并归还其缓冲
+static void usb_link_reset(void) {
+    s_link_reset = false;
+    if (s_framer.state == USB_STREAM_STATE_PAYLOAD && s_framer.dest) {
+        usb_frame_release(s_framer.dest);
     }
+    usb_stream_framer_reset(&s_framer);
+}
+
+static void usb_rx_task(void* arg) {
+    ESP_LOGI(TAG, "USB CDC 接收任务启动");
 
     // 等待USB连接建立
     while (!tusb_cdc_acm_initialized(TINYUSB_CDC_ACM_0)) {
@@ -156,40 +177,53 @@ static void usb_rx_task(void* arg) {
     ESP_LOGI(TAG, "USB CDC已初始化，开始接收数据");
 
     while (1) {
+        if (s_link_reset) {
+            usb_link_reset();
+        }
+
+        // 直接读入分帧器给出的窗口: 帧头阶段为暂存区，负载阶段为最终帧缓冲
+        uint8_t* window = NULL;
+        const size_t capacity = usb_stream_framer_window(&s_framer, &window);
         size_t n = 0;
-        esp_err_t ret = tinyusb_cdcacm_read(TINYUSB_CDC_ACM_0, s_rx_chunk, sizeof(s_rx_chunk), &n);
+        esp_err_t ret = tinyusb_cdcacm_read(TINYUSB_CDC_ACM_0, window, capacity, &n);
         if (ret == ESP_OK && n > 0) {
-            // 接收到USB数据
-            if (s_parse_len + (size_t)n > USB_RX_BUFFER_SIZE) {
-                size_t to_copy = USB_RX_BUFFER_SIZE;
-                if ((size_t)n < USB_RX_BUFFER_SIZE) {
-                    memmove(s_parse_buf, &s_parse_buf[s_parse_len + n - USB_RX_BUFFER_SIZE],
-                            USB_RX_BUFFER_SIZE - (size_t)n);
-                    memcpy(&s_parse_buf[USB_RX_BUFFER_SIZE - (size_t)n], s_rx_chunk, (size_t)n);
-                } else {
-                    memcpy(s_parse_buf, &s_rx_chunk[n - USB_RX_BUFFER_SIZE], USB_RX_BUFFER_SIZE);
-                }
-                s_parse_len = to_copy;
-            } else {
-                memcpy(&s_parse_buf[s_parse_len], s_rx_chunk, (size_t)n);
-                s_parse_len += (size_t)n;
-            }
-            parse_and_dispatch(s_parse_buf, s_parse_len);
+            usb_stream_framer_commit(&s_framer, n);
         } else {
-            vTaskDelay(pdMS_TO_TICKS(5));
+            // 接收 FIFO 已空: 阻塞等待接收回调，不再轮询
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(USB_RX_IDLE_WAIT_MS));
         }
-        // 无论是否有数据，适当让出 CPU，防止长期占用导致 WDT 触发
-        vTaskDelay(1);
+        usb_rate_update(&s_rx_rate, s_framer.stats.rx_bytes);
     }
 }
 
 esp_err_t usb_receiver_init(void) {
-    // Allocate parse buffer from PSRAM to save internal RAM
-    s_parse_buf = (uint8_t*)heap_caps_malloc(USB_RX_BUFFER_SIZE, MALLOC_CAP_SPIRAM);
-    if (!s_parse_buf) {
-        ESP_LOGE(TAG, "Failed to allocate parse buffer from PSRAM");
-        return ESP_ERR_NO_MEM;
+    // 帧缓冲从 PSRAM 分配 (只分配一次，图传桥可能仍持有引用)
+    if (!s_free_bufs) {
+        s_free_bufs = xQueueCreate(USB_RX_FRAME_BUF_COUNT, sizeof(uint8_t*));
+        s_tx_mutex = xSemaphoreCreateMutex();
+        if (!s_free_bufs || !s_tx_mutex) {
+            ESP_LOGE(TAG, "Failed to create USB queues");
+            return ESP_ERR_NO_MEM;
+        }
+        for (int i = 0; i < USB_RX_FRAME_BUF_COUNT; i++) {
+            s_frame_bufs[i] = (uint8_t*)heap_caps_malloc(USB_RX_FRAME_BUF_SIZE, MALLOC_CAP_SPIRAM);
+            if (!s_frame_bufs[i]) {
+                ESP_LOGE(TAG, "Failed to allocate frame buffer from PSRAM");
+                return ESP_ERR_NO_MEM;
+            }
+            xQueueSend(s_free_bufs, &s_frame_bufs[i], 0);
+        }
     }
+
+    const usb_stream_callbacks_t cb = {
+        .frame_begin = usb_on_frame_begin,
+        .frame_end = usb_on_frame_end,
+        .on_protocol = usb_on_protocol,
+        .on_line = usb_on_line,
+        .user = NULL,
+    };
+    usb_stream_framer_init(&s_framer, &cb);
+
     // ESP32-S3内置USB接口，不需要外部PHY
     const tinyusb_config_t tusb_cfg = {
         .device_descriptor = NULL,        // 使用默认设备描述符
@@ -202,16 +236,14 @@ esp_err_t usb_receiver_init(void) {
     esp_err_t ret = tinyusb_driver_install(&tusb_cfg);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "tinyusb_driver_install 失败: %s", esp_err_to_name(ret));
-        free(s_parse_buf);
-        s_parse_buf = NULL;
         return ret;
     }
 
     tinyusb_config_cdcacm_t acm_cfg = {
         .usb_dev = TINYUSB_USBDEV_0,
         .cdc_port = TINYUSB_CDC_ACM_0,
-        .rx_unread_buf_sz = 2048, // 扩大内部未读缓冲
-        .callback_rx = NULL,
+        .rx_unread_buf_sz = USB_RX_UNREAD_BUF_SIZE,
+        .callback_rx = usb_rx_callback,
         .callback_rx_wanted_char = NULL,
         .callback_line_state_changed = usb_line_state_changed_callback,
         .callback_line_coding_changed = NULL,
@@ -219,8 +251,6 @@ esp_err_t usb_receiver_init(void) {
     ret = tusb_cdc_acm_init(&acm_cfg);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "tinyusb_cdcacm_init 失败: %s", esp_err_to_name(ret));
-        free(s_parse_buf);
-        s_parse_buf = NULL;
         return ret;
     }
 
@@ -247,23 +277,134 @@ void usb_receiver_stop(void) {
         s_usb_task = NULL;
     }
     // tinyusb_driver_uninstall 函数在当前版本中不可用 (IDF-1474)
-    // 由于没有卸载函数，直接返回
-    if (s_parse_buf) {
-        free(s_parse_buf);
-        s_parse_buf = NULL;
+    // 帧缓冲保留，下游可能仍持有引用；半帧缓冲在此归还
+    usb_link_reset();
+}
+
+void usb_receiver_register_bulk_sink(usb_receiver_bulk_sink_t sink, void* ctx) {
+    s_bulk_ctx = ctx;
+    s_bulk_sink = sink;
+}
+
+// 写入发送 FIFO，FIFO 满时等待主机取走数据 (调用者持有 s_tx_mutex)
+static esp_err_t usb_tx_write(const uint8_t* data, size_t len) {
+    bool stalled = false;
+    while (len > 0) {
+        if (!s_usb_connected) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        const size_t queued = tinyusb_cdcacm_write_queue(TINYUSB_CDC_ACM_0, data, len);
+        if (queued == 0) {
+            if (stalled) {
+                s_tx_stalls++;
+                return ESP_ERR_TIMEOUT;
+            }
+            stalled = true;
+            tinyusb_cdcacm_write_flush(TINYUSB_CDC_ACM_0, pdMS_TO_TICKS(USB_TX_TIMEOUT_MS));
+            continue;
+        }
+        stalled = false;
+        data += queued;
+        len -= queued;
+        s_tx_bytes += queued;
     }
+    usb_rate_update(&s_tx_rate, s_tx_bytes);
+    return ESP_OK;
+}
+
+esp_err_t usb_receiver_stream_send(uint8_t frame_type, const uint8_t* data, size_t len) {
+    if (!data || len == 0 || len > USB_STREAM_MAX_FRAME) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_tx_mutex || !s_usb_connected) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint8_t header[USB_STREAM_HEADER_SIZE];
+    usb_stream_framer_make_header(header, frame_type, 0, 0, (uint32_t)len);
+
+    xSemaphoreTake(s_tx_mutex, portMAX_DELAY);
+    esp_err_t ret = usb_tx_write(header, sizeof(header));
+    if (ret == ESP_OK) {
+        ret = usb_tx_write(data, len);
+    }
+    tinyusb_cdcacm_write_flush(TINYUSB_CDC_ACM_0, 0);
+    xSemaphoreGive(s_tx_mutex);
+    return ret;
+}
+
+static void usb_bench_task(void* arg) {
+    uint32_t remain = (uint32_t)(uintptr_t)arg * 1024;
+    const uint32_t total = remain;
+    uint8_t* buf = (uint8_t*)heap_caps_malloc(USB_TX_BENCH_FRAME_SIZE, MALLOC_CAP_SPIRAM);
+    if (buf) {
+        for (size_t i = 0; i < USB_TX_BENCH_FRAME_SIZE; i++) {
+            buf[i] = (uint8_t)i;
+        }
+        const int64_t start_us = esp_timer_get_time();
+        esp_err_t ret = ESP_OK;
+        while (remain > 0 && ret == ESP_OK) {
+            const uint32_t n = remain < USB_TX_BENCH_FRAME_SIZE ? remain : USB_TX_BENCH_FRAME_SIZE;
+            ret = usb_receiver_stream_send(USB_STREAM_FRAME_BULK, buf, n);
+            if (ret == ESP_OK) {
+                remain -= n;
+            }
+        }
+        const int64_t elapsed_us = esp_timer_get_time() - start_us;
+        ESP_LOGI(TAG, "发送测试: %lu/%lu 字节, %.1f KB/s (%s)", (unsigned long)(total - remain),
+                 (unsigned long)total,
+                 elapsed_us > 0 ? (float)(total - remain) * 1000000.0f / 1024.0f / (float)elapsed_us : 0.0f,
+                 esp_err_to_name(ret));
+        free(buf);
+    } else {
+        ESP_LOGE(TAG, "发送测试缓冲分配失败");
+    }
+    s_bench_task = NULL;
+    vTaskDelete(NULL);
+}
+
+esp_err_t usb_receiver_bench_dump(uint32_t kb) {
+    if (!s_usb_connected) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_bench_task) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (xTaskCreatePinnedToCore(usb_bench_task, "usb_dump", 3072, (void*)(uintptr_t)kb, 3, &s_bench_task, 1) !=
+        pdPASS) {
+        s_bench_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void usb_receiver_get_stats(usb_receiver_stats_t* stats) {
+    if (!stats) {
+        return;
+    }
+    stats->stream = s_framer.stats;
+    stats->frames_forwarded = s_frames_forwarded;
+    stats->frames_rejected = s_frames_rejected;
+    stats->bulk_frames = s_bulk_frames;
+    stats->buffer_waits = s_buffer_waits;
+    stats->tx_bytes = s_tx_bytes;
+    stats->tx_stalls = s_tx_stalls;
+    stats->rx_kbps = s_rx_rate.kbps;
+    stats->tx_kbps = s_tx_rate.kbps;
 }
 
 // 供命令终端使用的输出函数：通过USB CDC回传到主机
 void cmd_terminal_write(const char* s) {
-    if (!s || !s_usb_connected)
+    if (!s || !s_usb_connected || !s_tx_mutex)
         return;
-    size_t len = strlen(s);
-    // 将整段字符串写入CDC队列并flush
-    tinyusb_cdcacm_write_queue(TINYUSB_CDC_ACM_0, (const uint8_t*)s, len);
-    tinyusb_cdcacm_write_flush(TINYUSB_CDC_ACM_0, 0);
-    // 追加换行，便于在终端阅读
+    // 与数据下载共用发送通道，下载进行中时等待有限时间，超时丢弃本条输出
+    if (xSemaphoreTake(s_tx_mutex, pdMS_TO_TICKS(USB_TX_TIMEOUT_MS)) != pdTRUE)
+        return;
+    // 整段字符串写入CDC队列，追加换行便于在终端阅读
     const char crlf[] = "\r\n";
-    tinyusb_cdcacm_write_queue(TINYUSB_CDC_ACM_0, (const uint8_t*)crlf, sizeof(crlf) - 1);
+    if (usb_tx_write((const uint8_t*)s, strlen(s)) == ESP_OK) {
+        usb_tx_write((const uint8_t*)crlf, sizeof(crlf) - 1);
+    }
     tinyusb_cdcacm_write_flush(TINYUSB_CDC_ACM_0, 0);
+    xSemaphoreGive(s_tx_mutex);
 }
@@ -0,0 +1,242 @@
+/**
+ * @file usb_stream_framer.c
+ * @brief USB CDC 字节流分帧实现
+ */
+
+#include "usb_stream_framer.h"
+#include "tcp_common_protocol.h"
+#include <string.h>
+
+static uint32_t read_le32(const uint8_t* p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static uint16_t read_le16(const uint8_t* p) {
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static void framer_finish_frame(usb_stream_framer_t* framer) {
+    uint8_t* data = framer->dest;
+    framer->dest = NULL;
+    framer->state = USB_STREAM_STATE_SCRATCH;
+    framer->stats.frames++;
+    if (framer->cb.frame_end) {
+        framer->cb.frame_end(framer->cb.user, &framer->info, data);
+    }
+}
+
+// 帧头已解析: 向接收方申请负载缓冲，申请不到则进入丢弃状态
+static void framer_begin_frame(usb_stream_framer_t* framer) {
+    framer->received = 0;
+    framer->dest = framer->cb.frame_begin ? framer->cb.frame_begin(framer->cb.user, &framer->info) : NULL;
+    if (framer->dest) {
+        framer->state = USB_STREAM_STATE_PAYLOAD;
+    } else {
+        framer->stats.dropped_frames++;
+        framer->discard_remain = framer->info.len;
+        framer->state = USB_STREAM_STATE_DISCARD;
+    }
+}
+
+// 与帧头一起读入暂存区的负载字节 (最多一个暂存区)
+static size_t framer_take_payload(usb_stream_framer_t* framer, const uint8_t* data, size_t avail) {
+    if (framer->state == USB_STREAM_STATE_PAYLOAD) {
+        size_t n = framer->info.len - framer->received;
+        if (n > avail) {
+            n = avail;
+        }
+        memcpy(framer->dest + framer->received, data, n);
+        framer->received += n;
+        framer->stats.copied_bytes += n;
+        if (framer->received == framer->info.len) {
+            framer_finish_frame(framer);
+        }
+        return n;
+    }
+
+    size_t n = framer->discard_remain;
+    if (n > avail) {
+        n = avail;
+    }
+    framer->discard_remain -= n;
+    if (framer->discard_remain == 0) {
+        framer->state = USB_STREAM_STATE_SCRATCH;
+    }
+    return n;
+}
+
+/**
+ * @brief 尝试解析暂存区中以 p 开头的一条消息
+ * @return 消费的字节数；0 表示数据不足，需要继续读取
+ */
+static size_t framer_parse_one(usb_stream_framer_t* framer, const uint8_t* p, size_t avail) {
+    if (p[0] == (uint8_t)(USB_STREAM_SYNC_WORD & 0xFF)) {
+        // 图传帧头
+        if (avail < USB_STREAM_HEADER_SIZE) {
+            return 0;
+        }
+        const uint32_t len = read_le32(&p[9]);
+        if (read_le32(p) != USB_STREAM_SYNC_WORD || len == 0 || len > USB_STREAM_MAX_FRAME) {
+            framer->stats.resync_bytes++;
+            return 1;
+        }
+        framer->info.frame_type = p[4];
+        framer->info.width = read_le16(&p[5]);
+        framer->info.height = read_le16(&p[7]);
+        framer->info.len = len;
+        framer_begin_frame(framer);
+        return USB_STREAM_HEADER_SIZE;
+    }
+
+    if (p[0] == FRAME_HEADER_1) {
+        // 协议帧
+        if (avail < 3) {
+            return 0;
+        }
+        if (p[1] != FRAME_HEADER_2) {
+            framer->stats.resync_bytes++;
+            return 1;
+        }
+        const size_t total = 2 + 1 + (size_t)p[2] + 2;
+        if (avail < total) {
+            return 0;
+        }
+        if (!validate_frame(p, (uint16_t)total)) {
+            framer->stats.resync_bytes++;
+            return 1;
+        }
+        framer->stats.protocol_frames++;
+        if (framer->cb.on_protocol) {
+            framer->cb.on_protocol(framer->cb.user, p, total);
+        }
+        return total;
+    }
+
+    // 文本行 (空行与 CRLF 的第二个字符直接跳过)
+    if (p[0] == '\r' || p[0] == '\n') {
+        return 1;
+    }
+    size_t end = 0;
+    while (end < avail && p[end] != '\r' && p[end] != '\n') {
+        if (p[end] < 0x20 && p[end] != '\t') {
+            // 文本中不应出现控制字符 (如紧随噪声的下一帧帧头): 之前的字节作为噪声丢弃
+            const size_t skip = end ? end : 1;
+            framer->stats.resync_bytes += skip;
+            return skip;
+        }
+        end++;
+    }
+    if (end == avail) {
+        if (avail < USB_STREAM_LINE_MAX) {
+            return 0;
+        }
+        // 超长且无换行，丢弃
+        framer->stats.resync_bytes += avail;
+        return avail;
+    }
+
+    char line[USB_STREAM_LINE_MAX];
+    const size_t line_len = end < sizeof(line) - 1 ? end : sizeof(line) - 1;
+    memcpy(line, p, line_len);
+    line[line_len] = '\0';
+    framer->stats.lines++;
+    if (framer->cb.on_line) {
+        framer->cb.on_line(framer->cb.user, line);
+    }
+    return end + 1;
+}
+
+static void framer_parse_scratch(usb_stream_framer_t* framer) {
+    size_t pos = 0;
+    while (pos < framer->scratch_len) {
+        const uint8_t* p = &framer->scratch[pos];
+        const size_t avail = framer->scratch_len - pos;
+
+        if (framer->state != USB_STREAM_STATE_SCRATCH) {
+            pos += framer_take_payload(framer, p, avail);
+            continue;
+        }
+
+        const size_t used = framer_parse_one(framer, p, avail);
+        if (used == 0) {
+            break;
+        }
+        pos += used;
+    }
+
+    framer->scratch_len -= pos;
+    if (framer->scratch_len > 0 && pos > 0) {
+        memmove(framer->scratch, &framer->scratch[pos], framer->scratch_len);
+    }
+}
+
+void usb_stream_framer_init(usb_stream_framer_t* framer, const usb_stream_callbacks_t* cb) {
+    memset(framer, 0, sizeof(*framer));
+    if (cb) {
+        framer->cb = *cb;
+    }
+}
+
+void usb_stream_framer_reset(usb_stream_framer_t* framer) {
+    framer->state = USB_STREAM_STATE_SCRATCH;
+    framer->scratch_len = 0;
+    framer->dest = NULL;
+    framer->received = 0;
+    framer->discard_remain = 0;
+}
+
+size_t usb_stream_framer_window(usb_stream_framer_t* framer, uint8_t** buf) {
+    switch (framer->state) {
+    case USB_STREAM_STATE_PAYLOAD:
+        *buf = framer->dest + framer->received;
+        return framer->info.len - framer->received;
+    case USB_STREAM_STATE_DISCARD:
+        *buf = framer->scratch;
+        return framer->discard_remain < sizeof(framer->scratch) ? framer->discard_remain : sizeof(framer->scratch);
+    case USB_STREAM_STATE_SCRATCH:
+    default:
+        *buf = &framer->scratch[framer->scratch_len];
+        return sizeof(framer->scratch) - framer->scratch_len;
+    }
+}
+
+void usb_stream_framer_commit(usb_stream_framer_t* framer, size_t n) {
+    if (n == 0) {
+        return;
+    }
+    framer->stats.rx_bytes += n;
+
+    switch (framer->state) {
+    case USB_STREAM_STATE_PAYLOAD:
+        framer->received += n;
+        framer->stats.payload_bytes += n;
+        if (framer->received >= framer->info.len) {
+            framer_finish_frame(framer);
+        }
+        break;
+    case USB_STREAM_STATE_DISCARD:
+        framer->discard_remain -= n;
+        if (framer->discard_remain == 0) {
+            framer->state = USB_STREAM_STATE_SCRATCH;
+        }
+        break;
+    case USB_STREAM_STATE_SCRATCH:
+    default:
+        framer->scratch_len += n;
+        framer_parse_scratch(framer);
+        break;
+    }
+}
+
+void usb_stream_framer_make_header(uint8_t* out, uint8_t frame_type, uint16_t width, uint16_t height, uint32_t len) {
+    const uint32_t sync = USB_STREAM_SYNC_WORD;
+    for (int i = 0; i < 4; i++) {
+        out[i] = (uint8_t)(sync >> (8 * i));
+        out[9 + i] = (uint8_t)(len >> (8 * i));
+    }
+    out[4] = frame_type;
+    out[5] = (uint8_t)width;
+    out[6] = (uint8_t)(width >> 8);
+    out[7] = (uint8_t)height;
+    out[8] = (uint8_t)(height >> 8);
+}
@@ -19,17 +19,64 @@
 #include <stdint.h>
 #include <stddef.h>
 
+// 输入像素格式
+typedef enum {
+    JPEG_STREAM_INPUT_RGB565_LE = 0, // RGB565 小端，每像素2字节
+    JPEG_STREAM_INPUT_RGB565_BE,     // RGB565 大端 (LCD 常用字节序)，每像素2字节
+    JPEG_STREAM_INPUT_YUV422,        // YUYV (Y0 Cb Y1 Cr)，每像素2字节，直接送入编码器
+    JPEG_STREAM_INPUT_RGBA,          // 现有 SPI 发送端使用的格式 (默认)，每像素4字节
+} jpeg_stream_input_format_t;
+
 // JPEG编码参数配置
 #define JPEG_ENC_WIDTH 240
 #define JPEG_ENC_HEIGHT 188
 #define JPEG_ENC_QUALITY 70
-#define JPEG_ENC_SRC_TYPE JPEG_PIXEL_FORMAT_RGBA
+#define JPEG_ENC_INPUT_FORMAT JPEG_STREAM_INPUT_RGBA // 与现有 SPI 发送端一致，其他格式用 set_input_format 选择
+// 编码器内部统一使用 YUV422 输入，按条带 (8 行) 边接收边编码
+#define JPEG_ENC_SRC_TYPE JPEG_PIXEL_FORMAT_YCbYCr
 #define JPEG_ENC_SUBSAMPLE JPEG_SUBSAMPLE_422
+#define JPEG_ENC_OUTPUT_BUF_SIZE (100 * 1024) // 每个输出缓冲大小，共两个轮流使用
+#define JPEG_ENC_MAX_WIDTH 640
+#define JPEG_ENC_MAX_HEIGHT 480
+#define JPEG_ENC_CHUNK_QUEUE_LEN 16          // 输入块队列深度
+#define JPEG_ENC_COPY_BLOCK_SIZE (8 * 1024)  // 拷贝投递的块池块大小，更长的数据拆成多块
+
+// 编码统计
+typedef struct {
+    uint32_t frames_encoded;   // 编码完成的帧数
+    uint32_t frames_dropped;   // 无空闲输出缓冲、输入丢失或编码失败而丢弃的帧数
+    uint32_t encode_errors;    // 编码器返回错误的次数
+    uint32_t input_gaps;       // 输入队列满导致数据丢失的次数
+    uint32_t input_refused;    // 输入被其他任务独占期间拒绝的投递次数
+    uint64_t input_bytes;      // 已消费的输入字节数 (含丢失部分)
+    uint32_t last_frame_bytes; // 最近一帧JPEG大小
+    uint32_t avg_frame_bytes;  // 平均每帧JPEG大小
+    uint32_t last_encode_us;   // 最近一帧从首个条带到编码完成的时间
+    float fps;                 // 最近统计窗口内的编码帧率
+    uint16_t width;            // 当前生效的宽度
+    uint16_t height;           // 当前生效的高度
+    uint8_t quality;           // 当前生效的质量
+    jpeg_stream_input_format_t input_format; // 当前生效的输入格式
+} jpeg_stream_encoder_stats_t;
+
+// 按引用投递的数据块在编码任务用完后调用的释放函数
+typedef void (*jpeg_chunk_release_t)(void* ctx);
+
+// 队列消息类型
+typedef enum {
+    JPEG_CHUNK_DATA = 0, // 数据块 (data/len 均为空时为退出信号)
+    JPEG_CHUNK_CLAIM,    // 输入开始被独占: 记下外部流的帧内位置并丢弃未完成的帧
+    JPEG_CHUNK_RELEASE,  // 独占结束: 丢弃未完成的帧，恢复外部流的帧内位置
+} jpeg_chunk_kind_t;
 
 // JPEG数据块消息结构
 typedef struct {
     uint8_t* data;
     size_t len;
+    jpeg_chunk_release_t release; // 为NULL时data由编码任务free
+    void* release_ctx;
+    size_t skip; // 此块之前因队列满而丢失的字节数，编码任务据此丢弃受影响的整帧
+    jpeg_chunk_kind_t kind;
 } jpeg_chunk_msg_t;
 
 // JPEG编码器回调函数类型
@@ -61,6 +108,34 @@ void jpeg_stream_encoder_stop(void);
  */
 esp_err_t jpeg_stream_encoder_feed_data(const uint8_t* data, size_t len);
 
+/**
+ * @brief 按引用向JPEG编码器投递数据块 (不分配内存、不拷贝)
+ *        编码任务消费完数据后调用 release(release_ctx)，在此之前调用者必须保证数据有效。
+ *        队列满时立即返回，不会阻塞调用者；失败时不会调用 release。
+ *        丢失的字节会记入下一个成功投递的数据块，编码任务据此丢弃整帧以保持帧对齐。
+ * @param data 数据指针
+ * @param len 数据长度
+ * @param release 释放回调，不能为NULL
+ * @param release_ctx 释放回调参数
+ * @return ESP_OK 成功，ESP_ERR_TIMEOUT 队列已满，其他值表示失败
+ */
+esp_err_t jpeg_stream_encoder_feed_ref(const uint8_t* data, size_t len, jpeg_chunk_release_t release,
+                                       void* release_ctx);
+
+/**
+ * @brief 由调用任务独占编码器输入 (如合成测试帧)
+ *        独占期间其他任务的投递返回 ESP_ERR_INVALID_STATE，不会与独占方的数据交错进同一帧；
+ *        调用任务投递的第一个字节作为新帧开始。
+ * @return ESP_OK 成功，ESP_ERR_INVALID_STATE 未启动或已被其他任务独占
+ */
+esp_err_t jpeg_stream_encoder_claim_input(void);
+
+/**
+ * @brief 结束独占 (须由独占任务调用)
+ *        独占期间被拒绝的字节计为丢失，外部流恢复后仍按帧对齐 (要求期间分辨率与格式已恢复原值)。
+ */
+void jpeg_stream_encoder_release_input(void);
+
 /**
  * @brief 获取JPEG编码器队列句柄
  * @return 队列句柄，如果未初始化则返回NULL
@@ -68,7 +143,7 @@ esp_err_t jpeg_stream_encoder_feed_data(const uint8_t* data, size_t len);
 QueueHandle_t jpeg_stream_encoder_get_queue(void);
 
 /**
- * @brief 设置JPEG编码质量
+ * @brief 设置JPEG编码质量 (在下一帧开始时生效)
  * @param quality 质量值 (1-100)
  * @return ESP_OK 成功，其他值表示失败
  */
@@ -80,4 +155,25 @@ esp_err_t jpeg_stream_encoder_set_quality(uint8_t quality);
  */
 uint8_t jpeg_stream_encoder_get_quality(void);
 
+/**
+ * @brief 设置输入分辨率 (在下一帧开始时生效)
+ * @param width 宽度 (偶数，不超过 JPEG_ENC_MAX_WIDTH)
+ * @param height 高度 (不超过 JPEG_ENC_MAX_HEIGHT)
+ * @return ESP_OK 成功，ESP_ERR_INVALID_ARG 参数超出范围
+ */
+esp_err_t jpeg_stream_encoder_set_resolution(uint16_t width, uint16_t height);
+
+/**
+ * @brief 设置输入像素格式 (在下一帧开始时生效)
+ * @param format 输入格式
+ * @return ESP_OK 成功，ESP_ERR_INVALID_ARG 格式无效
+ */
+esp_err_t jpeg_stream_encoder_set_input_format(jpeg_stream_input_format_t format);
+
+/**
+ * @brief 获取编码统计
+ * @param stats 输出
+ */
+void jpeg_stream_encoder_get_stats(jpeg_stream_encoder_stats_t* stats);
+
 #endif // JPEG_STREAM_ENCODER_H
@@ -0,0 +1,125 @@
+/**
+ * @file video_bridge.h
+ * @brief 图传桥: SPI 采集 -> JPEG 编码 -> 封包 -> TCP/UDP 发送
+ *
+ * 各级之间均为有界队列，反压时整帧丢弃，不会丢弃帧内的部分字节:
+ *  - SPI DMA 环 -> 编码输入队列: 队列满时丢失的字节所在帧由编码器整帧丢弃；
+ *  - 编码器双输出缓冲: 无空闲缓冲时整帧跳过编码；
+ *  - 发送队列 (VIDEO_BRIDGE_QUEUE_DEPTH 帧): 满时丢弃新完成的帧。
+ */
+
+#ifndef VIDEO_BRIDGE_H
+#define VIDEO_BRIDGE_H
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define VIDEO_BRIDGE_TCP_DEFAULT_PORT 6556 // 主控端图传 TCP 服务器端口
+#define VIDEO_BRIDGE_UDP_DEFAULT_PORT 6789 // 主控端 P2P UDP 图传端口
+#define VIDEO_BRIDGE_QUEUE_DEPTH 3         // 发送队列深度 (帧)
+#define VIDEO_BRIDGE_RECONNECT_DELAY_MS 2000
+#define VIDEO_BRIDGE_SEND_TIMEOUT_MS 1000
+
+typedef enum {
+    VIDEO_BRIDGE_TRANSPORT_TCP = 0, // image_transfer_header_t + JPEG
+    VIDEO_BRIDGE_TRANSPORT_UDP,     // p2p_udp 分片
+} video_bridge_transport_t;
+
+typedef struct {
+    video_bridge_transport_t transport;
+    char host[16]; // 目标IP
+    uint16_t port; // 0 使用传输方式的默认端口
+} video_bridge_config_t;
+
+// 单级吞吐与延迟统计
+typedef struct {
+    uint32_t frames;          // 通过该级的帧数
+    uint64_t bytes;           // 通过该级的字节数
+    float fps;                // 最近统计窗口的帧率
+    float kbps;               // 最近统计窗口的吞吐 (kbit/s)
+    uint32_t latency_last_us; // 最近一帧在该级的耗时
+    uint32_t latency_max_us;  // 最大耗时
+    uint32_t latency_avg_us;  // 平均耗时
+} video_bridge_stage_stats_t;
+
+typedef struct {
+    video_bridge_stage_stats_t capture; // SPI 采集 (图像字节)
+    video_bridge_stage_stats_t encode;  // JPEG 编码 (首个条带到编码完成)
+    video_bridge_stage_stats_t queue;   // 发送队列等待
+    video_bridge_stage_stats_t send;    // 封包与网络发送
+    uint32_t encode_drops;              // 编码级整帧丢弃 (输入丢失/无输出缓冲)
+    uint32_t queue_drops;               // 发送队列满整帧丢弃
+    uint32_t send_drops;                // 发送失败或未连接整帧丢弃
+    uint32_t reconnects;                // 重新建立连接次数
+    uint32_t queue_depth;               // 当前排队帧数
+    bool connected;                     // 是否已连接
+} video_bridge_stats_t;
+
+/**
+ * @brief 启动图传桥 (分配发送队列、创建发送任务)
+ * @param config 目标与传输方式
+ * @return ESP_OK 成功
+ */
+esp_err_t video_bridge_start(const video_bridge_config_t* config);
+
+/**
+ * @brief 停止图传桥并释放资源
+ */
+void video_bridge_stop(void);
+
+/**
+ * @brief 提交一帧编码完成的 JPEG (作为编码器输出回调使用，不阻塞)
+ * @param data JPEG 数据
+ * @param len 长度
+ */
+void video_bridge_submit_frame(const uint8_t* data, size_t len);
+
+// 按引用提交的帧在发送完成或丢弃后调用的释放函数
+typedef void (*video_bridge_release_t)(void* ctx);
+
+/**
+ * @brief 按引用提交一帧 JPEG (不拷贝)，发送完成或丢弃后调用 release(release_ctx)
+ * @param data JPEG 数据，在 release 之前必须保持有效
+ * @param len 长度
+ * @param width 宽度 (写入 TCP 帧头)
+ * @param height 高度
+ * @param release 释放回调，不能为NULL
+ * @param release_ctx 释放回调参数
+ * @return ESP_OK 已排队；ESP_ERR_TIMEOUT 发送队列满 (整帧丢弃，不会调用 release)
+ */
+esp_err_t video_bridge_submit_frame_ref(const uint8_t* data, size_t len, uint16_t width, uint16_t height,
+                                        video_bridge_release_t release, void* release_ctx);
+
+/**
+ * @brief 启动合成帧源: 按给定帧率生成 RGB565 彩条送入编码器，用于无 SPI 主机时的回环测试
+ * @param fps 帧率 (1-60)
+ * @return ESP_OK 成功
+ */
+esp_err_t video_bridge_start_test_pattern(uint32_t fps);
+
+/**
+ * @brief 停止合成帧源
+ */
+void video_bridge_stop_test_pattern(void);
+
+/**
+ * @brief 获取各级统计
+ */
+void video_bridge_get_stats(video_bridge_stats_t* stats);
+
+/**
+ * @brief 打印各级统计
+ */
+void video_bridge_print_status(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VIDEO_BRIDGE_H
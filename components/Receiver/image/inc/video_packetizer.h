@@ -0,0 +1,88 @@
+/**
+ * @file video_packetizer.h
+ * @brief 图传封包
+ *
+ * 两种线上格式与主控端 main/app/image_transfer 的解析保持一致:
+ *  - TCP: 13 字节 image_transfer_header_t + JPEG 负载；
+ *  - UDP: 每个分片 32 字节 p2p_udp_packet_header_t + 最多 1368 字节负载。
+ */
+
+#ifndef VIDEO_PACKETIZER_H
+#define VIDEO_PACKETIZER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ----------------- TCP (image_transfer_header_t) -----------------
+#define VIDEO_TCP_SYNC_WORD 0xAEBC1402
+#define VIDEO_TCP_FRAME_TYPE_JPEG 0x01
+
+typedef struct __attribute__((packed)) {
+    uint32_t sync_word;  // 同步字（魔数），标识帧的开始
+    uint8_t frame_type;  // 帧数据类型
+    uint16_t width;      // 图片宽度
+    uint16_t height;     // 图片高度
+    uint32_t data_len;   // 有效载荷数据的长度
+} video_tcp_header_t;
+
+// ----------------- UDP (p2p_udp_packet_header_t) -----------------
+#define VIDEO_UDP_MAGIC 0x50325055 // "P2PU"
+#define VIDEO_UDP_PACKET_TYPE_FRAME_DATA 0x02
+#define VIDEO_UDP_VERSION 1
+#define VIDEO_UDP_MAX_PACKET_SIZE 1400
+#define VIDEO_UDP_MAX_FRAME_SIZE (200 * 1024)
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;         // 魔数标识
+    uint8_t packet_type;    // 包类型
+    uint8_t version;        // 协议版本
+    uint16_t sequence_num;  // 序列号
+    uint32_t frame_id;      // 帧ID
+    uint16_t packet_id;     // 当前包在帧中的ID
+    uint16_t total_packets; // 该帧总包数
+    uint32_t frame_size;    // 帧总大小
+    uint16_t data_size;     // 当前包数据大小
+    uint16_t checksum;      // 数据校验和 (字节累加)
+    uint32_t timestamp;     // 时间戳 (ms)
+    uint8_t reserved[4];    // 保留字段
+} video_udp_header_t;
+
+#define VIDEO_UDP_PAYLOAD_SIZE (VIDEO_UDP_MAX_PACKET_SIZE - sizeof(video_udp_header_t))
+
+/**
+ * @brief 填充 TCP 帧头
+ */
+void video_packetizer_tcp_header(video_tcp_header_t* header, uint16_t width, uint16_t height, uint32_t len);
+
+/**
+ * @brief 一帧需要的 UDP 分片数 (len 超过 VIDEO_UDP_MAX_FRAME_SIZE 时返回 0)
+ */
+uint16_t video_packetizer_udp_count(uint32_t len);
+
+/**
+ * @brief 生成第 index 个 UDP 分片 (头部 + 负载)
+ * @param frame_id 帧ID
+ * @param frame 完整帧数据
+ * @param len 帧长度
+ * @param index 分片序号
+ * @param timestamp_ms 时间戳
+ * @param out 输出缓冲，至少 VIDEO_UDP_MAX_PACKET_SIZE 字节
+ * @return 分片总长度，index 越界时返回 0
+ */
+size_t video_packetizer_udp_fragment(uint32_t frame_id, const uint8_t* frame, uint32_t len, uint16_t index,
+                                     uint32_t timestamp_ms, uint8_t* out);
+
+/**
+ * @brief 字节累加校验和 (与接收端一致)
+ */
+uint16_t video_packetizer_checksum(const uint8_t* data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VIDEO_PACKETIZER_H
@@ -1,25 +1,82 @@
 #include "jpeg_stream_encoder.h"
 #include "esp_heap_caps.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/semphr.h"
+#include "mem_arena.h"
 #include "settings_manager.h"
 #include <string.h>
 #include <stdlib.h>
 
 static const char* TAG = "jpeg_encoder";
 
+#define JPEG_FPS_WINDOW_US 1000000 // 帧率统计窗口
+
+// 编码参数 (分辨率/质量/输入格式)，只在帧边界整体切换
+typedef struct {
+    uint16_t width;
+    uint16_t height;
+    uint8_t quality;
+    jpeg_stream_input_format_t format;
+} jpeg_stream_params_t;
+
+// 编码完成、等待输出任务处理的一帧
+typedef struct {
+    int index; // 输出缓冲序号，-1 为退出信号
+    size_t len;
+} jpeg_out_frame_t;
+
 // JPEG编码器全局变量
 static jpeg_enc_handle_t s_jpeg_enc = NULL;
 static QueueHandle_t s_jpeg_queue = NULL;
 static TaskHandle_t s_jpeg_task = NULL;
+static TaskHandle_t s_out_task = NULL;
 static jpeg_output_callback_t s_output_callback = NULL;
 
-// JPEG编码缓冲区
-static uint8_t* s_jpeg_input_buffer = NULL;
-static uint8_t* s_jpeg_output_buffer = NULL;
-static size_t s_jpeg_input_buffer_size = 0;
-static size_t s_jpeg_output_buffer_size = 0;
-static size_t s_jpeg_data_len = 0;
-static uint8_t s_jpeg_quality = JPEG_ENC_QUALITY;
+// 参数: s_pending 由任意任务写入，编码任务在帧边界取出成为 s_active
+static portMUX_TYPE s_param_lock = portMUX_INITIALIZER_UNLOCKED;
+static jpeg_stream_params_t s_pending = {JPEG_ENC_WIDTH, JPEG_ENC_HEIGHT, JPEG_ENC_QUALITY, JPEG_ENC_INPUT_FORMAT};
+static bool s_pending_dirty = false;
+static jpeg_stream_params_t s_active;
+
+// 条带输入缓冲: 只保存一个编码块 (8/16 行)，RGB 输入在其中就地转换为 YUYV
+static uint8_t* s_band_buf = NULL;
+static size_t s_band_buf_size = 0;
+static size_t s_band_fill = 0;
+static int s_block_size = 0; // 编码器每块输入字节数 (YUYV)
+static int s_band_rows = 0;
+
+// 双输出缓冲: 一个在编码，另一个交给输出任务
+static uint8_t* s_out_bufs[2] = {NULL, NULL};
+static QueueHandle_t s_out_free_queue = NULL;
+static QueueHandle_t s_out_done_queue = NULL;
+
+// 当前帧状态 (仅编码任务访问)
+static bool s_in_frame = false;
+static int s_out_index = -1; // -1 表示本帧丢弃，只消费输入
+static bool s_encoder_dirty = false; // 编码器停在帧中间，下一帧前需要重新打开
+static uint32_t s_band_index = 0;
+static uint32_t s_band_count = 0;
+static int s_out_len = 0;
+static int64_t s_frame_start_us = 0;
+
+// 投递状态，由 s_feed_lock 保护: 检查独占方与入队在同一把锁内完成，保证队列中的块不交错
+static SemaphoreHandle_t s_feed_lock = NULL;
+static volatile TaskHandle_t s_input_owner = NULL; // 独占输入的任务，NULL 表示不独占
+static size_t s_feed_gap = 0;             // 投递失败丢失的字节数，随下一块送给编码任务
+static size_t s_external_gap = 0;         // 独占开始时外部流尚未送出的丢失字节数
+static size_t s_refused_bytes = 0;        // 独占期间拒绝的外部流字节数 (与计数一起由 s_param_lock 保护)
+static uint32_t s_refused_count = 0;
+static size_t s_external_offset = 0;      // 独占开始时外部流在帧内的位置 (仅编码任务访问)
+
+// 拷贝投递 (feed_data) 的块池: 队列深度 + 编码任务正在消费的一块，块不足时等价于队列满
+static mem_pool_t s_chunk_pool;
+
+// 统计
+static jpeg_stream_encoder_stats_t s_stats;
+static uint64_t s_total_bytes = 0;
+static uint32_t s_window_frames = 0;
+static int64_t s_window_start_us = 0;
 
 // 前向声明
 static void jpeg_encode_feed_task(void* arg);
@@ -27,69 +84,358 @@ static esp_err_t init_jpeg_encoder_internal(void);
 static void cleanup_jpeg_encoder_internal(void);
 static void on_jpeg_quality_changed(setting_type_t type, const setting_value_t* new_value);
 
-// JPEG编码任务实现
+// 释放一个已消费的数据块
+static void jpeg_chunk_msg_release(const jpeg_chunk_msg_t* msg) {
+    if (msg->release) {
+        msg->release(msg->release_ctx);
+    } else if (msg->data) {
+        mem_pool_free(&s_chunk_pool, msg->data);
+    }
+}
+
+static size_t input_bytes_per_pixel(jpeg_stream_input_format_t format) {
+    return format == JPEG_STREAM_INPUT_RGBA ? 4 : 2;
+}
+
+static inline uint8_t clamp_u8(int v) {
+    return v < 0 ? 0 : (v > 255 ? 255 : (uint8_t)v);
+}
+
+// BT.601 全范围 (JFIF)，一对像素共享色度
+static inline void rgb_pair_to_yuyv(int r0, int g0, int b0, int r1, int g1, int b1, uint8_t* out) {
+    const int r = r0 + r1;
+    const int g = g0 + g1;
+    const int b = b0 + b1;
+    out[0] = clamp_u8((77 * r0 + 150 * g0 + 29 * b0 + 128) >> 8);
+    out[1] = clamp_u8(((-43 * r - 85 * g + 128 * b + 256) >> 9) + 128);
+    out[2] = clamp_u8((77 * r1 + 150 * g1 + 29 * b1 + 128) >> 8);
+    out[3] = clamp_u8(((128 * r - 107 * g - 21 * b + 256) >> 9) + 128);
+}
+
+static inline void rgb565_unpack(uint16_t px, int* r, int* g, int* b) {
+    *r = ((px >> 11) & 0x1F) * 255 / 31;
+    *g = ((px >> 5) & 0x3F) * 255 / 63;
+    *b = (px & 0x1F) * 255 / 31;
+}
+
+/**
+ * @brief 把条带就地转换为 YUYV
+ *        两种 RGB 格式每对像素的输出都不超过输入，从前往后写不会覆盖未读数据
+ */
+static void band_convert_to_yuyv(uint8_t* buf, size_t pixels, jpeg_stream_input_format_t format) {
+    int r0, g0, b0, r1, g1, b1;
+    switch (format) {
+    case JPEG_STREAM_INPUT_RGB565_LE:
+    case JPEG_STREAM_INPUT_RGB565_BE: {
+        const bool be = format == JPEG_STREAM_INPUT_RGB565_BE;
+        for (size_t i = 0; i < pixels; i += 2) {
+            uint8_t* p = &buf[i * 2];
+            const uint16_t px0 = be ? (uint16_t)(p[0] << 8 | p[1]) : (uint16_t)(p[1] << 8 | p[0]);
+            const uint16_t px1 = be ? (uint16_t)(p[2] << 8 | p[3]) : (uint16_t)(p[3] << 8 | p[2]);
+            rgb565_unpack(px0, &r0, &g0, &b0);
+            rgb565_unpack(px1, &r1, &g1, &b1);
+            rgb_pair_to_yuyv(r0, g0, b0, r1, g1, b1, p);
+        }
+        break;
+    }
+    case JPEG_STREAM_INPUT_RGBA:
+        for (size_t i = 0; i < pixels; i += 2) {
+            const uint8_t* p = &buf[i * 4];
+            rgb_pair_to_yuyv(p[0], p[1], p[2], p[4], p[5], p[6], &buf[i * 2]);
+        }
+        break;
+    case JPEG_STREAM_INPUT_YUV422:
+    default:
+        break;
+    }
+}
+
+// 打开编码器并按块大小准备条带缓冲
+static esp_err_t jpeg_encoder_open(const jpeg_stream_params_t* params) {
+    jpeg_enc_config_t jpeg_cfg = DEFAULT_JPEG_ENC_CONFIG();
+    jpeg_cfg.width = params->width;
+    jpeg_cfg.height = params->height;
+    jpeg_cfg.src_type = JPEG_ENC_SRC_TYPE;
+    jpeg_cfg.subsampling = JPEG_ENC_SUBSAMPLE;
+    jpeg_cfg.quality = params->quality;
+    jpeg_cfg.rotate = JPEG_ROTATE_0D;
+    jpeg_cfg.task_enable = true;
+    jpeg_cfg.hfm_task_core = 1;
+    jpeg_cfg.hfm_task_priority = 10;
+
+    jpeg_error_t ret = jpeg_enc_open(&jpeg_cfg, &s_jpeg_enc);
+    if (ret != JPEG_ERR_OK) {
+        ESP_LOGE(TAG, "JPEG encoder open failed: %d", ret);
+        s_jpeg_enc = NULL;
+        return ESP_FAIL;
+    }
+
+    const int row_bytes = params->width * 2;
+    s_block_size = jpeg_enc_get_block_size(s_jpeg_enc);
+    if (s_block_size <= 0 || s_block_size % row_bytes != 0) {
+        ESP_LOGE(TAG, "Unsupported block size %d for width %d", s_block_size, params->width);
+        jpeg_enc_close(s_jpeg_enc);
+        s_jpeg_enc = NULL;
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    s_band_rows = s_block_size / row_bytes;
+    s_band_count = (params->height + s_band_rows - 1) / s_band_rows;
+
+    // 条带缓冲按输入格式的原始大小分配，只在变大时重新分配
+    const size_t need = (size_t)params->width * s_band_rows * input_bytes_per_pixel(params->format);
+    if (need > s_band_buf_size) {
+        heap_caps_free(s_band_buf);
+        s_band_buf = (uint8_t*)heap_caps_malloc(need, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (!s_band_buf) {
+            s_band_buf = (uint8_t*)heap_caps_malloc(need, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        }
+        if (!s_band_buf) {
+            ESP_LOGE(TAG, "Failed to allocate band buffer: %u bytes", (unsigned)need);
+            s_band_buf_size = 0;
+            jpeg_enc_close(s_jpeg_enc);
+            s_jpeg_enc = NULL;
+            return ESP_ERR_NO_MEM;
+        }
+        s_band_buf_size = need;
+    }
+
+    s_active = *params;
+    s_encoder_dirty = false;
+    ESP_LOGI(TAG, "JPEG encoder config: %dx%d q=%d in=%d, %d rows/band, %lu bands", params->width,
+             params->height, params->quality, params->format, s_band_rows, (unsigned long)s_band_count);
+    return ESP_OK;
+}
+
+// 帧开始: 应用挂起的参数修改，取一个空闲输出缓冲
+static void jpeg_frame_begin(void) {
+    jpeg_stream_params_t params;
+    bool changed;
+    portENTER_CRITICAL(&s_param_lock);
+    params = s_pending;
+    changed = s_pending_dirty;
+    s_pending_dirty = false;
+    portEXIT_CRITICAL(&s_param_lock);
+
+    if (changed || s_encoder_dirty || !s_jpeg_enc) {
+        if (s_jpeg_enc) {
+            jpeg_enc_close(s_jpeg_enc);
+            s_jpeg_enc = NULL;
+        }
+        if (jpeg_encoder_open(&params) != ESP_OK && jpeg_encoder_open(&s_active) != ESP_OK) {
+            ESP_LOGE(TAG, "JPEG encoder reopen failed");
+        }
+    }
+
+    s_in_frame = true;
+    s_band_index = 0;
+    s_band_fill = 0;
+    s_out_len = 0;
+    s_frame_start_us = esp_timer_get_time();
+
+    // 上一帧还在输出且没有空闲缓冲时，整帧丢弃而不是阻塞输入
+    if (!s_jpeg_enc || xQueueReceive(s_out_free_queue, &s_out_index, 0) != pdTRUE) {
+        s_out_index = -1;
+    }
+}
+
+static void jpeg_frame_end(void) {
+    const int64_t now = esp_timer_get_time();
+    s_in_frame = false;
+
+    if (s_out_index < 0) {
+        s_stats.frames_dropped++;
+        return;
+    }
+
+    jpeg_out_frame_t frame = {.index = s_out_index, .len = (size_t)s_out_len};
+    s_out_index = -1;
+    xQueueSend(s_out_done_queue, &frame, portMAX_DELAY);
+
+    s_stats.frames_encoded++;
+    s_stats.last_frame_bytes = (uint32_t)frame.len;
+    s_total_bytes += frame.len;
+    s_stats.avg_frame_bytes = (uint32_t)(s_total_bytes / s_stats.frames_encoded);
+    s_stats.last_encode_us = (uint32_t)(now - s_frame_start_us);
+
+    s_window_frames++;
+    if (s_window_start_us == 0) {
+        s_window_start_us = now;
+    } else if (now - s_window_start_us >= JPEG_FPS_WINDOW_US) {
+        s_stats.fps = s_window_frames * 1000000.0f / (float)(now - s_window_start_us);
+        s_window_frames = 0;
+        s_window_start_us = now;
+    }
+    ESP_LOGD(TAG, "JPEG frame: %u bytes, %lu us", (unsigned)frame.len, (unsigned long)s_stats.last_encode_us);
+}
+
+// 当前帧输入不完整: 归还输出缓冲，本帧剩余数据只消费不编码
+static void jpeg_frame_abort(void) {
+    if (s_out_index < 0) {
+        return;
+    }
+    xQueueSend(s_out_free_queue, &s_out_index, 0);
+    s_out_index = -1;
+    if (s_band_index > 0) {
+        s_encoder_dirty = true;
+    }
+}
+
+// 编码一个 YUYV 条带
+static void jpeg_encode_band(const uint8_t* yuyv) {
+    if (s_out_index < 0) {
+        return;
+    }
+    jpeg_error_t ret = jpeg_enc_process_with_block(s_jpeg_enc, (uint8_t*)yuyv, s_block_size,
+                                                   s_out_bufs[s_out_index], JPEG_ENC_OUTPUT_BUF_SIZE,
+                                                   &s_out_len);
+    if (ret < JPEG_ERR_OK) {
+        // 编码器停在帧中间，本帧剩余数据只消费不编码，下一帧前重新打开
+        ESP_LOGW(TAG, "JPEG encode failed: %d", ret);
+        s_stats.encode_errors++;
+        xQueueSend(s_out_free_queue, &s_out_index, 0);
+        s_out_index = -1;
+        s_encoder_dirty = true;
+    }
+}
+
+// 最后一个条带不足块高时，用最后一行补齐
+static void jpeg_pad_band(uint32_t rows) {
+    const size_t row_bytes = (size_t)s_active.width * 2;
+    for (int r = rows; r < s_band_rows; r++) {
+        memcpy(&s_band_buf[r * row_bytes], &s_band_buf[(rows - 1) * row_bytes], row_bytes);
+    }
+}
+
+// 消费一段输入数据，可能跨越条带与帧边界；src 为 NULL 表示丢失的数据，所在帧全部丢弃
+static void jpeg_consume(const uint8_t* src, size_t remain) {
+    s_stats.input_bytes += remain;
+    while (remain > 0) {
+        if (!s_in_frame) {
+            jpeg_frame_begin();
+        }
+        if (!src) {
+            jpeg_frame_abort();
+        }
+
+        const size_t bpp = input_bytes_per_pixel(s_active.format);
+        uint32_t rows = s_active.height - s_band_index * s_band_rows;
+        if (rows > (uint32_t)s_band_rows) {
+            rows = s_band_rows;
+        }
+        const size_t band_bytes = (size_t)s_active.width * rows * bpp;
+
+        if (s_active.format == JPEG_STREAM_INPUT_YUV422 && s_band_fill == 0 && rows == (uint32_t)s_band_rows &&
+            remain >= band_bytes) {
+            // YUYV 整条带连续可用: 直接从输入缓冲编码，不经过条带缓冲
+            jpeg_encode_band(src);
+            src = src ? src + band_bytes : NULL;
+            remain -= band_bytes;
+        } else {
+            size_t n = band_bytes - s_band_fill;
+            if (n > remain) {
+                n = remain;
+            }
+            if (s_out_index >= 0) {
+                memcpy(s_band_buf + s_band_fill, src, n);
+            }
+            s_band_fill += n;
+            src = src ? src + n : NULL;
+            remain -= n;
+            if (s_band_fill < band_bytes) {
+                break;
+            }
+            if (s_out_index >= 0) {
+                band_convert_to_yuyv(s_band_buf, (size_t)s_active.width * rows, s_active.format);
+                jpeg_pad_band(rows);
+                jpeg_encode_band(s_band_buf);
+            }
+            s_band_fill = 0;
+        }
+
+        if (++s_band_index >= s_band_count) {
+            jpeg_frame_end();
+        }
+    }
+}
+
+// 当前帧已消费的输入字节数
+static size_t jpeg_frame_offset(void) {
+    if (!s_in_frame) {
+        return 0;
+    }
+    return (size_t)s_band_index * s_band_rows * s_active.width * input_bytes_per_pixel(s_active.format) +
+           s_band_fill;
+}
+
+// 丢弃未完成的帧，下一个字节作为新帧开始
+static void jpeg_frame_drop(void) {
+    if (!s_in_frame) {
+        return;
+    }
+    jpeg_frame_abort();
+    s_in_frame = false;
+    s_stats.frames_dropped++;
+}
+
+// JPEG编码任务实现: 每凑满一个条带立即编码
 static void jpeg_encode_feed_task(void* arg) {
     ESP_LOGI(TAG, "JPEG feed task started");
     jpeg_chunk_msg_t msg;
-    
+
     while (1) {
         if (xQueueReceive(s_jpeg_queue, &msg, portMAX_DELAY) == pdTRUE) {
+            if (msg.kind == JPEG_CHUNK_CLAIM) {
+                s_external_offset = jpeg_frame_offset();
+                jpeg_frame_drop();
+                continue;
+            }
+            if (msg.kind == JPEG_CHUNK_RELEASE) {
+                // 外部流停在帧内 s_external_offset 处: 补齐这段位置，其后的丢失字节随下一块到来
+                jpeg_frame_drop();
+                if (s_external_offset > 0) {
+                    jpeg_consume(NULL, s_external_offset);
+                    s_external_offset = 0;
+                }
+                continue;
+            }
             if (msg.data == NULL && msg.len == 0) {
                 // 退出信号
                 break;
             }
-            
-            if (msg.data && msg.len > 0 && s_jpeg_enc) {
-                // 累积数据到输入缓冲区
-                if (s_jpeg_data_len + msg.len <= s_jpeg_input_buffer_size) {
-                    memcpy(s_jpeg_input_buffer + s_jpeg_data_len, msg.data, msg.len);
-                    s_jpeg_data_len += msg.len;
-                    
-                    // 检查是否收集到足够的数据进行编码
-                    size_t expected_size = JPEG_ENC_WIDTH * JPEG_ENC_HEIGHT * 4; // RGBA格式
-                    if (s_jpeg_data_len >= expected_size) {
-                        // 执行JPEG编码
-                        int out_len = 0;
-                        jpeg_error_t ret = jpeg_enc_process(s_jpeg_enc, s_jpeg_input_buffer, 
-                                                          expected_size, s_jpeg_output_buffer, 
-                                                          s_jpeg_output_buffer_size, &out_len);
-                        if (ret == JPEG_ERR_OK && out_len > 0) {
-                            ESP_LOGI(TAG, "JPEG encoded: %d bytes -> %d bytes", expected_size, out_len);
-                            // 调用回调函数处理编码后的数据
-                            if (s_output_callback) {
-                                s_output_callback(s_jpeg_output_buffer, out_len);
-                            }
-                        } else {
-                            ESP_LOGW(TAG, "JPEG encode failed: %d", ret);
-                        }
-                        s_jpeg_data_len = 0; // 重置缓冲区
-                    }
-                } else {
-                    ESP_LOGW(TAG, "Input buffer overflow, dropping data");
-                    s_jpeg_data_len = 0; // 重置缓冲区
-                }
+            if (msg.skip > 0) {
+                s_stats.input_gaps++;
+                jpeg_consume(NULL, msg.skip);
+            }
+            if (msg.data) {
+                jpeg_consume(msg.data, msg.len);
             }
-            
-            if (msg.data) free(msg.data);
+            jpeg_chunk_msg_release(&msg);
         }
     }
     ESP_LOGI(TAG, "JPEG feed task stopped");
     vTaskDelete(NULL);
 }
 
+// 输出任务: 在编码下一帧的同时把上一帧交给回调
+static void jpeg_output_task(void* arg) {
+    jpeg_out_frame_t frame;
+    while (xQueueReceive(s_out_done_queue, &frame, portMAX_DELAY) == pdTRUE) {
+        if (frame.index < 0) {
+            break;
+        }
+        if (s_output_callback) {
+            s_output_callback(s_out_bufs[frame.index], frame.len);
+        }
+        xQueueSend(s_out_free_queue, &frame.index, 0);
+    }
+    vTaskDelete(NULL);
+}
+
 // 内部初始化函数
 static esp_err_t init_jpeg_encoder_internal(void) {
-    // 分配缓冲区
-    s_jpeg_input_buffer_size = JPEG_ENC_WIDTH * JPEG_ENC_HEIGHT * 4; // RGBA
-    s_jpeg_output_buffer_size = 100 * 1024; // 100KB
-
-    ESP_LOGI(TAG, "Available SPIRAM before malloc: %u bytes", (unsigned long)esp_get_free_heap_size());
     ESP_LOGI(TAG, "Available internal memory: %u bytes", (unsigned long)heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
     ESP_LOGI(TAG, "Available SPIRAM memory: %u bytes", (unsigned long)heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
-    
-    // 添加更长延迟确保SPIRAM完全初始化，并尝试小块分配测试
-    vTaskDelay(pdMS_TO_TICKS(1000));
-    
+
     // 先尝试小块SPIRAM分配测试
     void* test_ptr = heap_caps_malloc(1024, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
     if (test_ptr == NULL) {
@@ -97,57 +443,39 @@ static esp_err_t init_jpeg_encoder_internal(void) {
         return ESP_ERR_NO_MEM;
     }
     heap_caps_free(test_ptr);
-    ESP_LOGI(TAG, "SPIRAM test allocation successful");
-    
-    ESP_LOGI(TAG, "Attempting to allocate %d bytes for input buffer from SPIRAM...", s_jpeg_input_buffer_size);
-    
-    // 分配输入缓冲区 - 强制使用SPIRAM
-    s_jpeg_input_buffer = (uint8_t*)heap_caps_malloc(s_jpeg_input_buffer_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-    if (s_jpeg_input_buffer == NULL) {
-        ESP_LOGE(TAG, "Failed to allocate input buffer from SPIRAM!");
-        return ESP_ERR_NO_MEM;
-    }
-    ESP_LOGI(TAG, "JPEG encoder input buffer allocated from SPIRAM: %d bytes", s_jpeg_input_buffer_size);
 
-    ESP_LOGI(TAG, "Attempting to allocate %d bytes for output buffer from SPIRAM...", s_jpeg_output_buffer_size);
-    
-    // 分配输出缓冲区 - 强制使用SPIRAM
-    s_jpeg_output_buffer = (uint8_t*)heap_caps_malloc(s_jpeg_output_buffer_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-    if (s_jpeg_output_buffer == NULL) {
-        ESP_LOGE(TAG, "Failed to allocate output buffer from SPIRAM!");
-        heap_caps_free(s_jpeg_input_buffer);
-        s_jpeg_input_buffer = NULL;
-        return ESP_ERR_NO_MEM;
+    // 分配两个输出缓冲区 - 强制使用SPIRAM
+    for (int i = 0; i < 2; i++) {
+        s_out_bufs[i] = (uint8_t*)heap_caps_malloc(JPEG_ENC_OUTPUT_BUF_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (s_out_bufs[i] == NULL) {
+            ESP_LOGE(TAG, "Failed to allocate output buffer %d from SPIRAM!", i);
+            cleanup_jpeg_encoder_internal();
+            return ESP_ERR_NO_MEM;
+        }
     }
-    ESP_LOGI(TAG, "JPEG encoder output buffer allocated from SPIRAM: %d bytes", s_jpeg_output_buffer_size);
+    ESP_LOGI(TAG, "JPEG encoder output buffers allocated from SPIRAM: 2 x %d bytes", JPEG_ENC_OUTPUT_BUF_SIZE);
 
-    // 创建标准ESP-IDF JPEG编码器
-    jpeg_enc_config_t jpeg_cfg = DEFAULT_JPEG_ENC_CONFIG();
-    jpeg_cfg.width = JPEG_ENC_WIDTH;
-    jpeg_cfg.height = JPEG_ENC_HEIGHT;
-    jpeg_cfg.src_type = JPEG_ENC_SRC_TYPE;
-    jpeg_cfg.subsampling = JPEG_ENC_SUBSAMPLE;
-    jpeg_cfg.quality = s_jpeg_quality;
-    jpeg_cfg.rotate = JPEG_ROTATE_0D;
-    jpeg_cfg.task_enable = true;
-    jpeg_cfg.hfm_task_core = 1;
-    jpeg_cfg.hfm_task_priority = 10;
+    jpeg_stream_params_t params;
+    portENTER_CRITICAL(&s_param_lock);
+    params = s_pending;
+    s_pending_dirty = false;
+    portEXIT_CRITICAL(&s_param_lock);
 
-    ESP_LOGI(TAG, "JPEG encoder config: %d %d %d %d", jpeg_cfg.width, jpeg_cfg.height, jpeg_cfg.src_type, jpeg_cfg.quality);
-    
-    esp_err_t ret = jpeg_enc_open(&jpeg_cfg, &s_jpeg_enc);
-    if (ret != JPEG_ERR_OK) {
-        ESP_LOGE(TAG, "JPEG encoder open failed: %d", ret);
+    esp_err_t ret = jpeg_encoder_open(&params);
+    if (ret != ESP_OK) {
         cleanup_jpeg_encoder_internal();
-        return ESP_FAIL;
+        return ret;
     }
-    ESP_LOGI(TAG, "jpeg_enc_open success");
-    
-    // 缓冲区分配成功，初始化数据长度
-    s_jpeg_data_len = 0;
-    ESP_LOGI(TAG, "JPEG encoder initialized: %dx%d fmt=%d q=%d", 
-             jpeg_cfg.width, jpeg_cfg.height, jpeg_cfg.src_type, jpeg_cfg.quality);
-    
+
+    s_in_frame = false;
+    s_out_index = -1;
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_feed_gap = 0;
+    s_external_offset = 0;
+    s_refused_count = 0;
+    s_total_bytes = 0;
+    s_window_frames = 0;
+    s_window_start_us = 0;
     return ESP_OK;
 }
 
@@ -158,27 +486,44 @@ static void cleanup_jpeg_encoder_internal(void) {
         jpeg_enc_close(s_jpeg_enc);
         s_jpeg_enc = NULL;
     }
-    
-    if (s_jpeg_input_buffer) {
-        heap_caps_free(s_jpeg_input_buffer);
-        s_jpeg_input_buffer = NULL;
+
+    if (s_band_buf) {
+        heap_caps_free(s_band_buf);
+        s_band_buf = NULL;
     }
-    
-    if (s_jpeg_output_buffer) {
-        heap_caps_free(s_jpeg_output_buffer);
-        s_jpeg_output_buffer = NULL;
+    s_band_buf_size = 0;
+    s_band_fill = 0;
+
+    for (int i = 0; i < 2; i++) {
+        if (s_out_bufs[i]) {
+            heap_caps_free(s_out_bufs[i]);
+            s_out_bufs[i] = NULL;
+        }
     }
-    
-    s_jpeg_input_buffer_size = 0;
-    s_jpeg_output_buffer_size = 0;
-    s_jpeg_data_len = 0;
+    s_in_frame = false;
+    s_out_index = -1;
+}
+
+// 在帧边界生效的参数修改
+static void jpeg_params_update(const jpeg_stream_params_t* params) {
+    portENTER_CRITICAL(&s_param_lock);
+    s_pending = *params;
+    s_pending_dirty = true;
+    portEXIT_CRITICAL(&s_param_lock);
+}
+
+static jpeg_stream_params_t jpeg_params_pending(void) {
+    jpeg_stream_params_t params;
+    portENTER_CRITICAL(&s_param_lock);
+    params = s_pending;
+    portEXIT_CRITICAL(&s_param_lock);
+    return params;
 }
 
 // JPEG质量变化回调
 static void on_jpeg_quality_changed(setting_type_t type, const setting_value_t* new_value) {
-    if (type == SETTING_JPEG_QUALITY && new_value && new_value->uint8_value != s_jpeg_quality) {
-        s_jpeg_quality = new_value->uint8_value;
-        ESP_LOGI(TAG, "JPEG quality updated to: %d", s_jpeg_quality);
+    if (type == SETTING_JPEG_QUALITY && new_value && new_value->uint8_value != jpeg_stream_encoder_get_quality()) {
+        jpeg_stream_encoder_set_quality(new_value->uint8_value);
     }
 }
 
@@ -188,18 +533,19 @@ esp_err_t jpeg_stream_encoder_init(jpeg_output_callback_t output_callback) {
         ESP_LOGW(TAG, "JPEG encoder already initialized");
         return ESP_OK;
     }
-    
+
     s_output_callback = output_callback;
-    
+
     // 注册设置变化回调
     settings_register_callback(on_jpeg_quality_changed);
-    
+
     // 从设置管理器获取当前JPEG质量
     setting_value_t quality_val;
-    if (settings_get(SETTING_JPEG_QUALITY, &quality_val) == ESP_OK) {
-        s_jpeg_quality = quality_val.uint8_value;
+    if (settings_get(SETTING_JPEG_QUALITY, &quality_val) == ESP_OK && quality_val.uint8_value >= 1 &&
+        quality_val.uint8_value <= 100) {
+        s_pending.quality = quality_val.uint8_value;
     }
-    
+
     return init_jpeg_encoder_internal();
 }
 
@@ -208,36 +554,75 @@ esp_err_t jpeg_stream_encoder_start(void) {
         ESP_LOGE(TAG, "JPEG encoder not initialized");
         return ESP_ERR_INVALID_STATE;
     }
-    
+
     if (s_jpeg_queue != NULL || s_jpeg_task != NULL) {
         ESP_LOGW(TAG, "JPEG encoder already started");
         return ESP_OK;
     }
-    
-    // 创建编码消息队列
-    s_jpeg_queue = xQueueCreate(16, sizeof(jpeg_chunk_msg_t));
-    if (!s_jpeg_queue) {
+
+    // 创建编码消息队列与双缓冲输出队列
+    s_jpeg_queue = xQueueCreate(JPEG_ENC_CHUNK_QUEUE_LEN, sizeof(jpeg_chunk_msg_t));
+    s_out_free_queue = xQueueCreate(2, sizeof(int));
+    s_out_done_queue = xQueueCreate(2, sizeof(jpeg_out_frame_t));
+    s_feed_lock = xSemaphoreCreateMutex();
+    if (!s_jpeg_queue || !s_out_free_queue || !s_out_done_queue || !s_feed_lock) {
         ESP_LOGE(TAG, "Failed to create JPEG queue");
-        return ESP_ERR_NO_MEM;
+        goto fail;
+    }
+    for (int i = 0; i < 2; i++) {
+        xQueueSend(s_out_free_queue, &i, 0);
+    }
+    if (mem_pool_init(&s_chunk_pool, "enc_chunks", JPEG_ENC_COPY_BLOCK_SIZE, JPEG_ENC_CHUNK_QUEUE_LEN + 1,
+                      MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT) != ESP_OK) {
+        goto fail;
+    }
+
+    if (xTaskCreatePinnedToCore(jpeg_output_task, "jpeg_out", 4096, NULL, 8, &s_out_task, tskNO_AFFINITY) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create JPEG output task");
+        s_out_task = NULL;
+        goto fail;
     }
-    
+
     // 创建编码任务
     if (xTaskCreatePinnedToCore(jpeg_encode_feed_task, "jpeg_feed", 8192, NULL, 9, &s_jpeg_task, tskNO_AFFINITY) != pdPASS) {
         ESP_LOGE(TAG, "Failed to create JPEG feed task");
-        vQueueDelete(s_jpeg_queue);
-        s_jpeg_queue = NULL;
-        return ESP_ERR_NO_MEM;
+        s_jpeg_task = NULL;
+        goto fail;
     }
-    
+
     ESP_LOGI(TAG, "JPEG encoder started successfully");
     return ESP_OK;
+
+fail:
+    if (s_out_task) {
+        vTaskDelete(s_out_task);
+        s_out_task = NULL;
+    }
+    if (s_jpeg_queue) {
+        vQueueDelete(s_jpeg_queue);
+        s_jpeg_queue = NULL;
+    }
+    if (s_out_free_queue) {
+        vQueueDelete(s_out_free_queue);
+        s_out_free_queue = NULL;
+    }
+    if (s_out_done_queue) {
+        vQueueDelete(s_out_done_queue);
+        s_out_done_queue = NULL;
+    }
+    if (s_feed_lock) {
+        vSemaphoreDelete(s_feed_lock);
+        s_feed_lock = NULL;
+    }
+    mem_pool_deinit(&s_chunk_pool);
+    return ESP_ERR_NO_MEM;
 }
 
 void jpeg_stream_encoder_stop(void) {
     // 停止JPEG编码任务
     if (s_jpeg_task) {
         // 发送退出信号
-        jpeg_chunk_msg_t quit = {.data = NULL, .len = 0};
+        jpeg_chunk_msg_t quit = {.data = NULL, .len = 0, .release = NULL, .release_ctx = NULL, .skip = 0};
         if (s_jpeg_queue) {
             xQueueSend(s_jpeg_queue, &quit, 0);
         }
@@ -245,57 +630,186 @@ void jpeg_stream_encoder_stop(void) {
         vTaskDelay(pdMS_TO_TICKS(100));
         s_jpeg_task = NULL;
     }
-    
+
+    // 停止输出任务
+    if (s_out_task) {
+        jpeg_out_frame_t quit = {.index = -1, .len = 0};
+        xQueueSend(s_out_done_queue, &quit, pdMS_TO_TICKS(100));
+        vTaskDelay(pdMS_TO_TICKS(100));
+        s_out_task = NULL;
+    }
+
     // 清理队列
     if (s_jpeg_queue) {
         // 清空残留消息并释放内存
         jpeg_chunk_msg_t m;
         while (xQueueReceive(s_jpeg_queue, &m, 0) == pdTRUE) {
-            if (m.data) free(m.data);
+            jpeg_chunk_msg_release(&m);
         }
         vQueueDelete(s_jpeg_queue);
         s_jpeg_queue = NULL;
     }
-    
+    mem_pool_deinit(&s_chunk_pool);
+    if (s_out_free_queue) {
+        vQueueDelete(s_out_free_queue);
+        s_out_free_queue = NULL;
+    }
+    if (s_out_done_queue) {
+        vQueueDelete(s_out_done_queue);
+        s_out_done_queue = NULL;
+    }
+    if (s_feed_lock) {
+        vSemaphoreDelete(s_feed_lock);
+        s_feed_lock = NULL;
+    }
+    s_input_owner = NULL;
+
     // 清理编码器资源
     cleanup_jpeg_encoder_internal();
-    
+
     // 注意：settings_manager没有提供注销回调的接口
     // 在实际应用中，可能需要在settings_manager中添加此功能
-    
+
     s_output_callback = NULL;
-    
+
     ESP_LOGI(TAG, "JPEG encoder stopped");
 }
 
+// 取得投递锁；输入被其他任务独占时拒绝，字节数留待独占结束后计为丢失
+static esp_err_t jpeg_feed_lock(size_t len) {
+    const TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    // 独占期间外部流走快速路径直接拒绝，不与独占方争锁 (SPI 接收任务不能被阻塞)
+    if (s_input_owner == NULL || s_input_owner == self) {
+        xSemaphoreTake(s_feed_lock, portMAX_DELAY);
+        if (s_input_owner == NULL || s_input_owner == self) {
+            return ESP_OK;
+        }
+        xSemaphoreGive(s_feed_lock);
+    }
+    portENTER_CRITICAL(&s_param_lock);
+    s_refused_bytes += len;
+    s_refused_count++;
+    portEXIT_CRITICAL(&s_param_lock);
+    return ESP_ERR_INVALID_STATE;
+}
+
 esp_err_t jpeg_stream_encoder_feed_data(const uint8_t* data, size_t len) {
     if (!s_jpeg_queue || !data || len == 0) {
         return ESP_ERR_INVALID_ARG;
     }
-    
-    // 分配内存并复制数据
-    uint8_t* data_copy = malloc(len);
-    if (!data_copy) {
-        ESP_LOGE(TAG, "Failed to allocate memory for data copy");
-        return ESP_ERR_NO_MEM;
+    esp_err_t ret = jpeg_feed_lock(len);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // 从块池取块复制数据，超过块大小的按块拆分投递
+    while (len > 0) {
+        const size_t n = len < JPEG_ENC_COPY_BLOCK_SIZE ? len : JPEG_ENC_COPY_BLOCK_SIZE;
+        uint8_t* data_copy = mem_pool_alloc(&s_chunk_pool);
+        if (!data_copy) {
+            ESP_LOGW(TAG, "Chunk pool exhausted");
+            s_feed_gap += len;
+            ret = ESP_ERR_NO_MEM;
+            break;
+        }
+
+        memcpy(data_copy, data, n);
+
+        jpeg_chunk_msg_t msg = {
+            .data = data_copy,
+            .len = n,
+            .release = NULL,
+            .release_ctx = NULL,
+            .skip = s_feed_gap
+        };
+
+        if (xQueueSend(s_jpeg_queue, &msg, pdMS_TO_TICKS(100)) != pdTRUE) {
+            mem_pool_free(&s_chunk_pool, data_copy);
+            s_feed_gap += len;
+            ESP_LOGW(TAG, "Failed to send data to JPEG queue");
+            ret = ESP_ERR_TIMEOUT;
+            break;
+        }
+
+        s_feed_gap = 0;
+        data += n;
+        len -= n;
+    }
+    xSemaphoreGive(s_feed_lock);
+    return ret;
+}
+
+esp_err_t jpeg_stream_encoder_feed_ref(const uint8_t* data, size_t len, jpeg_chunk_release_t release,
+                                       void* release_ctx) {
+    if (!s_jpeg_queue || !data || len == 0 || !release) {
+        return ESP_ERR_INVALID_ARG;
     }
-    
-    memcpy(data_copy, data, len);
-    
+    esp_err_t ret = jpeg_feed_lock(len);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
     jpeg_chunk_msg_t msg = {
-        .data = data_copy,
-        .len = len
+        .data = (uint8_t*)data,
+        .len = len,
+        .release = release,
+        .release_ctx = release_ctx,
+        .skip = s_feed_gap
     };
-    
-    if (xQueueSend(s_jpeg_queue, &msg, pdMS_TO_TICKS(100)) != pdTRUE) {
-        free(data_copy);
-        ESP_LOGW(TAG, "Failed to send data to JPEG queue");
-        return ESP_ERR_TIMEOUT;
+
+    if (xQueueSend(s_jpeg_queue, &msg, 0) != pdTRUE) {
+        s_feed_gap += len;
+        ret = ESP_ERR_TIMEOUT;
+    } else {
+        s_feed_gap = 0;
+    }
+    xSemaphoreGive(s_feed_lock);
+    return ret;
+}
+
+esp_err_t jpeg_stream_encoder_claim_input(void) {
+    if (!s_jpeg_queue || !s_feed_lock) {
+        return ESP_ERR_INVALID_STATE;
     }
-    
+    const TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    xSemaphoreTake(s_feed_lock, portMAX_DELAY);
+    if (s_input_owner != NULL) {
+        xSemaphoreGive(s_feed_lock);
+        return s_input_owner == self ? ESP_OK : ESP_ERR_INVALID_STATE;
+    }
+
+    // 外部流的丢失字节留到独占结束后再送出
+    s_input_owner = self;
+    s_external_gap = s_feed_gap;
+    s_feed_gap = 0;
+    portENTER_CRITICAL(&s_param_lock);
+    s_refused_bytes = 0;
+    portEXIT_CRITICAL(&s_param_lock);
+
+    // 控制消息与数据块同在一个队列，必须送达
+    const jpeg_chunk_msg_t msg = {.kind = JPEG_CHUNK_CLAIM};
+    xQueueSend(s_jpeg_queue, &msg, portMAX_DELAY);
+    xSemaphoreGive(s_feed_lock);
     return ESP_OK;
 }
 
+void jpeg_stream_encoder_release_input(void) {
+    if (!s_jpeg_queue || !s_feed_lock || s_input_owner != xTaskGetCurrentTaskHandle()) {
+        return;
+    }
+    xSemaphoreTake(s_feed_lock, portMAX_DELAY);
+    const jpeg_chunk_msg_t msg = {.kind = JPEG_CHUNK_RELEASE};
+    xQueueSend(s_jpeg_queue, &msg, portMAX_DELAY);
+
+    portENTER_CRITICAL(&s_param_lock);
+    s_feed_gap = s_external_gap + s_refused_bytes;
+    s_refused_bytes = 0;
+    s_input_owner = NULL;
+    portEXIT_CRITICAL(&s_param_lock);
+    s_external_gap = 0;
+    xSemaphoreGive(s_feed_lock);
+}
+
 QueueHandle_t jpeg_stream_encoder_get_queue(void) {
     return s_jpeg_queue;
 }
@@ -304,19 +818,50 @@ esp_err_t jpeg_stream_encoder_set_quality(uint8_t quality) {
     if (quality < 1 || quality > 100) {
         return ESP_ERR_INVALID_ARG;
     }
-    
-    s_jpeg_quality = quality;
-    
-    // 如果编码器已初始化，需要重新配置
-    if (s_jpeg_enc) {
-        ESP_LOGI(TAG, "Updating JPEG quality to: %d", quality);
-        // 注意：ESP-IDF的JPEG编码器可能需要重新创建才能更新质量
-        // 这里简单更新变量，实际应用中可能需要重新初始化编码器
-    }
-    
+
+    jpeg_stream_params_t params = jpeg_params_pending();
+    params.quality = quality;
+    jpeg_params_update(&params);
+    ESP_LOGI(TAG, "JPEG quality -> %d (next frame)", quality);
     return ESP_OK;
 }
 
 uint8_t jpeg_stream_encoder_get_quality(void) {
-    return s_jpeg_quality;
-}
\ No newline at end of file
+    return jpeg_params_pending().quality;
+}
+
+esp_err_t jpeg_stream_encoder_set_resolution(uint16_t width, uint16_t height) {
+    if (width == 0 || height == 0 || (width & 1) || width > JPEG_ENC_MAX_WIDTH || height > JPEG_ENC_MAX_HEIGHT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    jpeg_stream_params_t params = jpeg_params_pending();
+    params.width = width;
+    params.height = height;
+    jpeg_params_update(&params);
+    ESP_LOGI(TAG, "JPEG resolution -> %dx%d (next frame)", width, height);
+    return ESP_OK;
+}
+
+esp_err_t jpeg_stream_encoder_set_input_format(jpeg_stream_input_format_t format) {
+    if (format > JPEG_STREAM_INPUT_RGBA) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    jpeg_stream_params_t params = jpeg_params_pending();
+    params.format = format;
+    jpeg_params_update(&params);
+    return ESP_OK;
+}
+
+void jpeg_stream_encoder_get_stats(jpeg_stream_encoder_stats_t* stats) {
+    if (!stats) {
+        return;
+    }
+    *stats = s_stats;
+    stats->input_refused = s_refused_count;
+    stats->width = s_active.width;
+    stats->height = s_active.height;
+    stats->quality = s_active.quality;
+    stats->input_format = s_active.format;
+}
@@ -0,0 +1,598 @@
+/**
+ * @file video_bridge.c
+ * @brief 图传桥实现: 编码输出 -> 有界发送队列 -> TCP/UDP
+ */
+
+#include "video_bridge.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "jpeg_stream_encoder.h"
+#include "lwip/sockets.h"
+#include "spi_slave_receiver.h"
+#include "video_packetizer.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* TAG = "video_bridge";
+
+#define VIDEO_RATE_WINDOW_US 1000000 // 吞吐统计窗口
+
+// 发送队列中的一帧
+typedef struct {
+    uint8_t* buf;        // 槽位自有缓冲 (拷贝提交)
+    const uint8_t* data; // 实际发送的数据: buf 或按引用提交的外部缓冲
+    size_t len;
+    video_bridge_release_t release; // 外部缓冲的释放函数
+    void* release_ctx;
+    uint16_t width;
+    uint16_t height;
+    int64_t queued_us;
+} video_frame_slot_t;
+
+// 单级统计的内部状态
+typedef struct {
+    video_bridge_stage_stats_t pub;
+    uint64_t latency_total_us;
+    uint32_t win_frames;
+    uint64_t win_bytes;
+} video_stage_t;
+
+static video_frame_slot_t s_slots[VIDEO_BRIDGE_QUEUE_DEPTH];
+static QueueHandle_t s_free_queue = NULL;  // 空闲槽位
+static QueueHandle_t s_ready_queue = NULL; // 待发送槽位
+static TaskHandle_t s_send_task = NULL;
+static volatile bool s_running = false;
+static video_bridge_config_t s_config;
+static int s_sock = -1;
+static struct sockaddr_in s_dest;
+static uint8_t* s_packet_buf = NULL; // UDP 分片缓冲
+static uint32_t s_frame_id = 0;
+
+// 合成帧源
+static TaskHandle_t s_pattern_task = NULL;
+static volatile bool s_pattern_running = false;
+static uint32_t s_pattern_fps = 0;
+static jpeg_stream_input_format_t s_pattern_prev_format = JPEG_ENC_INPUT_FORMAT; // 合成帧结束后恢复
+
+// 统计
+static portMUX_TYPE s_stats_lock = portMUX_INITIALIZER_UNLOCKED;
+static video_stage_t s_stage_encode;
+static video_stage_t s_stage_queue;
+static video_stage_t s_stage_send;
+static uint32_t s_queue_drops = 0;
+static uint32_t s_send_drops = 0;
+static uint32_t s_reconnects = 0;
+static bool s_connected = false;
+static bool s_ever_connected = false;
+static uint64_t s_capture_bytes_prev = 0;
+static float s_capture_kbps = 0;
+static int64_t s_window_start_us = 0;
+
+static void stage_record(video_stage_t* stage, size_t bytes, int64_t latency_us) {
+    const uint32_t latency = latency_us > 0 ? (uint32_t)latency_us : 0;
+    portENTER_CRITICAL(&s_stats_lock);
+    stage->pub.frames++;
+    stage->pub.bytes += bytes;
+    stage->pub.latency_last_us = latency;
+    if (latency > stage->pub.latency_max_us) {
+        stage->pub.latency_max_us = latency;
+    }
+    stage->latency_total_us += latency;
+    stage->pub.latency_avg_us = (uint32_t)(stage->latency_total_us / stage->pub.frames);
+    stage->win_frames++;
+    stage->win_bytes += bytes;
+    portEXIT_CRITICAL(&s_stats_lock);
+}
+
+static void stage_window_close(video_stage_t* stage, float seconds) {
+    stage->pub.fps = stage->win_frames / seconds;
+    stage->pub.kbps = stage->win_bytes * 8 / 1000.0f / seconds;
+    stage->win_frames = 0;
+    stage->win_bytes = 0;
+}
+
+// 每个统计窗口结束时更新各级帧率与吞吐 (发送任务调用)
+static void bridge_update_rates(void) {
+    const int64_t now = esp_timer_get_time();
+    if (s_window_start_us == 0) {
+        s_window_start_us = now;
+        return;
+    }
+    if (now - s_window_start_us < VIDEO_RATE_WINDOW_US) {
+        return;
+    }
+
+    const float seconds = (now - s_window_start_us) / 1000000.0f;
+    spi_receiver_stats_t spi;
+    spi_receiver_get_stats(&spi);
+
+    portENTER_CRITICAL(&s_stats_lock);
+    stage_window_close(&s_stage_encode, seconds);
+    stage_window_close(&s_stage_queue, seconds);
+    stage_window_close(&s_stage_send, seconds);
+    s_capture_kbps = (spi.image_bytes - s_capture_bytes_prev) * 8 / 1000.0f / seconds;
+    portEXIT_CRITICAL(&s_stats_lock);
+
+    s_capture_bytes_prev = spi.image_bytes;
+    s_window_start_us = now;
+}
+
+static void bridge_close(void) {
+    if (s_sock >= 0) {
+        close(s_sock);
+        s_sock = -1;
+    }
+    s_connected = false;
+}
+
+static esp_err_t bridge_connect(void) {
+    const bool tcp = s_config.transport == VIDEO_BRIDGE_TRANSPORT_TCP;
+    uint16_t port = s_config.port;
+    if (port == 0) {
+        port = tcp ? VIDEO_BRIDGE_TCP_DEFAULT_PORT : VIDEO_BRIDGE_UDP_DEFAULT_PORT;
+    }
+
+    memset(&s_dest, 0, sizeof(s_dest));
+    s_dest.sin_family = AF_INET;
+    s_dest.sin_port = htons(port);
+    if (inet_pton(AF_INET, s_config.host, &s_dest.sin_addr) != 1) {
+        ESP_LOGE(TAG, "Invalid host: %s", s_config.host);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    s_sock = socket(AF_INET, tcp ? SOCK_STREAM : SOCK_DGRAM, tcp ? IPPROTO_TCP : IPPROTO_UDP);
+    if (s_sock < 0) {
+        ESP_LOGE(TAG, "Unable to create socket: errno %d", errno);
+        return ESP_FAIL;
+    }
+
+    struct timeval timeout = {
+        .tv_sec = VIDEO_BRIDGE_SEND_TIMEOUT_MS / 1000,
+        .tv_usec = (VIDEO_BRIDGE_SEND_TIMEOUT_MS % 1000) * 1000,
+    };
+    setsockopt(s_sock, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    if (tcp) {
+        int nodelay = 1;
+        setsockopt(s_sock, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+        if (connect(s_sock, (struct sockaddr*)&s_dest, sizeof(s_dest)) != 0) {
+            ESP_LOGD(TAG, "Connect %s:%u failed: errno %d", s_config.host, port, errno);
+            bridge_close();
+            return ESP_FAIL;
+        }
+    }
+
+    if (s_ever_connected) {
+        s_reconnects++;
+    }
+    s_ever_connected = true;
+    s_connected = true;
+    ESP_LOGI(TAG, "Video bridge %s -> %s:%u", tcp ? "TCP" : "UDP", s_config.host, port);
+    return ESP_OK;
+}
+
+static esp_err_t bridge_send_all(const uint8_t* data, size_t len) {
+    while (len > 0) {
+        const int sent = send(s_sock, data, len, 0);
+        if (sent < 0) {
+            ESP_LOGW(TAG, "TCP send failed: errno %d", errno);
+            return ESP_FAIL;
+        }
+        data += sent;
+        len -= sent;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t bridge_send_tcp(const video_frame_slot_t* slot) {
+    video_tcp_header_t header;
+    video_packetizer_tcp_header(&header, slot->width, slot->height, (uint32_t)slot->len);
+    if (bridge_send_all((const uint8_t*)&header, sizeof(header)) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    return bridge_send_all(slot->data, slot->len);
+}
+
+static esp_err_t bridge_send_udp(const video_frame_slot_t* slot) {
+    const uint16_t total = video_packetizer_udp_count((uint32_t)slot->len);
+    if (total == 0) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    const uint32_t frame_id = ++s_frame_id;
+    const uint32_t timestamp_ms = (uint32_t)(esp_timer_get_time() / 1000);
+    for (uint16_t i = 0; i < total; i++) {
+        const size_t n = video_packetizer_udp_fragment(frame_id, slot->data, (uint32_t)slot->len, i, timestamp_ms,
+                                                       s_packet_buf);
+        int sent = sendto(s_sock, s_packet_buf, n, 0, (struct sockaddr*)&s_dest, sizeof(s_dest));
+        if (sent < 0 && errno == ENOMEM) {
+            // lwIP 发送缓冲暂时耗尽，让出一个节拍后重试一次
+            vTaskDelay(1);
+            sent = sendto(s_sock, s_packet_buf, n, 0, (struct sockaddr*)&s_dest, sizeof(s_dest));
+        }
+        if (sent < 0) {
+            // 剩余分片不再发送，接收端按整帧丢弃
+            ESP_LOGD(TAG, "UDP send failed at %u/%u: errno %d", i, total, errno);
+            return ESP_FAIL;
+        }
+    }
+    return ESP_OK;
+}
+
+// 发送完成或丢弃: 归还外部缓冲与槽位
+static void bridge_slot_free(video_frame_slot_t* slot) {
+    if (slot->release) {
+        slot->release(slot->release_ctx);
+        slot->release = NULL;
+    }
+    xQueueSend(s_free_queue, &slot, 0);
+}
+
+// 未连接时把排队的帧整帧丢弃，保证恢复后发送的是最新画面
+static void bridge_drain_ready(void) {
+    video_frame_slot_t* slot = NULL;
+    while (xQueueReceive(s_ready_queue, &slot, 0) == pdTRUE) {
+        if (slot) {
+            s_send_drops++;
+            bridge_slot_free(slot);
+        }
+    }
+}
+
+static void video_send_task(void* arg) {
+    ESP_LOGI(TAG, "Video send task started");
+
+    while (s_running) {
+        if (s_sock < 0 && bridge_connect() != ESP_OK) {
+            bridge_drain_ready();
+            vTaskDelay(pdMS_TO_TICKS(VIDEO_BRIDGE_RECONNECT_DELAY_MS));
+            continue;
+        }
+
+        video_frame_slot_t* slot = NULL;
+        if (xQueueReceive(s_ready_queue, &slot, pdMS_TO_TICKS(1000)) == pdTRUE && slot) {
+            const int64_t start_us = esp_timer_get_time();
+            stage_record(&s_stage_queue, slot->len, start_us - slot->queued_us);
+
+            esp_err_t ret = s_config.transport == VIDEO_BRIDGE_TRANSPORT_TCP ? bridge_send_tcp(slot)
+                                                                             : bridge_send_udp(slot);
+            if (ret == ESP_OK) {
+                stage_record(&s_stage_send, slot->len, esp_timer_get_time() - start_us);
+            } else {
+                s_send_drops++;
+                if (s_config.transport == VIDEO_BRIDGE_TRANSPORT_TCP) {
+                    // 流已失步，重新连接后从下一帧的帧头开始
+                    bridge_close();
+                }
+            }
+            bridge_slot_free(slot);
+        }
+
+        bridge_update_rates();
+    }
+
+    bridge_close();
+    ESP_LOGI(TAG, "Video send task stopped");
+    s_send_task = NULL;
+    vTaskDelete(NULL);
+}
+
+static void bridge_free(void) {
+    // 归还仍在队列中的外部缓冲
+    video_frame_slot_t* slot = NULL;
+    while (s_ready_queue && xQueueReceive(s_ready_queue, &slot, 0) == pdTRUE) {
+        if (slot && slot->release) {
+            slot->release(slot->release_ctx);
+            slot->release = NULL;
+        }
+    }
+    for (int i = 0; i < VIDEO_BRIDGE_QUEUE_DEPTH; i++) {
+        if (s_slots[i].buf) {
+            heap_caps_free(s_slots[i].buf);
+            s_slots[i].buf = NULL;
+        }
+    }
+    if (s_packet_buf) {
+        heap_caps_free(s_packet_buf);
+        s_packet_buf = NULL;
+    }
+    if (s_free_queue) {
+        vQueueDelete(s_free_queue);
+        s_free_queue = NULL;
+    }
+    if (s_ready_queue) {
+        vQueueDelete(s_ready_queue);
+        s_ready_queue = NULL;
+    }
+}
+
+esp_err_t video_bridge_start(const video_bridge_config_t* config) {
+    if (!config) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_send_task) {
+        ESP_LOGW(TAG, "Video bridge already running");
+        return ESP_OK;
+    }
+
+    s_config = *config;
+    s_config.host[sizeof(s_config.host) - 1] = '\0';
+
+    s_free_queue = xQueueCreate(VIDEO_BRIDGE_QUEUE_DEPTH, sizeof(video_frame_slot_t*));
+    s_ready_queue = xQueueCreate(VIDEO_BRIDGE_QUEUE_DEPTH + 1, sizeof(video_frame_slot_t*));
+    s_packet_buf = (uint8_t*)heap_caps_malloc(VIDEO_UDP_MAX_PACKET_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!s_free_queue || !s_ready_queue || !s_packet_buf) {
+        bridge_free();
+        return ESP_ERR_NO_MEM;
+    }
+
+    // 发送队列槽位放在 PSRAM，每个可容纳编码器最大输出
+    for (int i = 0; i < VIDEO_BRIDGE_QUEUE_DEPTH; i++) {
+        s_slots[i].buf = (uint8_t*)heap_caps_malloc(JPEG_ENC_OUTPUT_BUF_SIZE, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        if (!s_slots[i].buf) {
+            ESP_LOGE(TAG, "Failed to allocate frame slot %d", i);
+            bridge_free();
+            return ESP_ERR_NO_MEM;
+        }
+        video_frame_slot_t* slot = &s_slots[i];
+        xQueueSend(s_free_queue, &slot, 0);
+    }
+
+    portENTER_CRITICAL(&s_stats_lock);
+    memset(&s_stage_encode, 0, sizeof(s_stage_encode));
+    memset(&s_stage_queue, 0, sizeof(s_stage_queue));
+    memset(&s_stage_send, 0, sizeof(s_stage_send));
+    s_queue_drops = 0;
+    s_send_drops = 0;
+    s_reconnects = 0;
+    s_capture_kbps = 0;
+    portEXIT_CRITICAL(&s_stats_lock);
+    s_ever_connected = false;
+    s_window_start_us = 0;
+
+    s_running = true;
+    if (xTaskCreatePinnedToCore(video_send_task, "video_send", 4096, NULL, 7, &s_send_task, tskNO_AFFINITY) !=
+        pdPASS) {
+        ESP_LOGE(TAG, "Failed to create video send task");
+        s_running = false;
+        s_send_task = NULL;
+        bridge_free();
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Video bridge started: %s %s:%u, queue %d frames",
+             s_config.transport == VIDEO_BRIDGE_TRANSPORT_TCP ? "TCP" : "UDP", s_config.host, s_config.port,
+             VIDEO_BRIDGE_QUEUE_DEPTH);
+    return ESP_OK;
+}
+
+void video_bridge_stop(void) {
+    video_bridge_stop_test_pattern();
+
+    if (s_send_task) {
+        s_running = false;
+        // 唤醒阻塞在队列上的发送任务
+        video_frame_slot_t* wake = NULL;
+        xQueueSend(s_ready_queue, &wake, 0);
+
+        // 等待任务退出，最多等待 (连接/发送超时 + 1) 秒
+        uint32_t wait_count = 0;
+        while (s_send_task && wait_count < 50) {
+            vTaskDelay(pdMS_TO_TICKS(100));
+            wait_count++;
+        }
+    }
+    bridge_free();
+    ESP_LOGI(TAG, "Video bridge stopped");
+}
+
+void video_bridge_submit_frame(const uint8_t* data, size_t len) {
+    if (!s_running || !s_free_queue || !data || len == 0) {
+        return;
+    }
+
+    jpeg_stream_encoder_stats_t enc;
+    jpeg_stream_encoder_get_stats(&enc);
+    stage_record(&s_stage_encode, len, enc.last_encode_us);
+
+    video_frame_slot_t* slot = NULL;
+    if (len > JPEG_ENC_OUTPUT_BUF_SIZE || xQueueReceive(s_free_queue, &slot, 0) != pdTRUE) {
+        // 发送级跟不上: 丢弃新完成的整帧，不阻塞编码器输出任务
+        s_queue_drops++;
+        return;
+    }
+
+    memcpy(slot->buf, data, len);
+    slot->data = slot->buf;
+    slot->len = len;
+    slot->release = NULL;
+    slot->release_ctx = NULL;
+    slot->width = enc.width;
+    slot->height = enc.height;
+    slot->queued_us = esp_timer_get_time();
+    xQueueSend(s_ready_queue, &slot, 0);
+}
+
+esp_err_t video_bridge_submit_frame_ref(const uint8_t* data, size_t len, uint16_t width, uint16_t height,
+                                        video_bridge_release_t release, void* release_ctx) {
+    if (!data || len == 0 || !release) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_running || !s_free_queue) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    video_frame_slot_t* slot = NULL;
+    if (xQueueReceive(s_free_queue, &slot, 0) != pdTRUE) {
+        s_queue_drops++;
+        return ESP_ERR_TIMEOUT;
+    }
+
+    slot->data = data;
+    slot->len = len;
+    slot->width = width;
+    slot->height = height;
+    slot->release = release;
+    slot->release_ctx = release_ctx;
+    slot->queued_us = esp_timer_get_time();
+    xQueueSend(s_ready_queue, &slot, 0);
+    return ESP_OK;
+}
+
+// 合成帧源: RGB565 彩条 + 移动的白色竖条，按条带送入编码器
+// 运行期间独占编码器输入，SPI 图像数据被拒绝，两路数据不会交错进同一帧
+static void video_pattern_task(void* arg) {
+    static const uint16_t bars[8] = {0xFFFF, 0xFFE0, 0x07FF, 0x07E0, 0xF81F, 0xF800, 0x001F, 0x0000};
+    const uint32_t band_rows = 16;
+    uint8_t* band = NULL;
+    size_t band_size = 0;
+    uint32_t frame = 0;
+    const TickType_t period = pdMS_TO_TICKS(1000 / s_pattern_fps) > 0 ? pdMS_TO_TICKS(1000 / s_pattern_fps) : 1;
+    TickType_t last_wake = xTaskGetTickCount();
+
+    if (jpeg_stream_encoder_claim_input() != ESP_OK) {
+        ESP_LOGE(TAG, "Encoder input busy, test pattern not started");
+        s_pattern_running = false;
+        s_pattern_task = NULL;
+        vTaskDelete(NULL);
+        return;
+    }
+    // 合成帧按 RGB565 小端生成，在独占后的第一帧生效
+    jpeg_stream_encoder_set_input_format(JPEG_STREAM_INPUT_RGB565_LE);
+
+    ESP_LOGI(TAG, "Test pattern started: %lu fps", (unsigned long)s_pattern_fps);
+    while (s_pattern_running) {
+        jpeg_stream_encoder_stats_t enc;
+        jpeg_stream_encoder_get_stats(&enc);
+        const uint32_t width = enc.width;
+        const uint32_t height = enc.height;
+        const size_t need = width * band_rows * 2;
+        if (need > band_size) {
+            free(band);
+            band = (uint8_t*)malloc(need);
+            band_size = band ? need : 0;
+        }
+        if (!band || width == 0) {
+            vTaskDelay(pdMS_TO_TICKS(100));
+            continue;
+        }
+
+        const uint32_t marker = (frame * 4) % width;
+        for (uint32_t y = 0; y < height; y += band_rows) {
+            const uint32_t rows = height - y < band_rows ? height - y : band_rows;
+            uint16_t* px = (uint16_t*)band;
+            for (uint32_t r = 0; r < rows; r++) {
+                for (uint32_t x = 0; x < width; x++) {
+                    const bool on_marker = x >= marker && x < marker + 8;
+                    *px++ = on_marker ? 0xFFFF : bars[x * 8 / width];
+                }
+            }
+            jpeg_stream_encoder_feed_data(band, width * rows * 2);
+        }
+        frame++;
+        vTaskDelayUntil(&last_wake, period);
+    }
+
+    free(band);
+    // 先恢复外部流的输入格式再结束独占，SPI 数据按原格式恢复帧对齐
+    jpeg_stream_encoder_set_input_format(s_pattern_prev_format);
+    jpeg_stream_encoder_release_input();
+    ESP_LOGI(TAG, "Test pattern stopped after %lu frames", (unsigned long)frame);
+    s_pattern_task = NULL;
+    vTaskDelete(NULL);
+}
+
+esp_err_t video_bridge_start_test_pattern(uint32_t fps) {
+    if (fps == 0 || fps > 60) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_pattern_task) {
+        return ESP_OK;
+    }
+    if (!jpeg_stream_encoder_get_queue()) {
+        ESP_LOGE(TAG, "JPEG encoder not started");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    jpeg_stream_encoder_stats_t enc;
+    jpeg_stream_encoder_get_stats(&enc);
+    s_pattern_prev_format = enc.input_format;
+    s_pattern_fps = fps;
+    s_pattern_running = true;
+    if (xTaskCreatePinnedToCore(video_pattern_task, "video_pattern", 3072, NULL, 4, &s_pattern_task,
+                                tskNO_AFFINITY) != pdPASS) {
+        s_pattern_running = false;
+        s_pattern_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void video_bridge_stop_test_pattern(void) {
+    if (!s_pattern_task) {
+        return;
+    }
+    s_pattern_running = false;
+    uint32_t wait_count = 0;
+    while (s_pattern_task && wait_count < 20) {
+        vTaskDelay(pdMS_TO_TICKS(100));
+        wait_count++;
+    }
+}
+
+void video_bridge_get_stats(video_bridge_stats_t* stats) {
+    if (!stats) {
+        return;
+    }
+    memset(stats, 0, sizeof(*stats));
+
+    spi_receiver_stats_t spi;
+    spi_receiver_get_stats(&spi);
+    jpeg_stream_encoder_stats_t enc;
+    jpeg_stream_encoder_get_stats(&enc);
+
+    portENTER_CRITICAL(&s_stats_lock);
+    stats->encode = s_stage_encode.pub;
+    stats->queue = s_stage_queue.pub;
+    stats->send = s_stage_send.pub;
+    stats->capture.kbps = s_capture_kbps;
+    stats->queue_drops = s_queue_drops;
+    stats->send_drops = s_send_drops;
+    stats->reconnects = s_reconnects;
+    portEXIT_CRITICAL(&s_stats_lock);
+
+    // 采集级: 图像字节来自 SPI 解复用器，完整输入的帧数 = 编码完成 + 编码级丢弃
+    stats->capture.bytes = spi.image_bytes;
+    stats->capture.frames = enc.frames_encoded + enc.frames_dropped;
+    stats->encode.fps = enc.fps;
+    stats->encode_drops = enc.frames_dropped;
+    stats->queue_depth = s_ready_queue ? (uint32_t)uxQueueMessagesWaiting(s_ready_queue) : 0;
+    stats->connected = s_connected;
+}
+
+static void print_stage(const char* name, const video_bridge_stage_stats_t* stage) {
+    ESP_LOGI(TAG, "  %-7s frames=%lu bytes=%llu fps=%.1f kbps=%.0f lat(us) last=%lu avg=%lu max=%lu", name,
+             (unsigned long)stage->frames, (unsigned long long)stage->bytes, stage->fps, stage->kbps,
+             (unsigned long)stage->latency_last_us, (unsigned long)stage->latency_avg_us,
+             (unsigned long)stage->latency_max_us);
+}
+
+void video_bridge_print_status(void) {
+    video_bridge_stats_t stats;
+    video_bridge_get_stats(&stats);
+
+    ESP_LOGI(TAG, "=== 图传桥状态 ===");
+    ESP_LOGI(TAG, "  连接: %s, 重连 %lu 次, 队列 %lu/%d", stats.connected ? "已连接" : "未连接",
+             (unsigned long)stats.reconnects, (unsigned long)stats.queue_depth, VIDEO_BRIDGE_QUEUE_DEPTH);
+    print_stage("capture", &stats.capture);
+    print_stage("encode", &stats.encode);
+    print_stage("queue", &stats.queue);
+    print_stage("send", &stats.send);
+    ESP_LOGI(TAG, "  整帧丢弃: 编码 %lu, 队列 %lu, 发送 %lu", (unsigned long)stats.encode_drops,
+             (unsigned long)stats.queue_drops, (unsigned long)stats.send_drops);
+}
@@ -0,0 +1,65 @@
+/**
+ * @file video_packetizer.c
+ * @brief 图传封包实现
+ */
+
+#include "video_packetizer.h"
+#include <string.h>
+
+_Static_assert(sizeof(video_tcp_header_t) == 13, "TCP header must match image_transfer_header_t");
+_Static_assert(sizeof(video_udp_header_t) == 32, "UDP header must match p2p_udp_packet_header_t");
+
+void video_packetizer_tcp_header(video_tcp_header_t* header, uint16_t width, uint16_t height, uint32_t len) {
+    header->sync_word = VIDEO_TCP_SYNC_WORD;
+    header->frame_type = VIDEO_TCP_FRAME_TYPE_JPEG;
+    header->width = width;
+    header->height = height;
+    header->data_len = len;
+}
+
+uint16_t video_packetizer_udp_count(uint32_t len) {
+    if (len == 0 || len > VIDEO_UDP_MAX_FRAME_SIZE) {
+        return 0;
+    }
+    return (uint16_t)((len + VIDEO_UDP_PAYLOAD_SIZE - 1) / VIDEO_UDP_PAYLOAD_SIZE);
+}
+
+uint16_t video_packetizer_checksum(const uint8_t* data, size_t len) {
+    uint32_t sum = 0;
+    for (size_t i = 0; i < len; i++) {
+        sum += data[i];
+    }
+    return (uint16_t)(sum & 0xFFFF);
+}
+
+size_t video_packetizer_udp_fragment(uint32_t frame_id, const uint8_t* frame, uint32_t len, uint16_t index,
+                                     uint32_t timestamp_ms, uint8_t* out) {
+    const uint16_t total = video_packetizer_udp_count(len);
+    if (index >= total) {
+        return 0;
+    }
+
+    const uint32_t offset = (uint32_t)index * VIDEO_UDP_PAYLOAD_SIZE;
+    uint32_t size = len - offset;
+    if (size > VIDEO_UDP_PAYLOAD_SIZE) {
+        size = VIDEO_UDP_PAYLOAD_SIZE;
+    }
+
+    video_udp_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.magic = VIDEO_UDP_MAGIC;
+    header.packet_type = VIDEO_UDP_PACKET_TYPE_FRAME_DATA;
+    header.version = VIDEO_UDP_VERSION;
+    header.sequence_num = index;
+    header.frame_id = frame_id;
+    header.packet_id = index;
+    header.total_packets = total;
+    header.frame_size = len;
+    header.data_size = (uint16_t)size;
+    header.checksum = video_packetizer_checksum(&frame[offset], size);
+    header.timestamp = timestamp_ms;
+
+    memcpy(out, &header, sizeof(header));
+    memcpy(out + sizeof(header), &frame[offset], size);
+    return sizeof(header) + size;
+}
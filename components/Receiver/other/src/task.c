@@ -11,12 +11,16 @@
 #include "task.h"
 #include "tcp_client_hb.h"
 #include "tcp_client_telemetry.h"
+#include "pwm_controller.h"
+#include "video_bridge.h"
+#include "metrics_server.h"
 #include "esp_log.h"
 #include "esp_event.h"
 #include "esp_task_wdt.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
+#include <string.h>
 
 static const char *TAG = "Task";
 
@@ -254,9 +258,7 @@ static void tcp_task_function(void *pvParameters) {
             if (!s_tcp_modules_running) {
                 ESP_LOGI(TAG, "WIFI已连接，启动TCP模块");
                 
-                // 添加延时，确保WiFi连接稳定
-                vTaskDelay(pdMS_TO_TICKS(2000));
-                
+                // 连接位在取得 IP 后才置位，此时套接字已可用，无需额外延时
                 if (start_tcp_modules() == ESP_OK) {
                     s_tcp_modules_running = true;
                     ESP_LOGI(TAG, "TCP模块启动成功");
@@ -286,6 +288,7 @@ static void tcp_task_function(void *pvParameters) {
             if (++status_print_counter >= 30) { // 30秒 / 1秒 = 30次
                 tcp_client_hb_print_status();
                 tcp_client_telemetry_print_status();
+                video_bridge_print_status();
                 status_print_counter = 0;
             }
             
@@ -364,6 +367,18 @@ static esp_err_t start_tcp_modules(void) {
         ESP_LOGE(TAG, "遥测模块启动失败");
         return ESP_FAIL;
     }
+
+    // 启动图传桥 (SPI 采集的画面编码后发往主控端图传服务器)
+    video_bridge_config_t video_cfg = {.transport = VIDEO_BRIDGE_TRANSPORT_TCP, .port = 0};
+    strncpy(video_cfg.host, s_server_ip, sizeof(video_cfg.host) - 1);
+    if (video_bridge_start(&video_cfg) != ESP_OK) {
+        ESP_LOGW(TAG, "图传桥启动失败");
+    }
+
+    // 指标抓取服务 (重复启动直接返回)
+    if (metrics_server_start(METRICS_SERVER_PORT) != ESP_OK) {
+        ESP_LOGW(TAG, "指标服务启动失败");
+    }
     
     return ESP_OK;
 }
@@ -377,6 +392,7 @@ static esp_err_t stop_tcp_modules(void) {
     // 停止心跳和遥测客户端
     tcp_client_hb_stop();
     tcp_client_telemetry_stop();
+    video_bridge_stop();
     
     return ESP_OK;
 }
@@ -387,19 +403,14 @@ static esp_err_t stop_tcp_modules(void) {
  */
 static void pwm_control_callback(const remote_control_data_t* rc_data) {
     if (!rc_data) {
-        ESP_LOGW(TAG, "PWM回调: 遥控数据为空");
         return;
     }
     
-    ESP_LOGI(TAG, "PWM控制数据解析:");
-    ESP_LOGI(TAG, "  通道数量: %d", rc_data->channel_count);
-    
-    // 遍历所有通道并计算占空比
-    for (int i = 0; i < rc_data->channel_count && i < 8; i++) {
-        // 将通道值(0-1000)转换为占空比百分比
-        float duty_cycle = (rc_data->channel_values[i] / 1000.0f) * 100.0f;
-        ESP_LOGI(TAG, "  通道%d: 值=%d, 占空比=%.1f%%", 
-                 i + 1, rc_data->channel_values[i], duty_cycle);
+    // 遥控帧到达即批量更新全部通道，在下一个PWM周期边界统一生效；热路径不打印日志
+    esp_err_t ret = pwm_controller_apply_channels(rc_data->channel_values, rc_data->channel_count,
+                                                  rc_data->timestamp_us);
+    if (ret != ESP_OK) {
+        ESP_LOGD(TAG, "PWM批量更新失败: %s", esp_err_to_name(ret));
     }
 }
 
@@ -16,6 +16,7 @@ extern "C" {
 #define PWM_MAX_DUTY_PERCENT        96      // 最大占空比96%
 #define PWM_RESOLUTION_BITS         10      // PWM分辨率10位(1024级)
 #define PWM_MAX_DUTY_VALUE          ((1 << PWM_RESOLUTION_BITS) - 1) // 最大占空比值
+#define PWM_CHANNEL_VALUE_MAX       1000    // 遥控通道值满量程(0-1000对应0-PWM_MAX_DUTY_PERCENT)
 
 // GPIO引脚定义
 #define PWM_GPIO_PIN_1              3
@@ -51,6 +52,16 @@ typedef struct {
     uint32_t total_updates;     // 总更新次数
     uint32_t frequency_changes; // 频率变更次数
     uint64_t last_update_time;  // 最后更新时间戳
+    // 批量更新统计 (延迟 = 帧时间戳到全部通道提交的时间，硬件另需不超过1个PWM周期才生效)
+    uint32_t batch_updates;     // 批量更新次数
+    uint32_t channels_written;  // 批量更新中实际写入(占空比有变化)的通道累计数
+    uint32_t latency_last_us;   // 最近一次更新延迟(us)
+    uint32_t latency_min_us;    // 最小更新延迟(us)
+    uint32_t latency_max_us;    // 最大更新延迟(us)
+    uint32_t latency_avg_us;    // 平均更新延迟(us)
+    uint64_t latency_total_us;  // 更新延迟累计(us)
+    uint32_t interval_last_us;  // 最近两次批量更新的间隔(us)
+    uint32_t interval_max_us;   // 最大批量更新间隔(us)
 } pwm_controller_stats_t;
 
 /**
@@ -85,6 +96,21 @@ esp_err_t pwm_controller_set_frequency(uint32_t frequency);
  */
 esp_err_t pwm_controller_set_duty(uint8_t channel, float duty_percent);
 
+/**
+ * @brief 批量原子更新所有通道的占空比 (热路径，不打印日志)
+ *
+ * 占空比以定点计算，先写入全部通道的占空比寄存器，再在同一临界区内连续提交，
+ * 由LEDC硬件在下一个PWM周期边界统一生效，不会出现中间状态。
+ * 占空比未变化的通道跳过写入，未提供的通道输出0。
+ *
+ * @param channel_values 通道值数组(0-PWM_CHANNEL_VALUE_MAX对应0-PWM_MAX_DUTY_PERCENT)
+ * @param channel_count 通道数量
+ * @param timestamp_us 数据到达时间(esp_timer_get_time)，用于统计更新延迟；传0表示以调用时刻为准
+ * @return esp_err_t ESP_OK表示成功
+ */
+esp_err_t pwm_controller_apply_channels(const uint16_t *channel_values, uint8_t channel_count,
+                                        int64_t timestamp_us);
+
 /**
  * @brief 批量设置多个通道的占空比
  * 
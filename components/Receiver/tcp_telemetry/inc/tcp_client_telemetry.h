@@ -31,6 +31,7 @@ extern "C" {
 typedef struct {
     uint8_t channel_count;
     uint16_t channel_values[8]; // 最多支持8通道
+    int64_t timestamp_us;       // 帧解析完成时间(esp_timer_get_time)
 } remote_control_data_t;
 
 // ----------------- 新增：遥控命令回调函数类型 -----------------
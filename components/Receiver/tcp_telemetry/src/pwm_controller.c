@@ -2,8 +2,10 @@
 #include <string.h>
 #include "esp_log.h"
 #include "esp_system.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "metrics.h"
 
 static const char *TAG = "PWM_CONTROLLER";
 
@@ -13,6 +15,27 @@ static pwm_controller_stats_t g_pwm_stats = {0};
 static bool g_pwm_initialized = false;
 static uint8_t g_current_resolution_bits = PWM_RESOLUTION_BITS; // 当前使用的分辨率位数
 
+// 批量更新: 通道值(0-PWM_CHANNEL_VALUE_MAX) -> 占空比的Q16缩放系数，随分辨率更新
+static uint32_t g_duty_scale_q16 = 0;
+static int64_t g_last_batch_time_us = 0;
+static portMUX_TYPE g_pwm_commit_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// 指标: 计数直接引用统计字段，延迟/间隔另记直方图
+static const uint32_t g_latency_bounds_us[] = {100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000};
+static const uint32_t g_interval_bounds_us[] = {5000, 10000, 20000, 50000, 100000, 200000, 500000};
+static metrics_histogram_t g_latency_hist = METRICS_HISTOGRAM_INIT(
+    "pwm_update_latency_us", "Frame timestamp to PWM commit latency", g_latency_bounds_us);
+static metrics_histogram_t g_interval_hist = METRICS_HISTOGRAM_INIT(
+    "pwm_update_interval_us", "Interval between batch PWM updates", g_interval_bounds_us);
+static metrics_desc_t g_pwm_metrics[] = {
+    METRICS_REF_INIT("pwm_channel_updates_total", "PWM channel duty writes", METRICS_TYPE_COUNTER,
+                     &g_pwm_stats.total_updates),
+    METRICS_REF_INIT("pwm_batch_updates_total", "Batch PWM updates", METRICS_TYPE_COUNTER,
+                     &g_pwm_stats.batch_updates),
+    METRICS_REF_INIT("pwm_frequency_changes_total", "PWM frequency changes", METRICS_TYPE_COUNTER,
+                     &g_pwm_stats.frequency_changes),
+};
+
 // GPIO引脚映射表
 static const uint8_t gpio_pins[PWM_CHANNEL_COUNT] = {
     PWM_GPIO_PIN_1, PWM_GPIO_PIN_2, PWM_GPIO_PIN_3, PWM_GPIO_PIN_4,
@@ -24,6 +47,8 @@ static esp_err_t pwm_controller_configure_timer(uint32_t frequency);
 static esp_err_t pwm_controller_configure_channels(void);
 static uint32_t pwm_controller_percent_to_duty(float percent);
 static uint64_t pwm_controller_get_timestamp_ms(void);
+static void pwm_controller_update_duty_scale(void);
+static void pwm_controller_record_batch(int64_t timestamp_us, uint32_t written);
 
 /**
  * @brief 获取当前时间戳(毫秒)
@@ -44,6 +69,26 @@ static uint32_t pwm_controller_percent_to_duty(float percent) {
     return (uint32_t)((percent / 100.0f) * max_duty_value);
 }
 
+/**
+ * @brief 根据当前分辨率计算定点缩放系数
+ *        duty = value * (max_duty * PWM_MAX_DUTY_PERCENT / 100 / PWM_CHANNEL_VALUE_MAX)
+ */
+static void pwm_controller_update_duty_scale(void) {
+    uint64_t max_duty_value = (1ULL << g_current_resolution_bits) - 1;
+    g_duty_scale_q16 = (uint32_t)((max_duty_value * PWM_MAX_DUTY_PERCENT << 16) /
+                                  (100ULL * PWM_CHANNEL_VALUE_MAX));
+}
+
+/**
+ * @brief 通道值(0-PWM_CHANNEL_VALUE_MAX)转换为占空比值 (定点，无除法)
+ */
+static inline uint32_t pwm_controller_value_to_duty(uint16_t value) {
+    if (value > PWM_CHANNEL_VALUE_MAX) {
+        value = PWM_CHANNEL_VALUE_MAX;
+    }
+    return (uint32_t)(((uint64_t)value * g_duty_scale_q16 + 0x8000) >> 16);
+}
+
 /**
  * @brief 配置LEDC定时器
  */
@@ -70,6 +115,7 @@ static esp_err_t pwm_controller_configure_timer(uint32_t frequency) {
     g_pwm_config.speed_mode = LEDC_LOW_SPEED_MODE;
     g_pwm_config.frequency = frequency;
     g_current_resolution_bits = optimal_resolution; // 更新全局分辨率
+    pwm_controller_update_duty_scale();
     
     ESP_LOGI(TAG, "LEDC定时器配置成功，频率: %luHz, 分辨率: %d位", frequency, optimal_resolution);
     return ESP_OK;
@@ -122,6 +168,7 @@ esp_err_t pwm_controller_init(uint32_t frequency) {
     // 清零配置和统计信息
     memset(&g_pwm_config, 0, sizeof(g_pwm_config));
     memset(&g_pwm_stats, 0, sizeof(g_pwm_stats));
+    g_last_batch_time_us = 0;
     
     // 设置默认频率
     if (frequency == 0) {
@@ -144,6 +191,10 @@ esp_err_t pwm_controller_init(uint32_t frequency) {
     
     g_pwm_config.initialized = true;
     g_pwm_initialized = true;
+
+    metrics_register_refs(g_pwm_metrics, sizeof(g_pwm_metrics) / sizeof(g_pwm_metrics[0]));
+    metrics_register(&g_latency_hist.desc);
+    metrics_register(&g_interval_hist.desc);
     
     ESP_LOGI(TAG, "PWM控制器初始化完成");
     return ESP_OK;
@@ -248,45 +299,118 @@ esp_err_t pwm_controller_set_duty(uint8_t channel, float duty_percent) {
     return ESP_OK;
 }
 
-esp_err_t pwm_controller_set_channels(const uint16_t *channel_values, uint8_t channel_count) {
+/**
+ * @brief 记录一次批量更新的延迟与间隔
+ */
+static void pwm_controller_record_batch(int64_t timestamp_us, uint32_t written) {
+    const int64_t now_us = esp_timer_get_time();
+    const uint32_t latency_us = (uint32_t)(now_us - timestamp_us);
+
+    g_pwm_stats.batch_updates++;
+    g_pwm_stats.channels_written += written;
+    g_pwm_stats.total_updates += written;
+    g_pwm_stats.last_update_time = (uint64_t)(now_us / 1000);
+
+    g_pwm_stats.latency_last_us = latency_us;
+    if (g_pwm_stats.batch_updates == 1 || latency_us < g_pwm_stats.latency_min_us) {
+        g_pwm_stats.latency_min_us = latency_us;
+    }
+    if (latency_us > g_pwm_stats.latency_max_us) {
+        g_pwm_stats.latency_max_us = latency_us;
+    }
+    g_pwm_stats.latency_total_us += latency_us;
+    g_pwm_stats.latency_avg_us = (uint32_t)(g_pwm_stats.latency_total_us / g_pwm_stats.batch_updates);
+    metrics_histogram_observe(&g_latency_hist, latency_us);
+
+    if (g_last_batch_time_us != 0) {
+        g_pwm_stats.interval_last_us = (uint32_t)(now_us - g_last_batch_time_us);
+        metrics_histogram_observe(&g_interval_hist, g_pwm_stats.interval_last_us);
+        if (g_pwm_stats.interval_last_us > g_pwm_stats.interval_max_us) {
+            g_pwm_stats.interval_max_us = g_pwm_stats.interval_last_us;
+        }
+    }
+    g_last_batch_time_us = now_us;
+}
+
+esp_err_t pwm_controller_apply_channels(const uint16_t *channel_values, uint8_t channel_count,
+                                        int64_t timestamp_us) {
     if (!g_pwm_initialized) {
-        ESP_LOGE(TAG, "PWM控制器未初始化");
         return ESP_ERR_INVALID_STATE;
     }
-    
+
     if (!channel_values) {
-        ESP_LOGE(TAG, "通道值数组为空");
         return ESP_ERR_INVALID_ARG;
     }
-    
-    ESP_LOGI(TAG, "批量设置PWM通道，通道数: %d", channel_count);
-    
-    // 首先将所有通道设为0%
+
+    if (timestamp_us == 0) {
+        timestamp_us = esp_timer_get_time();
+    }
+
+    // 1. 定点计算全部通道的目标占空比
+    uint32_t staged[PWM_CHANNEL_COUNT];
+    uint8_t dirty[PWM_CHANNEL_COUNT];
+    uint32_t dirty_count = 0;
+    const uint8_t max_channels = (channel_count > PWM_CHANNEL_COUNT) ? PWM_CHANNEL_COUNT : channel_count;
+
     for (int i = 0; i < PWM_CHANNEL_COUNT; i++) {
-        esp_err_t ret = pwm_controller_set_duty(i, 0.0f);
-        if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "清零通道%d失败", i);
+        pwm_channel_config_t *ch = &g_pwm_config.channels[i];
+        staged[i] = (ch->enabled && i < max_channels) ? pwm_controller_value_to_duty(channel_values[i]) : 0;
+        if (staged[i] != ch->duty_value) {
+            dirty[dirty_count++] = (uint8_t)i;
         }
     }
-    
-    // 设置有效通道的占空比
-    uint8_t max_channels = (channel_count > PWM_CHANNEL_COUNT) ? PWM_CHANNEL_COUNT : channel_count;
-    
-    for (int i = 0; i < max_channels; i++) {
-        // 将0-1000映射到0-96%
-        float duty_percent = (channel_values[i] / 1000.0f) * PWM_MAX_DUTY_PERCENT;
-        
-        esp_err_t ret = pwm_controller_set_duty(i, duty_percent);
+
+    if (dirty_count == 0) {
+        pwm_controller_record_batch(timestamp_us, 0);
+        return ESP_OK;
+    }
+
+    // 2. 写入占空比寄存器 (此时尚未生效)
+    for (uint32_t k = 0; k < dirty_count; k++) {
+        esp_err_t ret = ledc_set_duty(g_pwm_config.speed_mode, (ledc_channel_t)dirty[k], staged[dirty[k]]);
         if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "设置通道%d失败", i);
-        } else {
-            ESP_LOGI(TAG, "通道%d: 值=%d, 占空比=%.2f%%", i + 1, channel_values[i], duty_percent);
+            return ret;
         }
     }
-    
+
+    // 3. 连续提交，所有通道在同一个PWM周期边界由硬件锁存
+    portENTER_CRITICAL(&g_pwm_commit_lock);
+    for (uint32_t k = 0; k < dirty_count; k++) {
+        ledc_update_duty(g_pwm_config.speed_mode, (ledc_channel_t)dirty[k]);
+    }
+    portEXIT_CRITICAL(&g_pwm_commit_lock);
+
+    // 4. 同步配置镜像
+    for (uint32_t k = 0; k < dirty_count; k++) {
+        pwm_channel_config_t *ch = &g_pwm_config.channels[dirty[k]];
+        ch->duty_value = staged[dirty[k]];
+        ch->duty_percent = (float)staged[dirty[k]] * 100.0f / (float)pwm_controller_get_max_duty_value();
+    }
+
+    pwm_controller_record_batch(timestamp_us, dirty_count);
     return ESP_OK;
 }
 
+esp_err_t pwm_controller_set_channels(const uint16_t *channel_values, uint8_t channel_count) {
+    if (!g_pwm_initialized) {
+        ESP_LOGE(TAG, "PWM控制器未初始化");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    if (!channel_values) {
+        ESP_LOGE(TAG, "通道值数组为空");
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    ESP_LOGD(TAG, "批量设置PWM通道，通道数: %d", channel_count);
+    
+    esp_err_t ret = pwm_controller_apply_channels(channel_values, channel_count, 0);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "批量设置PWM通道失败: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
 esp_err_t pwm_controller_enable_channel(uint8_t channel, bool enabled) {
     if (!g_pwm_initialized) {
         ESP_LOGE(TAG, "PWM控制器未初始化");
@@ -353,10 +477,15 @@ void pwm_controller_print_status(void) {
     
     ESP_LOGI(TAG, "统计: 总更新=%lu, 频率变更=%lu, 最后更新=%llu ms",
              g_pwm_stats.total_updates, g_pwm_stats.frequency_changes, g_pwm_stats.last_update_time);
+    ESP_LOGI(TAG, "批量更新: 次数=%lu, 写入通道=%lu, 延迟(us) 最近=%lu 最小=%lu 最大=%lu 平均=%lu, 间隔(us) 最近=%lu 最大=%lu",
+             g_pwm_stats.batch_updates, g_pwm_stats.channels_written, g_pwm_stats.latency_last_us,
+             g_pwm_stats.latency_min_us, g_pwm_stats.latency_max_us, g_pwm_stats.latency_avg_us,
+             g_pwm_stats.interval_last_us, g_pwm_stats.interval_max_us);
 }
 
 void pwm_controller_reset_stats(void) {
     memset(&g_pwm_stats, 0, sizeof(pwm_controller_stats_t));
+    g_last_batch_time_us = 0;
     ESP_LOGI(TAG, "PWM统计信息已重置");
 }
 
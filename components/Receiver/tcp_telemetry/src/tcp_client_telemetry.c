@@ -5,6 +5,7 @@
  * @date 2025-09-05
  */
 #include "tcp_client_telemetry.h"
+#include "metrics.h"
 #include "pwm_controller.h"
 #include <stdio.h>
 #include <stdlib.h>
@@ -20,6 +21,7 @@
 #include "freertos/task.h"
 #include "esp_system.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "lwip/err.h"
 #include "lwip/sockets.h"
 #include "lwip/sys.h"
@@ -45,6 +47,22 @@ static tcp_client_telemetry_manager_t g_telemetry_client = {0};
 static bool g_telemetry_client_initialized = false;
 static remote_control_callback_t g_rc_callback = NULL;
 
+// 统计字段注册为指标，导出时直接读取
+static metrics_desc_t g_telemetry_metrics[] = {
+    METRICS_REF_INIT("telemetry_client_frames_sent_total", "Telemetry frames sent to the ground station",
+                     METRICS_TYPE_COUNTER, &g_telemetry_client.stats.telemetry_sent_count),
+    METRICS_REF_INIT("telemetry_client_send_errors_total", "Telemetry frames that failed to send",
+                     METRICS_TYPE_COUNTER, &g_telemetry_client.stats.telemetry_failed_count),
+    METRICS_REF_INIT("telemetry_client_connections_total", "Telemetry connections established",
+                     METRICS_TYPE_COUNTER, &g_telemetry_client.stats.connection_count),
+    METRICS_REF_INIT("telemetry_client_reconnects_total", "Telemetry reconnection attempts", METRICS_TYPE_COUNTER,
+                     &g_telemetry_client.stats.reconnection_count),
+    METRICS_REF_INIT("telemetry_client_tx_bytes_total", "Telemetry bytes sent", METRICS_TYPE_COUNTER,
+                     &g_telemetry_client.stats.bytes_sent),
+    METRICS_REF_INIT("telemetry_client_rx_bytes_total", "Telemetry bytes received", METRICS_TYPE_COUNTER,
+                     &g_telemetry_client.stats.bytes_received),
+};
+
 // 模拟遥测数据
 static tcp_client_telemetry_sim_data_t g_sim_telemetry = {
     .voltage_mv = 3850,   // 3.85V
@@ -141,22 +159,17 @@ static void parse_and_handle_control_frame(const uint8_t *payload, uint16_t payl
         rc_data.channel_values[i] = (payload[1 + i * 2] << 8) | payload[2 + i * 2];
     }
 
-    // 打印接收到的PWM占空比
-    for (int i = 0; i < rc_data.channel_count; i++) {
-        float duty_cycle = (rc_data.channel_values[i] / 1000.0f) * 100.0f;
-        ESP_LOGI(TAG, "通道 %d: 值 = %d, 占空比 = %.2f%%", i + 1, rc_data.channel_values[i], duty_cycle);
-    }
-
-    // 设置PWM输出
-    esp_err_t ret = pwm_controller_set_channels(rc_data.channel_values, rc_data.channel_count);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "设置PWM通道失败: %s", esp_err_to_name(ret));
-    } else {
-        ESP_LOGI(TAG, "PWM通道设置成功，通道数: %d", rc_data.channel_count);
-    }
+    rc_data.timestamp_us = esp_timer_get_time();
 
+    // 已注册回调时由回调驱动PWM输出，否则直接批量更新 (热路径不打印日志)
     if (g_rc_callback) {
         g_rc_callback(&rc_data);
+    } else {
+        esp_err_t ret = pwm_controller_apply_channels(rc_data.channel_values, rc_data.channel_count,
+                                                      rc_data.timestamp_us);
+        if (ret != ESP_OK) {
+            ESP_LOGD(TAG, "设置PWM通道失败: %s", esp_err_to_name(ret));
+        }
     }
 }
 
@@ -382,6 +395,7 @@ bool tcp_client_telemetry_init(const char *server_ip, uint16_t server_port) {
     g_telemetry_client.is_running = false;
 
     g_telemetry_client_initialized = true;
+    metrics_register_refs(g_telemetry_metrics, sizeof(g_telemetry_metrics) / sizeof(g_telemetry_metrics[0]));
     ESP_LOGI(TAG, "遥测客户端初始化成功，服务器: %s:%d", server_ip, g_telemetry_client.config.server_port);
     
     return true;
@@ -569,14 +583,14 @@ bool tcp_client_telemetry_process_received_data(void) {
             // 检查是否接收到完整帧 (头部 + 负载 + CRC)
             uint16_t expected_frame_len = sizeof(protocol_header_t) + header->length - 1 + 2; // -1因为length包含frame_type
             if (received_bytes - header_pos >= expected_frame_len) {
-                ESP_LOGI(TAG, "接收到完整帧，类型: 0x%02X, 长度: %d", header->frame_type, header->length);
+                ESP_LOGD(TAG, "接收到完整帧，类型: 0x%02X, 长度: %d", header->frame_type, header->length);
                 
                 // 根据帧类型处理
                 if (header->frame_type == FRAME_TYPE_COMMAND) {
                     // 处理命令帧
                     const uint8_t *payload = frame_start + sizeof(protocol_header_t);
                     uint16_t payload_len = header->length - 1; // -1因为length包含frame_type字段
-                    ESP_LOGI(TAG, "处理命令帧，负载长度: %d", payload_len);
+                    ESP_LOGD(TAG, "处理命令帧，负载长度: %d", payload_len);
                     parse_and_handle_control_frame(payload, payload_len);
                 } else {
                     ESP_LOGI(TAG, "接收到其他类型帧: 0x%02X", header->frame_type);
@@ -61,6 +61,10 @@
  *====================*/
 
 #define LV_DISP_DEF_REFR_PERIOD 16  // 60FPS (1000/60≈16ms)
+
+/*lv_disp_flush_ready() 在SPI传输完成中断中调用 (CONFIG_SPI_MASTER_ISR_IN_IRAM)，须放在IRAM*/
+#include "esp_attr.h"
+#define LV_ATTRIBUTE_FLUSH_READY IRAM_ATTR
 #define LV_INDEV_DEF_READ_PERIOD 30
 #define LV_TICK_CUSTOM 0
 
@@ -9,7 +9,13 @@
  *      INCLUDES
  *********************/
 #include "lv_port_disp.h"
+#include "esp_attr.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "sys_trace.h"
 #include <stdbool.h>
 
 // ========================================
@@ -17,6 +23,9 @@
 // ========================================
 #define USE_ESP_LCD_DRIVER 0 // 0=使用原始驱动, 1=使用ESP-LCD驱动
 
+// 默认绘制缓冲策略，见 lv_port_disp_buf_mode_t；内部SRAM不足时回退到 PSRAM 整屏
+#define LV_PORT_DISP_BUF_MODE_DEFAULT LV_PORT_DISP_BUF_SRAM_STRIPES
+
 #if USE_ESP_LCD_DRIVER
 #include "st7789_esp_lcd.h" // ESP-LCD驱动
 #else
@@ -28,6 +37,7 @@
  *********************/
 #define MY_DISP_HOR_RES ST7789_WIDTH
 #define MY_DISP_VER_RES ST7789_HEIGHT
+#define DISP_STRIPE_LINES (MY_DISP_VER_RES / 10) // 内部SRAM条带行数 (约1/10屏)
 
 static const char* TAG = "lv_port_disp";
 
@@ -40,15 +50,35 @@ static const char* TAG = "lv_port_disp";
  **********************/
 static void disp_init(void);
 static void disp_flush(lv_disp_drv_t* disp_drv, const lv_area_t* area, lv_color_t* color_p);
+#if !USE_ESP_LCD_DRIVER
+static void disp_flush_done(void* arg);
+static void disp_wait(lv_disp_drv_t* disp_drv);
+#endif
+static esp_err_t disp_get_bufs(lv_port_disp_buf_mode_t mode, lv_color_t** buf1, lv_color_t** buf2, uint32_t* pixels);
+#if USE_ESP_LCD_DRIVER
+static bool disp_direct_rows(lv_area_t* rows);
+#else
+static size_t disp_direct_rects(st7789_rect_t* rects);
+#endif
 
 /**********************
  *  STATIC VARIABLES
  **********************/
 static bool disp_flush_enabled = true;
 
+// 传输完成时由SPI中断释放，LVGL等待上一块发送结束时阻塞在此而不是空转
+static SemaphoreHandle_t s_flush_done_sem = NULL;
+static lv_port_disp_stats_t s_stats = {0};
+
 #include "esp_heap_caps.h"
-static lv_color_t* disp_buf_1 = NULL;
-static lv_color_t* disp_buf_2 = NULL;
+// 各策略的缓冲首次使用时分配，切换策略后保留以便来回切换
+static lv_color_t* s_stripe_buf[2] = {NULL}; // 内部SRAM，DMA可达
+static lv_color_t* s_full_buf[2] = {NULL};   // PSRAM，direct_mode 只用第一块
+
+static lv_disp_draw_buf_t draw_buf_dsc;
+static lv_disp_drv_t disp_drv; /*Descriptor of a display driver*/
+static lv_disp_t* s_disp = NULL;
+static lv_port_disp_buf_mode_t s_buf_mode = LV_PORT_DISP_BUF_MODE_DEFAULT;
 
 /**********************
  *      MACROS
@@ -67,35 +97,111 @@ void lv_port_disp_init(void) {
     /*-----------------------------
      * Create a buffer for drawing
      *----------------------------*/
-    static lv_disp_draw_buf_t draw_buf_dsc;
-    size_t lines = MY_DISP_VER_RES;
-    size_t buf_pixels = MY_DISP_HOR_RES * lines;
-    disp_buf_1 = (lv_color_t*)heap_caps_malloc(buf_pixels * sizeof(lv_color_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-    disp_buf_2 = (lv_color_t*)heap_caps_malloc(buf_pixels * sizeof(lv_color_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-    lv_disp_draw_buf_init(&draw_buf_dsc, disp_buf_1, disp_buf_2, buf_pixels);
+    lv_color_t* buf1 = NULL;
+    lv_color_t* buf2 = NULL;
+    uint32_t buf_pixels = 0;
+    if (disp_get_bufs(s_buf_mode, &buf1, &buf2, &buf_pixels) != ESP_OK && s_buf_mode != LV_PORT_DISP_BUF_PSRAM_FULL) {
+        ESP_LOGW(TAG, "No memory for %s buffers, falling back to %s", lv_port_disp_buf_mode_name(s_buf_mode),
+                 lv_port_disp_buf_mode_name(LV_PORT_DISP_BUF_PSRAM_FULL));
+        s_buf_mode = LV_PORT_DISP_BUF_PSRAM_FULL;
+        disp_get_bufs(s_buf_mode, &buf1, &buf2, &buf_pixels);
+    }
+    lv_disp_draw_buf_init(&draw_buf_dsc, buf1, buf2, buf_pixels);
 
     /*-----------------------------------
      * Register the display in LVGL
      *----------------------------------*/
-    static lv_disp_drv_t disp_drv; /*Descriptor of a display driver*/
-    lv_disp_drv_init(&disp_drv);   /*Basic initialization*/
+    lv_disp_drv_init(&disp_drv); /*Basic initialization*/
 
     /*Set up the functions to access to your display*/
     disp_drv.hor_res = MY_DISP_HOR_RES;
     disp_drv.ver_res = MY_DISP_VER_RES;
     disp_drv.flush_cb = disp_flush;
     disp_drv.draw_buf = &draw_buf_dsc;
+    disp_drv.direct_mode = s_buf_mode == LV_PORT_DISP_BUF_PSRAM_DIRECT;
+#if !USE_ESP_LCD_DRIVER
+    s_flush_done_sem = xSemaphoreCreateBinary();
+    if (s_flush_done_sem != NULL) {
+        disp_drv.wait_cb = disp_wait;
+    }
+#endif
 
     /*Finally register the driver*/
-    lv_disp_drv_register(&disp_drv);
+    s_disp = lv_disp_drv_register(&disp_drv);
 
-    ESP_LOGI(TAG, "Display port initialized successfully (buf lines=%d)", (int)lines);
+    ESP_LOGI(TAG, "Display port initialized successfully (buf=%s, lines=%d)", lv_port_disp_buf_mode_name(s_buf_mode),
+             (int)(buf_pixels / MY_DISP_HOR_RES));
+}
+
+esp_err_t lv_port_disp_set_buf_mode(lv_port_disp_buf_mode_t mode) {
+    if (mode >= LV_PORT_DISP_BUF_MODE_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_disp == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (mode == s_buf_mode) {
+        return ESP_OK;
+    }
+
+    lv_color_t* buf1 = NULL;
+    lv_color_t* buf2 = NULL;
+    uint32_t buf_pixels = 0;
+    esp_err_t ret = disp_get_bufs(mode, &buf1, &buf2, &buf_pixels);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "No memory for %s buffers", lv_port_disp_buf_mode_name(mode));
+        return ret;
+    }
+
+    // 旧缓冲可能还在发送，等发送结束再换
+    lv_port_disp_wait_idle();
+    lv_disp_draw_buf_init(&draw_buf_dsc, buf1, buf2, buf_pixels);
+    disp_drv.direct_mode = mode == LV_PORT_DISP_BUF_PSRAM_DIRECT;
+    lv_disp_drv_update(s_disp, &disp_drv);
+    // 新缓冲内容未知 (direct_mode 下会整块保留)，整屏重绘一次
+    lv_obj_invalidate(lv_disp_get_scr_act(s_disp));
+    s_buf_mode = mode;
+
+    ESP_LOGI(TAG, "Draw buffer switched to %s (lines=%d)", lv_port_disp_buf_mode_name(mode),
+             (int)(buf_pixels / MY_DISP_HOR_RES));
+    return ESP_OK;
+}
+
+lv_port_disp_buf_mode_t lv_port_disp_get_buf_mode(void) { return s_buf_mode; }
+
+const char* lv_port_disp_buf_mode_name(lv_port_disp_buf_mode_t mode) {
+    switch (mode) {
+    case LV_PORT_DISP_BUF_SRAM_STRIPES:
+        return "SRAM stripes";
+    case LV_PORT_DISP_BUF_PSRAM_FULL:
+        return "PSRAM full";
+    case LV_PORT_DISP_BUF_PSRAM_DIRECT:
+        return "PSRAM direct";
+    default:
+        return "unknown";
+    }
+}
+
+void lv_port_disp_wait_idle(void) {
+    while (draw_buf_dsc.flushing) {
+        if (disp_drv.wait_cb != NULL) {
+            disp_drv.wait_cb(&disp_drv);
+        } else {
+            vTaskDelay(1);
+        }
+    }
 }
 
 void disp_enable_update(void) { disp_flush_enabled = true; }
 
 void disp_disable_update(void) { disp_flush_enabled = false; }
 
+void lv_port_disp_get_stats(lv_port_disp_stats_t* stats) {
+    if (stats != NULL) {
+        *stats = s_stats;
+    }
+}
+
 /**********************
  *   STATIC FUNCTIONS
  **********************/
@@ -115,12 +221,148 @@ static void disp_init(void) {
 #endif
 }
 
+/*取某策略的缓冲，没有则分配*/
+static lv_color_t* disp_buf_get(lv_color_t** slot, uint32_t pixels, uint32_t caps) {
+    if (*slot == NULL) {
+        *slot = (lv_color_t*)heap_caps_malloc(pixels * sizeof(lv_color_t), caps);
+    }
+    return *slot;
+}
+
+static esp_err_t disp_get_bufs(lv_port_disp_buf_mode_t mode, lv_color_t** buf1, lv_color_t** buf2, uint32_t* pixels) {
+    const uint32_t stripe_caps = MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL;
+    const uint32_t full_caps = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+
+    switch (mode) {
+    case LV_PORT_DISP_BUF_SRAM_STRIPES:
+        *pixels = MY_DISP_HOR_RES * DISP_STRIPE_LINES;
+        *buf1 = disp_buf_get(&s_stripe_buf[0], *pixels, stripe_caps);
+        *buf2 = disp_buf_get(&s_stripe_buf[1], *pixels, stripe_caps);
+        break;
+    case LV_PORT_DISP_BUF_PSRAM_FULL:
+        *pixels = MY_DISP_HOR_RES * MY_DISP_VER_RES;
+        *buf1 = disp_buf_get(&s_full_buf[0], *pixels, full_caps);
+        *buf2 = disp_buf_get(&s_full_buf[1], *pixels, full_caps);
+        break;
+    case LV_PORT_DISP_BUF_PSRAM_DIRECT:
+        // 单缓冲: 双缓冲的 direct_mode 需要每帧把脏区同步到另一块，PSRAM上得不偿失
+        *pixels = MY_DISP_HOR_RES * MY_DISP_VER_RES;
+        *buf1 = disp_buf_get(&s_full_buf[0], *pixels, full_caps);
+        *buf2 = NULL;
+        return *buf1 != NULL ? ESP_OK : ESP_ERR_NO_MEM;
+    default:
+        return ESP_ERR_INVALID_ARG;
+    }
+    return (*buf1 != NULL && *buf2 != NULL) ? ESP_OK : ESP_ERR_NO_MEM;
+}
+
+#if USE_ESP_LCD_DRIVER
+/*direct_mode: 本帧所有脏区合并成整行范围，整行在缓冲中连续，一个窗口一次发完*/
+static bool disp_direct_rows(lv_area_t* rows) {
+    lv_disp_t* disp = _lv_refr_get_disp_refreshing();
+    lv_coord_t y1 = MY_DISP_VER_RES;
+    lv_coord_t y2 = -1;
+    for (uint16_t i = 0; disp != NULL && i < disp->inv_p; i++) {
+        if (disp->inv_area_joined[i]) {
+            continue;
+        }
+        y1 = LV_MIN(y1, disp->inv_areas[i].y1);
+        y2 = LV_MAX(y2, disp->inv_areas[i].y2);
+    }
+    if (y2 < y1) {
+        return false;
+    }
+    rows->x1 = 0;
+    rows->x2 = MY_DISP_HOR_RES - 1;
+    rows->y1 = y1;
+    rows->y2 = y2;
+    return true;
+}
+#else
+/*direct_mode: 取本帧未被合并掉的脏区，由驱动按代价模型决定合并还是分窗口发送*/
+static size_t disp_direct_rects(st7789_rect_t* rects) {
+    lv_disp_t* disp = _lv_refr_get_disp_refreshing();
+    size_t count = 0;
+    for (uint16_t i = 0; disp != NULL && i < disp->inv_p && count < ST7789_DIRTY_MAX_RECTS; i++) {
+        if (disp->inv_area_joined[i]) {
+            continue;
+        }
+        rects[count].x1 = disp->inv_areas[i].x1;
+        rects[count].y1 = disp->inv_areas[i].y1;
+        rects[count].x2 = disp->inv_areas[i].x2;
+        rects[count].y2 = disp->inv_areas[i].y2;
+        count++;
+    }
+    return count;
+}
+#endif
+
 volatile bool disp_flush_ready = false;
 
+#if !USE_ESP_LCD_DRIVER
+/*最后一个SPI事务完成 (SPI中断中调用)*/
+static void IRAM_ATTR disp_flush_done(void* arg) {
+    SYS_TRACE_INSTANT("disp_flush_done");
+    lv_disp_flush_ready((lv_disp_drv_t*)arg);
+    if (s_flush_done_sem == NULL) {
+        return;
+    }
+    if (xPortInIsrContext()) {
+        BaseType_t woken = pdFALSE;
+        xSemaphoreGiveFromISR(s_flush_done_sem, &woken);
+        if (woken) {
+            portYIELD_FROM_ISR();
+        }
+    } else {
+        xSemaphoreGive(s_flush_done_sem);
+    }
+}
+
+/*LVGL需要等待上一块发送结束时调用 (循环直到 flushing 清零)*/
+static void disp_wait(lv_disp_drv_t* disp_drv) {
+    const int64_t t0 = esp_timer_get_time();
+    SYS_TRACE_BEGIN("disp_wait");
+    xSemaphoreTake(s_flush_done_sem, pdMS_TO_TICKS(10));
+    SYS_TRACE_END("disp_wait");
+    s_stats.wait_us += esp_timer_get_time() - t0;
+}
+#endif
+
 /*Flush the content of the internal buffer the specific area on the display
  *You can use DMA or any hardware acceleration to do this operation in the background but
  *'lv_disp_flush_ready()' has to be called when finished.*/
 static void disp_flush(lv_disp_drv_t* disp_drv, const lv_area_t* area, lv_color_t* color_p) {
+    s_stats.flushes++;
+    if (disp_drv->direct_mode) {
+        // 缓冲即整屏，各脏区已画在原位: 只在最后一块时统一发送
+        if (!lv_disp_flush_is_last(disp_drv) || !disp_flush_enabled) {
+            lv_disp_flush_ready(disp_drv);
+            return;
+        }
+#if USE_ESP_LCD_DRIVER
+        lv_area_t rows;
+        if (!disp_direct_rows(&rows)) {
+            lv_disp_flush_ready(disp_drv);
+            return;
+        }
+        color_p += (size_t)rows.y1 * MY_DISP_HOR_RES;
+        area = &rows;
+#else
+        st7789_rect_t rects[ST7789_DIRTY_MAX_RECTS];
+        const size_t count = disp_direct_rects(rects);
+        const int64_t t0 = esp_timer_get_time();
+        SYS_TRACE_BEGIN("disp_flush");
+        SYS_TRACE_COUNTER("disp_rects", count);
+        esp_err_t ret = count ? st7789_flush_rects((const uint16_t*)color_p, rects, count, disp_flush_done, disp_drv)
+                              : ESP_ERR_INVALID_ARG;
+        SYS_TRACE_END("disp_flush");
+        s_stats.flush_call_us += esp_timer_get_time() - t0;
+        if (ret != ESP_OK) {
+            lv_disp_flush_ready(disp_drv);
+        }
+        return;
+#endif
+    }
     if (disp_flush_enabled) {
 #if USE_ESP_LCD_DRIVER
         // ESP-LCD驱动实现
@@ -151,10 +393,18 @@ static void disp_flush(lv_disp_drv_t* disp_drv, const lv_area_t* area, lv_color_
             ESP_LOGE(TAG, "Panel handle is NULL");
         }
 #else
-        // 原始驱动实现
+        // 原始驱动实现: 排队后立即返回，LVGL随即渲染下一块到另一个缓冲，
+        // 最后一个SPI事务完成时在中断中调用 lv_disp_flush_ready
+        const int64_t t0 = esp_timer_get_time();
+        SYS_TRACE_BEGIN("disp_flush");
         st7789_set_window(area->x1, area->y1, area->x2, area->y2);
         size_t pixel_count = lv_area_get_size(area);
-        st7789_write_pixels((uint16_t*)color_p, pixel_count);
+        esp_err_t ret = st7789_write_pixels_async((const uint16_t*)color_p, pixel_count, disp_flush_done, disp_drv);
+        SYS_TRACE_END("disp_flush");
+        s_stats.flush_call_us += esp_timer_get_time() - t0;
+        if (ret == ESP_OK) {
+            return;
+        }
 #endif
     }
 
@@ -13,6 +13,7 @@ extern "C" {
 /*********************
  *      INCLUDES
  *********************/
+#include "esp_err.h"
 #include "lvgl.h"
 
 /*********************
@@ -22,6 +23,19 @@ extern "C" {
 /**********************
  *      TYPEDEFS
  **********************/
+/* 绘制缓冲策略 */
+typedef enum {
+    LV_PORT_DISP_BUF_SRAM_STRIPES = 0, /* 两条内部SRAM条带 (约1/10屏)，DMA直接发送，不经中转复制 */
+    LV_PORT_DISP_BUF_PSRAM_FULL,       /* 两块PSRAM整屏缓冲 (原方案)，发送时经内部中转缓冲复制 */
+    LV_PORT_DISP_BUF_PSRAM_DIRECT,     /* 一块PSRAM整屏缓冲，direct_mode 按屏幕绝对坐标渲染 */
+    LV_PORT_DISP_BUF_MODE_MAX,
+} lv_port_disp_buf_mode_t;
+
+typedef struct {
+    uint32_t flushes;       /* flush_cb 调用次数 */
+    uint64_t flush_call_us; /* flush_cb 内累计耗时 (异步后只含设置窗口与排队) */
+    uint64_t wait_us;       /* LVGL 等待上一块发送结束的累计时间 */
+} lv_port_disp_stats_t;
 
 /**********************
  * GLOBAL PROTOTYPES
@@ -35,6 +49,21 @@ void disp_enable_update(void);
 /* Disable updating the screen (the flushing process) when disp_flush() is called by LVGL */
 void disp_disable_update(void);
 
+/* Switch the draw buffer strategy at runtime (LVGL task only; buffers are allocated on first use and kept) */
+esp_err_t lv_port_disp_set_buf_mode(lv_port_disp_buf_mode_t mode);
+
+/* Get the active draw buffer strategy */
+lv_port_disp_buf_mode_t lv_port_disp_get_buf_mode(void);
+
+/* Name of a draw buffer strategy, for logs */
+const char* lv_port_disp_buf_mode_name(lv_port_disp_buf_mode_t mode);
+
+/* Block until the last flushed area has been sent to the panel (LVGL task only) */
+void lv_port_disp_wait_idle(void);
+
+/* Get flush timing counters (SPI transfer side: st7789_get_async_stats) */
+void lv_port_disp_get_stats(lv_port_disp_stats_t* stats);
+
 /**********************
  *      MACROS
  **********************/
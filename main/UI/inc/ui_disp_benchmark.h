@@ -0,0 +1,30 @@
+/**
+ * @file ui_disp_benchmark.h
+ * @brief 显示基准测试页面 - 比较各绘制缓冲策略的渲染+刷屏耗时
+ */
+
+#ifndef UI_DISP_BENCHMARK_H
+#define UI_DISP_BENCHMARK_H
+
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 创建显示基准测试界面
+ * @param parent 父容器
+ */
+void ui_disp_benchmark_create(lv_obj_t* parent);
+
+/**
+ * @brief 销毁显示基准测试界面 (中止正在运行的测试并恢复原缓冲策略)
+ */
+void ui_disp_benchmark_destroy(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UI_DISP_BENCHMARK_H
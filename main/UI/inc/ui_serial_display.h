@@ -37,6 +37,11 @@ void ui_serial_display_add_data(const char *data, size_t len);
  */
 void ui_serial_display_add_text(const char *text);
 
+/**
+ * @brief 提交未以换行结束的最后一行 (连接关闭时调用)
+ */
+void ui_serial_display_flush(void);
+
 #ifdef __cplusplus
 }
 #endif
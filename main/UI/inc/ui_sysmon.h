@@ -0,0 +1,30 @@
+/**
+ * @file ui_sysmon.h
+ * @brief 系统监视页面 - 核负载、各类堆空闲/碎片与 CPU 占用最高的任务
+ */
+
+#ifndef UI_SYSMON_H
+#define UI_SYSMON_H
+
+#include "lvgl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief 创建系统监视界面 (采样服务未运行时启动它)
+ * @param parent 父容器
+ */
+void ui_sysmon_create(lv_obj_t* parent);
+
+/**
+ * @brief 销毁系统监视界面 (停止刷新定时器，采样服务保持运行)
+ */
+void ui_sysmon_destroy(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UI_SYSMON_H
@@ -21,6 +21,8 @@
 #include "my_font.h"
 #include "theme_manager.h"
 #include "ui.h"
+#include "ui_disp_benchmark.h"
+#include "ui_sysmon.h"
 
 static const char* TAG = "UI_CALIBRATION";
 
@@ -219,6 +221,20 @@ static void menu_btn_event_cb(lv_event_t* e) {
         g_current_state = CALIBRATION_STATE_GYROSCOPE_TEST;
         create_gyroscope_test(g_content_container);
         break;
+    case 2: { // Display Benchmark，独立页面，先释放校准界面的资源
+        lv_obj_t* screen = lv_scr_act();
+        ui_calibration_destroy();
+        lv_obj_clean(screen);
+        ui_disp_benchmark_create(screen);
+        break;
+    }
+    case 3: { // System Monitor，独立页面
+        lv_obj_t* screen = lv_scr_act();
+        ui_calibration_destroy();
+        lv_obj_clean(screen);
+        ui_sysmon_create(screen);
+        break;
+    }
     }
 }
 
@@ -252,12 +268,12 @@ static void create_main_menu(lv_obj_t* content_container) {
     }
 
     // 创建菜单按钮
-    const char* menu_items[] = {"Joystick Test", "Gyroscope Test"};
+    const char* menu_items[] = {"Joystick Test", "Gyroscope Test", "Display Benchmark", "System Monitor"};
 
-    for (int i = 0; i < 2; i++) {
+    for (int i = 0; i < 4; i++) {
         lv_obj_t* btn = lv_btn_create(content_container);
         lv_obj_set_size(btn, 200, 40);
-        lv_obj_align(btn, LV_ALIGN_CENTER, 0, 60 + i * 50);
+        lv_obj_align(btn, LV_ALIGN_CENTER, 0, i * 44);
         theme_apply_to_button(btn, true);
 
         lv_obj_t* label = lv_label_create(btn);
@@ -0,0 +1,334 @@
+/**
+ * @file ui_disp_benchmark.c
+ * @brief 显示基准测试页面 - 依次切换各绘制缓冲策略，在几个典型场景下测量每帧渲染+刷屏耗时
+ *
+ * 每帧: 修改场景 -> lv_refr_now 渲染并排队发送 -> 等最后一块发送到屏幕，三者合计为一帧耗时。
+ * 场景画在 lv_layer_top 上的全屏舞台中，运行期间挡住下面的页面和触摸。
+ */
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "lv_port_disp.h"
+#include "lv_profiler.h"
+#include "lvgl.h"
+#include <stdio.h>
+
+#include "theme_manager.h"
+#include "ui.h"
+#include "ui_disp_benchmark.h"
+
+static const char* TAG = "UI_DISP_BENCH";
+
+#define BENCH_FRAMES 60   // 每个策略/场景组合测量的帧数
+#define BENCH_TEXT_LINES 40
+#define BENCH_SPRITES 16
+#define BENCH_SPRITE_SIZE 24
+
+typedef enum {
+    BENCH_SCENE_FILL,    // 整屏换色
+    BENCH_SCENE_TEXT,    // 文本列表滚动
+    BENCH_SCENE_SPRITES, // 多个小方块移动 (大量小脏区)
+    BENCH_SCENE_MAX
+} bench_scene_t;
+
+static const char* const s_scene_names[BENCH_SCENE_MAX] = {"Fill", "Text", "Sprites"};
+
+typedef struct {
+    uint64_t total_us;
+    uint32_t max_us;
+    uint32_t frames;
+    uint32_t flushes; // flush_cb 调用次数
+} bench_result_t;
+
+// 全局变量
+static lv_obj_t* g_result_label = NULL;
+static lv_obj_t* g_start_btn = NULL;
+static lv_obj_t* g_profiler_label = NULL;
+static lv_obj_t* g_stage = NULL;
+static lv_obj_t* g_text_list = NULL;
+static lv_obj_t* g_sprites[BENCH_SPRITES] = {NULL};
+static lv_timer_t* g_bench_timer = NULL;
+
+// 运行状态
+static int s_mode = 0;
+static int s_scene = 0;
+static int s_frame = 0;
+static lv_port_disp_buf_mode_t s_saved_mode = LV_PORT_DISP_BUF_SRAM_STRIPES;
+static bool s_mode_ok[LV_PORT_DISP_BUF_MODE_MAX];
+static bench_result_t s_results[LV_PORT_DISP_BUF_MODE_MAX][BENCH_SCENE_MAX];
+
+// 等待上一帧完全送到屏幕
+static void bench_refresh(void) {
+    lv_refr_now(NULL);
+    lv_port_disp_wait_idle();
+}
+
+static void bench_scene_create(bench_scene_t scene) {
+    lv_obj_clean(g_stage);
+    g_text_list = NULL;
+    lv_obj_set_style_bg_color(g_stage, lv_color_black(), 0);
+
+    switch (scene) {
+    case BENCH_SCENE_FILL:
+        break;
+    case BENCH_SCENE_TEXT:
+        g_text_list = lv_obj_create(g_stage);
+        lv_obj_set_size(g_text_list, lv_pct(100), lv_pct(100));
+        lv_obj_set_flex_flow(g_text_list, LV_FLEX_FLOW_COLUMN);
+        lv_obj_set_scrollbar_mode(g_text_list, LV_SCROLLBAR_MODE_OFF);
+        for (int i = 0; i < BENCH_TEXT_LINES; i++) {
+            lv_obj_t* label = lv_label_create(g_text_list);
+            lv_label_set_text_fmt(label, "%02d The quick brown fox 0123456789", i);
+            lv_obj_set_style_text_font(label, &lv_font_montserrat_14, 0);
+        }
+        break;
+    case BENCH_SCENE_SPRITES:
+        for (int i = 0; i < BENCH_SPRITES; i++) {
+            g_sprites[i] = lv_obj_create(g_stage);
+            lv_obj_set_size(g_sprites[i], BENCH_SPRITE_SIZE, BENCH_SPRITE_SIZE);
+            lv_obj_set_style_radius(g_sprites[i], BENCH_SPRITE_SIZE / 4, 0);
+            lv_obj_set_style_border_width(g_sprites[i], 0, 0);
+            lv_obj_set_style_bg_color(g_sprites[i], lv_palette_main((lv_palette_t)(i % LV_PALETTE_LAST)), 0);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static void bench_scene_step(bench_scene_t scene, int frame) {
+    switch (scene) {
+    case BENCH_SCENE_FILL:
+        lv_obj_set_style_bg_color(g_stage, lv_color_hsv_to_rgb((uint16_t)((frame * 37) % 360), 80, 90), 0);
+        break;
+    case BENCH_SCENE_TEXT:
+        lv_obj_scroll_to_y(g_text_list, (frame * 7) % 400, LV_ANIM_OFF);
+        break;
+    case BENCH_SCENE_SPRITES: {
+        const lv_coord_t w = lv_obj_get_content_width(g_stage) - BENCH_SPRITE_SIZE;
+        const lv_coord_t h = lv_obj_get_content_height(g_stage) - BENCH_SPRITE_SIZE;
+        for (int i = 0; i < BENCH_SPRITES; i++) {
+            lv_obj_set_pos(g_sprites[i], (lv_coord_t)((i * 37 + frame * (3 + i % 4)) % w),
+                           (lv_coord_t)((i * 53 + frame * (2 + i % 3)) % h));
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+static void bench_show_results(void) {
+    char text[512];
+    int pos = snprintf(text, sizeof(text), "avg / max ms per frame\n");
+    for (int m = 0; m < LV_PORT_DISP_BUF_MODE_MAX && pos < (int)sizeof(text); m++) {
+        pos += snprintf(text + pos, sizeof(text) - pos, "%s:\n", lv_port_disp_buf_mode_name(m));
+        if (!s_mode_ok[m]) {
+            pos += snprintf(text + pos, sizeof(text) - pos, "  no memory\n");
+            continue;
+        }
+        for (int s = 0; s < BENCH_SCENE_MAX && pos < (int)sizeof(text); s++) {
+            const bench_result_t* r = &s_results[m][s];
+            const float avg_ms = r->frames ? (float)r->total_us / r->frames / 1000.0f : 0.0f;
+            pos += snprintf(text + pos, sizeof(text) - pos, "  %-8s %5.1f / %5.1f\n", s_scene_names[s], avg_ms,
+                            r->max_us / 1000.0f);
+            ESP_LOGI(TAG, "%-12s %-8s avg %.2f ms max %.2f ms flushes/frame %.1f", lv_port_disp_buf_mode_name(m),
+                     s_scene_names[s], avg_ms, r->max_us / 1000.0f, r->frames ? (float)r->flushes / r->frames : 0.0f);
+        }
+    }
+    if (g_result_label) {
+        lv_label_set_text(g_result_label, text);
+    }
+}
+
+static void bench_stop(void) {
+    if (g_bench_timer) {
+        lv_timer_del(g_bench_timer);
+        g_bench_timer = NULL;
+    }
+    if (g_stage) {
+        lv_obj_del(g_stage);
+        g_stage = NULL;
+        g_text_list = NULL;
+    }
+    lv_port_disp_set_buf_mode(s_saved_mode);
+    if (g_start_btn) {
+        lv_obj_clear_state(g_start_btn, LV_STATE_DISABLED);
+    }
+}
+
+// 切到第一个可用的策略，没有剩余策略时返回 false
+static bool bench_enter_mode(void) {
+    while (s_mode < LV_PORT_DISP_BUF_MODE_MAX) {
+        s_mode_ok[s_mode] = lv_port_disp_set_buf_mode(s_mode) == ESP_OK;
+        if (s_mode_ok[s_mode]) {
+            return true;
+        }
+        ESP_LOGW(TAG, "Skipping %s", lv_port_disp_buf_mode_name(s_mode));
+        s_mode++;
+    }
+    return false;
+}
+
+// 每次定时器回调测一帧，测试期间 LVGL 其它定时器照常运行
+static void bench_timer_cb(lv_timer_t* timer) {
+    if (s_frame == 0) {
+        if (s_scene == 0 && !bench_enter_mode()) {
+            bench_stop();
+            bench_show_results();
+            return;
+        }
+        // 建场景及切换策略后的整屏重绘不计入
+        bench_scene_create(s_scene);
+        bench_refresh();
+    }
+
+    lv_port_disp_stats_t before;
+    lv_port_disp_get_stats(&before);
+
+    bench_scene_step(s_scene, s_frame);
+    const int64_t t0 = esp_timer_get_time();
+    bench_refresh();
+    const uint32_t dt = (uint32_t)(esp_timer_get_time() - t0);
+
+    lv_port_disp_stats_t after;
+    lv_port_disp_get_stats(&after);
+
+    bench_result_t* r = &s_results[s_mode][s_scene];
+    r->total_us += dt;
+    r->max_us = LV_MAX(r->max_us, dt);
+    r->frames++;
+    r->flushes += after.flushes - before.flushes;
+
+    if (++s_frame < BENCH_FRAMES) {
+        return;
+    }
+    s_frame = 0;
+    if (++s_scene < BENCH_SCENE_MAX) {
+        return;
+    }
+    s_scene = 0;
+    s_mode++;
+}
+
+static void start_btn_event_cb(lv_event_t* e) {
+    if (g_bench_timer) {
+        return;
+    }
+
+    lv_memset_00(s_results, sizeof(s_results));
+    lv_memset_00(s_mode_ok, sizeof(s_mode_ok));
+    s_mode = 0;
+    s_scene = 0;
+    s_frame = 0;
+    s_saved_mode = lv_port_disp_get_buf_mode();
+
+    // 全屏舞台，同时吸收触摸
+    g_stage = lv_obj_create(lv_layer_top());
+    lv_obj_set_size(g_stage, LV_HOR_RES, LV_VER_RES);
+    lv_obj_set_pos(g_stage, 0, 0);
+    lv_obj_set_style_radius(g_stage, 0, 0);
+    lv_obj_set_style_border_width(g_stage, 0, 0);
+    lv_obj_set_style_pad_all(g_stage, 0, 0);
+    lv_obj_set_style_bg_opa(g_stage, LV_OPA_COVER, 0);
+    lv_obj_clear_flag(g_stage, LV_OBJ_FLAG_SCROLLABLE);
+
+    lv_obj_add_state(g_start_btn, LV_STATE_DISABLED);
+    lv_label_set_text(g_result_label, "Running...");
+    g_bench_timer = lv_timer_create(bench_timer_cb, 1, NULL);
+
+    ESP_LOGI(TAG, "Benchmark started (%d frames per case)", BENCH_FRAMES);
+}
+
+static void profiler_label_update(void) {
+    lv_label_set_text(g_profiler_label, lv_profiler_overlay_visible() ? "Profiler: On" : "Profiler: Off");
+}
+
+// 浮层与 CSV 数据流一起开关；关闭时把累计统计打到日志
+static void profiler_btn_event_cb(lv_event_t* e) {
+    const bool on = !lv_profiler_overlay_visible();
+    lv_profiler_set_overlay(on);
+    if (on) {
+        lv_profiler_stream_start(LV_PROFILER_STREAM_PORT);
+    } else {
+        lv_profiler_stream_stop();
+        lv_profiler_report();
+    }
+    profiler_label_update();
+}
+
+// 自定义返回按钮回调 - 返回校准和测试界面
+static void bench_back_btn_callback(lv_event_t* e) {
+    ui_disp_benchmark_destroy();
+    lv_obj_t* screen = lv_scr_act();
+    if (screen) {
+        lv_obj_clean(screen);
+        ui_calibration_create(screen);
+    }
+}
+
+// 创建显示基准测试界面
+void ui_disp_benchmark_create(lv_obj_t* parent) {
+    // 应用当前主题到屏幕
+    theme_apply_to_screen(parent);
+
+    // 1. 创建页面父级容器（统一管理整个页面）
+    lv_obj_t* page_parent_container;
+    ui_create_page_parent_container(parent, &page_parent_container);
+
+    // 2. 创建顶部栏容器（包含返回按钮和标题）
+    lv_obj_t* top_bar_container;
+    lv_obj_t* title_container;
+    ui_create_top_bar(page_parent_container, "Display Benchmark", false, &top_bar_container, &title_container, NULL);
+
+    // 替换顶部栏的返回按钮回调为自定义回调
+    lv_obj_t* back_btn = lv_obj_get_child(top_bar_container, 0); // 获取返回按钮
+    if (back_btn) {
+        lv_obj_remove_event_cb(back_btn, NULL); // 移除默认回调
+        lv_obj_add_event_cb(back_btn, bench_back_btn_callback, LV_EVENT_CLICKED, NULL);
+    }
+
+    // 3. 创建页面内容容器
+    lv_obj_t* content_container;
+    ui_create_page_content_area(page_parent_container, &content_container);
+
+    // 4. 结果和开始按钮
+    g_result_label = lv_label_create(content_container);
+    lv_label_set_text_fmt(g_result_label, "Draw buffer: %s\n%d frames x %d scenes\nper strategy",
+                          lv_port_disp_buf_mode_name(lv_port_disp_get_buf_mode()), BENCH_FRAMES, BENCH_SCENE_MAX);
+    theme_apply_to_label(g_result_label, false);
+    lv_obj_set_style_text_font(g_result_label, &lv_font_montserrat_12, 0);
+    lv_obj_align(g_result_label, LV_ALIGN_TOP_LEFT, 4, 4);
+
+    g_start_btn = lv_btn_create(content_container);
+    lv_obj_set_size(g_start_btn, 200, 40);
+    lv_obj_align(g_start_btn, LV_ALIGN_BOTTOM_MID, 0, -10);
+    theme_apply_to_button(g_start_btn, true);
+    lv_obj_add_event_cb(g_start_btn, start_btn_event_cb, LV_EVENT_CLICKED, NULL);
+
+    lv_obj_t* label = lv_label_create(g_start_btn);
+    lv_label_set_text(label, "Start Benchmark");
+    lv_obj_center(label);
+
+    lv_obj_t* profiler_btn = lv_btn_create(content_container);
+    lv_obj_set_size(profiler_btn, 200, 40);
+    lv_obj_align(profiler_btn, LV_ALIGN_BOTTOM_MID, 0, -60);
+    theme_apply_to_button(profiler_btn, false);
+    lv_obj_add_event_cb(profiler_btn, profiler_btn_event_cb, LV_EVENT_CLICKED, NULL);
+
+    g_profiler_label = lv_label_create(profiler_btn);
+    lv_obj_center(g_profiler_label);
+    profiler_label_update();
+
+    ESP_LOGI(TAG, "Display benchmark UI created");
+}
+
+// 销毁显示基准测试界面
+void ui_disp_benchmark_destroy(void) {
+    if (g_bench_timer) {
+        bench_stop();
+        ESP_LOGI(TAG, "Benchmark aborted");
+    }
+    g_result_label = NULL;
+    g_start_btn = NULL;
+    g_profiler_label = NULL;
+}
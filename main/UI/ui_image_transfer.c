@@ -21,6 +21,7 @@
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
 #include "freertos/semphr.h"
+#include "sys_trace.h"
 
 #include <string.h>
 #include <stdio.h>
@@ -435,10 +436,12 @@ static void image_render_timer_callback(lv_timer_t* timer) {
             int copy_height = (frame_height < s_canvas_height) ? frame_height : s_canvas_height;
             
             // 直接复制RGB565数据，因为LVGL也使用RGB565格式
+            SYS_TRACE_BEGIN("image_blit");
             for (int y = 0; y < copy_height; y++) {
                 size_t line_bytes = (size_t)copy_width * sizeof(lv_color_t);
                 memcpy(&dst_ptr[y * s_canvas_width], &src_ptr[y * frame_width], line_bytes);
             }
+            SYS_TRACE_END("image_blit");
             lv_obj_invalidate(s_canvas);
             // 移除强制刷新，让LVGL自然调度刷新以提高性能
             s_is_rendering = false;
@@ -3,11 +3,18 @@
  * @brief 串口显示界面 - 支持接收数据、自动换行、时间戳显示
  * @author Your Name
  * @date 2024
+ *
+ * 高吞吐设计:
+ *  - TCP 接收任务把每个数据块一次性切行写入无锁行环形缓冲 (serial_line_ring)，不经过队列和中间任务；
+ *  - LVGL 定时器以屏幕刷新周期取出新行追加到历史，积压超过历史容量时直接跳过最旧的行；
+ *  - 只为可见行创建标签 (虚拟列表)，从最新一行自底向上排布，每次刷新只重设可见的十几行，
+ *    与历史总长度无关；
+ *  - 手指拖动按行滚动查看历史，离开底部时新行不会把内容顶走，拖回底部恢复跟随。
  */
 #include "esp_heap_caps.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
-#include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "freertos/task.h"
 #include "lvgl.h"
 #include <stdio.h>
@@ -17,6 +24,7 @@
 
 #include "my_font.h"
 #include "serial_display.h"
+#include "serial_line_ring.h"
 #include "ui.h"
 
 
@@ -44,35 +52,42 @@ static const ui_serial_display_text_t* get_current_serial_display_text(void) {
 static const char* TAG = "UI_SERIAL_DISPLAY";
 
 // 最大保存行数
-#define MAX_DISPLAY_LINES 128
-#define MAX_LINE_LENGTH 256  // 增加长度以避免截断
-#define DISPLAY_QUEUE_LEN 16
-
-// 消息类型
-typedef struct {
-    char line[MAX_LINE_LENGTH - 20];  // 为时间戳预留空间
-    time_t timestamp;
-} display_msg_t;
+#define MAX_DISPLAY_LINES 512
+#define MAX_LINE_LENGTH (SERIAL_LINE_RING_LINE_MAX + 1)
+#define LINE_RING_SIZE (256 * 1024) // 1MB/s 时可容纳约 250ms 的积压
+#define VIEW_WIDTH 240
+#define VIEW_HEIGHT 290
+#define MAX_VIEW_ROWS 32
+#define STATUS_UPDATE_MS 1000
 
 // 全局变量
 static lv_obj_t* g_serial_display_screen = NULL;
-static lv_obj_t* g_label = NULL;
+static lv_obj_t* g_view = NULL;
+static lv_obj_t* g_rows[MAX_VIEW_ROWS];
+static int g_row_count = 0;
+static lv_coord_t g_line_height = 16;
 static lv_obj_t* g_status_label = NULL;
 static lv_obj_t* g_back_btn = NULL;
 static lv_obj_t* g_clear_btn = NULL;
 
-// 循环缓冲区 - 使用PSRAM动态分配
+// 历史行循环缓冲区 - 使用PSRAM动态分配，仅LVGL线程访问
 static char (*display_buffer)[MAX_LINE_LENGTH] = NULL;
 static int display_start = 0;
 static int display_count = 0;
-static volatile bool g_ui_needs_update = false;
+static int g_scroll_lines = 0;   // 距最新一行的偏移，0 为跟随最新
+static lv_coord_t g_drag_acc = 0;
+static bool g_view_dirty = false;
 static lv_timer_t* g_ui_update_timer = NULL;
+static uint32_t g_last_status_ms = 0;
 static bool g_buffer_initialized = false;
 
-// 消息队列
-static QueueHandle_t g_display_queue = NULL;
-static TaskHandle_t g_display_task_handle = NULL;
-static bool g_display_running = false;
+// 接收行环形缓冲: TCP接收任务写入，LVGL定时器读取
+static serial_line_ring_t g_line_ring;
+static void* g_line_ring_buf = NULL;
+static SemaphoreHandle_t g_ingest_mutex = NULL; // 仅在多个生产者之间互斥，LVGL侧从不获取
+static volatile bool g_display_running = false;
+static time_t g_prefix_time = (time_t)-1;
+static char g_prefix[16];
 
 // 初始化PSRAM缓冲区
 static esp_err_t init_display_buffer(void) {
@@ -83,21 +98,27 @@ static esp_err_t init_display_buffer(void) {
     // 分配PSRAM内存
     display_buffer = (char (*)[MAX_LINE_LENGTH])heap_caps_malloc(
         MAX_DISPLAY_LINES * MAX_LINE_LENGTH, MALLOC_CAP_SPIRAM);
-    
-    if (display_buffer == NULL) {
-        ESP_LOGE(TAG, "Failed to allocate PSRAM buffer for display lines: %d bytes", 
-                 MAX_DISPLAY_LINES * MAX_LINE_LENGTH);
+    g_line_ring_buf = heap_caps_malloc(LINE_RING_SIZE, MALLOC_CAP_SPIRAM);
+
+    if (display_buffer == NULL || g_line_ring_buf == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate PSRAM buffer for display lines: %d + %d bytes",
+                 MAX_DISPLAY_LINES * MAX_LINE_LENGTH, LINE_RING_SIZE);
+        heap_caps_free(display_buffer);
+        heap_caps_free(g_line_ring_buf);
+        display_buffer = NULL;
+        g_line_ring_buf = NULL;
         return ESP_ERR_NO_MEM;
     }
 
-    // 初始化缓冲区
-    memset(display_buffer, 0, MAX_DISPLAY_LINES * MAX_LINE_LENGTH);
+    serial_line_ring_init(&g_line_ring, g_line_ring_buf, LINE_RING_SIZE);
     display_start = 0;
     display_count = 0;
+    g_scroll_lines = 0;
+    g_prefix_time = (time_t)-1;
     g_buffer_initialized = true;
 
-    ESP_LOGI(TAG, "PSRAM display buffer initialized: %d lines, %d bytes", 
-             MAX_DISPLAY_LINES, MAX_DISPLAY_LINES * MAX_LINE_LENGTH);
+    ESP_LOGI(TAG, "PSRAM display buffer initialized: %d lines, %d + %d bytes",
+             MAX_DISPLAY_LINES, MAX_DISPLAY_LINES * MAX_LINE_LENGTH, LINE_RING_SIZE);
     return ESP_OK;
 }
 
@@ -107,168 +128,174 @@ static void cleanup_display_buffer(void) {
         heap_caps_free(display_buffer);
         display_buffer = NULL;
     }
+    if (g_line_ring_buf != NULL) {
+        heap_caps_free(g_line_ring_buf);
+        g_line_ring_buf = NULL;
+    }
+    memset(&g_line_ring, 0, sizeof(g_line_ring));
     g_buffer_initialized = false;
     display_start = 0;
     display_count = 0;
 }
 
-// 添加新行到循环缓冲区
-static void add_line(const char* line) {
-    if (!g_buffer_initialized || display_buffer == NULL) {
-        ESP_LOGE(TAG, "Display buffer not initialized");
-        return;
-    }
+// 历史中第 i 行 (0 为最旧)
+static const char* history_line(int i) {
+    return display_buffer[(display_start + i) % MAX_DISPLAY_LINES];
+}
 
+// 添加新行到循环缓冲区
+static void add_line(const char* line, uint16_t len) {
     int idx = (display_start + display_count) % MAX_DISPLAY_LINES;
-    strncpy(display_buffer[idx], line, MAX_LINE_LENGTH - 1);
-    display_buffer[idx][MAX_LINE_LENGTH - 1] = '\0';
+    memcpy(display_buffer[idx], line, len);
+    display_buffer[idx][len] = '\0';
 
     if (display_count < MAX_DISPLAY_LINES) {
         display_count++;
     } else {
         display_start = (display_start + 1) % MAX_DISPLAY_LINES;
     }
-
-    g_ui_needs_update = true;
 }
 
-// 清空显示
+// 清空显示 (丢弃已接收未显示的行)
 static void clear_display(void) {
-    if (!g_buffer_initialized || display_buffer == NULL) {
+    if (!g_buffer_initialized) {
         return;
     }
-    
+
+    serial_line_ring_skip(&g_line_ring, serial_line_ring_pending(&g_line_ring));
     display_start = 0;
     display_count = 0;
-    memset(display_buffer, 0, MAX_DISPLAY_LINES * MAX_LINE_LENGTH);
-    g_ui_needs_update = true;
+    g_scroll_lines = 0;
+    g_view_dirty = true;
 }
 
-// UI更新定时器回调
+// 从最新可见行开始自底向上排布可见行
+static void layout_rows(void) {
+    const lv_font_t* font = get_current_font();
+    lv_coord_t y = VIEW_HEIGHT;
+    int row = 0;
+
+    if (display_count == 0 && g_row_count > 0) {
+        lv_label_set_text_static(g_rows[0], get_current_serial_display_text()->wait_text);
+        lv_obj_set_y(g_rows[0], 0);
+        lv_obj_clear_flag(g_rows[0], LV_OBJ_FLAG_HIDDEN);
+        row = 1;
+    }
+
+    for (int i = display_count - 1 - g_scroll_lines; i >= 0 && row < g_row_count && y > 0; i--, row++) {
+        const char* line = history_line(i);
+        lv_point_t size;
+        lv_txt_get_size(&size, line, font, 0, 0, VIEW_WIDTH, LV_TEXT_FLAG_NONE);
+        y -= size.y;
+        // 历史行在下次取新行前不会被覆盖，且取新行后总会重新排布
+        lv_label_set_text_static(g_rows[row], line);
+        lv_obj_set_y(g_rows[row], y);
+        lv_obj_clear_flag(g_rows[row], LV_OBJ_FLAG_HIDDEN);
+    }
+
+    for (; row < g_row_count; row++) {
+        lv_obj_add_flag(g_rows[row], LV_OBJ_FLAG_HIDDEN);
+    }
+}
+
+// UI更新定时器回调 - 以屏幕刷新周期合并更新
 static void ui_update_timer_cb(lv_timer_t* timer) {
-    if (!g_ui_needs_update || g_label == NULL || !g_buffer_initialized || display_buffer == NULL) {
+    if (!g_buffer_initialized || g_view == NULL) {
         return;
     }
-    g_ui_needs_update = false;
 
     // 检查LVGL对象是否有效
-    if (!lv_obj_is_valid(g_label)) {
-        ESP_LOGW(TAG, "Label object is not valid");
+    if (!lv_obj_is_valid(g_view)) {
+        ESP_LOGW(TAG, "View object is not valid");
         return;
     }
 
-    // 使用PSRAM分配临时缓冲区
-    static char* buf = NULL;
-    if (buf == NULL) {
-        buf = (char*)heap_caps_malloc(MAX_DISPLAY_LINES * MAX_LINE_LENGTH, MALLOC_CAP_SPIRAM);
-        if (buf == NULL) {
-            ESP_LOGE(TAG, "Failed to allocate PSRAM buffer for UI update");
-            return;
-        }
+    // 积压超过历史容量的部分反正会被挤出，只跳过记录不复制
+    uint32_t pending = serial_line_ring_pending(&g_line_ring);
+    if (pending > MAX_DISPLAY_LINES) {
+        serial_line_ring_skip(&g_line_ring, pending - MAX_DISPLAY_LINES);
+        pending = MAX_DISPLAY_LINES;
     }
 
-    char* p = buf;
-    int rem = MAX_DISPLAY_LINES * MAX_LINE_LENGTH;
+    uint32_t appended = 0;
+    const char* line;
+    uint16_t len;
+    while (appended < pending && (line = serial_line_ring_peek(&g_line_ring, &len)) != NULL) {
+        add_line(line, len);
+        serial_line_ring_pop(&g_line_ring);
+        appended++;
+    }
 
-    for (int i = 0; i < display_count; i++) {
-        int idx = (display_start + i) % MAX_DISPLAY_LINES;
-        int n = snprintf(p, rem, "%s\n", display_buffer[idx]);
-        if (n < 0 || n >= rem) break;
-        p += n;
-        rem -= n;
+    if (appended > 0) {
+        if (g_scroll_lines > 0) {
+            // 查看历史时保持当前内容不动
+            g_scroll_lines += appended;
+            if (g_scroll_lines > display_count - 1) {
+                g_scroll_lines = display_count - 1;
+            }
+        }
+        g_view_dirty = true;
     }
 
-    lv_label_set_text_static(g_label, buf);
-    lv_obj_scroll_to_y(g_label, LV_COORD_MAX, LV_ANIM_OFF);
+    if (g_view_dirty) {
+        g_view_dirty = false;
+        layout_rows();
+    }
 
     // 更新状态信息
-    if (g_status_label && lv_obj_is_valid(g_status_label)) {
+    uint32_t now = lv_tick_get();
+    if (g_status_label && lv_obj_is_valid(g_status_label) && now - g_last_status_ms >= STATUS_UPDATE_MS) {
+        g_last_status_ms = now;
         char status_text[128];
         bool tcp_running = serial_display_is_running();
-        snprintf(status_text, sizeof(status_text), "TCP:8080 %s | Lines: %d/%d", 
-                tcp_running ? "ON" : "OFF", display_count, MAX_DISPLAY_LINES);
+        snprintf(status_text, sizeof(status_text), "TCP:8080 %s | Lines: %d/%d | Drop: %u",
+                 tcp_running ? "ON" : "OFF", display_count, MAX_DISPLAY_LINES,
+                 (unsigned)atomic_load_explicit(&g_line_ring.dropped, memory_order_relaxed));
         lv_label_set_text(g_status_label, status_text);
     }
 }
 
-// 显示任务 - 处理消息队列
-static void display_task(void* pvParameters) {
-    display_msg_t msg;
-    TickType_t last_status_update = 0;
-    const TickType_t status_update_interval = pdMS_TO_TICKS(2000); // 每2秒更新一次状态
-
-    ESP_LOGI(TAG, "Display task started");
-
-    while (g_display_running && g_display_queue) {
-        // 等待消息，超时时间为100ms
-        if (xQueueReceive(g_display_queue, &msg, pdMS_TO_TICKS(100)) == pdTRUE) {
-            // 处理队列中所有剩余消息
-            do {
-                char line_with_ts[MAX_LINE_LENGTH];
-                struct tm* tinfo = localtime(&msg.timestamp);
-                if (tinfo) {
-                    snprintf(line_with_ts, sizeof(line_with_ts), "[%02d:%02d:%02d] %.*s",
-                             tinfo->tm_hour, tinfo->tm_min, tinfo->tm_sec, 
-                             (int)(sizeof(line_with_ts) - 15), msg.line);  // 限制字符串长度
-                } else {
-                    snprintf(line_with_ts, sizeof(line_with_ts), "[--:--:--] %.*s", 
-                             (int)(sizeof(line_with_ts) - 12), msg.line);  // 限制字符串长度
-                }
-                add_line(line_with_ts);
-            } while (xQueueReceive(g_display_queue, &msg, 0) == pdTRUE);
-        }
+// 拖动按行滚动
+static void view_event_cb(lv_event_t* e) {
+    lv_event_code_t code = lv_event_get_code(e);
+    if (code == LV_EVENT_PRESSED) {
+        g_drag_acc = 0;
+        return;
+    }
 
-        // 定期检查并更新状态
-        TickType_t current_time = xTaskGetTickCount();
-        if (current_time - last_status_update >= status_update_interval) {
-            g_ui_needs_update = true;
-            last_status_update = current_time;
-        }
+    lv_indev_t* indev = lv_indev_get_act();
+    if (indev == NULL) {
+        return;
     }
+    lv_point_t vect;
+    lv_indev_get_vect(indev, &vect);
+    g_drag_acc += vect.y;
 
-    ESP_LOGI(TAG, "Display task stopped");
-    vTaskDelete(NULL);
+    int lines = g_drag_acc / g_line_height;
+    if (lines == 0) {
+        return;
+    }
+    g_drag_acc -= lines * g_line_height;
+
+    // 向下拖动查看更早的行
+    int scroll = g_scroll_lines + lines;
+    if (scroll > display_count - 1) {
+        scroll = display_count - 1;
+    }
+    if (scroll < 0) {
+        scroll = 0;
+    }
+    if (scroll != g_scroll_lines) {
+        g_scroll_lines = scroll;
+        g_view_dirty = true;
+    }
 }
 
 // 按钮事件回调
 static void back_btn_event_cb(lv_event_t* e) {
     lv_obj_t* screen = lv_scr_act();
     if (screen) {
-        // 先停止显示任务
-        g_display_running = false;
-        if (g_display_task_handle) {
-            // 等待任务结束
-            vTaskDelay(pdMS_TO_TICKS(300));
-            // 检查任务是否还在运行
-            if (eTaskGetState(g_display_task_handle) != eDeleted) {
-                vTaskDelete(g_display_task_handle);
-            }
-            g_display_task_handle = NULL;
-        }
-
-        // 删除消息队列
-        if (g_display_queue) {
-            vQueueDelete(g_display_queue);
-            g_display_queue = NULL;
-        }
-
-        // 删除UI更新定时器
-        if (g_ui_update_timer) {
-            lv_timer_del(g_ui_update_timer);
-            g_ui_update_timer = NULL;
-        }
-
-        // 清理PSRAM缓冲区
-        cleanup_display_buffer();
-
-        g_serial_display_screen = NULL;
-        g_label = NULL;
-        g_status_label = NULL;
-        g_back_btn = NULL;
-        g_clear_btn = NULL;
-
-        // 停止TCP服务器 - 移到最后执行
-        serial_display_stop();
+        ui_serial_display_destroy();
         ESP_LOGI(TAG, "Serial display TCP server stopped on back button");
 
         lv_obj_clean(screen);
@@ -280,43 +307,31 @@ static void clear_btn_event_cb(lv_event_t* e) {
     clear_display();
 }
 
-// 滚动事件回调
-static void scroll_event_cb(lv_event_t* e) {
-    // 简化滚动事件处理，保持自动滚动行为
-}
-
-// 公共API：添加新数据
+// 公共API：添加新数据 (TCP接收任务调用，每个数据块一次写入)
 void ui_serial_display_add_data(const char* data, size_t len) {
-    if (!g_display_running || !data || len == 0 || !g_display_queue) {
+    if (!g_display_running || !data || len == 0 || !g_ingest_mutex) {
         return;
     }
 
-    // 处理数据，按行分割
-    char* data_copy = malloc(len + 1);
-    if (!data_copy) {
-        ESP_LOGE(TAG, "Failed to allocate memory for data copy");
+    if (xSemaphoreTake(g_ingest_mutex, portMAX_DELAY) != pdTRUE) {
         return;
     }
-
-    memcpy(data_copy, data, len);
-    data_copy[len] = '\0';
-
-    char* line = strtok(data_copy, "\n\r");
-    time_t current_time = time(NULL);
-
-    while (line) {
-        // 跳过空行
-        if (strlen(line) > 0) {
-            display_msg_t msg = {.timestamp = current_time};
-            strncpy(msg.line, line, sizeof(msg.line) - 1);
-            msg.line[sizeof(msg.line) - 1] = '\0';
-
-            xQueueSend(g_display_queue, &msg, pdMS_TO_TICKS(50));
+    if (g_display_running) {
+        // 时间戳前缀每秒格式化一次
+        time_t current_time = time(NULL);
+        if (current_time != g_prefix_time) {
+            g_prefix_time = current_time;
+            struct tm tinfo;
+            if (localtime_r(&current_time, &tinfo)) {
+                snprintf(g_prefix, sizeof(g_prefix), "[%02d:%02d:%02d] ", tinfo.tm_hour, tinfo.tm_min,
+                         tinfo.tm_sec);
+            } else {
+                snprintf(g_prefix, sizeof(g_prefix), "[--:--:--] ");
+            }
         }
-        line = strtok(NULL, "\n\r");
+        serial_line_ring_write(&g_line_ring, data, len, g_prefix);
     }
-
-    free(data_copy);
+    xSemaphoreGive(g_ingest_mutex);
 }
 
 // 公共API：添加文本
@@ -326,38 +341,61 @@ void ui_serial_display_add_text(const char* text) {
     }
 }
 
+void ui_serial_display_flush(void) {
+    if (!g_display_running || !g_ingest_mutex) {
+        return;
+    }
+    if (xSemaphoreTake(g_ingest_mutex, portMAX_DELAY) == pdTRUE) {
+        if (g_display_running) {
+            serial_line_ring_flush(&g_line_ring);
+        }
+        xSemaphoreGive(g_ingest_mutex);
+    }
+}
+
 // 创建串口显示界面
 void ui_serial_display_create(lv_obj_t* parent) {
     // 如果已经存在，先清理
-    if (g_display_running || g_display_queue || g_display_task_handle) {
+    if (g_display_running || g_buffer_initialized) {
         ESP_LOGW(TAG, "Serial display already exists, cleaning up first");
         ui_serial_display_destroy();
     }
     const ui_serial_display_text_t* text = get_current_serial_display_text();
 
+    if (g_ingest_mutex == NULL) {
+        g_ingest_mutex = xSemaphoreCreateMutex();
+        if (g_ingest_mutex == NULL) {
+            ESP_LOGE(TAG, "Failed to create ingest mutex");
+            return;
+        }
+    }
+
+    // 初始化PSRAM缓冲区 (先于TCP服务器，数据到达时缓冲区已就绪)
+    esp_err_t ret = init_display_buffer();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to initialize PSRAM display buffer");
+        return;
+    }
+
     // 初始化串口显示模块
-    esp_err_t ret = serial_display_init();
+    ret = serial_display_init();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to initialize serial display module");
+        cleanup_display_buffer();
         return;
     }
 
     // 启动TCP服务器，监听端口8080
+    g_display_running = true;
     if (!serial_display_start(8080)) {
         ESP_LOGE(TAG, "Failed to start serial display TCP server");
+        g_display_running = false;
+        cleanup_display_buffer();
         return;
     }
 
     ESP_LOGI(TAG, "Serial display TCP server started on port 8080");
 
-    // 初始化PSRAM缓冲区
-    ret = init_display_buffer();
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to initialize PSRAM display buffer");
-        serial_display_stop();
-        return;
-    }
-
     // 应用当前主题到屏幕
     theme_apply_to_screen(parent);
 
@@ -384,20 +422,35 @@ void ui_serial_display_create(lv_obj_t* parent) {
     // 3. 创建页面内容容器
     lv_obj_t* content_container;
     ui_create_page_content_area(page_parent_container, &content_container);
-
-    // 创建标签 - 直接占满整个内容区域
-    g_label = lv_label_create(content_container);
-    lv_obj_set_size(g_label, 240, 290);
-    lv_obj_align(g_label, LV_ALIGN_CENTER, 0, 10);
-    lv_label_set_long_mode(g_label, LV_LABEL_LONG_WRAP);
-    lv_label_set_text(g_label, text->wait_text);
-    lv_obj_set_style_text_color(g_label, theme_get_color(theme_get_current_theme()->colors.text_primary), 0);
-    lv_obj_set_style_bg_color(g_label, theme_get_color(theme_get_current_theme()->colors.surface), 0);
-    set_language_display(g_label);
-
-    // 添加滚动事件
-    lv_obj_add_event_cb(g_label, scroll_event_cb, LV_EVENT_SCROLL, NULL);
-
+    lv_obj_clear_flag(content_container, LV_OBJ_FLAG_SCROLLABLE); // 由视图自行按行滚动
+
+    // 4. 创建虚拟列表视图 - 占满整个内容区域，只为可见行创建标签
+    g_view = lv_obj_create(content_container);
+    lv_obj_remove_style_all(g_view);
+    lv_obj_set_size(g_view, VIEW_WIDTH, VIEW_HEIGHT);
+    lv_obj_align(g_view, LV_ALIGN_TOP_LEFT, 0, 0);
+    lv_obj_clear_flag(g_view, LV_OBJ_FLAG_SCROLLABLE);
+    lv_obj_add_flag(g_view, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_event_cb(g_view, view_event_cb, LV_EVENT_PRESSED, NULL);
+    lv_obj_add_event_cb(g_view, view_event_cb, LV_EVENT_PRESSING, NULL);
+
+    g_line_height = lv_font_get_line_height(get_current_font());
+    if (g_line_height <= 0) {
+        g_line_height = 16;
+    }
+    g_row_count = VIEW_HEIGHT / g_line_height + 1;
+    if (g_row_count > MAX_VIEW_ROWS) {
+        g_row_count = MAX_VIEW_ROWS;
+    }
+    for (int i = 0; i < g_row_count; i++) {
+        g_rows[i] = lv_label_create(g_view);
+        lv_obj_set_width(g_rows[i], VIEW_WIDTH);
+        lv_label_set_long_mode(g_rows[i], LV_LABEL_LONG_WRAP);
+        lv_obj_set_style_text_color(g_rows[i], theme_get_color(theme_get_current_theme()->colors.text_primary), 0);
+        set_language_display(g_rows[i]);
+        lv_obj_clear_flag(g_rows[i], LV_OBJ_FLAG_CLICKABLE);
+        lv_obj_add_flag(g_rows[i], LV_OBJ_FLAG_HIDDEN);
+    }
 
     // 5. 创建清空按钮 - 直接放在内容区域右下角
     g_clear_btn = lv_btn_create(content_container);
@@ -411,35 +464,18 @@ void ui_serial_display_create(lv_obj_t* parent) {
     lv_obj_center(clear_label);
 
     // 初始化数据
-    clear_display();
-
-    // 创建消息队列
-    g_display_queue = xQueueCreate(DISPLAY_QUEUE_LEN, sizeof(display_msg_t));
-    if (!g_display_queue) {
-        ESP_LOGE(TAG, "Failed to create display queue");
-        return;
-    }
+    g_view_dirty = true;
+    layout_rows();
 
-    // 创建UI更新定时器
-    g_ui_update_timer = lv_timer_create(ui_update_timer_cb, 100, NULL); // 100ms刷新率
+    // 创建UI更新定时器，与屏幕刷新周期一致
+    g_ui_update_timer = lv_timer_create(ui_update_timer_cb, LV_DISP_DEF_REFR_PERIOD, NULL);
     if (g_ui_update_timer == NULL) {
         ESP_LOGE(TAG, "Failed to create LVGL UI update timer");
         ui_serial_display_destroy(); // Clean up
         return;
     }
 
-    // 启动显示任务
-    g_display_running = true;
-    if (xTaskCreate(display_task, "ui_display_task", 4096, NULL, 3, &g_display_task_handle) != pdPASS) {
-        ESP_LOGE(TAG, "Failed to create display task");
-        g_display_running = false;
-        vQueueDelete(g_display_queue);
-        g_display_queue = NULL;
-        serial_display_stop();
-        return;
-    }
-
-    ESP_LOGI(TAG, "Serial display UI created successfully");
+    ESP_LOGI(TAG, "Serial display UI created successfully (%d rows)", g_row_count);
 }
 
 // 销毁串口显示界面
@@ -448,22 +484,17 @@ void ui_serial_display_destroy(void) {
     serial_display_stop();
     ESP_LOGI(TAG, "Serial display TCP server stopped");
 
-    // 停止显示任务
+    // 停止接收: 等正在写入的生产者退出后再释放缓冲区
     g_display_running = false;
-    if (g_display_task_handle) {
-        // 等待任务结束
-        vTaskDelay(pdMS_TO_TICKS(200));
-        // 检查任务是否还在运行
-        if (eTaskGetState(g_display_task_handle) != eDeleted) {
-            vTaskDelete(g_display_task_handle);
+    if (g_ingest_mutex) {
+        if (xSemaphoreTake(g_ingest_mutex, pdMS_TO_TICKS(500)) == pdTRUE) {
+            xSemaphoreGive(g_ingest_mutex);
+        } else {
+            // 持有者是写入中途被强制删除的TCP任务，下次创建界面时重建
+            ESP_LOGW(TAG, "Ingest mutex abandoned, recreating");
+            vSemaphoreDelete(g_ingest_mutex);
+            g_ingest_mutex = NULL;
         }
-        g_display_task_handle = NULL;
-    }
-
-    // 删除消息队列
-    if (g_display_queue) {
-        vQueueDelete(g_display_queue);
-        g_display_queue = NULL;
     }
 
     // 删除UI更新定时器
@@ -477,7 +508,8 @@ void ui_serial_display_destroy(void) {
 
     // 清空全局变量
     g_serial_display_screen = NULL;
-    g_label = NULL;
+    g_view = NULL;
+    g_row_count = 0;
     g_status_label = NULL;
     g_back_btn = NULL;
     g_clear_btn = NULL;
@@ -0,0 +1,143 @@
+/**
+ * @file ui_sysmon.c
+ * @brief 系统监视页面 - 每秒从 sys_monitor 读取最近一次采样并刷新
+ */
+#include "esp_log.h"
+#include "lvgl.h"
+#include "sys_monitor.h"
+#include <stdio.h>
+
+#include "theme_manager.h"
+#include "ui.h"
+#include "ui_sysmon.h"
+
+static const char* TAG = "UI_SYSMON";
+
+#define SYSMON_REFRESH_MS 1000
+#define SYSMON_TOP_TASKS 6 // 页面列出的任务数
+
+// 全局变量
+static lv_obj_t* g_core_bars[SYS_MONITOR_MAX_CORES] = {NULL};
+static lv_obj_t* g_core_labels[SYS_MONITOR_MAX_CORES] = {NULL};
+static lv_obj_t* g_heap_label = NULL;
+static lv_obj_t* g_task_label = NULL;
+static lv_timer_t* g_refresh_timer = NULL;
+
+static void sysmon_refresh(void) {
+    sys_monitor_sample_t sample;
+    if (!sys_monitor_get_latest(&sample)) {
+        lv_label_set_text(g_heap_label, "Waiting for first sample...");
+        return;
+    }
+
+    for (int c = 0; c < SYS_MONITOR_MAX_CORES; c++) {
+        lv_bar_set_value(g_core_bars[c], sample.core_load_x10[c], LV_ANIM_OFF);
+        lv_label_set_text_fmt(g_core_labels[c], "Core%d %3u.%u%%", c, sample.core_load_x10[c] / 10,
+                              sample.core_load_x10[c] % 10);
+    }
+
+    char text[256];
+    int pos = snprintf(text, sizeof(text), "%-8s %6s %6s %4s %4s\n", "Heap", "FreeKB", "MaxKB", "Frag", "Fail");
+    for (int i = 0; i < SYS_MONITOR_HEAP_MAX && pos < (int)sizeof(text); i++) {
+        const sys_monitor_heap_stats_t* h = &sample.heap[i];
+        pos += snprintf(text + pos, sizeof(text) - pos, "%-8s %6lu %6lu %3u%% %4lu\n",
+                        sys_monitor_heap_name((sys_monitor_heap_t)i), (unsigned long)(h->free_bytes / 1024),
+                        (unsigned long)(h->largest_block / 1024), sys_monitor_fragmentation(h),
+                        (unsigned long)h->alloc_failures);
+    }
+    lv_label_set_text(g_heap_label, text);
+
+    sys_monitor_task_t tasks[SYSMON_TOP_TASKS];
+    const size_t n = sys_monitor_get_tasks(tasks, SYSMON_TOP_TASKS);
+    pos = snprintf(text, sizeof(text), "%-12s %5s %6s  (%u tasks)\n", "Task", "CPU%", "Stack", sample.task_count);
+    for (size_t i = 0; i < n && pos < (int)sizeof(text); i++) {
+        pos += snprintf(text + pos, sizeof(text) - pos, "%-12.12s %3u.%u %6lu\n", tasks[i].name, tasks[i].cpu_x10 / 10,
+                        tasks[i].cpu_x10 % 10, (unsigned long)tasks[i].stack_hwm);
+    }
+    lv_label_set_text(g_task_label, text);
+}
+
+static void sysmon_timer_cb(lv_timer_t* timer) { sysmon_refresh(); }
+
+// 自定义返回按钮回调 - 返回校准和测试界面
+static void sysmon_back_btn_callback(lv_event_t* e) {
+    ui_sysmon_destroy();
+    lv_obj_t* screen = lv_scr_act();
+    if (screen) {
+        lv_obj_clean(screen);
+        ui_calibration_create(screen);
+    }
+}
+
+// 创建系统监视界面
+void ui_sysmon_create(lv_obj_t* parent) {
+    if (!sys_monitor_is_running()) {
+        sys_monitor_start(0);
+    }
+
+    // 应用当前主题到屏幕
+    theme_apply_to_screen(parent);
+
+    // 1. 创建页面父级容器（统一管理整个页面）
+    lv_obj_t* page_parent_container;
+    ui_create_page_parent_container(parent, &page_parent_container);
+
+    // 2. 创建顶部栏容器（包含返回按钮和标题）
+    lv_obj_t* top_bar_container;
+    lv_obj_t* title_container;
+    ui_create_top_bar(page_parent_container, "System Monitor", false, &top_bar_container, &title_container, NULL);
+
+    // 替换顶部栏的返回按钮回调为自定义回调
+    lv_obj_t* back_btn = lv_obj_get_child(top_bar_container, 0); // 获取返回按钮
+    if (back_btn) {
+        lv_obj_remove_event_cb(back_btn, NULL); // 移除默认回调
+        lv_obj_add_event_cb(back_btn, sysmon_back_btn_callback, LV_EVENT_CLICKED, NULL);
+    }
+
+    // 3. 创建页面内容容器
+    lv_obj_t* content_container;
+    ui_create_page_content_area(page_parent_container, &content_container);
+    lv_obj_set_flex_flow(content_container, LV_FLEX_FLOW_COLUMN);
+    lv_obj_set_style_pad_row(content_container, 4, 0);
+
+    // 4. 核负载条
+    for (int c = 0; c < SYS_MONITOR_MAX_CORES; c++) {
+        g_core_labels[c] = lv_label_create(content_container);
+        theme_apply_to_label(g_core_labels[c], false);
+        lv_obj_set_style_text_font(g_core_labels[c], &lv_font_montserrat_12, 0);
+        lv_label_set_text_fmt(g_core_labels[c], "Core%d", c);
+
+        g_core_bars[c] = lv_bar_create(content_container);
+        lv_obj_set_size(g_core_bars[c], lv_pct(100), 10);
+        lv_bar_set_range(g_core_bars[c], 0, 1000);
+    }
+
+    // 5. 堆与任务表
+    g_heap_label = lv_label_create(content_container);
+    theme_apply_to_label(g_heap_label, false);
+    lv_obj_set_style_text_font(g_heap_label, &lv_font_montserrat_12, 0);
+
+    g_task_label = lv_label_create(content_container);
+    theme_apply_to_label(g_task_label, false);
+    lv_obj_set_style_text_font(g_task_label, &lv_font_montserrat_12, 0);
+    lv_label_set_text(g_task_label, "");
+
+    sysmon_refresh();
+    g_refresh_timer = lv_timer_create(sysmon_timer_cb, SYSMON_REFRESH_MS, NULL);
+
+    ESP_LOGI(TAG, "System monitor UI created");
+}
+
+// 销毁系统监视界面
+void ui_sysmon_destroy(void) {
+    if (g_refresh_timer) {
+        lv_timer_del(g_refresh_timer);
+        g_refresh_timer = NULL;
+    }
+    for (int c = 0; c < SYS_MONITOR_MAX_CORES; c++) {
+        g_core_bars[c] = NULL;
+        g_core_labels[c] = NULL;
+    }
+    g_heap_label = NULL;
+    g_task_label = NULL;
+}
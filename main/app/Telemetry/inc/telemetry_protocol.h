@@ -17,8 +17,11 @@ typedef enum {
     FRAME_TYPE_SPECIAL_CMD = 0x05,
     FRAME_TYPE_IMAGE_TRANSFER = 0x06,
     FRAME_TYPE_ACK = 0x07,
+    FRAME_TYPE_SYS_STATS = 0x08,
 } frame_type_t;
 
+#define SYS_STATS_MAX_TASKS 8 // 系统状态帧携带的任务数上限 (CPU 占用最高的若干个)
+
 // 扩展命令ID
 typedef enum {
     EXT_CMD_ID_SET_PWM_FREQ = 0x10,
@@ -113,6 +116,25 @@ typedef struct {
     uint8_t response_data[];    // 响应数据
 } ack_payload_t;
 
+// 系统状态中的单个任务
+typedef struct {
+    char name[8];          // 任务名前 8 字节，不保证以 0 结尾
+    int8_t core;           // 绑定的核，-1 表示不绑定
+    uint8_t cpu_half_pct;  // CPU 占用，单位: 0.5%
+    uint16_t stack_hwm;    // 栈剩余最低值 (字节)
+} sys_stats_task_t;
+
+// 系统状态负载 (ESP32 -> 地面站)，tasks 只发送 task_count 项
+typedef struct {
+    uint32_t uptime_ms;
+    uint16_t core_load_x10[2];   // 单位: 0.1%
+    uint16_t heap_free_kb[3];    // 内部 / DMA / PSRAM
+    uint16_t heap_largest_kb[3]; // 最大连续空闲块
+    uint16_t alloc_failures[3];
+    uint8_t task_count;
+    sys_stats_task_t tasks[SYS_STATS_MAX_TASKS];
+} sys_stats_payload_t;
+
 #pragma pack(pop)
 
 // 结构体用于存放解析后的帧数据
@@ -197,6 +219,17 @@ size_t telemetry_protocol_parse_frame(const uint8_t* buffer, size_t len, parsed_
 size_t telemetry_protocol_create_telemetry_frame(uint8_t* buffer, size_t buffer_size,
                                                 const telemetry_data_payload_t* telemetry_data);
 
+/**
+ * @brief 创建系统状态帧
+ *
+ * @param buffer 用于存储编码后数据的缓冲区
+ * @param buffer_size 缓冲区大小
+ * @param stats 系统状态，只编码前 task_count 个任务
+ * @return 编码后的帧长度, 失败返回0
+ */
+size_t telemetry_protocol_create_sys_stats_frame(uint8_t* buffer, size_t buffer_size,
+                                                 const sys_stats_payload_t* stats);
+
 /**
  * @brief 创建ACK应答帧
  *
@@ -25,6 +25,7 @@
 #include <unistd.h>
 
 
+#include "metrics.h"
 #include "tcp_server_hb.h"
 #include "telemetry_protocol.h"
 
@@ -48,6 +49,18 @@ typedef struct {
 static tcp_server_hb_manager_t g_hb_server = {0};
 static bool g_hb_server_initialized = false;
 
+// 统计字段注册为指标，导出时直接读取
+static metrics_desc_t g_hb_metrics[] = {
+    METRICS_REF_INIT("hb_server_connections_total", "Heartbeat clients accepted", METRICS_TYPE_COUNTER,
+                     &g_hb_server.stats.total_connections),
+    METRICS_REF_INIT("hb_server_active_clients", "Connected heartbeat clients", METRICS_TYPE_GAUGE,
+                     &g_hb_server.stats.active_clients),
+    METRICS_REF_INIT("hb_server_heartbeats_total", "Heartbeat frames received", METRICS_TYPE_COUNTER,
+                     &g_hb_server.stats.heartbeat_received_count),
+    METRICS_REF_INIT("hb_server_heartbeat_errors_total", "Heartbeat frames failing to parse", METRICS_TYPE_COUNTER,
+                     &g_hb_server.stats.heartbeat_failed_count),
+};
+
 // ----------------- 内部函数声明 -----------------
 static bool tcp_server_hb_bind_and_listen(void);
 static void tcp_server_hb_disconnect_client(uint32_t client_index);
@@ -409,6 +422,7 @@ bool tcp_server_hb_init(const tcp_server_hb_config_t* config) {
     g_hb_server.is_running = false;
 
     g_hb_server_initialized = true;
+    metrics_register_refs(g_hb_metrics, sizeof(g_hb_metrics) / sizeof(g_hb_metrics[0]));
     ESP_LOGI(TAG, "心跳服务器初始化成功，端口: %d", g_hb_server.config.server_port);
 
     return true;
@@ -133,7 +133,9 @@ esp_err_t telemetry_data_converter_get_rc_channels(uint16_t *channels, uint8_t *
         return ESP_ERR_INVALID_ARG;
     }
     
-    if (!s_data_valid || !s_cached_data.joystick.valid) {
+    // 直接读取 ADC DMA 最新发布的摇杆值 (无锁快照)，不依赖 50Hz 的遥测缓存
+    joystick_data_t joystick_data;
+    if (joystick_adc_read(&joystick_data) != ESP_OK) {
         ESP_LOGW(TAG, "Joystick data not available");
         return ESP_ERR_INVALID_STATE;
     }
@@ -142,8 +144,8 @@ esp_err_t telemetry_data_converter_get_rc_channels(uint16_t *channels, uint8_t *
     // CH1: 油门 (摇杆Y轴)
     // CH2: 方向 (摇杆X轴)
     
-    channels[0] = convert_joystick_to_channel(s_cached_data.joystick.joy_y);  // 油门
-    channels[1] = convert_joystick_to_channel(s_cached_data.joystick.joy_x);  // 方向
+    channels[0] = convert_joystick_to_channel(joystick_data.norm_joy1_y);  // 油门
+    channels[1] = convert_joystick_to_channel(joystick_data.norm_joy1_x);  // 方向
     
     // 预留其他通道，设为中位值
     channels[2] = 500;  // 预留通道3
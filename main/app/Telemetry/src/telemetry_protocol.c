@@ -228,6 +228,30 @@ size_t telemetry_protocol_create_telemetry_frame(uint8_t* buffer, size_t buffer_
     return finalize_frame(buffer, FRAME_TYPE_TELEMETRY, (const uint8_t*)telemetry_data, payload_len);
 }
 
+/**
+ * @brief 创建系统状态帧
+ *
+ * @param buffer 帧缓冲区
+ * @param buffer_size 帧缓冲区大小
+ * @param stats 系统状态
+ * @return 整个帧的总长度
+ */
+size_t telemetry_protocol_create_sys_stats_frame(uint8_t* buffer, size_t buffer_size,
+                                                 const sys_stats_payload_t* stats) {
+    if (!buffer || !stats || stats->task_count > SYS_STATS_MAX_TASKS) {
+        return 0;
+    }
+
+    size_t payload_len = offsetof(sys_stats_payload_t, tasks) + stats->task_count * sizeof(sys_stats_task_t);
+    size_t frame_len = 2 + 1 + 1 + payload_len + 2; // Header + Len + Type + Payload + CRC
+
+    if (buffer_size < frame_len) {
+        return 0;
+    }
+
+    return finalize_frame(buffer, FRAME_TYPE_SYS_STATS, (const uint8_t*)stats, payload_len);
+}
+
 /**
  * @brief 创建ACK应答帧
  *
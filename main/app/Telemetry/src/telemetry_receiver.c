@@ -7,6 +7,7 @@
 #include "telemetry_main.h"
 #include "telemetry_protocol.h"
 #include "telemetry_sender.h"
+#include "sys_trace.h"
 #include <errno.h>
 #include <fcntl.h>
 #include <stdlib.h>
@@ -197,6 +198,7 @@ static void handle_client_connection(int client_sock) {
  * @param frame 解析后的帧
  */
 static void process_received_frame(const parsed_frame_t* frame) {
+    SYS_TRACE_INSTANT("telemetry_rx_frame");
     if (!frame->crc_ok) {
         ESP_LOGW(TAG, "Received a frame with bad CRC. Type: 0x%02X", frame->header.type);
         return;
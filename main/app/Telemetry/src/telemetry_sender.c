@@ -17,6 +17,8 @@
 #include "telemetry_data_converter.h"
 #include "telemetry_main.h"
 #include "telemetry_protocol.h"
+#include "sys_monitor.h"
+#include "sys_trace.h"
 #include <string.h>
 
 static const char* TAG = "telemetry_sender";
@@ -25,9 +27,11 @@ static const char* TAG = "telemetry_sender";
 static int g_client_sock = -1;
 static bool g_sender_active = false;
 static uint32_t g_last_data_send = 0;
+static uint32_t g_last_stats_send = 0;
 
 // 内部函数声明
 static int send_frame(const uint8_t* frame, size_t len);
+static void send_sys_stats(void);
 
 /**
  * @brief 初始化发送器
@@ -39,6 +43,7 @@ int telemetry_sender_init(void) {
     g_client_sock = -1;
     g_sender_active = false;
     g_last_data_send = 0;
+    g_last_stats_send = 0;
     return 0;
 }
 
@@ -88,7 +93,10 @@ void telemetry_sender_process(void) {
             size_t frame_len = telemetry_protocol_create_rc_frame(
                 frame_buffer, sizeof(frame_buffer), channel_count, channels);
             if (frame_len > 0) {
-                if (send_frame(frame_buffer, frame_len) > 0) {
+                SYS_TRACE_BEGIN("telemetry_tx");
+                const int sent = send_frame(frame_buffer, frame_len);
+                SYS_TRACE_END("telemetry_tx");
+                if (sent > 0) {
                     // RC帧发送完成
                 } else {
                     ESP_LOGW(TAG, "Failed to send RC frame");
@@ -101,6 +109,12 @@ void telemetry_sender_process(void) {
         }
         g_last_data_send = current_time;
     }
+
+    // 每秒发送一次系统状态 (采样服务运行时)
+    if (current_time - g_last_stats_send > pdMS_TO_TICKS(1000)) {
+        send_sys_stats();
+        g_last_stats_send = current_time;
+    }
 }
 
 void telemetry_sender_deactivate(void) {
@@ -109,6 +123,45 @@ void telemetry_sender_deactivate(void) {
     ESP_LOGI(TAG, "Telemetry sender manually deactivated");
 }
 
+/**
+ * @brief 把最近一次系统采样编码为系统状态帧并发送
+ */
+static void send_sys_stats(void) {
+    sys_monitor_sample_t sample;
+    if (!sys_monitor_get_latest(&sample)) {
+        return;
+    }
+
+    sys_stats_payload_t stats;
+    memset(&stats, 0, sizeof(stats));
+    stats.uptime_ms = sample.timestamp_ms;
+    stats.core_load_x10[0] = sample.core_load_x10[0];
+    stats.core_load_x10[1] = sample.core_load_x10[1];
+    for (int i = 0; i < SYS_MONITOR_HEAP_MAX; i++) {
+        const uint32_t free_kb = sample.heap[i].free_bytes / 1024;
+        const uint32_t largest_kb = sample.heap[i].largest_block / 1024;
+        stats.heap_free_kb[i] = free_kb > UINT16_MAX ? UINT16_MAX : (uint16_t)free_kb;
+        stats.heap_largest_kb[i] = largest_kb > UINT16_MAX ? UINT16_MAX : (uint16_t)largest_kb;
+        stats.alloc_failures[i] = sample.heap[i].alloc_failures > UINT16_MAX ? UINT16_MAX
+                                                                              : (uint16_t)sample.heap[i].alloc_failures;
+    }
+
+    sys_monitor_task_t tasks[SYS_STATS_MAX_TASKS];
+    stats.task_count = (uint8_t)sys_monitor_get_tasks(tasks, SYS_STATS_MAX_TASKS);
+    for (int i = 0; i < stats.task_count; i++) {
+        memcpy(stats.tasks[i].name, tasks[i].name, sizeof(stats.tasks[i].name));
+        stats.tasks[i].core = tasks[i].core;
+        stats.tasks[i].cpu_half_pct = (uint8_t)(tasks[i].cpu_x10 / 5);
+        stats.tasks[i].stack_hwm = tasks[i].stack_hwm > UINT16_MAX ? UINT16_MAX : (uint16_t)tasks[i].stack_hwm;
+    }
+
+    uint8_t frame_buffer[2 + 1 + 1 + sizeof(sys_stats_payload_t) + 2];
+    size_t frame_len = telemetry_protocol_create_sys_stats_frame(frame_buffer, sizeof(frame_buffer), &stats);
+    if (frame_len > 0 && send_frame(frame_buffer, frame_len) < 0) {
+        ESP_LOGW(TAG, "Failed to send system stats frame");
+    }
+}
+
 /**
  * @brief 发送帧
  *
@@ -0,0 +1,232 @@
+/**
+ * @file audio_codec.c
+ * @brief 音频流编解码实现
+ */
+
+#include "audio_codec.h"
+#include <string.h>
+
+static const int16_t s_step_table[89] = {
+    7,     8,     9,     10,    11,    12,    13,    14,    16,    17,    19,    21,    23,    25,    28,
+    31,    34,    37,    41,    45,    50,    55,    60,    66,    73,    80,    88,    97,    107,   118,
+    130,   143,   157,   173,   190,   209,   230,   253,   279,   307,   337,   371,   408,   449,   494,
+    544,   598,   658,   724,   796,   876,   963,   1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+    2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,  5894,  6484,  7132,  7845,  8630,
+    9493,  10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+};
+
+static const int8_t s_index_table4[8] = {-1, -1, -1, -1, 2, 4, 6, 8};
+static const int8_t s_index_table2[2] = {-1, 2};
+
+static inline int clamp_index(int index) {
+    return index < 0 ? 0 : (index > 88 ? 88 : index);
+}
+
+static inline int clamp_sample(int value) {
+    return value < -32768 ? -32768 : (value > 32767 ? 32767 : value);
+}
+
+// 4 位码字 -> 更新预测值与步长索引
+static inline void adpcm4_step(int* predictor, int* index, unsigned code) {
+    const int step = s_step_table[*index];
+    int diff = step >> 3;
+    if (code & 4) diff += step;
+    if (code & 2) diff += step >> 1;
+    if (code & 1) diff += step >> 2;
+    *predictor = clamp_sample((code & 8) ? *predictor - diff : *predictor + diff);
+    *index = clamp_index(*index + s_index_table4[code & 7]);
+}
+
+static inline unsigned adpcm4_code(int predictor, int index, int sample) {
+    const int step = s_step_table[index];
+    int diff = sample - predictor;
+    unsigned code = 0;
+    if (diff < 0) {
+        code = 8;
+        diff = -diff;
+    }
+    if (diff >= step) {
+        code |= 4;
+        diff -= step;
+    }
+    if (diff >= step >> 1) {
+        code |= 2;
+        diff -= step >> 1;
+    }
+    if (diff >= step >> 2) {
+        code |= 1;
+    }
+    return code;
+}
+
+// 2 位码字: bit1 为符号，bit0 选择 step/2 或 3*step/2
+static inline void adpcm2_step(int* predictor, int* index, unsigned code) {
+    const int step = s_step_table[*index];
+    int diff = step >> 1;
+    if (code & 1) diff += step;
+    *predictor = clamp_sample((code & 2) ? *predictor - diff : *predictor + diff);
+    *index = clamp_index(*index + s_index_table2[code & 1]);
+}
+
+static inline unsigned adpcm2_code(int predictor, int index, int sample) {
+    const int step = s_step_table[index];
+    int diff = sample - predictor;
+    unsigned code = 0;
+    if (diff < 0) {
+        code = 2;
+        diff = -diff;
+    }
+    if (diff >= step) {
+        code |= 1;
+    }
+    return code;
+}
+
+audio_codec_id_t audio_codec_negotiate(uint8_t local_mask, uint8_t remote_mask, uint8_t preferred) {
+    const uint8_t common = local_mask & remote_mask;
+    if (preferred < AUDIO_CODEC_COUNT && (common & AUDIO_CODEC_MASK(preferred))) {
+        return (audio_codec_id_t)preferred;
+    }
+    static const audio_codec_id_t order[] = {AUDIO_CODEC_IMA_ADPCM, AUDIO_CODEC_ADPCM2, AUDIO_CODEC_PCM16};
+    for (size_t i = 0; i < sizeof(order) / sizeof(order[0]); i++) {
+        if (common & AUDIO_CODEC_MASK(order[i])) {
+            return order[i];
+        }
+    }
+    return AUDIO_CODEC_COUNT;
+}
+
+size_t audio_codec_payload_size(audio_codec_id_t codec, size_t samples) {
+    switch (codec) {
+    case AUDIO_CODEC_PCM16:
+        return samples * sizeof(int16_t);
+    case AUDIO_CODEC_IMA_ADPCM:
+        return (samples + 1) / 2;
+    case AUDIO_CODEC_ADPCM2:
+        return (samples + 3) / 4;
+    default:
+        return 0;
+    }
+}
+
+size_t audio_adpcm_encode(audio_adpcm_state_t* state, const int16_t* pcm, size_t samples, uint8_t* out) {
+    int predictor = state->predictor;
+    int index = state->step_index;
+    size_t n = 0;
+    for (size_t i = 0; i < samples; i += 2) {
+        unsigned lo = adpcm4_code(predictor, index, pcm[i]);
+        adpcm4_step(&predictor, &index, lo);
+        unsigned hi = 0;
+        if (i + 1 < samples) {
+            hi = adpcm4_code(predictor, index, pcm[i + 1]);
+            adpcm4_step(&predictor, &index, hi);
+        }
+        out[n++] = (uint8_t)(lo | hi << 4);
+    }
+    state->predictor = (int16_t)predictor;
+    state->step_index = (uint8_t)index;
+    return n;
+}
+
+size_t audio_adpcm_decode(audio_adpcm_state_t* state, const uint8_t* in, size_t samples, int16_t* pcm) {
+    int predictor = state->predictor;
+    int index = clamp_index(state->step_index);
+    const size_t pairs = samples / 2;
+    for (size_t i = 0; i < pairs; i++) {
+        const unsigned byte = in[i];
+        adpcm4_step(&predictor, &index, byte & 0x0F);
+        pcm[2 * i] = (int16_t)predictor;
+        adpcm4_step(&predictor, &index, byte >> 4);
+        pcm[2 * i + 1] = (int16_t)predictor;
+    }
+    if (samples & 1) {
+        adpcm4_step(&predictor, &index, in[pairs] & 0x0F);
+        pcm[samples - 1] = (int16_t)predictor;
+    }
+    state->predictor = (int16_t)predictor;
+    state->step_index = (uint8_t)index;
+    return samples;
+}
+
+size_t audio_adpcm2_encode(audio_adpcm_state_t* state, const int16_t* pcm, size_t samples, uint8_t* out) {
+    int predictor = state->predictor;
+    int index = state->step_index;
+    size_t n = 0;
+    for (size_t i = 0; i < samples; i += 4) {
+        unsigned byte = 0;
+        for (size_t k = 0; k < 4 && i + k < samples; k++) {
+            const unsigned code = adpcm2_code(predictor, index, pcm[i + k]);
+            adpcm2_step(&predictor, &index, code);
+            byte |= code << (2 * k);
+        }
+        out[n++] = (uint8_t)byte;
+    }
+    state->predictor = (int16_t)predictor;
+    state->step_index = (uint8_t)index;
+    return n;
+}
+
+size_t audio_adpcm2_decode(audio_adpcm_state_t* state, const uint8_t* in, size_t samples, int16_t* pcm) {
+    int predictor = state->predictor;
+    int index = clamp_index(state->step_index);
+    for (size_t i = 0; i < samples; i++) {
+        adpcm2_step(&predictor, &index, (in[i >> 2] >> (2 * (i & 3))) & 3);
+        pcm[i] = (int16_t)predictor;
+    }
+    state->predictor = (int16_t)predictor;
+    state->step_index = (uint8_t)index;
+    return samples;
+}
+
+size_t audio_codec_encode_block(audio_codec_id_t codec, audio_adpcm_state_t* state, uint16_t seq,
+                                const int16_t* pcm, size_t samples, uint8_t* out) {
+    audio_block_header_t header = {
+        .sync = AUDIO_BLOCK_SYNC,
+        .codec = (uint8_t)codec,
+        .seq = seq,
+        .samples = (uint16_t)samples,
+        .predictor = state->predictor,
+        .step_index = state->step_index,
+    };
+    uint8_t* payload = out + sizeof(header);
+    size_t len = 0;
+    switch (codec) {
+    case AUDIO_CODEC_PCM16:
+        len = samples * sizeof(int16_t);
+        memcpy(payload, pcm, len);
+        break;
+    case AUDIO_CODEC_IMA_ADPCM:
+        len = audio_adpcm_encode(state, pcm, samples, payload);
+        break;
+    case AUDIO_CODEC_ADPCM2:
+        len = audio_adpcm2_encode(state, pcm, samples, payload);
+        break;
+    default:
+        return 0;
+    }
+    header.payload_len = (uint16_t)len;
+    memcpy(out, &header, sizeof(header));
+    return sizeof(header) + len;
+}
+
+size_t audio_codec_decode_block(const audio_block_header_t* header, const uint8_t* payload, int16_t* pcm) {
+    const audio_codec_id_t codec = (audio_codec_id_t)header->codec;
+    const size_t samples = header->samples;
+    if (header->sync != AUDIO_BLOCK_SYNC || samples == 0 || samples > AUDIO_BLOCK_MAX_SAMPLES ||
+        codec >= AUDIO_CODEC_COUNT || header->payload_len != audio_codec_payload_size(codec, samples)) {
+        return 0;
+    }
+
+    audio_adpcm_state_t state = {.predictor = header->predictor, .step_index = header->step_index};
+    switch (codec) {
+    case AUDIO_CODEC_PCM16:
+        memcpy(pcm, payload, samples * sizeof(int16_t));
+        return samples;
+    case AUDIO_CODEC_IMA_ADPCM:
+        return audio_adpcm_decode(&state, payload, samples, pcm);
+    case AUDIO_CODEC_ADPCM2:
+        return audio_adpcm2_decode(&state, payload, samples, pcm);
+    default:
+        return 0;
+    }
+}
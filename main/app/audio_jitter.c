@@ -0,0 +1,458 @@
+/**
+ * @file audio_jitter.c
+ * @brief 音频抖动缓冲实现
+ */
+
+#include "audio_jitter.h"
+#include <math.h>
+#include <string.h>
+
+#define JB_GAIN_ONE_Q15 32768
+#define JB_FADE_SAMPLES 64             // 隐藏信号恢复为真实信号时的淡入长度
+#define JB_PLC_FADE_MS 60              // 连续隐藏信号从满幅衰减到静音的时长 (与块长无关)
+#define JB_PLC_WINDOW 256              // 基音估计的相关窗口
+#define JB_JITTER_GAIN (1.0f / 16.0f)  // 抖动估计平滑系数 (RFC 3550)
+#define JB_JITTER_FACTOR 3.0f          // 目标延迟 = 块时长 + max(3 * 抖动, 近期最大相对延迟) + 欠载增加量
+#define JB_DELAY_WINDOW_US 10000000    // 相对延迟统计窗口，峰值保持一到两个窗口
+#define JB_ERR_TAU_S 1.0f              // 深度偏差平滑时间常数
+#define JB_DEADBAND_MS 5.0f            // 偏差死区，避免块到达的锯齿波动引起音调变化
+#define JB_KP_SECONDS 5.0f             // 比例项: 偏差约 5 秒内修正
+#define JB_DRIFT_GAIN 0.25f            // 每个窗口的漂移估计平滑系数
+
+// 缓冲深度按序号跨度计算: 尚未到达的中间块也计入 (播放到时由隐藏信号占据相同时长)
+static inline uint32_t jb_depth(const audio_jitter_t* jb) {
+    const int32_t span = (int16_t)(uint16_t)(jb->end_seq - jb->play_seq);
+    uint32_t missing = 0;
+    if (span > (int32_t)jb->buffered_blocks) {
+        missing = (uint32_t)span - jb->buffered_blocks;
+    }
+    return jb->fifo_count + jb->buffered_samples + missing * jb->last_block_samples;
+}
+
+static inline int16_t jb_fifo_at(const audio_jitter_t* jb, uint32_t i) {
+    return jb->fifo[(jb->fifo_read + i) & (jb->fifo_cap - 1)];
+}
+
+static inline int16_t jb_apply_gain(int32_t sample, int32_t gain_q15) {
+    return (int16_t)((sample * gain_q15) >> 15);
+}
+
+// 目标延迟: 上升立即生效 (避免欠载)，下降按 dt 限速 (避免深度修正引起明显的变速)
+static void jb_update_target(audio_jitter_t* jb, float dt) {
+    const float rate = (float)jb->cfg.sample_rate;
+    float margin_us = JB_JITTER_FACTOR * jb->jitter_us;
+    const int64_t peak_us = jb->peak_us[0] > jb->peak_us[1] ? jb->peak_us[0] : jb->peak_us[1];
+    if ((float)peak_us > margin_us) {
+        margin_us = (float)peak_us;
+    }
+    jb->stats.peak_delay_ms = (float)peak_us / 1000.0f;
+    float target_ms = (float)jb->last_block_samples * 1000.0f / rate + margin_us / 1000.0f + jb->boost_ms;
+    if (target_ms < jb->cfg.min_delay_ms) {
+        target_ms = jb->cfg.min_delay_ms;
+    }
+    if (target_ms > jb->cfg.max_delay_ms) {
+        target_ms = jb->cfg.max_delay_ms;
+    }
+    const float floor_ms = jb->target_ms - AUDIO_JITTER_TARGET_FALL_MS * dt;
+    if (target_ms < floor_ms) {
+        target_ms = floor_ms;
+    }
+    jb->target_ms = target_ms;
+    jb->stats.target_ms = target_ms;
+    jb->target_samples = target_ms * rate / 1000.0f;
+}
+
+// 最近写入的真实采样，供丢包隐藏使用
+static void jb_history_append(audio_jitter_t* jb, const int16_t* pcm, uint32_t n) {
+    const uint32_t h = AUDIO_JITTER_HISTORY_SAMPLES;
+    if (n >= h) {
+        memcpy(jb->history, pcm + n - h, h * sizeof(int16_t));
+        return;
+    }
+    memmove(jb->history, jb->history + n, (h - n) * sizeof(int16_t));
+    memcpy(jb->history + h - n, pcm, n * sizeof(int16_t));
+}
+
+static void jb_fifo_write(audio_jitter_t* jb, const int16_t* pcm, uint32_t n) {
+    const uint32_t mask = jb->fifo_cap - 1;
+    uint32_t w = (jb->fifo_read + jb->fifo_count) & mask;
+    for (uint32_t i = 0; i < n; i++) {
+        jb->fifo[w] = pcm[i];
+        w = (w + 1) & mask;
+    }
+    jb->fifo_count += n;
+}
+
+// 真实块进入播放队列；之前输出过衰减的隐藏信号时从该增益淡入
+static void jb_fifo_append_block(audio_jitter_t* jb, const int16_t* pcm, uint32_t n) {
+    jb_history_append(jb, pcm, n);
+    if (jb->last_gain_q15 >= JB_GAIN_ONE_Q15) {
+        jb_fifo_write(jb, pcm, n);
+        return;
+    }
+
+    const uint32_t mask = jb->fifo_cap - 1;
+    uint32_t w = (jb->fifo_read + jb->fifo_count) & mask;
+    const int32_t g0 = jb->last_gain_q15;
+    for (uint32_t i = 0; i < n; i++) {
+        int16_t s = pcm[i];
+        if (i < JB_FADE_SAMPLES) {
+            s = jb_apply_gain(s, g0 + (JB_GAIN_ONE_Q15 - g0) * (int32_t)i / JB_FADE_SAMPLES);
+        }
+        jb->fifo[w] = s;
+        w = (w + 1) & mask;
+    }
+    jb->fifo_count += n;
+    jb->last_gain_q15 = JB_GAIN_ONE_Q15;
+}
+
+// 基音周期估计: 在 2.5~15ms 范围内找历史末尾窗口的最大归一化自相关
+static uint32_t jb_estimate_period(const audio_jitter_t* jb) {
+    const uint32_t h = AUDIO_JITTER_HISTORY_SAMPLES;
+    uint32_t lag_min = jb->cfg.sample_rate / 400;
+    uint32_t lag_max = jb->cfg.sample_rate * 15 / 1000;
+    if (lag_max > h - JB_PLC_WINDOW) {
+        lag_max = h - JB_PLC_WINDOW;
+    }
+    if (lag_min < 16) {
+        lag_min = 16;
+    }
+
+    const int16_t* x = jb->history + h - JB_PLC_WINDOW;
+    uint32_t best_lag = lag_max;
+    float best_score = 0.0f;
+    for (uint32_t lag = lag_min; lag <= lag_max; lag += 2) {
+        int64_t corr = 0;
+        int64_t energy = 0;
+        for (uint32_t i = 0; i < JB_PLC_WINDOW; i += 2) {
+            const int32_t a = x[i];
+            const int32_t b = x[(int32_t)i - (int32_t)lag];
+            corr += a * b;
+            energy += b * b;
+        }
+        if (corr <= 0 || energy == 0) {
+            continue;
+        }
+        const float score = (float)corr / sqrtf((float)energy);
+        if (score > best_score) {
+            best_score = score;
+            best_lag = lag;
+        }
+    }
+    return best_lag;
+}
+
+// 写入 n 个隐藏采样: 重复历史末尾的基音周期，增益从 g0 线性变化到 g1
+static void jb_conceal(audio_jitter_t* jb, uint32_t n, int32_t g0, int32_t g1) {
+    if (jb->plc_run == 0) {
+        jb->plc_period = jb_estimate_period(jb);
+        jb->plc_pos = 0;
+    }
+    const uint32_t h = AUDIO_JITTER_HISTORY_SAMPLES;
+    const uint32_t period = jb->plc_period;
+    const uint32_t mask = jb->fifo_cap - 1;
+    uint32_t w = (jb->fifo_read + jb->fifo_count) & mask;
+    for (uint32_t i = 0; i < n; i++) {
+        const int32_t gain = g0 + (g1 - g0) * (int32_t)i / (int32_t)n;
+        jb->fifo[w] = jb_apply_gain(jb->history[h - period + jb->plc_pos % period], gain);
+        jb->plc_pos++;
+        w = (w + 1) & mask;
+    }
+    jb->fifo_count += n;
+    jb->plc_run++;
+    jb->last_gain_q15 = g1;
+}
+
+// 缺失一块: 增益从上一块末尾继续按时间线性下降，JB_PLC_FADE_MS 后静音
+static void jb_conceal_block(audio_jitter_t* jb, uint32_t n) {
+    const uint32_t fade_samples = jb->cfg.sample_rate * JB_PLC_FADE_MS / 1000;
+    const int32_t g0 = jb->last_gain_q15;
+    int32_t g1 = g0 - (int32_t)((int64_t)JB_GAIN_ONE_Q15 * n / fade_samples);
+    if (g1 < 0) {
+        g1 = 0;
+    }
+    jb_conceal(jb, n, g0, g1);
+}
+
+// 到达统计:
+//  - 抖动: 相邻块到达间隔与采样时间间隔之差的平滑绝对值 (RFC 3550)，反映平稳的随机延迟；
+//  - 峰值: 到达时间减采样时间得到相对延迟，减去窗口内最小值 (传输延迟基线) 后取窗口内最大值，
+//    反映 Wi-Fi 停顿后突发到达这类平滑抖动估计体现不出的长延迟
+static void jb_track_arrival(audio_jitter_t* jb, uint32_t timestamp, int64_t arrival_us) {
+    if (!jb->have_arrival) {
+        jb->have_arrival = true;
+        jb->media_samples = 0;
+        jb->windows = 0;
+        jb->window_start_us = arrival_us;
+        jb->base_min_us[0] = jb->base_min_us[1] = arrival_us;
+        jb->peak_us[0] = jb->peak_us[1] = 0;
+    } else {
+        const int32_t step = (int32_t)(timestamp - jb->last_timestamp);
+        const float d = (float)(arrival_us - jb->last_arrival_us) - (float)step * 1e6f / (float)jb->cfg.sample_rate;
+        jb->jitter_us += (fabsf(d) - jb->jitter_us) * JB_JITTER_GAIN;
+        jb->media_samples += step;
+    }
+    jb->last_arrival_us = arrival_us;
+    jb->last_timestamp = timestamp;
+
+    const int64_t rel = arrival_us - jb->media_samples * 1000000 / (int64_t)jb->cfg.sample_rate;
+    const int64_t elapsed = arrival_us - jb->window_start_us;
+    if (elapsed >= JB_DELAY_WINDOW_US) {
+        // 窗口滚动: 相邻窗口基线之差即时钟漂移 (发送端较快时基线下降)，旧峰值在两个窗口后失效
+        jb->windows++;
+        if (jb->windows >= 2) {
+            float est = -(float)(jb->base_min_us[0] - jb->base_min_us[1]) / (float)elapsed;
+            const float max_dev = (float)jb->cfg.max_drift_ppm * 1e-6f;
+            est = est > max_dev ? max_dev : (est < -max_dev ? -max_dev : est);
+            jb->drift += (est - jb->drift) * (jb->windows == 2 ? 1.0f : JB_DRIFT_GAIN);
+        }
+        jb->window_start_us = arrival_us;
+        jb->base_min_us[1] = jb->base_min_us[0];
+        jb->peak_us[1] = jb->peak_us[0];
+        jb->base_min_us[0] = rel;
+        jb->peak_us[0] = 0;
+    }
+    if (rel < jb->base_min_us[0]) {
+        jb->base_min_us[0] = rel;
+    }
+    const int64_t base = jb->base_min_us[0] < jb->base_min_us[1] ? jb->base_min_us[0] : jb->base_min_us[1];
+    if (rel - base > jb->peak_us[0]) {
+        jb->peak_us[0] = rel - base;
+    }
+}
+
+static void jb_clear_slots(audio_jitter_t* jb) {
+    memset(jb->slot_valid, 0, sizeof(jb->slot_valid));
+    jb->buffered_samples = 0;
+    jb->buffered_blocks = 0;
+    jb->end_seq = jb->play_seq;
+}
+
+bool audio_jitter_init(audio_jitter_t* jb, const audio_jitter_config_t* cfg, int16_t* storage) {
+    if (!jb || !cfg || !storage || cfg->sample_rate == 0 || cfg->max_block_samples == 0 || cfg->slot_count == 0 ||
+        cfg->slot_count > AUDIO_JITTER_MAX_SLOTS || (cfg->slot_count & (cfg->slot_count - 1)) != 0 ||
+        cfg->min_delay_ms > cfg->max_delay_ms) {
+        return false;
+    }
+
+    // 队列容量取不超过 4 块的最大 2 的幂，保证一次读取所需输入加一整块仍放得下
+    uint32_t fifo_cap = 1;
+    while (fifo_cap * 2 <= 4u * cfg->max_block_samples) {
+        fifo_cap *= 2;
+    }
+    if (fifo_cap < 2u * cfg->max_block_samples + 8) {
+        return false;
+    }
+
+    memset(jb, 0, sizeof(*jb));
+    jb->cfg = *cfg;
+    jb->slot_data = storage;
+    jb->fifo = storage + (size_t)cfg->slot_count * cfg->max_block_samples;
+    jb->fifo_cap = fifo_cap;
+    jb->history = jb->fifo + 4u * cfg->max_block_samples;
+    audio_jitter_reset(jb, 0);
+    return true;
+}
+
+void audio_jitter_reset(audio_jitter_t* jb, uint32_t sample_rate) {
+    if (sample_rate) {
+        jb->cfg.sample_rate = sample_rate;
+    }
+    jb->state = AUDIO_JITTER_IDLE;
+    jb->started = false;
+    jb->play_seq = 0;
+    jb_clear_slots(jb);
+    jb->last_block_samples = 0;
+    jb->fifo_read = 0;
+    jb->fifo_count = 0;
+    jb->phase = 0;
+    memset(jb->history, 0, AUDIO_JITTER_HISTORY_SAMPLES * sizeof(int16_t));
+    jb->plc_run = 0;
+    jb->plc_period = 0;
+    jb->plc_pos = 0;
+    jb->last_gain_q15 = 0;
+    jb->have_arrival = false;
+    jb->jitter_us = 0.0f;
+    jb->peak_us[0] = jb->peak_us[1] = 0;
+    jb->boost_ms = 0.0f;
+    jb->err_avg = 0.0f;
+    jb->drift = 0.0f;
+    jb->ratio = 1.0f;
+    memset(&jb->stats, 0, sizeof(jb->stats));
+    jb->target_ms = 0.0f;
+    jb_update_target(jb, 0.0f);
+}
+
+void audio_jitter_set_delay_range(audio_jitter_t* jb, uint16_t min_delay_ms, uint16_t max_delay_ms) {
+    if (min_delay_ms > max_delay_ms) {
+        return;
+    }
+    jb->cfg.min_delay_ms = min_delay_ms;
+    jb->cfg.max_delay_ms = max_delay_ms;
+    // 下限提高时立即生效，降低时按正常速度回落
+    jb_update_target(jb, 0.0f);
+}
+
+bool audio_jitter_push(audio_jitter_t* jb, uint16_t seq, uint32_t timestamp, const int16_t* pcm, size_t samples,
+                       int64_t arrival_us) {
+    if (!pcm || samples == 0 || samples > jb->cfg.max_block_samples) {
+        return false;
+    }
+    if (!jb->started) {
+        jb->started = true;
+        jb->play_seq = seq;
+        jb->end_seq = seq;
+        jb->state = AUDIO_JITTER_BUFFERING;
+    }
+
+    int32_t ahead = (int16_t)(uint16_t)(seq - jb->play_seq);
+    if (ahead < 0) {
+        jb->stats.late_blocks++;
+        return false;
+    }
+    if (ahead >= jb->cfg.slot_count) {
+        // 序号跳变超出缓冲范围 (发送端重启或长时间中断): 丢弃尚未播放的块，从该块重新开始
+        jb->stats.overflow_resets++;
+        jb->play_seq = seq;
+        jb_clear_slots(jb);
+        ahead = 0;
+        jb->have_arrival = false;
+    }
+
+    const uint32_t slot = seq & (jb->cfg.slot_count - 1);
+    if (jb->slot_valid[slot]) {
+        return false; // 重复
+    }
+    memcpy(jb->slot_data + (size_t)slot * jb->cfg.max_block_samples, pcm, samples * sizeof(int16_t));
+    jb->slot_seq[slot] = seq;
+    jb->slot_len[slot] = (uint16_t)samples;
+    jb->slot_valid[slot] = true;
+    jb->buffered_samples += (uint32_t)samples;
+    jb->buffered_blocks++;
+    if (ahead >= (int16_t)(uint16_t)(jb->end_seq - jb->play_seq)) {
+        jb->end_seq = (uint16_t)(seq + 1);
+    }
+    jb->last_block_samples = (uint16_t)samples;
+    jb->stats.received_blocks++;
+
+    jb_track_arrival(jb, timestamp, arrival_us);
+    jb_update_target(jb, 0.0f);
+    return true;
+}
+
+static void jb_update_drift(audio_jitter_t* jb, float dt) {
+    const float rate = (float)jb->cfg.sample_rate;
+    const float err = (float)jb_depth(jb) - jb->target_samples;
+    float alpha = dt / JB_ERR_TAU_S;
+    if (alpha > 1.0f) {
+        alpha = 1.0f;
+    }
+    jb->err_avg += (err - jb->err_avg) * alpha;
+
+    const float deadband = rate * JB_DEADBAND_MS / 1000.0f;
+    float e = 0.0f;
+    if (jb->err_avg > deadband) {
+        e = jb->err_avg - deadband;
+    } else if (jb->err_avg < -deadband) {
+        e = jb->err_avg + deadband;
+    }
+
+    const float max_dev = (float)jb->cfg.max_drift_ppm * 1e-6f;
+    float dev = jb->drift + e / (rate * JB_KP_SECONDS);
+    if (dev > max_dev) {
+        dev = max_dev;
+    } else if (dev < -max_dev) {
+        dev = -max_dev;
+    }
+    jb->ratio = 1.0f + dev;
+}
+
+void audio_jitter_pull(audio_jitter_t* jb, int16_t* out, size_t samples) {
+    const uint32_t n = (uint32_t)samples;
+    const float dt = (float)n / (float)jb->cfg.sample_rate;
+
+    if (jb->state == AUDIO_JITTER_BUFFERING && (float)jb_depth(jb) >= jb->target_samples) {
+        jb->state = AUDIO_JITTER_PLAYING;
+    }
+
+    if (jb->state == AUDIO_JITTER_PLAYING && n <= jb->cfg.max_block_samples) {
+        const uint64_t step = (uint64_t)((double)jb->ratio * 4294967296.0);
+        const uint32_t need = (uint32_t)(((uint64_t)jb->phase + step * n) >> 32) + 2;
+
+        while (jb->fifo_count < need) {
+            const uint32_t slot = jb->play_seq & (jb->cfg.slot_count - 1);
+            if (jb->slot_valid[slot] && jb->slot_seq[slot] == jb->play_seq) {
+                const uint32_t len = jb->slot_len[slot];
+                jb_fifo_append_block(jb, jb->slot_data + (size_t)slot * jb->cfg.max_block_samples, len);
+                jb->slot_valid[slot] = false;
+                jb->buffered_samples -= len;
+                jb->buffered_blocks--;
+                jb->plc_run = 0;
+            } else if (jb->buffered_samples > 0 || jb->last_gain_q15 > 0) {
+                // 当前块丢失或迟到: 隐藏并跳过该块 (迟到的块到达后按迟到丢弃)，连续隐藏到增益为零才算欠载
+                jb_conceal_block(jb, jb->last_block_samples);
+                jb->stats.concealed_blocks++;
+            } else {
+                break;
+            }
+            jb->play_seq++;
+            if ((int16_t)(uint16_t)(jb->end_seq - jb->play_seq) < 0) {
+                jb->end_seq = jb->play_seq;
+            }
+        }
+
+        if (jb->fifo_count < need) {
+            // 欠载: 以衰减到零的隐藏信号补齐本次输出，随后重新缓冲并提高目标延迟
+            jb->stats.underruns++;
+            jb->boost_ms += AUDIO_JITTER_UNDERRUN_BOOST_MS;
+            jb_conceal(jb, need - jb->fifo_count, jb->last_gain_q15, 0);
+            jb->state = AUDIO_JITTER_BUFFERING;
+            jb->err_avg = 0.0f;
+        }
+
+        // 定点线性插值重采样
+        const uint32_t mask = jb->fifo_cap - 1;
+        uint64_t phase = jb->phase;
+        uint32_t r = 0;
+        for (uint32_t i = 0; i < n; i++) {
+            const int32_t s0 = jb->fifo[(jb->fifo_read + r) & mask];
+            const int32_t s1 = jb->fifo[(jb->fifo_read + r + 1) & mask];
+            const int32_t frac = (int32_t)((uint32_t)phase >> 17);
+            out[i] = (int16_t)(s0 + (((s1 - s0) * frac) >> 15));
+            phase += step;
+            r += (uint32_t)(phase >> 32);
+            phase &= 0xFFFFFFFFull;
+        }
+        jb->fifo_read = (jb->fifo_read + r) & mask;
+        jb->fifo_count -= r;
+        jb->phase = (uint32_t)phase;
+
+        if (jb->state == AUDIO_JITTER_PLAYING) {
+            jb_update_drift(jb, dt);
+        }
+    } else {
+        memset(out, 0, samples * sizeof(int16_t));
+    }
+
+    if (jb->boost_ms > 0.0f) {
+        jb->boost_ms -= AUDIO_JITTER_BOOST_DECAY_MS * dt;
+        if (jb->boost_ms < 0.0f) {
+            jb->boost_ms = 0.0f;
+        }
+    }
+    jb_update_target(jb, dt);
+}
+
+bool audio_jitter_is_full(const audio_jitter_t* jb) {
+    return (float)jb_depth(jb) >= jb->target_samples + (float)jb->last_block_samples / 2.0f;
+}
+
+void audio_jitter_get_stats(const audio_jitter_t* jb, audio_jitter_stats_t* stats) {
+    *stats = jb->stats;
+    stats->state = jb->state;
+    stats->depth_samples = jb_depth(jb);
+    stats->depth_ms = (float)stats->depth_samples * 1000.0f / (float)jb->cfg.sample_rate;
+    stats->jitter_ms = jb->jitter_us / 1000.0f;
+    stats->drift_ppm = (int32_t)lroundf(jb->drift * 1e6f);
+    stats->resample_ppm = (int32_t)lroundf((jb->ratio - 1.0f) * 1e6f);
+}
@@ -0,0 +1,347 @@
+/**
+ * @file audio_mixer.c
+ * @brief 多音源混音、多相重采样与提示音发生器
+ */
+
+#include "audio_mixer.h"
+#include <math.h>
+#include <string.h>
+
+#define MIXER_PI 3.14159265358979
+
+#define RS_PHASE_SHIFT 27              // Q32 小数位置 -> 相位号 (32 个相位)
+#define RS_INTERP_SHIFT 12             // Q32 小数位置 -> 相邻相位之间的 Q15 插值系数
+#define RS_CUTOFF 0.90                 // 截止频率 (相对较低一侧的奈奎斯特频率)
+#define RS_KAISER_BETA 7.0             // 阻带约 -70dB
+
+#define TONE_SINE_BITS 8               // 正弦表 256 点，相邻点线性插值
+#define TONE_FADE_MS 5                 // 音符起止淡入淡出
+
+static inline int16_t sat16(int32_t v) {
+    return (int16_t)(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+}
+
+// ---------------------------------------------------------------- 重采样
+
+// 第一类零阶修正贝塞尔函数 (级数展开)
+static double bessel_i0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 32; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+bool audio_resampler_init(audio_resampler_t* rs, uint32_t in_rate, uint32_t out_rate) {
+    if (in_rate == 0 || out_rate == 0 || in_rate > out_rate * AUDIO_RESAMPLER_MAX_RATIO) {
+        return false;
+    }
+    memset(rs, 0, sizeof(*rs));
+    rs->in_rate = in_rate;
+    rs->out_rate = out_rate;
+    const uint64_t step = ((uint64_t)in_rate << 32) / out_rate;
+    rs->step_int = (uint32_t)(step >> 32);
+    rs->step_frac = (uint32_t)step;
+
+    // 相位 p 对应输出位于窗口中心右侧 p/P 个输入采样: c[p][k] = h(T/2 - 1 + p/P - k)
+    const double fc = RS_CUTOFF * (in_rate > out_rate ? (double)out_rate / in_rate : 1.0); // 相对输入奈奎斯特
+    const double half = AUDIO_RESAMPLER_TAPS / 2.0;
+    const double i0_beta = bessel_i0(RS_KAISER_BETA);
+    for (int p = 0; p <= AUDIO_RESAMPLER_PHASES; p++) {
+        double h[AUDIO_RESAMPLER_TAPS];
+        double sum = 0;
+        for (int k = 0; k < AUDIO_RESAMPLER_TAPS; k++) {
+            const double x = half - 1 + (double)p / AUDIO_RESAMPLER_PHASES - k;
+            const double sinc = x == 0 ? fc : sin(MIXER_PI * fc * x) / (MIXER_PI * x);
+            const double r = x / half;
+            const double win = r * r < 1.0 ? bessel_i0(RS_KAISER_BETA * sqrt(1.0 - r * r)) / i0_beta : 0.0;
+            h[k] = sinc * win;
+            sum += h[k];
+        }
+        // 每个相位单独归一化为直流增益 1，舍入误差补到最大的抽头
+        int16_t* c = &rs->coeffs[p * AUDIO_RESAMPLER_TAPS];
+        int32_t total = 0;
+        int peak = 0;
+        for (int k = 0; k < AUDIO_RESAMPLER_TAPS; k++) {
+            c[k] = (int16_t)lrint(h[k] / sum * 32768.0);
+            total += c[k];
+            if (c[k] > c[peak]) {
+                peak = k;
+            }
+        }
+        c[peak] = (int16_t)(c[peak] + 32768 - total);
+    }
+    audio_resampler_reset(rs);
+    return true;
+}
+
+void audio_resampler_reset(audio_resampler_t* rs) {
+    // 预置半个窗口的零，使首个输出对齐首个输入 (只有半窗延迟)
+    memset(rs->buf, 0, sizeof(rs->buf));
+    rs->filled = AUDIO_RESAMPLER_TAPS / 2;
+    rs->start = 0;
+    rs->frac = 0;
+}
+
+size_t audio_resampler_needed(const audio_resampler_t* rs, size_t frames) {
+    if (frames == 0) {
+        return 0;
+    }
+    const uint64_t step = ((uint64_t)rs->step_int << 32) | rs->step_frac;
+    const uint64_t last = rs->frac + (uint64_t)(frames - 1) * step;
+    const size_t end = rs->start + (size_t)(last >> 32) + AUDIO_RESAMPLER_TAPS;
+    return end > rs->filled ? end - rs->filled : 0;
+}
+
+static inline int32_t rs_dot(const int16_t* restrict c, const int16_t* restrict x) {
+    int32_t acc = 0;
+    for (int k = 0; k < AUDIO_RESAMPLER_TAPS; k++) {
+        acc += c[k] * x[k];
+    }
+    return acc;
+}
+
+void audio_resampler_process(audio_resampler_t* rs, const int16_t* in, size_t in_samples, int16_t* out,
+                             size_t frames) {
+    memcpy(&rs->buf[rs->filled], in, in_samples * sizeof(int16_t));
+    rs->filled = (uint16_t)(rs->filled + in_samples);
+
+    size_t start = rs->start;
+    uint32_t frac = rs->frac;
+    for (size_t i = 0; i < frames; i++) {
+        // 相邻两个相位的输出按小数位置线性插值
+        const uint32_t p = frac >> RS_PHASE_SHIFT;
+        const int32_t a = (int32_t)((frac >> RS_INTERP_SHIFT) & 0x7FFF);
+        const int16_t* c = &rs->coeffs[p * AUDIO_RESAMPLER_TAPS];
+        const int16_t* x = &rs->buf[start];
+        const int32_t y0 = rs_dot(c, x);
+        const int32_t y1 = rs_dot(c + AUDIO_RESAMPLER_TAPS, x);
+        const int32_t y = y0 + (int32_t)(((int64_t)(y1 - y0) * a) >> 15);
+        out[i] = sat16((y + (1 << 14)) >> 15);
+
+        const uint32_t next = frac + rs->step_frac;
+        start += rs->step_int + (next < frac);
+        frac = next;
+    }
+
+    // 未用完的输入移到缓冲开头
+    memmove(rs->buf, &rs->buf[start], (rs->filled - start) * sizeof(int16_t));
+    rs->filled = (uint16_t)(rs->filled - start);
+    rs->start = 0;
+    rs->frac = frac;
+}
+
+// ---------------------------------------------------------------- 混音
+
+void audio_mixer_init(audio_mixer_t* mixer, uint32_t out_rate) {
+    memset(mixer, 0, sizeof(*mixer));
+    mixer->out_rate = out_rate;
+    mixer->master_gain_q12 = AUDIO_MIXER_GAIN_UNITY;
+}
+
+static inline uint16_t clamp_gain(uint16_t gain_q12) {
+    return gain_q12 > AUDIO_MIXER_GAIN_MAX ? AUDIO_MIXER_GAIN_MAX : gain_q12;
+}
+
+static bool mixer_source_configure(audio_mixer_t* mixer, audio_mixer_source_t* src, uint32_t rate) {
+    src->passthrough = rate == mixer->out_rate;
+    if (src->passthrough) {
+        src->rs.in_rate = rate;
+        src->rs.out_rate = rate;
+        return true;
+    }
+    return audio_resampler_init(&src->rs, rate, mixer->out_rate);
+}
+
+int audio_mixer_add_source(audio_mixer_t* mixer, uint32_t rate, audio_mixer_source_type_t type,
+                           audio_mixer_pull_t pull, void* ctx, uint16_t gain_q12) {
+    if (!pull) {
+        return -1;
+    }
+    for (int id = 0; id < AUDIO_MIXER_MAX_SOURCES; id++) {
+        audio_mixer_source_t* src = &mixer->sources[id];
+        if (src->active) {
+            continue;
+        }
+        if (!mixer_source_configure(mixer, src, rate)) {
+            return -1;
+        }
+        src->type = type;
+        src->gain_q12 = clamp_gain(gain_q12);
+        src->pull = pull;
+        src->ctx = ctx;
+        src->underruns = 0;
+        src->active = true;
+        return id;
+    }
+    return -1;
+}
+
+void audio_mixer_remove_source(audio_mixer_t* mixer, int id) {
+    if (id >= 0 && id < AUDIO_MIXER_MAX_SOURCES) {
+        mixer->sources[id].active = false;
+    }
+}
+
+bool audio_mixer_set_source_rate(audio_mixer_t* mixer, int id, uint32_t rate) {
+    if (id < 0 || id >= AUDIO_MIXER_MAX_SOURCES || !mixer->sources[id].active) {
+        return false;
+    }
+    audio_mixer_source_t* src = &mixer->sources[id];
+    if (src->rs.in_rate == rate) {
+        return true;
+    }
+    if (!mixer_source_configure(mixer, src, rate)) {
+        src->active = false;
+        return false;
+    }
+    return true;
+}
+
+void audio_mixer_set_gain(audio_mixer_t* mixer, int id, uint16_t gain_q12) {
+    if (id >= 0 && id < AUDIO_MIXER_MAX_SOURCES) {
+        mixer->sources[id].gain_q12 = clamp_gain(gain_q12);
+    }
+}
+
+void audio_mixer_set_master_gain(audio_mixer_t* mixer, uint16_t gain_q12) {
+    mixer->master_gain_q12 = clamp_gain(gain_q12);
+}
+
+bool audio_mixer_source_active(const audio_mixer_t* mixer, int id) {
+    return id >= 0 && id < AUDIO_MIXER_MAX_SOURCES && mixer->sources[id].active;
+}
+
+// 拉取 samples 个采样，不足部分补零；返回是否拉满
+static bool mixer_pull(audio_mixer_source_t* src, int16_t* pcm, size_t samples) {
+    const size_t got = samples ? src->pull(src->ctx, pcm, samples) : 0;
+    if (got >= samples) {
+        return true;
+    }
+    memset(&pcm[got], 0, (samples - got) * sizeof(int16_t));
+    return false;
+}
+
+static void mixer_accumulate(int32_t* restrict acc, const int16_t* restrict pcm, int32_t gain, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        acc[i] += (pcm[i] * gain) >> 12;
+    }
+}
+
+void audio_mixer_render(audio_mixer_t* mixer, int16_t* out, size_t frames) {
+    if (frames > AUDIO_MIXER_MAX_FRAMES) {
+        frames = AUDIO_MIXER_MAX_FRAMES;
+    }
+    memset(mixer->acc, 0, frames * sizeof(int32_t));
+
+    for (int id = 0; id < AUDIO_MIXER_MAX_SOURCES; id++) {
+        audio_mixer_source_t* src = &mixer->sources[id];
+        if (!src->active) {
+            continue;
+        }
+        bool full;
+        if (src->passthrough) {
+            full = mixer_pull(src, mixer->tmp, frames);
+        } else {
+            const size_t need = audio_resampler_needed(&src->rs, frames);
+            full = mixer_pull(src, mixer->in, need);
+            audio_resampler_process(&src->rs, mixer->in, need, mixer->tmp, frames);
+        }
+        if (src->gain_q12) {
+            mixer_accumulate(mixer->acc, mixer->tmp, src->gain_q12, frames);
+        }
+        if (!full) {
+            if (src->type == AUDIO_MIXER_ONESHOT) {
+                src->active = false;
+            } else {
+                src->underruns++;
+            }
+        }
+    }
+
+    // 主增益与饱和 (|acc| 最大约 4 个音源 * 4 倍增益 * 32768，乘主增益用 64 位)
+    const int32_t master = mixer->master_gain_q12;
+    uint32_t clipped = 0;
+    for (size_t i = 0; i < frames; i++) {
+        const int32_t v = (int32_t)(((int64_t)mixer->acc[i] * master) >> 12);
+        clipped += (v > 32767) | (v < -32768);
+        out[i] = sat16(v);
+    }
+    mixer->clipped_samples += clipped;
+}
+
+// ---------------------------------------------------------------- 提示音
+
+static int16_t s_sine[(1 << TONE_SINE_BITS) + 1];
+
+static void tone_start_note(audio_tone_t* tone) {
+    const audio_tone_note_t* note = &tone->notes[tone->note];
+    tone->note_pos = 0;
+    tone->note_len = (uint32_t)((uint64_t)note->duration_ms * tone->sample_rate / 1000);
+    tone->phase = 0;
+    tone->phase_step = (uint32_t)(((uint64_t)note->freq_hz << 32) / tone->sample_rate);
+}
+
+bool audio_tone_init(audio_tone_t* tone, uint32_t sample_rate, const audio_tone_note_t* notes, size_t count,
+                     int16_t amplitude) {
+    if (count == 0 || count > AUDIO_TONE_MAX_NOTES || sample_rate == 0) {
+        return false;
+    }
+    if (s_sine[1 << (TONE_SINE_BITS - 2)] == 0) {
+        for (int i = 0; i <= (1 << TONE_SINE_BITS); i++) {
+            s_sine[i] = (int16_t)lrint(32767.0 * sin(2.0 * MIXER_PI * i / (1 << TONE_SINE_BITS)));
+        }
+    }
+    memset(tone, 0, sizeof(*tone));
+    tone->sample_rate = sample_rate;
+    tone->amplitude = amplitude;
+    tone->note_count = (uint8_t)count;
+    memcpy(tone->notes, notes, count * sizeof(audio_tone_note_t));
+    tone_start_note(tone);
+    return true;
+}
+
+size_t audio_tone_pull(void* ctx, int16_t* pcm, size_t samples) {
+    audio_tone_t* tone = (audio_tone_t*)ctx;
+    const uint32_t fade = tone->sample_rate * TONE_FADE_MS / 1000;
+    size_t produced = 0;
+    while (produced < samples && tone->note < tone->note_count) {
+        if (tone->note_pos >= tone->note_len) {
+            if (++tone->note < tone->note_count) {
+                tone_start_note(tone);
+            }
+            continue;
+        }
+        const bool rest = tone->notes[tone->note].freq_hz == 0;
+        size_t n = samples - produced;
+        if (n > tone->note_len - tone->note_pos) {
+            n = tone->note_len - tone->note_pos;
+        }
+        for (size_t i = 0; i < n; i++) {
+            int32_t v = 0;
+            if (!rest) {
+                const uint32_t idx = tone->phase >> (32 - TONE_SINE_BITS);
+                const int32_t a = (int32_t)((tone->phase >> (16 - TONE_SINE_BITS)) & 0xFFFF);
+                const int32_t s0 = s_sine[idx];
+                v = s0 + (int32_t)(((int64_t)(s_sine[idx + 1] - s0) * a) >> 16);
+                v = (v * tone->amplitude) >> 15;
+                // 起止淡入淡出，避免爆音
+                const uint32_t pos = tone->note_pos + (uint32_t)i;
+                const uint32_t edge = pos < tone->note_len - pos ? pos : tone->note_len - pos;
+                if (edge < fade) {
+                    v = (int32_t)((int64_t)v * edge / fade);
+                }
+                tone->phase += tone->phase_step;
+            }
+            pcm[produced + i] = (int16_t)v;
+        }
+        tone->note_pos += (uint32_t)n;
+        produced += n;
+    }
+    return produced;
+}
@@ -7,66 +7,344 @@
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/ringbuf.h"
+#include "freertos/semphr.h"
 #include "lwip/sockets.h"
+#include "esp_timer.h"
 #include "i2s_tdm.h"
+#include "sys_trace.h"
 #include <stdlib.h>
 #include "esp_heap_caps.h"
 #include <errno.h>
+#include <string.h>
 #include "../UI/inc/status_bar_manager.h"
+#include "audio_codec.h"
+#include "audio_jitter.h"
+#include "audio_mixer.h"
+#include "audio_rtp.h"
+#include "audio_receiver.h"
+#include "voice_capture.h"
 
 void audio_receiver_stop(void);
 
 static const char* TAG = "AUDIO_RECEIVER";
 
 #define TCP_PORT 7557
-#define BUFFER_SIZE (1024 * 256)  // 缓冲区大小到256KB
-#define SAMPLE_RATE 44100
+#define UDP_PORT 7557                    // UDP 低延迟音频 (RTP 格式，见 audio_rtp.h)
+#define SAMPLE_RATE 44100                // 未声明采样率的流 (旧格式 PCM 与无 hello 的 UDP)
+#define AUDIO_OUTPUT_RATE 44100          // I2S 输出采样率，各音源经混音器重采样到此采样率
+#define AUDIO_RX_CHUNK_SIZE 4096
+#define AUDIO_PLAYBACK_CHUNK_SAMPLES 256 // 播放任务每次渲染的采样数 (44.1kHz 下约 5.8ms)
+#define AUDIO_EFFECT_SLOTS (AUDIO_MIXER_MAX_SOURCES - 1) // 音效/提示音同时播放数 (另一路为网络流)
+#define AUDIO_RAW_BLOCK_SAMPLES 1024     // 旧格式 PCM 按此长度分块写入抖动缓冲
+#define AUDIO_BACKPRESSURE_WAIT_MS 5     // 抖动缓冲已满时暂停读取 socket 的间隔 (TCP 反压)
+#define AUDIO_TCP_MIN_DELAY_MS 40        // TCP 流目标延迟下限 (重传造成的停顿较长)
+#define AUDIO_UDP_MIN_DELAY_MS 20        // UDP 流目标延迟下限 (通话)
+#define AUDIO_MAX_DELAY_MS 400
+#define AUDIO_UDP_RX_TIMEOUT_MS 100      // recvfrom 超时，用于检查空闲与退出
+#define AUDIO_UDP_IDLE_US (1000 * 1000)  // 超过该时间无包视为 UDP 流结束
+// 解析缓冲: 一个完整块 (块头 + PCM16 最大负载) 加一次接收
+#define AUDIO_PARSE_BUF_SIZE \
+    (sizeof(audio_block_header_t) + AUDIO_BLOCK_MAX_SAMPLES * sizeof(int16_t) + AUDIO_RX_CHUNK_SIZE)
+#define AUDIO_TONE_AMPLITUDE 12000      // 提示音峰值 (约 -9dBFS，音量 100 时)
+#define AUDIO_MIN_SAMPLE_RATE 8000
+#define AUDIO_MAX_SAMPLE_RATE 48000
 
 static int server_sock = -1;
 static int client_sock = -1;
+static int udp_sock = -1;
 static bool server_running = false;
 static bool audio_receiving = false;  // 音频接收状态标志
 static TaskHandle_t playback_task_handle = NULL;
 static TaskHandle_t tcp_server_task_handle = NULL;
 static TaskHandle_t tcp_receive_task_handle = NULL;
-static RingbufHandle_t audio_ringbuf = NULL;
+static TaskHandle_t udp_receive_task_handle = NULL;
+static volatile bool s_udp_active = false; // UDP 流正在接收 (TCP 连接存在时 UDP 包被忽略)
 
-// I2S播放任务
+// 抖动缓冲: 接收任务写入，播放任务读取，s_jitter_lock 互斥
+static audio_jitter_t s_jitter;
+static int16_t* s_jitter_storage = NULL;
+static SemaphoreHandle_t s_jitter_lock = NULL;
+
+// 当前流状态 (由占用播放的接收任务修改: TCP 连接存在时为 TCP 接收任务，否则为 UDP 接收任务)
+static audio_receiver_stats_t s_stream;
+static int16_t s_pcm_block[AUDIO_BLOCK_MAX_SAMPLES]; // TCP 块解码输出
+static int16_t s_udp_pcm[AUDIO_RTP_MAX_SAMPLES];     // UDP 包解码输出
+static uint16_t s_raw_seq;                           // 旧格式分块的序号
+static bool s_seq_valid;                             // 已收到编码块，next_seq 有效
+static uint32_t s_next_timestamp;                    // 下一块首个采样的时间戳
+static volatile uint32_t s_pending_sample_rate = 0;  // 待播放任务应用到网络流音源的采样率 (0 表示无)
+
+// 混音器: 网络流 (抖动缓冲) 与音效共用 I2S 输出，s_mix_lock 互斥 (需要时先取 s_mix_lock 再取 s_jitter_lock)
+typedef struct {
+    int source;             // 混音器音源编号，-1 空闲
+    audio_tone_t tone;
+    const int16_t* pcm;     // PCM 音效 (NULL 为提示音)
+    size_t pcm_len;
+    size_t pcm_pos;
+} audio_effect_t;
+
+static audio_mixer_t* s_mixer = NULL;
+static SemaphoreHandle_t s_mix_lock = NULL;
+static int s_stream_source = -1;
+static audio_effect_t s_effects[AUDIO_EFFECT_SLOTS];
+
+// 网络流音源: 按流采样率从抖动缓冲拉取 (缓冲中/欠载时为静音或隐藏信号，总是拉满)
+static size_t audio_stream_pull(void* ctx, int16_t* pcm, size_t samples) {
+    xSemaphoreTake(s_jitter_lock, portMAX_DELAY);
+    audio_jitter_pull(&s_jitter, pcm, samples);
+    xSemaphoreGive(s_jitter_lock);
+    return samples;
+}
+
+static size_t audio_effect_pcm_pull(void* ctx, int16_t* pcm, size_t samples) {
+    audio_effect_t* effect = (audio_effect_t*)ctx;
+    size_t n = effect->pcm_len - effect->pcm_pos;
+    if (n > samples) {
+        n = samples;
+    }
+    memcpy(pcm, &effect->pcm[effect->pcm_pos], n * sizeof(int16_t));
+    effect->pcm_pos += n;
+    return n;
+}
+
+// I2S播放任务: 以 I2S 时钟节奏渲染混音器 (网络流 + 音效)，I2S 采样率固定为 AUDIO_OUTPUT_RATE
 static void i2s_playback_task(void* arg) {
+    static int16_t pcm[AUDIO_PLAYBACK_CHUNK_SAMPLES];
+
     while (server_running) {
-        size_t item_size;
-        const uint8_t* item = xRingbufferReceive(audio_ringbuf, &item_size, pdMS_TO_TICKS(100));
-        if (item) {
-            size_t bytes_written = 0;
-            esp_err_t ret = i2s_tdm_write((const void*)item, item_size, &bytes_written);
-            if (ret != ESP_OK) {
-                ESP_LOGE(TAG, "I2S write failed: %s", esp_err_to_name(ret));
-            }
-            vRingbufferReturnItem(audio_ringbuf, (void*)item);
+        xSemaphoreTake(s_mix_lock, portMAX_DELAY);
+        // 流采样率变化只重新配置网络流音源的重采样器，不重配 I2S 时钟
+        const uint32_t rate = s_pending_sample_rate;
+        if (rate) {
+            s_pending_sample_rate = 0;
+            audio_mixer_set_source_rate(s_mixer, s_stream_source, rate);
+        }
+        SYS_TRACE_BEGIN("audio_mix");
+        audio_mixer_render(s_mixer, pcm, AUDIO_PLAYBACK_CHUNK_SAMPLES);
+        SYS_TRACE_END("audio_mix");
+        xSemaphoreGive(s_mix_lock);
+
+        // 写入前送给上行回声消除作为参考 (与麦克风同一 I2S 时钟)
+        voice_capture_feed_reference(pcm, AUDIO_PLAYBACK_CHUNK_SAMPLES);
+
+        size_t bytes_written = 0;
+        SYS_TRACE_BEGIN("i2s_write");
+        esp_err_t ret = i2s_tdm_write(pcm, sizeof(pcm), &bytes_written);
+        SYS_TRACE_END("i2s_write");
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "I2S write failed: %s", esp_err_to_name(ret));
+            vTaskDelay(pdMS_TO_TICKS(10));
         }
     }
     playback_task_handle = NULL;
     vTaskDelete(NULL);
 }
 
+static void audio_push_pcm(uint16_t seq, uint32_t timestamp, const int16_t* pcm, size_t samples) {
+    s_stream.pcm_bytes += samples * sizeof(int16_t);
+    const int64_t now = esp_timer_get_time();
+    xSemaphoreTake(s_jitter_lock, portMAX_DELAY);
+    audio_jitter_push(&s_jitter, seq, timestamp, pcm, samples, now);
+    xSemaphoreGive(s_jitter_lock);
+    SYS_TRACE_COUNTER("audio_rx_seq", seq);
+}
+
+static bool audio_jitter_full(void) {
+    xSemaphoreTake(s_jitter_lock, portMAX_DELAY);
+    const bool full = audio_jitter_is_full(&s_jitter);
+    xSemaphoreGive(s_jitter_lock);
+    return full;
+}
+
+// 新流或采样率变化: 清空抖动缓冲并按传输方式设置目标延迟下限，播放任务随后切换网络流音源的采样率
+static void audio_stream_restart(uint32_t sample_rate) {
+    const uint16_t min_delay =
+        s_stream.transport == AUDIO_TRANSPORT_UDP ? AUDIO_UDP_MIN_DELAY_MS : AUDIO_TCP_MIN_DELAY_MS;
+    xSemaphoreTake(s_jitter_lock, portMAX_DELAY);
+    audio_jitter_set_delay_range(&s_jitter, min_delay, AUDIO_MAX_DELAY_MS);
+    audio_jitter_reset(&s_jitter, sample_rate);
+    xSemaphoreGive(s_jitter_lock);
+    s_pending_sample_rate = sample_rate;
+}
+
+/**
+ * @brief 编码协商: 选定编码，填写确认并切换到新流
+ * @return false 协商失败 (确认中带失败状态)
+ */
+static bool audio_stream_accept_hello(const audio_stream_hello_t* hello, audio_stream_ack_t* ack_out) {
+    const audio_codec_id_t codec =
+        audio_codec_negotiate(AUDIO_CODEC_SUPPORTED_MASK, hello->codec_mask, hello->preferred);
+    const bool ok = codec < AUDIO_CODEC_COUNT && hello->channels == 1 &&
+                    hello->sample_rate >= AUDIO_MIN_SAMPLE_RATE && hello->sample_rate <= AUDIO_MAX_SAMPLE_RATE &&
+                    hello->block_samples > 0 && hello->block_samples <= AUDIO_BLOCK_MAX_SAMPLES;
+
+    audio_stream_ack_t ack = {
+        .magic = AUDIO_STREAM_ACK_MAGIC,
+        .version = AUDIO_STREAM_VERSION,
+        .codec = ok ? (uint8_t)codec : 0,
+        .status = ok ? AUDIO_STREAM_ACK_OK : AUDIO_STREAM_ACK_UNSUPPORTED,
+        .block_samples = hello->block_samples,
+    };
+    *ack_out = ack;
+
+    if (!ok) {
+        ESP_LOGW(TAG, "Codec negotiation failed: mask=0x%02X ch=%u rate=%lu block=%u", hello->codec_mask,
+                 hello->channels, (unsigned long)hello->sample_rate, hello->block_samples);
+        return false;
+    }
+    s_stream.codec = (uint8_t)codec;
+    s_stream.sample_rate = hello->sample_rate;
+    s_seq_valid = false;
+    audio_stream_restart(hello->sample_rate);
+    ESP_LOGI(TAG, "Audio stream: codec=%d rate=%lu block=%u", codec, (unsigned long)hello->sample_rate,
+             hello->block_samples);
+    return true;
+}
+
+/**
+ * @brief 解析接收缓冲中的音频流
+ * @return 已消费的字节数，其余字节等待更多数据或抖动缓冲腾出空间
+ */
+static size_t audio_stream_consume(int sock, const uint8_t* data, size_t len) {
+    size_t pos = 0;
+
+    if (s_stream.mode == AUDIO_STREAM_MODE_DETECT) {
+        if (len < sizeof(uint32_t)) {
+            return 0;
+        }
+        uint32_t magic;
+        memcpy(&magic, data, sizeof(magic));
+        if (magic == AUDIO_STREAM_HELLO_MAGIC) {
+            s_stream.mode = AUDIO_STREAM_MODE_CODED;
+        } else {
+            // 旧发送端: 直接为 44.1kHz PCM
+            s_stream.mode = AUDIO_STREAM_MODE_RAW;
+            s_stream.codec = AUDIO_CODEC_PCM16;
+            s_stream.sample_rate = SAMPLE_RATE;
+            audio_stream_restart(SAMPLE_RATE);
+            ESP_LOGI(TAG, "Audio stream: raw PCM");
+        }
+    }
+
+    if (s_stream.mode == AUDIO_STREAM_MODE_RAW) {
+        // 按整采样分块，序号与时间戳本地生成；奇数尾字节留待下次
+        while (len - pos >= sizeof(int16_t) && !audio_jitter_full()) {
+            size_t samples = (len - pos) / sizeof(int16_t);
+            if (samples > AUDIO_RAW_BLOCK_SAMPLES) {
+                samples = AUDIO_RAW_BLOCK_SAMPLES;
+            }
+            memcpy(s_pcm_block, &data[pos], samples * sizeof(int16_t));
+            audio_push_pcm(s_raw_seq++, s_next_timestamp, s_pcm_block, samples);
+            s_next_timestamp += (uint32_t)samples;
+            pos += samples * sizeof(int16_t);
+        }
+        return pos;
+    }
+
+    while (pos < len) {
+        const uint8_t* p = &data[pos];
+        const size_t avail = len - pos;
+
+        if (avail >= sizeof(uint32_t) && p[0] == (uint8_t)AUDIO_STREAM_HELLO_MAGIC) {
+            uint32_t magic;
+            memcpy(&magic, p, sizeof(magic));
+            if (magic == AUDIO_STREAM_HELLO_MAGIC) {
+                if (avail < sizeof(audio_stream_hello_t)) {
+                    break;
+                }
+                audio_stream_hello_t hello;
+                audio_stream_ack_t ack;
+                memcpy(&hello, p, sizeof(hello));
+                audio_stream_accept_hello(&hello, &ack);
+                if (send(sock, &ack, sizeof(ack), 0) != sizeof(ack)) {
+                    ESP_LOGW(TAG, "Failed to send codec ack: errno %d", errno);
+                }
+                pos += sizeof(hello);
+                continue;
+            }
+        }
+
+        if (avail < sizeof(audio_block_header_t)) {
+            break;
+        }
+        audio_block_header_t header;
+        memcpy(&header, p, sizeof(header));
+        if (header.sync != AUDIO_BLOCK_SYNC || header.codec >= AUDIO_CODEC_COUNT || header.samples == 0 ||
+            header.samples > AUDIO_BLOCK_MAX_SAMPLES ||
+            header.payload_len != audio_codec_payload_size((audio_codec_id_t)header.codec, header.samples)) {
+            // 不是块头: 逐字节重新同步
+            s_stream.resync_bytes++;
+            pos++;
+            continue;
+        }
+        if (avail < sizeof(header) + header.payload_len || audio_jitter_full()) {
+            break;
+        }
+
+        // 时间戳按序号差推算，序号回绕与丢块时保持连续
+        uint32_t timestamp = 0;
+        if (s_seq_valid) {
+            const int16_t gap = (int16_t)(uint16_t)(header.seq - s_stream.next_seq);
+            timestamp = s_next_timestamp + (uint32_t)((int32_t)gap * header.samples);
+            if (gap > 0) {
+                s_stream.lost_blocks += (uint32_t)gap;
+            }
+        }
+        s_stream.next_seq = (uint16_t)(header.seq + 1);
+        s_next_timestamp = timestamp + header.samples;
+        s_seq_valid = true;
+        s_stream.blocks++;
+
+        const size_t samples = audio_codec_decode_block(&header, p + sizeof(header), s_pcm_block);
+        if (samples > 0) {
+            audio_push_pcm(header.seq, timestamp, s_pcm_block, samples);
+        } else {
+            s_stream.bad_blocks++;
+        }
+        pos += sizeof(header) + header.payload_len;
+    }
+    return pos;
+}
+
 // TCP接收任务
 static void tcp_receive_task(void* arg) {
     int sock = (int)(intptr_t)arg;
-    int total_received = 0;
-    
-    char *rx_buffer = heap_caps_malloc(BUFFER_SIZE, MALLOC_CAP_SPIRAM);
-    if (!rx_buffer) {
-        ESP_LOGE(TAG, "Failed to allocate rx_buffer from PSRAM");
-        rx_buffer = malloc(BUFFER_SIZE);
-        if (!rx_buffer) {
-            ESP_LOGE(TAG, "Failed to allocate rx_buffer from internal RAM");
+
+    memset(&s_stream, 0, sizeof(s_stream));
+    s_stream.transport = AUDIO_TRANSPORT_TCP;
+    s_raw_seq = 0;
+    s_seq_valid = false;
+    s_next_timestamp = 0;
+    size_t parse_len = 0;
+    uint8_t* parse_buf = heap_caps_malloc(AUDIO_PARSE_BUF_SIZE, MALLOC_CAP_SPIRAM);
+    if (!parse_buf) {
+        ESP_LOGE(TAG, "Failed to allocate parse buffer from PSRAM");
+        parse_buf = malloc(AUDIO_PARSE_BUF_SIZE);
+        if (!parse_buf) {
+            ESP_LOGE(TAG, "Failed to allocate parse buffer from internal RAM");
             goto cleanup;
         }
     }
-    
+
     while (server_running && sock >= 0) {
-        int len = recv(sock, rx_buffer, BUFFER_SIZE, 0);
+        if (parse_len > 0) {
+            const size_t used = audio_stream_consume(sock, parse_buf, parse_len);
+            parse_len -= used;
+            if (parse_len > 0 && used > 0) {
+                memmove(parse_buf, parse_buf + used, parse_len);
+            }
+        }
+        // 抖动缓冲已到目标深度: 暂停读取，由 TCP 窗口让发送端按播放速度发送
+        if (audio_jitter_full()) {
+            vTaskDelay(pdMS_TO_TICKS(AUDIO_BACKPRESSURE_WAIT_MS));
+            continue;
+        }
+
+        size_t room = AUDIO_PARSE_BUF_SIZE - parse_len;
+        if (room > AUDIO_RX_CHUNK_SIZE) {
+            room = AUDIO_RX_CHUNK_SIZE;
+        }
+        int len = recv(sock, parse_buf + parse_len, room, 0);
         if (len < 0) {
             if (errno == EAGAIN || errno == EWOULDBLOCK) {
                 vTaskDelay(pdMS_TO_TICKS(5)); // 短暂等待，避免忙等
@@ -78,18 +356,15 @@ static void tcp_receive_task(void* arg) {
             ESP_LOGI(TAG, "Connection closed");
             break;
         } else {
-            total_received += len;
+            s_stream.rx_bytes += len;
             
             // 设置音频接收状态
             audio_receiving = true;
             
             // 更新状态栏显示音频接收状态
             status_bar_manager_set_audio_status(true);
-            
-            BaseType_t done = xRingbufferSend(audio_ringbuf, rx_buffer, len, pdMS_TO_TICKS(100));
-            if (!done) {
-                ESP_LOGW(TAG, "Ringbuffer full, dropping %d bytes", len);
-            }
+
+            parse_len += (size_t)len;
         }
     }
 
@@ -97,9 +372,24 @@ cleanup:
     // 连接断开时，更新状态
     audio_receiving = false;
     status_bar_manager_set_audio_status(false);
-    
-    if (rx_buffer) {
-        free(rx_buffer);
+    if (s_stream.mode == AUDIO_STREAM_MODE_CODED) {
+        ESP_LOGI(TAG, "Audio stream closed: %lu bytes -> %llu PCM bytes, blocks=%lu lost=%lu bad=%lu resync=%lu",
+                 (unsigned long)s_stream.rx_bytes, (unsigned long long)s_stream.pcm_bytes,
+                 (unsigned long)s_stream.blocks, (unsigned long)s_stream.lost_blocks,
+                 (unsigned long)s_stream.bad_blocks, (unsigned long)s_stream.resync_bytes);
+    }
+    audio_jitter_stats_t jitter;
+    xSemaphoreTake(s_jitter_lock, portMAX_DELAY);
+    audio_jitter_get_stats(&s_jitter, &jitter);
+    xSemaphoreGive(s_jitter_lock);
+    ESP_LOGI(TAG, "Jitter buffer: target=%.0fms jitter=%.1fms peak=%.0fms drift=%ldppm underruns=%lu concealed=%lu "
+             "late=%lu", jitter.target_ms, jitter.jitter_ms, jitter.peak_delay_ms, (long)jitter.drift_ppm,
+             (unsigned long)jitter.underruns, (unsigned long)jitter.concealed_blocks,
+             (unsigned long)jitter.late_blocks);
+
+
+    if (parse_buf) {
+        free(parse_buf);
     }
     close(sock);
     client_sock = -1;
@@ -107,6 +397,166 @@ cleanup:
     vTaskDelete(NULL);
 }
 
+static void audio_udp_set_active(bool active, const struct sockaddr_in* peer) {
+    s_udp_active = active;
+    audio_receiving = active;
+    status_bar_manager_set_audio_status(active);
+    // 上行语音发回下行流的来源地址与端口
+    voice_capture_set_peer(active ? peer : NULL);
+    if (active) {
+        char addr[16];
+        inet_ntoa_r(peer->sin_addr, addr, sizeof(addr));
+        ESP_LOGI(TAG, "UDP audio stream from %s:%u", addr, ntohs(peer->sin_port));
+        return;
+    }
+
+    audio_jitter_stats_t jitter;
+    xSemaphoreTake(s_jitter_lock, portMAX_DELAY);
+    audio_jitter_get_stats(&s_jitter, &jitter);
+    xSemaphoreGive(s_jitter_lock);
+    ESP_LOGI(TAG, "UDP audio stream idle: packets=%lu lost=%lu bad=%lu target=%.0fms jitter=%.1fms "
+             "concealed=%lu late=%lu underruns=%lu", (unsigned long)s_stream.blocks,
+             (unsigned long)s_stream.lost_blocks, (unsigned long)s_stream.bad_blocks, jitter.target_ms,
+             jitter.jitter_ms, (unsigned long)jitter.concealed_blocks, (unsigned long)jitter.late_blocks,
+             (unsigned long)jitter.underruns);
+}
+
+// 新的 UDP 流 (hello 或 SSRC 变化): 接管流状态并清空抖动缓冲
+static void audio_udp_begin(uint32_t sample_rate, uint8_t codec) {
+    memset(&s_stream, 0, sizeof(s_stream));
+    s_stream.transport = AUDIO_TRANSPORT_UDP;
+    s_stream.mode = AUDIO_STREAM_MODE_CODED;
+    s_stream.codec = codec;
+    s_stream.sample_rate = sample_rate;
+    s_seq_valid = false;
+    audio_stream_restart(sample_rate);
+}
+
+static void audio_udp_handle_packet(const uint8_t* data, size_t len, uint32_t* ssrc, uint32_t sample_rate) {
+    audio_rtp_packet_t pkt;
+    if (!audio_rtp_parse(data, len, &pkt)) {
+        if (s_stream.transport == AUDIO_TRANSPORT_UDP) {
+            s_stream.bad_blocks++;
+        }
+        return;
+    }
+    if (s_stream.transport != AUDIO_TRANSPORT_UDP || !s_seq_valid || pkt.ssrc != *ssrc) {
+        if (s_stream.transport != AUDIO_TRANSPORT_UDP || pkt.ssrc != *ssrc) {
+            audio_udp_begin(sample_rate, pkt.block.codec);
+        }
+        *ssrc = pkt.ssrc;
+        s_stream.next_seq = pkt.seq;
+        s_seq_valid = true;
+    }
+    s_stream.rx_bytes += len;
+    s_stream.blocks++;
+
+    // 序号统计: 前跳计为丢失，之后乱序到达的包抵消
+    const int16_t gap = (int16_t)(uint16_t)(pkt.seq - s_stream.next_seq);
+    if (gap >= 0) {
+        s_stream.lost_blocks += (uint32_t)gap;
+        s_stream.next_seq = (uint16_t)(pkt.seq + 1);
+    } else if (s_stream.lost_blocks > 0) {
+        s_stream.lost_blocks--;
+    }
+
+    SYS_TRACE_BEGIN("audio_decode");
+    const size_t samples = audio_codec_decode_block(&pkt.block, pkt.payload, s_udp_pcm);
+    SYS_TRACE_END("audio_decode");
+    if (samples == 0) {
+        s_stream.bad_blocks++;
+        return;
+    }
+    s_stream.codec = pkt.block.codec;
+    audio_push_pcm(pkt.seq, pkt.timestamp, s_udp_pcm, samples);
+}
+
+// UDP接收任务: 小包低延迟音频，无反压，乱序/丢包由抖动缓冲处理
+static void udp_receive_task(void* arg) {
+    static uint8_t packet[AUDIO_RTP_MAX_PACKET];
+    uint32_t sample_rate = SAMPLE_RATE; // 最近一次 hello 声明的采样率
+    uint32_t ssrc = 0;
+    int64_t last_rx_us = 0;
+    struct sockaddr_in peer = {0};
+
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(UDP_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    udp_sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (udp_sock < 0) {
+        ESP_LOGE(TAG, "Unable to create UDP socket: errno %d", errno);
+        goto exit;
+    }
+    if (bind(udp_sock, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        ESP_LOGE(TAG, "UDP socket unable to bind: errno %d", errno);
+        goto exit;
+    }
+    struct timeval tv = {.tv_sec = 0, .tv_usec = AUDIO_UDP_RX_TIMEOUT_MS * 1000};
+    setsockopt(udp_sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    ESP_LOGI(TAG, "UDP audio listening on port %d", UDP_PORT);
+
+    while (server_running) {
+        struct sockaddr_in src;
+        socklen_t src_len = sizeof(src);
+        const int len = recvfrom(udp_sock, packet, sizeof(packet), 0, (struct sockaddr*)&src, &src_len);
+        const int64_t now = esp_timer_get_time();
+        if (len < 0) {
+            if (!server_running) {
+                break;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                ESP_LOGE(TAG, "UDP recv failed: errno %d", errno);
+                vTaskDelay(pdMS_TO_TICKS(100));
+            }
+            if (s_udp_active && now - last_rx_us > AUDIO_UDP_IDLE_US) {
+                audio_udp_set_active(false, &peer);
+            }
+            continue;
+        }
+        if (tcp_receive_task_handle != NULL) {
+            // TCP 连接占用播放
+            s_udp_active = false;
+            voice_capture_set_peer(NULL);
+            continue;
+        }
+
+        uint32_t magic = 0;
+        if ((size_t)len >= sizeof(magic)) {
+            memcpy(&magic, packet, sizeof(magic));
+        }
+        if (magic == AUDIO_STREAM_HELLO_MAGIC && (size_t)len >= sizeof(audio_stream_hello_t)) {
+            audio_stream_hello_t hello;
+            audio_stream_ack_t ack;
+            memcpy(&hello, packet, sizeof(hello));
+            s_stream.transport = AUDIO_TRANSPORT_UDP;
+            if (audio_stream_accept_hello(&hello, &ack)) {
+                sample_rate = hello.sample_rate;
+                audio_udp_begin(sample_rate, ack.codec);
+            }
+            sendto(udp_sock, &ack, sizeof(ack), 0, (struct sockaddr*)&src, src_len);
+            continue;
+        }
+
+        audio_udp_handle_packet(packet, (size_t)len, &ssrc, sample_rate);
+        last_rx_us = now;
+        peer = src;
+        if (!s_udp_active) {
+            audio_udp_set_active(true, &peer);
+        }
+    }
+
+exit:
+    if (udp_sock >= 0) {
+        close(udp_sock);
+        udp_sock = -1;
+    }
+    s_udp_active = false;
+    udp_receive_task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
 // TCP服务器任务
 static void tcp_server_task(void* arg) {
     struct sockaddr_in dest_addr;
@@ -168,21 +618,64 @@ error:
     vTaskDelete(NULL);
 }
 
+static void audio_receiver_release_buffers(void) {
+    if (s_mixer) {
+        free(s_mixer);
+        s_mixer = NULL;
+    }
+    if (s_mix_lock) {
+        vSemaphoreDelete(s_mix_lock);
+        s_mix_lock = NULL;
+    }
+    s_stream_source = -1;
+    if (s_jitter_storage) {
+        free(s_jitter_storage);
+        s_jitter_storage = NULL;
+    }
+    if (s_jitter_lock) {
+        vSemaphoreDelete(s_jitter_lock);
+        s_jitter_lock = NULL;
+    }
+}
+
 esp_err_t audio_receiver_start(void) {
     if (server_running) {
         return ESP_OK;
     }
     server_running = true;
 
-    // 初始化环形缓冲区 - 256KB缓冲区分配到PSRAM
-    audio_ringbuf = xRingbufferCreateWithCaps(BUFFER_SIZE, RINGBUF_TYPE_BYTEBUF, MALLOC_CAP_SPIRAM);
-    if (!audio_ringbuf) {
-        audio_ringbuf = xRingbufferCreate(BUFFER_SIZE, RINGBUF_TYPE_BYTEBUF);
-        if (!audio_ringbuf) {
-            ESP_LOGE(TAG, "Failed to create ring buffer");
-            server_running = false;
-            return ESP_FAIL;
-        }
+    // 初始化抖动缓冲 - 槽位与播放队列分配到PSRAM
+    const audio_jitter_config_t jitter_cfg = AUDIO_JITTER_DEFAULT_CONFIG(SAMPLE_RATE);
+    const size_t storage_size = AUDIO_JITTER_STORAGE_SAMPLES(&jitter_cfg) * sizeof(int16_t);
+    s_jitter_storage = heap_caps_malloc(storage_size, MALLOC_CAP_SPIRAM);
+    if (!s_jitter_storage) {
+        s_jitter_storage = malloc(storage_size);
+    }
+    s_jitter_lock = xSemaphoreCreateMutex();
+    if (!s_jitter_storage || !s_jitter_lock || !audio_jitter_init(&s_jitter, &jitter_cfg, s_jitter_storage)) {
+        ESP_LOGE(TAG, "Failed to create jitter buffer (%u bytes)", (unsigned)storage_size);
+        server_running = false;
+        audio_receiver_release_buffers();
+        return ESP_FAIL;
+    }
+
+    // 混音器: 重采样滤波器与历史在渲染时逐采样访问，优先放内部 RAM
+    s_mixer = heap_caps_malloc(sizeof(audio_mixer_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!s_mixer) {
+        s_mixer = heap_caps_malloc(sizeof(audio_mixer_t), MALLOC_CAP_SPIRAM);
+    }
+    s_mix_lock = xSemaphoreCreateMutex();
+    if (!s_mixer || !s_mix_lock) {
+        ESP_LOGE(TAG, "Failed to create mixer (%u bytes)", (unsigned)sizeof(audio_mixer_t));
+        server_running = false;
+        audio_receiver_release_buffers();
+        return ESP_FAIL;
+    }
+    audio_mixer_init(s_mixer, AUDIO_OUTPUT_RATE);
+    s_stream_source = audio_mixer_add_source(s_mixer, SAMPLE_RATE, AUDIO_MIXER_STREAM, audio_stream_pull, NULL,
+                                             AUDIO_MIXER_GAIN_UNITY);
+    for (int i = 0; i < AUDIO_EFFECT_SLOTS; i++) {
+        s_effects[i].source = -1;
     }
 
     // 初始化I2S
@@ -191,7 +684,7 @@ esp_err_t audio_receiver_start(void) {
         audio_receiver_stop();
         return ret;
     }
-    ret = i2s_tdm_set_sample_rate(SAMPLE_RATE);
+    ret = i2s_tdm_set_sample_rate(AUDIO_OUTPUT_RATE);
     if (ret != ESP_OK) {
         audio_receiver_stop();
         return ret;
@@ -215,11 +708,21 @@ esp_err_t audio_receiver_start(void) {
         xTaskCreatePinnedToCore(i2s_playback_task, "i2s_playback", 4096, NULL, 5, &playback_task_handle, 1);
     }
 
+    // 麦克风上行 (失败时只播放)
+    if (voice_capture_start() != ESP_OK) {
+        ESP_LOGW(TAG, "Voice capture not started, playback only");
+    }
+
     // 创建TCP服务器任务
     if (tcp_server_task_handle == NULL) {
         xTaskCreatePinnedToCore(tcp_server_task, "tcp_server", 4096, NULL, 5, &tcp_server_task_handle, 1);
     }
 
+    // 创建UDP接收任务 (优先级高于 TCP，小包需及时取走)
+    if (udp_receive_task_handle == NULL) {
+        xTaskCreatePinnedToCore(udp_receive_task, "udp_audio", 4096, NULL, 6, &udp_receive_task_handle, 0);
+    }
+
     return ESP_OK;
 }
 
@@ -242,22 +745,110 @@ void audio_receiver_stop(void) {
         close(server_sock);
         server_sock = -1;
     }
+    if (udp_sock != -1) {
+        shutdown(udp_sock, SHUT_RDWR);
+    }
     
     // 等待任务结束
-    while(tcp_server_task_handle != NULL || tcp_receive_task_handle != NULL || playback_task_handle != NULL) {
+    while(tcp_server_task_handle != NULL || tcp_receive_task_handle != NULL || playback_task_handle != NULL ||
+          udp_receive_task_handle != NULL) {
         vTaskDelay(pdMS_TO_TICKS(50));
     }
 
-    if (audio_ringbuf) {
-        vRingbufferDelete(audio_ringbuf);
-        audio_ringbuf = NULL;
-    }
+    audio_receiver_release_buffers();
 
+    voice_capture_stop();
     i2s_tdm_stop();
     i2s_tdm_deinit();
     ESP_LOGI(TAG, "Audio receiver stopped");
 }
 
 bool audio_receiver_is_receiving(void) {
-    return audio_receiving && server_running && (client_sock >= 0);
-}
\ No newline at end of file
+    return audio_receiving && server_running && (client_sock >= 0 || s_udp_active);
+}
+
+void audio_receiver_get_stats(audio_receiver_stats_t* stats) {
+    if (!stats) {
+        return;
+    }
+    *stats = s_stream;
+    if (s_jitter_lock) {
+        xSemaphoreTake(s_jitter_lock, portMAX_DELAY);
+        audio_jitter_get_stats(&s_jitter, &stats->jitter);
+        xSemaphoreGive(s_jitter_lock);
+    } else {
+        memset(&stats->jitter, 0, sizeof(stats->jitter));
+    }
+    stats->output_rate = AUDIO_OUTPUT_RATE;
+    if (s_mix_lock) {
+        xSemaphoreTake(s_mix_lock, portMAX_DELAY);
+        stats->mix_clipped_samples = s_mixer->clipped_samples;
+        xSemaphoreGive(s_mix_lock);
+    }
+}
+
+// 占用一个空闲音效槽 (调用者持有 s_mix_lock)
+static audio_effect_t* audio_effect_slot(void) {
+    for (int i = 0; i < AUDIO_EFFECT_SLOTS; i++) {
+        audio_effect_t* effect = &s_effects[i];
+        // 一次性音源结束后编号可能已被其他音效复用，按回调上下文确认
+        const void* ctx = effect->pcm ? (const void*)effect : (const void*)&effect->tone;
+        if (effect->source < 0 || !audio_mixer_source_active(s_mixer, effect->source) ||
+            s_mixer->sources[effect->source].ctx != ctx) {
+            effect->source = -1;
+            return effect;
+        }
+    }
+    return NULL;
+}
+
+static uint16_t audio_volume_gain(uint8_t volume) {
+    return (uint16_t)((volume > 100 ? 100 : volume) * AUDIO_MIXER_GAIN_UNITY / 100);
+}
+
+esp_err_t audio_receiver_play_tone(const audio_tone_note_t* notes, size_t count, uint8_t volume) {
+    if (!server_running || !s_mix_lock || !notes) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    xSemaphoreTake(s_mix_lock, portMAX_DELAY);
+    audio_effect_t* effect = audio_effect_slot();
+    if (effect && audio_tone_init(&effect->tone, AUDIO_OUTPUT_RATE, notes, count, AUDIO_TONE_AMPLITUDE)) {
+        effect->pcm = NULL;
+        effect->source = audio_mixer_add_source(s_mixer, AUDIO_OUTPUT_RATE, AUDIO_MIXER_ONESHOT, audio_tone_pull,
+                                                &effect->tone, audio_volume_gain(volume));
+        ret = effect->source >= 0 ? ESP_OK : ESP_ERR_NO_MEM;
+    } else if (effect) {
+        ret = ESP_ERR_INVALID_ARG;
+    }
+    xSemaphoreGive(s_mix_lock);
+    return ret;
+}
+
+esp_err_t audio_receiver_play_pcm(const int16_t* pcm, size_t samples, uint32_t sample_rate, uint8_t volume) {
+    if (!server_running || !s_mix_lock || !pcm) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    xSemaphoreTake(s_mix_lock, portMAX_DELAY);
+    audio_effect_t* effect = audio_effect_slot();
+    if (effect) {
+        effect->pcm = pcm;
+        effect->pcm_len = samples;
+        effect->pcm_pos = 0;
+        effect->source = audio_mixer_add_source(s_mixer, sample_rate, AUDIO_MIXER_ONESHOT, audio_effect_pcm_pull,
+                                                effect, audio_volume_gain(volume));
+        ret = effect->source >= 0 ? ESP_OK : ESP_ERR_INVALID_ARG;
+    }
+    xSemaphoreGive(s_mix_lock);
+    return ret;
+}
+
+void audio_receiver_set_stream_volume(uint8_t volume) {
+    if (!s_mix_lock) {
+        return;
+    }
+    xSemaphoreTake(s_mix_lock, portMAX_DELAY);
+    audio_mixer_set_gain(s_mixer, s_stream_source, audio_volume_gain(volume));
+    xSemaphoreGive(s_mix_lock);
+}
@@ -0,0 +1,130 @@
+/**
+ * @file audio_rtp.c
+ * @brief UDP 音频包 (RTP 格式) 打包与解析
+ */
+
+#include "audio_rtp.h"
+#include <string.h>
+
+static inline void put_be16(uint8_t* p, uint16_t v) {
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static inline void put_be32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static inline uint16_t get_be16(const uint8_t* p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static inline uint32_t get_be32(const uint8_t* p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+// 负载字节数对应的采样数 (与 audio_codec_payload_size 互逆，ADPCM 按满字节计)
+static size_t rtp_payload_samples(audio_codec_id_t codec, size_t bytes) {
+    switch (codec) {
+    case AUDIO_CODEC_PCM16:
+        return (bytes % sizeof(int16_t)) ? 0 : bytes / sizeof(int16_t);
+    case AUDIO_CODEC_IMA_ADPCM:
+        return bytes * 2;
+    case AUDIO_CODEC_ADPCM2:
+        return bytes * 4;
+    default:
+        return 0;
+    }
+}
+
+size_t audio_rtp_encode(audio_codec_id_t codec, audio_adpcm_state_t* state, uint16_t seq, uint32_t timestamp,
+                        uint32_t ssrc, bool marker, const int16_t* pcm, size_t samples, uint8_t* out) {
+    if (codec >= AUDIO_CODEC_COUNT || samples == 0 || samples > AUDIO_RTP_MAX_SAMPLES ||
+        (codec != AUDIO_CODEC_PCM16 && (samples & 3) != 0)) {
+        return 0;
+    }
+
+    out[0] = AUDIO_RTP_VERSION << 6;
+    out[1] = (uint8_t)((marker ? 0x80 : 0) | (AUDIO_RTP_PT_BASE + codec));
+    put_be16(&out[2], seq);
+    put_be32(&out[4], timestamp);
+    put_be32(&out[8], ssrc);
+
+    uint8_t* ph = out + AUDIO_RTP_HEADER_SIZE;
+    put_be16(&ph[0], (uint16_t)state->predictor);
+    ph[2] = state->step_index;
+    ph[3] = 0;
+
+    uint8_t* payload = ph + AUDIO_RTP_PAYLOAD_HEADER_SIZE;
+    size_t len = 0;
+    switch (codec) {
+    case AUDIO_CODEC_PCM16:
+        len = samples * sizeof(int16_t);
+        memcpy(payload, pcm, len);
+        break;
+    case AUDIO_CODEC_IMA_ADPCM:
+        len = audio_adpcm_encode(state, pcm, samples, payload);
+        break;
+    case AUDIO_CODEC_ADPCM2:
+        len = audio_adpcm2_encode(state, pcm, samples, payload);
+        break;
+    default:
+        return 0;
+    }
+    return AUDIO_RTP_HEADER_SIZE + AUDIO_RTP_PAYLOAD_HEADER_SIZE + len;
+}
+
+bool audio_rtp_parse(const uint8_t* packet, size_t len, audio_rtp_packet_t* out) {
+    if (len < AUDIO_RTP_HEADER_SIZE + AUDIO_RTP_PAYLOAD_HEADER_SIZE || (packet[0] >> 6) != AUDIO_RTP_VERSION) {
+        return false;
+    }
+
+    // 跳过 CSRC 列表与扩展头；去掉尾部填充
+    size_t offset = AUDIO_RTP_HEADER_SIZE + 4u * (packet[0] & 0x0F);
+    if (packet[0] & 0x10) {
+        if (len < offset + 4) {
+            return false;
+        }
+        offset += 4 + 4u * get_be16(&packet[offset + 2]);
+    }
+    if (packet[0] & 0x20) {
+        const uint8_t pad = packet[len - 1];
+        if (pad == 0 || pad > len) {
+            return false;
+        }
+        len -= pad;
+    }
+    if (len < offset + AUDIO_RTP_PAYLOAD_HEADER_SIZE) {
+        return false;
+    }
+
+    const uint8_t pt = packet[1] & 0x7F;
+    if (pt < AUDIO_RTP_PT_BASE || pt >= AUDIO_RTP_PT_BASE + AUDIO_CODEC_COUNT) {
+        return false;
+    }
+    const audio_codec_id_t codec = (audio_codec_id_t)(pt - AUDIO_RTP_PT_BASE);
+    const uint8_t* ph = packet + offset;
+    const size_t payload_len = len - offset - AUDIO_RTP_PAYLOAD_HEADER_SIZE;
+    const size_t samples = rtp_payload_samples(codec, payload_len);
+    if (samples == 0 || samples > AUDIO_RTP_MAX_SAMPLES) {
+        return false;
+    }
+
+    out->seq = get_be16(&packet[2]);
+    out->timestamp = get_be32(&packet[4]);
+    out->ssrc = get_be32(&packet[8]);
+    out->marker = (packet[1] & 0x80) != 0;
+    memset(&out->block, 0, sizeof(out->block));
+    out->block.sync = AUDIO_BLOCK_SYNC;
+    out->block.codec = (uint8_t)codec;
+    out->block.seq = out->seq;
+    out->block.samples = (uint16_t)samples;
+    out->block.predictor = (int16_t)get_be16(&ph[0]);
+    out->block.step_index = ph[2];
+    out->block.payload_len = (uint16_t)payload_len;
+    out->payload = ph + AUDIO_RTP_PAYLOAD_HEADER_SIZE;
+    return true;
+}
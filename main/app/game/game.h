@@ -7,6 +7,14 @@ extern "C" {
 
 #include "lvgl.h"
 
+typedef enum {
+    GAME_SOUND_SCORE = 0, // 得分 (吃到食物)
+    GAME_SOUND_HIT,       // 撞击方块
+    GAME_SOUND_CLEAR,     // 消行
+    GAME_SOUND_WIN,
+    GAME_SOUND_GAME_OVER,
+} game_sound_t;
+
 /**
  * @brief 创建游戏主菜单界面
  * @param parent 父对象
@@ -31,6 +39,11 @@ void ui_tetris_create(lv_obj_t* parent);
  */
 void ui_brickbreaker_create(lv_obj_t* parent);
 
+/**
+ * @brief 播放游戏音效 (与网络音频混音；音频服务未启动时忽略)
+ */
+void game_play_sound(game_sound_t sound);
+
 #ifdef __cplusplus
 }
 #endif
@@ -187,6 +187,7 @@ static void game_timer_cb(lv_timer_t* t) {
     // 检测游戏失败（球掉出屏幕）
     if (current_y > 260) {  // 适配更小的屏幕
         game_active = false;
+        game_play_sound(GAME_SOUND_GAME_OVER);
         lv_obj_t* game_over_label = lv_label_create(game_container);
         lv_label_set_text(game_over_label, "GAME OVER");
         lv_obj_set_style_text_color(game_over_label, lv_color_hex(0xFF0000), LV_PART_MAIN);
@@ -227,6 +228,7 @@ static void game_timer_cb(lv_timer_t* t) {
             int collision = check_collision(ball_obj, cubes[i][j].obj);
             if (collision > 0) {
                 score++;
+                game_play_sound(GAME_SOUND_HIT);
                 create_cube_animation(
                     lv_obj_get_style_bg_color(cubes[i][j].obj, LV_PART_MAIN),
                     lv_obj_get_x(cubes[i][j].obj),
@@ -267,6 +269,7 @@ static void game_timer_cb(lv_timer_t* t) {
     
     if (all_cleared) {
         game_active = false;
+        game_play_sound(GAME_SOUND_WIN);
         lv_obj_t* win_label = lv_label_create(game_container);
         lv_label_set_text(win_label, "YOU WIN!");
         lv_obj_set_style_text_color(win_label, lv_color_hex(0x00FF00), LV_PART_MAIN);
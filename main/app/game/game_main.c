@@ -1,7 +1,34 @@
 #include "game.h"
+#include "audio_receiver.h"
 #include "theme_manager.h"
 #include "ui.h" // For ui_main_menu_create
 
+#define GAME_SOUND_VOLUME 60
+
+// --- 音效 ---
+
+static const audio_tone_note_t s_sound_score[] = {{1320, 40}, {1760, 60}};
+static const audio_tone_note_t s_sound_hit[] = {{990, 25}};
+static const audio_tone_note_t s_sound_clear[] = {{880, 60}, {1175, 60}, {1568, 120}};
+static const audio_tone_note_t s_sound_win[] = {{1047, 100}, {1319, 100}, {1568, 100}, {2093, 250}};
+static const audio_tone_note_t s_sound_game_over[] = {{784, 150}, {0, 30}, {587, 150}, {0, 30}, {392, 300}};
+
+void game_play_sound(game_sound_t sound) {
+    static const struct {
+        const audio_tone_note_t* notes;
+        size_t count;
+    } sounds[] = {
+        [GAME_SOUND_SCORE] = {s_sound_score, sizeof(s_sound_score) / sizeof(s_sound_score[0])},
+        [GAME_SOUND_HIT] = {s_sound_hit, sizeof(s_sound_hit) / sizeof(s_sound_hit[0])},
+        [GAME_SOUND_CLEAR] = {s_sound_clear, sizeof(s_sound_clear) / sizeof(s_sound_clear[0])},
+        [GAME_SOUND_WIN] = {s_sound_win, sizeof(s_sound_win) / sizeof(s_sound_win[0])},
+        [GAME_SOUND_GAME_OVER] = {s_sound_game_over, sizeof(s_sound_game_over) / sizeof(s_sound_game_over[0])},
+    };
+    if ((size_t)sound < sizeof(sounds) / sizeof(sounds[0])) {
+        audio_receiver_play_tone(sounds[sound].notes, sounds[sound].count, GAME_SOUND_VOLUME);
+    }
+}
+
 // --- 回调函数 ---
 
 // 返回主菜单的回调
@@ -170,6 +170,7 @@ static void move_snake(void) {
     // 检查是否吃到食物
     if (check_food_collision()) {
         score += 10;
+        game_play_sound(GAME_SOUND_SCORE);
         snake_length++;
         snake[snake_length - 1] = tail;
         generate_food();
@@ -307,6 +308,7 @@ static void game_loop(lv_timer_t* timer) {
     // 检查碰撞
     if (check_collision()) {
         game_over = true;
+        game_play_sound(GAME_SOUND_GAME_OVER);
         return;
     }
     
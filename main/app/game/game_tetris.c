@@ -264,6 +264,7 @@ static void spawn_new_piece() {
     // 如果新生成的方块直接就碰撞了，说明游戏结束
     if (check_collision(current_piece.x, current_piece.y, current_piece.shape)) {
         game_over = true;
+        game_play_sound(GAME_SOUND_GAME_OVER);
     }
 }
 
@@ -308,6 +309,7 @@ static void clear_lines() {
     if (lines_cleared_this_turn > 0) {
         // 更新分数
         score += lines_cleared_this_turn * 100 * lines_cleared_this_turn;
+        game_play_sound(GAME_SOUND_CLEAR);
         lv_label_set_text_fmt(score_label, "Score:\n%d", score);
 
         // 更新总消行数并检查是否升级
@@ -12,6 +12,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
 #include "image_transfer_protocol.h"
@@ -19,6 +20,11 @@
 // 帧消息魔术数
 #define FRAME_MSG_MAGIC 0x4652414D  // 'FRAM'
 
+// 帧缓冲池: 队列深度 + 解码器在途一帧 + UI 正在拷贝的一帧
+// 块大小按首帧的分辨率确定，池满或更大的帧退回逐帧分配
+#define DISPLAY_QUEUE_DEPTH 4
+#define DISPLAY_FRAME_POOL_BLOCKS (DISPLAY_QUEUE_DEPTH + 2)
+
 // 定义帧消息结构
 typedef struct {
     uint32_t magic;          // 魔术数，标识帧消息
@@ -58,6 +64,15 @@ bool display_queue_enqueue(QueueHandle_t queue, frame_msg_t *frame_msg);
  */
 bool display_queue_dequeue(QueueHandle_t queue, frame_msg_t *frame_msg, TickType_t timeout);
 
+/**
+ * @brief 从帧缓冲池取一块用于解码输出 (16 字节对齐)
+ *
+ * 首次调用时按 size 建池；超过块大小、池已取空或建池失败时退回 jpeg_calloc_align。
+ * @param size 所需字节数
+ * @return 缓冲区指针，内存不足返回 NULL
+ */
+void *display_queue_alloc_frame(size_t size);
+
 /**
  * @brief 释放帧消息中的缓冲区资源
  * @param frame_msg 帧消息指针
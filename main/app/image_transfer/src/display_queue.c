@@ -12,20 +12,40 @@
 #include "esp_log.h"
 #include "esp_jpeg_common.h"
 #include "esp_jpeg_dec.h"
+#include "freertos/semphr.h"
+#include "mem_arena.h"
+#include "metrics.h"
+#include "sys_trace.h"
 
 static const char *TAG = "display_queue";
 
+static metrics_counter_t s_frames_queued =
+    METRICS_COUNTER_INIT("display_queue_frames_total", "Decoded frames queued for display");
+static metrics_counter_t s_frames_dropped =
+    METRICS_COUNTER_INIT("display_queue_dropped_total", "Frames dropped because the display queue was full");
+static metrics_gauge_t s_queue_depth = METRICS_GAUGE_INIT("display_queue_depth", "Frames waiting in the display queue");
+
+// 解码输出帧缓冲池，块大小取自首帧分辨率 (流的协商尺寸)，之后不再向堆申请
+static mem_pool_t s_frame_pool;
+static SemaphoreHandle_t s_pool_lock = NULL;
+static bool s_pool_failed = false;
+
 /**
  * @brief 初始化显示队列
  * @return 队列句柄，如果初始化失败返回NULL
  */
 QueueHandle_t display_queue_init(void) {
     // 创建队列，大小为4个帧消息
-    QueueHandle_t queue = xQueueCreate(4, sizeof(frame_msg_t));
+    QueueHandle_t queue = xQueueCreate(DISPLAY_QUEUE_DEPTH, sizeof(frame_msg_t));
     if (queue == NULL) {
         ESP_LOGE(TAG, "Failed to create display queue");
         return NULL;
     }
+    s_pool_lock = xSemaphoreCreateMutex();
+    s_pool_failed = false;
+    metrics_register(&s_frames_queued.desc);
+    metrics_register(&s_frames_dropped.desc);
+    metrics_register(&s_queue_depth.desc);
     return queue;
 }
 
@@ -41,6 +61,11 @@ void display_queue_deinit(QueueHandle_t queue) {
             display_queue_free_frame(&msg);
         }
         vQueueDelete(queue);
+        mem_pool_deinit(&s_frame_pool);
+        if (s_pool_lock != NULL) {
+            vSemaphoreDelete(s_pool_lock);
+            s_pool_lock = NULL;
+        }
         ESP_LOGI(TAG, "Display queue destroyed");
     }
 }
@@ -60,15 +85,23 @@ bool display_queue_enqueue(QueueHandle_t queue, frame_msg_t *frame_msg) {
     frame_msg->magic = FRAME_MSG_MAGIC;
     
     // 如果队列已满，移除最旧的帧以腾出空间
-    if (uxQueueMessagesWaiting(queue) >= 4) {
+    if (uxQueueMessagesWaiting(queue) >= DISPLAY_QUEUE_DEPTH) {
         frame_msg_t old_msg;
         if (xQueueReceive(queue, &old_msg, 0) == pdTRUE) {
             display_queue_free_frame(&old_msg);
+            metrics_counter_inc(&s_frames_dropped);
             ESP_LOGW(TAG, "Display queue full, dropped oldest frame");
         }
     }
     
-    return xQueueSend(queue, frame_msg, portMAX_DELAY) == pdTRUE;
+    const bool ok = xQueueSend(queue, frame_msg, portMAX_DELAY) == pdTRUE;
+    const UBaseType_t depth = uxQueueMessagesWaiting(queue);
+    if (ok) {
+        metrics_counter_inc(&s_frames_queued);
+    }
+    metrics_gauge_set(&s_queue_depth, (int32_t)depth);
+    SYS_TRACE_COUNTER("display_queue", depth);
+    return ok;
 }
 
 /**
@@ -84,6 +117,9 @@ bool display_queue_dequeue(QueueHandle_t queue, frame_msg_t *frame_msg, TickType
     }
     
     BaseType_t result = xQueueReceive(queue, frame_msg, timeout);
+    if (result == pdTRUE) {
+        metrics_gauge_set(&s_queue_depth, (int32_t)uxQueueMessagesWaiting(queue));
+    }
     if (result == pdTRUE && frame_msg->magic == FRAME_MSG_MAGIC) {
         return true;
     }
@@ -91,13 +127,53 @@ bool display_queue_dequeue(QueueHandle_t queue, frame_msg_t *frame_msg, TickType
     return false;
 }
 
+/**
+ * @brief 按首帧尺寸建立帧缓冲池，只尝试一次
+ * @param size 首帧字节数
+ */
+static void frame_pool_setup(size_t size) {
+    if (s_pool_lock == NULL || xSemaphoreTake(s_pool_lock, portMAX_DELAY) != pdTRUE) {
+        return;
+    }
+    if (mem_pool_block_size(&s_frame_pool) == 0 && !s_pool_failed) {
+        if (mem_pool_init(&s_frame_pool, "display_frames", size, DISPLAY_FRAME_POOL_BLOCKS,
+                          MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT) != ESP_OK) {
+            ESP_LOGW(TAG, "Frame pool unavailable, falling back to per-frame allocation");
+            s_pool_failed = true;
+        }
+    }
+    xSemaphoreGive(s_pool_lock);
+}
+
+/**
+ * @brief 从帧缓冲池取一块用于解码输出
+ * @param size 所需字节数
+ * @return 缓冲区指针，失败返回NULL
+ */
+void *display_queue_alloc_frame(size_t size) {
+    if (mem_pool_block_size(&s_frame_pool) == 0) {
+        frame_pool_setup(size);
+    }
+    if (size <= mem_pool_block_size(&s_frame_pool)) {
+        void *block = mem_pool_alloc(&s_frame_pool);
+        if (block != NULL) {
+            return block;
+        }
+    }
+    // 分辨率变大或池已取空时逐帧分配，释放时由 display_queue_free_frame 区分
+    return jpeg_calloc_align(size, 16);
+}
+
 /**
  * @brief 释放帧消息中的缓冲区资源
  * @param frame_msg 帧消息指针
  */
 void display_queue_free_frame(frame_msg_t *frame_msg) {
     if (frame_msg != NULL && frame_msg->frame_buffer != NULL) {
-        jpeg_free_align(frame_msg->frame_buffer);
+        // 池外缓冲 (池不可用时的回退分配) 仍按原方式释放
+        if (!mem_pool_free(&s_frame_pool, frame_msg->frame_buffer)) {
+            jpeg_free_align(frame_msg->frame_buffer);
+        }
         frame_msg->frame_buffer = NULL;
         frame_msg->magic = 0; // 清除魔术数
     }
@@ -8,6 +8,8 @@
 #include "freertos/task.h"
 #include "freertos/semphr.h"
 #include "freertos/event_groups.h"
+#include "mem_arena.h"
+#include "sys_trace.h"
 #include <string.h>
 
 static const char* TAG = "JPEG_DECODER_SERVICE";
@@ -15,10 +17,10 @@ static const char* TAG = "JPEG_DECODER_SERVICE";
 // 全局状态变量
 static bool s_jpeg_service_running = false;
 static uint8_t* s_jpeg_buffer = NULL;
-static uint8_t* s_decoded_buffer = NULL;
-// 三重缓冲系统已移除，现在直接使用显示队列
+// 三重缓冲系统已移除，解码输出直接取自显示队列的帧缓冲池
 static size_t s_max_jpeg_size = 0;
-static size_t s_max_decoded_size = 0;
+// 每帧的解码器临时结构 (io/头信息)，帧结束整体复位
+static mem_arena_t s_scratch_arena;
 static int s_frame_width = 0;       // 当前帧宽度
 static int s_frame_height = 0;      // 当前帧高度
 static EventGroupHandle_t s_jpeg_event_group = NULL;
@@ -29,6 +31,7 @@ static QueueHandle_t s_display_queue = NULL; // 显示队列句柄
 
 #define JPEG_DATA_READY_BIT (1 << 0)
 #define JPEG_BUFFER_LOCK_BIT (1 << 1) // 缓冲区锁定位
+#define JPEG_SCRATCH_ARENA_SIZE 1024
 
 // JPEG解码任务函数
 static void jpeg_decode_task(void* pvParameters) {
@@ -60,9 +63,10 @@ static void jpeg_decode_task(void* pvParameters) {
             ESP_LOGD(TAG, "JPEG decode task: received data ready signal");
             if (s_jpeg_buffer && s_max_jpeg_size > 0) {
                 ESP_LOGD(TAG, "JPEG decode task: buffer valid, size=%zu", s_max_jpeg_size);
-                // 解析JPEG头部信息
-                jpeg_dec_io_t* jpeg_io = calloc(1, sizeof(jpeg_dec_io_t));
-                jpeg_dec_header_info_t* out_info = calloc(1, sizeof(jpeg_dec_header_info_t));
+                // 解析JPEG头部信息 (临时结构取自每帧复位的线性区)
+                jpeg_dec_io_t* jpeg_io = mem_arena_calloc(&s_scratch_arena, sizeof(jpeg_dec_io_t), 0);
+                jpeg_dec_header_info_t* out_info =
+                    mem_arena_calloc(&s_scratch_arena, sizeof(jpeg_dec_header_info_t), 0);
 
                 if (jpeg_io && out_info) {
                     // 设置输入缓冲区
@@ -76,62 +80,43 @@ static void jpeg_decode_task(void* pvParameters) {
                         ESP_LOGD(TAG, "JPEG header parsed: %dx%d", out_info->width,
                                  out_info->height);
 
-                        // 确保解码缓冲区足够大
+                        // 从帧缓冲池取输出缓冲，入队后所有权转移给显示队列
                         size_t required_size =
                             out_info->width * out_info->height * 2; // RGB565 = 2字节/像素
-                        if (!s_decoded_buffer || s_max_decoded_size < required_size) {
-                            if (s_decoded_buffer) {
-                                jpeg_free_align(s_decoded_buffer);
-                            }
-                            s_decoded_buffer = jpeg_calloc_align(required_size, 16);
-                            if (!s_decoded_buffer) {
-                                ESP_LOGE(TAG, "Failed to allocate decoded buffer");
-                                free(jpeg_io);
-                                free(out_info);
-                                continue;
-                            }
-                            s_max_decoded_size = required_size;
-                        }
-
-                        // UI缓冲区管理已简化，直接使用显示队列
-
-                        // 设置输出缓冲区为解码缓冲区
-                        jpeg_io->outbuf = s_decoded_buffer;
-
-                        // 执行JPEG解码
-                        ESP_LOGD(TAG, "JPEG decode task: processing decode...");
-                        dec_ret = jpeg_dec_process(jpeg_dec, jpeg_io);
-                        if (dec_ret == JPEG_ERR_OK) {
-                            ESP_LOGD(TAG, "JPEG decoded: %dx%d", out_info->width, out_info->height);
-
-                            // 记录当前帧尺寸
-                            s_frame_width = out_info->width;
-                            s_frame_height = out_info->height;
-
-                            // 直接使用解码缓冲区推送到显示队列，避免额外的内存复制
-                            // 推送到 DisplayQueue（RGB565LE）
-                            frame_msg_t msg = {.magic = FRAME_MSG_MAGIC,
-                                               .type = FRAME_TYPE_JPEG,
-                                               .width = (uint16_t)s_frame_width,
-                                               .height = (uint16_t)s_frame_height,
-                                               .payload_len = (uint32_t)required_size,
-                                               .frame_buffer = s_decoded_buffer};
-                            
-                            if (display_queue_enqueue(s_display_queue, &msg)) {
-                                // 入队成功，将解码缓冲区所有权转移给显示队列
-                                // 分配新的解码缓冲区供下一帧使用
-                                s_decoded_buffer = jpeg_calloc_align(required_size, 16);
-                                if (!s_decoded_buffer) {
-                                    ESP_LOGE(TAG, "Failed to allocate new decoded buffer");
-                                    s_max_decoded_size = 0;
-                                } else {
-                                    s_max_decoded_size = required_size;
+                        frame_msg_t msg = {.magic = FRAME_MSG_MAGIC,
+                                           .type = FRAME_TYPE_JPEG,
+                                           .width = (uint16_t)out_info->width,
+                                           .height = (uint16_t)out_info->height,
+                                           .payload_len = (uint32_t)required_size,
+                                           .frame_buffer = display_queue_alloc_frame(required_size)};
+
+                        if (!msg.frame_buffer) {
+                            ESP_LOGE(TAG, "Failed to allocate decoded buffer");
+                        } else {
+                            // 设置输出缓冲区
+                            jpeg_io->outbuf = msg.frame_buffer;
+
+                            // 执行JPEG解码
+                            ESP_LOGD(TAG, "JPEG decode task: processing decode...");
+                            SYS_TRACE_BEGIN("jpeg_decode");
+                            dec_ret = jpeg_dec_process(jpeg_dec, jpeg_io);
+                            SYS_TRACE_END("jpeg_decode");
+                            if (dec_ret == JPEG_ERR_OK) {
+                                ESP_LOGD(TAG, "JPEG decoded: %dx%d", out_info->width, out_info->height);
+
+                                // 记录当前帧尺寸
+                                s_frame_width = out_info->width;
+                                s_frame_height = out_info->height;
+
+                                // 推送到 DisplayQueue（RGB565LE）
+                                if (!display_queue_enqueue(s_display_queue, &msg)) {
+                                    ESP_LOGW(TAG, "Display queue full, dropping frame");
+                                    display_queue_free_frame(&msg);
                                 }
                             } else {
-                                ESP_LOGW(TAG, "Display queue full, dropping frame");
+                                ESP_LOGE(TAG, "JPEG decode failed: %d", dec_ret);
+                                display_queue_free_frame(&msg);
                             }
-                        } else {
-                            ESP_LOGE(TAG, "JPEG decode failed: %d", dec_ret);
                         }
                     } else {
                         ESP_LOGE(TAG, "JPEG header parse failed: %d", dec_ret);
@@ -141,10 +126,7 @@ static void jpeg_decode_task(void* pvParameters) {
                 }
 
                 // 清理临时结构
-                if (jpeg_io)
-                    free(jpeg_io);
-                if (out_info)
-                    free(out_info);
+                mem_arena_reset(&s_scratch_arena);
             } else {
                 ESP_LOGW(TAG, "JPEG decode task: invalid buffer or size=0");
             }
@@ -218,6 +200,15 @@ esp_err_t jpeg_decoder_service_init(jpeg_decoder_callback_t data_callback, void*
 
     // 互斥锁已移除，使用更简单的缓冲区管理
 
+    // 解码临时结构的线性区，初始化时一次申请
+    esp_err_t ret = mem_arena_init(&s_scratch_arena, "jpeg_scratch", JPEG_SCRATCH_ARENA_SIZE,
+                                   MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (ret != ESP_OK) {
+        vEventGroupDelete(s_jpeg_event_group);
+        s_jpeg_event_group = NULL;
+        return ret;
+    }
+
     s_data_callback = data_callback;
     s_callback_context = context;
     s_display_queue = display_queue;
@@ -236,6 +227,7 @@ esp_err_t jpeg_decoder_service_init(jpeg_decoder_callback_t data_callback, void*
 
     if (result != pdPASS) {
         ESP_LOGE(TAG, "Failed to create JPEG decode task");
+        mem_arena_deinit(&s_scratch_arena);
         vEventGroupDelete(s_jpeg_event_group);
         s_jpeg_event_group = NULL;
         s_jpeg_service_running = false;
@@ -272,11 +264,7 @@ void jpeg_decoder_service_deinit(void) {
         s_max_jpeg_size = 0;
     }
 
-    if (s_decoded_buffer) {
-        jpeg_free_align(s_decoded_buffer);
-        s_decoded_buffer = NULL;
-        s_max_decoded_size = 0;
-    }
+    mem_arena_deinit(&s_scratch_arena);
 
     // 删除事件组
     if (s_jpeg_event_group) {
@@ -17,6 +17,7 @@
 #include "freertos/event_groups.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
+#include "sys_trace.h"
 #include "lz4.h"
 #include "lz4frame.h"
 #include <stdlib.h>
@@ -36,6 +37,8 @@ static uint8_t *s_decompressed_buffer = NULL;
 static size_t s_max_compressed_size = 0;
 static size_t s_max_decompressed_size = 0;
 static size_t s_compressed_data_received = 0;
+// 解压缩上下文常驻，每帧复位，避免逐帧申请内部缓冲
+static LZ4F_dctx *s_dctx = NULL;
 
 static void lz4_decoder_task(void *arg);
 
@@ -82,6 +85,22 @@ bool lz4_decoder_service_init(QueueHandle_t display_queue) {
     }
     s_max_decompressed_size = 2 * 1024 * 1024;
 
+    // 创建解压缩上下文
+    LZ4F_errorCode_t errorCode = LZ4F_createDecompressionContext(&s_dctx, LZ4F_VERSION);
+    if (LZ4F_isError(errorCode)) {
+        ESP_LOGE(TAG, "LZ4F_createDecompressionContext failed: %s", LZ4F_getErrorName(errorCode));
+        heap_caps_free(s_compressed_buffer);
+        heap_caps_free(s_decompressed_buffer);
+        vSemaphoreDelete(s_lz4_mutex);
+        vEventGroupDelete(lz4_decoder_event_group);
+        s_compressed_buffer = NULL;
+        s_decompressed_buffer = NULL;
+        s_lz4_mutex = NULL;
+        lz4_decoder_event_group = NULL;
+        s_dctx = NULL;
+        return false;
+    }
+
     // 保存显示队列句柄
     s_display_queue = display_queue;
 
@@ -97,6 +116,8 @@ bool lz4_decoder_service_init(QueueHandle_t display_queue) {
 
     if (result != pdPASS) {
         ESP_LOGE(TAG, "Failed to create LZ4 decoder task");
+        LZ4F_freeDecompressionContext(s_dctx);
+        s_dctx = NULL;
         heap_caps_free(s_compressed_buffer);
         heap_caps_free(s_decompressed_buffer);
         vSemaphoreDelete(s_lz4_mutex);
@@ -125,6 +146,11 @@ void lz4_decoder_service_deinit(void) {
     }
 
     // 清理资源
+    if (s_dctx) {
+        LZ4F_freeDecompressionContext(s_dctx);
+        s_dctx = NULL;
+    }
+
     if (s_compressed_buffer) {
         heap_caps_free(s_compressed_buffer);
         s_compressed_buffer = NULL;
@@ -200,16 +226,7 @@ static void lz4_decoder_task(void *arg) {
         if (bits & LZ4_DECODER_DATA_READY_BIT) {
             if (xSemaphoreTake(s_lz4_mutex, portMAX_DELAY) == pdTRUE) {
                 // 执行LZ4帧解压缩
-                LZ4F_decompressionContext_t dctx = NULL;
-                LZ4F_errorCode_t errorCode;
-
-                // 创建解压缩上下文
-                errorCode = LZ4F_createDecompressionContext(&dctx, LZ4F_VERSION);
-                if (LZ4F_isError(errorCode)) {
-                    ESP_LOGE(TAG, "LZ4F_createDecompressionContext failed: %s", LZ4F_getErrorName(errorCode));
-                    xSemaphoreGive(s_lz4_mutex);
-                    continue;
-                }
+                LZ4F_dctx *dctx = s_dctx;
 
                 // 设置输入和输出缓冲区
                 LZ4F_decompressOptions_t options = {0};
@@ -217,8 +234,10 @@ static void lz4_decoder_task(void *arg) {
                 size_t dstSize = s_max_decompressed_size;
 
                 // LZ4帧解压缩
+                SYS_TRACE_BEGIN("lz4_decode");
                 size_t result = LZ4F_decompress(dctx, s_decompressed_buffer, &dstSize,
                                                s_compressed_buffer, &srcSize, &options);
+                SYS_TRACE_END("lz4_decode");
 
                 if (LZ4F_isError(result)) {
                     ESP_LOGE(TAG, "LZ4F_decompress failed: %s", LZ4F_getErrorName(result));
@@ -226,8 +245,8 @@ static void lz4_decoder_task(void *arg) {
                     // Python脚本已经发送了BE格式的RGB565数据，直接使用
                     // 不需要字节序转换，因为LVGL配置了LV_COLOR_16_SWAP=1
                     
-                    // 分配显示缓冲区
-                    uint8_t *display_buffer = jpeg_calloc_align(dstSize, 16);
+                    // 从帧缓冲池取显示缓冲区
+                    uint8_t *display_buffer = display_queue_alloc_frame(dstSize);
                     if (display_buffer) {
                         // 直接复制解压缩的数据，无需字节序转换
                         memcpy(display_buffer, s_decompressed_buffer, dstSize);
@@ -242,21 +261,17 @@ static void lz4_decoder_task(void *arg) {
                         };
 
                         // 使用保存的显示队列句柄推送帧
-                        if (s_display_queue) {
-                            if (!display_queue_enqueue(s_display_queue, &frame_msg)) {
-                                ESP_LOGW(TAG, "Display queue full, dropping LZ4 frame");
-                                jpeg_free_align(display_buffer);
-                            }
-                        } else {
-                            jpeg_free_align(display_buffer);
+                        if (!s_display_queue || !display_queue_enqueue(s_display_queue, &frame_msg)) {
+                            ESP_LOGW(TAG, "Display queue full, dropping LZ4 frame");
+                            display_queue_free_frame(&frame_msg);
                         }
                     } else {
                         ESP_LOGE(TAG, "Failed to allocate LZ4 display buffer");
                     }
                 }
 
-                // 清理上下文
-                LZ4F_freeDecompressionContext(dctx);
+                // 复位上下文供下一帧使用 (保留内部缓冲)
+                LZ4F_resetDecompressionContext(dctx);
 
                 // 重置数据缓冲区
                 s_compressed_data_received = 0;
@@ -11,6 +11,7 @@
 #include "freertos/task.h"
 #include "lwip/netdb.h"
 #include "lwip/sockets.h"
+#include "metrics.h"
 #include <string.h>
 #include <sys/time.h>
 #include <time.h>
@@ -58,6 +59,15 @@ static uint32_t g_tx_packets = 0;
 static uint32_t g_rx_packets = 0;
 static uint32_t g_lost_packets = 0;
 static uint32_t g_retx_packets = 0;
+
+static metrics_desc_t g_udp_metrics[] = {
+    METRICS_REF_INIT("p2p_udp_tx_packets_total", "Image packets sent", METRICS_TYPE_COUNTER, &g_tx_packets),
+    METRICS_REF_INIT("p2p_udp_rx_packets_total", "Image packets received", METRICS_TYPE_COUNTER, &g_rx_packets),
+    METRICS_REF_INIT("p2p_udp_lost_packets_total", "Image packets reported lost (NACK)", METRICS_TYPE_COUNTER,
+                     &g_lost_packets),
+    METRICS_REF_INIT("p2p_udp_retx_packets_total", "Image packets retransmitted", METRICS_TYPE_COUNTER,
+                     &g_retx_packets),
+};
 static float g_current_fps = 0.0f;
 static uint32_t g_fps_frame_count = 0;
 static uint32_t g_fps_last_time = 0;
@@ -134,6 +144,7 @@ esp_err_t p2p_udp_image_transfer_init(p2p_connection_mode_t mode,
         IP_EVENT, ESP_EVENT_ANY_ID, &ip_event_handler, NULL, &g_ip_event_instance));
 
     g_initialized = true;
+    metrics_register_refs(g_udp_metrics, sizeof(g_udp_metrics) / sizeof(g_udp_metrics[0]));
     ESP_LOGI(TAG, "P2P UDP image transfer initialized in %s mode",
              mode == P2P_MODE_AP ? "AP" : "STA");
 
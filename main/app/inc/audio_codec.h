@@ -0,0 +1,152 @@
+/**
+ * @file audio_codec.h
+ * @brief 音频流编解码与分帧
+ *
+ * TCP 音频流 (端口 7557) 的两种形式:
+ *  - 旧格式: 连接建立后直接发送 44.1kHz 单声道 16 位 PCM；
+ *  - 压缩格式: 发送端先发 audio_stream_hello_t 声明支持的编码，接收端回复 audio_stream_ack_t
+ *    选定编码，之后每块为 [audio_block_header_t][负载]。任意块边界可再次发送 hello 重新协商。
+ *
+ * ADPCM 块头携带初始预测值与步长索引，每块可独立解码 (丢块不影响后续块)。
+ * 编码输出须与发送端 others/py_test_demo/test_audio_sender.py 逐字节一致，由 audio_codec_bench.py 在主机上比对。
+ */
+
+#ifndef AUDIO_CODEC_H
+#define AUDIO_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDIO_STREAM_HELLO_MAGIC 0x31445541 // "AUD1"
+#define AUDIO_STREAM_ACK_MAGIC 0x31415541   // "AUA1"
+#define AUDIO_STREAM_VERSION 1
+#define AUDIO_BLOCK_SYNC 0xA55A
+#define AUDIO_BLOCK_MAX_SAMPLES 2048
+#define AUDIO_BLOCK_DEFAULT_SAMPLES 1024 // 44.1kHz 下约 23ms
+
+typedef enum {
+    AUDIO_CODEC_PCM16 = 0,     // 16 位 PCM，不压缩
+    AUDIO_CODEC_IMA_ADPCM = 1, // IMA-ADPCM 4 位，4:1
+    AUDIO_CODEC_ADPCM2 = 2,    // 2 位 ADPCM (IMA 步长表)，8:1，音质较低
+    AUDIO_CODEC_COUNT,
+} audio_codec_id_t;
+
+#define AUDIO_CODEC_MASK(id) (1u << (id))
+#define AUDIO_CODEC_SUPPORTED_MASK                                                                             \
+    (AUDIO_CODEC_MASK(AUDIO_CODEC_PCM16) | AUDIO_CODEC_MASK(AUDIO_CODEC_IMA_ADPCM) |                           \
+     AUDIO_CODEC_MASK(AUDIO_CODEC_ADPCM2))
+
+typedef enum {
+    AUDIO_STREAM_ACK_OK = 0,
+    AUDIO_STREAM_ACK_UNSUPPORTED = 1, // 没有双方都支持的编码
+} audio_stream_ack_status_t;
+
+// 发送端 -> 接收端: 编码协商 (16 字节)
+typedef struct __attribute__((packed)) {
+    uint32_t magic;         // AUDIO_STREAM_HELLO_MAGIC
+    uint8_t version;        // AUDIO_STREAM_VERSION
+    uint8_t codec_mask;     // 发送端支持的编码 (AUDIO_CODEC_MASK)
+    uint8_t preferred;      // 发送端首选编码
+    uint8_t channels;       // 声道数 (仅支持 1)
+    uint32_t sample_rate;   // 采样率
+    uint16_t block_samples; // 每块采样数
+    uint16_t reserved;
+} audio_stream_hello_t;
+
+// 接收端 -> 发送端: 协商结果 (12 字节)
+typedef struct __attribute__((packed)) {
+    uint32_t magic;         // AUDIO_STREAM_ACK_MAGIC
+    uint8_t version;
+    uint8_t codec;          // 选定编码
+    uint8_t status;         // audio_stream_ack_status_t
+    uint8_t reserved;
+    uint16_t block_samples; // 接收端接受的每块采样数
+    uint16_t reserved2;
+} audio_stream_ack_t;
+
+// 音频块头 (14 字节)
+typedef struct __attribute__((packed)) {
+    uint16_t sync;        // AUDIO_BLOCK_SYNC
+    uint8_t codec;        // audio_codec_id_t
+    uint8_t flags;        // 保留
+    uint16_t seq;         // 块序号
+    uint16_t samples;     // 本块采样数
+    int16_t predictor;    // ADPCM 初始预测值
+    uint8_t step_index;   // ADPCM 初始步长索引
+    uint8_t reserved;
+    uint16_t payload_len; // 负载字节数
+} audio_block_header_t;
+
+_Static_assert(sizeof(audio_stream_hello_t) == 16, "audio_stream_hello_t size");
+_Static_assert(sizeof(audio_stream_ack_t) == 12, "audio_stream_ack_t size");
+_Static_assert(sizeof(audio_block_header_t) == 14, "audio_block_header_t size");
+
+typedef struct {
+    int16_t predictor;
+    uint8_t step_index;
+} audio_adpcm_state_t;
+
+/**
+ * @brief 按双方能力选择编码: 首选编码双方都支持时使用首选，否则依次尝试 IMA-ADPCM、ADPCM2、PCM16
+ * @return 选定编码；没有共同编码时返回 AUDIO_CODEC_COUNT
+ */
+audio_codec_id_t audio_codec_negotiate(uint8_t local_mask, uint8_t remote_mask, uint8_t preferred);
+
+/**
+ * @brief 给定采样数的负载字节数
+ */
+size_t audio_codec_payload_size(audio_codec_id_t codec, size_t samples);
+
+/**
+ * @brief IMA-ADPCM 4 位编码，每字节两个采样，先低 4 位
+ * @return 输出字节数
+ */
+size_t audio_adpcm_encode(audio_adpcm_state_t* state, const int16_t* pcm, size_t samples, uint8_t* out);
+
+/**
+ * @brief IMA-ADPCM 4 位解码 (定点)
+ * @return 输出采样数
+ */
+size_t audio_adpcm_decode(audio_adpcm_state_t* state, const uint8_t* in, size_t samples, int16_t* pcm);
+
+/**
+ * @brief 2 位 ADPCM 编码，每字节四个采样，先低位
+ */
+size_t audio_adpcm2_encode(audio_adpcm_state_t* state, const int16_t* pcm, size_t samples, uint8_t* out);
+
+/**
+ * @brief 2 位 ADPCM 解码 (定点)
+ */
+size_t audio_adpcm2_decode(audio_adpcm_state_t* state, const uint8_t* in, size_t samples, int16_t* pcm);
+
+/**
+ * @brief 编码一块 (写入块头与负载)
+ * @param codec 编码
+ * @param state ADPCM 状态，跨块延续 (PCM 忽略)
+ * @param seq 块序号
+ * @param pcm 输入采样
+ * @param samples 采样数 (不超过 AUDIO_BLOCK_MAX_SAMPLES)
+ * @param out 输出，至少 sizeof(audio_block_header_t) + audio_codec_payload_size() 字节
+ * @return 输出总字节数
+ */
+size_t audio_codec_encode_block(audio_codec_id_t codec, audio_adpcm_state_t* state, uint16_t seq,
+                                const int16_t* pcm, size_t samples, uint8_t* out);
+
+/**
+ * @brief 解码一块
+ * @param header 块头
+ * @param payload 负载 (header->payload_len 字节)
+ * @param pcm 输出，至少 header->samples 个采样
+ * @return 解码采样数；块头不合法时返回 0
+ */
+size_t audio_codec_decode_block(const audio_block_header_t* header, const uint8_t* payload, int16_t* pcm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_CODEC_H
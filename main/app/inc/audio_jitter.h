@@ -0,0 +1,177 @@
+/**
+ * @file audio_jitter.h
+ * @brief 音频抖动缓冲
+ *
+ * 网络侧按块写入 (带序号与采样时间戳，可乱序)，播放侧按固定采样数读取:
+ *  - 块按序号放入槽位，播放到缺失块且后续块已到达时做丢包隐藏；
+ *  - 目标深度 (播放延迟) 随到达抖动、近期最大相对延迟与欠载次数自适应，在 [min_delay_ms, max_delay_ms] 内；
+ *  - 由传输延迟基线 (到达时间减采样时间的窗口最小值) 的斜率估计发送端与本地时钟的漂移，加上缓冲深度
+ *    与目标偏差的比例修正得到重采样比 (±max_drift_ppm)，由定点线性插值重采样器执行，
+ *    稳态下缓冲深度不随时间增长或耗尽；
+ *  - 欠载时输出逐渐衰减的隐藏信号后转为静音，重新缓冲到目标深度再恢复播放。
+ *
+ * 本模块不加锁，写入与读取在不同任务时由调用者互斥。
+ * 各类网络抖动、丢包与时钟漂移场景的主机仿真见 others/py_test_demo/audio_jitter_sim.py。
+ */
+
+#ifndef AUDIO_JITTER_H
+#define AUDIO_JITTER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDIO_JITTER_MAX_SLOTS 64         // 槽位数上限
+#define AUDIO_JITTER_HISTORY_SAMPLES 1024 // 丢包隐藏使用的历史采样
+#define AUDIO_JITTER_UNDERRUN_BOOST_MS 20 // 每次欠载增加的目标延迟
+#define AUDIO_JITTER_BOOST_DECAY_MS 1     // 增加量每秒衰减
+#define AUDIO_JITTER_TARGET_FALL_MS 1     // 目标延迟每秒最多下降
+
+typedef struct {
+    uint32_t sample_rate;
+    uint16_t max_block_samples; // 单块最大采样数，也是单次读取的上限
+    uint16_t slot_count;        // 槽位数 (2 的幂，不超过 AUDIO_JITTER_MAX_SLOTS)
+    uint16_t min_delay_ms;      // 目标延迟下限
+    uint16_t max_delay_ms;      // 目标延迟上限
+    uint16_t max_drift_ppm;     // 重采样比最大偏离
+} audio_jitter_config_t;
+
+#define AUDIO_JITTER_DEFAULT_CONFIG(rate)                                                                      \
+    {                                                                                                          \
+        .sample_rate = (rate), .max_block_samples = 2048, .slot_count = 32, .min_delay_ms = 40,                \
+        .max_delay_ms = 400, .max_drift_ppm = 2000,                                                            \
+    }
+
+// 外部存储大小 (int16_t 个数)，由调用者分配 (可放 PSRAM)
+#define AUDIO_JITTER_STORAGE_SAMPLES(cfg)                                                                      \
+    ((size_t)(cfg)->slot_count * (cfg)->max_block_samples + 4u * (cfg)->max_block_samples +                    \
+     AUDIO_JITTER_HISTORY_SAMPLES)
+
+typedef enum {
+    AUDIO_JITTER_IDLE = 0,  // 尚未收到数据，输出静音
+    AUDIO_JITTER_BUFFERING, // 缓冲到目标深度前输出静音
+    AUDIO_JITTER_PLAYING,
+} audio_jitter_state_t;
+
+typedef struct {
+    audio_jitter_state_t state;
+    uint32_t depth_samples;    // 当前缓冲深度
+    float depth_ms;            // 当前缓冲深度 (即播放延迟，不含 I2S DMA)
+    float target_ms;           // 目标延迟
+    float jitter_ms;           // 到达抖动估计
+    float peak_delay_ms;       // 近期最大相对延迟 (突发停顿)
+    int32_t drift_ppm;         // 时钟漂移估计 (正值表示发送端较快)
+    int32_t resample_ppm;      // 当前重采样偏离 (漂移 + 深度修正，正值表示加快消耗)
+    uint32_t received_blocks;  // 写入的块
+    uint32_t late_blocks;      // 晚于播放点到达而丢弃的块
+    uint32_t concealed_blocks; // 丢包隐藏生成的块
+    uint32_t underruns;        // 欠载次数
+    uint32_t overflow_resets;  // 序号跳变超出缓冲范围而重置的次数
+} audio_jitter_stats_t;
+
+typedef struct {
+    audio_jitter_config_t cfg;
+    audio_jitter_state_t state;
+
+    // 乱序缓冲: 块按 seq % slot_count 存放
+    int16_t* slot_data;
+    uint16_t slot_seq[AUDIO_JITTER_MAX_SLOTS];
+    uint16_t slot_len[AUDIO_JITTER_MAX_SLOTS];
+    bool slot_valid[AUDIO_JITTER_MAX_SLOTS];
+    bool started;
+    uint16_t play_seq;         // 下一个进入播放的块序号
+    uint16_t end_seq;          // 已到达的最新块序号 + 1
+    uint32_t buffered_samples; // 槽位中的采样数
+    uint32_t buffered_blocks;  // 槽位中的块数
+    uint16_t last_block_samples;
+
+    // 连续采样队列 (重采样器输入)
+    int16_t* fifo;
+    uint32_t fifo_cap;
+    uint32_t fifo_read;
+    uint32_t fifo_count;
+    uint32_t phase; // 重采样小数相位 (Q32)
+
+    // 丢包隐藏
+    int16_t* history;       // 最近写入队列的真实采样
+    uint32_t plc_run;       // 连续隐藏的块数
+    uint32_t plc_period;    // 重复周期 (基音估计)
+    uint32_t plc_pos;
+    int32_t last_gain_q15;  // 最近输出块末尾的增益
+
+    // 抖动估计与自适应目标
+    bool have_arrival;
+    int64_t last_arrival_us;
+    uint32_t last_timestamp;
+    int64_t media_samples;   // 累计采样数 (换算为时间时不累积取整误差)
+    float jitter_us;
+    int64_t window_start_us; // 相对延迟统计窗口 (两个窗口滚动)
+    uint32_t windows;        // 已完成的窗口数
+    int64_t base_min_us[2];  // 到达时间 - 采样时间 的最小值 (传输延迟基线)
+    int64_t peak_us[2];      // 相对基线的最大延迟
+    float boost_ms;
+    float target_ms;      // 当前目标 (上升立即生效，下降按 AUDIO_JITTER_TARGET_FALL_MS 缓慢回落)
+    float target_samples;
+
+    // 漂移控制
+    float err_avg;
+    float drift;   // 时钟漂移估计 (比例，正值表示发送端较快)
+    float ratio;
+
+    audio_jitter_stats_t stats;
+} audio_jitter_t;
+
+/**
+ * @brief 初始化
+ * @param jb 抖动缓冲
+ * @param cfg 配置
+ * @param storage 外部存储，至少 AUDIO_JITTER_STORAGE_SAMPLES(cfg) 个采样
+ * @return false 配置不合法
+ */
+bool audio_jitter_init(audio_jitter_t* jb, const audio_jitter_config_t* cfg, int16_t* storage);
+
+/**
+ * @brief 清空并回到 IDLE (新连接或采样率变化)
+ * @param sample_rate 新采样率，0 保持不变
+ */
+void audio_jitter_reset(audio_jitter_t* jb, uint32_t sample_rate);
+
+/**
+ * @brief 修改目标延迟范围 (如低延迟通话流使用更小的下限)，下次更新目标时生效
+ */
+void audio_jitter_set_delay_range(audio_jitter_t* jb, uint16_t min_delay_ms, uint16_t max_delay_ms);
+
+/**
+ * @brief 写入一块解码后的采样
+ * @param seq 块序号
+ * @param timestamp 首个采样的时间戳 (采样为单位)，用于抖动估计
+ * @param pcm 采样
+ * @param samples 采样数 (不超过 max_block_samples)
+ * @param arrival_us 到达时间
+ * @return false 块被丢弃 (迟到/重复/参数错误)
+ */
+bool audio_jitter_push(audio_jitter_t* jb, uint16_t seq, uint32_t timestamp, const int16_t* pcm, size_t samples,
+                       int64_t arrival_us);
+
+/**
+ * @brief 读取播放采样，总是填满 samples 个 (缓冲中或欠载时为静音/隐藏信号)
+ * @param samples 采样数 (不超过 max_block_samples)
+ */
+void audio_jitter_pull(audio_jitter_t* jb, int16_t* out, size_t samples);
+
+/**
+ * @brief 缓冲深度已超过目标一块以上 (可靠传输的接收端据此暂停读取，形成反压)
+ */
+bool audio_jitter_is_full(const audio_jitter_t* jb);
+
+void audio_jitter_get_stats(const audio_jitter_t* jb, audio_jitter_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_JITTER_H
@@ -0,0 +1,162 @@
+/**
+ * @file audio_mixer.h
+ * @brief 多音源混音与采样率转换 (定点)
+ *
+ * 播放任务每次以 DMA 块长度调用 audio_mixer_render:
+ *  - 每个音源通过拉取回调按自身采样率提供 PCM (网络流、游戏音效、提示音等)；
+ *  - 采样率与输出不同的音源经多相重采样器转换: 32 抽头 Kaiser 窗 sinc，32 个相位，
+ *    相邻相位线性插值，任意采样率比 (输入不超过输出的 4 倍)，降采样时截止频率随比例降低；
+ *  - 各音源乘以 Q12 增益后累加到 32 位，乘主增益后饱和到 16 位；
+ *  - 拉取回调返回的采样数不足时其余补零，一次性音源 (AUDIO_MIXER_ONESHOT) 随即自动移除。
+ *
+ * 本模块不加锁，渲染与增删音源在不同任务时由调用者互斥。
+ * 重采样精度与渲染耗时: others/py_test_demo/audio_mixer_bench.py。
+ */
+
+#ifndef AUDIO_MIXER_H
+#define AUDIO_MIXER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDIO_MIXER_MAX_SOURCES 4
+#define AUDIO_MIXER_MAX_FRAMES 256     // 单次渲染的最大采样数
+#define AUDIO_MIXER_GAIN_UNITY 4096    // Q12 增益 1.0
+#define AUDIO_MIXER_GAIN_MAX (4 * AUDIO_MIXER_GAIN_UNITY)
+#define AUDIO_RESAMPLER_TAPS 32
+#define AUDIO_RESAMPLER_PHASES 32      // 2 的幂
+#define AUDIO_RESAMPLER_MAX_RATIO 4    // 输入采样率 / 输出采样率上限
+#define AUDIO_RESAMPLER_BUF_SAMPLES (2 * AUDIO_RESAMPLER_TAPS + AUDIO_MIXER_MAX_FRAMES * AUDIO_RESAMPLER_MAX_RATIO)
+#define AUDIO_TONE_MAX_NOTES 8
+
+/**
+ * @brief 音源拉取回调
+ * @param samples 请求的采样数 (音源采样率)
+ * @return 实际写入的采样数；少于请求表示音源暂时无数据或已结束
+ */
+typedef size_t (*audio_mixer_pull_t)(void* ctx, int16_t* pcm, size_t samples);
+
+typedef struct {
+    uint32_t in_rate;
+    uint32_t out_rate;
+    uint32_t step_int;      // 每个输出采样前进的输入采样数 (整数部分)
+    uint32_t step_frac;     // 小数部分 (Q32)
+    uint32_t frac;          // 当前位置的小数部分 (Q32)
+    uint16_t start;         // buf 中当前窗口起点
+    uint16_t filled;        // buf 中有效采样数
+    int16_t coeffs[(AUDIO_RESAMPLER_PHASES + 1) * AUDIO_RESAMPLER_TAPS]; // Q15，每个相位直流增益 1
+    int16_t buf[AUDIO_RESAMPLER_BUF_SAMPLES];
+} audio_resampler_t;
+
+typedef enum {
+    AUDIO_MIXER_STREAM = 0, // 持续音源，数据不足时补零
+    AUDIO_MIXER_ONESHOT,    // 数据不足时视为结束并移除
+} audio_mixer_source_type_t;
+
+typedef struct {
+    bool active;
+    bool passthrough;       // 采样率与输出相同，不经重采样
+    audio_mixer_source_type_t type;
+    uint16_t gain_q12;
+    audio_mixer_pull_t pull;
+    void* ctx;
+    uint32_t underruns;     // 持续音源数据不足次数
+    audio_resampler_t rs;
+} audio_mixer_source_t;
+
+typedef struct {
+    uint32_t out_rate;
+    uint16_t master_gain_q12;
+    uint32_t clipped_samples; // 饱和的输出采样数
+    audio_mixer_source_t sources[AUDIO_MIXER_MAX_SOURCES];
+    int32_t acc[AUDIO_MIXER_MAX_FRAMES];
+    int16_t in[AUDIO_RESAMPLER_BUF_SAMPLES];
+    int16_t tmp[AUDIO_MIXER_MAX_FRAMES];
+} audio_mixer_t;
+
+typedef struct {
+    uint16_t freq_hz;       // 0 为静音
+    uint16_t duration_ms;
+} audio_tone_note_t;
+
+// 提示音/音效发生器 (正弦，带 5ms 起止淡入淡出)，作为一次性音源使用
+typedef struct {
+    uint32_t sample_rate;
+    int16_t amplitude;
+    uint8_t note_count;
+    uint8_t note;           // 当前音符
+    uint32_t note_pos;      // 当前音符已输出的采样数
+    uint32_t note_len;      // 当前音符的采样数
+    uint32_t phase;         // Q32 相位
+    uint32_t phase_step;
+    audio_tone_note_t notes[AUDIO_TONE_MAX_NOTES];
+} audio_tone_t;
+
+/**
+ * @brief 重采样器初始化
+ * @return false 采样率为 0 或比例超过 AUDIO_RESAMPLER_MAX_RATIO
+ */
+bool audio_resampler_init(audio_resampler_t* rs, uint32_t in_rate, uint32_t out_rate);
+
+/** @brief 清空历史 (保留滤波器) */
+void audio_resampler_reset(audio_resampler_t* rs);
+
+/** @brief 输出 frames 个采样还需要的输入采样数 */
+size_t audio_resampler_needed(const audio_resampler_t* rs, size_t frames);
+
+/**
+ * @brief 重采样
+ * @param in audio_resampler_needed(rs, frames) 个输入采样
+ * @param frames 输出采样数 (不超过 AUDIO_MIXER_MAX_FRAMES)
+ */
+void audio_resampler_process(audio_resampler_t* rs, const int16_t* in, size_t in_samples, int16_t* out,
+                             size_t frames);
+
+void audio_mixer_init(audio_mixer_t* mixer, uint32_t out_rate);
+
+/**
+ * @brief 添加音源
+ * @param gain_q12 增益 (AUDIO_MIXER_GAIN_UNITY 为 1.0，不超过 AUDIO_MIXER_GAIN_MAX)
+ * @return 音源编号；没有空位或采样率不支持时返回 -1
+ */
+int audio_mixer_add_source(audio_mixer_t* mixer, uint32_t rate, audio_mixer_source_type_t type,
+                           audio_mixer_pull_t pull, void* ctx, uint16_t gain_q12);
+
+void audio_mixer_remove_source(audio_mixer_t* mixer, int id);
+
+/** @brief 修改音源采样率 (重新设计滤波器并清空历史) */
+bool audio_mixer_set_source_rate(audio_mixer_t* mixer, int id, uint32_t rate);
+
+void audio_mixer_set_gain(audio_mixer_t* mixer, int id, uint16_t gain_q12);
+void audio_mixer_set_master_gain(audio_mixer_t* mixer, uint16_t gain_q12);
+
+/** @brief 音源是否仍在播放 (一次性音源结束后为 false) */
+bool audio_mixer_source_active(const audio_mixer_t* mixer, int id);
+
+/**
+ * @brief 渲染一个 DMA 块: 拉取、重采样、混音、饱和
+ * @param frames 输出采样数 (不超过 AUDIO_MIXER_MAX_FRAMES)
+ */
+void audio_mixer_render(audio_mixer_t* mixer, int16_t* out, size_t frames);
+
+/**
+ * @brief 提示音初始化
+ * @param amplitude 峰值幅度
+ * @return false 音符数为 0 或超过 AUDIO_TONE_MAX_NOTES
+ */
+bool audio_tone_init(audio_tone_t* tone, uint32_t sample_rate, const audio_tone_note_t* notes, size_t count,
+                     int16_t amplitude);
+
+/** @brief audio_mixer_pull_t 形式的提示音拉取 (ctx 为 audio_tone_t*) */
+size_t audio_tone_pull(void* ctx, int16_t* pcm, size_t samples);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_MIXER_H
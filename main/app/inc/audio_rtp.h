@@ -0,0 +1,65 @@
+/**
+ * @file audio_rtp.h
+ * @brief UDP 音频包 (RTP 格式) 打包与解析
+ *
+ * UDP 音频流 (端口与 TCP 相同，7557) 面向低延迟通话:
+ *  - 可选先发送 audio_stream_hello_t 数据报声明采样率与编码，接收端回复 audio_stream_ack_t；
+ *    未发送 hello 时按 44.1kHz 处理；
+ *  - 每个数据报为 [RTP 固定头 12 字节][负载头 4 字节][负载]，RTP 头为网络字节序，
+ *    负载类型为动态类型 AUDIO_RTP_PT_BASE + audio_codec_id_t；
+ *  - 负载头携带 ADPCM 初始预测值与步长索引 (与 RFC 3551 DVI4 相同的布局)，每包可独立解码；
+ *  - 采样数由负载长度推算，ADPCM 包的采样数需为 4 的倍数 (负载无填充)；
+ *  - 每包 5~10ms 音频 (44.1kHz 下 220 或 440 个采样)，SSRC 变化视为新的流。
+ *
+ * others/py_test_demo/audio_udp_loopback.py 经本机 UDP 回环 (带丢包与乱序) 测试打包到播放的整条接收链路。
+ */
+
+#ifndef AUDIO_RTP_H
+#define AUDIO_RTP_H
+
+#include "audio_codec.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDIO_RTP_VERSION 2
+#define AUDIO_RTP_PT_BASE 96          // 动态负载类型: 96 PCM16 (小端)，97 IMA-ADPCM，98 ADPCM2
+#define AUDIO_RTP_HEADER_SIZE 12
+#define AUDIO_RTP_PAYLOAD_HEADER_SIZE 4
+#define AUDIO_RTP_MAX_SAMPLES 960     // 单包采样数上限 (48kHz 下 20ms)
+#define AUDIO_RTP_MAX_PACKET (AUDIO_RTP_HEADER_SIZE + AUDIO_RTP_PAYLOAD_HEADER_SIZE + AUDIO_RTP_MAX_SAMPLES * 2)
+
+typedef struct {
+    uint16_t seq;
+    uint32_t timestamp; // 首个采样的时间戳 (采样为单位)
+    uint32_t ssrc;
+    bool marker;        // 流或讲话段的第一个包
+    audio_block_header_t block; // 转换后的块头，交给 audio_codec_decode_block 解码
+    const uint8_t* payload;     // 指向数据报内的负载
+} audio_rtp_packet_t;
+
+/**
+ * @brief 编码一包
+ * @param state ADPCM 状态，跨包延续 (PCM 忽略)
+ * @param samples 采样数 (不超过 AUDIO_RTP_MAX_SAMPLES，ADPCM 时为 4 的倍数)
+ * @param out 输出，至少 AUDIO_RTP_MAX_PACKET 字节
+ * @return 数据报字节数；参数不合法时返回 0
+ */
+size_t audio_rtp_encode(audio_codec_id_t codec, audio_adpcm_state_t* state, uint16_t seq, uint32_t timestamp,
+                        uint32_t ssrc, bool marker, const int16_t* pcm, size_t samples, uint8_t* out);
+
+/**
+ * @brief 解析数据报
+ * @return false 不是本格式的音频包 (版本、负载类型或长度不符)
+ */
+bool audio_rtp_parse(const uint8_t* packet, size_t len, audio_rtp_packet_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_RTP_H
@@ -0,0 +1,64 @@
+/**
+ * @file lv_profiler.h
+ * @brief LVGL 逐帧渲染分析 - 渲染/刷屏耗时、重绘面积、最慢页面与控件，屏幕浮层显示并通过 TCP 输出 CSV
+ *
+ * 帧: 一次 lv_timer_handler 调用中发生了重绘即记为一帧。
+ *  - render: 渲染耗时 (刷新过程减去 flush_cb 内排队与等待上一块发送的时间)；
+ *  - flush : flush_cb 内耗时 + 等待上一块发送结束的时间 (LVGL 被刷屏阻塞的部分)；
+ *  - xfer  : SPI 实际传输时间 (与渲染并行)；
+ *  - other : lv_timer_handler 中其余时间，即各页面定时器与布局更新。
+ * 控件耗时来自各对象 LV_EVENT_DRAW_MAIN_BEGIN ~ DRAW_MAIN_END 之间的时间 (不含子对象)，
+ * 只在浮层或数据流开启时给当前页面的对象挂上事件，关闭后移除。
+ *
+ * TCP 数据流 (每行一条记录，'#' 开头为注释):
+ *   F,frame,t_ms,screen,handler_us,render_us,flush_us,xfer_us,other_us,px,areas
+ *   W,screen,class,obj,draws,avg_us,max_us        (每秒一次，最慢的若干控件)
+ */
+
+#ifndef LV_PROFILER_H
+#define LV_PROFILER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define LV_PROFILER_STREAM_PORT 7560 // CSV 数据流默认端口
+
+/**
+ * @brief 初始化 (LVGL 任务中，lv_port_disp_init 之后调用)
+ */
+esp_err_t lv_profiler_init(void);
+
+/**
+ * @brief 包在 lv_timer_handler 前后调用
+ */
+void lv_profiler_frame_begin(void);
+void lv_profiler_frame_end(void);
+
+/**
+ * @brief 显示/隐藏屏幕右上角的统计浮层 (LVGL 任务中调用)
+ */
+void lv_profiler_set_overlay(bool show);
+bool lv_profiler_overlay_visible(void);
+
+/**
+ * @brief 启动/停止 CSV 数据流 TCP 服务 (单客户端)
+ */
+esp_err_t lv_profiler_stream_start(uint16_t port);
+void lv_profiler_stream_stop(void);
+bool lv_profiler_stream_running(void);
+
+/**
+ * @brief 把各页面与最慢控件的累计统计打印到日志 (LVGL 任务中调用)
+ */
+void lv_profiler_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LV_PROFILER_H
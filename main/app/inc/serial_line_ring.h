@@ -0,0 +1,83 @@
+/**
+ * @file serial_line_ring.h
+ * @brief 远程串口文本行环形缓冲 (单生产者/单消费者，无锁)
+ *
+ * 生产者 (TCP 接收任务) 按 '\n' / '\r' 把字节流切成行写入，消费者 (LVGL 定时器) 按行取出:
+ *  - 变长记录 [uint16 长度][文本][NUL]，4 字节对齐，尾部放不下时写回绕标记从头开始；
+ *  - 每次 serial_line_ring_write 结束时才发布一次写位置，一个 TCP 数据块只有一次原子写；
+ *  - 跨数据块的半行暂存在生产者私有缓冲中，遇到换行、超过 SERIAL_LINE_RING_LINE_MAX
+ *    (折成下一行) 或 serial_line_ring_flush 时提交；空行丢弃；
+ *  - 缓冲满时丢弃新行并计数，生产者从不等待消费者；
+ *  - 消费者积压过多时可用 serial_line_ring_skip 只跳过记录头，不复制文本。
+ *
+ * 并发读写与吞吐的主机测试: others/py_test_demo/serial_line_ring_bench.py。
+ */
+
+#ifndef SERIAL_LINE_RING_H
+#define SERIAL_LINE_RING_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SERIAL_LINE_RING_LINE_MAX 255 // 单行最大字节数 (含时间戳前缀，不含 NUL)
+
+typedef struct {
+    char* buf;
+    uint32_t size;                  // 2 的幂，字节
+    atomic_uint head;               // 生产者已发布的写位置 (单调递增)
+    atomic_uint tail;               // 消费者读位置 (单调递增)
+    atomic_uint lines_written;
+    atomic_uint dropped;            // 缓冲满丢弃的行数
+    atomic_uint bytes_in;           // 写入的原始字节数
+    uint32_t lines_read;            // 仅消费者访问
+    uint16_t partial_len;           // 以下仅生产者访问
+    bool partial_body;              // 半行已有正文 (不只是前缀)
+    bool folded;                    // 上一行因超长折行，下一行为续行
+    char partial[SERIAL_LINE_RING_LINE_MAX + 1];
+} serial_line_ring_t;
+
+/**
+ * @brief 初始化 (不得与读写并发)
+ * @param buf 缓冲区，至少 size 字节，4 字节对齐
+ * @param size 2 的幂，不小于 1024
+ * @return false 参数无效
+ */
+bool serial_line_ring_init(serial_line_ring_t* ring, void* buf, uint32_t size);
+
+/**
+ * @brief 生产者: 写入字节流
+ * @param prefix 每个新行开头插入的前缀 (如时间戳)，可为 NULL；折行产生的续行不加前缀
+ * @return 本次提交的行数
+ */
+size_t serial_line_ring_write(serial_line_ring_t* ring, const char* data, size_t len, const char* prefix);
+
+/** @brief 生产者: 提交未以换行结束的半行 (如连接关闭时) */
+void serial_line_ring_flush(serial_line_ring_t* ring);
+
+/** @brief 消费者: 已发布但未读取的行数 */
+uint32_t serial_line_ring_pending(const serial_line_ring_t* ring);
+
+/**
+ * @brief 消费者: 查看最早的一行 (不移除)
+ * @param len 输出行长度
+ * @return 以 NUL 结尾的行，在 serial_line_ring_pop 前有效；没有数据时返回 NULL
+ */
+const char* serial_line_ring_peek(serial_line_ring_t* ring, uint16_t* len);
+
+/** @brief 消费者: 移除 serial_line_ring_peek 返回的行 */
+void serial_line_ring_pop(serial_line_ring_t* ring);
+
+/** @brief 消费者: 跳过最多 lines 行，返回实际跳过的行数 */
+uint32_t serial_line_ring_skip(serial_line_ring_t* ring, uint32_t lines);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SERIAL_LINE_RING_H
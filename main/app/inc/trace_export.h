@@ -0,0 +1,44 @@
+/**
+ * @file trace_export.h
+ * @brief 事件追踪导出 - 通过 TCP 或控制台 (USB-Serial-JTAG) 输出 Chrome trace JSON
+ *
+ * TCP 协议 (单客户端):
+ *  - 连上后不发送任何内容: 导出环中现有的事件 (最近一段时间)；
+ *  - 连上后 300ms 内发送 "capture <ms>\n": 清空、记录指定毫秒数后导出。
+ * 导出完成后服务端关闭连接，例如:
+ *   echo "capture 2000" | nc <ip> 7561 > trace.json
+ */
+
+#ifndef TRACE_EXPORT_H
+#define TRACE_EXPORT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+#define TRACE_EXPORT_PORT 7561         // 默认导出端口
+#define TRACE_EXPORT_MAX_CAPTURE_MS 10000 // capture 命令允许的最长记录时间
+
+/**
+ * @brief 启动/停止 TCP 导出服务 (需在网络协议栈初始化之后)
+ */
+esp_err_t trace_export_start(uint16_t port);
+void trace_export_stop(void);
+bool trace_export_is_running(void);
+
+/**
+ * @brief 把当前事件以 JSON 写到标准输出 (USB-Serial-JTAG 控制台)
+ *
+ * 输出以 "--- sys_trace begin ---" / "--- sys_trace end ---" 两行包围，便于从日志中截取。
+ */
+esp_err_t trace_export_dump_console(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TRACE_EXPORT_H
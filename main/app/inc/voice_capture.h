@@ -0,0 +1,82 @@
+/**
+ * @file voice_capture.h
+ * @brief 麦克风上行: I2S TDM 麦克风时隙 -> 语音处理链 -> IMA-ADPCM -> UDP (RTP 格式)
+ *
+ * 与播放全双工运行:
+ *  - 采集任务固定在 APP 核 (核 1)，以 I2S 时钟节奏按帧读取麦克风 DMA 数据；
+ *  - 播放任务把写给扬声器的 PCM 送入参考 FIFO (voice_capture_feed_reference)，
+ *    采集任务按相同采样数取出作为回声消除参考 (同一 I2S 时钟，无漂移)；
+ *    FIFO 溢出/欠载 (任务被长时间阻塞) 时重新对齐并重置回声消除；
+ *  - 处理链见 voice_dsp.h，上行采样率为 I2S 采样率抽取后的 14.7/16kHz；
+ *  - 有对端时 (UDP 下行流的来源地址与端口) 每帧发送一个 audio_rtp 包，
+ *    并每秒发送一次 audio_stream_hello_t 声明采样率、编码与每包采样数。
+ */
+
+#ifndef VOICE_CAPTURE_H
+#define VOICE_CAPTURE_H
+
+#include "esp_err.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct sockaddr_in;
+
+typedef struct {
+    bool running;
+    bool streaming;           // 有对端，正在发送
+    bool aec_enabled;
+    uint32_t sample_rate;     // 上行语音采样率
+    uint16_t frame_samples;   // 每包采样数
+    uint32_t frames;          // 已处理帧数
+    uint32_t packets;         // 已发送包数
+    uint32_t send_errors;
+    uint32_t ref_overruns;    // 参考 FIFO 溢出次数
+    uint32_t ref_underruns;   // 参考 FIFO 欠载次数
+    uint32_t process_us_avg;  // 处理链单帧耗时 (平均 / 最大)
+    uint32_t process_us_max;
+    float erle_db;
+    float agc_gain_db;
+    float level_dbfs;
+    uint32_t double_talk_frames;
+} voice_capture_stats_t;
+
+/**
+ * @brief 启动采集任务 (需在 I2S TDM 启动之后调用)
+ * @return ESP_OK 成功
+ */
+esp_err_t voice_capture_start(void);
+
+/**
+ * @brief 停止采集任务 (需在 I2S TDM 停止之前调用，否则读取会一直阻塞)
+ */
+void voice_capture_stop(void);
+
+/**
+ * @brief 设置上行对端
+ * @param peer 对端地址与端口；NULL 停止发送
+ */
+void voice_capture_set_peer(const struct sockaddr_in* peer);
+
+/**
+ * @brief 启用/禁用回声消除 (默认启用)
+ */
+void voice_capture_set_aec(bool enable);
+
+/**
+ * @brief 写入扬声器参考信号 (播放任务在每次 I2S 写入前调用)
+ * @param pcm I2S 采样率下的单声道 PCM
+ */
+void voice_capture_feed_reference(const int16_t* pcm, size_t samples);
+
+void voice_capture_get_stats(voice_capture_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VOICE_CAPTURE_H
@@ -0,0 +1,167 @@
+/**
+ * @file voice_dsp.h
+ * @brief 麦克风上行语音处理链 (定点)
+ *
+ * 每帧 (约 10ms) 依次处理:
+ *   抽取 (I2S 采样率 -> 语音采样率) -> 高通 -> 回声消除 (可选) -> AGC
+ *  - 抽取: 对称 FIR 低通，只计算保留的输出点；麦克风与播放参考各用一个抽取器；
+ *  - 高通: 二阶 Butterworth，Q28 系数，状态保留 8 位小数，滤除直流与低频噪声；
+ *  - 回声消除: NLMS 自适应 FIR，参考为同一 I2S 时钟下写给扬声器的信号，
+ *    Geigel 双讲检测期间与远端静音时冻结更新；前景/背景双滤波器，漏检的双讲只影响背景；
+ *  - AGC: 帧 RMS 包络快攻慢放，噪声门限以下不再提升增益，帧内线性插值增益并按峰值限幅。
+ * 内层循环按整帧处理、无分支、数据连续，便于编译器展开与向量化 (递归的高通除外)，
+ * 向量化与标量编译的对比见 others/py_test_demo/voice_dsp_bench.py。
+ */
+
+#ifndef VOICE_DSP_H
+#define VOICE_DSP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define VOICE_DSP_MAX_DECIM 3          // 44.1/48kHz -> 14.7/16kHz
+#define VOICE_DSP_DECIM_TAPS 48        // 抽取低通阶数
+#define VOICE_DSP_FRAME_MAX 160        // 语音采样率下每帧最多采样数 (16kHz 10ms)
+#define VOICE_DSP_HPF_CUTOFF_HZ 120
+#define VOICE_AEC_MAX_TAPS 512
+#define VOICE_AEC_DEFAULT_TAPS 256     // 14.7kHz 下约 17ms 回声尾长
+#define VOICE_AEC_STORAGE_BYTES(taps) ((size_t)(taps) * (sizeof(int32_t) + 4 * sizeof(int16_t)))
+
+typedef struct {
+    uint8_t factor;
+    int16_t coeffs[VOICE_DSP_DECIM_TAPS];  // Q15，直流增益 1
+    int16_t hist[VOICE_DSP_DECIM_TAPS - 1 + VOICE_DSP_FRAME_MAX * VOICE_DSP_MAX_DECIM];
+} voice_decimator_t;
+
+typedef struct {
+    int32_t b0, b1, b2, a1, a2; // Q28
+    int32_t x1, x2;             // 输入历史
+    int32_t y1, y2;             // 输出历史 (8 位小数)
+} voice_hpf_t;
+
+typedef struct {
+    int32_t target_rms;
+    int32_t gate_rms;           // 包络低于此值视为噪声，不再提升增益
+    int32_t max_gain_q16;
+    int32_t gain_q16;
+    int32_t level;              // RMS 包络
+} voice_agc_t;
+
+typedef struct {
+    uint16_t taps;
+    uint16_t pos;               // 参考历史最新采样位置
+    int32_t* w;                 // 背景滤波器权重，Q24 (NLMS 更新)
+    int16_t* w16;               // 背景滤波器权重 Q14 副本 (滤波)
+    int16_t* fg16;              // 前景滤波器权重 Q14 (输出)，背景表现更好时整帧拷贝
+    int16_t* x;                 // 参考历史，双写 2*taps，x[pos..pos+taps) 为连续窗口 (新 -> 旧)
+    int64_t energy;             // 窗口内参考能量
+    int32_t mu_q15;             // 步长
+    int32_t far_peak;           // 参考峰值包络 (双讲检测)
+    int32_t dt_ratio_q8;        // 近端超过 far_peak * dt_ratio 判为双讲 (收敛前)，持续双讲超过 1 秒时自动放宽
+    float echo_gain;            // 估计的回声路径增益，收敛后门限收紧为其 2 倍
+    uint32_t dt_score;          // 双讲计分 (双讲帧增加，远端单讲帧减少)
+    uint32_t bg_better_frames;  // 背景连续优于前景的帧数
+    uint32_t hold;              // 双讲保持剩余采样数
+    float echo_energy;          // 平滑后的输入 / 输出帧能量 (ERLE)
+    float out_energy;
+    uint32_t double_talk_frames;
+    uint32_t fg_updates;        // 前景更新次数
+    uint32_t bg_resets;         // 背景发散后从前景恢复的次数
+} voice_aec_t;
+
+typedef struct {
+    uint32_t in_rate;           // I2S 采样率
+    uint32_t rate;              // 语音采样率
+    uint16_t frame_samples;     // 语音采样率下每帧采样数 (4 的倍数，便于 ADPCM 打包)
+    bool aec_enabled;
+    voice_decimator_t mic_dec;
+    voice_decimator_t ref_dec;
+    voice_hpf_t hpf;
+    voice_aec_t aec;
+    voice_agc_t agc;
+    int16_t ref[VOICE_DSP_FRAME_MAX];
+} voice_dsp_t;
+
+typedef struct {
+    uint32_t rate;
+    uint16_t frame_samples;
+    bool aec_enabled;
+    float erle_db;              // 回声抑制量 (输入/输出能量比)
+    float agc_gain_db;
+    float level_dbfs;           // 输入包络
+    uint32_t double_talk_frames;
+    uint32_t aec_bg_resets;
+} voice_dsp_stats_t;
+
+/**
+ * @brief 抽取器初始化
+ * @param factor 1..VOICE_DSP_MAX_DECIM
+ */
+bool voice_decimator_init(voice_decimator_t* dec, uint8_t factor);
+
+/**
+ * @brief 抽取一帧
+ * @param n 输入采样数 (factor 的倍数，不超过 VOICE_DSP_FRAME_MAX * factor)
+ * @return 输出采样数
+ */
+size_t voice_decimator_process(voice_decimator_t* dec, const int16_t* in, size_t n, int16_t* out);
+
+void voice_hpf_init(voice_hpf_t* hpf, uint32_t sample_rate, uint32_t cutoff_hz);
+void voice_hpf_process(voice_hpf_t* hpf, int16_t* pcm, size_t n);
+
+/**
+ * @param target_dbfs 目标 RMS 电平 (如 -18)
+ * @param max_gain_db 最大增益 (如 24)
+ * @param gate_dbfs 噪声门限 (如 -55)
+ */
+void voice_agc_init(voice_agc_t* agc, int target_dbfs, int max_gain_db, int gate_dbfs);
+void voice_agc_process(voice_agc_t* agc, int16_t* pcm, size_t n);
+
+/**
+ * @brief 回声消除初始化
+ * @param taps 滤波器长度 (4 的倍数，不超过 VOICE_AEC_MAX_TAPS)
+ * @param storage VOICE_AEC_STORAGE_BYTES(taps) 字节，4 字节对齐
+ */
+bool voice_aec_init(voice_aec_t* aec, uint16_t taps, void* storage);
+void voice_aec_reset(voice_aec_t* aec);
+
+/**
+ * @brief 从 mic 中减去参考的回声估计 (原地)
+ * @param ref 与 mic 同步的扬声器参考信号
+ */
+void voice_aec_process(voice_aec_t* aec, const int16_t* ref, int16_t* mic, size_t n);
+
+/**
+ * @brief 处理链初始化: 按 I2S 采样率选择抽取倍数与帧长
+ * @param aec_storage VOICE_AEC_STORAGE_BYTES(aec_taps) 字节；NULL 时不支持回声消除
+ */
+bool voice_dsp_init(voice_dsp_t* dsp, uint32_t in_rate, uint16_t aec_taps, void* aec_storage);
+
+/** @brief 清空滤波器状态与回声消除权重 (参考与麦克风失去同步后调用) */
+void voice_dsp_reset(voice_dsp_t* dsp);
+
+/** @brief 每帧需要从 I2S 读取的采样数 (麦克风与参考相同) */
+static inline size_t voice_dsp_input_samples(const voice_dsp_t* dsp) {
+    return (size_t)dsp->frame_samples * dsp->mic_dec.factor;
+}
+
+/**
+ * @brief 处理一帧
+ * @param mic 麦克风，voice_dsp_input_samples() 个采样 (I2S 采样率)
+ * @param ref 扬声器参考，同样长度；NULL 或未启用回声消除时跳过
+ * @param out 输出 frame_samples 个采样 (语音采样率)
+ */
+void voice_dsp_process(voice_dsp_t* dsp, const int16_t* mic, const int16_t* ref, int16_t* out);
+
+void voice_dsp_get_stats(const voice_dsp_t* dsp, voice_dsp_stats_t* stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // VOICE_DSP_H
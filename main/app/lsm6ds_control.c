@@ -57,6 +57,30 @@ static void lsm6ds3_control_task(void* pvParameters) {
     // 等待 2 秒让传感器稳定
     vTaskDelay(pdMS_TO_TICKS(2000));
 
+    // 优先使用 FIFO 模式：416Hz 全速率融合，每次水位线突发读取一次
+    bool use_fifo = (lsm6ds3_fifo_enable(NULL) == ESP_OK);
+    if (!use_fifo) {
+        ESP_LOGW(TAG, "FIFO mode unavailable, falling back to 50Hz polling");
+    }
+
+    while (use_fifo) {
+        lsm6ds3_fifo_wait(100);
+
+        lsm6ds3_euler_t e = {0};
+        ret = lsm6ds3_fifo_read_euler(&e, NULL);
+        if (ret == ESP_OK) {
+            if (xSemaphoreTake(attitude_mutex, portMAX_DELAY) == pdTRUE) {
+                pitch = e.pitch;
+                roll = e.roll;
+                yaw = e.yaw;
+                xSemaphoreGive(attitude_mutex);
+            }
+        } else if (ret != ESP_ERR_NOT_FOUND) {
+            ESP_LOGW(TAG, "Failed to read FIFO: %s", esp_err_to_name(ret));
+            vTaskDelay(pdMS_TO_TICKS(20));
+        }
+    }
+
     while (1) {
         // 【关键修改】使用 lsm6ds3_read_euler()，它内部已经包含：
         // 1. 读取原始数据
@@ -0,0 +1,622 @@
+/**
+ * @file lv_profiler.c
+ * @brief LVGL 逐帧渲染分析 - 统计、屏幕浮层与 CSV 数据流
+ */
+#include "lv_profiler.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "lv_port_disp.h"
+#include "lvgl.h"
+#include "lwip/sockets.h"
+#include "st7789.h"
+#include "ui_state_manager.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char* TAG = "LV_PROFILER";
+
+#define PROF_WIDGET_SLOTS 32        // 控件统计表大小，满了替换累计耗时最少的一项
+#define PROF_WIDGET_TOP 5           // 数据流与日志中列出的最慢控件数
+#define PROF_TICK_MS 500            // 浮层刷新与对象扫描周期
+#define PROF_QUEUE_LEN 64           // 数据流记录队列，客户端跟不上时丢弃并计数
+#define PROF_MARK LV_OBJ_FLAG_USER_4 // 已挂上绘制计时事件的对象
+
+// 数据流记录
+typedef struct {
+    char type; // 'F'
+    uint8_t screen;
+    uint16_t areas;
+    uint32_t frame;
+    uint32_t t_ms;
+    uint32_t handler_us;
+    uint32_t render_us;
+    uint32_t flush_us;
+    uint32_t xfer_us;
+    uint32_t other_us;
+    uint32_t px;
+} prof_frame_rec_t;
+
+typedef struct {
+    char type; // 'W'
+    uint8_t screen;
+    const char* cls;
+    uintptr_t obj;
+    uint32_t draws;
+    uint32_t avg_us;
+    uint32_t max_us;
+} prof_widget_rec_t;
+
+typedef union {
+    char type;
+    prof_frame_rec_t f;
+    prof_widget_rec_t w;
+} prof_rec_t;
+
+typedef struct {
+    uint32_t frames;
+    uint64_t render_us;
+    uint32_t max_render_us;
+    uint64_t other_us;
+    uint64_t px;
+} prof_screen_t;
+
+typedef struct {
+    const lv_obj_t* obj; // 对象删除后置 NULL，统计保留
+    const lv_obj_class_t* cls;
+    uint8_t screen;
+    uint32_t draws;
+    uint64_t total_us;
+    uint32_t max_us;
+} prof_widget_t;
+
+static const char* const s_screen_names[UI_SCREEN_MAX] = {
+    "main_menu", "wifi", "settings", "game", "image", "serial", "calibration", "test", "telemetry",
+};
+
+static bool s_inited = false;
+
+// 当前帧
+static int64_t s_handler_t0 = 0;
+static lv_port_disp_stats_t s_disp0;
+static st7789_async_stats_t s_xfer0;
+static int64_t s_render_t0 = 0;
+static uint32_t s_refr_us = 0;
+static uint32_t s_px = 0;
+static uint16_t s_areas = 0;
+static bool s_refreshed = false;
+static uint32_t s_frame_no = 0;
+static void (*s_prev_render_start_cb)(lv_disp_drv_t*) = NULL;
+static void (*s_prev_monitor_cb)(lv_disp_drv_t*, uint32_t, uint32_t) = NULL;
+
+// 浮层统计窗口 (每次刷新浮层后清零)
+static struct {
+    int64_t t0;
+    uint32_t frames;
+    uint64_t render_us;
+    uint32_t max_render_us;
+    uint64_t flush_us;
+    uint64_t other_us;
+    uint64_t px;
+} s_win;
+
+static prof_screen_t s_screens[UI_SCREEN_MAX];
+static prof_widget_t s_widgets[PROF_WIDGET_SLOTS];
+static const lv_obj_t* s_draw_obj = NULL;
+static int64_t s_draw_t0 = 0;
+static bool s_hooks_on = false;
+
+static lv_obj_t* s_overlay = NULL;
+static lv_timer_t* s_tick_timer = NULL;
+static uint32_t s_ticks = 0;
+
+// 数据流
+static QueueHandle_t s_stream_queue = NULL;
+static TaskHandle_t s_stream_task = NULL;
+static volatile bool s_stream_running = false;
+static volatile bool s_client_connected = false;
+static volatile uint32_t s_stream_dropped = 0;
+
+static uint8_t current_screen(void) {
+    const ui_screen_type_t screen = ui_state_manager_get_current_screen();
+    return screen < UI_SCREEN_MAX ? (uint8_t)screen : UI_SCREEN_MAIN_MENU;
+}
+
+static const char* class_name(const lv_obj_class_t* cls) {
+#if LV_USE_LABEL
+    if (cls == &lv_label_class) return "label";
+#endif
+#if LV_USE_BTN
+    if (cls == &lv_btn_class) return "btn";
+#endif
+#if LV_USE_IMG
+    if (cls == &lv_img_class) return "img";
+#endif
+#if LV_USE_CANVAS
+    if (cls == &lv_canvas_class) return "canvas";
+#endif
+#if LV_USE_ARC
+    if (cls == &lv_arc_class) return "arc";
+#endif
+#if LV_USE_BAR
+    if (cls == &lv_bar_class) return "bar";
+#endif
+#if LV_USE_SWITCH
+    if (cls == &lv_switch_class) return "switch";
+#endif
+#if LV_USE_SPINNER
+    if (cls == &lv_spinner_class) return "spinner";
+#endif
+    if (cls == &lv_obj_class) return "obj";
+    return "widget";
+}
+
+static void queue_record(const prof_rec_t* rec) {
+    if (s_client_connected && xQueueSend(s_stream_queue, rec, 0) != pdTRUE) {
+        s_stream_dropped++;
+    }
+}
+
+// ========================================
+// 控件绘制计时
+// ========================================
+
+static prof_widget_t* widget_slot(const lv_obj_t* obj) {
+    prof_widget_t* victim = &s_widgets[0];
+    for (int i = 0; i < PROF_WIDGET_SLOTS; i++) {
+        prof_widget_t* w = &s_widgets[i];
+        if (w->obj == obj) {
+            return w;
+        }
+        if (w->draws == 0 || (victim->draws != 0 && w->total_us < victim->total_us)) {
+            victim = w;
+        }
+    }
+    memset(victim, 0, sizeof(*victim));
+    victim->obj = obj;
+    victim->cls = lv_obj_get_class(obj);
+    victim->screen = current_screen();
+    return victim;
+}
+
+static void widget_event_cb(lv_event_t* e) {
+    const lv_event_code_t code = lv_event_get_code(e);
+    lv_obj_t* obj = lv_event_get_target(e);
+
+    if (code == LV_EVENT_DRAW_MAIN_BEGIN) {
+        s_draw_obj = obj;
+        s_draw_t0 = esp_timer_get_time();
+    } else if (code == LV_EVENT_DRAW_MAIN_END && s_draw_obj == obj) {
+        const uint32_t dt = (uint32_t)(esp_timer_get_time() - s_draw_t0);
+        prof_widget_t* w = widget_slot(obj);
+        w->draws++;
+        w->total_us += dt;
+        if (dt > w->max_us) w->max_us = dt;
+        s_draw_obj = NULL;
+    } else if (code == LV_EVENT_DELETE) {
+        for (int i = 0; i < PROF_WIDGET_SLOTS; i++) {
+            if (s_widgets[i].obj == obj) s_widgets[i].obj = NULL;
+        }
+    }
+}
+
+static lv_obj_tree_walk_res_t attach_cb(lv_obj_t* obj, void* user_data) {
+    (void)user_data;
+    if (!lv_obj_has_flag(obj, PROF_MARK)) {
+        // BEGIN 预处理，在控件自身绘制之前计时；END 在控件绘制之后
+        lv_obj_add_event_cb(obj, widget_event_cb, LV_EVENT_DRAW_MAIN_BEGIN | LV_EVENT_PREPROCESS, NULL);
+        lv_obj_add_event_cb(obj, widget_event_cb, LV_EVENT_DRAW_MAIN_END, NULL);
+        lv_obj_add_event_cb(obj, widget_event_cb, LV_EVENT_DELETE, NULL);
+        lv_obj_add_flag(obj, PROF_MARK);
+    }
+    return LV_OBJ_TREE_WALK_NEXT;
+}
+
+static lv_obj_tree_walk_res_t detach_cb(lv_obj_t* obj, void* user_data) {
+    (void)user_data;
+    if (lv_obj_has_flag(obj, PROF_MARK)) {
+        while (lv_obj_remove_event_cb(obj, widget_event_cb)) {
+        }
+        lv_obj_clear_flag(obj, PROF_MARK);
+    }
+    return LV_OBJ_TREE_WALK_NEXT;
+}
+
+static void set_hooks(bool on) {
+    if (!on && !s_hooks_on) {
+        return;
+    }
+    // 页面随时新建对象，开启期间每个周期都扫描一次
+    lv_obj_tree_walk(lv_scr_act(), on ? attach_cb : detach_cb, NULL);
+    lv_obj_tree_walk(lv_layer_top(), on ? attach_cb : detach_cb, NULL);
+    s_hooks_on = on;
+    s_draw_obj = NULL;
+}
+
+// ========================================
+// 帧统计
+// ========================================
+
+static void render_start_cb(lv_disp_drv_t* drv) {
+    s_render_t0 = esp_timer_get_time();
+    lv_disp_t* disp = _lv_refr_get_disp_refreshing();
+    for (uint16_t i = 0; disp != NULL && i < disp->inv_p; i++) {
+        s_areas += !disp->inv_area_joined[i];
+    }
+    if (s_prev_render_start_cb) s_prev_render_start_cb(drv);
+}
+
+static void monitor_cb(lv_disp_drv_t* drv, uint32_t time_ms, uint32_t px) {
+    if (s_render_t0 != 0) {
+        s_refr_us += (uint32_t)(esp_timer_get_time() - s_render_t0);
+        s_render_t0 = 0;
+    }
+    s_px += px;
+    s_refreshed = true;
+    if (s_prev_monitor_cb) s_prev_monitor_cb(drv, time_ms, px);
+}
+
+void lv_profiler_frame_begin(void) {
+    if (!s_inited) {
+        return;
+    }
+    s_refreshed = false;
+    s_refr_us = 0;
+    s_px = 0;
+    s_areas = 0;
+    lv_port_disp_get_stats(&s_disp0);
+    st7789_get_async_stats(&s_xfer0);
+    s_handler_t0 = esp_timer_get_time();
+}
+
+void lv_profiler_frame_end(void) {
+    if (!s_inited || !s_refreshed) {
+        return;
+    }
+    const int64_t now = esp_timer_get_time();
+    lv_port_disp_stats_t disp;
+    st7789_async_stats_t xfer;
+    lv_port_disp_get_stats(&disp);
+    st7789_get_async_stats(&xfer);
+
+    const uint32_t handler_us = (uint32_t)(now - s_handler_t0);
+    const uint32_t flush_us = (uint32_t)((disp.flush_call_us - s_disp0.flush_call_us) + (disp.wait_us - s_disp0.wait_us));
+    const uint32_t render_us = s_refr_us > flush_us ? s_refr_us - flush_us : 0;
+    const uint32_t other_us = handler_us > s_refr_us ? handler_us - s_refr_us : 0;
+    const uint8_t screen = current_screen();
+
+    prof_screen_t* sc = &s_screens[screen];
+    sc->frames++;
+    sc->render_us += render_us;
+    sc->other_us += other_us;
+    sc->px += s_px;
+    if (render_us > sc->max_render_us) sc->max_render_us = render_us;
+
+    s_win.frames++;
+    s_win.render_us += render_us;
+    s_win.flush_us += flush_us;
+    s_win.other_us += other_us;
+    s_win.px += s_px;
+    if (render_us > s_win.max_render_us) s_win.max_render_us = render_us;
+
+    const prof_rec_t rec = {.f = {
+                                .type = 'F',
+                                .screen = screen,
+                                .areas = s_areas,
+                                .frame = s_frame_no,
+                                .t_ms = (uint32_t)(now / 1000),
+                                .handler_us = handler_us,
+                                .render_us = render_us,
+                                .flush_us = flush_us,
+                                .xfer_us = (uint32_t)(xfer.xfer_us - s_xfer0.xfer_us),
+                                .other_us = other_us,
+                                .px = s_px,
+                            }};
+    queue_record(&rec);
+    s_frame_no++;
+}
+
+// ========================================
+// 浮层
+// ========================================
+
+static const prof_widget_t* slowest_widget(uint8_t screen) {
+    const prof_widget_t* best = NULL;
+    for (int i = 0; i < PROF_WIDGET_SLOTS; i++) {
+        const prof_widget_t* w = &s_widgets[i];
+        if (w->draws != 0 && w->screen == screen && (best == NULL || w->max_us > best->max_us)) {
+            best = w;
+        }
+    }
+    return best;
+}
+
+static void overlay_update(void) {
+    const int64_t now = esp_timer_get_time();
+    const float secs = (float)(now - s_win.t0) / 1e6f;
+    const uint32_t n = s_win.frames ? s_win.frames : 1;
+    const uint32_t screen_px = (uint32_t)lv_disp_get_hor_res(NULL) * lv_disp_get_ver_res(NULL);
+    const prof_widget_t* w = slowest_widget(current_screen());
+
+    char text[160];
+    int pos = snprintf(text, sizeof(text), "FPS %.0f  R %.1f/%.1fms\nF %.1fms  T %.1fms  A %u%%",
+                       secs > 0 ? s_win.frames / secs : 0.0f, s_win.render_us / 1000.0f / n,
+                       s_win.max_render_us / 1000.0f, s_win.flush_us / 1000.0f / n, s_win.other_us / 1000.0f / n,
+                       (unsigned)(s_win.px * 100 / ((uint64_t)screen_px * n)));
+    if (w != NULL && pos < (int)sizeof(text)) {
+        snprintf(text + pos, sizeof(text) - pos, "\n%s %.2fms", class_name(w->cls), w->max_us / 1000.0f);
+    }
+    lv_label_set_text(s_overlay, text);
+
+    memset(&s_win, 0, sizeof(s_win));
+    s_win.t0 = now;
+}
+
+static void stream_widgets(void) {
+    // 当前页面最慢的若干控件，按单次最大耗时排序
+    bool used[PROF_WIDGET_SLOTS] = {false};
+    const uint8_t screen = current_screen();
+    for (int k = 0; k < PROF_WIDGET_TOP; k++) {
+        int best = -1;
+        for (int i = 0; i < PROF_WIDGET_SLOTS; i++) {
+            const prof_widget_t* w = &s_widgets[i];
+            if (!used[i] && w->draws != 0 && w->screen == screen && (best < 0 || w->max_us > s_widgets[best].max_us)) {
+                best = i;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        used[best] = true;
+        const prof_widget_t* w = &s_widgets[best];
+        const prof_rec_t rec = {.w = {
+                                    .type = 'W',
+                                    .screen = w->screen,
+                                    .cls = class_name(w->cls),
+                                    .obj = (uintptr_t)w->obj,
+                                    .draws = w->draws,
+                                    .avg_us = (uint32_t)(w->total_us / w->draws),
+                                    .max_us = w->max_us,
+                                }};
+        queue_record(&rec);
+    }
+}
+
+static void tick_timer_cb(lv_timer_t* timer) {
+    (void)timer;
+    const bool active = s_overlay != NULL || s_client_connected;
+    set_hooks(active);
+    if (s_overlay != NULL) {
+        overlay_update();
+    }
+    if (s_client_connected && (++s_ticks % 2) == 0) {
+        stream_widgets();
+    }
+}
+
+void lv_profiler_set_overlay(bool show) {
+    if (!s_inited || show == (s_overlay != NULL)) {
+        return;
+    }
+    if (show) {
+        s_overlay = lv_label_create(lv_layer_sys());
+        lv_obj_set_style_text_font(s_overlay, &lv_font_montserrat_12, 0);
+        lv_obj_set_style_text_color(s_overlay, lv_color_white(), 0);
+        lv_obj_set_style_bg_color(s_overlay, lv_color_black(), 0);
+        lv_obj_set_style_bg_opa(s_overlay, LV_OPA_60, 0);
+        lv_obj_set_style_pad_all(s_overlay, 2, 0);
+        lv_obj_align(s_overlay, LV_ALIGN_TOP_RIGHT, 0, 0);
+        lv_obj_clear_flag(s_overlay, LV_OBJ_FLAG_CLICKABLE);
+        lv_label_set_text(s_overlay, "profiling...");
+        memset(&s_win, 0, sizeof(s_win));
+        s_win.t0 = esp_timer_get_time();
+    } else {
+        lv_obj_del(s_overlay);
+        s_overlay = NULL;
+    }
+    tick_timer_cb(NULL);
+    ESP_LOGI(TAG, "Overlay %s", show ? "shown" : "hidden");
+}
+
+bool lv_profiler_overlay_visible(void) { return s_overlay != NULL; }
+
+void lv_profiler_report(void) {
+    ESP_LOGI(TAG, "%-12s %7s %10s %10s %10s %8s", "screen", "frames", "render_avg", "render_max", "other_avg", "area%");
+    const uint32_t screen_px = (uint32_t)lv_disp_get_hor_res(NULL) * lv_disp_get_ver_res(NULL);
+    for (int i = 0; i < UI_SCREEN_MAX; i++) {
+        const prof_screen_t* sc = &s_screens[i];
+        if (sc->frames == 0) continue;
+        ESP_LOGI(TAG, "%-12s %7lu %8.2fms %8.2fms %8.2fms %7u%%", s_screen_names[i], (unsigned long)sc->frames,
+                 sc->render_us / 1000.0f / sc->frames, sc->max_render_us / 1000.0f, sc->other_us / 1000.0f / sc->frames,
+                 (unsigned)(sc->px * 100 / ((uint64_t)screen_px * sc->frames)));
+    }
+    bool used[PROF_WIDGET_SLOTS] = {false};
+    for (int k = 0; k < PROF_WIDGET_TOP; k++) {
+        int best = -1;
+        for (int i = 0; i < PROF_WIDGET_SLOTS; i++) {
+            if (!used[i] && s_widgets[i].draws != 0 &&
+                (best < 0 || s_widgets[i].total_us > s_widgets[best].total_us)) {
+                best = i;
+            }
+        }
+        if (best < 0) break;
+        used[best] = true;
+        const prof_widget_t* w = &s_widgets[best];
+        ESP_LOGI(TAG, "widget %-8s on %-12s draws %lu avg %.2fms max %.2fms total %.1fms", class_name(w->cls),
+                 s_screen_names[w->screen], (unsigned long)w->draws, (float)w->total_us / w->draws / 1000.0f,
+                 w->max_us / 1000.0f, w->total_us / 1000.0f);
+    }
+}
+
+esp_err_t lv_profiler_init(void) {
+    if (s_inited) {
+        return ESP_OK;
+    }
+    lv_disp_t* disp = lv_disp_get_default();
+    if (disp == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    s_stream_queue = xQueueCreate(PROF_QUEUE_LEN, sizeof(prof_rec_t));
+    s_tick_timer = lv_timer_create(tick_timer_cb, PROF_TICK_MS, NULL);
+    if (s_stream_queue == NULL || s_tick_timer == NULL) {
+        ESP_LOGE(TAG, "Failed to create profiler queue/timer");
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_prev_render_start_cb = disp->driver->render_start_cb;
+    s_prev_monitor_cb = disp->driver->monitor_cb;
+    disp->driver->render_start_cb = render_start_cb;
+    disp->driver->monitor_cb = monitor_cb;
+    s_inited = true;
+    ESP_LOGI(TAG, "LVGL profiler ready");
+    return ESP_OK;
+}
+
+// ========================================
+// CSV 数据流
+// ========================================
+
+static int format_record(char* buf, size_t size, const prof_rec_t* rec) {
+    if (rec->type == 'F') {
+        const prof_frame_rec_t* f = &rec->f;
+        return snprintf(buf, size, "F,%lu,%lu,%s,%lu,%lu,%lu,%lu,%lu,%lu,%u\n", (unsigned long)f->frame,
+                        (unsigned long)f->t_ms, s_screen_names[f->screen], (unsigned long)f->handler_us,
+                        (unsigned long)f->render_us, (unsigned long)f->flush_us, (unsigned long)f->xfer_us,
+                        (unsigned long)f->other_us, (unsigned long)f->px, f->areas);
+    }
+    const prof_widget_rec_t* w = &rec->w;
+    return snprintf(buf, size, "W,%s,%s,%08lx,%lu,%lu,%lu\n", s_screen_names[w->screen], w->cls,
+                    (unsigned long)w->obj, (unsigned long)w->draws, (unsigned long)w->avg_us, (unsigned long)w->max_us);
+}
+
+static bool send_all(int sock, const char* data, size_t len) {
+    while (len > 0) {
+        int n = send(sock, data, len, 0);
+        if (n < 0) {
+            return false;
+        }
+        data += n;
+        len -= n;
+    }
+    return true;
+}
+
+static void stream_client(int sock) {
+    static const char header[] = "# lv_profiler v1\n"
+                                 "# F,frame,t_ms,screen,handler_us,render_us,flush_us,xfer_us,other_us,px,areas\n"
+                                 "# W,screen,class,obj,draws,avg_us,max_us\n";
+    char buf[1024];
+    if (!send_all(sock, header, sizeof(header) - 1)) {
+        return;
+    }
+    xQueueReset(s_stream_queue);
+    s_stream_dropped = 0;
+    s_client_connected = true;
+
+    uint32_t reported_drops = 0;
+    while (s_stream_running) {
+        prof_rec_t rec;
+        if (xQueueReceive(s_stream_queue, &rec, pdMS_TO_TICKS(200)) != pdTRUE) {
+            continue;
+        }
+        // 一次取空队列，攒成一个 TCP 包
+        size_t len = 0;
+        do {
+            len += format_record(buf + len, sizeof(buf) - len, &rec);
+        } while (len + 128 < sizeof(buf) && xQueueReceive(s_stream_queue, &rec, 0) == pdTRUE);
+        if (s_stream_dropped != reported_drops && len + 32 < sizeof(buf)) {
+            reported_drops = s_stream_dropped;
+            len += snprintf(buf + len, sizeof(buf) - len, "# dropped %lu\n", (unsigned long)reported_drops);
+        }
+        if (!send_all(sock, buf, len)) {
+            break;
+        }
+    }
+    s_client_connected = false;
+}
+
+static void stream_task(void* pvParameters) {
+    const uint16_t port = (uint16_t)(uintptr_t)pvParameters;
+    struct sockaddr_in dest_addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+
+    int listen_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
+    if (listen_sock < 0) {
+        ESP_LOGE(TAG, "Unable to create socket: errno %d", errno);
+        goto EXIT;
+    }
+    if (bind(listen_sock, (struct sockaddr*)&dest_addr, sizeof(dest_addr)) != 0 || listen(listen_sock, 1) != 0) {
+        ESP_LOGE(TAG, "Socket unable to bind/listen on port %d: errno %d", port, errno);
+        goto CLEAN_UP;
+    }
+    ESP_LOGI(TAG, "CSV stream listening on port %d", port);
+
+    while (s_stream_running) {
+        fd_set readfds;
+        struct timeval tv = {.tv_sec = 1, .tv_usec = 0};
+        FD_ZERO(&readfds);
+        FD_SET(listen_sock, &readfds);
+        if (select(listen_sock + 1, &readfds, NULL, NULL, &tv) <= 0) {
+            continue;
+        }
+
+        struct sockaddr_in source_addr;
+        socklen_t addr_len = sizeof(source_addr);
+        int sock = accept(listen_sock, (struct sockaddr*)&source_addr, &addr_len);
+        if (sock < 0) {
+            ESP_LOGE(TAG, "Unable to accept connection: errno %d", errno);
+            continue;
+        }
+        char addr_str[16];
+        inet_ntoa_r(source_addr.sin_addr.s_addr, addr_str, sizeof(addr_str));
+        ESP_LOGI(TAG, "Stream client %s connected", addr_str);
+
+        stream_client(sock);
+
+        ESP_LOGI(TAG, "Stream client %s done, %lu records dropped", addr_str, (unsigned long)s_stream_dropped);
+        shutdown(sock, 0);
+        close(sock);
+    }
+
+CLEAN_UP:
+    close(listen_sock);
+EXIT:
+    s_stream_running = false;
+    s_stream_task = NULL;
+    vTaskDelete(NULL);
+}
+
+esp_err_t lv_profiler_stream_start(uint16_t port) {
+    if (!s_inited) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (s_stream_task != NULL) {
+        return ESP_OK;
+    }
+    s_stream_running = true;
+    if (xTaskCreatePinnedToCore(stream_task, "lv_prof_tcp", 3072, (void*)(uintptr_t)port, 3, &s_stream_task, 0) !=
+        pdPASS) {
+        ESP_LOGE(TAG, "Failed to create stream task");
+        s_stream_running = false;
+        s_stream_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void lv_profiler_stream_stop(void) {
+    s_stream_running = false;
+    // 任务在 1s 内自行退出 (select 超时)
+    for (int i = 0; i < 15 && s_stream_task != NULL; i++) {
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+}
+
+bool lv_profiler_stream_running(void) { return s_stream_task != NULL; }
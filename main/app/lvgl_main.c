@@ -4,21 +4,28 @@
  * @author Your Name
  * @date 2025-08-14
  */
+#include "boot_graph.h"
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "lv_port_disp.h"
 #include "lv_port_indev.h"
+#include "lv_profiler.h"
 #include "my_font.h"
 #include "settings_manager.h"
 #include "theme_manager.h"
 #include "ui.h"
 #include "st7789.h"
+#include "sys_trace.h"
 
 
-// 动画完成后的回调函数
-static void show_main_menu_cb(void) { ui_main_menu_create(lv_scr_act()); }
+// 动画完成后的回调函数: 主界面创建后立即送显，并通知启动图首帧已出
+static void show_main_menu_cb(void) {
+    ui_main_menu_create(lv_scr_act());
+    lv_refr_now(NULL);
+    boot_graph_signal("first_frame");
+}
 
 static void lv_tick_task(void* arg) {
     (void)arg;
@@ -34,6 +41,7 @@ void lvgl_main_task(void* pvParameters) {
     font_init(); // 初始化字体
     lv_port_disp_init();
     lv_port_indev_init();
+    lv_profiler_init(); // 逐帧渲染分析 (浮层/数据流默认关闭)
 
     // 在屏幕硬件和设置都初始化完成后，应用背光（使用设置中的亮度）
     st7789_set_backlight(settings_get_backlight());
@@ -58,7 +66,11 @@ void lvgl_main_task(void* pvParameters) {
 
     // LVGL主循环 - 专用任务处理
     while (1) {
+        lv_profiler_frame_begin();
+        SYS_TRACE_BEGIN("lv_timer_handler");
         lv_timer_handler();
+        SYS_TRACE_END("lv_timer_handler");
+        lv_profiler_frame_end();
         vTaskDelay(pdMS_TO_TICKS(16)); // 60Hz刷新率
     }
 }
\ No newline at end of file
@@ -27,7 +27,7 @@ static const char* TAG = "SERIAL_DISPLAY";
 
 // TCP服务器配置
 #define LISTEN_SOCKET_NUM 1
-#define TCP_RECV_BUF_SIZE 1024
+#define TCP_RECV_BUF_SIZE 4096 // 每个数据块一次性切行写入显示缓冲，块越大开销越小
 #define MAX_DISPLAY_DATA_SIZE 4096
 
 // 任务句柄
@@ -78,6 +78,7 @@ static void tcp_server_task(void* pvParameters) {
     int addr_family = AF_INET;
     int ip_protocol = IPPROTO_IP;
     struct sockaddr_in dest_addr;
+    uint8_t* rx_buffer = NULL;
 
     dest_addr.sin_addr.s_addr = htonl(INADDR_ANY);
     dest_addr.sin_family = AF_INET;
@@ -106,6 +107,12 @@ static void tcp_server_task(void* pvParameters) {
     }
     ESP_LOGI(TAG, "Socket listening on port %d", port);
 
+    rx_buffer = (uint8_t*)heap_caps_malloc(TCP_RECV_BUF_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (rx_buffer == NULL) {
+        ESP_LOGE(TAG, "Failed to allocate receive buffer");
+        goto CLEAN_UP;
+    }
+
     s_server_running = true;
 
     while (s_server_running) {
@@ -137,12 +144,12 @@ static void tcp_server_task(void* pvParameters) {
         ESP_LOGI(TAG, "Socket accepted IP address: %s", addr_str);
 
         int len;
-        uint8_t rx_buffer[TCP_RECV_BUF_SIZE];
+        uint64_t total = 0;
 
         do {
             if (!s_server_running) break;
 
-            len = recv(sock, rx_buffer, sizeof(rx_buffer), 0);
+            len = recv(sock, rx_buffer, TCP_RECV_BUF_SIZE, 0);
             if (len < 0) {
                 ESP_LOGE(TAG, "Error during receive: errno %d", errno);
                 break;
@@ -150,29 +157,24 @@ static void tcp_server_task(void* pvParameters) {
                 ESP_LOGW(TAG, "Connection closed");
                 break;
             } else {
-                ESP_LOGI(TAG, "Received %d bytes from TCP", len);
-
-                if (xSemaphoreTake(s_buffer_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-                    if (s_buffer_initialized && s_display_buffer != NULL && len <= MAX_DISPLAY_DATA_SIZE) {
-                        memcpy(s_display_buffer, rx_buffer, len);
-                        s_buffer_size = len;
-                        ESP_LOGI(TAG, "Data buffered for UI display");
-                    } else {
-                        ESP_LOGE(TAG, "Buffer not ready or data too large: %d", len);
-                    }
-                    xSemaphoreGive(s_buffer_mutex);
-                }
-
-                // 更新UI显示
+                // 高速数据流下逐块打印日志会拖慢接收，这里只在调试级别输出
+                ESP_LOGD(TAG, "Received %d bytes from TCP", len);
+                total += len;
+
+                // 更新UI显示 (写入无锁行缓冲，不等待LVGL)
                 ui_serial_display_add_data((const char*)rx_buffer, len);
             }
         } while (s_server_running);
 
+        ui_serial_display_flush();
+        ESP_LOGI(TAG, "Connection from %s done, %llu bytes received", addr_str, (unsigned long long)total);
+
         shutdown(sock, 0);
         close(sock);
     }
 
 CLEAN_UP:
+    heap_caps_free(rx_buffer);
     close(listen_sock);
     s_server_running = false;
     free(pvParameters);
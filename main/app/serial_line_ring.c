@@ -0,0 +1,191 @@
+/**
+ * @file serial_line_ring.c
+ * @brief 远程串口文本行环形缓冲 (单生产者/单消费者，无锁)
+ */
+
+#include "serial_line_ring.h"
+
+#include <string.h>
+
+#define RECORD_HDR 2
+#define WRAP_MARK 0xFFFFu
+
+static inline uint32_t record_size(uint32_t len) {
+    return (RECORD_HDR + len + 1 + 3u) & ~3u;
+}
+
+static inline bool is_line_end(char c) {
+    return c == '\n' || c == '\r';
+}
+
+bool serial_line_ring_init(serial_line_ring_t* ring, void* buf, uint32_t size) {
+    if (ring == NULL || buf == NULL || size < 1024 || (size & (size - 1)) != 0 || ((uintptr_t)buf & 3u) != 0) {
+        return false;
+    }
+    memset(ring, 0, sizeof(*ring));
+    ring->buf = (char*)buf;
+    ring->size = size;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->lines_written, 0);
+    atomic_init(&ring->dropped, 0);
+    atomic_init(&ring->bytes_in, 0);
+    return true;
+}
+
+// 把半行写成记录 (尚未发布)，head 为生产者本地写位置
+static size_t commit_partial(serial_line_ring_t* ring, uint32_t* head) {
+    const uint32_t len = ring->partial_len;
+    const bool body = ring->partial_body;
+    ring->partial_len = 0;
+    ring->partial_body = false;
+    if (!body) {
+        return 0; // 只有前缀的空行
+    }
+
+    const uint32_t need = record_size(len);
+    const uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    uint32_t pos = *head & (ring->size - 1);
+    const uint32_t pad = (ring->size - pos < need) ? ring->size - pos : 0;
+    if (*head + pad + need - tail > ring->size) {
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        return 0;
+    }
+
+    if (pad != 0) {
+        const uint16_t mark = WRAP_MARK; // 记录 4 字节对齐，尾部至少剩 4 字节
+        memcpy(ring->buf + pos, &mark, sizeof(mark));
+        *head += pad;
+        pos = 0;
+    }
+    const uint16_t hdr = (uint16_t)len;
+    memcpy(ring->buf + pos, &hdr, sizeof(hdr));
+    memcpy(ring->buf + pos + RECORD_HDR, ring->partial, len);
+    ring->buf[pos + RECORD_HDR + len] = '\0';
+    *head += need;
+    return 1;
+}
+
+static void publish(serial_line_ring_t* ring, uint32_t head, size_t committed) {
+    // 先发布写位置再发布行数，消费者看到的行数不会超过可读记录
+    atomic_store_explicit(&ring->head, head, memory_order_release);
+    if (committed != 0) {
+        const uint32_t lines = atomic_load_explicit(&ring->lines_written, memory_order_relaxed);
+        atomic_store_explicit(&ring->lines_written, lines + (uint32_t)committed, memory_order_release);
+    }
+}
+
+size_t serial_line_ring_write(serial_line_ring_t* ring, const char* data, size_t len, const char* prefix) {
+    if (ring == NULL || ring->buf == NULL || data == NULL) {
+        return 0;
+    }
+
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t prefix_len = prefix != NULL ? strlen(prefix) : 0;
+    if (prefix_len > SERIAL_LINE_RING_LINE_MAX / 2) {
+        prefix_len = SERIAL_LINE_RING_LINE_MAX / 2;
+    }
+    size_t committed = 0;
+    size_t i = 0;
+
+    while (i < len) {
+        if (is_line_end(data[i])) {
+            committed += commit_partial(ring, &head);
+            ring->folded = false;
+            i++;
+            continue;
+        }
+
+        if (ring->partial_len == 0 && !ring->folded && prefix_len != 0) {
+            memcpy(ring->partial, prefix, prefix_len);
+            ring->partial_len = (uint16_t)prefix_len;
+        }
+
+        // 一段连续正文整体复制
+        size_t end = i;
+        while (end < len && !is_line_end(data[end])) {
+            end++;
+        }
+        const size_t room = SERIAL_LINE_RING_LINE_MAX - ring->partial_len;
+        size_t n = end - i;
+        bool fold = false;
+        if (n > room) {
+            // 超长折行，切点退到 UTF-8 字符起始处
+            n = room;
+            while (n > 0 && ((uint8_t)data[i + n] & 0xC0u) == 0x80u) {
+                n--;
+            }
+            fold = true;
+        }
+        memcpy(ring->partial + ring->partial_len, data + i, n);
+        ring->partial_len += (uint16_t)n;
+        ring->partial_body |= n != 0;
+        i += n;
+
+        if (fold) {
+            committed += commit_partial(ring, &head);
+            ring->folded = true;
+        }
+    }
+
+    atomic_fetch_add_explicit(&ring->bytes_in, (uint32_t)len, memory_order_relaxed);
+    publish(ring, head, committed);
+    return committed;
+}
+
+void serial_line_ring_flush(serial_line_ring_t* ring) {
+    if (ring == NULL || ring->buf == NULL) {
+        return;
+    }
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    const size_t committed = commit_partial(ring, &head);
+    ring->folded = false;
+    publish(ring, head, committed);
+}
+
+uint32_t serial_line_ring_pending(const serial_line_ring_t* ring) {
+    return atomic_load_explicit(&ring->lines_written, memory_order_acquire) - ring->lines_read;
+}
+
+const char* serial_line_ring_peek(serial_line_ring_t* ring, uint16_t* len) {
+    const uint32_t start = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    const uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint32_t tail = start;
+    const char* line = NULL;
+
+    while (tail != head) {
+        const uint32_t pos = tail & (ring->size - 1);
+        uint16_t hdr;
+        memcpy(&hdr, ring->buf + pos, sizeof(hdr));
+        if (hdr != WRAP_MARK) {
+            *len = hdr;
+            line = ring->buf + pos + RECORD_HDR;
+            break;
+        }
+        tail += ring->size - pos;
+    }
+    if (tail != start) {
+        atomic_store_explicit(&ring->tail, tail, memory_order_release);
+    }
+    return line;
+}
+
+void serial_line_ring_pop(serial_line_ring_t* ring) {
+    uint16_t len;
+    if (serial_line_ring_peek(ring, &len) == NULL) {
+        return;
+    }
+    const uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    ring->lines_read++;
+    atomic_store_explicit(&ring->tail, tail + record_size(len), memory_order_release);
+}
+
+uint32_t serial_line_ring_skip(serial_line_ring_t* ring, uint32_t lines) {
+    uint32_t skipped = 0;
+    uint16_t len;
+    while (skipped < lines && serial_line_ring_peek(ring, &len) != NULL) {
+        serial_line_ring_pop(ring);
+        skipped++;
+    }
+    return skipped;
+}
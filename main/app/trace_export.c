@@ -0,0 +1,165 @@
+/**
+ * @file trace_export.c
+ * @brief 事件追踪导出 - TCP 服务与控制台输出
+ */
+#include "trace_export.h"
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+#include "sys_trace.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* TAG = "TRACE_EXPORT";
+
+static TaskHandle_t s_export_task = NULL;
+static volatile bool s_export_running = false;
+
+static int socket_write(void* ctx, const char* data, size_t len) {
+    const int sock = (int)(intptr_t)ctx;
+    size_t sent = 0;
+    while (sent < len) {
+        int n = send(sock, data + sent, len - sent, 0);
+        if (n < 0) {
+            return -1;
+        }
+        sent += n;
+    }
+    return (int)sent;
+}
+
+static int console_write(void* ctx, const char* data, size_t len) {
+    (void)ctx;
+    return fwrite(data, 1, len, stdout) == len ? (int)len : -1;
+}
+
+/**
+ * @brief 读取可选的 "capture <ms>" 命令，没有命令返回 0
+ */
+static uint32_t read_capture_request(int sock) {
+    struct timeval tv = {.tv_sec = 0, .tv_usec = 300000};
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    char cmd[32];
+    int len = recv(sock, cmd, sizeof(cmd) - 1, 0);
+    if (len <= 0) {
+        return 0;
+    }
+    cmd[len] = '\0';
+    unsigned long ms = 0;
+    if (sscanf(cmd, "capture %lu", &ms) != 1) {
+        ESP_LOGW(TAG, "Unknown request, exporting current buffer");
+        return 0;
+    }
+    return ms > TRACE_EXPORT_MAX_CAPTURE_MS ? TRACE_EXPORT_MAX_CAPTURE_MS : (uint32_t)ms;
+}
+
+static void handle_client(int sock) {
+    const uint32_t capture_ms = read_capture_request(sock);
+    if (capture_ms > 0) {
+        const bool was_recording = sys_trace_is_recording();
+        sys_trace_clear();
+        sys_trace_start();
+        vTaskDelay(pdMS_TO_TICKS(capture_ms));
+        if (!was_recording) {
+            sys_trace_stop();
+        }
+    }
+
+    sys_trace_stats_t stats;
+    sys_trace_get_stats(&stats);
+    const esp_err_t ret = sys_trace_write_json(socket_write, (void*)(intptr_t)sock);
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "Exported trace (%lu recorded, %lu lost)", (unsigned long)stats.recorded,
+                 (unsigned long)stats.lost);
+    } else {
+        ESP_LOGW(TAG, "Trace export failed: %s", esp_err_to_name(ret));
+    }
+}
+
+static void trace_export_task(void* pvParameters) {
+    const uint16_t port = (uint16_t)(uintptr_t)pvParameters;
+    struct sockaddr_in dest_addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+
+    int listen_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
+    if (listen_sock < 0) {
+        ESP_LOGE(TAG, "Unable to create socket: errno %d", errno);
+        goto EXIT;
+    }
+    int opt = 1;
+    setsockopt(listen_sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    if (bind(listen_sock, (struct sockaddr*)&dest_addr, sizeof(dest_addr)) != 0 || listen(listen_sock, 1) != 0) {
+        ESP_LOGE(TAG, "Socket unable to bind/listen on port %d: errno %d", port, errno);
+        goto CLEAN_UP;
+    }
+    ESP_LOGI(TAG, "Trace export listening on port %d", port);
+
+    while (s_export_running) {
+        fd_set readfds;
+        struct timeval tv = {.tv_sec = 1, .tv_usec = 0};
+        FD_ZERO(&readfds);
+        FD_SET(listen_sock, &readfds);
+        if (select(listen_sock + 1, &readfds, NULL, NULL, &tv) <= 0) {
+            continue;
+        }
+
+        struct sockaddr_in source_addr;
+        socklen_t addr_len = sizeof(source_addr);
+        int sock = accept(listen_sock, (struct sockaddr*)&source_addr, &addr_len);
+        if (sock < 0) {
+            ESP_LOGE(TAG, "Unable to accept connection: errno %d", errno);
+            continue;
+        }
+        handle_client(sock);
+        shutdown(sock, 0);
+        close(sock);
+    }
+
+CLEAN_UP:
+    close(listen_sock);
+EXIT:
+    s_export_running = false;
+    s_export_task = NULL;
+    vTaskDelete(NULL);
+}
+
+esp_err_t trace_export_start(uint16_t port) {
+    if (s_export_task != NULL) {
+        return ESP_OK;
+    }
+    s_export_running = true;
+    if (xTaskCreatePinnedToCore(trace_export_task, "trace_export", 4096, (void*)(uintptr_t)port, 2, &s_export_task,
+                                0) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create trace export task");
+        s_export_running = false;
+        s_export_task = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void trace_export_stop(void) {
+    s_export_running = false;
+    // 任务在 1s 内自行退出 (select 超时)
+    for (int i = 0; i < 15 && s_export_task != NULL; i++) {
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+}
+
+bool trace_export_is_running(void) { return s_export_task != NULL; }
+
+esp_err_t trace_export_dump_console(void) {
+    printf("\n--- sys_trace begin ---\n");
+    const esp_err_t ret = sys_trace_write_json(console_write, NULL);
+    printf("--- sys_trace end ---\n");
+    fflush(stdout);
+    return ret;
+}
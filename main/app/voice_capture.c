@@ -0,0 +1,384 @@
+/**
+ * @file voice_capture.c
+ * @brief 麦克风上行: 采集、语音处理、ADPCM 编码与 UDP 发送
+ */
+
+#include "voice_capture.h"
+#include "audio_codec.h"
+#include "audio_rtp.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "i2s_tdm.h"
+#include "lwip/sockets.h"
+#include "voice_dsp.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* TAG = "VOICE_CAPTURE";
+
+#define VOICE_CAPTURE_TASK_STACK 4096
+#define VOICE_CAPTURE_TASK_PRIO 5
+#define VOICE_CAPTURE_CORE 1                      // APP 核 (核 0 承担 WiFi/lwIP 与网络接收)
+#define VOICE_CAPTURE_AEC_TAPS VOICE_AEC_MAX_TAPS // 14.7kHz 下约 35ms: 覆盖播放 DMA 队列延迟与回声尾长
+#define VOICE_CAPTURE_CODEC AUDIO_CODEC_IMA_ADPCM
+#define VOICE_CAPTURE_REF_FIFO_SAMPLES 4096       // 参考 FIFO (2 的幂，44.1kHz 下约 93ms)
+#define VOICE_CAPTURE_REF_PRIME_SAMPLES 256       // 对齐后 FIFO 保留的余量 (一个播放块)，吸收两侧块大小不同的抖动
+#define VOICE_CAPTURE_HELLO_INTERVAL_US (1000 * 1000)
+#define VOICE_CAPTURE_STOP_WAIT_MS 10
+
+// 参考 FIFO: 播放任务写入，采集任务读取；索引为自由计数，s_ref_lock 保护
+static int16_t s_ref_fifo[VOICE_CAPTURE_REF_FIFO_SAMPLES];
+static uint32_t s_ref_head;         // 已写入采样数
+static uint32_t s_ref_tail;         // 已读取采样数
+static bool s_ref_overrun;          // 写入时空间不足 (已丢弃)，等待采集任务重新对齐
+static portMUX_TYPE s_ref_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static volatile bool s_running = false;
+static TaskHandle_t s_task_handle = NULL;
+static void* s_aec_storage = NULL;
+static volatile bool s_aec_requested = true;
+
+// 对端: set_peer 写入，采集任务在帧间读取 (代数变化表示新的上行流)
+static struct sockaddr_in s_peer;
+static bool s_peer_valid = false;
+static uint32_t s_peer_gen = 0;
+static portMUX_TYPE s_peer_lock = portMUX_INITIALIZER_UNLOCKED;
+
+static voice_capture_stats_t s_stats;
+
+// 采集任务使用的缓冲 (voice_dsp_t 较大，不放在任务栈上)
+static voice_dsp_t s_dsp;
+static int16_t s_mic[VOICE_DSP_FRAME_MAX * VOICE_DSP_MAX_DECIM];
+static int16_t s_ref[VOICE_DSP_FRAME_MAX * VOICE_DSP_MAX_DECIM];
+static int16_t s_out[VOICE_DSP_FRAME_MAX];
+static uint8_t s_packet[AUDIO_RTP_MAX_PACKET];
+
+void voice_capture_feed_reference(const int16_t* pcm, size_t samples) {
+    if (!s_running || samples == 0) {
+        return;
+    }
+    taskENTER_CRITICAL(&s_ref_lock);
+    const uint32_t head = s_ref_head;
+    const uint32_t used = head - s_ref_tail;
+    const bool fits = !s_ref_overrun && samples <= VOICE_CAPTURE_REF_FIFO_SAMPLES - used;
+    if (!fits) {
+        s_ref_overrun = true;
+    }
+    taskEXIT_CRITICAL(&s_ref_lock);
+    if (!fits) {
+        return;
+    }
+
+    // 单生产者: [head, head + samples) 只有本任务写，拷贝不需要持锁
+    const size_t start = head & (VOICE_CAPTURE_REF_FIFO_SAMPLES - 1);
+    const size_t first =
+        samples < VOICE_CAPTURE_REF_FIFO_SAMPLES - start ? samples : VOICE_CAPTURE_REF_FIFO_SAMPLES - start;
+    memcpy(&s_ref_fifo[start], pcm, first * sizeof(int16_t));
+    memcpy(s_ref_fifo, pcm + first, (samples - first) * sizeof(int16_t));
+
+    taskENTER_CRITICAL(&s_ref_lock);
+    s_ref_head = head + (uint32_t)samples;
+    taskEXIT_CRITICAL(&s_ref_lock);
+}
+
+// 丢弃 FIFO 内容，重新对齐
+static void ref_fifo_reset(void) {
+    taskENTER_CRITICAL(&s_ref_lock);
+    s_ref_tail = s_ref_head;
+    s_ref_overrun = false;
+    taskEXIT_CRITICAL(&s_ref_lock);
+}
+
+typedef enum {
+    REF_OK = 0,
+    REF_PRIMING, // 对齐后余量尚未攒够
+    REF_OVERRUN,
+    REF_UNDERRUN,
+} ref_status_t;
+
+// 取出 n 个参考采样；primed 为 false 时先等待 FIFO 攒够 n + 余量，并丢弃多出的部分
+static ref_status_t ref_fifo_pop(int16_t* out, size_t n, bool* primed) {
+    taskENTER_CRITICAL(&s_ref_lock);
+    const bool overrun = s_ref_overrun;
+    uint32_t tail = s_ref_tail;
+    const uint32_t used = s_ref_head - tail;
+    taskEXIT_CRITICAL(&s_ref_lock);
+    if (overrun) {
+        return REF_OVERRUN;
+    }
+    if (!*primed) {
+        if (used < n + VOICE_CAPTURE_REF_PRIME_SAMPLES) {
+            return REF_PRIMING;
+        }
+        tail += used - (uint32_t)(n + VOICE_CAPTURE_REF_PRIME_SAMPLES);
+        *primed = true;
+    } else if (used < n) {
+        return REF_UNDERRUN;
+    }
+
+    const size_t start = tail & (VOICE_CAPTURE_REF_FIFO_SAMPLES - 1);
+    const size_t first = n < VOICE_CAPTURE_REF_FIFO_SAMPLES - start ? n : VOICE_CAPTURE_REF_FIFO_SAMPLES - start;
+    memcpy(out, &s_ref_fifo[start], first * sizeof(int16_t));
+    memcpy(out + first, s_ref_fifo, (n - first) * sizeof(int16_t));
+
+    taskENTER_CRITICAL(&s_ref_lock);
+    s_ref_tail = tail + (uint32_t)n;
+    taskEXIT_CRITICAL(&s_ref_lock);
+    return REF_OK;
+}
+
+// 按当前 I2S 采样率初始化处理链
+static bool capture_configure(uint32_t in_rate) {
+    if (!voice_dsp_init(&s_dsp, in_rate, VOICE_CAPTURE_AEC_TAPS, s_aec_storage)) {
+        ESP_LOGE(TAG, "Unsupported I2S sample rate %lu", (unsigned long)in_rate);
+        return false;
+    }
+    s_dsp.aec_enabled = s_dsp.aec_enabled && s_aec_requested;
+    s_stats.sample_rate = s_dsp.rate;
+    s_stats.frame_samples = s_dsp.frame_samples;
+    ESP_LOGI(TAG, "Voice chain: %lu Hz -> %lu Hz, %u samples/frame, aec %s (%u taps)", (unsigned long)in_rate,
+             (unsigned long)s_dsp.rate, s_dsp.frame_samples, s_dsp.aec_enabled ? "on" : "off",
+             VOICE_CAPTURE_AEC_TAPS);
+    return true;
+}
+
+static void capture_send_hello(int sock, const struct sockaddr_in* peer) {
+    const audio_stream_hello_t hello = {
+        .magic = AUDIO_STREAM_HELLO_MAGIC,
+        .version = AUDIO_STREAM_VERSION,
+        .codec_mask = AUDIO_CODEC_MASK(VOICE_CAPTURE_CODEC),
+        .preferred = VOICE_CAPTURE_CODEC,
+        .channels = 1,
+        .sample_rate = s_dsp.rate,
+        .block_samples = s_dsp.frame_samples,
+        .reserved = 0,
+    };
+    sendto(sock, &hello, sizeof(hello), 0, (const struct sockaddr*)peer, sizeof(*peer));
+}
+
+static void capture_log_stream_end(void) {
+    voice_dsp_stats_t dsp;
+    voice_dsp_get_stats(&s_dsp, &dsp);
+    ESP_LOGI(TAG, "Uplink idle: packets=%lu errors=%lu erle=%.1fdB agc=%.1fdB double_talk=%lu resets=%lu "
+             "ref_overruns=%lu ref_underruns=%lu process=%lu/%luus", (unsigned long)s_stats.packets,
+             (unsigned long)s_stats.send_errors, dsp.erle_db, dsp.agc_gain_db,
+             (unsigned long)dsp.double_talk_frames, (unsigned long)dsp.aec_bg_resets,
+             (unsigned long)s_stats.ref_overruns, (unsigned long)s_stats.ref_underruns,
+             (unsigned long)s_stats.process_us_avg, (unsigned long)s_stats.process_us_max);
+}
+
+// 采集任务: 以 I2S 时钟节奏逐帧读取麦克风，有对端时处理并发送
+static void voice_capture_task(void* arg) {
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        ESP_LOGE(TAG, "Unable to create UDP socket: errno %d", errno);
+        goto exit;
+    }
+    if (!capture_configure(i2s_tdm_get_sample_rate())) {
+        goto exit;
+    }
+
+    struct sockaddr_in peer = {0};
+    bool has_peer = false;
+    uint32_t peer_gen = 0;
+    bool primed = false;
+    bool marker = true;
+    audio_adpcm_state_t adpcm = {0};
+    uint16_t seq = (uint16_t)esp_random();
+    uint32_t timestamp = esp_random();
+    const uint32_t ssrc = esp_random();
+    int64_t last_hello_us = 0;
+    ref_fifo_reset();
+
+    while (s_running) {
+        const size_t in_samples = voice_dsp_input_samples(&s_dsp);
+        size_t bytes_read = 0;
+        if (i2s_tdm_read(s_mic, in_samples * sizeof(int16_t), &bytes_read) != ESP_OK ||
+            bytes_read != in_samples * sizeof(int16_t)) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+            continue;
+        }
+
+        // 播放任务切换了 I2S 采样率: 重新初始化处理链，FIFO 中的参考已失效
+        const uint32_t in_rate = i2s_tdm_get_sample_rate();
+        if (in_rate != s_dsp.in_rate) {
+            if (!capture_configure(in_rate)) {
+                break;
+            }
+            ref_fifo_reset();
+            primed = false;
+            last_hello_us = 0;
+            continue;
+        }
+
+        // 参考: 溢出/欠载后重新对齐并清空回声消除 (旧权重对应的延迟已失效)
+        const int16_t* ref = NULL;
+        const ref_status_t ref_status = ref_fifo_pop(s_ref, in_samples, &primed);
+        if (ref_status == REF_OK) {
+            ref = s_ref;
+        } else if (ref_status != REF_PRIMING) {
+            if (ref_status == REF_OVERRUN) {
+                s_stats.ref_overruns++;
+            } else {
+                s_stats.ref_underruns++;
+            }
+            ref_fifo_reset();
+            primed = false;
+            voice_dsp_reset(&s_dsp);
+        }
+
+        // 对端变化: 新的上行流重新开始编码并立即发送 hello
+        taskENTER_CRITICAL(&s_peer_lock);
+        const bool peer_changed = s_peer_gen != peer_gen;
+        if (peer_changed) {
+            peer_gen = s_peer_gen;
+            has_peer = s_peer_valid;
+            peer = s_peer;
+        }
+        taskEXIT_CRITICAL(&s_peer_lock);
+        if (peer_changed) {
+            if (s_stats.streaming && !has_peer) {
+                capture_log_stream_end();
+            }
+            s_stats.streaming = has_peer;
+            if (has_peer) {
+                s_stats.packets = 0;
+                s_stats.send_errors = 0;
+                s_stats.process_us_max = 0;
+                memset(&adpcm, 0, sizeof(adpcm));
+                marker = true;
+                last_hello_us = 0;
+                voice_dsp_reset(&s_dsp);
+            }
+        }
+
+        const bool aec = s_aec_requested && s_aec_storage != NULL;
+        if (aec != s_dsp.aec_enabled) {
+            if (aec) {
+                voice_aec_reset(&s_dsp.aec);
+            }
+            s_dsp.aec_enabled = aec;
+        }
+
+        if (!has_peer) {
+            continue;
+        }
+
+        const int64_t start_us = esp_timer_get_time();
+        voice_dsp_process(&s_dsp, s_mic, ref, s_out);
+        const uint32_t elapsed = (uint32_t)(esp_timer_get_time() - start_us);
+        s_stats.process_us_avg = s_stats.frames ? s_stats.process_us_avg - (s_stats.process_us_avg >> 4) +
+                                                      (elapsed >> 4)
+                                                : elapsed;
+        if (elapsed > s_stats.process_us_max) {
+            s_stats.process_us_max = elapsed;
+        }
+        s_stats.frames++;
+
+        if (start_us - last_hello_us >= VOICE_CAPTURE_HELLO_INTERVAL_US) {
+            capture_send_hello(sock, &peer);
+            last_hello_us = start_us;
+        }
+        const size_t len = audio_rtp_encode(VOICE_CAPTURE_CODEC, &adpcm, seq, timestamp, ssrc, marker, s_out,
+                                            s_dsp.frame_samples, s_packet);
+        seq++;
+        timestamp += s_dsp.frame_samples;
+        marker = false;
+        if (len == 0 || sendto(sock, s_packet, len, 0, (struct sockaddr*)&peer, sizeof(peer)) < 0) {
+            s_stats.send_errors++;
+        } else {
+            s_stats.packets++;
+        }
+    }
+
+exit:
+    if (sock >= 0) {
+        close(sock);
+    }
+    s_stats.streaming = false;
+    s_task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+esp_err_t voice_capture_start(void) {
+    if (s_running) {
+        return ESP_OK;
+    }
+    // 回声消除内层循环每个采样遍历全部权重，优先放内部 RAM
+    const size_t storage_size = VOICE_AEC_STORAGE_BYTES(VOICE_CAPTURE_AEC_TAPS);
+    s_aec_storage = heap_caps_malloc(storage_size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!s_aec_storage) {
+        s_aec_storage = heap_caps_malloc(storage_size, MALLOC_CAP_SPIRAM);
+    }
+    if (!s_aec_storage) {
+        ESP_LOGW(TAG, "No memory for echo canceller (%u bytes), running without AEC", (unsigned)storage_size);
+    }
+
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_running = true;
+    if (xTaskCreatePinnedToCore(voice_capture_task, "voice_capture", VOICE_CAPTURE_TASK_STACK, NULL,
+                                VOICE_CAPTURE_TASK_PRIO, &s_task_handle, VOICE_CAPTURE_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create capture task");
+        s_running = false;
+        s_task_handle = NULL;
+        free(s_aec_storage);
+        s_aec_storage = NULL;
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+void voice_capture_stop(void) {
+    if (!s_running) {
+        return;
+    }
+    s_running = false;
+    // I2S 仍在运行，阻塞中的读取在一帧内返回
+    while (s_task_handle != NULL) {
+        vTaskDelay(pdMS_TO_TICKS(VOICE_CAPTURE_STOP_WAIT_MS));
+    }
+    free(s_aec_storage);
+    s_aec_storage = NULL;
+    voice_capture_set_peer(NULL);
+    ESP_LOGI(TAG, "Voice capture stopped");
+}
+
+void voice_capture_set_peer(const struct sockaddr_in* peer) {
+    taskENTER_CRITICAL(&s_peer_lock);
+    const bool valid = peer != NULL;
+    if (valid != s_peer_valid || (valid && (peer->sin_addr.s_addr != s_peer.sin_addr.s_addr ||
+                                            peer->sin_port != s_peer.sin_port))) {
+        s_peer_valid = valid;
+        if (valid) {
+            s_peer = *peer;
+        }
+        s_peer_gen++;
+    }
+    taskEXIT_CRITICAL(&s_peer_lock);
+}
+
+void voice_capture_set_aec(bool enable) {
+    s_aec_requested = enable;
+}
+
+void voice_capture_get_stats(voice_capture_stats_t* stats) {
+    if (!stats) {
+        return;
+    }
+    *stats = s_stats;
+    stats->running = s_running;
+    if (s_running && s_dsp.rate) {
+        voice_dsp_stats_t dsp;
+        voice_dsp_get_stats(&s_dsp, &dsp);
+        stats->aec_enabled = dsp.aec_enabled;
+        stats->erle_db = dsp.erle_db;
+        stats->agc_gain_db = dsp.agc_gain_db;
+        stats->level_dbfs = dsp.level_dbfs;
+        stats->double_talk_frames = dsp.double_talk_frames;
+    }
+}
@@ -0,0 +1,448 @@
+/**
+ * @file voice_dsp.c
+ * @brief 麦克风上行语音处理链 (抽取、高通、回声消除、AGC)
+ */
+
+#include "voice_dsp.h"
+#include <math.h>
+#include <string.h>
+
+#define VOICE_PI 3.14159265358979f
+
+#define DECIM_HIST_LEN (VOICE_DSP_DECIM_TAPS - 1)
+#define DECIM_CUTOFF 0.40f              // 低通截止 (相对输出奈奎斯特频率)
+
+#define AGC_PEAK_LIMIT 29000            // 帧峰值限幅 (约 -1dBFS)
+#define AGC_ATTACK_SHIFT 1              // 包络上升: 每帧逼近 1/2
+#define AGC_RELEASE_SHIFT 5             // 包络下降: 每帧逼近 1/32 (约 320ms)
+#define AGC_GAIN_UP_SHIFT 4             // 增益上升: 每帧逼近 1/16，下降立即生效
+#define AGC_MIN_GAIN_Q16 (1 << 14)      // -12dB
+
+#define AEC_W_MAX ((2 << 24) - 1024)   // 权重限制在 ±2 (Q14 副本不溢出)
+#define AEC_MU_Q15 12288                // NLMS 步长 0.375
+#define AEC_DELTA_PER_TAP (32 * 32)     // 正则项 (每抽头)
+#define AEC_MIN_RMS 64                  // 参考 RMS 低于此值 (约 -54dBFS) 不更新
+#define AEC_PEAK_DECAY_SHIFT 10         // 参考峰值包络衰减 (时间常数约 1024 个采样，覆盖回声尾长)
+#define AEC_DT_RATIO_Q8 128             // Geigel 门限 0.5 (要求回声比参考低 6dB 以上)
+#define AEC_DT_RATIO_MIN_Q8 32          // 自适应 Geigel 门限下限 0.125
+#define AEC_DT_RATIO_MAX_Q8 1024        // 放宽后的上限 4.0
+#define AEC_DT_TIMEOUT_FRAMES 100       // 双讲计分: 双讲帧 +4，单讲帧 -1，累计约 1 秒双讲时放宽门限
+#define AEC_DT_TIMEOUT_CONVERGED 500    // 已收敛时约 5 秒
+#define AEC_DT_SCORE_STEP 4
+#define AEC_CONVERGED_UPDATES 10        // 前景更新次数达到后才估计回声路径增益
+#define AEC_DT_HOLD_MS 40               // 双讲判定后的保持时间
+#define AEC_FG_MARGIN_SHIFT 3           // 背景误差能量低于前景 7/8 时更新前景
+#define AEC_FG_COPY_FRAMES 20           // 背景连续优于前景的帧数 (200ms，漏检的双讲通常夹杂已检出的双讲帧)
+#define AEC_ENERGY_SMOOTH 0.1f
+
+static inline int16_t sat16(int32_t v) {
+    return (int16_t)(v > 32767 ? 32767 : (v < -32768 ? -32768 : v));
+}
+
+static inline int32_t abs32(int32_t v) {
+    return v < 0 ? -v : v;
+}
+
+static uint32_t isqrt32(uint32_t v) {
+    uint32_t root = 0;
+    uint32_t bit = 1u << 30;
+    while (bit > v) {
+        bit >>= 2;
+    }
+    while (bit) {
+        if (v >= root + bit) {
+            v -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+static inline float db_to_linear(float db) {
+    return powf(10.0f, db / 20.0f);
+}
+
+// ---------------------------------------------------------------- 抽取
+
+bool voice_decimator_init(voice_decimator_t* dec, uint8_t factor) {
+    if (factor == 0 || factor > VOICE_DSP_MAX_DECIM) {
+        return false;
+    }
+    memset(dec, 0, sizeof(*dec));
+    dec->factor = factor;
+
+    // Hamming 窗 sinc，归一化为直流增益 1 (舍入误差补到中心抽头)
+    const float fc = DECIM_CUTOFF / factor; // 相对输入采样率的截止 (单边)
+    const float mid = (VOICE_DSP_DECIM_TAPS - 1) / 2.0f;
+    float h[VOICE_DSP_DECIM_TAPS];
+    float sum = 0;
+    for (int i = 0; i < VOICE_DSP_DECIM_TAPS; i++) {
+        const float t = (float)i - mid;
+        const float sinc = 2 * fc * sinf(2 * VOICE_PI * fc * t) / (2 * VOICE_PI * fc * t);
+        const float win = 0.54f - 0.46f * cosf(2 * VOICE_PI * (float)i / (VOICE_DSP_DECIM_TAPS - 1));
+        h[i] = sinc * win;
+        sum += h[i];
+    }
+    int32_t total = 0;
+    for (int i = 0; i < VOICE_DSP_DECIM_TAPS; i++) {
+        dec->coeffs[i] = (int16_t)lrintf(h[i] / sum * 32768.0f);
+        total += dec->coeffs[i];
+    }
+    // 偶数阶两个中心抽头对称分摊
+    const int32_t fix = 32768 - total;
+    dec->coeffs[VOICE_DSP_DECIM_TAPS / 2 - 1] += (int16_t)(fix / 2);
+    dec->coeffs[VOICE_DSP_DECIM_TAPS / 2] += (int16_t)(fix - fix / 2);
+    return true;
+}
+
+size_t voice_decimator_process(voice_decimator_t* dec, const int16_t* in, size_t n, int16_t* out) {
+    const size_t factor = dec->factor;
+    if (factor == 1) {
+        memcpy(out, in, n * sizeof(int16_t));
+        return n;
+    }
+
+    // 历史与新输入拼成连续缓冲，每个输出点是一段连续窗口的点积
+    memcpy(&dec->hist[DECIM_HIST_LEN], in, n * sizeof(int16_t));
+    const size_t outputs = n / factor;
+    const int16_t* coeffs = dec->coeffs;
+    for (size_t m = 0; m < outputs; m++) {
+        const int16_t* x = &dec->hist[m * factor + factor - 1];
+        int32_t acc = 1 << 14;
+        for (int k = 0; k < VOICE_DSP_DECIM_TAPS; k++) {
+            acc += coeffs[k] * x[k];
+        }
+        out[m] = sat16(acc >> 15);
+    }
+    memmove(dec->hist, &dec->hist[n], DECIM_HIST_LEN * sizeof(int16_t));
+    return outputs;
+}
+
+// ---------------------------------------------------------------- 高通
+
+void voice_hpf_init(voice_hpf_t* hpf, uint32_t sample_rate, uint32_t cutoff_hz) {
+    memset(hpf, 0, sizeof(*hpf));
+    const float k = tanf(VOICE_PI * (float)cutoff_hz / (float)sample_rate);
+    const float norm = 1.0f / (1.0f + sqrtf(2.0f) * k + k * k);
+    const float q28 = (float)(1 << 28);
+    hpf->b0 = (int32_t)lrintf(norm * q28);
+    hpf->b1 = -2 * hpf->b0;
+    hpf->b2 = hpf->b0;
+    hpf->a1 = (int32_t)lrintf(2.0f * (k * k - 1.0f) * norm * q28);
+    hpf->a2 = (int32_t)lrintf((1.0f - sqrtf(2.0f) * k + k * k) * norm * q28);
+}
+
+void voice_hpf_process(voice_hpf_t* hpf, int16_t* pcm, size_t n) {
+    // 直接 I 型，输入输出都放大 256 倍参与运算，低截止频率下极点贴近单位圆也不损失精度
+    int32_t x1 = hpf->x1, x2 = hpf->x2, y1 = hpf->y1, y2 = hpf->y2;
+    for (size_t i = 0; i < n; i++) {
+        const int32_t x0 = (int32_t)pcm[i] << 8;
+        int64_t acc = (int64_t)hpf->b0 * x0 + (int64_t)hpf->b1 * x1 + (int64_t)hpf->b2 * x2;
+        acc -= (int64_t)hpf->a1 * y1 + (int64_t)hpf->a2 * y2;
+        const int32_t y0 = (int32_t)(acc >> 28);
+        x2 = x1;
+        x1 = x0;
+        y2 = y1;
+        y1 = y0;
+        pcm[i] = sat16((y0 + 128) >> 8);
+    }
+    hpf->x1 = x1;
+    hpf->x2 = x2;
+    hpf->y1 = y1;
+    hpf->y2 = y2;
+}
+
+// ---------------------------------------------------------------- AGC
+
+void voice_agc_init(voice_agc_t* agc, int target_dbfs, int max_gain_db, int gate_dbfs) {
+    agc->target_rms = (int32_t)lrintf(32767.0f * db_to_linear((float)target_dbfs));
+    agc->gate_rms = (int32_t)lrintf(32767.0f * db_to_linear((float)gate_dbfs));
+    agc->max_gain_q16 = (int32_t)lrintf(65536.0f * db_to_linear((float)max_gain_db));
+    agc->gain_q16 = 1 << 16;
+    agc->level = agc->gate_rms;
+}
+
+void voice_agc_process(voice_agc_t* agc, int16_t* pcm, size_t n) {
+    if (n == 0) {
+        return;
+    }
+    int64_t sumsq = 0;
+    int32_t peak = 0;
+    for (size_t i = 0; i < n; i++) {
+        const int32_t s = pcm[i];
+        sumsq += s * s;
+        const int32_t a = abs32(s);
+        peak = a > peak ? a : peak;
+    }
+    const int32_t rms = (int32_t)isqrt32((uint32_t)(sumsq / (int64_t)n));
+
+    // 包络快攻慢放
+    if (rms > agc->level) {
+        agc->level += (rms - agc->level) >> AGC_ATTACK_SHIFT;
+    } else {
+        agc->level -= (agc->level - rms) >> AGC_RELEASE_SHIFT;
+    }
+
+    const int32_t old_gain = agc->gain_q16;
+    int32_t desired = agc->max_gain_q16;
+    if (agc->level > 0 && ((int64_t)agc->target_rms << 16) / agc->level < desired) {
+        desired = (int32_t)(((int64_t)agc->target_rms << 16) / agc->level);
+    }
+    if (desired < AGC_MIN_GAIN_Q16) {
+        desired = AGC_MIN_GAIN_Q16;
+    }
+    if (agc->level < agc->gate_rms && desired > old_gain) {
+        desired = old_gain; // 噪声段保持增益，避免把底噪放大
+    }
+    int32_t gain = desired < old_gain ? desired : old_gain + ((desired - old_gain) >> AGC_GAIN_UP_SHIFT);
+    int32_t start = old_gain;
+    if (peak > 0 && (int64_t)peak * gain > ((int64_t)AGC_PEAK_LIMIT << 16)) {
+        gain = (int32_t)(((int64_t)AGC_PEAK_LIMIT << 16) / peak);
+    }
+    if (peak > 0 && (int64_t)peak * start > ((int64_t)AGC_PEAK_LIMIT << 16)) {
+        start = gain; // 限幅优先于平滑: 整帧直接使用新增益
+    }
+    agc->gain_q16 = gain;
+
+    // 帧内线性插值增益；按 Q11 相乘使乘积保持在 32 位内
+    const int32_t step = (gain - start) / (int32_t)n;
+    for (size_t i = 0; i < n; i++) {
+        const int32_t g = (start + step * (int32_t)(i + 1)) >> 5;
+        pcm[i] = sat16((pcm[i] * g + (1 << 10)) >> 11);
+    }
+}
+
+// ---------------------------------------------------------------- 回声消除
+
+// 滤波用 Q14 的 16 位权重副本: 16x16 乘加与 ESP32-S3 的 16 位 SIMD 乘加及主机 pmaddwd 对应。
+// 按 32 位无符号累加 (回绕)，只要最终结果在 32 位内 (回声估计 < 4 倍满幅) 就与逐项精确求和一致
+static int32_t aec_dot(const int16_t* restrict w, const int16_t* restrict x, size_t taps) {
+    uint32_t acc = 0;
+    for (size_t k = 0; k < taps; k++) {
+        acc += (uint32_t)(w[k] * x[k]);
+    }
+    return (int32_t)acc;
+}
+
+// 在 Q24 主权重上累加更新并刷新 Q14 副本
+static void aec_update(int32_t* restrict w, int16_t* restrict w16, const int16_t* restrict x, size_t taps,
+                       int32_t g, int shift) {
+    const int32_t round = 1 << (shift - 1);
+    for (size_t k = 0; k < taps; k++) {
+        int32_t v = w[k] + ((g * x[k] + round) >> shift);
+        v = v > AEC_W_MAX ? AEC_W_MAX : (v < -AEC_W_MAX ? -AEC_W_MAX : v);
+        w[k] = v;
+        w16[k] = (int16_t)(v >> 10);
+    }
+}
+
+bool voice_aec_init(voice_aec_t* aec, uint16_t taps, void* storage) {
+    if (taps == 0 || taps > VOICE_AEC_MAX_TAPS || (taps & 3) || !storage) {
+        return false;
+    }
+    memset(aec, 0, sizeof(*aec));
+    aec->taps = taps;
+    aec->w = (int32_t*)storage;
+    aec->w16 = (int16_t*)(aec->w + taps);
+    aec->fg16 = aec->w16 + taps;
+    aec->x = aec->fg16 + taps;
+    aec->mu_q15 = AEC_MU_Q15;
+    aec->dt_ratio_q8 = AEC_DT_RATIO_Q8;
+    voice_aec_reset(aec);
+    return true;
+}
+
+void voice_aec_reset(voice_aec_t* aec) {
+    memset(aec->w, 0, aec->taps * sizeof(int32_t));
+    memset(aec->w16, 0, aec->taps * sizeof(int16_t));
+    memset(aec->fg16, 0, aec->taps * sizeof(int16_t));
+    memset(aec->x, 0, 2u * aec->taps * sizeof(int16_t));
+    aec->pos = 0;
+    aec->energy = 0;
+    aec->far_peak = 0;
+    aec->hold = 0;
+    aec->echo_energy = 0;
+    aec->out_energy = 0;
+    aec->echo_gain = 0;
+    aec->dt_score = 0;
+    aec->bg_better_frames = 0;
+    aec->fg_updates = 0;
+}
+
+void voice_aec_process(voice_aec_t* aec, const int16_t* ref, int16_t* mic, size_t n) {
+    const size_t taps = aec->taps;
+    const int64_t delta = (int64_t)taps * AEC_DELTA_PER_TAP;
+    const int64_t min_energy = (int64_t)taps * AEC_MIN_RMS * AEC_MIN_RMS;
+    // 双讲保持时间按 1 帧约 10ms 折算
+    const uint32_t dt_hold = (uint32_t)(n * AEC_DT_HOLD_MS / 10);
+    int64_t in_energy = 0;
+    int64_t bg_energy = 0;
+    int64_t out_energy = 0;
+    int64_t est_energy = 0;
+    int64_t ref_energy = 0;
+    bool double_talk = false;
+
+    // Geigel 门限: 远端有声时绝大多数帧都判为双讲，说明回声比假设的强 (或回声路径已变化)，
+    // 放宽门限并重新估计增益；前景收敛后收紧为估计回声路径增益的 2 倍，此时允许更长的连续双讲
+    const uint32_t dt_timeout = aec->echo_gain > 0 ? AEC_DT_TIMEOUT_CONVERGED : AEC_DT_TIMEOUT_FRAMES;
+    if (aec->dt_score >= AEC_DT_SCORE_STEP * dt_timeout) {
+        aec->dt_ratio_q8 = aec->dt_ratio_q8 * 3 / 2 > AEC_DT_RATIO_MAX_Q8 ? AEC_DT_RATIO_MAX_Q8
+                                                                         : aec->dt_ratio_q8 * 3 / 2;
+        aec->echo_gain = 0;
+        aec->dt_score = 0;
+    }
+    int32_t dt_ratio = aec->dt_ratio_q8;
+    if (aec->echo_gain > 0) {
+        const int32_t adaptive = (int32_t)(2.0f * aec->echo_gain * 256.0f);
+        dt_ratio = adaptive < AEC_DT_RATIO_MIN_Q8 ? AEC_DT_RATIO_MIN_Q8 : (adaptive < dt_ratio ? adaptive : dt_ratio);
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        // 参考写入历史 (双写，窗口 x[pos..pos+taps) 连续)
+        aec->pos = (uint16_t)(aec->pos ? aec->pos - 1u : taps - 1);
+        const int32_t r = ref[i];
+        const int32_t old = aec->x[aec->pos];
+        aec->energy += r * r - old * old;
+        aec->x[aec->pos] = (int16_t)r;
+        aec->x[aec->pos + taps] = (int16_t)r;
+        const int16_t* win = &aec->x[aec->pos];
+
+        // 前景滤波器输出，背景滤波器的误差只用于自适应
+        const int32_t d = mic[i];
+        const int32_t e = d - ((aec_dot(aec->fg16, win, taps) + (1 << 13)) >> 14);
+        const int32_t eb = d - ((aec_dot(aec->w16, win, taps) + (1 << 13)) >> 14);
+        mic[i] = sat16(e);
+        in_energy += d * d;
+        out_energy += (int64_t)e * e;
+        bg_energy += (int64_t)eb * eb;
+        est_energy += (int64_t)(d - e) * (d - e);
+        ref_energy += r * r;
+
+        // Geigel 双讲检测: 近端幅度超过远端峰值的 dt_ratio 倍
+        const int32_t a = abs32(r);
+        aec->far_peak = a > aec->far_peak ? a : aec->far_peak - (aec->far_peak >> AEC_PEAK_DECAY_SHIFT);
+        if ((abs32(d) << 8) > aec->far_peak * dt_ratio) {
+            aec->hold = dt_hold;
+            double_talk = aec->energy >= min_energy;
+        } else if (aec->hold) {
+            aec->hold--;
+        }
+        if (aec->hold || aec->energy < min_energy) {
+            continue;
+        }
+
+        // NLMS: dw = mu * e * x / (|x|^2 + delta)，g 带 23 位小数，归一化到 16 位以内后与参考相乘
+        int64_t g = (int64_t)aec->mu_q15 * eb * ((int64_t)1 << 32) / (aec->energy + delta);
+        int shift = 23;
+        while ((g > 32767 || g < -32768) && shift > 1) {
+            g >>= 1;
+            shift--;
+        }
+        if (g > 32767 || g < -32768) {
+            g = g > 0 ? 32767 : -32768;
+        }
+        aec_update(aec->w, aec->w16, win, taps, (int32_t)g, shift);
+    }
+
+    // 双滤波器: 背景滤波器连续 200ms 单讲帧都明显优于前景时才拷贝到前景 (双讲期间的漏检帧不会拷贝)；
+    // 背景发散 (漏检的双讲) 而前景仍有效时，从前景恢复背景
+    if (!double_talk && bg_energy < out_energy - (out_energy >> AEC_FG_MARGIN_SHIFT) && bg_energy < in_energy) {
+        if (++aec->bg_better_frames >= AEC_FG_COPY_FRAMES) {
+            memcpy(aec->fg16, aec->w16, taps * sizeof(int16_t));
+            aec->fg_updates++;
+        }
+    } else {
+        aec->bg_better_frames = 0;
+    }
+    if (bg_energy > (in_energy << 2) && out_energy < in_energy) {
+        for (size_t k = 0; k < taps; k++) {
+            aec->w16[k] = aec->fg16[k];
+            aec->w[k] = (int32_t)aec->fg16[k] * (1 << 10);
+        }
+        aec->bg_resets++;
+    }
+
+    aec->echo_energy += AEC_ENERGY_SMOOTH * ((float)in_energy - aec->echo_energy);
+    aec->out_energy += AEC_ENERGY_SMOOTH * ((float)out_energy - aec->out_energy);
+    if (double_talk) {
+        aec->double_talk_frames++;
+        aec->dt_score += AEC_DT_SCORE_STEP;
+    } else if (ref_energy >= min_energy && aec->dt_score > 0) {
+        aec->dt_score--;
+    }
+
+    // 回声路径增益 (前景回声估计 / 参考): 单讲且前景已有效 (ERLE > 10dB) 时更新
+    if (!double_talk && ref_energy >= min_energy && aec->fg_updates >= AEC_CONVERGED_UPDATES &&
+        aec->out_energy * 10.0f < aec->echo_energy) {
+        const float gain = sqrtf((float)est_energy / (float)ref_energy);
+        aec->echo_gain = aec->echo_gain > 0 ? aec->echo_gain + AEC_ENERGY_SMOOTH * (gain - aec->echo_gain) : gain;
+    }
+}
+
+// ---------------------------------------------------------------- 处理链
+
+bool voice_dsp_init(voice_dsp_t* dsp, uint32_t in_rate, uint16_t aec_taps, void* aec_storage) {
+    if (in_rate < 8000 || in_rate > 48000) {
+        return false;
+    }
+    memset(dsp, 0, sizeof(*dsp));
+    // 语音采样率不超过 16kHz
+    uint32_t factor = (in_rate + 15999) / 16000;
+    if (factor > VOICE_DSP_MAX_DECIM) {
+        factor = VOICE_DSP_MAX_DECIM;
+    }
+    dsp->in_rate = in_rate;
+    dsp->rate = in_rate / factor;
+    dsp->frame_samples = (uint16_t)(dsp->rate / 100 / 4 * 4);
+    if (dsp->frame_samples > VOICE_DSP_FRAME_MAX) {
+        dsp->frame_samples = VOICE_DSP_FRAME_MAX;
+    }
+    if (!voice_decimator_init(&dsp->mic_dec, (uint8_t)factor) ||
+        !voice_decimator_init(&dsp->ref_dec, (uint8_t)factor)) {
+        return false;
+    }
+    voice_hpf_init(&dsp->hpf, dsp->rate, VOICE_DSP_HPF_CUTOFF_HZ);
+    voice_agc_init(&dsp->agc, -18, 24, -55);
+    if (aec_storage) {
+        dsp->aec_enabled = voice_aec_init(&dsp->aec, aec_taps, aec_storage);
+    }
+    return true;
+}
+
+void voice_dsp_reset(voice_dsp_t* dsp) {
+    const uint8_t factor = dsp->mic_dec.factor;
+    voice_decimator_init(&dsp->mic_dec, factor);
+    voice_decimator_init(&dsp->ref_dec, factor);
+    voice_hpf_init(&dsp->hpf, dsp->rate, VOICE_DSP_HPF_CUTOFF_HZ);
+    if (dsp->aec.w) {
+        voice_aec_reset(&dsp->aec);
+    }
+}
+
+void voice_dsp_process(voice_dsp_t* dsp, const int16_t* mic, const int16_t* ref, int16_t* out) {
+    const size_t in_samples = voice_dsp_input_samples(dsp);
+    const size_t n = voice_decimator_process(&dsp->mic_dec, mic, in_samples, out);
+    voice_hpf_process(&dsp->hpf, out, n);
+    if (dsp->aec_enabled && ref) {
+        voice_decimator_process(&dsp->ref_dec, ref, in_samples, dsp->ref);
+        voice_aec_process(&dsp->aec, dsp->ref, out, n);
+    }
+    voice_agc_process(&dsp->agc, out, n);
+}
+
+void voice_dsp_get_stats(const voice_dsp_t* dsp, voice_dsp_stats_t* stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->rate = dsp->rate;
+    stats->frame_samples = dsp->frame_samples;
+    stats->aec_enabled = dsp->aec_enabled;
+    if (dsp->aec_enabled && dsp->aec.out_energy > 0 && dsp->aec.echo_energy > 0) {
+        stats->erle_db = 10.0f * log10f(dsp->aec.echo_energy / dsp->aec.out_energy);
+    }
+    stats->double_talk_frames = dsp->aec.double_talk_frames;
+    stats->aec_bg_resets = dsp->aec.bg_resets;
+    stats->agc_gain_db = 20.0f * log10f((float)dsp->agc.gain_q16 / 65536.0f);
+    stats->level_dbfs = dsp->agc.level > 0 ? 20.0f * log10f((float)dsp->agc.level / 32767.0f) : -96.0f;
+}
@@ -22,6 +22,7 @@
 #include "bsp_i2c.h"
 #include "calibration_manager.h"
 #include "gt911.h"
+#include "joystick_adc.h"
 #include "ft6336g.h"
 #include "lsm6ds3.h"
 #include "lv_port_indev.h" // 包含此头文件以获取宏定义
@@ -31,6 +32,8 @@
 #include "task_init.h"
 #include "ui.h"
 #include "sx1281.h"
+#include "sys_trace.h"
+#include "boot_graph.h"
 
 static const char* TAG = "COMPONENTS_INIT";
 
@@ -92,110 +95,118 @@ void spiffs_deinit(void) {
     ESP_LOGI(TAG, "SPIFFS unmounted");
 }
 
-/**
- * @brief 初始化所有必要组件
- * @return esp_err_t ESP_OK成功，其他错误码失败
- */
-esp_err_t components_init(void) {
-    esp_err_t ret;
+// ---- 启动步骤: 依赖由 components_init 中的步骤表声明，彼此独立的步骤在两个核上并行 ----
 
-    // 初始化NVS
-    ret = nvs_flash_init();
+static esp_err_t step_nvs(void* arg) {
+    esp_err_t ret = nvs_flash_init();
     if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
         ESP_ERROR_CHECK(nvs_flash_erase());
         ret = nvs_flash_init();
     }
-    ESP_ERROR_CHECK(ret);
-
-    // 初始化SPIFFS文件系统
-    // ret = spiffs_init();
-    // if (ret != ESP_OK) {
-    //     ESP_LOGE(TAG, "Failed to initialize SPIFFS");
-    //     return ret;
-    // }
+    return ret;
+}
 
-    // 初始化I2C总线
-    ret = bsp_i2c_init();
+static esp_err_t step_i2c(void* arg) {
+    esp_err_t ret = bsp_i2c_init();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to initialize I2C bus");
-        return ret;
     }
+    return ret;
+}
 
-    // 初始化UI状态管理器
+static esp_err_t step_ui_state(void* arg) {
     ui_state_manager_init();
     ESP_LOGI(TAG, "UI state manager initialized");
+    return ESP_OK;
+}
 
-    // 初始化设置管理器
+static esp_err_t step_settings(void* arg) {
     settings_manager_init();
     ESP_LOGI(TAG, "Settings manager initialized.");
+    return ESP_OK;
+}
 
-    // 初始化状态栏管理器
-    ret = status_bar_manager_init();
+static esp_err_t step_status_bar(void* arg) {
+    esp_err_t ret = status_bar_manager_init();
     if (ret == ESP_OK) {
         ESP_LOGI(TAG, "Status bar manager initialized");
     } else {
         ESP_LOGW(TAG, "Status bar manager init failed: %s", esp_err_to_name(ret));
     }
+    return ESP_OK;
+}
 
-    // 初始化LVGL任务,用于实时显示加载动画
-    ret = init_lvgl_task();
+// LVGL 任务显示开机动画；动画界面就绪后才返回，保证后续进度更新不丢失
+static esp_err_t step_lvgl(void* arg) {
+    esp_err_t ret = init_lvgl_task();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to init LVGL task");
         return ret;
     }
-    // 等待开机动画界面真正就绪（避免后续进度更新丢失或延迟显示）
     extern bool ui_wait_start_anim_ready(TickType_t ticks_to_wait);
-    bool ready = ui_wait_start_anim_ready(pdMS_TO_TICKS(2000));
-    if (!ready) {
+    if (!ui_wait_start_anim_ready(pdMS_TO_TICKS(2000))) {
         ESP_LOGW(TAG, "Start animation not ready within 2s, continue anyway");
     }
     ui_start_animation_update_state(UI_STAGE_INITIALIZING);
-    ui_start_animation_set_progress((float)1 / UI_STAGE_DONE * 100);
+    return ESP_OK;
+}
 
-    // 初始化校准管理器
-    ret = calibration_manager_init();
+static esp_err_t step_calibration(void* arg) {
+    esp_err_t ret = calibration_manager_init();
     if (ret == ESP_OK) {
         ESP_LOGI(TAG, "Calibration manager initialized");
     } else {
         ESP_LOGW(TAG, "Calibration manager init failed: %s", esp_err_to_name(ret));
     }
-    ui_start_animation_update_state(UI_STAGE_LOADING_COMPONENTS);
-    ui_start_animation_set_progress((float)2 / UI_STAGE_DONE * 100);
-    vTaskDelay(pdMS_TO_TICKS(200)); // 确保动画有时间更新
+    return ESP_OK;
+}
 
-    // 初始化电池监测引脚
-    ret = battery_monitor_init();
+// 摇杆 ADC 连续采样 (电池通道也由其 DMA 采集，需先于电池监测初始化)
+static esp_err_t step_adc(void* arg) {
+    esp_err_t ret = joystick_adc_init();
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "Joystick ADC initialized");
+    } else {
+        ESP_LOGW(TAG, "Joystick ADC init failed: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+static esp_err_t step_battery(void* arg) {
+    esp_err_t ret = battery_monitor_init();
     if (ret == ESP_OK) {
         ESP_LOGI(TAG, "Battery monitor initialized");
     } else {
         ESP_LOGW(TAG, "Battery monitor init failed: %s", esp_err_to_name(ret));
     }
-    ui_start_animation_update_state(UI_STAGE_CONFIGURING_HARDWARE);
-    ui_start_animation_set_progress((float)3 / UI_STAGE_DONE * 100);
-    vTaskDelay(pdMS_TO_TICKS(200)); // 确保动画有时间更新
+    return ret;
+}
 
-    // 初始化LSM6DS3传感器
-    ret = lsm6ds3_init();
+static esp_err_t step_imu(void* arg) {
+    esp_err_t ret = lsm6ds3_init();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "LSM6DS3 initialization failed: %s", esp_err_to_name(ret));
     } else {
         ESP_LOGI(TAG, "LSM6DS3 initialized successfully");
     }
+    return ret;
+}
 
-    // 初始化GT911触摸控制器
-    ret = gt911_init();
+static esp_err_t step_touch(void* arg) {
+    esp_err_t ret = gt911_init();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "GT911 initialization failed: %s", esp_err_to_name(ret));
     } else {
         ESP_LOGI(TAG, "GT911 initialized successfully");
     }
+    return ESP_OK; // 无触摸时仍可用摇杆操作
+}
 
-    // 其他组件初始化可以在这里添加
-
-    // 初始化 LORA (SX1281) 引脚与SPI，读取一次状态作为握手
+// 初始化 LORA (SX1281) 引脚与SPI，读取一次状态作为握手
+static esp_err_t step_lora(void* arg) {
     sx1281_handle_t lora = NULL;
-    esp_err_t lora_ret = sx1281_create_default(&lora);
-    if (lora_ret == ESP_OK) {
+    esp_err_t ret = sx1281_create_default(&lora);
+    if (ret == ESP_OK) {
         uint8_t status = 0;
         if (sx1281_get_status(lora, &status) == ESP_OK) {
             ESP_LOGI(TAG, "SX1281 initialized, status=0x%02X", status);
@@ -203,9 +214,49 @@ esp_err_t components_init(void) {
             ESP_LOGW(TAG, "SX1281 initialized but status read failed");
         }
     } else {
-        ESP_LOGW(TAG, "SX1281 init skipped/failed: %s", esp_err_to_name(lora_ret));
+        ESP_LOGW(TAG, "SX1281 init skipped/failed: %s", esp_err_to_name(ret));
+    }
+    return ret;
+}
+
+/**
+ * @brief 登记所有必要组件的启动步骤，由 init_all_tasks 统一启动启动图
+ * @return esp_err_t ESP_OK成功，其他错误码失败
+ */
+esp_err_t components_init(void) {
+    // 事件追踪最先初始化，记录之后整个启动过程
+    if (sys_trace_init(0) == ESP_OK) {
+        sys_trace_start();
     }
 
-    ESP_LOGI(TAG, "All components initialized successfully");
+    // 初始化SPIFFS文件系统
+    // ret = spiffs_init();
+    // if (ret != ESP_OK) {
+    //     ESP_LOGE(TAG, "Failed to initialize SPIFFS");
+    //     return ret;
+    // }
+
+    // 显示链路绑定 Core 1 (LVGL 任务所在核)，其余步骤由空闲的核取走
+    static const boot_step_t steps[] = {
+        {.name = "nvs", .fn = step_nvs, .core = BOOT_CORE_ANY},
+        {.name = "i2c", .fn = step_i2c, .core = BOOT_CORE_ANY},
+        {.name = "ui_state", .fn = step_ui_state, .core = BOOT_CORE_ANY},
+        {.name = "settings", .fn = step_settings, .deps = "nvs", .core = BOOT_CORE_ANY},
+        {.name = "status_bar", .fn = step_status_bar, .deps = "settings", .core = BOOT_CORE_ANY},
+        {.name = "lvgl", .fn = step_lvgl, .deps = "settings,ui_state", .core = 1},
+        {.name = "calibration", .fn = step_calibration, .deps = "nvs", .core = BOOT_CORE_ANY},
+        {.name = "adc", .fn = step_adc, .core = BOOT_CORE_ANY},
+        {.name = "battery", .fn = step_battery, .deps = "adc", .core = BOOT_CORE_ANY},
+        {.name = "imu", .fn = step_imu, .deps = "i2c", .core = BOOT_CORE_ANY},
+        {.name = "touch", .fn = step_touch, .deps = "i2c", .core = BOOT_CORE_ANY},
+        {.name = "lora", .fn = step_lora, .core = BOOT_CORE_ANY},
+    };
+    esp_err_t ret = boot_graph_add(steps, sizeof(steps) / sizeof(steps[0]));
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register component boot steps");
+        return ret;
+    }
+
+    ESP_LOGI(TAG, "Component boot steps registered");
     return ESP_OK;
-}
\ No newline at end of file
+}
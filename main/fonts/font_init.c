@@ -1,4 +1,6 @@
 #include "my_font.h"
+#include "font_mmap.h"
+#include "metrics.h"
 #include "esp_log.h"
 #include "esp_partition.h"
 #include "esp_spi_flash.h"
@@ -97,6 +99,21 @@ void font_init(void) {
         return;
     }
 
+    // 优先直接在映射区上使用字体，仅索引与字形缓存占用 RAM
+    font_cn = font_mmap_create(mmap_ptr, font_partition_size);
+    if (font_cn) {
+        const font_mmap_stats_t *stats = font_mmap_get_stats(font_cn);
+        static metrics_desc_t metrics[2];
+        metrics[0] = (metrics_desc_t)METRICS_REF_INIT("font_glyph_cache_hits_total", "Glyph bitmap cache hits",
+                                                      METRICS_TYPE_COUNTER, &stats->cache_hits);
+        metrics[1] = (metrics_desc_t)METRICS_REF_INIT("font_glyph_cache_misses_total", "Glyph bitmaps unpacked from flash",
+                                                      METRICS_TYPE_COUNTER, &stats->cache_misses);
+        metrics_register_refs(metrics, 2);
+        ESP_LOGI(TAG, "Font mapped from partition, %lu bytes RAM", (unsigned long)stats->ram_bytes);
+        return;
+    }
+
+    ESP_LOGW(TAG, "Font not usable in place, loading into heap");
     static lv_fs_drv_t drv;
     lv_fs_drv_init(&drv);
 
@@ -0,0 +1,594 @@
+/**
+ * @file font_mmap.c
+ * @brief 内存映射字体 - 码点区间索引 + flash 上按需解码字形 + 内部 RAM LRU 位图缓存
+ *
+ * 文件布局 (均为小端，每个表以 uint32 长度 + 4 字节标签开头，长度含表头):
+ *   head: 字体参数；cmap: 码点子表；loca: 字形偏移；glyf: 位域描述符 + 位图；kern (可选): 字距
+ * 解码规则与 LVGL 的 lv_font_loader.c / lv_font_fmt_txt.c 保持一致。
+ */
+
+#include "font_mmap.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+static const char *TAG = "FONT_MMAP";
+
+#define HEAD_DATA_SIZE 40
+#define RAM_CAPS (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT)
+
+typedef struct {
+    uint32_t cp;  // 区间起始码点
+    uint32_t len;
+    uint32_t gid; // 起始码点的字形号，区间内随码点连续递增
+} cp_range_t;
+
+typedef enum {
+    KERN_NONE = 0,
+    KERN_PAIRS,   // 按 (左, 右) 字形号排序的字形对
+    KERN_CLASSES, // 左右分类映射 + 分类值矩阵
+} kern_type_t;
+
+typedef struct {
+    uint32_t adv_w; // 1/16 像素
+    int16_t ofs_x;
+    int16_t ofs_y;
+    uint16_t box_w;
+    uint16_t box_h;
+    const uint8_t *bmp; // 位图首字节
+    uint8_t bmp_shift;  // 位图在首字节中的起始位 (高位在前)
+    uint32_t bmp_avail; // 位图首字节起本字形记录剩余的字节数
+} glyph_t;
+
+typedef struct {
+    uint32_t gid; // 0 表示空槽
+    uint32_t stamp;
+} cache_tag_t;
+
+typedef struct {
+    lv_font_t font;
+    const uint8_t *base;
+    size_t size;
+
+    uint8_t bpp;
+    uint8_t xy_bits;
+    uint8_t wh_bits;
+    uint8_t adv_bits;
+    uint8_t adv_fmt; // 0: 整像素，1: 1/16 像素
+    uint8_t loc_fmt; // 0: uint16 偏移，1: uint32 偏移
+    uint8_t gid_fmt; // 字距表字形号 0: uint8，1: uint16
+    uint16_t default_adv;
+    uint16_t kern_scale;
+
+    const uint8_t *loca;
+    uint32_t glyph_count;
+    const uint8_t *glyf;
+    uint32_t glyf_len;
+
+    kern_type_t kern_type;
+    const uint8_t *kern_left;   // 字形对 / 左分类映射
+    const uint8_t *kern_right;  // 右分类映射
+    const uint8_t *kern_values;
+    uint32_t kern_count;        // 字形对数 / 分类映射长度
+    uint8_t kern_cols;
+
+    cp_range_t *ranges;
+    uint32_t range_count;
+
+    cache_tag_t tags[FONT_MMAP_CACHE_SLOTS];
+    uint8_t *slots;
+    uint32_t slot_bytes;
+    uint8_t *big; // 超出槽大小的字形
+    uint32_t big_bytes;
+    uint32_t clock;
+
+    font_mmap_stats_t stats;
+} font_mmap_t;
+
+static inline uint16_t rd16(const uint8_t *p) { return (uint16_t)(p[0] | (p[1] << 8)); }
+
+static inline uint32_t rd32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// 返回 ofs 处表的长度 (含表头)，标签不符或越界返回 0
+static uint32_t table_at(const font_mmap_t *f, uint32_t ofs, const char *label) {
+    if (ofs > f->size || f->size - ofs < 8 || memcmp(f->base + ofs + 4, label, 4) != 0) {
+        return 0;
+    }
+    const uint32_t len = rd32(f->base + ofs);
+    return (len >= 8 && len <= f->size - ofs) ? len : 0;
+}
+
+// 从 p 的第 bit 位起按高位在前读取 n 位 (n < 32)
+static uint32_t read_bits(const uint8_t *p, uint32_t bit, uint32_t n) {
+    uint32_t v = 0;
+    while (n > 0) {
+        const uint32_t avail = 8 - (bit & 7);
+        const uint32_t take = n < avail ? n : avail;
+        v = (v << take) | ((p[bit >> 3] >> (avail - take)) & ((1u << take) - 1));
+        bit += take;
+        n -= take;
+    }
+    return v;
+}
+
+static int32_t read_bits_signed(const uint8_t *p, uint32_t bit, uint32_t n) {
+    uint32_t v = read_bits(p, bit, n);
+    if (n > 0 && (v & (1u << (n - 1)))) {
+        v |= ~0u << n;
+    }
+    return (int32_t)v;
+}
+
+// ---- 码点索引 ----
+
+typedef struct {
+    cp_range_t *out; // NULL 时只计数
+    uint32_t n;
+    cp_range_t cur;
+    bool open;
+} range_builder_t;
+
+static void rb_flush(range_builder_t *b) {
+    if (b->open) {
+        if (b->out) {
+            b->out[b->n] = b->cur;
+        }
+        b->n++;
+        b->open = false;
+    }
+}
+
+static void rb_add(range_builder_t *b, uint32_t cp, uint32_t len, uint32_t gid) {
+    if (len == 0) {
+        return;
+    }
+    if (b->open && cp == b->cur.cp + b->cur.len && gid == b->cur.gid + b->cur.len) {
+        b->cur.len += len;
+        return;
+    }
+    rb_flush(b);
+    b->cur = (cp_range_t){.cp = cp, .len = len, .gid = gid};
+    b->open = true;
+}
+
+// 遍历 cmap 子表生成区间；out 为 NULL 时只返回区间数，格式错误返回 UINT32_MAX
+static uint32_t build_ranges(const font_mmap_t *f, const uint8_t *cmap, uint32_t cmap_len, cp_range_t *out) {
+    range_builder_t b = {.out = out};
+    const uint32_t count = rd32(cmap + 8);
+    if (count > (cmap_len - 12) / 16) {
+        return UINT32_MAX;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        const uint8_t *e = cmap + 12 + i * 16;
+        const uint32_t data_ofs = rd32(e);
+        const uint32_t start = rd32(e + 4);
+        const uint32_t range_len = rd16(e + 8);
+        const uint32_t gid_start = rd16(e + 10);
+        const uint32_t entries = rd16(e + 12);
+        const uint8_t *data = cmap + data_ofs;
+        const uint32_t room = data_ofs <= cmap_len ? cmap_len - data_ofs : 0;
+
+        switch (e[14]) {
+        case 0: // format0 full: uint8 字形号偏移
+            if (room < entries) {
+                return UINT32_MAX;
+            }
+            for (uint32_t k = 0; k < entries && k < range_len; k++) {
+                rb_add(&b, start + k, 1, gid_start + data[k]);
+            }
+            break;
+        case 1: // sparse full: uint16 码点偏移 + uint16 字形号偏移
+            if (room < entries * 4) {
+                return UINT32_MAX;
+            }
+            for (uint32_t k = 0; k < entries; k++) {
+                rb_add(&b, start + rd16(data + k * 2), 1, gid_start + rd16(data + entries * 2 + k * 2));
+            }
+            break;
+        case 2: // format0 tiny: 整段连续
+            rb_add(&b, start, range_len, gid_start);
+            break;
+        case 3: // sparse tiny: uint16 码点偏移，字形号连续
+            if (room < entries * 2) {
+                return UINT32_MAX;
+            }
+            for (uint32_t k = 0; k < entries; k++) {
+                rb_add(&b, start + rd16(data + k * 2), 1, gid_start + k);
+            }
+            break;
+        default:
+            return UINT32_MAX;
+        }
+    }
+    rb_flush(&b);
+    return b.n;
+}
+
+// lv_font_conv 输出的子表已按码点排序，这里兜底排序并合并相邻区间
+static uint32_t sort_and_merge(cp_range_t *r, uint32_t n) {
+    for (uint32_t i = 1; i < n; i++) {
+        const cp_range_t v = r[i];
+        uint32_t j = i;
+        for (; j > 0 && r[j - 1].cp > v.cp; j--) {
+            r[j] = r[j - 1];
+        }
+        r[j] = v;
+    }
+    uint32_t m = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        if (m > 0 && r[i].cp == r[m - 1].cp + r[m - 1].len && r[i].gid == r[m - 1].gid + r[m - 1].len) {
+            r[m - 1].len += r[i].len;
+        } else {
+            r[m++] = r[i];
+        }
+    }
+    return m;
+}
+
+static uint32_t lookup_gid(const font_mmap_t *f, uint32_t cp) {
+    uint32_t lo = 0;
+    uint32_t hi = f->range_count;
+    while (lo < hi) {
+        const uint32_t mid = (lo + hi) / 2;
+        const cp_range_t *r = &f->ranges[mid];
+        if (cp < r->cp) {
+            hi = mid;
+        } else if (cp - r->cp >= r->len) {
+            lo = mid + 1;
+        } else {
+            return r->gid + (cp - r->cp);
+        }
+    }
+    return 0;
+}
+
+// ---- 字形与字距 ----
+
+static bool glyph_decode(const font_mmap_t *f, uint32_t gid, glyph_t *g) {
+    if (gid == 0 || gid >= f->glyph_count) {
+        return false;
+    }
+    const uint32_t ofs = f->loc_fmt ? rd32(f->loca + gid * 4) : rd16(f->loca + gid * 2);
+    if (ofs >= f->glyf_len) {
+        return false;
+    }
+    const uint8_t *p = f->glyf + ofs;
+    uint32_t bit = 0;
+
+    g->adv_w = f->default_adv;
+    if (f->adv_bits) {
+        g->adv_w = read_bits(p, bit, f->adv_bits);
+        bit += f->adv_bits;
+    }
+    if (f->adv_fmt == 0) {
+        g->adv_w *= 16;
+    }
+    g->ofs_x = (int16_t)read_bits_signed(p, bit, f->xy_bits);
+    g->ofs_y = (int16_t)read_bits_signed(p, bit + f->xy_bits, f->xy_bits);
+    bit += 2 * f->xy_bits;
+    g->box_w = (uint16_t)read_bits(p, bit, f->wh_bits);
+    g->box_h = (uint16_t)read_bits(p, bit + f->wh_bits, f->wh_bits);
+    bit += 2 * f->wh_bits;
+
+    g->bmp = p + bit / 8;
+    g->bmp_shift = bit % 8;
+    g->bmp_avail = f->glyf_len - ofs - bit / 8;
+    const uint32_t need = (g->bmp_shift + (uint32_t)g->box_w * g->box_h * f->bpp + 7) / 8;
+    return need <= g->bmp_avail;
+}
+
+static int32_t kern_value(const font_mmap_t *f, uint32_t left, uint32_t right) {
+    if (f->kern_type == KERN_CLASSES) {
+        if (left >= f->kern_count || right >= f->kern_count) {
+            return 0;
+        }
+        const uint8_t lc = f->kern_left[left];
+        const uint8_t rc = f->kern_right[right];
+        return (lc && rc) ? (int8_t)f->kern_values[(lc - 1) * f->kern_cols + (rc - 1)] : 0;
+    }
+
+    if (f->gid_fmt == 0 && (left > 0xFF || right > 0xFF)) {
+        return 0;
+    }
+    const uint32_t key = (left << 16) | right;
+    uint32_t lo = 0;
+    uint32_t hi = f->kern_count;
+    while (lo < hi) {
+        const uint32_t mid = (lo + hi) / 2;
+        uint32_t k;
+        if (f->gid_fmt) {
+            k = ((uint32_t)rd16(f->kern_left + mid * 4) << 16) | rd16(f->kern_left + mid * 4 + 2);
+        } else {
+            k = ((uint32_t)f->kern_left[mid * 2] << 16) | f->kern_left[mid * 2 + 1];
+        }
+        if (k == key) {
+            return (int8_t)f->kern_values[mid];
+        }
+        if (k < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return 0;
+}
+
+static bool parse_kern(font_mmap_t *f, uint32_t ofs) {
+    const uint32_t len = table_at(f, ofs, "kern");
+    if (len < 12) {
+        return false;
+    }
+    const uint8_t *k = f->base + ofs;
+    const uint8_t format = k[8];
+    if (format == 0 && len >= 16) {
+        const uint32_t pairs = rd32(k + 12);
+        const uint32_t ids = pairs * (f->gid_fmt ? 4 : 2);
+        if (pairs > len || 16 + ids + pairs > len) {
+            return false;
+        }
+        f->kern_type = KERN_PAIRS;
+        f->kern_left = k + 16;
+        f->kern_values = k + 16 + ids;
+        f->kern_count = pairs;
+        return true;
+    }
+    if (format == 3 && len >= 16) {
+        const uint32_t map_len = rd16(k + 12);
+        const uint32_t rows = k[14];
+        const uint32_t cols = k[15];
+        if (16 + 2 * map_len + rows * cols > len) {
+            return false;
+        }
+        f->kern_type = KERN_CLASSES;
+        f->kern_left = k + 16;
+        f->kern_right = k + 16 + map_len;
+        f->kern_values = k + 16 + 2 * map_len;
+        f->kern_count = map_len;
+        f->kern_cols = (uint8_t)cols;
+        return true;
+    }
+    return false;
+}
+
+// ---- LVGL 回调 ----
+
+static bool font_mmap_get_glyph_dsc(const lv_font_t *font, lv_font_glyph_dsc_t *dsc_out, uint32_t letter,
+                                    uint32_t letter_next) {
+    const font_mmap_t *f = (const font_mmap_t *)font->dsc;
+    bool is_tab = false;
+    if (letter == '\t') {
+        letter = ' ';
+        is_tab = true;
+    }
+    const uint32_t gid = lookup_gid(f, letter);
+    glyph_t g;
+    if (!glyph_decode(f, gid, &g)) {
+        return false;
+    }
+
+    int32_t kv = 0;
+    if (f->kern_type != KERN_NONE) {
+        const uint32_t gid_next = lookup_gid(f, letter_next);
+        if (gid_next) {
+            kv = (kern_value(f, gid, gid_next) * f->kern_scale) >> 4;
+        }
+    }
+
+    uint32_t adv_w = g.adv_w;
+    if (is_tab) {
+        adv_w *= 2;
+    }
+    adv_w += kv;
+    dsc_out->adv_w = (adv_w + (1 << 3)) >> 4;
+    dsc_out->box_w = is_tab ? g.box_w * 2 : g.box_w;
+    dsc_out->box_h = g.box_h;
+    dsc_out->ofs_x = g.ofs_x;
+    dsc_out->ofs_y = g.ofs_y;
+    dsc_out->bpp = f->bpp;
+    dsc_out->is_placeholder = false;
+    return true;
+}
+
+// 把按位排列的位图左移到字节边界，多余的尾部位清零
+static void bitmap_unpack(const glyph_t *g, uint32_t bits, uint8_t *dst) {
+    const uint32_t bytes = (bits + 7) / 8;
+    const uint8_t *src = g->bmp;
+    const uint8_t s = g->bmp_shift;
+    if (s == 0) {
+        memcpy(dst, src, bytes);
+    } else {
+        const uint32_t src_bytes = (s + bits + 7) / 8;
+        for (uint32_t k = 0; k < bytes; k++) {
+            const uint8_t next = (k + 1 < src_bytes) ? src[k + 1] : 0;
+            dst[k] = (uint8_t)((src[k] << s) | (next >> (8 - s)));
+        }
+    }
+    if (bits & 7) {
+        dst[bytes - 1] &= (uint8_t)(0xFF << (8 - (bits & 7)));
+    }
+}
+
+static const uint8_t *font_mmap_get_glyph_bitmap(const lv_font_t *font, uint32_t letter) {
+    static const uint8_t empty[1] = {0};
+    font_mmap_t *f = (font_mmap_t *)font->dsc;
+    if (letter == '\t') {
+        letter = ' ';
+    }
+    const uint32_t gid = lookup_gid(f, letter);
+    if (gid == 0) {
+        return NULL;
+    }
+
+    uint32_t victim = 0;
+    for (uint32_t i = 0; i < FONT_MMAP_CACHE_SLOTS; i++) {
+        if (f->tags[i].gid == gid) {
+            f->tags[i].stamp = ++f->clock;
+            f->stats.cache_hits++;
+            return f->slots + i * f->slot_bytes;
+        }
+        if (f->tags[i].stamp < f->tags[victim].stamp) {
+            victim = i;
+        }
+    }
+
+    glyph_t g;
+    if (!glyph_decode(f, gid, &g)) {
+        return NULL;
+    }
+    const uint32_t bits = (uint32_t)g.box_w * g.box_h * f->bpp;
+    if (bits == 0) {
+        return empty;
+    }
+    f->stats.cache_misses++;
+
+    const uint32_t bytes = (bits + 7) / 8;
+    uint8_t *dst;
+    if (bytes <= f->slot_bytes) {
+        dst = f->slots + victim * f->slot_bytes;
+        f->tags[victim].gid = gid;
+        f->tags[victim].stamp = ++f->clock;
+    } else {
+        if (bytes > f->big_bytes) {
+            uint8_t *buf = heap_caps_realloc(f->big, bytes, RAM_CAPS);
+            if (buf == NULL) {
+                return NULL;
+            }
+            f->big = buf;
+            f->big_bytes = bytes;
+        }
+        dst = f->big;
+    }
+    bitmap_unpack(&g, bits, dst);
+    return dst;
+}
+
+// ---- 创建 ----
+
+static bool parse_font(font_mmap_t *f, uint32_t *cmap_ofs, uint32_t *cmap_len) {
+    const uint32_t head_len = table_at(f, 0, "head");
+    if (head_len < 8 + HEAD_DATA_SIZE) {
+        ESP_LOGE(TAG, "Missing head table");
+        return false;
+    }
+    const uint8_t *h = f->base + 8;
+    const uint16_t tables = rd16(h + 4);
+    const int16_t ascent = (int16_t)rd16(h + 8);
+    const int16_t descent = (int16_t)rd16(h + 10);
+    f->default_adv = rd16(h + 22);
+    f->kern_scale = rd16(h + 24);
+    f->loc_fmt = h[26];
+    f->gid_fmt = h[27];
+    f->adv_fmt = h[28];
+    f->bpp = h[29];
+    f->xy_bits = h[30];
+    f->wh_bits = h[31];
+    f->adv_bits = h[32];
+    const uint8_t compression = h[33];
+    const uint8_t subpx = h[34];
+
+    if (compression != 0 || !(f->bpp == 1 || f->bpp == 2 || f->bpp == 4 || f->bpp == 8) || f->loc_fmt > 1 ||
+        f->xy_bits > 16 || f->wh_bits > 16 || f->adv_bits > 16) {
+        ESP_LOGW(TAG, "Unsupported font: bpp %u, compression %u", f->bpp, compression);
+        return false;
+    }
+
+    *cmap_ofs = head_len;
+    *cmap_len = table_at(f, *cmap_ofs, "cmap");
+    const uint32_t loca_ofs = *cmap_ofs + *cmap_len;
+    const uint32_t loca_len = *cmap_len >= 12 ? table_at(f, loca_ofs, "loca") : 0;
+    const uint32_t glyf_ofs = loca_ofs + loca_len;
+    f->glyf_len = loca_len >= 12 ? table_at(f, glyf_ofs, "glyf") : 0;
+    if (f->glyf_len == 0) {
+        ESP_LOGE(TAG, "Missing cmap/loca/glyf table");
+        return false;
+    }
+    f->glyph_count = rd32(f->base + loca_ofs + 8);
+    if (f->glyph_count > (loca_len - 12) / (f->loc_fmt ? 4 : 2)) {
+        ESP_LOGE(TAG, "loca table truncated");
+        return false;
+    }
+    f->loca = f->base + loca_ofs + 12;
+    f->glyf = f->base + glyf_ofs;
+
+    if (tables >= 4 && !parse_kern(f, glyf_ofs + f->glyf_len)) {
+        ESP_LOGW(TAG, "Kerning table missing or unsupported, kerning disabled");
+    }
+
+    lv_font_t *font = &f->font;
+    font->get_glyph_dsc = font_mmap_get_glyph_dsc;
+    font->get_glyph_bitmap = font_mmap_get_glyph_bitmap;
+    font->line_height = ascent - descent;
+    font->base_line = -descent;
+    font->subpx = subpx;
+    font->underline_position = (int8_t)rd16(h + 36);
+    font->underline_thickness = (int8_t)rd16(h + 38);
+    font->dsc = f;
+    return true;
+}
+
+lv_font_t *font_mmap_create(const void *data, size_t size) {
+    if (data == NULL) {
+        return NULL;
+    }
+    font_mmap_t *f = heap_caps_calloc(1, sizeof(font_mmap_t), RAM_CAPS);
+    if (f == NULL) {
+        return NULL;
+    }
+    f->base = data;
+    f->size = size;
+
+    uint32_t cmap_ofs = 0;
+    uint32_t cmap_len = 0;
+    if (!parse_font(f, &cmap_ofs, &cmap_len)) {
+        heap_caps_free(f);
+        return NULL;
+    }
+
+    const uint8_t *cmap = f->base + cmap_ofs;
+    const uint32_t n = build_ranges(f, cmap, cmap_len, NULL);
+    if (n == UINT32_MAX || n == 0) {
+        ESP_LOGE(TAG, "Invalid cmap table");
+        heap_caps_free(f);
+        return NULL;
+    }
+    f->ranges = heap_caps_malloc(n * sizeof(cp_range_t), RAM_CAPS);
+    const uint32_t max_side = (1u << f->wh_bits) - 1;
+    const uint32_t max_bytes = (max_side * max_side * f->bpp + 7) / 8;
+    f->slot_bytes = ((max_bytes < FONT_MMAP_SLOT_MAX_BYTES ? max_bytes : FONT_MMAP_SLOT_MAX_BYTES) + 3) & ~3u;
+    f->slots = heap_caps_malloc(f->slot_bytes * FONT_MMAP_CACHE_SLOTS, RAM_CAPS);
+    if (f->ranges == NULL || f->slots == NULL) {
+        ESP_LOGE(TAG, "No memory for font index/cache");
+        font_mmap_destroy(&f->font);
+        return NULL;
+    }
+    build_ranges(f, cmap, cmap_len, f->ranges);
+    f->range_count = sort_and_merge(f->ranges, n);
+
+    f->stats.glyphs = f->glyph_count;
+    f->stats.ranges = f->range_count;
+    f->stats.ram_bytes = sizeof(font_mmap_t) + n * sizeof(cp_range_t) + f->slot_bytes * FONT_MMAP_CACHE_SLOTS;
+    ESP_LOGI(TAG, "Font mapped: %lu glyphs, %lu ranges, %u bpp, cache %u x %lu bytes",
+             (unsigned long)f->glyph_count, (unsigned long)f->range_count, f->bpp, FONT_MMAP_CACHE_SLOTS,
+             (unsigned long)f->slot_bytes);
+    return &f->font;
+}
+
+void font_mmap_destroy(lv_font_t *font) {
+    if (font == NULL) {
+        return;
+    }
+    font_mmap_t *f = (font_mmap_t *)font->dsc;
+    heap_caps_free(f->ranges);
+    heap_caps_free(f->slots);
+    heap_caps_free(f->big);
+    heap_caps_free(f);
+}
+
+const font_mmap_stats_t *font_mmap_get_stats(const lv_font_t *font) {
+    return &((const font_mmap_t *)font->dsc)->stats;
+}
@@ -0,0 +1,49 @@
+/**
+ * @file font_mmap.h
+ * @brief 内存映射字体 - 直接在映射的 flash 上使用 LVGL 二进制字体 (lv_font_conv --format bin)
+ *
+ * lv_font_load 会把整个字体 (含全部位图，CJK 字库约 1.4 MB) 解码复制到堆上。这里 RAM 中只保留:
+ *   - 码点索引: 按码点排序的连续区间表 (码点 -> 字形号)，lv_font_conv 生成的 CJK 0x4E00-0x9FA5
+ *     各子表会合并为一个区间，查找为对少量区间的二分；
+ *   - 位图缓存: 内部 RAM 中的小型 LRU 缓存。文件中位图紧跟在位域描述符之后，一般不按字节对齐，
+ *     需移位解包后才能交给 LVGL。
+ * 字形描述符、字距表每次从 flash 按需解码，不占 RAM。
+ *
+ * 仅支持未压缩位图 (1/2/4/8 bpp)；压缩或格式不符时返回 NULL，调用方可回退到 lv_font_load。
+ * 字体回调只在 LVGL 任务中调用，缓存不加锁。
+ */
+
+#ifndef FONT_MMAP_H
+#define FONT_MMAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "lvgl.h"
+
+#define FONT_MMAP_CACHE_SLOTS 32     // 缓存的已解包字形数
+#define FONT_MMAP_SLOT_MAX_BYTES 512 // 单个缓存槽上限，更大的字形解包到单独的临时缓冲区
+
+typedef struct {
+    uint32_t glyphs;       // 字形数 (含保留的 0 号)
+    uint32_t ranges;       // 码点索引区间数
+    uint32_t ram_bytes;    // 索引与缓存占用的 RAM
+    uint32_t cache_hits;
+    uint32_t cache_misses; // 每次未命中解包一个字形
+} font_mmap_stats_t;
+
+/**
+ * @brief 在映射的字体数据上创建字体
+ * @param data 字体文件起始地址 (需在字体生命周期内保持映射)
+ * @param size 可访问的字节数 (可大于文件本身，如整个分区)
+ * @return 字体对象；格式不支持或内存不足返回 NULL
+ */
+lv_font_t* font_mmap_create(const void* data, size_t size);
+
+void font_mmap_destroy(lv_font_t* font);
+
+/**
+ * @brief 字体的实时统计，地址在字体生命周期内不变 (可用于注册指标)
+ */
+const font_mmap_stats_t* font_mmap_get_stats(const lv_font_t* font);
+
+#endif // FONT_MMAP_H
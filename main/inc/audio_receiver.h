@@ -12,7 +12,40 @@ extern "C" {
 #endif
 
 #include "esp_err.h"
+#include "audio_jitter.h"
+#include "audio_mixer.h"
+#include <stddef.h>
 #include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    AUDIO_TRANSPORT_NONE = 0,
+    AUDIO_TRANSPORT_TCP, // 端口 7557，可靠传输，单客户端
+    AUDIO_TRANSPORT_UDP, // 端口 7557，RTP 格式小包，低延迟 (见 audio_rtp.h)
+} audio_transport_t;
+
+typedef enum {
+    AUDIO_STREAM_MODE_DETECT = 0, // 等待首个数据判断格式
+    AUDIO_STREAM_MODE_RAW,        // 旧格式: 44.1kHz PCM
+    AUDIO_STREAM_MODE_CODED,      // 协商后的分块编码流 (见 audio_codec.h)
+} audio_stream_mode_t;
+
+typedef struct {
+    audio_transport_t transport;
+    audio_stream_mode_t mode;
+    uint8_t codec;          // audio_codec_id_t
+    uint32_t sample_rate;
+    uint32_t rx_bytes;      // 网络接收字节
+    uint64_t pcm_bytes;     // 解码后送入抖动缓冲的字节
+    uint32_t blocks;        // 已接收块数 (UDP 为包数)
+    uint32_t lost_blocks;   // 按块序号推算的丢失块数
+    uint32_t bad_blocks;    // 解码失败块数
+    uint32_t resync_bytes;  // 重新同步跳过的字节
+    uint16_t next_seq;      // 期望的下一个块序号
+    audio_jitter_stats_t jitter; // 抖动缓冲 (深度/目标延迟/欠载/漂移)
+    uint32_t output_rate;   // I2S 输出采样率 (流经混音器重采样到此采样率)
+    uint32_t mix_clipped_samples; // 混音饱和的采样数
+} audio_receiver_stats_t;
 
 /**
  * @brief 启动音频接收服务
@@ -31,6 +64,34 @@ void audio_receiver_stop(void);
  */
 bool audio_receiver_is_receiving(void);
 
+/**
+ * @brief 获取当前 (或最近一次) 连接的音频流统计
+ * @param stats 输出
+ */
+void audio_receiver_get_stats(audio_receiver_stats_t* stats);
+
+/**
+ * @brief 播放提示音 (与网络音频混音)
+ * @param notes 音符序列，频率为 0 表示停顿
+ * @param volume 音量 0~100
+ * @return ESP_ERR_INVALID_STATE 音频服务未启动；ESP_ERR_NO_MEM 音效通道已满
+ */
+esp_err_t audio_receiver_play_tone(const audio_tone_note_t* notes, size_t count, uint8_t volume);
+
+/**
+ * @brief 播放 PCM 音效 (任意采样率，经重采样后混音)
+ * @param pcm 单声道 PCM，播放结束前需保持有效 (通常为常量数据)
+ * @param volume 音量 0~100
+ * @return ESP_ERR_INVALID_STATE 音频服务未启动；ESP_ERR_NO_MEM 音效通道已满；ESP_ERR_INVALID_ARG 采样率不支持
+ */
+esp_err_t audio_receiver_play_pcm(const int16_t* pcm, size_t samples, uint32_t sample_rate, uint8_t volume);
+
+/**
+ * @brief 设置网络音频流音量
+ * @param volume 0~100
+ */
+void audio_receiver_set_stream_volume(uint8_t volume);
+
 #ifdef __cplusplus
 }
 #endif
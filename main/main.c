@@ -19,6 +19,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
+#include "boot_graph.h"
 #include "spi_slave_receiver.h"
 #include "usb_device_receiver.h"
 #include "led_status_manager.h"
@@ -34,45 +35,52 @@ static void log_heap_info(const char* step) {
     ESP_LOGI(TAG, "  PSRAM free: %u bytes", heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
 }
 
-void app_main(void) {
-
-    // 初始化NVS
+static esp_err_t step_nvs(void* arg) {
     esp_err_t ret = nvs_flash_init();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to initialize NVS: %s", esp_err_to_name(ret));
-        return;
     }
+    return ret;
+}
 
-    log_heap_info("Initial");
-
-    // 初始化LED管理器
+// 初始化LED管理器
+static esp_err_t step_led(void* arg) {
     led_manager_config_t led_manager_config = {
         .led_count = 1, .queue_size = 1, .task_priority = 2, .task_stack_size = 2048};
-    if (led_status_manager_init(&led_manager_config) == ESP_OK) {
-        led_status_set_style(LED_STYLE_RED_SOLID, LED_PRIORITY_LOW, 0);
-        log_heap_info("After LED Manager Init");
-    } else {
+    if (led_status_manager_init(&led_manager_config) != ESP_OK) {
         ESP_LOGE(TAG, "Failed to initialize LED Status Manager");
+        return ESP_FAIL;
     }
+    led_status_set_style(LED_STYLE_RED_SOLID, LED_PRIORITY_LOW, 0);
+    log_heap_info("After LED Manager Init");
+    return ESP_OK;
+}
 
-    // 初始化 SPI 从机并启动接收任务
-    if (spi_receiver_init() == ESP_OK) {
-        spi_receiver_start();
-        log_heap_info("After SPI Receiver Init");
-    } else {
+// 初始化 SPI 从机并启动接收任务
+static esp_err_t step_spi(void* arg) {
+    if (spi_receiver_init() != ESP_OK) {
         ESP_LOGE(TAG, "Failed to initialize SPI Receiver");
+        return ESP_FAIL;
     }
+    spi_receiver_start();
+    log_heap_info("After SPI Receiver Init");
+    return ESP_OK;
+}
 
-    // 初始化 USB CDC 从机并启动接收任务
+// 初始化 USB CDC 从机并启动接收任务
+static esp_err_t step_usb(void* arg) {
     ESP_LOGI(TAG, "开始初始化USB Receiver");
-    if (usb_receiver_init() == ESP_OK) {
-        usb_receiver_start();
-        log_heap_info("After USB Receiver Init");
-    } else {
+    if (usb_receiver_init() != ESP_OK) {
         ESP_LOGE(TAG, "Failed to initialize USB Receiver");
+        return ESP_FAIL;
     }
+    usb_receiver_start();
+    log_heap_info("After USB Receiver Init");
+    return ESP_OK;
+}
 
-    // 启动事件驱动的TCP管理器
+// 启动带WIFI事件集成的TCP管理器，连上网络后由其事件驱动启动TCP模块
+static esp_err_t step_tcp_manager(void* arg) {
     ESP_LOGI(TAG, "启动事件驱动TCP管理器");
 
     // 初始化WiFi配对管理器
@@ -84,17 +92,42 @@ void app_main(void) {
         .target_ssid_prefix = "tidy_",
         .default_password = "22989822",
     };
-    // 启动带WIFI事件集成的TCP管理器
-    esp_err_t tcp_result = tcp_task_manager_start_with_wifi(&wifi_config);
-    if (tcp_result != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to start TCP manager: %s", esp_err_to_name(tcp_result));
-    } else {
-        ESP_LOGI(TAG, "Event-driven TCP manager started successfully");
-        log_heap_info("After TCP Manager Init");
+    esp_err_t ret = tcp_task_manager_start_with_wifi(&wifi_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start TCP manager: %s", esp_err_to_name(ret));
+        return ret;
     }
+    ESP_LOGI(TAG, "Event-driven TCP manager started successfully");
+    log_heap_info("After TCP Manager Init");
+    return ESP_OK;
+}
 
-    // 启动TCP服务器
+// 启动TCP服务器
+static esp_err_t step_tcp_server(void* arg) {
     tcp_server_start();
+    return ESP_OK;
+}
+
+void app_main(void) {
+    log_heap_info("Initial");
+
+    // LED、SPI、USB 互不依赖，与 WiFi 初始化在两个核上并行
+    static const boot_step_t steps[] = {
+        {.name = "nvs", .fn = step_nvs, .core = BOOT_CORE_ANY},
+        {.name = "led", .fn = step_led, .core = BOOT_CORE_ANY},
+        {.name = "spi", .fn = step_spi, .core = BOOT_CORE_ANY},
+        {.name = "usb", .fn = step_usb, .core = BOOT_CORE_ANY},
+        {.name = "tcp_manager", .fn = step_tcp_manager, .deps = "nvs", .core = BOOT_CORE_ANY},
+        {.name = "tcp_server", .fn = step_tcp_server, .deps = "tcp_manager", .core = BOOT_CORE_ANY},
+    };
+    esp_err_t ret = boot_graph_add(steps, sizeof(steps) / sizeof(steps[0]));
+    if (ret == ESP_OK) {
+        ret = boot_graph_start(8192, 5);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start boot graph: %s", esp_err_to_name(ret));
+        return;
+    }
 
     while (1) {
         ESP_LOGI(TAG, "Receiver running, free heap: %lu bytes",
@@ -117,6 +150,7 @@ void app_main(void) {
 #include "freertos/task.h"
 
 // 项目组件头文件
+#include "boot_graph.h"
 #include "task_init.h"
 
 static const char* TAG = "MAIN";
@@ -139,8 +173,10 @@ void app_main(void) {
         return;
     }
 
-    // 显示当前运行的任务
-    vTaskDelay(pdMS_TO_TICKS(1000)); // 等待任务启动
+    // 主界面切换完成后显示当前运行的任务
+    if (!boot_graph_wait("ui_done", pdMS_TO_TICKS(5000))) {
+        ESP_LOGW(TAG, "UI not ready within 5s after boot start");
+    }
     list_running_tasks();
 
     // 主任务进入轻量级监控循环
@@ -1,5 +1,6 @@
 // ESP-IDF 核心头文件
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
@@ -7,12 +8,17 @@
 #include "../app/Telemetry/inc/tcp_server_hb.h"
 #include "../app/inc/auto_pairing.h"
 #include "background_manager.h"
+#include "boot_graph.h"
 #include "joystick_adc.h"
 #include "lsm6ds_control.h"
 #include "lvgl_main.h"
 #include "power_management.h"
 #include "serial_display.h"
 #include "task_init.h"
+#include "metrics_server.h"
+#include "sys_monitor.h"
+#include "sys_trace.h"
+#include "trace_export.h"
 #include "wifi_manager.h"
 #include "key.h"
 #include "ui.h"
@@ -32,15 +38,15 @@ static TaskHandle_t s_power_task_handle = NULL;
 static TaskHandle_t s_monitor_task_handle = NULL;
 static TaskHandle_t s_battery_task_handle = NULL;
 static TaskHandle_t s_joystick_task_handle = NULL;
-static TaskHandle_t s_wifi_task_handle = NULL;
 static TaskHandle_t s_audio_receiver_task_handle = NULL;
 static TaskHandle_t s_serial_display_task_handle = NULL;
 static TaskHandle_t s_tcp_hb_server_task_handle = NULL;
 
-// 摇杆ADC采样任务（200Hz）
+// 摇杆与按键任务: 摇杆由 ADC DMA 回调自行采样发布，本任务只负责按键扫描
 static void joystick_adc_task(void* pvParameters) {
     ESP_LOGI(TAG, "Joystick ADC Task started on core %d", xPortGetCoreID());
 
+    // 通常已在 components_init 中启动，此处重复调用直接返回
     if (joystick_adc_init() != ESP_OK) {
         ESP_LOGE(TAG, "Joystick ADC init failed");
         vTaskDelete(NULL);
@@ -53,13 +59,10 @@ static void joystick_adc_task(void* pvParameters) {
         return;
     }
 
-    const TickType_t period_ticks = pdMS_TO_TICKS(20); // 50Hz = 20ms，降低频率避免看门狗超时
-
-    joystick_data_t data;
+    const TickType_t period_ticks = pdMS_TO_TICKS(20); // 50Hz 按键扫描
 
     while (1) {
         key_scan();
-        joystick_adc_read(&data);
         vTaskDelay(period_ticks);
     }
 }
@@ -82,6 +85,18 @@ static void system_monitor_task(void* pvParameters) {
         ESP_LOGI(TAG, "Min free heap: %lu bytes", (unsigned long)esp_get_minimum_free_heap_size());
         ESP_LOGI(TAG, "Stack high water mark: %lu bytes",
                  (unsigned long)uxTaskGetStackHighWaterMark(NULL));
+        sys_monitor_sample_t sample;
+        if (sys_monitor_get_latest(&sample)) {
+            ESP_LOGI(TAG, "CPU load: core0 %u.%u%%, core1 %u.%u%%, internal largest block %lu bytes (frag %u%%)",
+                     sample.core_load_x10[0] / 10, sample.core_load_x10[0] % 10, sample.core_load_x10[1] / 10,
+                     sample.core_load_x10[1] % 10,
+                     (unsigned long)sample.heap[SYS_MONITOR_HEAP_INTERNAL].largest_block,
+                     sys_monitor_fragmentation(&sample.heap[SYS_MONITOR_HEAP_INTERNAL]));
+        }
+        sys_trace_stats_t trace_stats;
+        sys_trace_get_stats(&trace_stats);
+        ESP_LOGI(TAG, "Trace events: %lu recorded, %lu overwritten", (unsigned long)trace_stats.recorded,
+                 (unsigned long)trace_stats.lost);
 
         // 任务状态检查
         if (s_lvgl_task_handle) {
@@ -100,32 +115,14 @@ static void system_monitor_task(void* pvParameters) {
     }
 }
 
-static void wifi_manager_task(void* pvParameters) {
-    ESP_LOGI(TAG, "WiFi Manager Task started on core %d", xPortGetCoreID());
-
-    esp_err_t ret = wifi_manager_init(NULL);
-    if (ret == ESP_OK) {
-        ESP_LOGI(TAG, "WiFi manager initialized");
-        ret = wifi_manager_start();
-        if (ret != ESP_OK) {
-            ESP_LOGW(TAG, "WiFi start failed: %s", esp_err_to_name(ret));
-        }
-    } else {
-        ESP_LOGW(TAG, "WiFi init failed: %s", esp_err_to_name(ret));
-    }
-
-    // Task can terminate after starting WiFi connection process
-    vTaskDelete(NULL);
-}
-
 // 电池监测任务（现在由后台管理模块处理，此任务主要用于日志记录）
 static void battery_monitor_task(void* pvParameters) {
     ESP_LOGI(TAG, "Battery Monitor Task started on core %d", xPortGetCoreID());
 
-    // 等待系统初始化完成
-    vTaskDelay(pdMS_TO_TICKS(5000)); // 增加等待时间，确保UI完全初始化
-
+    // 由启动图保证在后台管理模块启动后创建，首次采样前先等一个周期
     while (1) {
+        vTaskDelay(pdMS_TO_TICKS(10000)); // 每10秒记录一次日志
+
         // 获取后台电池信息用于日志记录
         background_battery_info_t battery_info;
         esp_err_t ret = background_manager_get_battery(&battery_info);
@@ -144,9 +141,6 @@ static void battery_monitor_task(void* pvParameters) {
         } else {
             ESP_LOGW(TAG, "Failed to get battery info from background manager");
         }
-
-        // 每10秒记录一次日志
-        vTaskDelay(pdMS_TO_TICKS(10000)); // 10秒
     }
 }
 
@@ -246,30 +240,6 @@ esp_err_t init_system_monitor_task(void) {
     return ESP_OK;
 }
 
-esp_err_t init_wifi_manager_task(void) {
-    if (s_wifi_task_handle != NULL) {
-        ESP_LOGW(TAG, "WiFi manager task already running");
-        return ESP_OK;
-    }
-
-    BaseType_t result = xTaskCreatePinnedToCore(wifi_manager_task,    // 任务函数
-                                                "WiFi_Manager",       // 任务名称
-                                                TASK_STACK_MEDIUM,    // 堆栈大小 (4KB)
-                                                NULL,                 // 参数
-                                                TASK_PRIORITY_NORMAL, // 普通优先级
-                                                &s_wifi_task_handle,  // 任务句柄
-                                                0                     // 绑定到Core 0
-    );
-
-    if (result != pdPASS) {
-        ESP_LOGE(TAG, "Failed to create WiFi manager task");
-        return ESP_ERR_NO_MEM;
-    }
-
-    ESP_LOGI(TAG, "WiFi manager task created successfully on Core 0");
-    return ESP_OK;
-}
-
 esp_err_t init_battery_monitor_task(void) {
     if (s_battery_task_handle != NULL) {
         ESP_LOGW(TAG, "Battery monitor task already running");
@@ -298,8 +268,10 @@ esp_err_t init_battery_monitor_task(void) {
 static void audio_receiver_task(void* pvParameters) {
     ESP_LOGI(TAG, "Audio Receiver Task started on core %d", xPortGetCoreID());
 
-    // 等待WiFi连接
-    vTaskDelay(pdMS_TO_TICKS(5000));
+    // 等待网络协议栈就绪
+    if (!boot_graph_wait("wifi", portMAX_DELAY)) {
+        ESP_LOGW(TAG, "WiFi boot step not completed");
+    }
 
     esp_err_t ret = audio_receiver_start();
     if (ret != ESP_OK) {
@@ -319,9 +291,7 @@ static void audio_receiver_task(void* pvParameters) {
 static void serial_display_task(void* pvParameters) {
     ESP_LOGI(TAG, "Serial Display Task started on core %d", xPortGetCoreID());
 
-    // 等待WiFi连接
-    vTaskDelay(pdMS_TO_TICKS(5000));
-
+    // 由启动图保证在 WiFi 步骤完成后创建，监听套接字无需等待连接
     esp_err_t ret = serial_display_init();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to init serial display: %s", esp_err_to_name(ret));
@@ -421,81 +391,112 @@ esp_err_t init_tcp_hb_server_task(void) {
     return ESP_OK;
 }
 
-esp_err_t init_all_tasks(void) {
-    ESP_LOGI(TAG, "Initializing all tasks...");
+// ---- 启动步骤: 与 components_init 登记的组件步骤同属一张启动图 ----
 
-    esp_err_t ret;
-    ui_start_animation_update_state(UI_STAGE_STARTING_SERVICES);
-    ui_start_animation_set_progress((float)4 / UI_STAGE_DONE * 100);
-    // 初始化后台管理模块
-    ret = background_manager_init();
+static esp_err_t step_background(void* arg) {
+    esp_err_t ret = background_manager_init();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to init background manager");
         return ret;
     }
-
-    // 启动后台管理任务
     ret = background_manager_start();
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to start background manager task");
-        return ret;
     }
+    return ret;
+}
 
-    // 初始化电池监测任务
-    ret = init_battery_monitor_task();
+// WiFi 初始化直接在启动步骤中完成，完成即表示网络协议栈可用
+static esp_err_t step_wifi(void* arg) {
+    esp_err_t ret = wifi_manager_init(NULL);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to init battery monitor task");
+        ESP_LOGW(TAG, "WiFi init failed: %s", esp_err_to_name(ret));
         return ret;
     }
-
-    // 初始化WiFi管理任务
-    ret = init_wifi_manager_task();
+    ESP_LOGI(TAG, "WiFi manager initialized");
+    ret = wifi_manager_start();
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to init WiFi manager task");
-        return ret;
+        ESP_LOGW(TAG, "WiFi start failed: %s", esp_err_to_name(ret));
     }
+    return ret;
+}
 
-    // 初始化摇杆ADC采样任务（200Hz）
-    ret = init_joystick_adc_task();
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to init Joystick ADC task");
-        return ret;
+// 依赖网络协议栈的诊断服务 (trace 导出、指标端点)
+static esp_err_t step_diag_net(void* arg) {
+    if (trace_export_start(TRACE_EXPORT_PORT) != ESP_OK) {
+        ESP_LOGW(TAG, "Trace export server not started");
     }
-
-    ret = init_lsm6ds3_control_task();
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to init LSM6DS3 control task");
-        return ret;
+    if (metrics_server_start(METRICS_SERVER_PORT) != ESP_OK) {
+        ESP_LOGW(TAG, "Metrics endpoint not started");
     }
+    return ESP_OK;
+}
+
+static esp_err_t step_task(void* arg) {
+    esp_err_t (*create)(void) = (esp_err_t(*)(void))arg;
+    return create();
+}
+
+// 界面所需的组件就绪后结束开机动画，切换到主界面
+static esp_err_t step_ui_done(void* arg) {
+    ui_start_animation_update_state(UI_STAGE_DONE);
+    return ESP_OK;
+}
+
+// 主界面首帧已送显 (lvgl_main 置位 first_frame 事件)
+static esp_err_t step_interactive(void* arg) {
+    ESP_LOGI(TAG, "First interactive frame at %lld ms after power-on", esp_timer_get_time() / 1000);
+    return ESP_OK;
+}
 
-    ui_start_animation_update_state(UI_STAGE_ALMOST_READY);
-    ui_start_animation_set_progress((float)5 / UI_STAGE_DONE * 100);
-    // 初始化音频接收任务（后台服务）
-    // ret = init_audio_receiver_task();
-    // if (ret != ESP_OK) {
-    //     ESP_LOGE(TAG, "Failed to init audio receiver task");
-    //     return ret;
-    // }
+static void boot_progress_cb(uint32_t done, uint32_t total) {
+    const uint32_t stages = UI_STAGE_FINALIZING - UI_STAGE_LOADING_COMPONENTS;
+    ui_start_animation_update_state((ui_load_stage_t)(UI_STAGE_LOADING_COMPONENTS + done * stages / total));
+    ui_start_animation_set_progress((uint8_t)(done * 100 / total));
+}
+
+esp_err_t init_all_tasks(void) {
+    ESP_LOGI(TAG, "Initializing all tasks...");
 
-    // 初始化串口显示任务（后台服务）
-    ret = init_serial_display_task();
+    // 持续采样服务先于启动图运行，SYS_STATS 遥测帧与监控页面从开机起即有数据
+    if (sys_monitor_start(SYS_MONITOR_DEFAULT_PERIOD_MS) != ESP_OK) {
+        ESP_LOGW(TAG, "System sampler not started");
+    }
+
+    // 音频接收任务（后台服务）暂不启用，启用时以依赖 "wifi" 的步骤加入
+    static const boot_step_t steps[] = {
+        {.name = "background", .fn = step_background, .deps = "battery", .core = BOOT_CORE_ANY},
+        {.name = "battery_log", .fn = step_task, .arg = (void*)init_battery_monitor_task,
+         .deps = "background", .core = BOOT_CORE_ANY},
+        {.name = "wifi", .fn = step_wifi, .deps = "nvs", .core = 0},
+        {.name = "joystick", .fn = step_task, .arg = (void*)init_joystick_adc_task,
+         .deps = "adc", .core = BOOT_CORE_ANY},
+        {.name = "imu_ctrl", .fn = step_task, .arg = (void*)init_lsm6ds3_control_task,
+         .deps = "imu", .core = BOOT_CORE_ANY},
+        {.name = "serial_disp", .fn = step_task, .arg = (void*)init_serial_display_task,
+         .deps = "wifi", .core = BOOT_CORE_ANY},
+        {.name = "tcp_hb", .fn = step_task, .arg = (void*)init_tcp_hb_server_task,
+         .deps = "wifi", .core = BOOT_CORE_ANY},
+        {.name = "diag_net", .fn = step_diag_net, .deps = "wifi", .core = BOOT_CORE_ANY},
+        {.name = "ui_done", .fn = step_ui_done, .deps = "lvgl,status_bar,calibration,touch,joystick",
+         .core = BOOT_CORE_ANY},
+        {.name = "first_frame", .fn = NULL},
+        {.name = "interactive", .fn = step_interactive, .deps = "ui_done,first_frame", .core = BOOT_CORE_ANY},
+    };
+    esp_err_t ret = boot_graph_add(steps, sizeof(steps) / sizeof(steps[0]));
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to init serial display task");
+        ESP_LOGE(TAG, "Failed to register task boot steps");
         return ret;
     }
 
-    // 初始化TCP心跳服务器任务（后台服务）
-    ret = init_tcp_hb_server_task();
+    boot_graph_set_progress_cb(boot_progress_cb);
+    ret = boot_graph_start(TASK_STACK_WIFI, TASK_PRIORITY_NORMAL);
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to init TCP heartbeat server task");
+        ESP_LOGE(TAG, "Failed to start boot graph: %s", esp_err_to_name(ret));
         return ret;
     }
-    ui_start_animation_update_state(UI_STAGE_FINALIZING);
-    ui_start_animation_set_progress((float)6 / UI_STAGE_DONE * 100);
-    vTaskDelay(pdMS_TO_TICKS(200)); // 确保动画有时间更新
-    // 启动动画完成，切换到主界面
-    ui_start_animation_update_state(UI_STAGE_DONE);
-    ESP_LOGI(TAG, "All tasks initialized successfully");
+
+    ESP_LOGI(TAG, "Boot graph started, tasks come up as their dependencies complete");
     return ESP_OK;
 }
 
@@ -537,12 +538,6 @@ esp_err_t stop_all_tasks(void) {
         ESP_LOGI(TAG, "Battery monitor task stopped");
     }
 
-    if (s_wifi_task_handle) {
-        vTaskDelete(s_wifi_task_handle);
-        s_wifi_task_handle = NULL;
-        ESP_LOGI(TAG, "WiFi manager task stopped");
-    }
-
     if (s_audio_receiver_task_handle) {
         audio_receiver_stop(); // 先停止音频接收服务
         vTaskDelete(s_audio_receiver_task_handle);
@@ -653,7 +648,6 @@ void list_running_tasks(void) {
     ESP_LOGI(TAG, "Monitor Task: %s", s_monitor_task_handle ? "Running" : "Stopped");
     ESP_LOGI(TAG, "Joystick Task: %s", s_joystick_task_handle ? "Running" : "Stopped");
     ESP_LOGI(TAG, "Battery Task: %s", s_battery_task_handle ? "Running" : "Stopped");
-    ESP_LOGI(TAG, "WiFi Task: %s", s_wifi_task_handle ? "Running" : "Stopped");
     ESP_LOGI(TAG, "Audio Receiver Task: %s", s_audio_receiver_task_handle ? "Running" : "Stopped");
     ESP_LOGI(TAG, "Serial Display Task: %s", s_serial_display_task_handle ? "Running" : "Stopped");
     ESP_LOGI(TAG, "TCP HB Server Task: %s", s_tcp_hb_server_task_handle ? "Running" : "Stopped");
@@ -666,7 +660,6 @@ TaskHandle_t get_power_task_handle(void) { return s_power_task_handle; }
 TaskHandle_t get_monitor_task_handle(void) { return s_monitor_task_handle; }
 TaskHandle_t get_battery_task_handle(void) { return s_battery_task_handle; }
 TaskHandle_t get_joystick_task_handle(void) { return s_joystick_task_handle; }
-TaskHandle_t get_wifi_task_handle(void) { return s_wifi_task_handle; }
 TaskHandle_t get_audio_receiver_task_handle(void) { return s_audio_receiver_task_handle; }
 TaskHandle_t get_serial_display_task_handle(void) { return s_serial_display_task_handle; }
 TaskHandle_t get_tcp_hb_server_task_handle(void) { return s_tcp_hb_server_task_handle; }
\ No newline at end of file
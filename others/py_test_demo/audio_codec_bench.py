@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+音频编解码 (main/app/audio_codec.c) 主机校验与解码性能基准
+
+  1. 将固件 audio_codec.c 编译为共享库；
+  2. 校验 test_audio_sender.py 中的 Python 编码器与固件编码器逐字节一致；
+  3. 解码信噪比；
+  4. 解码耗时: 每毫秒音频的纳秒数与主机周期数 (x86 上为 TSC 周期)。
+
+用法:
+  python audio_codec_bench.py
+  python audio_codec_bench.py --seconds 5 --iterations 20000
+"""
+
+import argparse
+import ctypes
+import math
+import os
+import random
+import struct
+import sys
+import tempfile
+
+import host_harness
+import test_audio_sender as sender
+from host_harness import REPO
+
+REPO_MAIN = os.path.join(REPO, 'main')
+
+GLUE_C = r'''
+#include "audio_codec.h"
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static uint64_t read_cycles(void) { return __rdtsc(); }
+#else
+static uint64_t read_cycles(void) { return 0; }
+#endif
+
+size_t host_encode_block(int codec, int16_t* predictor, uint8_t* index, uint16_t seq, const int16_t* pcm,
+                         size_t samples, uint8_t* out) {
+    audio_adpcm_state_t st = {*predictor, *index};
+    size_t n = audio_codec_encode_block((audio_codec_id_t)codec, &st, seq, pcm, samples, out);
+    *predictor = st.predictor;
+    *index = st.step_index;
+    return n;
+}
+
+size_t host_decode_block(const uint8_t* block, int16_t* pcm) {
+    audio_block_header_t header;
+    memcpy(&header, block, sizeof(header));
+    return audio_codec_decode_block(&header, block + sizeof(header), pcm);
+}
+
+// 重复解码同一块，返回总纳秒，周期数写入 cycles
+uint64_t host_bench_decode(const uint8_t* block, int iterations, int16_t* pcm, uint64_t* cycles) {
+    struct timespec t0, t1;
+    volatile size_t sink = 0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    const uint64_t c0 = read_cycles();
+    for (int i = 0; i < iterations; i++) {
+        sink += host_decode_block(block, pcm);
+    }
+    *cycles = read_cycles() - c0;
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    (void)sink;
+    return (uint64_t)(t1.tv_sec - t0.tv_sec) * 1000000000ull + (uint64_t)(t1.tv_nsec - t0.tv_nsec);
+}
+'''
+
+
+def build_lib(workdir):
+    lib = host_harness.build_lib(workdir, 'audio_codec', [os.path.join(REPO_MAIN, 'app', 'audio_codec.c')],
+                                 glue={'glue.c': GLUE_C}, includes=[os.path.join(REPO_MAIN, 'app', 'inc')])
+    lib.host_encode_block.restype = ctypes.c_size_t
+    lib.host_encode_block.argtypes = [ctypes.c_int, ctypes.POINTER(ctypes.c_int16), ctypes.POINTER(ctypes.c_uint8),
+                                      ctypes.c_uint16, ctypes.c_void_p, ctypes.c_size_t, ctypes.c_void_p]
+    lib.host_decode_block.restype = ctypes.c_size_t
+    lib.host_decode_block.argtypes = [ctypes.c_char_p, ctypes.c_void_p]
+    lib.host_bench_decode.restype = ctypes.c_uint64
+    lib.host_bench_decode.argtypes = [ctypes.c_char_p, ctypes.c_int, ctypes.c_void_p,
+                                      ctypes.POINTER(ctypes.c_uint64)]
+    return lib
+
+
+def test_signal(seconds, rate=sender.SAMPLE_RATE):
+    """测试音 + 扫频 + 噪声 + 满幅削波段，覆盖步长表两端"""
+    rng = random.Random(7)
+    n = int(seconds * rate)
+    out = []
+    for i in range(n):
+        t = i / rate
+        v = 8000 * math.sin(2 * math.pi * 440 * t) + 5000 * math.sin(2 * math.pi * (200 + 4000 * t / seconds) * t)
+        v += rng.gauss(0, 300)
+        if (i // 4410) % 10 == 9:
+            v *= 6
+        out.append(max(-32768, min(32767, int(v))))
+    return out
+
+
+def snr_db(ref, test):
+    sig = sum(x * x for x in ref)
+    err = sum((a - b) ** 2 for a, b in zip(ref, test))
+    return 10 * math.log10(sig / err) if err else float('inf')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='audio_codec 主机校验与基准')
+    parser.add_argument('--seconds', type=float, default=2.0, help='校验信号时长')
+    parser.add_argument('--iterations', type=int, default=20000, help='解码基准重复次数')
+    args = parser.parse_args()
+
+    block_samples = sender.BLOCK_SAMPLES
+    samples = test_signal(args.seconds)
+    ok = True
+
+    with tempfile.TemporaryDirectory() as workdir:
+        lib = build_lib(workdir)
+        out_buf = ctypes.create_string_buffer(14 + block_samples * 2)
+        pcm_buf = (ctypes.c_int16 * block_samples)()
+
+        for name, codec in (('pcm', sender.CODEC_PCM16), ('adpcm', sender.CODEC_IMA_ADPCM),
+                            ('adpcm2', sender.CODEC_ADPCM2)):
+            py_enc = sender.AdpcmEncoder(codec)
+            predictor, index = ctypes.c_int16(0), ctypes.c_uint8(0)
+            decoded, mismatches, encoded_bytes = [], 0, 0
+            first_block = None
+            for seq, i in enumerate(range(0, len(samples), block_samples)):
+                chunk = samples[i:i + block_samples]
+                py_block = py_enc.encode_block(seq, chunk)
+                c_in = (ctypes.c_int16 * len(chunk))(*chunk)
+                n = lib.host_encode_block(codec, ctypes.byref(predictor), ctypes.byref(index), seq, c_in, len(chunk),
+                                          out_buf)
+                if out_buf.raw[:n] != py_block:
+                    mismatches += 1
+                if first_block is None and len(chunk) == block_samples:
+                    first_block = py_block
+                encoded_bytes += len(py_block)
+                got = lib.host_decode_block(py_block, pcm_buf)
+                decoded.extend(pcm_buf[:got])
+
+            # 解码基准: 每毫秒音频的耗时
+            cycles = ctypes.c_uint64(0)
+            ns = lib.host_bench_decode(first_block, args.iterations, pcm_buf, ctypes.byref(cycles))
+            audio_ms = args.iterations * block_samples * 1000.0 / sender.SAMPLE_RATE
+            ratio = len(samples) * 2 / encoded_bytes
+            snr = snr_db(samples, decoded)
+            print('%-7s ratio %.2f:1  %5.0f kbit/s  SNR %6.1f dB  py==c %s  decode %.0f ns/ms-audio  %.0f cycles/ms-audio'
+                  % (name, ratio, encoded_bytes * 8 / args.seconds / 1000, snr,
+                     'yes' if mismatches == 0 else 'NO (%d blocks)' % mismatches, ns / audio_ms,
+                     cycles.value / audio_ms))
+            ok = ok and mismatches == 0 and len(decoded) == len(samples)
+            if codec == sender.CODEC_IMA_ADPCM:
+                ok = ok and snr > 20
+
+    print('PASS' if ok else 'FAIL')
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
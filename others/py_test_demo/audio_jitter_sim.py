@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+音频抖动缓冲 (main/app/audio_jitter.c) 主机仿真
+
+将固件 audio_jitter.c 编译为共享库，按网络轨迹模拟块到达时间，以本地 I2S 时钟节奏读取，检查:
+  - 欠载/隐藏/迟到块计数；
+  - 延迟有界: 末段平均深度跟随目标延迟 (不随时间增长)，且不超过 max_delay_ms + 一块；
+  - 漂移跟踪: 稳态重采样偏离接近发送端与本地时钟的实际偏差。
+
+轨迹:
+  clean    固定 5ms 延迟
+  gauss    20ms + |N(0,15ms)|，允许乱序 (UDP)
+  wifi     5ms 延迟，每 3~8 秒一次 150~300ms 链路停顿，停顿结束后突发到达
+  loss     gauss + 5% 丢包
+  fast     gauss，发送端时钟快 300ppm
+  slow     gauss，发送端时钟慢 300ppm
+
+用法:
+  python audio_jitter_sim.py
+  python audio_jitter_sim.py --trace slow --seconds 600 --verbose
+"""
+
+import argparse
+import array
+import ctypes
+import math
+import os
+import random
+import sys
+import tempfile
+
+import host_harness
+from host_harness import REPO
+
+REPO_MAIN = os.path.join(REPO, 'main')
+
+RATE = 44100
+BLOCK = 1024        # 发送块 (与 test_audio_sender.BLOCK_SAMPLES 一致)
+PULL = 256          # 播放任务每次读取
+MAX_DELAY_MS = 400
+
+GLUE_C = r'''
+#include "audio_jitter.h"
+#include <stdlib.h>
+audio_jitter_t* host_jitter_create(uint32_t rate) {
+    audio_jitter_config_t cfg = AUDIO_JITTER_DEFAULT_CONFIG(rate);
+    audio_jitter_t* jb = malloc(sizeof(*jb));
+    int16_t* storage = malloc(AUDIO_JITTER_STORAGE_SAMPLES(&cfg) * sizeof(int16_t));
+    if (!jb || !storage || !audio_jitter_init(jb, &cfg, storage)) return NULL;
+    return jb;
+}
+'''
+
+
+class Stats(ctypes.Structure):
+    _fields_ = [('state', ctypes.c_int), ('depth_samples', ctypes.c_uint32), ('depth_ms', ctypes.c_float),
+                ('target_ms', ctypes.c_float), ('jitter_ms', ctypes.c_float), ('peak_delay_ms', ctypes.c_float), ('drift_ppm', ctypes.c_int32),
+                ('resample_ppm', ctypes.c_int32),
+                ('received_blocks', ctypes.c_uint32), ('late_blocks', ctypes.c_uint32),
+                ('concealed_blocks', ctypes.c_uint32), ('underruns', ctypes.c_uint32),
+                ('overflow_resets', ctypes.c_uint32)]
+
+
+def build_lib(workdir):
+    lib = host_harness.build_lib(workdir, 'audio_jitter', [os.path.join(REPO_MAIN, 'app', 'audio_jitter.c')],
+                                 glue={'glue.c': GLUE_C}, includes=[os.path.join(REPO_MAIN, 'app', 'inc')])
+    lib.host_jitter_create.restype = ctypes.c_void_p
+    lib.host_jitter_create.argtypes = [ctypes.c_uint32]
+    lib.audio_jitter_push.restype = ctypes.c_bool
+    lib.audio_jitter_push.argtypes = [ctypes.c_void_p, ctypes.c_uint16, ctypes.c_uint32, ctypes.c_void_p,
+                                      ctypes.c_size_t, ctypes.c_int64]
+    lib.audio_jitter_pull.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_size_t]
+    lib.audio_jitter_get_stats.argtypes = [ctypes.c_void_p, ctypes.POINTER(Stats)]
+    return lib
+
+
+def arrivals(trace, seconds, seed):
+    """返回 [(到达时间s, 块序号)]，按到达时间排序"""
+    rng = random.Random(seed)
+    drift_ppm = {'fast': 300, 'slow': -300}.get(trace, 0)
+    period = BLOCK / (RATE * (1 + drift_ppm * 1e-6))
+    events = []
+    blocked_until = 0.0
+    next_stall = 3.0
+    for seq in range(int(seconds / period)):
+        send = seq * period
+        if trace == 'clean':
+            delay = 0.005
+        elif trace == 'wifi':
+            delay = 0.005
+            if send >= next_stall:
+                blocked_until = send + rng.uniform(0.15, 0.3)
+                next_stall = send + rng.uniform(3.0, 8.0)
+        else:
+            delay = 0.020 + abs(rng.gauss(0, 0.015))
+        if trace == 'loss' and rng.random() < 0.05:
+            continue
+        events.append((max(send + delay, blocked_until), seq))
+    events.sort()
+    return events, drift_ppm
+
+
+def run_trace(lib, trace, seconds, seed, verbose):
+    jb = lib.host_jitter_create(RATE)
+    events, drift_ppm = arrivals(trace, seconds, seed)
+
+    # 441Hz 正弦，周期 100 个采样，块内容按时间戳连续
+    table = array.array('h', (int(10000 * math.sin(2 * math.pi * i / 100)) for i in range(BLOCK + 100)))
+    table_addr = table.buffer_info()[0]
+    out = (ctypes.c_int16 * PULL)()
+    st = Stats()
+
+    depths = []
+    targets = []
+    ppm = []
+    e = 0
+    pulls = int(seconds * RATE / PULL)
+    for j in range(pulls):
+        now = j * PULL / RATE
+        while e < len(events) and events[e][0] <= now:
+            t, seq = events[e]
+            offset = (seq * BLOCK) % 100
+            lib.audio_jitter_push(jb, seq & 0xFFFF, (seq * BLOCK) & 0xFFFFFFFF, table_addr + offset * 2, BLOCK,
+                                  int(t * 1e6))
+            e += 1
+        lib.audio_jitter_pull(jb, out, PULL)
+        if j % 173 == 0:  # 约每秒采样一次统计 (与块周期错开，避免总在锯齿同一相位采样)
+            lib.audio_jitter_get_stats(jb, ctypes.byref(st))
+            depths.append(st.depth_ms)
+            targets.append(st.target_ms)
+            ppm.append(st.drift_ppm)
+            if verbose:
+                print('  t=%5.1fs depth=%6.1fms target=%6.1fms jitter=%5.1fms peak=%5.1fms drift=%+5dppm under=%d '
+                      'conceal=%d' % (now, st.depth_ms, st.target_ms, st.jitter_ms, st.peak_delay_ms, st.drift_ppm, st.underruns,
+                         st.concealed_blocks))
+
+    lib.audio_jitter_get_stats(jb, ctypes.byref(st))
+    n = len(depths)
+    q2 = sum(depths[n // 4:n // 2]) / max(1, n // 2 - n // 4)
+    q4 = sum(depths[3 * n // 4:]) / max(1, n - 3 * n // 4)
+    q4_target = sum(targets[3 * n // 4:]) / max(1, n - 3 * n // 4)
+    tail_ppm = sum(ppm[3 * n // 4:]) / max(1, n - 3 * n // 4)
+    max_depth = max(depths[n // 4:]) if n > 4 else 0
+
+    ok = max_depth <= MAX_DELAY_MS + BLOCK * 1000 / RATE and abs(q4 - q4_target) < BLOCK * 1000 / RATE
+    if drift_ppm:
+        ok = ok and abs(tail_ppm - drift_ppm) < 100
+    # wifi: 第一次停顿前尚未学到峰值延迟，允许少量欠载
+    ok = ok and st.underruns <= (3 if trace == 'wifi' else 0)
+    if trace == 'loss':
+        ok = ok and st.concealed_blocks > 0
+    print('%-6s depth q2=%6.1fms q4=%6.1fms max=%6.1fms target(q4)=%6.1fms jitter=%5.1fms drift=%+5.0fppm (true %+d) '
+          'under=%d conceal=%d late=%d  %s'
+          % (trace, q2, q4, max_depth, q4_target, st.jitter_ms, tail_ppm, drift_ppm, st.underruns,
+             st.concealed_blocks, st.late_blocks, 'ok' if ok else 'FAIL'))
+    return ok
+
+
+def main():
+    parser = argparse.ArgumentParser(description='audio_jitter 主机仿真')
+    parser.add_argument('--trace', choices=['clean', 'gauss', 'wifi', 'loss', 'fast', 'slow', 'all'], default='all')
+    parser.add_argument('--seconds', type=float, default=240)
+    parser.add_argument('--seed', type=int, default=1)
+    parser.add_argument('--verbose', action='store_true')
+    args = parser.parse_args()
+
+    traces = ['clean', 'gauss', 'wifi', 'loss', 'fast', 'slow'] if args.trace == 'all' else [args.trace]
+    with tempfile.TemporaryDirectory() as workdir:
+        lib = build_lib(workdir)
+        ok = all([run_trace(lib, t, args.seconds, args.seed, args.verbose) for t in traces])
+    print('PASS' if ok else 'FAIL')
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,306 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+混音与采样率转换 (main/app/audio_mixer.c) 主机校验与性能基准
+
+将固件 audio_mixer.c 分别按 -O3 (自动向量化) 与 -O2 -fno-tree-vectorize (标量) 编译为共享库，检查:
+  1. 重采样: 8k/16k/22.05k/32k/48k -> 44.1kHz 的 1kHz 正弦增益在 ±0.1dB 内，信噪比 > 60dB，
+     长时间运行消耗的输入采样数与采样率比一致 (无累计漂移)；
+  2. 降采样抗混叠: 48kHz 输入中高于输出奈奎斯特频率的 23kHz 衰减 > 40dB；
+  3. 混音: 增益 0.5 的音源为 -6dB，两个满幅音源叠加后饱和且计数，一次性音源播完后自动移除；
+  4. 提示音: 频率与时长准确；
+  5. 耗时: 每个 DMA 块 (256 采样) 的纳秒数与主机周期数 (x86 上为 TSC 周期)，向量化与标量对比。
+
+用法:
+  python audio_mixer_bench.py
+  python audio_mixer_bench.py --renders 5000
+"""
+
+import argparse
+import array
+import ctypes
+import math
+import os
+import sys
+import tempfile
+
+import host_harness
+from host_harness import REPO, check
+
+REPO_MAIN = os.path.join(REPO, 'main')
+
+OUT_RATE = 44100
+BLOCK = 256
+ONESHOT = 1
+
+GLUE_C = r'''
+#include "audio_mixer.h"
+#include <stdlib.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static uint64_t read_cycles(void) { return __rdtsc(); }
+#else
+static uint64_t read_cycles(void) { return 0; }
+#endif
+
+static uint64_t now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ull + (uint64_t)t.tv_nsec;
+}
+
+// 数组音源: loop 为真时循环播放，否则播完返回不足
+typedef struct {
+    const int16_t* data;
+    size_t len;
+    size_t pos;
+    size_t consumed;
+    int loop;
+} host_source_t;
+
+static size_t host_pull(void* ctx, int16_t* pcm, size_t samples) {
+    host_source_t* s = ctx;
+    size_t n = 0;
+    while (n < samples) {
+        if (s->pos >= s->len) {
+            if (!s->loop) break;
+            s->pos = 0;
+        }
+        pcm[n++] = s->data[s->pos++];
+    }
+    s->consumed += n;
+    return n;
+}
+
+audio_mixer_t* host_mixer_create(uint32_t out_rate) {
+    audio_mixer_t* m = malloc(sizeof(*m));
+    audio_mixer_init(m, out_rate);
+    return m;
+}
+
+host_source_t* host_source_create(const int16_t* data, size_t len, int loop) {
+    host_source_t* s = calloc(1, sizeof(*s));
+    s->data = data;
+    s->len = len;
+    s->loop = loop;
+    return s;
+}
+
+size_t host_source_consumed(const host_source_t* s) { return s->consumed; }
+
+int host_add(audio_mixer_t* m, uint32_t rate, int type, host_source_t* s, uint16_t gain) {
+    return audio_mixer_add_source(m, rate, (audio_mixer_source_type_t)type, host_pull, s, gain);
+}
+
+audio_tone_t* host_tone_create(uint32_t rate, const uint16_t* notes, size_t count, int16_t amplitude) {
+    audio_tone_note_t n[AUDIO_TONE_MAX_NOTES];
+    for (size_t i = 0; i < count && i < AUDIO_TONE_MAX_NOTES; i++) {
+        n[i].freq_hz = notes[2 * i];
+        n[i].duration_ms = notes[2 * i + 1];
+    }
+    audio_tone_t* t = malloc(sizeof(*t));
+    return audio_tone_init(t, rate, n, count, amplitude) ? t : NULL;
+}
+
+int host_add_tone(audio_mixer_t* m, audio_tone_t* t, uint16_t gain) {
+    return audio_mixer_add_source(m, t->sample_rate, AUDIO_MIXER_ONESHOT, audio_tone_pull, t, gain);
+}
+
+uint32_t host_clipped(const audio_mixer_t* m) { return m->clipped_samples; }
+
+void host_render(audio_mixer_t* m, int16_t* out, size_t blocks, size_t block) {
+    for (size_t b = 0; b < blocks; b++) audio_mixer_render(m, out + b * block, block);
+}
+
+// 渲染 renders 次，返回每次纳秒，cycles 为每次周期数
+double host_bench(audio_mixer_t* m, size_t renders, size_t block, double* cycles) {
+    int16_t out[AUDIO_MIXER_MAX_FRAMES];
+    volatile int16_t sink = 0;
+    const uint64_t t0 = now_ns();
+    const uint64_t c0 = read_cycles();
+    for (size_t r = 0; r < renders; r++) {
+        audio_mixer_render(m, out, block);
+        sink += out[0];
+    }
+    *cycles = (double)(read_cycles() - c0) / (double)renders;
+    (void)sink;
+    return (double)(now_ns() - t0) / (double)renders;
+}
+'''
+
+
+def build_lib(workdir, flags):
+    name = 'audio_mixer%s' % ''.join(flags).replace('-', '_')
+    lib = host_harness.build_lib(workdir, name, [os.path.join(REPO_MAIN, 'app', 'audio_mixer.c')],
+                                 glue={'glue.c': GLUE_C}, includes=[os.path.join(REPO_MAIN, 'app', 'inc')],
+                                 cflags=flags)
+    vp = ctypes.c_void_p
+    lib.host_mixer_create.restype = vp
+    lib.host_mixer_create.argtypes = [ctypes.c_uint32]
+    lib.host_source_create.restype = vp
+    lib.host_source_create.argtypes = [vp, ctypes.c_size_t, ctypes.c_int]
+    lib.host_source_consumed.restype = ctypes.c_size_t
+    lib.host_source_consumed.argtypes = [vp]
+    lib.host_add.argtypes = [vp, ctypes.c_uint32, ctypes.c_int, vp, ctypes.c_uint16]
+    lib.host_tone_create.restype = vp
+    lib.host_tone_create.argtypes = [ctypes.c_uint32, vp, ctypes.c_size_t, ctypes.c_int16]
+    lib.host_add_tone.argtypes = [vp, vp, ctypes.c_uint16]
+    lib.host_clipped.restype = ctypes.c_uint32
+    lib.host_clipped.argtypes = [vp]
+    lib.host_render.argtypes = [vp, vp, ctypes.c_size_t, ctypes.c_size_t]
+    lib.host_bench.restype = ctypes.c_double
+    lib.host_bench.argtypes = [vp, ctypes.c_size_t, ctypes.c_size_t, ctypes.POINTER(ctypes.c_double)]
+    lib.audio_mixer_source_active.restype = ctypes.c_bool
+    lib.audio_mixer_source_active.argtypes = [vp, ctypes.c_int]
+    return lib
+
+
+def addr(buf):
+    return buf.buffer_info()[0]
+
+
+def tone(freq, seconds, rate, amp=10000.0):
+    return array.array('h', (int(round(amp * math.sin(2 * math.pi * freq * i / rate)))
+                             for i in range(int(seconds * rate))))
+
+
+def fit_sine(buf, freq, rate, start):
+    """最小二乘拟合已知频率的正弦，返回 (幅度, 信噪比 dB)"""
+    seg = buf[start:]
+    w = 2 * math.pi * freq / rate
+    s = c = 0.0
+    for i, v in enumerate(seg):
+        s += v * math.sin(w * (i + start))
+        c += v * math.cos(w * (i + start))
+    a, b = 2 * s / len(seg), 2 * c / len(seg)
+    amp = math.hypot(a, b)
+    err = sum((v - a * math.sin(w * (i + start)) - b * math.cos(w * (i + start))) ** 2 for i, v in enumerate(seg))
+    sig = amp * amp / 2 * len(seg)
+    return amp, 10 * math.log10(sig / err) if err > 0 else 200.0
+
+
+def rms_db(buf, start=0):
+    seg = buf[start:]
+    p = sum(v * v for v in seg) / len(seg)
+    return 10 * math.log10(p / 32767.0 ** 2) if p > 0 else -120.0
+
+
+def render(lib, mixer, seconds):
+    blocks = int(seconds * OUT_RATE) // BLOCK
+    out = array.array('h', bytes(2 * blocks * BLOCK))
+    lib.host_render(mixer, addr(out), blocks, BLOCK)
+    return out
+
+
+
+def test_resampler(lib):
+    ok = True
+    for rate in (8000, 16000, 22050, 32000, 44100, 48000):
+        sig = tone(1000, 0.5, rate)
+        mixer = lib.host_mixer_create(OUT_RATE)
+        src = lib.host_source_create(addr(sig), len(sig), 1)
+        lib.host_add(mixer, rate, 0, src, 4096)
+        out = render(lib, mixer, 2.0)
+        amp, snr = fit_sine(out, 1000, OUT_RATE, OUT_RATE // 2)
+        gain = 20 * math.log10(amp / 10000)
+        ok &= check('resample %5d -> %d' % (rate, OUT_RATE), abs(gain) < 0.1 and snr > 60,
+                    'gain %+.3f dB  SNR %.1f dB' % (gain, snr))
+        # 消耗的输入采样数与采样率比一致 (误差不超过一个滤波器长度)
+        expected = len(out) * rate / OUT_RATE
+        consumed = lib.host_source_consumed(src)
+        ok &= check('  input consumed', abs(consumed - expected) <= 32, '%d vs %.0f expected' % (consumed, expected))
+
+    sig = tone(23000, 0.5, 48000)
+    mixer = lib.host_mixer_create(OUT_RATE)
+    lib.host_add(mixer, 48000, 0, lib.host_source_create(addr(sig), len(sig), 1), 4096)
+    out = render(lib, mixer, 1.0)
+    level = rms_db(out, 4096) - rms_db(sig)
+    ok &= check('alias 23kHz @ 48k -> 44.1k', level < -40, 'level %.1f dB' % level)
+    return ok
+
+
+def test_mixer(lib):
+    ok = True
+    sig = tone(1000, 0.5, OUT_RATE)
+    mixer = lib.host_mixer_create(OUT_RATE)
+    lib.host_add(mixer, OUT_RATE, 0, lib.host_source_create(addr(sig), len(sig), 1), 2048)
+    out = render(lib, mixer, 0.5)
+    gain = rms_db(out) - rms_db(sig)
+    ok &= check('source gain 0.5', abs(gain + 6.02) < 0.05, 'gain %+.2f dB' % gain)
+
+    full = tone(1000, 0.5, OUT_RATE, amp=30000)
+    mixer = lib.host_mixer_create(OUT_RATE)
+    for rate in (OUT_RATE, 22050):
+        src = full if rate == OUT_RATE else tone(1000, 0.5, rate, amp=30000)
+        lib.host_add(mixer, rate, 0, lib.host_source_create(addr(src), len(src), 1), 4096)
+    out = render(lib, mixer, 0.5)
+    clipped = lib.host_clipped(mixer)
+    ok &= check('saturation', max(out) == 32767 and min(out) == -32768 and clipped > 0,
+                'peak %d/%d, %d samples clipped' % (max(out), min(out), clipped))
+
+    effect = tone(2000, 0.1, 16000)
+    mixer = lib.host_mixer_create(OUT_RATE)
+    sid = lib.host_add(mixer, 16000, ONESHOT, lib.host_source_create(addr(effect), len(effect), 0), 4096)
+    render(lib, mixer, 0.05)
+    playing = lib.audio_mixer_source_active(mixer, sid)
+    render(lib, mixer, 0.1)
+    ok &= check('oneshot removed when done', playing and not lib.audio_mixer_source_active(mixer, sid),
+                '100 ms effect at 16 kHz')
+    return ok
+
+
+def test_tone(lib):
+    notes = (ctypes.c_uint16 * 6)(880, 200, 0, 100, 1320, 150)
+    t = lib.host_tone_create(OUT_RATE, notes, 3, 16000)
+    mixer = lib.host_mixer_create(OUT_RATE)
+    sid = lib.host_add_tone(mixer, t, 4096)
+    out = render(lib, mixer, 0.6)
+    last = max(i for i, v in enumerate(out) if v != 0)
+    seg = out[int(0.02 * OUT_RATE):int(0.18 * OUT_RATE)]
+    crossings = sum(1 for a, b in zip(seg, seg[1:]) if a < 0 <= b)
+    freq = crossings / (len(seg) / OUT_RATE)
+    length_ms = last * 1000 / OUT_RATE
+    return check('tone 880/rest/1320 Hz', abs(freq - 880) < 10 and abs(length_ms - 450) < 3 and
+                 not lib.audio_mixer_source_active(mixer, sid),
+                 '%.0f Hz, %.1f ms' % (freq, length_ms))
+
+
+def bench(lib, label, renders):
+    print('benchmark [%s]: %d renders of %d samples @ %d Hz (%.1f ms)'
+          % (label, renders, BLOCK, OUT_RATE, BLOCK * 1e3 / OUT_RATE))
+    block_ns = BLOCK * 1e9 / OUT_RATE
+    keep = []
+    cases = (('passthrough 44.1k', (OUT_RATE,)), ('1 src 48k', (48000,)), ('1 src 16k', (16000,)),
+             ('4 src mixed', (OUT_RATE, 48000, 22050, 16000)))
+    cycles = ctypes.c_double()
+    for name, rates in cases:
+        mixer = lib.host_mixer_create(OUT_RATE)
+        for rate in rates:
+            sig = tone(440, 0.25, rate)
+            keep.append(sig)
+            lib.host_add(mixer, rate, 0, lib.host_source_create(addr(sig), len(sig), 1), 4096)
+        ns = lib.host_bench(mixer, renders, BLOCK, ctypes.byref(cycles))
+        print('  %-18s %8.0f ns/render %9.0f cycles/render %6.1f cycles/sample  %5.2f%% realtime'
+              % (name, ns, cycles.value, cycles.value / BLOCK if cycles.value else 0, 100 * ns / block_ns))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='audio_mixer 主机校验与基准')
+    parser.add_argument('--renders', type=int, default=2000, help='基准渲染次数')
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as workdir:
+        lib = build_lib(workdir, ['-O3'])
+        scalar = build_lib(workdir, ['-O2', '-fno-tree-vectorize'])
+        ok = test_resampler(lib)
+        ok &= test_mixer(lib)
+        ok &= test_tone(lib)
+        bench(lib, '-O3 vectorized', args.renders)
+        bench(scalar, '-O2 scalar', args.renders)
+    print('PASS' if ok else 'FAIL')
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,283 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+UDP 低延迟音频回环测试 (main/app/audio_rtp.c + audio_codec.c + audio_jitter.c)
+
+  1. test_audio_sender.RtpPacketizer 与固件 audio_rtp_encode 逐字节一致，解析往返一致；
+  2. 本机 UDP 回环: 发送端按实时速度发 5ms 小包 -> 损伤中继 (丢包、随机延迟造成乱序、偶发延迟尖峰)
+     -> 接收端按固件流程解析/解码/写入抖动缓冲，并以播放节奏读取；
+  3. 检查丢包被隐藏、乱序包被重排、欠载次数、目标延迟与输出连续性。
+
+用法:
+  python audio_udp_loopback.py
+  python audio_udp_loopback.py --seconds 20 --loss 0.1 --codec adpcm2
+"""
+
+import argparse
+import ctypes
+import heapq
+import math
+import os
+import random
+import select
+import socket
+import struct
+import sys
+import tempfile
+import threading
+import time
+
+import host_harness
+import test_audio_sender as sender
+from host_harness import REPO
+
+REPO_MAIN = os.path.join(REPO, 'main')
+RATE = sender.SAMPLE_RATE
+PULL = 256
+
+GLUE_C = r'''
+#include "audio_jitter.h"
+#include "audio_rtp.h"
+#include <stdlib.h>
+
+typedef struct {
+    audio_jitter_t jb;
+    int16_t pcm[AUDIO_RTP_MAX_SAMPLES];
+    uint32_t bad;
+} host_rx_t;
+
+host_rx_t* host_rx_create(uint32_t rate, uint16_t min_delay_ms) {
+    audio_jitter_config_t cfg = AUDIO_JITTER_DEFAULT_CONFIG(rate);
+    host_rx_t* rx = calloc(1, sizeof(*rx));
+    int16_t* storage = malloc(AUDIO_JITTER_STORAGE_SAMPLES(&cfg) * sizeof(int16_t));
+    if (!rx || !storage || !audio_jitter_init(&rx->jb, &cfg, storage)) return NULL;
+    audio_jitter_set_delay_range(&rx->jb, min_delay_ms, cfg.max_delay_ms);
+    audio_jitter_reset(&rx->jb, 0);
+    return rx;
+}
+
+// 与 audio_receiver.c 的 audio_udp_handle_packet 相同: 解析 -> 解码 -> 写入抖动缓冲
+int host_rx_packet(host_rx_t* rx, const uint8_t* data, size_t len, int64_t arrival_us) {
+    audio_rtp_packet_t pkt;
+    if (!audio_rtp_parse(data, len, &pkt)) { rx->bad++; return -1; }
+    size_t n = audio_codec_decode_block(&pkt.block, pkt.payload, rx->pcm);
+    if (n == 0) { rx->bad++; return -1; }
+    audio_jitter_push(&rx->jb, pkt.seq, pkt.timestamp, rx->pcm, n, arrival_us);
+    return (int)n;
+}
+
+void host_rx_pull(host_rx_t* rx, int16_t* out, size_t n) { audio_jitter_pull(&rx->jb, out, n); }
+void host_rx_stats(host_rx_t* rx, audio_jitter_stats_t* st) { audio_jitter_get_stats(&rx->jb, st); }
+uint32_t host_rx_bad(host_rx_t* rx) { return rx->bad; }
+
+size_t host_rtp_encode(int codec, int16_t* predictor, uint8_t* index, uint16_t seq, uint32_t ts, uint32_t ssrc,
+                       int marker, const int16_t* pcm, size_t n, uint8_t* out) {
+    audio_adpcm_state_t st = {*predictor, *index};
+    size_t len = audio_rtp_encode((audio_codec_id_t)codec, &st, seq, ts, ssrc, marker != 0, pcm, n, out);
+    *predictor = st.predictor;
+    *index = st.step_index;
+    return len;
+}
+
+int host_rtp_parse(const uint8_t* data, size_t len, uint16_t* seq, uint32_t* ts, uint32_t* ssrc, int* samples) {
+    audio_rtp_packet_t pkt;
+    if (!audio_rtp_parse(data, len, &pkt)) return 0;
+    *seq = pkt.seq; *ts = pkt.timestamp; *ssrc = pkt.ssrc; *samples = pkt.block.samples;
+    return 1;
+}
+'''
+
+
+class Stats(ctypes.Structure):
+    _fields_ = [('state', ctypes.c_int), ('depth_samples', ctypes.c_uint32), ('depth_ms', ctypes.c_float),
+                ('target_ms', ctypes.c_float), ('jitter_ms', ctypes.c_float), ('peak_delay_ms', ctypes.c_float),
+                ('drift_ppm', ctypes.c_int32), ('resample_ppm', ctypes.c_int32),
+                ('received_blocks', ctypes.c_uint32), ('late_blocks', ctypes.c_uint32),
+                ('concealed_blocks', ctypes.c_uint32), ('underruns', ctypes.c_uint32),
+                ('overflow_resets', ctypes.c_uint32)]
+
+
+def build_lib(workdir):
+    srcs = [os.path.join(REPO_MAIN, 'app', n) for n in ('audio_rtp.c', 'audio_codec.c', 'audio_jitter.c')]
+    lib = host_harness.build_lib(workdir, 'audio_udp', srcs, glue={'glue.c': GLUE_C},
+                                 includes=[os.path.join(REPO_MAIN, 'app', 'inc')])
+    lib.host_rx_create.restype = ctypes.c_void_p
+    lib.host_rx_create.argtypes = [ctypes.c_uint32, ctypes.c_uint16]
+    lib.host_rx_packet.argtypes = [ctypes.c_void_p, ctypes.c_char_p, ctypes.c_size_t, ctypes.c_int64]
+    lib.host_rx_pull.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_size_t]
+    lib.host_rx_stats.argtypes = [ctypes.c_void_p, ctypes.POINTER(Stats)]
+    lib.host_rx_bad.argtypes = [ctypes.c_void_p]
+    lib.host_rtp_encode.restype = ctypes.c_size_t
+    lib.host_rtp_encode.argtypes = [ctypes.c_int, ctypes.POINTER(ctypes.c_int16), ctypes.POINTER(ctypes.c_uint8),
+                                    ctypes.c_uint16, ctypes.c_uint32, ctypes.c_uint32, ctypes.c_int, ctypes.c_void_p,
+                                    ctypes.c_size_t, ctypes.c_void_p]
+    lib.host_rtp_parse.argtypes = [ctypes.c_char_p, ctypes.c_size_t, ctypes.POINTER(ctypes.c_uint16),
+                                   ctypes.POINTER(ctypes.c_uint32), ctypes.POINTER(ctypes.c_uint32),
+                                   ctypes.POINTER(ctypes.c_int)]
+    return lib
+
+
+def tone(n, offset=0):
+    return [int(9000 * math.sin(2 * math.pi * 440 * (offset + i) / RATE)) for i in range(n)]
+
+
+def check_packetizer(lib, codec, packet_samples):
+    """Python 打包与固件逐字节一致，固件解析得到相同的序号/时间戳/采样数"""
+    pk = sender.RtpPacketizer(codec, ssrc=0x12345678)
+    seq0, ts0 = pk.seq, pk.timestamp
+    predictor, index = ctypes.c_int16(0), ctypes.c_uint8(0)
+    out = ctypes.create_string_buffer(2048)
+    for k in range(200):
+        samples = tone(packet_samples, k * packet_samples)
+        py = pk.packet(samples)
+        c_in = (ctypes.c_int16 * packet_samples)(*samples)
+        n = lib.host_rtp_encode(codec, ctypes.byref(predictor), ctypes.byref(index), (seq0 + k) & 0xFFFF,
+                                (ts0 + k * packet_samples) & 0xFFFFFFFF, 0x12345678, 1 if k == 0 else 0, c_in,
+                                packet_samples, out)
+        if out.raw[:n] != py:
+            return False
+        seq, ts, ssrc, cnt = ctypes.c_uint16(), ctypes.c_uint32(), ctypes.c_uint32(), ctypes.c_int()
+        if not lib.host_rtp_parse(py, len(py), ctypes.byref(seq), ctypes.byref(ts), ctypes.byref(ssrc),
+                                  ctypes.byref(cnt)):
+            return False
+        if (seq.value, ts.value, ssrc.value, cnt.value) != ((seq0 + k) & 0xFFFF,
+                                                             (ts0 + k * packet_samples) & 0xFFFFFFFF,
+                                                             0x12345678, packet_samples):
+            return False
+    return True
+
+
+class Relay(threading.Thread):
+    """损伤中继: 丢包、随机延迟 (造成乱序)、偶发延迟尖峰"""
+
+    def __init__(self, dest, loss, jitter_ms, spike_prob, seed):
+        super().__init__(daemon=True)
+        self.sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.sock.bind(('127.0.0.1', 0))
+        self.addr = self.sock.getsockname()
+        self.dest = dest
+        self.loss, self.jitter_ms, self.spike_prob = loss, jitter_ms, spike_prob
+        self.rng = random.Random(seed)
+        self.running = True
+        self.dropped = self.forwarded = self.reordered = 0
+
+    def run(self):
+        pending = []  # (发送时刻, 序号, 数据)
+        last_seq = None
+        out = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        while self.running or pending:
+            timeout = max(0.0, pending[0][0] - time.monotonic()) if pending else 0.05
+            r, _, _ = select.select([self.sock], [], [], timeout)
+            now = time.monotonic()
+            if r:
+                data, _ = self.sock.recvfrom(2048)
+                if self.rng.random() < self.loss:
+                    self.dropped += 1
+                else:
+                    delay = 0.002 + self.rng.expovariate(1000.0 / self.jitter_ms)
+                    if self.rng.random() < self.spike_prob:
+                        delay += self.rng.uniform(0.02, 0.04)
+                    seq = struct.unpack('>H', data[2:4])[0]
+                    heapq.heappush(pending, (now + delay, seq, data))
+            while pending and pending[0][0] <= time.monotonic():
+                _, seq, data = heapq.heappop(pending)
+                if last_seq is not None and ((seq - last_seq) & 0xFFFF) > 0x8000:
+                    self.reordered += 1
+                else:
+                    last_seq = seq
+                out.sendto(data, self.dest)
+                self.forwarded += 1
+
+
+def run_loopback(lib, codec, seconds, packet_ms, loss, jitter_ms, spike_prob, seed):
+    packet_samples = max(4, int(RATE * packet_ms / 1000) // 4 * 4)
+    rx = lib.host_rx_create(RATE, 20)
+    rx_sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    rx_sock.bind(('127.0.0.1', 0))
+    relay = Relay(rx_sock.getsockname(), loss, jitter_ms, spike_prob, seed)
+    relay.start()
+
+    start = time.monotonic() + 0.05
+    sent = [0]
+
+    def send():
+        pk = sender.RtpPacketizer(codec)
+        tx = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        total = int(seconds * RATE / packet_samples)
+        for n in range(total):
+            delay = start + n * packet_samples / RATE - time.monotonic()
+            if delay > 0:
+                time.sleep(delay)
+            tx.sendto(pk.packet(tone(packet_samples, n * packet_samples)), relay.addr)
+            sent[0] += 1
+
+    tx_thread = threading.Thread(target=send, daemon=True)
+    tx_thread.start()
+
+    out = (ctypes.c_int16 * PULL)()
+    st = Stats()
+    silent_chunks = played_chunks = 0
+    depth_sum = depth_n = 0
+    pull_index = 0
+    end = start + seconds + 0.3
+    while time.monotonic() < end:
+        next_pull = start + pull_index * PULL / RATE
+        r, _, _ = select.select([rx_sock], [], [], max(0.0, next_pull - time.monotonic()))
+        if r:
+            data, _ = rx_sock.recvfrom(2048)
+            lib.host_rx_packet(rx, data, len(data), int(time.monotonic() * 1e6))
+        while time.monotonic() >= start + pull_index * PULL / RATE:
+            lib.host_rx_pull(rx, out, PULL)
+            pull_index += 1
+            lib.host_rx_stats(rx, ctypes.byref(st))
+            if st.state == 2:  # PLAYING
+                played_chunks += 1
+                if max(abs(v) for v in out) < 100:
+                    silent_chunks += 1
+                depth_sum += st.depth_ms
+                depth_n += 1
+    relay.running = False
+    tx_thread.join()
+    relay.join(1.0)
+
+    lib.host_rx_stats(rx, ctypes.byref(st))
+    bad = lib.host_rx_bad(rx)
+    avg_depth = depth_sum / max(1, depth_n)
+    missing = relay.dropped
+    ok = (bad == 0 and st.underruns <= 2 and st.target_ms <= 80 and avg_depth <= 80 and
+          st.concealed_blocks >= 0.8 * missing and silent_chunks <= 0.02 * max(1, played_chunks) and
+          relay.reordered > 0)
+    print('%-7s %d pkts of %.1fms: dropped=%d reordered=%d | concealed=%d late=%d underruns=%d bad=%d | '
+          'target=%.1fms avg depth=%.1fms jitter=%.1fms silent=%d/%d  %s'
+          % ({0: 'pcm', 1: 'adpcm', 2: 'adpcm2'}[codec], sent[0], packet_samples * 1000 / RATE, relay.dropped,
+             relay.reordered, st.concealed_blocks, st.late_blocks, st.underruns, bad, st.target_ms, avg_depth,
+             st.jitter_ms, silent_chunks, played_chunks, 'ok' if ok else 'FAIL'))
+    return ok
+
+
+def main():
+    parser = argparse.ArgumentParser(description='UDP 音频回环测试')
+    parser.add_argument('--seconds', type=float, default=8)
+    parser.add_argument('--packet-ms', type=float, default=sender.RTP_DEFAULT_PACKET_MS)
+    parser.add_argument('--loss', type=float, default=0.05)
+    parser.add_argument('--jitter-ms', type=float, default=4, help='中继随机延迟均值 (指数分布)')
+    parser.add_argument('--spike', type=float, default=0.02, help='20~40ms 延迟尖峰的概率')
+    parser.add_argument('--codec', choices=sorted(sender.CODEC_NAMES), default='adpcm')
+    parser.add_argument('--seed', type=int, default=1)
+    args = parser.parse_args()
+
+    ok = True
+    with tempfile.TemporaryDirectory() as workdir:
+        lib = build_lib(workdir)
+        for name, codec in sorted(sender.CODEC_NAMES.items()):
+            exact = check_packetizer(lib, codec, 220)
+            print('packetizer %-7s py==c %s' % (name, 'yes' if exact else 'NO'))
+            ok = ok and exact
+        ok = run_loopback(lib, sender.CODEC_NAMES[args.codec], args.seconds, args.packet_ms, args.loss,
+                          args.jitter_ms, args.spike, args.seed) and ok
+    print('PASS' if ok else 'FAIL')
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,265 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+启动依赖图 (components/Peripherals/src/boot_graph.c) 主机校验
+
+借 host_harness 的 pthread FreeRTOS 模拟 (任务绑核、任务通知、互斥量、事件组) 把固件 boot_graph.c 编译为共享库，
+每个场景加载一份独立的库 (模块状态为静态变量)，检查:
+  1. 并行: 两个 100 ms 的独立步骤在两个核上同时执行，汇合步骤在二者结束后立即开始；
+  2. 绑核: 指定核的步骤只在该核的工作任务上运行；
+  3. 失败传播: 依赖失败的步骤及其后继标记为跳过，无关步骤照常完成，boot_graph_wait 返回 false；
+  4. 图检查: 依赖环、未知依赖、重名、超出容量、启动后添加均被拒绝；
+  5. 外部事件: 依赖事件的步骤在 boot_graph_signal 之后才开始，boot_graph_wait 可等待事件；
+  6. 进度回调: 完成数单调递增且计入跳过的步骤，全部结束后工作任务退出。
+
+用法:
+  python boot_graph_bench.py [-v]   (-v 打印固件日志与耗时报告)
+"""
+
+import ctypes
+import os
+import shutil
+import sys
+import tempfile
+import time
+
+import host_harness
+from host_harness import REPO_PERIPH
+
+# 测试用步骤函数 (FreeRTOS 由 host_harness 的 pthread 实现模拟)
+GLUE_C = r'''
+#include "boot_graph.h"
+#include "freertos/task.h"
+#include <stdint.h>
+
+// ---- 测试步骤: arg 低 16 位为耗时 ms，bit16 表示返回失败 ----
+static esp_err_t step_sleep(void *arg) {
+    uintptr_t v = (uintptr_t)arg;
+    vTaskDelay(v & 0xffff);
+    return (v & 0x10000) ? ESP_FAIL : ESP_OK;
+}
+
+static uint32_t s_progress[32];
+static volatile uint32_t s_progress_n;
+static void progress_cb(uint32_t done, uint32_t total) {
+    if (s_progress_n < 32) s_progress[s_progress_n++] = done * 100 + total;
+}
+
+int host_add(const char *name, int sleep_ms, int fail, const char *deps, int core, int event) {
+    boot_step_t step = {
+        .name = name,
+        .fn = event ? NULL : step_sleep,
+        .arg = (void *)(uintptr_t)(sleep_ms | (fail ? 0x10000 : 0)),
+        .deps = deps,
+        .core = (int8_t)core,
+    };
+    return boot_graph_add(&step, 1);
+}
+int host_start(void) {
+    boot_graph_set_progress_cb(progress_cb);
+    return boot_graph_start(4096, 5);
+}
+int host_signal(const char *name) { return boot_graph_signal(name); }
+int host_wait(const char *name, int ms) { return boot_graph_wait(name, ms); }
+uint32_t host_progress(uint32_t *out, uint32_t max) {
+    uint32_t n = s_progress_n < max ? s_progress_n : max;
+    for (uint32_t i = 0; i < n; i++) out[i] = s_progress[i];
+    return n;
+}
+size_t host_records(boot_step_record_t *out, size_t max) { return boot_graph_get_records(out, max); }
+'''
+
+
+class Record(ctypes.Structure):
+    _fields_ = [('name', ctypes.c_char_p), ('state', ctypes.c_int), ('is_event', ctypes.c_bool),
+                ('core', ctypes.c_int8), ('err', ctypes.c_int), ('ready_us', ctypes.c_int64),
+                ('start_us', ctypes.c_int64), ('end_us', ctypes.c_int64)]
+
+
+STATE = ['pending', 'running', 'ok', 'failed', 'skipped']
+ESP_ERR_NO_MEM, ESP_ERR_INVALID_STATE, ESP_ERR_NOT_FOUND = 0x101, 0x103, 0x105
+
+
+class Graph:
+    """一份独立加载的 boot_graph 实例"""
+    counter = 0
+
+    def __init__(self, so_path, workdir, verbose):
+        Graph.counter += 1
+        copy = os.path.join(workdir, 'libboot_graph_%d.so' % Graph.counter)
+        shutil.copy(so_path, copy)
+        self.lib = ctypes.CDLL(copy)
+        self.lib.host_records.restype = ctypes.c_size_t
+        self.keep = []
+        ctypes.c_int.in_dll(self.lib, 'host_verbose').value = 1 if verbose else 0
+
+    def add(self, name, ms=0, deps=None, core=-1, fail=False, event=False):
+        # 步骤名与依赖串由图保存指针 (固件中为常量字符串)，需保持存活
+        name_b = ctypes.create_string_buffer(name.encode())
+        deps_b = ctypes.create_string_buffer(deps.encode()) if deps else None
+        self.keep += [name_b, deps_b]
+        return self.lib.host_add(name_b, ms, int(fail), deps_b, core, int(event))
+
+    def start(self):
+        return self.lib.host_start()
+
+    def signal(self, name):
+        return self.lib.host_signal(name.encode())
+
+    def wait(self, name, ms):
+        return bool(self.lib.host_wait(name.encode(), ms))
+
+    def join(self, timeout=5.0):
+        end = time.time() + timeout
+        while self.lib.host_live_tasks() > 0 and time.time() < end:
+            time.sleep(0.005)
+        return self.lib.host_live_tasks() == 0
+
+    def records(self):
+        buf = (Record * 32)()
+        n = self.lib.host_records(buf, 32)
+        return {r.name.decode(): r for r in buf[:n]}
+
+    def progress(self):
+        buf = (ctypes.c_uint32 * 32)()
+        n = self.lib.host_progress(buf, 32)
+        return [(v // 100, v % 100) for v in buf[:n]]
+
+
+def build_lib(workdir):
+    return host_harness.compile_so(workdir, 'boot_graph', [os.path.join(REPO_PERIPH, 'src', 'boot_graph.c')],
+                                   glue={'glue.c': GLUE_C}, includes=[os.path.join(REPO_PERIPH, 'inc')])
+
+
+def check(name, ok, detail=''):
+    return host_harness.check(name, ok, detail, width=40)
+
+
+def ms(us):
+    return us / 1000.0
+
+
+def test_parallel(new):
+    g = new()
+    g.add('a', 100)
+    g.add('b', 100)
+    g.add('c', 50, deps='a, b')
+    t0 = time.time()
+    ok = check('parallel: start', g.start() == 0)
+    ok &= check('parallel: wait join step', g.wait('c', 2000))
+    elapsed = (time.time() - t0) * 1000
+    ok &= check('parallel: workers exit', g.join())
+    r = g.records()
+    ok &= check('parallel: independent steps overlap', r['a'].core != r['b'].core and
+                abs(r['a'].start_us - r['b'].start_us) < 20000,
+                'a core %d, b core %d' % (r['a'].core, r['b'].core))
+    ok &= check('parallel: total < serial', elapsed < 230, '%.0f ms (serial 250 ms)' % elapsed)
+    last_dep = max(r['a'].end_us, r['b'].end_us)
+    ok &= check('parallel: join ready at last dep', r['c'].ready_us == last_dep and
+                r['c'].start_us - last_dep < 5000, 'start +%.2f ms' % ms(r['c'].start_us - last_dep))
+    return ok
+
+
+def test_pinning(new):
+    g = new()
+    for i in range(3):
+        g.add('p0_%d' % i, 20, core=0)
+        g.add('p1_%d' % i, 20, core=1)
+    g.add('any', 20, deps='p0_2,p1_2')
+    g.add('big', 20, core=5)   # 超出核数视为任一核
+    ok = check('pinning: start', g.start() == 0)
+    ok &= check('pinning: workers exit', g.join())
+    r = g.records()
+    ok &= check('pinning: core honoured', all(r['p0_%d' % i].core == 0 and r['p1_%d' % i].core == 1
+                                            for i in range(3)))
+    ok &= check('pinning: all ok', all(v.state == 2 for v in r.values()))
+    return ok
+
+
+def test_failure(new):
+    g = new()
+    g.add('f', 10, fail=True)
+    g.add('g', 10, deps='f')
+    g.add('h', 10, deps='g')
+    g.add('i', 30)
+    g.add('j', 10, deps='i')
+    ok = check('failure: start', g.start() == 0)
+    ok &= check('failure: wait on skipped returns false', not g.wait('h', 1000))
+    ok &= check('failure: wait on good branch', g.wait('j', 1000))
+    ok &= check('failure: workers exit', g.join())
+    r = g.records()
+    states = {k: STATE[v.state] for k, v in r.items()}
+    ok &= check('failure: propagated', states == {'f': 'failed', 'g': 'skipped', 'h': 'skipped',
+                                                  'i': 'ok', 'j': 'ok'}, str(states))
+    ok &= check('failure: skipped never ran', r['g'].start_us == 0 and r['h'].start_us == 0)
+    prog = g.progress()
+    # f 失败时 g、h 一并跳过，done 直接跳到 3
+    ok &= check('progress: monotonic, skips counted', all(a[0] < b[0] for a, b in zip(prog, prog[1:])) and
+                len(prog) == 3 and prog[-1] == (5, 5), str(prog))
+    return ok
+
+
+def test_validation(new):
+    g = new()
+    g.add('x', deps='y')
+    g.add('y', deps='x')
+    g.add('z')
+    ok = check('validation: cycle rejected', g.start() == ESP_ERR_INVALID_STATE)
+    g = new()
+    g.add('x', deps='nope')
+    ok &= check('validation: unknown dep', g.start() == ESP_ERR_NOT_FOUND)
+    g = new()
+    ok &= check('validation: duplicate name', g.add('x') == 0 and g.add('x') == ESP_ERR_INVALID_STATE)
+    for i in range(23):
+        g.add('s%d' % i)
+    ok &= check('validation: capacity', g.add('overflow') == ESP_ERR_NO_MEM)
+    g = new()
+    g.add('only', 5)
+    g.start()
+    ok &= check('validation: add after start', g.add('late') == ESP_ERR_INVALID_STATE)
+    ok &= check('validation: unknown signal', g.signal('only') == ESP_ERR_NOT_FOUND)
+    g.join()
+    return ok
+
+
+def test_event(new):
+    g = new()
+    g.add('net_up', event=True)
+    g.add('early', 10)
+    g.add('server', 10, deps='net_up,early')
+    ok = check('event: start', g.start() == 0)
+    time.sleep(0.08)
+    r = g.records()
+    ok &= check('event: gated until signal', STATE[r['server'].state] == 'pending' and
+                STATE[r['early'].state] == 'ok')
+    ok &= check('event: wait times out before signal', not g.wait('net_up', 10))
+    ok &= check('event: signal', g.signal('net_up') == 0 and g.signal('net_up') == 0)
+    ok &= check('event: wait on event', g.wait('net_up', 100))
+    ok &= check('event: dependent runs', g.wait('server', 1000))
+    ok &= check('event: workers exit', g.join())
+    r = g.records()
+    ok &= check('event: starts after signal', r['server'].start_us >= r['net_up'].end_us and
+                r['net_up'].is_event and r['net_up'].core == -1,
+                'lag %.2f ms' % ms(r['server'].start_us - r['net_up'].end_us))
+    return ok
+
+
+def main():
+    verbose = '-v' in sys.argv
+    with tempfile.TemporaryDirectory() as workdir:
+        so_path = build_lib(workdir)
+
+        def new():
+            return Graph(so_path, workdir, verbose)
+
+        ok = test_parallel(new)
+        ok &= test_pinning(new)
+        ok &= test_failure(new)
+        ok &= test_validation(new)
+        ok &= test_event(new)
+    print('PASS' if ok else 'FAIL')
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
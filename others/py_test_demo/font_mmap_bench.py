@@ -0,0 +1,416 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+内存映射字体 (main/fonts/font_mmap.c) 主机校验与微基准
+
+借 host_harness 把固件 font_mmap.c 编译为共享库，对 font/ 下的每个 LVGL 二进制字体检查:
+  1. 与参考解码 (按 lv_font_loader.c / lv_font_fmt_txt.c 的规则用 Python 实现) 逐字形一致:
+     全部 ASCII、随机 CJK 与不存在的码点的描述符、解包后的位图，以及字距对的前进宽度与制表符；
+  2. LRU 缓存: 命中/未命中计数，淘汰最久未用的字形，被淘汰后重新解包内容不变；
+  3. 异常输入: 压缩字体、截断文件返回 NULL (调用方回退到 lv_font_load)；
+  4. 占用: 索引与缓存的 RAM 对比 lv_font_load 全量加载的估算，及查找/位图的单次耗时 (主机)。
+
+用法:
+  python font_mmap_bench.py [-v]   (-v 以字符画打印 "中")
+"""
+
+import ctypes
+import os
+import random
+import struct
+import sys
+import tempfile
+
+import host_harness
+from host_harness import REPO, check
+
+FONT_DIR = os.path.join(REPO, 'font')
+PARTITION_SIZE = 1536 * 1024
+
+# LVGL 8.3 字体结构
+STUBS = {
+    'lvgl.h': '''#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+struct _lv_font_t;
+typedef struct {
+    const struct _lv_font_t *resolved_font;
+    uint16_t adv_w;
+    uint16_t box_w;
+    uint16_t box_h;
+    int16_t ofs_x;
+    int16_t ofs_y;
+    uint8_t bpp : 4;
+    uint8_t is_placeholder : 1;
+} lv_font_glyph_dsc_t;
+typedef struct _lv_font_t {
+    bool (*get_glyph_dsc)(const struct _lv_font_t *, lv_font_glyph_dsc_t *, uint32_t letter, uint32_t letter_next);
+    const uint8_t *(*get_glyph_bitmap)(const struct _lv_font_t *, uint32_t);
+    int16_t line_height;
+    int16_t base_line;
+    uint8_t subpx : 2;
+    int8_t underline_position;
+    int8_t underline_thickness;
+    const void *dsc;
+    const struct _lv_font_t *fallback;
+    void *user_data;
+} lv_font_t;
+''',
+}
+
+GLUE_C = r'''
+#include <time.h>
+#include "font_mmap.h"
+
+int host_dsc(const lv_font_t *font, uint32_t letter, uint32_t next, int32_t *out) {
+    lv_font_glyph_dsc_t d = {0};
+    d.is_placeholder = 1;
+    if (!font->get_glyph_dsc(font, &d, letter, next)) {
+        return 0;
+    }
+    out[0] = d.adv_w; out[1] = d.box_w; out[2] = d.box_h;
+    out[3] = d.ofs_x; out[4] = d.ofs_y; out[5] = d.bpp; out[6] = d.is_placeholder;
+    return 1;
+}
+
+const uint8_t *host_bitmap(const lv_font_t *font, uint32_t letter) {
+    return font->get_glyph_bitmap(font, letter);
+}
+
+void host_font_info(const lv_font_t *font, int32_t *out) {
+    out[0] = font->line_height; out[1] = font->base_line;
+    out[2] = font->underline_position; out[3] = font->underline_thickness;
+}
+
+void host_stats(const lv_font_t *font, uint32_t *out) {
+    const font_mmap_stats_t *s = font_mmap_get_stats(font);
+    out[0] = s->glyphs; out[1] = s->ranges; out[2] = s->ram_bytes;
+    out[3] = s->cache_hits; out[4] = s->cache_misses;
+}
+
+static double elapsed_ns(struct timespec a, struct timespec b, int loops) {
+    return ((b.tv_sec - a.tv_sec) * 1e9 + (b.tv_nsec - a.tv_nsec)) / loops;
+}
+
+// kind 0: 描述符 (随机码点)；1: 位图命中 (同一字形)；2: 位图未命中 (轮转超过缓存容量的字形)
+double host_bench(const lv_font_t *font, int kind, int loops, const uint32_t *cps, int n) {
+    lv_font_glyph_dsc_t d;
+    volatile uintptr_t sink = 0;
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < loops; i++) {
+        if (kind == 0) {
+            sink += font->get_glyph_dsc(font, &d, cps[i % n], cps[(i + 1) % n]);
+        } else if (kind == 1) {
+            sink += (uintptr_t)font->get_glyph_bitmap(font, cps[0]);
+        } else {
+            sink += (uintptr_t)font->get_glyph_bitmap(font, cps[i % n]);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    (void)sink;
+    return elapsed_ns(t0, t1, loops);
+}
+'''
+
+
+def build_lib(workdir):
+    lib = host_harness.build_lib(workdir, 'font_mmap', [os.path.join(REPO, 'main', 'fonts', 'font_mmap.c')],
+                                 glue={'glue.c': GLUE_C}, stubs=STUBS,
+                                 includes=[os.path.join(REPO, 'main', 'fonts')],
+                                 cflags=['-Wextra', '-Wno-unused-parameter'])
+    lib.font_mmap_create.restype = ctypes.c_void_p
+    lib.font_mmap_create.argtypes = [ctypes.c_void_p, ctypes.c_size_t]
+    lib.font_mmap_destroy.argtypes = [ctypes.c_void_p]
+    lib.host_dsc.argtypes = [ctypes.c_void_p, ctypes.c_uint32, ctypes.c_uint32, ctypes.POINTER(ctypes.c_int32)]
+    lib.host_bitmap.restype = ctypes.c_void_p
+    lib.host_bitmap.argtypes = [ctypes.c_void_p, ctypes.c_uint32]
+    lib.host_font_info.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_int32)]
+    lib.host_stats.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_uint32)]
+    lib.host_bench.restype = ctypes.c_double
+    lib.host_bench.argtypes = [ctypes.c_void_p, ctypes.c_int, ctypes.c_int, ctypes.POINTER(ctypes.c_uint32),
+                               ctypes.c_int]
+    return lib
+
+
+class RefFont:
+    """按 LVGL 加载器规则全量解码的参考字体"""
+
+    def __init__(self, data):
+        self.data = data
+        pos = 0
+        tables = {}
+        while pos + 8 <= len(data):
+            length, label = struct.unpack_from('<I4s', data, pos)
+            if length < 8 or label not in (b'head', b'cmap', b'loca', b'glyf', b'kern'):
+                break
+            tables[label] = (pos, length)
+            pos += length
+        h = tables[b'head'][0] + 8
+        (_, self.tables_count, _, ascent, descent, _, _, _, _, _, self.default_adv, self.kern_scale,
+         self.loc_fmt, self.gid_fmt, self.adv_fmt, self.bpp, self.xy_bits, self.wh_bits, self.adv_bits,
+         self.compression, _, _, self.ul_pos, self.ul_thick) = struct.unpack_from('<IHHHhHhHhhHHBBBBBBBBBBhH', data, h)
+        self.line_height = ascent - descent
+        self.base_line = -descent
+
+        self.cmap = {}
+        c0 = tables[b'cmap'][0]
+        for i in range(struct.unpack_from('<I', data, c0 + 8)[0]):
+            ofs, start, rlen, gstart, entries, fmt = struct.unpack_from('<IIHHHB', data, c0 + 12 + i * 16)
+            d = c0 + ofs
+            if fmt == 0:
+                for k in range(min(entries, rlen)):
+                    self.cmap.setdefault(start + k, gstart + data[d + k])
+            elif fmt == 1:
+                for k in range(entries):
+                    cp, = struct.unpack_from('<H', data, d + 2 * k)
+                    g, = struct.unpack_from('<H', data, d + 2 * entries + 2 * k)
+                    self.cmap.setdefault(start + cp, gstart + g)
+            elif fmt == 2:
+                for k in range(rlen):
+                    self.cmap.setdefault(start + k, gstart + k)
+            else:
+                for k in range(entries):
+                    cp, = struct.unpack_from('<H', data, d + 2 * k)
+                    self.cmap.setdefault(start + cp, gstart + k)
+
+        l0 = tables[b'loca'][0]
+        self.glyph_count, = struct.unpack_from('<I', data, l0 + 8)
+        fmt = '<%d%s' % (self.glyph_count, 'I' if self.loc_fmt else 'H')
+        self.loca = struct.unpack_from(fmt, data, l0 + 12)
+        self.glyf = tables[b'glyf'][0]
+
+        self.kern = {}
+        if b'kern' in tables:
+            k0 = tables[b'kern'][0]
+            kfmt = data[k0 + 8]
+            if kfmt == 0:
+                n, = struct.unpack_from('<I', data, k0 + 12)
+                w = 2 if self.gid_fmt else 1
+                ids = struct.unpack_from('<%d%s' % (2 * n, 'H' if w == 2 else 'B'), data, k0 + 16)
+                vals = struct.unpack_from('<%db' % n, data, k0 + 16 + 2 * n * w)
+                for i in range(n):
+                    self.kern[(ids[2 * i], ids[2 * i + 1])] = vals[i]
+            elif kfmt == 3:
+                map_len, rows, cols = struct.unpack_from('<HBB', data, k0 + 12)
+                left = data[k0 + 16:k0 + 16 + map_len]
+                right = data[k0 + 16 + map_len:k0 + 16 + 2 * map_len]
+                vals = struct.unpack_from('<%db' % (rows * cols), data, k0 + 16 + 2 * map_len)
+                for a in range(map_len):
+                    for b in range(map_len):
+                        if left[a] and right[b] and vals[(left[a] - 1) * cols + right[b] - 1]:
+                            self.kern[(a, b)] = vals[(left[a] - 1) * cols + right[b] - 1]
+
+    def glyph(self, gid):
+        p = self.glyf + self.loca[gid]
+        nbits = self.adv_bits + 2 * self.xy_bits + 2 * self.wh_bits
+        raw = self.data[p:p + 8 + (nbits + 255 * 255 * 8 + 7) // 8]
+        bits = ''.join('{:08b}'.format(b) for b in raw[:(nbits + 7) // 8 + 1])
+
+        def take(pos, n, signed=False):
+            if n == 0:
+                return 0
+            v = int(bits[pos:pos + n], 2)
+            return v - (1 << n) if signed and v >> (n - 1) else v
+
+        pos = 0
+        adv = self.default_adv
+        if self.adv_bits:
+            adv = take(pos, self.adv_bits)
+            pos += self.adv_bits
+        if self.adv_fmt == 0:
+            adv *= 16
+        ofs_x = take(pos, self.xy_bits, True)
+        ofs_y = take(pos + self.xy_bits, self.xy_bits, True)
+        pos += 2 * self.xy_bits
+        box_w = take(pos, self.wh_bits)
+        box_h = take(pos + self.wh_bits, self.wh_bits)
+        pos += 2 * self.wh_bits
+        bmp_bits = box_w * box_h * self.bpp
+        full = int.from_bytes(raw[:(pos + bmp_bits + 7) // 8], 'big')
+        total = ((pos + bmp_bits + 7) // 8) * 8
+        val = (full >> (total - pos - bmp_bits)) & ((1 << bmp_bits) - 1) if bmp_bits else 0
+        nbytes = (bmp_bits + 7) // 8
+        bmp = (val << (nbytes * 8 - bmp_bits)).to_bytes(nbytes, 'big') if nbytes else b''
+        return adv, box_w, box_h, ofs_x, ofs_y, bmp
+
+    def dsc(self, letter, letter_next):
+        is_tab = letter == 9
+        if is_tab:
+            letter = 32
+        gid = self.cmap.get(letter, 0)
+        if gid == 0:
+            return None
+        adv, box_w, box_h, ofs_x, ofs_y, _ = self.glyph(gid)
+        kv = 0
+        gid_next = self.cmap.get(letter_next, 0)
+        if gid_next:
+            kv = (self.kern.get((gid, gid_next), 0) * self.kern_scale) >> 4
+        if is_tab:
+            adv *= 2
+            box_w *= 2
+        return ((adv + kv + 8) >> 4, box_w, box_h, ofs_x, ofs_y, self.bpp, 0)
+
+    def heap_estimate(self):
+        """lv_font_load: 每字形 8 字节描述符 + 按字节对齐的位图"""
+        total = 8 * self.glyph_count
+        for gid in range(1, self.glyph_count):
+            p = self.glyf + self.loca[gid]
+            hdr = int.from_bytes(self.data[p:p + 8], 'big')
+            pos = self.adv_bits + 2 * self.xy_bits
+            w = (hdr >> (64 - pos - self.wh_bits)) & ((1 << self.wh_bits) - 1)
+            h = (hdr >> (64 - pos - 2 * self.wh_bits)) & ((1 << self.wh_bits) - 1)
+            total += (w * h * self.bpp + 7) // 8
+        return total
+
+
+def load_mapped(lib, data):
+    # 模拟整个分区被映射: 文件之后为擦除态 0xFF
+    buf = ctypes.create_string_buffer(data + b'\xff' * (PARTITION_SIZE - len(data)), PARTITION_SIZE)
+    return buf, lib.font_mmap_create(ctypes.cast(buf, ctypes.c_void_p), PARTITION_SIZE)
+
+
+def get_dsc(lib, font, letter, letter_next=0):
+    out = (ctypes.c_int32 * 7)()
+    return tuple(out) if lib.host_dsc(font, letter, letter_next, out) else None
+
+
+def get_bitmap(lib, font, letter, nbytes):
+    p = lib.host_bitmap(font, letter)
+    return None if p is None else ctypes.string_at(p, nbytes)
+
+
+def test_font(lib, name, verbose):
+    with open(os.path.join(FONT_DIR, name), 'rb') as f:
+        data = f.read()
+    ref = RefFont(data)
+    buf, font = load_mapped(lib, data)
+    print('-- %s (%d bpp, %d glyphs, %d kern pairs)' % (name, ref.bpp, ref.glyph_count, len(ref.kern)))
+    if not check('create', font is not None, ''):
+        return False
+
+    info = (ctypes.c_int32 * 4)()
+    lib.host_font_info(font, info)
+    ok = check('line metrics', tuple(info) == (ref.line_height, ref.base_line, ref.ul_pos, ref.ul_thick),
+               'line_height %d base_line %d' % (info[0], info[1]))
+
+    rng = random.Random(50)
+    cjk = [cp for cp in ref.cmap if cp >= 0x4E00]
+    letters = list(range(32, 127)) + rng.sample(cjk, 2000) + [9, 0x4DFF, 0x9FA6, 0x1F600, 0]
+    bad = []
+    for letter in letters:
+        want = ref.dsc(letter, 0)
+        got = get_dsc(lib, font, letter)
+        if want != got:
+            bad.append((letter, want, got))
+            continue
+        if want is not None and letter != 9:
+            gid = ref.cmap[letter]
+            bmp = ref.glyph(gid)[5]
+            if bmp and get_bitmap(lib, font, letter, len(bmp)) != bmp:
+                bad.append((letter, 'bitmap'))
+    ok &= check('descriptors + bitmaps', not bad, '%d letters%s' % (len(letters), ', first bad %r' % (bad[0],) if bad else ''))
+
+    rev = {g: cp for cp, g in ref.cmap.items()}
+    pairs = [(rev[a], rev[b]) for (a, b) in ref.kern if a in rev and b in rev]
+    pairs += [(rng.choice(cjk), rng.choice(cjk)) for _ in range(200)] + [(ord('A'), ord('V')), (9, ord('A'))]
+    bad = [(a, b) for a, b in pairs if get_dsc(lib, font, a, b) != ref.dsc(a, b)]
+    kerned = sum(1 for a, b in pairs if ref.dsc(a, b)[0] != ref.dsc(a, 0)[0])
+    ok &= check('kerning', not bad, '%d pairs, %d change advance%s' % (len(pairs), kerned,
+                                                                    ', first bad %r' % (bad[0],) if bad else ''))
+
+    stats = (ctypes.c_uint32 * 5)()
+    lib.host_stats(font, stats)
+    heap = ref.heap_estimate()
+    ok &= check('stats', stats[0] == ref.glyph_count and stats[1] >= 1,
+                '%d ranges, %d bytes RAM vs ~%d bytes lv_font_load' % (stats[1], stats[2], heap))
+
+    if verbose and ref.cmap.get(0x4E2D):
+        d = get_dsc(lib, font, 0x4E2D)
+        bmp = get_bitmap(lib, font, 0x4E2D, (d[1] * d[2] * d[5] + 7) // 8)
+        val = int.from_bytes(bmp, 'big')
+        nbits = len(bmp) * 8
+        for y in range(d[2]):
+            row = ''
+            for x in range(d[1]):
+                i = (y * d[1] + x) * d[5]
+                px = (val >> (nbits - i - d[5])) & ((1 << d[5]) - 1)
+                row += ' .+#'[px * 3 // ((1 << d[5]) - 1)]
+            print('    |%s|' % row)
+
+    lib.font_mmap_destroy(font)
+    del buf
+    return ok
+
+
+def test_cache(lib):
+    with open(os.path.join(FONT_DIR, 'font_noto_sans_sc_16_2bpp.bin'), 'rb') as f:
+        data = f.read()
+    ref = RefFont(data)
+    buf, font = load_mapped(lib, data)
+    print('-- cache')
+    stats = (ctypes.c_uint32 * 5)()
+
+    def counters():
+        lib.host_stats(font, stats)
+        return stats[3], stats[4]
+
+    cps = list(range(0x4E00, 0x4E00 + 33))
+    sizes = {cp: len(ref.glyph(ref.cmap[cp])[5]) for cp in cps}
+    for cp in cps[:32]:
+        get_bitmap(lib, font, cp, sizes[cp])
+    ok = check('cold fill', counters() == (0, 32), '%r' % (counters(),))
+    for cp in cps[:32]:
+        get_bitmap(lib, font, cp, sizes[cp])
+    ok &= check('warm hits', counters() == (32, 32), '%r' % (counters(),))
+    # 先访问 1..31，使 0 号最久未用；新字形应淘汰 0 号
+    for cp in cps[1:32]:
+        get_bitmap(lib, font, cp, sizes[cp])
+    get_bitmap(lib, font, cps[32], sizes[cps[32]])
+    get_bitmap(lib, font, cps[1], sizes[cps[1]])
+    ok &= check('lru keeps recent', counters() == (64, 33), '%r' % (counters(),))
+    bmp = get_bitmap(lib, font, cps[0], sizes[cps[0]])
+    ok &= check('evicted reloaded intact', counters() == (64, 34) and bmp == ref.glyph(ref.cmap[cps[0]])[5],
+                '%r' % (counters(),))
+    lib.font_mmap_destroy(font)
+    del buf
+
+    bad = bytearray(data)
+    bad[8 + 33] = 1  # compression_id
+    buf, font = load_mapped(lib, bytes(bad))
+    ok &= check('compressed rejected', font is None, '')
+    buf2 = ctypes.create_string_buffer(data[:20000], 20000)
+    font = lib.font_mmap_create(ctypes.cast(buf2, ctypes.c_void_p), 20000)
+    ok &= check('truncated rejected', font is None, '')
+    return ok
+
+
+def bench(lib):
+    with open(os.path.join(FONT_DIR, 'font_noto_sans_sc_16_2bpp.bin'), 'rb') as f:
+        data = f.read()
+    buf, font = load_mapped(lib, data)
+    rng = random.Random(1)
+    cps = (ctypes.c_uint32 * 4096)(*[rng.randrange(0x4E00, 0x9FA6) for _ in range(4096)])
+    names = ('glyph dsc (random CJK, kerning)', 'glyph bitmap cache hit', 'glyph bitmap miss (unpack)')
+    for kind, name in enumerate(names):
+        print('benchmark: %-34s %.1f ns/op (host)' % (name, lib.host_bench(font, kind, 1000000, cps, 4096)))
+    lib.font_mmap_destroy(font)
+    del buf
+
+
+def main():
+    verbose = '-v' in sys.argv
+    with tempfile.TemporaryDirectory() as workdir:
+        lib = build_lib(workdir)
+        ok = True
+        for name in sorted(os.listdir(FONT_DIR)):
+            if name.endswith('.bin'):
+                ok &= test_font(lib, name, verbose)
+        ok &= test_cache(lib)
+        bench(lib)
+    print('PASS' if ok else 'FAIL')
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -14,6 +14,12 @@ FRAME_HEADER = 0xAA55
 FRAME_TYPE_REMOTE_CONTROL = 0x01
 FRAME_TYPE_TELEMETRY = 0x02
 FRAME_TYPE_HEARTBEAT = 0x03
+FRAME_TYPE_SYS_STATS = 0x08
+
+# 系统状态负载: 与C语言中的 sys_stats_payload_t 匹配 (tasks 只发送 task_count 项)
+SYS_STATS_HEAD = struct.Struct('<I2H3H3H3HB')
+SYS_STATS_TASK = struct.Struct('<8sbBH')
+SYS_STATS_HEAPS = ("internal", "dma", "spiram")
 
 # CRC16 Modbus
 crc16_func = crcmod.predefined.mkPredefinedCrcFun('modbus')
@@ -75,6 +81,21 @@ def create_telemetry_frame():
     frame = struct.pack('>HBB', FRAME_HEADER, length, frame_type) + payload + struct.pack('<H', crc)
     return frame
 
+def print_sys_stats(payload):
+    """ 打印系统状态帧 (ESP32 每秒发送一次) """
+    fields = SYS_STATS_HEAD.unpack_from(payload)
+    uptime_ms, core0, core1 = fields[0:3]
+    free_kb, largest_kb, failures = fields[3:6], fields[6:9], fields[9:12]
+    task_count = fields[12]
+    print(f"系统状态 @{uptime_ms / 1000:.1f}s: core0 {core0 / 10:.1f}% core1 {core1 / 10:.1f}%")
+    for i, name in enumerate(SYS_STATS_HEAPS):
+        print(f"  {name:<8} free {free_kb[i]:>5}KB largest {largest_kb[i]:>5}KB fail {failures[i]}")
+    for i in range(task_count):
+        name, core, cpu_half_pct, stack_hwm = SYS_STATS_TASK.unpack_from(
+            payload, SYS_STATS_HEAD.size + i * SYS_STATS_TASK.size)
+        name = name.split(b'\0', 1)[0].decode(errors='replace')
+        print(f"  {name:<8} core {core:>2} cpu {cpu_half_pct / 2:5.1f}% stack {stack_hwm}")
+
 def parse_and_handle_frame(data):
     """ 解析并处理收到的单个数据帧 """
     # 同样，帧头使用 >H (大端序) 解析
@@ -100,6 +121,8 @@ def parse_and_handle_frame(data):
         throttle = channels[0] if channel_count > 0 else "N/A"
         direction = channels[1] if channel_count > 1 else "N/A"
         print(f"收到遥控数据: 油门={throttle}, 方向={direction}")
+    elif frame_type == FRAME_TYPE_SYS_STATS:
+        print_sys_stats(payload)
     else:
         print(f"收到未知类型的帧: {frame_type}")
         
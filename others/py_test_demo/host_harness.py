@@ -0,0 +1,361 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+主机校验脚本共用的编译环境
+
+把固件源文件连同 ESP-IDF / FreeRTOS 桩头文件编译为共享库，供 ctypes 加载:
+  - STUBS: esp_err / esp_log / esp_attr / esp_heap_caps / esp_timer 与 FreeRTOS 头文件；
+  - SHIM_C: 上述头文件中非内联部分的实现，FreeRTOS 任务、任务通知、互斥量、事件组用 pthread 模拟，
+    临界区用原子标志代替关中断；
+  - build_lib / compile_so: 写出桩与胶水代码后调用 cc，各脚本只需提供自己的胶水代码与额外桩；
+  - check: 统一的检查项输出格式。
+
+固件日志默认不输出，置 host_verbose = 1 (ctypes.c_int.in_dll) 后打印到 stdout。
+"""
+
+import ctypes
+import os
+import subprocess
+
+REPO = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..'))
+REPO_PERIPH = os.path.join(REPO, 'components', 'Peripherals')
+
+STUBS = {
+    'esp_err.h': '''#pragma once
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_NO_MEM 0x101
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_STATE 0x103
+#define ESP_ERR_INVALID_SIZE 0x104
+#define ESP_ERR_NOT_FOUND 0x105
+#define ESP_ERR_TIMEOUT 0x107
+static inline const char *esp_err_to_name(esp_err_t err) { return err == ESP_OK ? "ESP_OK" : "ESP_ERR"; }
+''',
+    'esp_attr.h': '''#pragma once
+#define IRAM_ATTR
+''',
+    'esp_log.h': '''#pragma once
+void host_log(const char *level, const char *tag, const char *fmt, ...);
+#define ESP_LOGE(tag, ...) host_log("E", tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) host_log("W", tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) host_log("I", tag, __VA_ARGS__)
+#define ESP_LOGD(tag, ...) ((void)(tag))
+''',
+    'esp_heap_caps.h': '''#pragma once
+#include <stdlib.h>
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_DMA (1 << 3)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+static inline void *heap_caps_malloc(size_t size, unsigned caps) { (void)caps; return malloc(size); }
+static inline void *heap_caps_calloc(size_t n, size_t size, unsigned caps) { (void)caps; return calloc(n, size); }
+static inline void *heap_caps_realloc(void *p, size_t size, unsigned caps) { (void)caps; return realloc(p, size); }
+static inline void *heap_caps_aligned_alloc(size_t align, size_t size, unsigned caps) {
+    (void)caps;
+    return aligned_alloc(align, (size + align - 1) / align * align);
+}
+static inline void heap_caps_free(void *p) { free(p); }
+''',
+    'esp_timer.h': '''#pragma once
+#include <stdint.h>
+int64_t esp_timer_get_time(void);
+''',
+    # 目标板上 portMUX 为自旋锁 + 关中断，这里用原子标志代替
+    'freertos/FreeRTOS.h': '''#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint32_t EventBits_t;
+typedef struct host_task *TaskHandle_t;
+typedef struct host_mutex *SemaphoreHandle_t;
+typedef struct host_events *EventGroupHandle_t;
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY 0xffffffffu
+#define portNUM_PROCESSORS 2
+#define portTICK_PERIOD_MS 1
+#define configMAX_TASK_NAME_LEN 16
+#define pdMS_TO_TICKS(x) (x)
+typedef struct { volatile int owner; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portMUX_INITIALIZE(m) ((m)->owner = 0)
+#define portENTER_CRITICAL(m) do { while (__atomic_exchange_n(&(m)->owner, 1, __ATOMIC_ACQUIRE)) {} } while (0)
+#define portEXIT_CRITICAL(m) __atomic_store_n(&(m)->owner, 0, __ATOMIC_RELEASE)
+#define portENTER_CRITICAL_ISR(m) portENTER_CRITICAL(m)
+#define portEXIT_CRITICAL_ISR(m) portEXIT_CRITICAL(m)
+BaseType_t xPortGetCoreID(void);
+static inline BaseType_t xPortInIsrContext(void) { return 0; }
+''',
+    'freertos/task.h': '''#pragma once
+#include "FreeRTOS.h"
+typedef struct { TaskHandle_t xHandle; const char *pcTaskName; } TaskStatus_t;
+BaseType_t xTaskCreatePinnedToCore(void (*fn)(void *), const char *name, uint32_t stack, void *arg,
+                                   UBaseType_t prio, TaskHandle_t *out, BaseType_t core);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount(void);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+UBaseType_t uxTaskGetNumberOfTasks(void);
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *tasks, UBaseType_t size, uint32_t *total);
+''',
+    'freertos/semphr.h': '''#pragma once
+#include "FreeRTOS.h"
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+void vSemaphoreDelete(SemaphoreHandle_t m);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t m, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t m);
+''',
+    'freertos/event_groups.h': '''#pragma once
+#include "FreeRTOS.h"
+EventGroupHandle_t xEventGroupCreate(void);
+EventBits_t xEventGroupSetBits(EventGroupHandle_t g, EventBits_t bits);
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t g, EventBits_t bits, BaseType_t clear, BaseType_t all,
+                                TickType_t ticks);
+''',
+}
+
+SHIM_C = r'''
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+int host_verbose;
+void host_log(const char *level, const char *tag, const char *fmt, ...) {
+    if (!host_verbose) return;
+    va_list ap;
+    va_start(ap, fmt);
+    printf("    %s (%s) ", level, tag);
+    vprintf(fmt, ap);
+    printf("\n");
+    va_end(ap);
+}
+
+int64_t esp_timer_get_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void deadline(struct timespec *ts, TickType_t ms) {
+    clock_gettime(CLOCK_REALTIME, ts);
+    ts->tv_sec += ms / 1000;
+    ts->tv_nsec += (long)(ms % 1000) * 1000000;
+    if (ts->tv_nsec >= 1000000000) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000;
+    }
+}
+
+// ---- 任务: 每个任务一个线程，句柄登记在全局表中供 uxTaskGetSystemState 枚举 ----
+struct host_task {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t notify;
+    int core;
+    char name[configMAX_TASK_NAME_LEN];
+    void (*fn)(void *);
+    void *arg;
+};
+#define HOST_MAX_TASKS 64
+static struct host_task *s_tasks[HOST_MAX_TASKS];
+static int s_task_count;
+static pthread_mutex_t s_tasks_lock = PTHREAD_MUTEX_INITIALIZER;
+static __thread struct host_task *t_self;
+static volatile int s_live_tasks;
+
+static struct host_task *task_new(const char *name, int core) {
+    struct host_task *t = calloc(1, sizeof(*t));
+    pthread_mutex_init(&t->lock, NULL);
+    pthread_cond_init(&t->cond, NULL);
+    t->core = core;
+    snprintf(t->name, sizeof(t->name), "%s", name ? name : "");
+    pthread_mutex_lock(&s_tasks_lock);
+    if (s_task_count < HOST_MAX_TASKS) s_tasks[s_task_count++] = t;
+    pthread_mutex_unlock(&s_tasks_lock);
+    return t;
+}
+
+// 把当前线程登记为指定核上的任务 (主线程或脚本自建的线程)，返回句柄
+TaskHandle_t host_task_bind(int core, const char *name) {
+    if (t_self == NULL) {
+        t_self = task_new(name, core);
+    } else {
+        t_self->core = core;
+        snprintf(t_self->name, sizeof(t_self->name), "%s", name ? name : "");
+    }
+    return t_self;
+}
+int host_live_tasks(void) { return __atomic_load_n(&s_live_tasks, __ATOMIC_SEQ_CST); }
+
+static void *task_entry(void *p) {
+    t_self = p;
+    t_self->fn(t_self->arg);
+    return NULL;
+}
+BaseType_t xTaskCreatePinnedToCore(void (*fn)(void *), const char *name, uint32_t stack, void *arg,
+                                   UBaseType_t prio, TaskHandle_t *out, BaseType_t core) {
+    (void)stack;
+    (void)prio;
+    struct host_task *t = task_new(name, core);
+    t->fn = fn;
+    t->arg = arg;
+    if (out) *out = t;
+    __atomic_fetch_add(&s_live_tasks, 1, __ATOMIC_SEQ_CST);
+    pthread_create(&t->thread, NULL, task_entry, t);
+    pthread_detach(t->thread);
+    return pdPASS;
+}
+void vTaskDelete(TaskHandle_t task) {
+    if (task == NULL) {
+        __atomic_fetch_sub(&s_live_tasks, 1, __ATOMIC_SEQ_CST);
+        pthread_exit(NULL);
+    }
+}
+void vTaskDelay(TickType_t ticks) {
+    struct timespec ts = {ticks / 1000, (long)(ticks % 1000) * 1000000};
+    nanosleep(&ts, NULL);
+}
+TickType_t xTaskGetTickCount(void) { return (TickType_t)(esp_timer_get_time() / 1000); }
+BaseType_t xTaskNotifyGive(TaskHandle_t t) {
+    pthread_mutex_lock(&t->lock);
+    t->notify++;
+    pthread_cond_signal(&t->cond);
+    pthread_mutex_unlock(&t->lock);
+    return pdPASS;
+}
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+    struct host_task *t = t_self;
+    struct timespec ts;
+    deadline(&ts, ticks == portMAX_DELAY ? 3600000 : ticks);
+    pthread_mutex_lock(&t->lock);
+    while (t->notify == 0) {
+        if (pthread_cond_timedwait(&t->cond, &t->lock, &ts) == ETIMEDOUT) break;
+    }
+    uint32_t v = t->notify;
+    t->notify = clear ? 0 : (v ? v - 1 : 0);
+    pthread_mutex_unlock(&t->lock);
+    return v;
+}
+TaskHandle_t xTaskGetCurrentTaskHandle(void) { return t_self; }
+BaseType_t xPortGetCoreID(void) { return t_self ? t_self->core : 0; }
+UBaseType_t uxTaskGetNumberOfTasks(void) { return (UBaseType_t)s_task_count; }
+UBaseType_t uxTaskGetSystemState(TaskStatus_t *tasks, UBaseType_t size, uint32_t *total) {
+    (void)total;
+    pthread_mutex_lock(&s_tasks_lock);
+    UBaseType_t n = size < (UBaseType_t)s_task_count ? size : (UBaseType_t)s_task_count;
+    for (UBaseType_t i = 0; i < n; i++) {
+        tasks[i].xHandle = s_tasks[i];
+        tasks[i].pcTaskName = s_tasks[i]->name;
+    }
+    pthread_mutex_unlock(&s_tasks_lock);
+    return n;
+}
+
+// ---- 互斥量 ----
+struct host_mutex { pthread_mutex_t m; };
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    struct host_mutex *m = calloc(1, sizeof(*m));
+    pthread_mutex_init(&m->m, NULL);
+    return m;
+}
+void vSemaphoreDelete(SemaphoreHandle_t m) {
+    pthread_mutex_destroy(&m->m);
+    free(m);
+}
+BaseType_t xSemaphoreTake(SemaphoreHandle_t m, TickType_t ticks) {
+    if (ticks == portMAX_DELAY) return pthread_mutex_lock(&m->m) == 0;
+    struct timespec ts;
+    deadline(&ts, ticks);
+    return pthread_mutex_timedlock(&m->m, &ts) == 0;
+}
+BaseType_t xSemaphoreGive(SemaphoreHandle_t m) { return pthread_mutex_unlock(&m->m) == 0; }
+
+// ---- 事件组 ----
+struct host_events { pthread_mutex_t m; pthread_cond_t c; EventBits_t bits; };
+EventGroupHandle_t xEventGroupCreate(void) {
+    struct host_events *g = calloc(1, sizeof(*g));
+    pthread_mutex_init(&g->m, NULL);
+    pthread_cond_init(&g->c, NULL);
+    return g;
+}
+EventBits_t xEventGroupSetBits(EventGroupHandle_t g, EventBits_t bits) {
+    pthread_mutex_lock(&g->m);
+    g->bits |= bits;
+    EventBits_t v = g->bits;
+    pthread_cond_broadcast(&g->c);
+    pthread_mutex_unlock(&g->m);
+    return v;
+}
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t g, EventBits_t bits, BaseType_t clear, BaseType_t all,
+                                TickType_t ticks) {
+    struct timespec ts;
+    deadline(&ts, ticks == portMAX_DELAY ? 3600000 : ticks);
+    pthread_mutex_lock(&g->m);
+    while (all ? (g->bits & bits) != bits : (g->bits & bits) == 0) {
+        if (pthread_cond_timedwait(&g->c, &g->m, &ts) == ETIMEDOUT) break;
+    }
+    EventBits_t v = g->bits;
+    if (clear && (all ? (v & bits) == bits : (v & bits) != 0)) g->bits &= ~bits;
+    pthread_mutex_unlock(&g->m);
+    return v;
+}
+'''
+
+CFLAGS = ['-O2', '-std=gnu11', '-Wall', '-shared', '-fPIC', '-pthread']
+
+
+def write_files(directory, files):
+    paths = []
+    for name, text in files.items():
+        path = os.path.join(directory, name)
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        with open(path, 'w') as f:
+            f.write(text)
+        paths.append(path)
+    return paths
+
+
+def compile_so(workdir, name, sources, glue=None, stubs=None, includes=(), cflags=()):
+    """编译共享库并返回路径
+
+    sources: 固件源文件；glue: {文件名: C 源码}，与桩一起写入 workdir；
+    stubs: 额外或覆盖的桩头文件；includes: 固件头文件目录。
+    """
+    stub_dir = os.path.join(workdir, 'stub')
+    write_files(stub_dir, dict(STUBS, **(stubs or {})))
+    glue_srcs = write_files(workdir, dict({'host_shim.c': SHIM_C}, **(glue or {})))
+    out = os.path.join(workdir, 'lib%s.so' % name)
+    cmd = ['cc'] + CFLAGS + list(cflags) + ['-I', stub_dir]
+    for inc in includes:
+        cmd += ['-I', inc]
+    subprocess.check_call(cmd + list(sources) + glue_srcs + ['-o', out, '-lm'])
+    return out
+
+
+def build_lib(workdir, name, sources, **kwargs):
+    """编译并加载共享库，参数同 compile_so"""
+    return ctypes.CDLL(compile_so(workdir, name, sources, **kwargs))
+
+
+def check(name, ok, detail='', width=34):
+    print('%-*s %s  %s' % (width, name, 'ok' if ok else 'FAIL', detail))
+    return ok
@@ -0,0 +1,182 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+摇杆定点滤波 (components/Peripherals/src/joystick_filter.c) 主机校验
+
+借 host_harness 把固件 joystick_filter.c 编译为共享库，检查:
+  1. IIR 阶跃响应: Q15 系数下逐点与浮点 y += a(x - y) 相差不超过 1 LSB，单调不过冲，
+     上/下阶跃与 1 LSB 小阶跃都能精确收敛到目标 (状态额外的 8 位小数不被截断)；
+     alpha = 0 按 1 处理，alpha = 1.0 直通；
+  2. 过采样平均: 四舍五入，空通道返回 false，满量程 16 倍过采样不溢出；
+  3. 归一化: 未校准按默认中心换算，已校准时死区、满偏、超出校准范围钳位到 ±100，
+     校准范围退化 (max == center) 时直接取满偏；
+  4. 电压换算与校准极值跟踪。
+
+用法:
+  python joystick_filter_bench.py
+"""
+
+import ctypes
+import os
+import sys
+import tempfile
+
+import host_harness
+from host_harness import REPO_PERIPH, check
+
+ADC_MAX, ADC_CENTER, DEAD_ZONE = 4095, 2048, 50
+ALPHA = 0.25  # JOYSTICK_LOW_PASS_ALPHA
+
+# 头文件中的内联函数在共享库里没有符号，经胶水函数导出
+GLUE_C = r'''
+#include "joystick_filter.h"
+
+int host_average(const uint32_t *values, int n, int *avg) {
+    joystick_filter_acc_t acc;
+    joystick_filter_acc_reset(&acc);
+    for (int i = 0; i < n; i++) joystick_filter_acc_add(&acc, values[i]);
+    return joystick_filter_acc_average(&acc, avg);
+}
+
+// 从 initial 开始连续输入 n 个 sample，逐点写出滤波结果
+void host_step(uint16_t alpha_q15, int initial, int sample, int n, int *out) {
+    joystick_filter_iir_t iir;
+    joystick_filter_iir_init(&iir, alpha_q15, initial);
+    for (int i = 0; i < n; i++) out[i] = joystick_filter_iir_update(&iir, sample);
+}
+
+int host_normalize(int value, int min, int max, int center, int calibrated) {
+    const joystick_axis_cal_t cal = {.min = min, .max = max, .center = center};
+    return joystick_filter_normalize(value, &cal, calibrated);
+}
+
+int host_raw_to_mv(int raw) { return joystick_filter_raw_to_mv(raw); }
+
+void host_cal_track(const int *values, int n, int *min, int *max) {
+    joystick_axis_cal_t cal = {.min = JOYSTICK_FILTER_ADC_MAX, .max = 0, .center = 0};
+    for (int i = 0; i < n; i++) joystick_filter_cal_track(&cal, values[i]);
+    *min = cal.min;
+    *max = cal.max;
+}
+'''
+
+
+def alpha_q15(a):
+    return int(a * (1 << 15) + 0.5)
+
+
+def build_lib(workdir):
+    lib = host_harness.build_lib(workdir, 'joystick_filter', [os.path.join(REPO_PERIPH, 'src', 'joystick_filter.c')],
+                                 glue={'glue.c': GLUE_C}, includes=[os.path.join(REPO_PERIPH, 'inc')])
+    lib.host_step.argtypes = [ctypes.c_uint16, ctypes.c_int, ctypes.c_int, ctypes.c_int,
+                              ctypes.POINTER(ctypes.c_int)]
+    return lib
+
+
+def step(lib, alpha, initial, sample, n):
+    out = (ctypes.c_int * n)()
+    lib.host_step(alpha, initial, sample, n, out)
+    return list(out)
+
+
+def average(lib, values):
+    arr = (ctypes.c_uint32 * max(len(values), 1))(*values)
+    avg = ctypes.c_int(-1)
+    ok = lib.host_average(arr, len(values), ctypes.byref(avg))
+    return avg.value if ok else None
+
+
+def norm(lib, value, cal=None):
+    lo, hi, center = cal if cal else (0, 0, 0)
+    return lib.host_normalize(value, lo, hi, center, 1 if cal else 0)
+
+
+def test_iir(lib):
+    q = alpha_q15(ALPHA)
+    ok = check('iir: alpha Q15', q == 8192, '%d' % q)
+
+    # 上阶跃: 与浮点模型逐点比较
+    n = 80
+    got = step(lib, q, ADC_CENTER, ADC_MAX, n)
+    ref, y = [], float(ADC_CENTER)
+    for _ in range(n):
+        y += ALPHA * (ADC_MAX - y)
+        ref.append(y)
+    err = max(abs(g - r) for g, r in zip(got, ref))
+    ok &= check('iir: step up tracks float model', err <= 1.0, 'max error %.2f LSB' % err)
+    ok &= check('iir: step up monotonic, no overshoot',
+                all(a <= b for a, b in zip(got, got[1:])) and max(got) <= ADC_MAX)
+    settle = next(i for i, v in enumerate(got) if v == ADC_MAX) + 1
+    ok &= check('iir: step up settles exactly', got[-1] == ADC_MAX and settle < 40, '%d frames' % settle)
+
+    # 下阶跃到 0 (负差值的算术右移)
+    got = step(lib, q, ADC_MAX, 0, n)
+    ok &= check('iir: step down settles exactly', got[-1] == 0 and
+                all(a >= b for a, b in zip(got, got[1:])) and min(got) >= 0, 'last %d' % got[-1])
+
+    # 1 LSB 小阶跃不因截断停滞
+    got = step(lib, q, 1000, 1001, 20)
+    ok &= check('iir: 1 LSB step reached', got[-1] == 1001, '%r' % got[:4])
+    got = step(lib, q, 1001, 1000, 20)
+    ok &= check('iir: -1 LSB step reached', got[-1] == 1000, '%r' % got[:4])
+
+    got = step(lib, 0, ADC_CENTER, ADC_MAX, 200)
+    ok &= check('iir: alpha 0 treated as 1/32768', ADC_CENTER < got[-1] < ADC_MAX, 'after 200 frames %d' % got[-1])
+    got = step(lib, 1 << 15, ADC_CENTER, 123, 1)
+    ok &= check('iir: alpha 1.0 passes through', got == [123], '%r' % got)
+    return ok
+
+
+def test_average(lib):
+    ok = check('avg: rounding', average(lib, [1, 2]) == 2 and average(lib, [1, 1, 2]) == 1 and
+               average(lib, [100, 101, 101, 100]) == 101, '%r' % [average(lib, [1, 2]), average(lib, [1, 1, 2])])
+    ok &= check('avg: empty channel', average(lib, []) is None)
+    ok &= check('avg: 16x full scale', average(lib, [ADC_MAX] * 16) == ADC_MAX)
+    ok &= check('avg: large frame no overflow', average(lib, [ADC_MAX] * 100000) == ADC_MAX)
+    return ok
+
+
+def test_normalize(lib):
+    ends = [norm(lib, v) for v in (0, ADC_CENTER, ADC_MAX)]
+    ok = check('norm: uncalibrated', ends == [-100, 0, 99], '%r' % ends)
+
+    cal = (300, 3800, 2000)
+    dz = [norm(lib, v, cal) for v in (2000 - DEAD_ZONE + 1, 2000, 2000 + DEAD_ZONE - 1)]
+    ok &= check('norm: dead zone', dz == [0, 0, 0], '%r' % dz)
+    edge = [norm(lib, v, cal) for v in (2000 - DEAD_ZONE, 2000 + DEAD_ZONE)]
+    ok &= check('norm: dead zone edge', edge == [-(DEAD_ZONE * 100 // 1700), DEAD_ZONE * 100 // 1800], '%r' % edge)
+    full = [norm(lib, v, cal) for v in (300, 3800, 1150, 2900)]
+    ok &= check('norm: full and half deflection', full == [-100, 100, -50, 50], '%r' % full)
+    clamp = [norm(lib, v, cal) for v in (0, 4095)]
+    ok &= check('norm: clamped beyond calibration', clamp == [-100, 100], '%r' % clamp)
+    degen = [norm(lib, v, (2000, 2000, 2000)) for v in (1000, 3000)]
+    ok &= check('norm: degenerate span', degen == [-100, 100], '%r' % degen)
+    sweep = [norm(lib, v, cal) for v in range(0, ADC_MAX + 1)]
+    ok &= check('norm: sweep monotonic within range', all(a <= b for a, b in zip(sweep, sweep[1:])) and
+                min(sweep) == -100 and max(sweep) == 100)
+    return ok
+
+
+def test_misc(lib):
+    mv = [lib.host_raw_to_mv(v) for v in (0, ADC_CENTER, ADC_MAX)]
+    ok = check('raw to mV', mv == [0, 1650, 3300], '%r' % mv)
+    values = (ctypes.c_int * 5)(2048, 310, 3790, 2100, 1999)
+    lo, hi = ctypes.c_int(), ctypes.c_int()
+    lib.host_cal_track(values, 5, ctypes.byref(lo), ctypes.byref(hi))
+    ok &= check('cal track min/max', (lo.value, hi.value) == (310, 3790), '%d..%d' % (lo.value, hi.value))
+    return ok
+
+
+def main():
+    with tempfile.TemporaryDirectory() as workdir:
+        lib = build_lib(workdir)
+        ok = test_iir(lib)
+        ok &= test_average(lib)
+        ok &= test_normalize(lib)
+        ok &= test_misc(lib)
+    print('PASS' if ok else 'FAIL')
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,163 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+LSM6DS3 FIFO 解码 (components/Peripherals/src/lsm6ds3_fifo.c) 主机校验
+
+借 host_harness 把固件 lsm6ds3_fifo.c 编译为共享库，用一段 FIFO 读出 (FIFO_STATUS1..4 + DATA_OUT 突发) 检查:
+  1. 状态: DIFF_FIFO、FIFO_PATTERN、水位/溢出/满/空位的解析；
+  2. 突发长度: 先补齐不完整样本的剩余字，再取整样本，受 max_samples 限制；
+     尚未写满的不完整样本、EMPTY 位均返回 0，溢出时仍按 DIFF_FIFO 读取；
+  3. 解码: 非零起始模式位置跳过前导字，末尾不完整样本被忽略，结果与 Python 参考解码逐值一致；
+  4. 各起始位置 (0..5) 下同一组样本都能对齐解出；
+  5. ODR 寄存器值到频率的换算。
+
+用法:
+  python lsm6ds3_fifo_bench.py
+"""
+
+import ctypes
+import os
+import struct
+import sys
+import tempfile
+
+import host_harness
+from host_harness import REPO_PERIPH, check
+
+# 一次 FIFO 读出的原始字节 (数值为静止平放、±2 g / ±250 dps 的量级)，按寄存器顺序: FIFO_STATUS1..4，
+# 随后为 FIFO_DATA_OUT 突发。
+# 读取时模式位置为 3 (上一样本只剩 Ax Ay Az)，之后 8 个完整样本，末尾 2 个字属于尚未写满的下一样本。
+DUMP_STATUS = bytes.fromhex('35800300')
+DUMP_DATA = bytes.fromhex(
+    '23003800e33ff2ff0f0024003100b4ffa83f1500ddff2700'
+    '2600d1ff2a400e00f7ff0c00d9ff57006340dbfff4ffeaff'
+    'c7ffddff2040150009000600e4ff3b008f3fdbfffdff1d00'
+    '2f00c5ff0a40ddffd8ff13003f004e001740000000000e00'
+    '14005700bb3fdffff8ff')
+
+WORDS_PER_SAMPLE = 6
+
+
+class Status(ctypes.Structure):
+    _fields_ = [('unread_words', ctypes.c_uint16), ('pattern', ctypes.c_uint16), ('watermark', ctypes.c_bool),
+                ('overrun', ctypes.c_bool), ('full', ctypes.c_bool), ('empty', ctypes.c_bool)]
+
+
+class RawSample(ctypes.Structure):
+    _fields_ = [('gyro', ctypes.c_int16 * 3), ('accel', ctypes.c_int16 * 3)]
+
+
+def build_lib(workdir):
+    lib = host_harness.build_lib(workdir, 'lsm6ds3_fifo', [os.path.join(REPO_PERIPH, 'src', 'lsm6ds3_fifo.c')],
+                                 includes=[os.path.join(REPO_PERIPH, 'inc')])
+    lib.lsm6ds3_fifo_parse_status.argtypes = [ctypes.c_char_p, ctypes.POINTER(Status)]
+    lib.lsm6ds3_fifo_burst_len.restype = ctypes.c_size_t
+    lib.lsm6ds3_fifo_burst_len.argtypes = [ctypes.POINTER(Status), ctypes.c_size_t]
+    lib.lsm6ds3_fifo_decode.restype = ctypes.c_size_t
+    lib.lsm6ds3_fifo_decode.argtypes = [ctypes.c_char_p, ctypes.c_size_t, ctypes.c_uint16,
+                                        ctypes.POINTER(RawSample), ctypes.c_size_t]
+    lib.lsm6ds3_fifo_odr_to_hz.restype = ctypes.c_float
+    lib.lsm6ds3_fifo_odr_to_hz.argtypes = [ctypes.c_uint8]
+    return lib
+
+
+def parse(lib, regs):
+    s = Status()
+    lib.lsm6ds3_fifo_parse_status(bytes(regs), ctypes.byref(s))
+    return s
+
+
+def status(unread, pattern, empty=False):
+    s = Status()
+    s.unread_words, s.pattern, s.empty = unread, pattern, empty
+    return s
+
+
+def decode(lib, data, pattern, cap=64):
+    out = (RawSample * cap)()
+    n = lib.lsm6ds3_fifo_decode(data, len(data), pattern, out, cap)
+    return [(tuple(r.gyro), tuple(r.accel)) for r in out[:n]]
+
+
+def reference(data, pattern):
+    """按数据手册的字序逐字解码: 跳过不完整样本的剩余字，再按 Gx Gy Gz Ax Ay Az 成组"""
+    words = struct.unpack('<%dh' % (len(data) // 2), data[:len(data) // 2 * 2])
+    skip = (WORDS_PER_SAMPLE - pattern % WORDS_PER_SAMPLE) % WORDS_PER_SAMPLE
+    words = words[skip:]
+    full = len(words) // WORDS_PER_SAMPLE
+    return [(tuple(words[i * 6:i * 6 + 3]), tuple(words[i * 6 + 3:i * 6 + 6])) for i in range(full)]
+
+
+def test_status(lib):
+    s = parse(lib, DUMP_STATUS)
+    ok = check('status: dump', (s.unread_words, s.pattern, s.watermark, s.overrun, s.full, s.empty) ==
+               (53, 3, True, False, False, False), 'diff %d pattern %d' % (s.unread_words, s.pattern))
+    s = parse(lib, [0xFF, 0x6F, 0x05, 0x02])   # 溢出 + 满，DIFF = 0xFFF，模式位置跨到 STATUS4
+    ok &= check('status: overrun/full bits', (s.unread_words, s.pattern, s.overrun, s.full, s.watermark) ==
+                (0xFFF, 0x205, True, True, False), 'diff %#x pattern %#x' % (s.unread_words, s.pattern))
+    s = parse(lib, [0x00, 0x10, 0x00, 0x00])
+    ok &= check('status: empty bit', s.empty and s.unread_words == 0)
+    return ok
+
+
+def test_burst_len(lib):
+    s = parse(lib, DUMP_STATUS)
+    n = lib.lsm6ds3_fifo_burst_len(ctypes.byref(s), 64)
+    ok = check('burst: skip + whole samples', n == (3 + 8 * 6) * 2, '%d bytes (trailing 2 words left)' % n)
+    n = lib.lsm6ds3_fifo_burst_len(ctypes.byref(s), 5)
+    ok &= check('burst: max_samples cap', n == (3 + 5 * 6) * 2, '%d bytes' % n)
+    s = parse(lib, [0xFF, 0x6F, 0x00, 0x00])
+    n = lib.lsm6ds3_fifo_burst_len(ctypes.byref(s), 64)
+    ok &= check('burst: overrun still drained', n == 64 * 6 * 2, '%d bytes' % n)
+    s = status(40, 0, empty=True)
+    ok &= check('burst: empty bit wins over diff', lib.lsm6ds3_fifo_burst_len(ctypes.byref(s), 64) == 0)
+    s = status(2, 3)
+    ok &= check('burst: partial sample not ready', lib.lsm6ds3_fifo_burst_len(ctypes.byref(s), 64) == 0)
+    s = status(3, 3)
+    n = lib.lsm6ds3_fifo_burst_len(ctypes.byref(s), 64)
+    ok &= check('burst: skip only realigns', n == 3 * 2, '%d bytes' % n)
+    return ok
+
+
+def test_decode(lib):
+    s = parse(lib, DUMP_STATUS)
+    burst = DUMP_DATA[:lib.lsm6ds3_fifo_burst_len(ctypes.byref(s), 64)]
+    got = decode(lib, burst, s.pattern)
+    ok = check('decode: dump', got == reference(burst, s.pattern) and len(got) == 8, '%d samples' % len(got))
+    ok &= check('decode: first sample', got[:1] == [((-14, 15, 36), (49, -76, 16296))], repr(got[:1]))
+    ok &= check('decode: trailing partial ignored', decode(lib, DUMP_DATA, s.pattern) == got and
+                len(decode(lib, burst[:-1], s.pattern)) == 7)
+    ok &= check('decode: output capacity', decode(lib, burst, s.pattern, cap=3) == got[:3])
+    ok &= check('decode: short/NULL input', decode(lib, burst[:6], s.pattern) == [] and
+                lib.lsm6ds3_fifo_decode(None, 12, 0, (RawSample * 1)(), 1) == 0)
+
+    # 同一组样本前面接上一样本的剩余字，读取起点落在模式中的任一位置都应对齐解出
+    words = struct.unpack('<%dh' % (len(DUMP_DATA) // 2), DUMP_DATA)[3:3 + 8 * 6]
+    bad = []
+    for pattern in range(WORDS_PER_SAMPLE):
+        lead = (0x7FFF,) * ((WORDS_PER_SAMPLE - pattern) % WORDS_PER_SAMPLE)
+        stream = struct.pack('<%dh' % (len(lead) + len(words)), *(lead + words))
+        if decode(lib, stream, pattern) != got:
+            bad.append(pattern)
+    ok &= check('decode: every start pattern', not bad, 'bad %r' % bad if bad else 'patterns 0..5')
+    return ok
+
+
+def test_odr(lib):
+    hz = [round(lib.lsm6ds3_fifo_odr_to_hz(v), 1) for v in (0x00, 0x10, 0x40, 0x44, 0xA0, 0xB0)]
+    return check('odr to hz', hz == [0.0, 12.5, 104.0, 104.0, 6660.0, 0.0], repr(hz))
+
+
+def main():
+    with tempfile.TemporaryDirectory() as workdir:
+        lib = build_lib(workdir)
+        ok = test_status(lib)
+        ok &= test_burst_len(lib)
+        ok &= test_decode(lib)
+        ok &= test_odr(lib)
+    print('PASS' if ok else 'FAIL')
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+LVGL 逐帧渲染分析客户端 (main/app/lv_profiler.c 的 CSV 数据流)
+
+连接设备的分析端口 (默认 7560)，把收到的记录原样保存为 CSV，结束时 (Ctrl+C 或 --seconds 到时)
+按页面汇总帧数、FPS、render/flush/other 的 p50/p95/max 与平均重绘面积，并列出最慢的控件。
+也可用 --replay 对已保存的 CSV 重新汇总。
+
+用法:
+  python lv_profiler_client.py 192.168.1.100 -o frames.csv
+  python lv_profiler_client.py 192.168.1.100 --seconds 30
+  python lv_profiler_client.py --replay frames.csv
+"""
+
+import argparse
+import socket
+import sys
+import time
+
+FRAME_FIELDS = ['frame', 't_ms', 'screen', 'handler_us', 'render_us', 'flush_us', 'xfer_us', 'other_us', 'px', 'areas']
+WIDGET_FIELDS = ['screen', 'class', 'obj', 'draws', 'avg_us', 'max_us']
+SCREEN_PX = 240 * 320
+
+
+class ProfileSummary:
+    def __init__(self):
+        self.frames = {}   # screen -> [frame dict]
+        self.widgets = {}  # (screen, obj) -> 最新的 W 记录
+        self.dropped = 0
+
+    def feed(self, line):
+        line = line.strip()
+        if not line:
+            return
+        if line.startswith('#'):
+            if line.startswith('# dropped'):
+                self.dropped = int(line.split()[-1])
+            return
+        parts = line.split(',')
+        if parts[0] == 'F' and len(parts) == len(FRAME_FIELDS) + 1:
+            rec = dict(zip(FRAME_FIELDS, parts[1:]))
+            for k in FRAME_FIELDS:
+                if k != 'screen':
+                    rec[k] = int(rec[k])
+            self.frames.setdefault(rec['screen'], []).append(rec)
+        elif parts[0] == 'W' and len(parts) == len(WIDGET_FIELDS) + 1:
+            rec = dict(zip(WIDGET_FIELDS, parts[1:]))
+            for k in ('draws', 'avg_us', 'max_us'):
+                rec[k] = int(rec[k])
+            self.widgets[(rec['screen'], rec['obj'])] = rec
+
+    @staticmethod
+    def percentile(values, p):
+        values = sorted(values)
+        if not values:
+            return 0
+        return values[min(len(values) - 1, int(len(values) * p / 100.0))]
+
+    def report(self):
+        print('%-12s %6s %5s %17s %17s %17s %6s' % ('screen', 'frames', 'fps', 'render p50/p95/max',
+                                                   'flush p50/p95/max', 'other p50/p95/max', 'area%'))
+        for screen, frames in sorted(self.frames.items(), key=lambda kv: -len(kv[1])):
+            span = (frames[-1]['t_ms'] - frames[0]['t_ms']) / 1000.0
+            fps = (len(frames) - 1) / span if span > 0 else 0.0
+
+            def col(key):
+                vals = [f[key] for f in frames]
+                return '%5.1f/%5.1f/%5.1f' % (self.percentile(vals, 50) / 1000.0,
+                                              self.percentile(vals, 95) / 1000.0, max(vals) / 1000.0)
+
+            area = 100.0 * sum(f['px'] for f in frames) / (SCREEN_PX * len(frames))
+            print('%-12s %6d %5.1f %17s %17s %17s %5.1f%%'
+                  % (screen, len(frames), fps, col('render_us'), col('flush_us'), col('other_us'), area))
+
+        if self.widgets:
+            print('\nslowest widgets (ms):')
+            print('  %-12s %-8s %-10s %7s %7s %7s' % ('screen', 'class', 'obj', 'draws', 'avg', 'max'))
+            for w in sorted(self.widgets.values(), key=lambda w: -w['max_us'])[:10]:
+                print('  %-12s %-8s %-10s %7d %7.2f %7.2f' % (w['screen'], w['class'], w['obj'], w['draws'],
+                                                             w['avg_us'] / 1000.0, w['max_us'] / 1000.0))
+        if self.dropped:
+            print('\n%d records dropped on device (client too slow)' % self.dropped)
+
+
+def capture(host, port, out_path, seconds, summary):
+    sock = socket.create_connection((host, port), timeout=5)
+    sock.settimeout(1.0)
+    print('connected to %s:%d, Ctrl+C to stop' % (host, port))
+    out = open(out_path, 'w') if out_path else None
+    pending = ''
+    t_end = time.time() + seconds if seconds else None
+    try:
+        while t_end is None or time.time() < t_end:
+            try:
+                data = sock.recv(4096)
+            except socket.timeout:
+                continue
+            if not data:
+                print('connection closed by device')
+                break
+            pending += data.decode('ascii', errors='replace')
+            lines = pending.split('\n')
+            pending = lines.pop()
+            for line in lines:
+                summary.feed(line)
+                if out:
+                    out.write(line + '\n')
+    except KeyboardInterrupt:
+        pass
+    finally:
+        sock.close()
+        if out:
+            out.close()
+            print('saved to %s' % out_path)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='LVGL 逐帧渲染分析客户端')
+    parser.add_argument('host', nargs='?', help='设备 IP')
+    parser.add_argument('--port', type=int, default=7560, help='分析数据流端口 (LV_PROFILER_STREAM_PORT)')
+    parser.add_argument('-o', '--output', help='保存原始 CSV 的文件')
+    parser.add_argument('--seconds', type=float, default=0, help='采集时长，0 为直到 Ctrl+C')
+    parser.add_argument('--replay', help='汇总已保存的 CSV 而不连接设备')
+    args = parser.parse_args()
+
+    summary = ProfileSummary()
+    if args.replay:
+        with open(args.replay) as f:
+            for line in f:
+                summary.feed(line)
+    elif args.host:
+        capture(args.host, args.port, args.output, args.seconds, summary)
+    else:
+        parser.error('需要设备 IP 或 --replay')
+    summary.report()
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
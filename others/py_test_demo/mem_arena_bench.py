@@ -0,0 +1,266 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+子系统内存区 (components/Peripherals/src/mem_arena.c) 主机校验与微基准
+
+借 host_harness 把固件 mem_arena.c 与 metrics.c 编译为共享库，检查:
+  1. 线性区: 对齐、写满后失败计数、reset/rewind 后高水位保留；
+  2. 定长块池: 块互不重叠且对齐，池空失败计数，非本池指针拒绝归还，归还后复用；
+  3. 并发: 多线程反复申请/归还同一个池，块不会被两个线程同时持有，结束后 used 归零；
+  4. 指标: 每个区导出 capacity/used/high_water/failures 四项，带 arena 标签；
+  5. 基准: 线性区与块池对比 malloc/free 的单次耗时 (主机)。
+
+用法:
+  python mem_arena_bench.py
+"""
+
+import ctypes
+import os
+import re
+import sys
+import tempfile
+
+import host_harness
+from host_harness import REPO_PERIPH, check
+
+GLUE_C = r'''
+#include "esp_heap_caps.h"
+#include "mem_arena.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static mem_arena_t s_arena;
+static mem_pool_t s_pool;
+static mem_pool_t s_other;
+
+int host_setup(void) {
+    int err = 0;
+    err |= mem_arena_init(&s_arena, "scratch", 1000, MALLOC_CAP_INTERNAL);
+    err |= mem_pool_init(&s_pool, "frames", 100, 8, MALLOC_CAP_SPIRAM);
+    err |= mem_pool_init(&s_other, "other", 64, 2, MALLOC_CAP_SPIRAM);
+    err |= mem_arena_init(&s_arena, "scratch", 1000, MALLOC_CAP_INTERNAL) != ESP_ERR_INVALID_STATE;
+    return err;
+}
+
+// 返回各检查项的位掩码，全部通过为 0
+int host_bump(uint32_t *high_water, uint32_t *failures) {
+    int bad = 0;
+    if (s_arena.info.capacity != 1008) bad |= 1;                 // 向上取整到 16
+    uint8_t *a = mem_arena_alloc(&s_arena, 3, 1);
+    uint8_t *b = mem_arena_alloc(&s_arena, 8, 16);
+    if (!a || !b || ((uintptr_t)b & 15) || b - a != 16) bad |= 2;
+    uint32_t mark = mem_arena_mark(&s_arena);
+    uint8_t *c = mem_arena_calloc(&s_arena, 900, 0);
+    if (!c || c[0] != 0 || c[899] != 0) bad |= 4;
+    if (mem_arena_alloc(&s_arena, 200, 0) != NULL) bad |= 8;       // 超出容量
+    mem_arena_rewind(&s_arena, mark);
+    if (s_arena.info.used != mark || mem_arena_alloc(&s_arena, 200, 0) == NULL) bad |= 16;
+    mem_arena_reset(&s_arena);
+    if (s_arena.info.used != 0) bad |= 32;
+    if (mem_arena_alloc(&s_arena, 2000, 0) != NULL) bad |= 64;
+    *high_water = s_arena.info.high_water;
+    *failures = s_arena.info.failures;
+    return bad;
+}
+
+int host_pool(uint32_t *failures, uint32_t *high_water) {
+    int bad = 0;
+    void *blocks[8];
+    if (mem_pool_block_size(&s_pool) != 112) bad |= 1;
+    for (int i = 0; i < 8; i++) {
+        blocks[i] = mem_pool_alloc(&s_pool);
+        if (!blocks[i] || ((uintptr_t)blocks[i] & 15)) bad |= 2;
+        memset(blocks[i], i, 112);
+    }
+    for (int i = 0; i < 8; i++) {
+        for (int j = 0; j < 112; j++) {
+            if (((uint8_t *)blocks[i])[j] != i) bad |= 4;      // 块不重叠
+        }
+    }
+    if (mem_pool_alloc(&s_pool) != NULL) bad |= 8;              // 池空
+    void *foreign = mem_pool_alloc(&s_other);
+    if (mem_pool_free(&s_pool, foreign)) bad |= 16;             // 非本池
+    if (mem_pool_free(&s_pool, (uint8_t *)blocks[1] + 4)) bad |= 32; // 非块起始
+    if (!mem_pool_free(&s_other, foreign)) bad |= 64;
+    for (int i = 0; i < 8; i++) {
+        if (!mem_pool_free(&s_pool, blocks[i])) bad |= 128;
+    }
+    if (s_pool.info.used != 0) bad |= 256;
+    void *again = mem_pool_alloc(&s_pool);
+    if (again != blocks[7]) bad |= 512;                          // 后进先出复用
+    mem_pool_free(&s_pool, again);
+    *failures = s_pool.info.failures;
+    *high_water = s_pool.info.high_water;
+    return bad;
+}
+
+static volatile int s_conflicts;
+static void *worker(void *p) {
+    int n = *(int *)p;
+    uint32_t tag = (uint32_t)(uintptr_t)pthread_self();
+    for (int i = 0; i < n; i++) {
+        uint32_t *block = mem_pool_alloc(&s_pool);
+        if (!block) {
+            continue;
+        }
+        block[1] = tag;
+        for (volatile int k = 0; k < 20; k++) {
+        }
+        if (block[1] != tag) {
+            __atomic_fetch_add(&s_conflicts, 1, __ATOMIC_RELAXED);
+        }
+        mem_pool_free(&s_pool, block);
+    }
+    return NULL;
+}
+int host_concurrent(int threads, int per_thread, uint32_t *used) {
+    pthread_t th[8];
+    for (int i = 0; i < threads; i++) pthread_create(&th[i], NULL, worker, &per_thread);
+    for (int i = 0; i < threads; i++) pthread_join(th[i], NULL);
+    *used = s_pool.info.used;
+    return s_conflicts;
+}
+
+static char *s_text;
+static size_t s_text_len;
+static int mem_write(void *ctx, const char *data, size_t len) {
+    (void)ctx;
+    s_text = realloc(s_text, s_text_len + len + 1);
+    memcpy(s_text + s_text_len, data, len);
+    s_text_len += len;
+    s_text[s_text_len] = 0;
+    return (int)len;
+}
+const char *host_export(void) {
+    free(s_text);
+    s_text = NULL;
+    s_text_len = 0;
+    return metrics_write_text(mem_write, NULL) == ESP_OK ? s_text : NULL;
+}
+
+size_t host_list(char *names, size_t len) {
+    mem_arena_stats_t stats[8];
+    size_t n = mem_arena_get_all(stats, 8);
+    names[0] = 0;
+    for (size_t i = 0; i < n; i++) {
+        strncat(names, stats[i].name, len - strlen(names) - 2);
+        strcat(names, ",");
+    }
+    return n;
+}
+
+static double elapsed_ns(struct timespec t0, struct timespec t1, int loops) {
+    return ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / loops;
+}
+double host_bench(int kind, int loops) {
+    struct timespec t0, t1;
+    void *volatile sink;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < loops; i++) {
+        switch (kind) {
+        case 0: // 每帧两个小结构: 线性区
+            sink = mem_arena_calloc(&s_arena, 64, 0);
+            sink = mem_arena_calloc(&s_arena, 48, 0);
+            mem_arena_reset(&s_arena);
+            break;
+        case 1: // 同上: calloc/free
+            sink = calloc(1, 64);
+            free(sink);
+            sink = calloc(1, 48);
+            free(sink);
+            break;
+        case 2: // 帧缓冲: 块池
+            sink = mem_pool_alloc(&s_pool);
+            mem_pool_free(&s_pool, sink);
+            break;
+        default: // 帧缓冲: 对齐分配 (与 jpeg_calloc_align 相同量级)
+            sink = aligned_alloc(16, 153600);
+            free(sink);
+            break;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    (void)sink;
+    return elapsed_ns(t0, t1, loops);
+}
+'''
+
+
+def build_lib(workdir):
+    lib = host_harness.build_lib(workdir, 'mem_arena', [os.path.join(REPO_PERIPH, 'src', 'mem_arena.c'),
+                                                        os.path.join(REPO_PERIPH, 'src', 'metrics.c')],
+                                 glue={'glue.c': GLUE_C}, includes=[os.path.join(REPO_PERIPH, 'inc')])
+    lib.host_export.restype = ctypes.c_char_p
+    lib.host_bench.restype = ctypes.c_double
+    lib.host_bench.argtypes = [ctypes.c_int, ctypes.c_int]
+    lib.host_list.restype = ctypes.c_size_t
+    return lib
+
+
+def test_bump(lib):
+    hw, fails = ctypes.c_uint32(), ctypes.c_uint32()
+    bad = lib.host_bump(ctypes.byref(hw), ctypes.byref(fails))
+    ok = check('bump alloc/align/rewind/reset', bad == 0, 'mask 0x%x' % bad)
+    # 3 + 对齐到 16 后 8 字节 = 24，再 900 = 924
+    ok &= check('bump high water kept', hw.value == 924, '%d bytes' % hw.value)
+    ok &= check('bump failures counted', fails.value == 2, '%d' % fails.value)
+    return ok
+
+
+def test_pool(lib):
+    fails, hw = ctypes.c_uint32(), ctypes.c_uint32()
+    bad = lib.host_pool(ctypes.byref(fails), ctypes.byref(hw))
+    ok = check('pool blocks/ownership/reuse', bad == 0, 'mask 0x%x' % bad)
+    ok &= check('pool failures counted', fails.value == 1, '%d' % fails.value)
+    ok &= check('pool high water', hw.value == 8 * 112, '%d bytes' % hw.value)
+    return ok
+
+
+def test_concurrent(lib):
+    used = ctypes.c_uint32()
+    conflicts = lib.host_concurrent(4, 200000, ctypes.byref(used))
+    ok = check('concurrent pool no double owner', conflicts == 0, '%d conflicts' % conflicts)
+    ok &= check('concurrent pool drained', used.value == 0, 'used %d' % used.value)
+    return ok
+
+
+def test_metrics(lib):
+    text = lib.host_export().decode()
+    names = ctypes.create_string_buffer(256)
+    n = lib.host_list(names, 256)
+    ok = check('arena list', n == 3 and set(names.value.decode().strip(',').split(',')) ==
+               {'scratch', 'frames', 'other'}, names.value.decode())
+    samples = dict(re.findall(r'^(\S+) (\d+)$', text, re.M))
+    ok &= check('capacity exported', samples.get('mem_arena_capacity_bytes{arena="frames"}') == '896', '')
+    ok &= check('high water exported', samples.get('mem_arena_high_water_bytes{arena="scratch"}') == '924', '')
+    ok &= check('failures exported', samples.get('mem_arena_alloc_failures_total{arena="frames"}') == '1', '')
+    ok &= check('one TYPE per family', text.count('# TYPE mem_arena_used_bytes') == 1, '')
+    return ok
+
+
+def bench(lib):
+    loops = 2000000
+    names = ('bump 2 structs + reset', 'calloc/free 2 structs', 'pool alloc/free', 'aligned_alloc/free 150KB')
+    for kind, name in enumerate(names):
+        print('benchmark: %-30s %.1f ns/op (host)' % (name, lib.host_bench(kind, loops if kind < 3 else loops // 10)))
+
+
+def main():
+    with tempfile.TemporaryDirectory() as workdir:
+        lib = build_lib(workdir)
+        if lib.host_setup() != 0:
+            print('setup failed')
+            return 1
+        ok = test_bump(lib)
+        ok &= test_pool(lib)
+        ok &= test_concurrent(lib)
+        ok &= test_metrics(lib)
+        bench(lib)
+    print('PASS' if ok else 'FAIL')
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,244 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+指标注册表 (components/Peripherals/src/metrics.c) 主机校验与微基准
+
+借 host_harness 把固件 metrics.c 编译为共享库，检查:
+  1. 导出: 计数器/仪表/引用/直方图按 Prometheus 文本格式输出，同名指标成组且只有一组 HELP/TYPE；
+  2. 直方图: 桶为累计值，+Inf 与 _count 一致，_sum 正确；
+  3. 注册: 重复注册不重复导出，非法参数被拒绝；
+  4. 并发: 多线程同时更新同一计数器与直方图，总数不丢；
+  5. 基准: 各类更新的单次耗时 (主机)。目标板上 32 位原子加为几十个时钟周期。
+
+用法:
+  python metrics_bench.py
+  python metrics_bench.py --dump metrics.txt   # 另存一份示例导出
+"""
+
+import argparse
+import ctypes
+import os
+import re
+import sys
+import tempfile
+
+import host_harness
+from host_harness import REPO_PERIPH, check
+
+GLUE_C = r'''
+#include "metrics.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const uint32_t s_bounds[] = {10, 100, 1000};
+static metrics_counter_t s_requests = METRICS_COUNTER_INIT("demo_requests_total", "Requests handled");
+static metrics_gauge_t s_temp = METRICS_GAUGE_INIT("demo_temperature", "Signed gauge");
+static metrics_histogram_t s_latency = METRICS_HISTOGRAM_INIT("demo_latency_us", "Latency", s_bounds);
+static metrics_histogram_t s_latency_b = METRICS_HISTOGRAM_INIT("demo_latency_us", NULL, s_bounds);
+static uint32_t s_field_a = 7, s_field_b = 9;
+static metrics_desc_t s_refs[] = {
+    METRICS_REF_INIT("demo_heap_free_bytes", "Labelled ref gauge", METRICS_TYPE_GAUGE, &s_field_a),
+    METRICS_REF_INIT("demo_heap_free_bytes", NULL, METRICS_TYPE_GAUGE, &s_field_b),
+};
+
+int host_setup(void) {
+    s_latency.desc.labels = "path=\"a\"";
+    s_latency_b.desc.labels = "path=\"b\"";
+    s_refs[0].labels = "heap=\"internal\"";
+    s_refs[1].labels = "heap=\"spiram\"";
+    int err = 0;
+    err |= metrics_register(&s_requests.desc);
+    err |= metrics_register(&s_temp.desc);
+    err |= metrics_register(&s_latency.desc);
+    err |= metrics_register_refs(s_refs, 2);
+    err |= metrics_register(&s_latency_b.desc);
+    err |= metrics_register(&s_requests.desc); // 重复注册
+    return err;
+}
+
+int host_invalid(void) {
+    static metrics_counter_t unnamed = METRICS_COUNTER_INIT("", NULL);
+    static uint32_t many[METRICS_MAX_BUCKETS + 1];
+    static metrics_histogram_t too_many = METRICS_HISTOGRAM_INIT("too_many", NULL, many);
+    int rejected = 0;
+    rejected += metrics_register(&unnamed.desc) == ESP_ERR_INVALID_ARG;
+    rejected += metrics_register(&too_many.desc) == ESP_ERR_INVALID_ARG;
+    rejected += metrics_register(NULL) == ESP_ERR_INVALID_ARG;
+    return rejected;
+}
+
+void host_demo_updates(void) {
+    metrics_counter_add(&s_requests, 41);
+    metrics_counter_inc(&s_requests);
+    metrics_gauge_set(&s_temp, -5);
+    const uint32_t samples[] = {1, 10, 11, 100, 500, 5000};
+    for (unsigned i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+        metrics_histogram_observe(&s_latency, samples[i]);
+    }
+    metrics_histogram_observe(&s_latency_b, 3);
+}
+
+static char* s_text;
+static size_t s_text_len;
+static int mem_write(void* ctx, const char* data, size_t len) {
+    (void)ctx;
+    s_text = realloc(s_text, s_text_len + len + 1);
+    memcpy(s_text + s_text_len, data, len);
+    s_text_len += len;
+    s_text[s_text_len] = 0;
+    return (int)len;
+}
+const char* host_export(void) {
+    free(s_text);
+    s_text = NULL;
+    s_text_len = 0;
+    return metrics_write_text(mem_write, NULL) == ESP_OK ? s_text : NULL;
+}
+
+static metrics_counter_t s_conc = METRICS_COUNTER_INIT("conc_total", NULL);
+static const uint32_t s_conc_bounds[] = {3};
+static metrics_histogram_t s_conc_hist = METRICS_HISTOGRAM_INIT("conc_hist", NULL, s_conc_bounds);
+static void* worker(void* p) {
+    int n = *(int*)p;
+    for (int i = 0; i < n; i++) {
+        metrics_counter_inc(&s_conc);
+        metrics_histogram_observe(&s_conc_hist, (uint32_t)(i & 7));
+    }
+    return NULL;
+}
+void host_concurrent(int threads, int per_thread, uint32_t* counter, uint32_t* hist_count, uint32_t* low_bucket) {
+    pthread_t th[8];
+    for (int i = 0; i < threads; i++) pthread_create(&th[i], NULL, worker, &per_thread);
+    for (int i = 0; i < threads; i++) pthread_join(th[i], NULL);
+    *counter = s_conc.value;
+    *hist_count = s_conc_hist.buckets[0] + s_conc_hist.buckets[1];
+    *low_bucket = s_conc_hist.buckets[0];
+}
+
+static double elapsed_ns(struct timespec t0, struct timespec t1, int loops) {
+    return ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / loops;
+}
+double host_bench(int kind, int loops) {
+    static metrics_counter_t c = METRICS_COUNTER_INIT("bench_total", NULL);
+    static metrics_gauge_t g = METRICS_GAUGE_INIT("bench_gauge", NULL);
+    static const uint32_t bounds[] = {100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000};
+    static metrics_histogram_t h = METRICS_HISTOGRAM_INIT("bench_hist", NULL, bounds);
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < loops; i++) {
+        switch (kind) {
+        case 0: metrics_counter_inc(&c); break;
+        case 1: metrics_gauge_set(&g, i); break;
+        default: metrics_histogram_observe(&h, (uint32_t)(i * 2654435761u) % 60000); break;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return elapsed_ns(t0, t1, loops);
+}
+'''
+
+
+def build_lib(workdir):
+    lib = host_harness.build_lib(workdir, 'metrics', [os.path.join(REPO_PERIPH, 'src', 'metrics.c')],
+                                 glue={'glue.c': GLUE_C}, includes=[os.path.join(REPO_PERIPH, 'inc')])
+    lib.host_export.restype = ctypes.c_char_p
+    lib.host_bench.restype = ctypes.c_double
+    lib.host_bench.argtypes = [ctypes.c_int, ctypes.c_int]
+    lib.metrics_count.restype = ctypes.c_size_t
+    return lib
+
+
+def parse(text):
+    """ 解析为 {(名字, 标签串): 值}，并返回 TYPE 行出现顺序 """
+    samples, types = {}, []
+    for line in text.splitlines():
+        if line.startswith('# TYPE'):
+            types.append(line.split()[2])
+            continue
+        if line.startswith('#') or not line:
+            continue
+        m = re.match(r'^([a-zA-Z_:][a-zA-Z0-9_:]*)(\{[^}]*\})? (-?\d+)$', line)
+        if not m:
+            raise ValueError('bad line: %r' % line)
+        samples[(m.group(1), m.group(2) or '')] = int(m.group(3))
+    return samples, types
+
+
+def test_export(lib, dump):
+    lib.host_demo_updates()
+    text = lib.host_export().decode()
+    if dump:
+        with open(dump, 'w') as f:
+            f.write(text)
+        print('  wrote %s' % dump)
+    samples, types = parse(text)
+
+    ok = check('one TYPE per family', sorted(types) == sorted(set(types)) and len(types) == 4, repr(types))
+    ok &= check('HELP taken from any member', '# HELP demo_heap_free_bytes Labelled ref gauge' in text and
+                '# HELP demo_latency_us Latency' in text, '')
+    ok &= check('counter value', samples[('demo_requests_total', '')] == 42, '')
+    ok &= check('negative gauge', samples[('demo_temperature', '')] == -5, '')
+    ok &= check('ref gauges with labels', samples[('demo_heap_free_bytes', '{heap="internal"}')] == 7 and
+                samples[('demo_heap_free_bytes', '{heap="spiram"}')] == 9, '')
+
+    buckets = [samples[('demo_latency_us_bucket', '{path="a",le="%s"}' % le)] for le in ('10', '100', '1000', '+Inf')]
+    ok &= check('histogram cumulative buckets', buckets == [2, 4, 5, 6], repr(buckets))
+    ok &= check('histogram sum/count', samples[('demo_latency_us_sum', '{path="a"}')] == 5622 and
+                samples[('demo_latency_us_count', '{path="a"}')] == 6, '')
+    ok &= check('histogram second label set', samples[('demo_latency_us_count', '{path="b"}')] == 1, '')
+
+    # 同名的样本必须连续出现
+    names = [line.split('{')[0].split(' ')[0] for line in text.splitlines() if not line.startswith('#')]
+    families = [re.sub(r'_(bucket|sum|count)$', '', n) for n in names]
+    grouped = all(families.index(f) + families.count(f) - 1 == len(families) - 1 - families[::-1].index(f)
+                  for f in set(families))
+    ok &= check('families contiguous', grouped, '%d samples' % len(names))
+    return ok
+
+
+def test_register(lib):
+    ok = check('duplicate registration ignored', lib.metrics_count() == 6, '%d registered' % lib.metrics_count())
+    ok &= check('invalid registration rejected', lib.host_invalid() == 3, '')
+    return ok
+
+
+def test_concurrent(lib):
+    threads, per_thread = 4, 500000
+    counter, count, low = ctypes.c_uint32(), ctypes.c_uint32(), ctypes.c_uint32()
+    lib.host_concurrent(threads, per_thread, ctypes.byref(counter), ctypes.byref(count), ctypes.byref(low))
+    total = threads * per_thread
+    ok = check('concurrent counter', counter.value == total, '%d / %d' % (counter.value, total))
+    ok &= check('concurrent histogram', count.value == total and low.value == total // 2,
+                'count %d, le=3 %d' % (count.value, low.value))
+    return ok
+
+
+def bench(lib):
+    loops = 5000000
+    names = ('counter_inc', 'gauge_set', 'histogram_observe (9 buckets)')
+    for kind, name in enumerate(names):
+        print('benchmark: %-30s %.1f ns/op (host)' % (name, lib.host_bench(kind, loops)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='metrics 主机校验与微基准')
+    parser.add_argument('--dump', help='把示例导出写到文件')
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as workdir:
+        lib = build_lib(workdir)
+        if lib.host_setup() != 0:
+            print('register failed')
+            return 1
+        ok = test_export(lib, args.dump)
+        ok &= test_register(lib)
+        ok &= test_concurrent(lib)
+        bench(lib)
+    print('PASS' if ok else 'FAIL')
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,322 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+远程串口行环形缓冲 (main/app/serial_line_ring.c) 主机校验与吞吐基准
+
+将固件 serial_line_ring.c 编译为共享库，检查:
+  1. 切行: 跨数据块的半行、\\r\\n、空行丢弃、时间戳前缀、超长折行 (续行无前缀，不切断 UTF-8 字符)、flush；
+  2. 回绕: 小缓冲上随机长度的行边写边读，内容与顺序一致；
+  3. 溢出: 消费者不读时新行被丢弃并计数，skip 只跳过记录；
+  4. 并发: 生产者/消费者两个线程同时运行，行序号严格递增，收到 + 丢弃 = 发送；
+     限速 4MB/s (目标的 4 倍) 且消费者按 16ms 刷新周期取空时不丢行；
+  5. 吞吐: 按 4KB TCP 数据块写入的 MB/s 与消费者每行耗时 (目标 1MB/s 下的 CPU 占比)。
+
+用法:
+  python serial_line_ring_bench.py
+  python serial_line_ring_bench.py --mbytes 64
+"""
+
+import argparse
+import ctypes
+import os
+import random
+import sys
+import tempfile
+
+import host_harness
+from host_harness import REPO, check
+
+REPO_MAIN = os.path.join(REPO, 'main')
+
+LINE_MAX = 255
+CHUNK = 4096
+
+GLUE_C = r'''
+#include "serial_line_ring.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static uint64_t now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ull + (uint64_t)t.tv_nsec;
+}
+
+serial_line_ring_t* host_ring_create(uint32_t size) {
+    serial_line_ring_t* r = malloc(sizeof(*r));
+    void* buf = aligned_alloc(4, size);
+    return serial_line_ring_init(r, buf, size) ? r : NULL;
+}
+
+uint32_t host_dropped(const serial_line_ring_t* r) { return atomic_load(&r->dropped); }
+
+// 读出一行到 out，返回长度；没有数据返回 -1
+int host_read(serial_line_ring_t* r, char* out) {
+    uint16_t len;
+    const char* line = serial_line_ring_peek(r, &len);
+    if (line == NULL) return -1;
+    memcpy(out, line, len + 1u);
+    serial_line_ring_pop(r);
+    return len;
+}
+
+// 生成 bytes 字节的日志流: "seq=%08u " + 随机填充 + "\n"
+static size_t make_stream(char* dst, size_t bytes, unsigned seed, uint32_t* lines) {
+    size_t n = 0;
+    uint32_t seq = 0;
+    srand(seed);
+    while (n + 128 < bytes) {
+        n += (size_t)sprintf(dst + n, "seq=%08u ", seq++);
+        const int fill = 8 + rand() % 100;
+        for (int k = 0; k < fill; k++) dst[n++] = (char)('a' + (k + seq) % 26);
+        dst[n++] = (rand() & 7) == 0 ? '\r' : '\n';
+        if (dst[n - 1] == '\r') dst[n++] = '\n';
+    }
+    *lines = seq;
+    return n;
+}
+
+typedef struct {
+    serial_line_ring_t* ring;
+    uint32_t period_us;   // 0 为不停轮询，否则按固定周期取空 (模拟 LVGL 定时器)
+    atomic_int done;
+    uint32_t received;
+    uint32_t out_of_order;
+    uint64_t consume_ns;
+} consumer_t;
+
+static void* consumer_main(void* arg) {
+    consumer_t* c = arg;
+    long last = -1;
+    for (;;) {
+        const int finished = atomic_load(&c->done);
+        uint16_t len;
+        const char* line;
+        int got = 0;
+        const uint64_t t0 = now_ns();
+        while ((line = serial_line_ring_peek(c->ring, &len)) != NULL) {
+            const long seq = strtol(line + 4, NULL, 10);
+            if (strncmp(line, "seq=", 4) != 0 || seq <= last) c->out_of_order++;
+            last = seq;
+            serial_line_ring_pop(c->ring);
+            c->received++;
+            got = 1;
+        }
+        if (got) c->consume_ns += now_ns() - t0;
+        if (finished && serial_line_ring_pending(c->ring) == 0) break;
+        if (c->period_us) {
+            const struct timespec ts = {0, (long)c->period_us * 1000};
+            nanosleep(&ts, NULL);
+        }
+    }
+    return NULL;
+}
+
+// 两个线程并发: 主线程按 chunk 写入 mbytes 数据，pace_mbps 不为 0 时限速，返回写入 MB/s
+double host_concurrent(uint32_t ring_size, size_t mbytes, size_t chunk, double pace_mbps, uint32_t period_us,
+                       uint32_t* sent, uint32_t* received, uint32_t* dropped, uint32_t* out_of_order, double* consume_ns_per_line) {
+    const size_t bytes = mbytes << 20;
+    char* stream = malloc(bytes);
+    const size_t len = make_stream(stream, bytes, 1, sent);
+    consumer_t c = {.ring = host_ring_create(ring_size), .period_us = period_us};
+    atomic_init(&c.done, 0);
+    pthread_t th;
+    pthread_create(&th, NULL, consumer_main, &c);
+    const uint64_t t0 = now_ns();
+    for (size_t off = 0; off < len; off += chunk) {
+        serial_line_ring_write(c.ring, stream + off, off + chunk <= len ? chunk : len - off, NULL);
+        if (pace_mbps > 0) {
+            const uint64_t due = t0 + (uint64_t)((double)(off + chunk) / 1048576.0 / pace_mbps * 1e9);
+            while (now_ns() < due) {
+            }
+        }
+    }
+    const uint64_t t1 = now_ns();
+    atomic_store(&c.done, 1);
+    pthread_join(th, NULL);
+    *received = c.received;
+    *dropped = atomic_load(&c.ring->dropped);
+    *out_of_order = c.out_of_order;
+    *consume_ns_per_line = c.received ? (double)c.consume_ns / c.received : 0;
+    free(stream);
+    return (double)len / 1048576.0 / ((double)(t1 - t0) / 1e9);
+}
+
+// 单线程: 每个数据块写入后立即取空 (与固件按块写入、按刷新周期读取相当)，返回生产者 ns/MB 与消费者 ns/行
+void host_single(uint32_t ring_size, size_t mbytes, size_t chunk, const char* prefix, double* produce_ns_per_mb,
+                 double* consume_ns_per_line) {
+    const size_t bytes = mbytes << 20;
+    char* stream = malloc(bytes);
+    uint32_t lines;
+    const size_t len = make_stream(stream, bytes, 2, &lines);
+    serial_line_ring_t* r = host_ring_create(ring_size);
+    uint64_t produce = 0, consume = 0, read = 0;
+    char out[LINE_MAX_COPY];
+    for (size_t off = 0; off < len; off += chunk) {
+        uint64_t t0 = now_ns();
+        serial_line_ring_write(r, stream + off, off + chunk <= len ? chunk : len - off, prefix);
+        uint64_t t1 = now_ns();
+        uint16_t l;
+        const char* line;
+        while ((line = serial_line_ring_peek(r, &l)) != NULL) {
+            memcpy(out, line, l + 1u);
+            serial_line_ring_pop(r);
+            read++;
+        }
+        produce += t1 - t0;
+        consume += now_ns() - t1;
+    }
+    *produce_ns_per_mb = (double)produce / ((double)len / 1048576.0);
+    *consume_ns_per_line = read ? (double)consume / read : 0;
+    free(stream);
+}
+'''.replace('LINE_MAX_COPY', str(LINE_MAX + 1))
+
+
+def build_lib(workdir):
+    lib = host_harness.build_lib(workdir, 'serial_line_ring', [os.path.join(REPO_MAIN, 'app', 'serial_line_ring.c')],
+                                 glue={'glue.c': GLUE_C}, includes=[os.path.join(REPO_MAIN, 'app', 'inc')])
+    vp = ctypes.c_void_p
+    u32p = ctypes.POINTER(ctypes.c_uint32)
+    dp = ctypes.POINTER(ctypes.c_double)
+    lib.host_ring_create.restype = vp
+    lib.host_ring_create.argtypes = [ctypes.c_uint32]
+    lib.host_dropped.restype = ctypes.c_uint32
+    lib.host_dropped.argtypes = [vp]
+    lib.host_read.argtypes = [vp, ctypes.c_char_p]
+    lib.serial_line_ring_write.restype = ctypes.c_size_t
+    lib.serial_line_ring_write.argtypes = [vp, ctypes.c_char_p, ctypes.c_size_t, ctypes.c_char_p]
+    lib.serial_line_ring_flush.argtypes = [vp]
+    lib.serial_line_ring_pending.restype = ctypes.c_uint32
+    lib.serial_line_ring_pending.argtypes = [vp]
+    lib.serial_line_ring_skip.restype = ctypes.c_uint32
+    lib.serial_line_ring_skip.argtypes = [vp, ctypes.c_uint32]
+    lib.host_concurrent.restype = ctypes.c_double
+    lib.host_concurrent.argtypes = [ctypes.c_uint32, ctypes.c_size_t, ctypes.c_size_t, ctypes.c_double,
+                                    ctypes.c_uint32, u32p, u32p, u32p, u32p, dp]
+    lib.host_single.argtypes = [ctypes.c_uint32, ctypes.c_size_t, ctypes.c_size_t, ctypes.c_char_p, dp, dp]
+    return lib
+
+
+def write(lib, ring, data, prefix=None):
+    return lib.serial_line_ring_write(ring, data, len(data), prefix)
+
+
+def read_all(lib, ring):
+    out = ctypes.create_string_buffer(LINE_MAX + 1)
+    lines = []
+    while lib.host_read(ring, out) >= 0:
+        lines.append(out.value)
+    return lines
+
+
+
+def test_split(lib):
+    ok = True
+    ring = lib.host_ring_create(4096)
+    write(lib, ring, b'hello wo', b'[T] ')
+    pending = lib.serial_line_ring_pending(ring)
+    write(lib, ring, b'rld\r\n\r\n\nsecond\rthird', b'[T] ')
+    lines = read_all(lib, ring)
+    ok &= check('split across chunks', pending == 0 and lines == [b'[T] hello world', b'[T] second'],
+                repr(lines))
+    lib.serial_line_ring_flush(ring)
+    lines = read_all(lib, ring)
+    ok &= check('flush partial line', lines == [b'[T] third'], repr(lines))
+
+    text = ('日志' * 200).encode('utf-8')
+    write(lib, ring, text + b'\n', b'[T] ')
+    lines = read_all(lib, ring)
+    valid = True
+    try:
+        for line in lines:
+            line.decode('utf-8')
+    except UnicodeDecodeError:
+        valid = False
+    joined = lines[0][4:] + b''.join(lines[1:]) if lines else b''
+    ok &= check('fold long line', len(lines) == 5 and all(len(l) <= LINE_MAX for l in lines) and valid and
+                joined == text and not lines[1].startswith(b'[T]'),
+                '%d bytes -> %s' % (len(text), [len(l) for l in lines]))
+    return ok
+
+
+def test_wrap(lib):
+    rnd = random.Random(7)
+    ring = lib.host_ring_create(1024)
+    sent, got = [], []
+    for i in range(20000):
+        line = ('%06d ' % i + 'x' * rnd.randint(0, 200)).encode()
+        if write(lib, ring, line + b'\n') == 1:
+            sent.append(line)
+        if rnd.random() < 0.5:
+            got.extend(read_all(lib, ring))
+    got.extend(read_all(lib, ring))
+    return check('wrap-around 20000 lines', got == sent and lib.host_dropped(ring) == 20000 - len(sent),
+                 '%d delivered, %d dropped' % (len(got), lib.host_dropped(ring)))
+
+
+def test_overflow(lib):
+    ok = True
+    ring = lib.host_ring_create(1024)
+    accepted = sum(write(lib, ring, b'line %03d padding padding\n' % i) for i in range(100))
+    dropped = lib.host_dropped(ring)
+    ok &= check('overflow drops newest', accepted + dropped == 100 and accepted == lib.serial_line_ring_pending(ring),
+                '%d accepted, %d dropped' % (accepted, dropped))
+    skipped = lib.serial_line_ring_skip(ring, accepted - 2)
+    lines = read_all(lib, ring)
+    ok &= check('skip backlog', skipped == accepted - 2 and len(lines) == 2 and
+                lines[-1] == b'line %03d padding padding' % (accepted - 1), repr(lines))
+    accepted = write(lib, ring, b'after\n')
+    ok &= check('accepts again after drain', accepted == 1 and read_all(lib, ring) == [b'after'], '')
+    return ok
+
+
+def test_concurrent(lib, mbytes):
+    ok = True
+    # 不限速 + 不停轮询 (消费者跟不上，验证丢弃计数)；
+    # 限速 4MB/s (目标的 4 倍) + 每 16ms 取空一次 (LVGL 刷新周期)，不应丢行
+    for pace, period_us, size in ((0.0, 0, mbytes), (4.0, 16000, 4)):
+        sent, received, dropped, disorder = (ctypes.c_uint32() for _ in range(4))
+        ns_line = ctypes.c_double()
+        mbps = lib.host_concurrent(256 * 1024, size, CHUNK, pace, period_us, ctypes.byref(sent),
+                                   ctypes.byref(received), ctypes.byref(dropped), ctypes.byref(disorder),
+                                   ctypes.byref(ns_line))
+        ok &= check('concurrent %d MB %s' % (size, 'paced %.0f MB/s' % pace if pace else 'unpaced'),
+                    disorder.value == 0 and received.value + dropped.value == sent.value and
+                    (pace == 0 or dropped.value == 0),
+                    '%d sent, %d received, %d dropped, %.0f MB/s'
+                    % (sent.value, received.value, dropped.value, mbps))
+    return ok
+
+
+def bench(lib, mbytes):
+    produce, consume = ctypes.c_double(), ctypes.c_double()
+    lib.host_single(256 * 1024, mbytes, CHUNK, b'[12:34:56] ', ctypes.byref(produce), ctypes.byref(consume))
+    lines_per_mb = 1048576 / 70.0  # 测试流平均行长约 70 字节
+    print('benchmark: %d MB in %d-byte chunks, timestamp prefix' % (mbytes, CHUNK))
+    print('  producer %8.0f ns/MB  (%.3f%% CPU at 1 MB/s)' % (produce.value, produce.value / 1e7))
+    print('  consumer %8.1f ns/line (%.3f%% CPU at 1 MB/s, ~%.0f lines/s)'
+          % (consume.value, consume.value * lines_per_mb / 1e7, lines_per_mb))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='serial_line_ring 主机校验与基准')
+    parser.add_argument('--mbytes', type=int, default=16, help='并发与吞吐测试的数据量 (MB)')
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as workdir:
+        lib = build_lib(workdir)
+        ok = test_split(lib)
+        ok &= test_wrap(lib)
+        ok &= test_overflow(lib)
+        ok &= test_concurrent(lib, args.mbytes)
+        bench(lib, args.mbytes)
+    print('PASS' if ok else 'FAIL')
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,349 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+SPI 字节流解复用 (components/Receiver/Communication/src/spi_stream_demux.c) 主机校验
+
+借 host_harness 把固件 spi_stream_demux.c 与 tcp_common_protocol.c (CRC16/帧校验) 编译为共享库。
+按发送端的格式合成一段 SPI 流: 图像字节中穿插遥测/心跳/命令/扩展帧 (含 255 字节最长帧)，
+以及几类诱饵 (孤立的 AA、AA 55 + 非法类型、长度为 0、CRC 错误的候选帧，候选范围覆盖后续真帧)。
+用多种随机切分 (含 1 字节缓冲、DMA 大小缓冲、帧内每个偏移处切分) 逐缓冲喂入，检查:
+  1. 回调序列: 图像字节与协议帧交替的顺序、内容与原始流逐字节一致；
+  2. 统计: frames / image_bytes 与流一致，跨缓冲边界的帧都计入 split_frames
+     (紧跟跨边界诱饵、从拼接缓冲交出的帧也计入)；
+  3. 重同步: bad_frames 等于 CRC 错误的诱饵数，诱饵之后 (包括落在其声明长度之内) 的真帧都能解出；
+  4. 按引用转发: 带缓冲句柄的图像数据指向该缓冲内部，只有拼接失败的遗留字节以 NULL 句柄交出；
+  5. 基准: 4 KB 缓冲下的吞吐 (主机)。
+
+用法:
+  python spi_stream_demux_bench.py [--seed N] [--chunkings N]
+"""
+
+import argparse
+import ctypes
+import os
+import random
+import struct
+import sys
+import tempfile
+
+import host_harness
+from host_harness import REPO, check
+
+COMM = os.path.join(REPO, 'components', 'Receiver', 'Communication')
+TCP = os.path.join(REPO, 'components', 'Receiver', 'tcp_server')
+
+FRAME_TYPES = (0x01, 0x02, 0x03, 0x04)  # 命令 / 遥测 / 心跳 / 扩展
+DMA_CHUNK = 4092
+
+GLUE_C = r'''
+#include "spi_stream_demux.h"
+#include <stdlib.h>
+#include <time.h>
+
+spi_stream_demux_t *host_new(spi_stream_image_cb_t on_image, spi_stream_frame_cb_t on_frame) {
+    spi_stream_demux_t *d = malloc(sizeof(*d));
+    spi_stream_demux_init(d, on_image, on_frame, NULL);
+    return d;
+}
+
+void host_stats(const spi_stream_demux_t *d, uint32_t *out, uint64_t *image_bytes) {
+    out[0] = d->stats.frames;
+    out[1] = d->stats.split_frames;
+    out[2] = d->stats.bad_frames;
+    *image_bytes = d->stats.image_bytes;
+}
+
+static void null_image(void *user, void *chunk, const uint8_t *data, size_t len) {}
+static void null_frame(void *user, const uint8_t *frame, size_t len) {}
+
+// 不经过 Python 回调的吞吐测试，返回 MB/s
+double host_bench(const uint8_t *data, size_t len, size_t chunk, int loops) {
+    spi_stream_demux_t d;
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < loops; i++) {
+        spi_stream_demux_init(&d, null_image, null_frame, NULL);
+        for (size_t pos = 0; pos < len; pos += chunk) {
+            spi_stream_demux_feed(&d, NULL, &data[pos], len - pos < chunk ? len - pos : chunk);
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    const double s = (t1.tv_sec - t0.tv_sec) + (t1.tv_nsec - t0.tv_nsec) * 1e-9;
+    return (double)len * loops / s / 1e6;
+}
+'''
+
+IMAGE_CB = ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_size_t)
+FRAME_CB = ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_size_t)
+
+
+def crc16_modbus(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xA001 if crc & 1 else crc >> 1
+    return crc
+
+
+def make_frame(frame_type, payload, corrupt=False):
+    """AA 55 + 长度(类型+负载) + 类型 + 负载 + CRC16/MODBUS(小端，覆盖长度/类型/负载)"""
+    body = bytes([len(payload) + 1, frame_type]) + payload
+    crc = crc16_modbus(body) ^ (0x0100 if corrupt else 0)
+    return b'\xaa\x55' + body + struct.pack('<H', crc)
+
+
+def image_bytes(rng, n):
+    # 图像数据本身不含 0xAA/0x55，流中所有帧头候选都来自有意放入的帧与诱饵
+    return bytes(b if b not in (0xAA, 0x55) else b + 1 for b in rng.randbytes(n))
+
+
+def build_stream(rng):
+    """返回 (流, 期望事件序列 [(kind, bytes)], CRC 错误诱饵数, 紧跟诱饵的帧序号)"""
+    events = []
+    bad = 0
+    resync = set()
+
+    def img(data):
+        if not data:
+            return
+        if events and events[-1][0] == 'img':
+            events[-1] = ('img', events[-1][1] + data)
+        else:
+            events.append(('img', data))
+
+    telemetry = struct.pack('<HHhhhi', 3850, 150, 5, -10, 2500, 123456)
+    fixed = [
+        make_frame(0x02, telemetry),                       # 与 ground_station_simulator 相同的遥测帧
+        make_frame(0x03, struct.pack('<BI', 1, 987654)),   # 心跳
+        make_frame(0x04, bytes(range(254))),               # 最长帧: length = 255
+        make_frame(0x01, b'\x10'),                         # 最短帧: 7 字节
+    ]
+    for i in range(160):
+        img(image_bytes(rng, rng.choice((0, 1, 3, 40, 700, 3000))))
+        roll = rng.random()
+        if i < len(fixed):
+            frame = fixed[i]
+        elif roll < 0.55:
+            frame = make_frame(rng.choice(FRAME_TYPES), rng.randbytes(rng.randint(1, 60)))
+        elif roll < 0.65:
+            img(b'\xaa')                                   # 孤立帧头字节
+            continue
+        elif roll < 0.72:
+            img(b'\xaa\x55' + bytes([rng.randint(1, 40), 0x09]))   # 非法类型
+            continue
+        elif roll < 0.76:
+            img(b'\xaa\x55\x00\x01')                       # 长度为 0
+            continue
+        else:
+            # CRC 错误的诱饵，其后紧跟一个真帧: 诱饵声明的长度可能覆盖真帧，解复用器须回退重新同步
+            payload = image_bytes(rng, rng.randint(1, 30))
+            decoy = make_frame(rng.choice(FRAME_TYPES), payload, corrupt=True)
+            img(decoy[:rng.randint(4, len(decoy))])
+            bad += 1
+            resync.add(sum(1 for kind, _ in events if kind == 'frame'))
+            frame = make_frame(rng.choice(FRAME_TYPES), rng.randbytes(rng.randint(1, 60)))
+        events.append(('frame', frame))
+    img(image_bytes(rng, 600))  # 结尾留足图像数据，不让最后的候选帧悬空
+    stream = b''.join(data for _, data in events)
+    return stream, events, bad, resync
+
+
+def frame_spans(stream_events):
+    spans, pos = [], 0
+    for kind, data in stream_events:
+        if kind == 'frame':
+            spans.append((pos, pos + len(data)))
+        pos += len(data)
+    return spans
+
+
+class Demux:
+    def __init__(self, lib):
+        self.lib = lib
+        self.events = []
+        self.bad_refs = 0
+        self.null_bytes = 0
+        self.chunks = {}
+        self._image_cb = IMAGE_CB(self._on_image)
+        self._frame_cb = FRAME_CB(self._on_frame)
+        self.handle = lib.host_new(self._image_cb, self._frame_cb)
+
+    def _on_image(self, user, chunk, data, length):
+        payload = ctypes.string_at(data, length)
+        if chunk is None:
+            self.null_bytes += length
+        else:
+            base, size = self.chunks[chunk]
+            if not (base <= data and data + length <= base + size):
+                self.bad_refs += 1
+        if self.events and self.events[-1][0] == 'img':
+            self.events[-1] = ('img', self.events[-1][1] + payload)
+        else:
+            self.events.append(('img', payload))
+
+    def _on_frame(self, user, frame, length):
+        self.events.append(('frame', ctypes.string_at(frame, length)))
+
+    def feed(self, stream, cuts):
+        start = 0
+        for i, end in enumerate(list(cuts) + [len(stream)]):
+            if end <= start:
+                continue
+            buf = ctypes.create_string_buffer(stream[start:end], end - start)
+            self.chunks[i + 1] = (ctypes.addressof(buf), end - start)
+            self.lib.spi_stream_demux_feed(self.handle, i + 1, buf, end - start)
+            start = end
+
+    def stats(self):
+        out = (ctypes.c_uint32 * 3)()
+        image = ctypes.c_uint64()
+        self.lib.host_stats(self.handle, out, ctypes.byref(image))
+        return out[0], out[1], out[2], image.value
+
+    def close(self):
+        self.lib.free(self.handle)
+
+
+def build_lib(workdir):
+    lib = host_harness.build_lib(workdir, 'spi_stream_demux',
+                                 [os.path.join(COMM, 'src', 'spi_stream_demux.c'),
+                                  os.path.join(TCP, 'src', 'tcp_common_protocol.c')],
+                                 glue={'glue.c': GLUE_C},
+                                 includes=[os.path.join(COMM, 'inc'), os.path.join(TCP, 'inc')])
+    lib.host_new.restype = ctypes.c_void_p
+    lib.host_new.argtypes = [IMAGE_CB, FRAME_CB]
+    lib.host_stats.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_uint32), ctypes.POINTER(ctypes.c_uint64)]
+    lib.spi_stream_demux_feed.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_char_p, ctypes.c_size_t]
+    lib.free.argtypes = [ctypes.c_void_p]
+    lib.host_bench.restype = ctypes.c_double
+    lib.host_bench.argtypes = [ctypes.c_char_p, ctypes.c_size_t, ctypes.c_size_t, ctypes.c_int]
+    return lib
+
+
+def random_cuts(rng, length, style):
+    cuts, pos = [], 0
+    while True:
+        if style == 'tiny':
+            pos += rng.randint(1, 3)
+        elif style == 'dma':
+            pos += DMA_CHUNK
+        elif style == 'mixed':
+            pos += rng.choice((1, 2, 5, 64, 255, 1024, DMA_CHUNK))
+        else:
+            pos += rng.randint(1, 600)
+        if pos >= length:
+            return cuts
+        cuts.append(pos)
+
+
+def run(lib, stream, cuts):
+    d = Demux(lib)
+    d.feed(stream, cuts)
+    result = d.events, d.stats(), d.bad_refs, d.null_bytes
+    d.close()
+    return result
+
+
+def expected_split(spans, cuts, resync):
+    """跨缓冲边界的帧一定经拼接缓冲交出；紧跟诱饵的帧在诱饵跨边界时也可能从拼接缓冲交出"""
+    cut_set = set(cuts)
+    straddle = [any(c in cut_set for c in range(s + 1, e)) for s, e in spans]
+    lo = sum(straddle)
+    return lo, lo + sum(1 for i in resync if not straddle[i])
+
+
+def test_chunkings(lib, rng, count):
+    stream, want, bad, resync = build_stream(rng)
+    spans = frame_spans(want)
+    image_total = sum(len(d) for k, d in want if k == 'img')
+    print('stream: %d bytes, %d frames, %d bad-CRC decoys' % (len(stream), len(spans), bad))
+
+    styles = ['whole', 'dma', 'tiny', 'mixed'] + ['random'] * max(count - 4, 0)
+    failures = []
+    split_seen = 0
+    null_seen = 0
+    for i, style in enumerate(styles):
+        cuts = [] if style == 'whole' else random_cuts(rng, len(stream), style)
+        events, (frames, split, bad_frames, image), bad_refs, null_bytes = run(lib, stream, cuts)
+        problems = []
+        if events != want:
+            first = next((j for j, (a, b) in enumerate(zip(events, want)) if a != b), min(len(events), len(want)))
+            problems.append('event %d differs' % first)
+        if frames != len(spans) or image != image_total:
+            problems.append('frames %d image %d' % (frames, image))
+        lo, hi = expected_split(spans, cuts, resync)
+        if not lo <= split <= hi:
+            problems.append('split %d want %d..%d' % (split, lo, hi))
+        if bad_frames != bad:
+            problems.append('bad %d want %d' % (bad_frames, bad))
+        if bad_refs:
+            problems.append('%d image refs outside their chunk' % bad_refs)
+        if problems:
+            failures.append('%s#%d: %s' % (style, i, ', '.join(problems)))
+        split_seen += split
+        null_seen += null_bytes
+    ok = check('random chunkings', not failures,
+               '%d chunkings, %d split frames, %d carried image bytes' % (len(styles), split_seen, null_seen)
+               if not failures else failures[0])
+    ok &= check('carried bytes exercised', null_seen > 0 and split_seen > 0)
+    return ok, stream, want, bad
+
+
+def test_boundary_sweep(lib, stream, want, bad):
+    """在最长帧内部的每个偏移处切一刀，再切成三段让中间段只进入拼接缓冲"""
+    spans = frame_spans(want)
+    longest = max(spans, key=lambda s: s[1] - s[0])
+    failures = []
+    for cut in range(longest[0], longest[1] + 1):
+        events, stats, _, _ = run(lib, stream, [cut])
+        if events != want or stats[2] != bad:
+            failures.append(cut)
+    # 两刀: 把帧切成三段 (中间段落在内部拼接缓冲内)
+    for a in range(longest[0] + 1, longest[0] + 8):
+        events, stats, _, _ = run(lib, stream, [a, a + 3, longest[1] - 2])
+        if events != want or stats[1] != 1:
+            failures.append((a, a + 3))
+    return check('cut at every offset of longest frame', not failures,
+                 '%d offsets' % (longest[1] - longest[0] + 1) if not failures else 'first bad %r' % (failures[0],))
+
+
+def test_resync(lib):
+    good = make_frame(0x02, b'\x01\x02\x03\x04')
+    decoy = make_frame(0x01, bytes(20), corrupt=True)
+    # 诱饵声明 22 字节，真帧起始于诱饵第 6 字节: 校验失败后须回到候选起点之后重新寻找帧头
+    stream = b'\x11' * 5 + decoy[:6] + good + b'\x22' * 40
+    want = [('img', b'\x11' * 5 + decoy[:6]), ('frame', good), ('img', b'\x22' * 40)]
+    ok = True
+    # [22]/[24]/[22, 26]: 真帧完整落在跨缓冲遗留的候选字节内，其后的遗留字节仍须按序交出
+    for cuts in ([], [6], [7], [10], [13], [6, 8, 12, 14], [22], [24], [22, 26]):
+        events, stats, _, _ = run(lib, stream, cuts)
+        ok &= check('resync inside bad candidate %r' % (cuts,), events == want and stats[2] == 1 and stats[0] == 1,
+                    'bad %d frames %d' % (stats[2], stats[0]))
+    return ok
+
+
+def bench(lib, stream):
+    mbps = lib.host_bench(stream, len(stream), DMA_CHUNK, 200)
+    print('benchmark: %.0f MB/s with %d-byte chunks (host)' % (mbps, DMA_CHUNK))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='spi_stream_demux 主机校验')
+    parser.add_argument('--seed', type=int, default=31)
+    parser.add_argument('--chunkings', type=int, default=40)
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    with tempfile.TemporaryDirectory() as workdir:
+        lib = build_lib(workdir)
+        ok, stream, want, bad = test_chunkings(lib, rng, args.chunkings)
+        ok &= test_boundary_sweep(lib, stream, want, bad)
+        ok &= test_resync(lib)
+        bench(lib, stream)
+    print('PASS' if ok else 'FAIL')
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,211 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+ST7789 脏区合并与窗口代价模型 (components/Peripherals/src/st7789_dirty.c) 主机校验与基准
+
+将固件 st7789_dirty.c 编译为共享库，检查:
+  1. 规则: 相邻及大面积重叠的脏区合并，仅角部重叠或相距较远的小脏区分开，空矩形丢弃，结果按扫描顺序排列；
+  2. 随机: 合并结果覆盖全部输入像素，代价不高于输入，且任意两窗口再合并都不再省；
+  3. 窗口开销: window_cost_px=0 时只合并重叠，开销很大时合并成外接矩形；
+  4. 基准: 典型 LVGL 帧 (移动小方块、滚动文本、光标闪烁 + 状态栏) 合并前后的窗口数、
+     发送像素与 80MHz SPI 下的估算传输时间，以及 32 个脏区时合并本身的耗时。
+
+用法:
+  python st7789_dirty_bench.py
+  python st7789_dirty_bench.py --window-cost 64
+"""
+
+import argparse
+import ctypes
+import os
+import random
+import sys
+import tempfile
+
+import host_harness
+from host_harness import REPO_PERIPH, check
+
+WIDTH, HEIGHT = 240, 320
+MAX_RECTS = 32
+US_PER_PX = 16 / 80.0  # RGB565 在 80MHz SPI 下每像素 0.2us
+
+GLUE_C = r'''
+#include "st7789_dirty.h"
+#include <string.h>
+#include <time.h>
+
+static uint64_t now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ull + (uint64_t)t.tv_nsec;
+}
+
+// 对同一组脏区重复合并 loops 次，返回每次耗时 ns
+double host_merge_ns(const st7789_rect_t* rects, size_t n, uint32_t window_cost_px, int loops) {
+    st7789_rect_t work[ST7789_DIRTY_MAX_RECTS];
+    volatile size_t sink = 0;
+    const uint64_t t0 = now_ns();
+    for (int i = 0; i < loops; i++) {
+        memcpy(work, rects, n * sizeof(*rects));
+        sink += st7789_dirty_merge(work, n, window_cost_px);
+    }
+    (void)sink;
+    return (double)(now_ns() - t0) / loops;
+}
+'''
+
+
+class Rect(ctypes.Structure):
+    _fields_ = [('x1', ctypes.c_int16), ('y1', ctypes.c_int16), ('x2', ctypes.c_int16), ('y2', ctypes.c_int16)]
+
+    def tup(self):
+        return (self.x1, self.y1, self.x2, self.y2)
+
+
+def build_lib(workdir):
+    lib = host_harness.build_lib(workdir, 'st7789_dirty', [os.path.join(REPO_PERIPH, 'src', 'st7789_dirty.c')],
+                                 glue={'glue.c': GLUE_C}, includes=[os.path.join(REPO_PERIPH, 'inc')])
+    rp = ctypes.POINTER(Rect)
+    lib.st7789_dirty_merge.restype = ctypes.c_size_t
+    lib.st7789_dirty_merge.argtypes = [rp, ctypes.c_size_t, ctypes.c_uint32]
+    lib.st7789_dirty_cost.restype = ctypes.c_uint32
+    lib.st7789_dirty_cost.argtypes = [rp, ctypes.c_size_t, ctypes.c_uint32]
+    lib.host_merge_ns.restype = ctypes.c_double
+    lib.host_merge_ns.argtypes = [rp, ctypes.c_size_t, ctypes.c_uint32, ctypes.c_int]
+    return lib
+
+
+def to_array(rects):
+    arr = (Rect * MAX_RECTS)()
+    for i, r in enumerate(rects):
+        arr[i] = Rect(*r)
+    return arr
+
+
+def merge(lib, rects, window_cost):
+    arr = to_array(rects)
+    n = lib.st7789_dirty_merge(arr, len(rects), window_cost)
+    return [arr[i].tup() for i in range(n)]
+
+
+def cost(lib, rects, window_cost):
+    return lib.st7789_dirty_cost(to_array(rects), len(rects), window_cost)
+
+
+def area(r):
+    return max(0, r[2] - r[0] + 1) * max(0, r[3] - r[1] + 1)
+
+
+def union(a, b):
+    return (min(a[0], b[0]), min(a[1], b[1]), max(a[2], b[2]), max(a[3], b[3]))
+
+
+def covers(windows, rects):
+    for r in rects:
+        for y in range(r[1], r[3] + 1):
+            for x in range(r[0], r[2] + 1):
+                if not any(w[0] <= x <= w[2] and w[1] <= y <= w[3] for w in windows):
+                    return False
+    return True
+
+
+def test_rules(lib, wc):
+    ok = True
+    out = merge(lib, [(0, 0, 99, 9), (0, 10, 99, 19)], wc)
+    ok &= check('adjacent rows merge', out == [(0, 0, 99, 19)], repr(out))
+    out = merge(lib, [(10, 10, 50, 50), (20, 20, 60, 60)], wc)
+    ok &= check('large overlap merges', out == [(10, 10, 60, 60)], repr(out))
+    # 对角小重叠: 外接矩形多出的两角比重叠部分重发更贵
+    out = merge(lib, [(10, 10, 50, 50), (40, 40, 80, 80)], wc)
+    ok &= check('corner overlap stays apart', len(out) == 2, repr(out))
+    out = merge(lib, [(200, 300, 219, 309), (0, 0, 19, 9)], wc)
+    ok &= check('far small rects stay apart', out == [(0, 0, 19, 9), (200, 300, 219, 309)], repr(out))
+    out = merge(lib, [(5, 5, 4, 10), (0, 0, 9, 9), (3, 8, 3, 7)], wc)
+    ok &= check('empty rects dropped', out == [(0, 0, 9, 9)], repr(out))
+    out = merge(lib, [(0, 0, 9, 9), (20, 0, 29, 9)], 0)
+    ok &= check('zero window cost keeps gaps', len(out) == 2, repr(out))
+    out = merge(lib, [(0, 0, 9, 9), (200, 300, 239, 319)], 1 << 20)
+    ok &= check('huge window cost -> bbox', out == [(0, 0, 239, 319)], repr(out))
+    return ok
+
+
+def random_frame(rnd, n, max_size):
+    rects = []
+    for _ in range(n):
+        w, h = rnd.randint(1, max_size), rnd.randint(1, max_size)
+        x, y = rnd.randint(0, WIDTH - w), rnd.randint(0, HEIGHT - h)
+        rects.append((x, y, x + w - 1, y + h - 1))
+    return rects
+
+
+def test_random(lib, wc):
+    rnd = random.Random(43)
+    bad_cover = bad_cost = bad_local = bad_order = 0
+    frames = 300
+    for i in range(frames):
+        rects = random_frame(rnd, rnd.randint(1, MAX_RECTS), rnd.choice((8, 24, 80)))
+        out = merge(lib, rects, wc)
+        if i < 60 and not covers(out, rects):  # 逐像素检查较慢，只查前 60 帧
+            bad_cover += 1
+        if cost(lib, out, wc) > cost(lib, rects, wc):
+            bad_cost += 1
+        for a in range(len(out)):
+            for b in range(a + 1, len(out)):
+                if area(union(out[a], out[b])) + wc < area(out[a]) + area(out[b]) + 2 * wc:
+                    bad_local += 1
+        if out != sorted(out, key=lambda r: (r[1], r[0])):
+            bad_order += 1
+    return check('random frames x%d' % frames, bad_cover == bad_cost == bad_local == bad_order == 0,
+                 'cover %d, cost %d, mergeable pairs %d, order %d failures'
+                 % (bad_cover, bad_cost, bad_local, bad_order))
+
+
+def sprites_frame(rnd, count=16, size=24, step=4):
+    # 每个方块旧位置与新位置各一个脏区 (LVGL 已把重叠的两块合并时也可能是一个)
+    rects = []
+    for _ in range(count):
+        x, y = rnd.randint(0, WIDTH - size - step), rnd.randint(0, HEIGHT - size - step)
+        rects.append((x, y, x + size - 1, y + size - 1))
+        rects.append((x + step, y + step, x + step + size - 1, y + step + size - 1))
+    return rects
+
+
+def bench(lib, wc):
+    rnd = random.Random(1)
+    scenes = [
+        ('sprites 16x24px', sprites_frame(rnd)),
+        ('text rows', [(4, 40 + 18 * i, 235, 40 + 18 * i + 15) for i in range(14)]),
+        ('cursor + status bar', [(120, 150, 121, 167), (0, 0, 239, 19), (180, 2, 236, 17)]),
+        ('random 32 rects', random_frame(rnd, MAX_RECTS, 40)),
+    ]
+    print('benchmark: window cost %d px (%.1f us), 80 MHz RGB565' % (wc, wc * US_PER_PX))
+    print('  %-20s %9s %9s %10s %10s %9s' % ('scene', 'windows', 'merged', 'px before', 'px after', 'xfer us'))
+    for name, rects in scenes:
+        out = merge(lib, rects, wc)
+        before, after = cost(lib, rects, wc), cost(lib, out, wc)
+        rows = (min(r[1] for r in rects), max(r[3] for r in rects))
+        rows_cost = (rows[1] - rows[0] + 1) * WIDTH + wc  # 旧做法: 脏区所在整行一个窗口
+        print('  %-20s %9d %9d %10d %10d %5.0f/%.0f'
+              % (name, len(rects), len(out), before, after, after * US_PER_PX, rows_cost * US_PER_PX))
+    rects = random_frame(rnd, MAX_RECTS, 40)
+    ns = lib.host_merge_ns(to_array(rects), len(rects), wc, 2000)
+    print('  merge 32 rects: %.1f us on host' % (ns / 1000.0))
+    print('  (xfer us: merged windows / full-width rows spanning all dirty areas)')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='st7789_dirty 主机校验与基准')
+    parser.add_argument('--window-cost', type=int, default=64, help='每窗口开销 (等价像素数，与 ST7789_WINDOW_COST_PX 一致)')
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as workdir:
+        lib = build_lib(workdir)
+        ok = test_rules(lib, args.window_cost)
+        ok &= test_random(lib, args.window_cost)
+        bench(lib, args.window_cost)
+    print('PASS' if ok else 'FAIL')
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
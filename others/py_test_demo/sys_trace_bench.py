@@ -0,0 +1,243 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+系统事件追踪 (components/Peripherals/src/sys_trace.c) 主机校验与基准
+
+借 host_harness 把固件 sys_trace.c 编译为共享库 (测试线程登记为指定核上的任务)，检查:
+  1. 导出: 区间/瞬时/计数事件导出为合法的 Chrome trace JSON，字段与顺序正确；
+  2. 覆盖: 环满后只保留最新的事件，recorded/lost 统计正确；
+  3. 并发: 多线程同时写同一核的环，每个事件完整地落在唯一的槽位里，不丢不重；
+  4. 编译去除: SYS_TRACE_ENABLE=0 时宏不产生调用，也不对计数值求值；
+  5. 基准: 单事件写入耗时 (记录中/已停止)。主机上时间戳取自 clock_gettime，
+     目标板上 esp_timer_get_time 的读取开销另计。
+
+用法:
+  python sys_trace_bench.py
+  python sys_trace_bench.py --dump trace.json   # 另存一份示例 JSON，可在 chrome://tracing 中打开
+"""
+
+import argparse
+import ctypes
+import json
+import os
+import sys
+import tempfile
+
+import host_harness
+from host_harness import REPO_PERIPH, check
+
+GLUE_C = r'''
+#include "sys_trace.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+TaskHandle_t host_task_bind(int core, const char* name);
+
+void host_set_core(int core) { host_task_bind(core, "main"); }
+
+// 导出到内存
+static char* s_json;
+static size_t s_json_len;
+static int mem_write(void* ctx, const char* data, size_t len) {
+    (void)ctx;
+    s_json = realloc(s_json, s_json_len + len + 1);
+    memcpy(s_json + s_json_len, data, len);
+    s_json_len += len;
+    s_json[s_json_len] = 0;
+    return (int)len;
+}
+const char* host_export(void) {
+    free(s_json);
+    s_json = NULL;
+    s_json_len = 0;
+    return sys_trace_write_json(mem_write, NULL) == ESP_OK ? s_json : NULL;
+}
+
+void host_emit_demo(void) {
+    SYS_TRACE_BEGIN("frame");
+    SYS_TRACE_BEGIN("render");
+    SYS_TRACE_COUNTER("queue_depth", 3);
+    SYS_TRACE_END("render");
+    SYS_TRACE_INSTANT("vsync");
+    SYS_TRACE_END("frame");
+}
+
+void host_emit_n(int n) {
+    for (int i = 0; i < n; i++) sys_trace_emit(SYS_TRACE_EV_COUNTER, "n", i);
+}
+
+// 并发写: 每个线程写 value = (线程号 << 24) | i，事件名与任务名一一对应
+static const char* s_writer_names[4] = {"w0", "w1", "w2", "w3"};
+static const char* s_writer_tasks[4] = {"writer0", "writer1", "writer2", "writer3"};
+typedef struct { int id; int count; } writer_arg_t;
+static void* writer(void* p) {
+    writer_arg_t* a = p;
+    host_task_bind(0, s_writer_tasks[a->id]); // 全部写 core 0 的环
+    for (int i = 0; i < a->count; i++) {
+        sys_trace_emit(SYS_TRACE_EV_INSTANT, s_writer_names[a->id], (a->id << 24) | i);
+    }
+    return NULL;
+}
+void host_concurrent(int threads, int per_thread) {
+    pthread_t th[4];
+    writer_arg_t args[4];
+    for (int i = 0; i < threads; i++) {
+        args[i].id = i;
+        args[i].count = per_thread;
+        pthread_create(&th[i], NULL, writer, &args[i]);
+    }
+    for (int i = 0; i < threads; i++) pthread_join(th[i], NULL);
+}
+
+double host_emit_ns(int loops) {
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (int i = 0; i < loops; i++) {
+        SYS_TRACE_BEGIN("bench");
+        SYS_TRACE_END("bench");
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    return ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / (2.0 * loops);
+}
+'''
+
+DISABLED_C = r'''
+#define SYS_TRACE_ENABLE 0
+#include "sys_trace.h"
+static int s_calls;
+static int side_effect(void) { return ++s_calls; }
+int host_disabled_calls(void) {
+    SYS_TRACE_BEGIN("x");
+    SYS_TRACE_COUNTER("y", side_effect());
+    SYS_TRACE_END("x");
+    return s_calls;
+}
+'''
+
+
+class Stats(ctypes.Structure):
+    _fields_ = [('capacity', ctypes.c_uint32), ('recorded', ctypes.c_uint32), ('lost', ctypes.c_uint32)]
+
+
+def build_lib(workdir):
+    lib = host_harness.build_lib(workdir, 'sys_trace', [os.path.join(REPO_PERIPH, 'src', 'sys_trace.c')],
+                                 glue={'glue.c': GLUE_C, 'disabled.c': DISABLED_C},
+                                 includes=[os.path.join(REPO_PERIPH, 'inc')])
+    lib.sys_trace_init.argtypes = [ctypes.c_size_t]
+    lib.sys_trace_get_stats.argtypes = [ctypes.POINTER(Stats)]
+    lib.host_export.restype = ctypes.c_char_p
+    lib.host_concurrent.argtypes = [ctypes.c_int, ctypes.c_int]
+    lib.host_emit_ns.restype = ctypes.c_double
+    return lib
+
+
+def export(lib):
+    text = lib.host_export()
+    return json.loads(text.decode()) if text else None
+
+
+def stats(lib):
+    s = Stats()
+    lib.sys_trace_get_stats(ctypes.byref(s))
+    return s
+
+
+def test_export(lib, dump):
+    lib.sys_trace_clear()
+    lib.host_set_core(1)
+    lib.host_emit_demo()
+    doc = export(lib)
+    events = [e for e in doc['traceEvents'] if e['ph'] != 'M']
+    phases = [(e['ph'], e['name']) for e in events]
+    expect = [('B', 'frame'), ('B', 'render'), ('C', 'queue_depth'), ('E', 'render'), ('i', 'vsync'), ('E', 'frame')]
+    ok = check('chrome json phases', phases == expect, repr(phases))
+    ts = [e['ts'] for e in events]
+    ok &= check('timestamps monotonic', ts == sorted(ts) and ts[-1] - ts[0] < 1000000, '%d us span' % (ts[-1] - ts[0]))
+    names = {e['args']['name'] for e in doc['traceEvents'] if e['ph'] == 'M' and e['name'] == 'thread_name'}
+    ok &= check('thread names resolved', names == {'main'}, repr(names))
+    counter = [e for e in events if e['ph'] == 'C'][0]
+    ok &= check('counter value', counter['args']['value'] == 3, repr(counter['args']))
+    if dump:
+        with open(dump, 'w') as f:
+            json.dump(doc, f, indent=1)
+        print('  wrote %s' % dump)
+    return ok
+
+
+def test_overwrite(lib, capacity):
+    lib.sys_trace_clear()
+    lib.host_set_core(0)
+    lib.host_emit_n(1000)
+    s = stats(lib)
+    doc = export(lib)
+    values = [e['args']['value'] for e in doc['traceEvents'] if e['ph'] == 'C']
+    ok = check('overwrite keeps newest', values == list(range(1000 - capacity, 1000)),
+               '%d events, first %s' % (len(values), values[:1]))
+    ok &= check('recorded/lost stats', s.recorded == 1000 and s.lost == 1000 - capacity,
+                'recorded %d lost %d' % (s.recorded, s.lost))
+    return ok
+
+
+def test_concurrent(lib, capacity):
+    lib.sys_trace_clear()
+    threads, per_thread = 4, 50000
+    lib.host_concurrent(threads, per_thread)
+    s = stats(lib)
+    doc = export(lib)
+    events = [e for e in doc['traceEvents'] if e['ph'] == 'i']
+    # 每个事件的名字与其所属任务一致 (槽位没有被两个写入方混写)；
+    # 环中保留的正好是最后 capacity 个序号
+    tasks = {e['tid']: e['args']['name'] for e in doc['traceEvents'] if e['ph'] == 'M' and e['name'] == 'thread_name'}
+    bad = 0
+    for e in events:
+        if tasks.get(e['tid']) != 'writer' + e['name'][1:]:
+            bad += 1
+    ok = check('concurrent slot integrity', bad == 0 and len(events) == capacity,
+               '%d events kept, %d torn' % (len(events), bad))
+    ok &= check('concurrent count', s.recorded == threads * per_thread, 'recorded %d' % s.recorded)
+    return ok
+
+
+def test_disabled(lib):
+    calls = lib.host_disabled_calls()
+    return check('SYS_TRACE_ENABLE=0 compiles out', calls == 0, '%d side effects' % calls)
+
+
+def bench(lib):
+    lib.sys_trace_clear()
+    lib.host_set_core(0)
+    lib.sys_trace_start()
+    on = lib.host_emit_ns(2000000)
+    lib.sys_trace_stop()
+    off = lib.host_emit_ns(2000000)
+    lib.sys_trace_start()
+    print('benchmark: emit %.1f ns/event recording, %.1f ns/event stopped (host, incl. clock read)' % (on, off))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='sys_trace 主机校验与基准')
+    parser.add_argument('--dump', help='把示例导出 JSON 写到文件')
+    args = parser.parse_args()
+
+    capacity = 256
+    with tempfile.TemporaryDirectory() as workdir:
+        lib = build_lib(workdir)
+        if lib.sys_trace_init(capacity) != 0:
+            print('init failed')
+            return 1
+        lib.sys_trace_start()
+        ok = test_export(lib, args.dump)
+        ok &= test_overwrite(lib, capacity)
+        ok &= test_concurrent(lib, capacity)
+        ok &= test_disabled(lib)
+        bench(lib)
+    print('PASS' if ok else 'FAIL')
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())
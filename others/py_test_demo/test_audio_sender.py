@@ -2,20 +2,355 @@
 # 用于测试发送MP3解码后的PCM数据到ESP32
 # 依赖: pip install pydub
 # 还需要安装ffmpeg: https://ffmpeg.org/download.html
+#
+# 支持压缩传输 (与 main/app/inc/audio_codec.h 一致):
+#   连接后先发送 hello 协商编码，ESP32 回复 ack 后按块发送 [块头][负载]；
+#   旧固件不回复 ack 时回退为原始 PCM。
+# 支持 UDP 低延迟传输 (与 main/app/inc/audio_rtp.h 一致):
+#   RTP 格式小包 (默认每包 5ms)，按实时速度发送，丢包/乱序由 ESP32 抖动缓冲隐藏。
+# 用法:
+#   python test_audio_sender.py                                  # 图形界面选择文件与IP，原始PCM
+#   python test_audio_sender.py --ip 192.168.1.100 --file a.mp3 --codec adpcm
+#   python test_audio_sender.py --ip 192.168.1.100 --tone 10 --codec adpcm2   # 发送10秒测试音
+#   python test_audio_sender.py --ip 192.168.1.100 --tone 10 --udp --packet-ms 5
+#   python test_audio_sender.py --ip 192.168.1.100 --file a.mp3 --udp --uplink-wav mic.wav  # 同时保存麦克风上行
 
+import argparse
+import math
+import random
 import socket
+import struct
 import sys
-from pydub import AudioSegment
 import os
-import tkinter as tk
-from tkinter import filedialog, simpledialog
+import time
+import wave
 
 ESP32_IP = "192.168.233.247"
+ESP32_PORT = 7557
 
 # 采样率（与ESP32一致）
 SAMPLE_RATE = 44100
 
+# 协议定义（与 audio_codec.h 保持一致）
+HELLO_MAGIC = 0x31445541  # "AUD1"
+ACK_MAGIC = 0x31415541    # "AUA1"
+STREAM_VERSION = 1
+BLOCK_SYNC = 0xA55A
+HELLO_FMT = '<IBBBBIHH'   # magic, version, codec_mask, preferred, channels, sample_rate, block_samples, reserved
+ACK_FMT = '<IBBBBHH'      # magic, version, codec, status, reserved, block_samples, reserved2
+BLOCK_FMT = '<HBBHHhBBH'  # sync, codec, flags, seq, samples, predictor, step_index, reserved, payload_len
+BLOCK_SAMPLES = 1024
+
+CODEC_PCM16 = 0
+CODEC_IMA_ADPCM = 1
+CODEC_ADPCM2 = 2
+CODEC_NAMES = {'pcm': CODEC_PCM16, 'adpcm': CODEC_IMA_ADPCM, 'adpcm2': CODEC_ADPCM2}
+
+RTP_VERSION = 2
+RTP_PT_BASE = 96            # 96 PCM16 (小端)，97 IMA-ADPCM，98 ADPCM2
+RTP_HEADER_FMT = '>BBHII'   # V/P/X/CC, M/PT, seq, timestamp, ssrc
+RTP_PAYLOAD_HEADER_FMT = '>hBB'  # predictor, step_index, reserved (DVI4 布局)
+RTP_DEFAULT_PACKET_MS = 5
+
+assert struct.calcsize(HELLO_FMT) == 16 and struct.calcsize(ACK_FMT) == 12 and struct.calcsize(BLOCK_FMT) == 14
+
+STEP_TABLE = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97,
+    107, 118, 130, 143, 157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871,
+    5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623,
+    27086, 29794, 32767,
+]
+INDEX_TABLE4 = [-1, -1, -1, -1, 2, 4, 6, 8]
+INDEX_TABLE2 = [-1, 2]
+
+
+def _clamp(v, lo, hi):
+    return lo if v < lo else (hi if v > hi else v)
+
+
+class AdpcmEncoder:
+    """IMA-ADPCM 4位 / 2位编码器，与 audio_codec.c 逐位一致"""
+
+    def __init__(self, codec):
+        self.codec = codec
+        self.predictor = 0
+        self.index = 0
+
+    def _code4(self, sample):
+        step = STEP_TABLE[self.index]
+        diff = sample - self.predictor
+        code = 0
+        if diff < 0:
+            code = 8
+            diff = -diff
+        if diff >= step:
+            code |= 4
+            diff -= step
+        if diff >= step >> 1:
+            code |= 2
+            diff -= step >> 1
+        if diff >= step >> 2:
+            code |= 1
+        # 与解码器相同的重建
+        d = step >> 3
+        if code & 4:
+            d += step
+        if code & 2:
+            d += step >> 1
+        if code & 1:
+            d += step >> 2
+        self.predictor = _clamp(self.predictor - d if code & 8 else self.predictor + d, -32768, 32767)
+        self.index = _clamp(self.index + INDEX_TABLE4[code & 7], 0, 88)
+        return code
+
+    def _code2(self, sample):
+        step = STEP_TABLE[self.index]
+        diff = sample - self.predictor
+        code = 0
+        if diff < 0:
+            code = 2
+            diff = -diff
+        if diff >= step:
+            code |= 1
+        d = (step >> 1) + (step if code & 1 else 0)
+        self.predictor = _clamp(self.predictor - d if code & 2 else self.predictor + d, -32768, 32767)
+        self.index = _clamp(self.index + INDEX_TABLE2[code & 1], 0, 88)
+        return code
+
+    def encode(self, samples):
+        out = bytearray()
+        if self.codec == CODEC_IMA_ADPCM:
+            for i in range(0, len(samples), 2):
+                lo = self._code4(samples[i])
+                hi = self._code4(samples[i + 1]) if i + 1 < len(samples) else 0
+                out.append(lo | hi << 4)
+        elif self.codec == CODEC_ADPCM2:
+            for i in range(0, len(samples), 4):
+                byte = 0
+                for k in range(min(4, len(samples) - i)):
+                    byte |= self._code2(samples[i + k]) << (2 * k)
+                out.append(byte)
+        else:
+            out += struct.pack('<%dh' % len(samples), *samples)
+        return bytes(out)
+
+    def encode_block(self, seq, samples):
+        """返回 [块头][负载]，块头携带编码前的预测值与步长索引"""
+        predictor, index = self.predictor, self.index
+        payload = self.encode(samples)
+        header = struct.pack(BLOCK_FMT, BLOCK_SYNC, self.codec, 0, seq & 0xFFFF, len(samples), predictor, index, 0,
+                             len(payload))
+        return header + payload
+
+
+def adpcm_decode4(payload, predictor, index, samples):
+    """IMA-ADPCM 4位解码 (低半字节在前)，与 audio_codec.c 一致"""
+    out = []
+    for i in range(samples):
+        code = (payload[i >> 1] >> (4 * (i & 1))) & 0xF
+        step = STEP_TABLE[index]
+        d = step >> 3
+        if code & 4:
+            d += step
+        if code & 2:
+            d += step >> 1
+        if code & 1:
+            d += step >> 2
+        predictor = _clamp(predictor - d if code & 8 else predictor + d, -32768, 32767)
+        index = _clamp(index + INDEX_TABLE4[code & 7], 0, 88)
+        out.append(predictor)
+    return out
+
+
+class UplinkRecorder:
+    """接收 ESP32 麦克风上行 (main/app/voice_capture.c): hello 声明采样率，之后为 IMA-ADPCM RTP 包"""
+
+    def __init__(self):
+        self.sample_rate = 16000
+        self.samples = []
+        self.packets = 0
+        self.lost = 0
+        self.next_seq = None
+
+    def handle(self, data):
+        if len(data) >= struct.calcsize(HELLO_FMT) and struct.unpack_from('<I', data)[0] == HELLO_MAGIC:
+            self.sample_rate = struct.unpack_from(HELLO_FMT, data)[5]
+            return
+        head = struct.calcsize(RTP_HEADER_FMT) + struct.calcsize(RTP_PAYLOAD_HEADER_FMT)
+        if len(data) < head:
+            return
+        vpxcc, mpt, seq, _, _ = struct.unpack_from(RTP_HEADER_FMT, data)
+        if vpxcc >> 6 != RTP_VERSION or (mpt & 0x7F) != RTP_PT_BASE + CODEC_IMA_ADPCM:
+            return
+        predictor, index, _ = struct.unpack_from(RTP_PAYLOAD_HEADER_FMT, data, struct.calcsize(RTP_HEADER_FMT))
+        if self.next_seq is not None:
+            gap = (seq - self.next_seq) & 0xFFFF
+            if gap < 0x8000:
+                self.lost += gap
+        self.next_seq = (seq + 1) & 0xFFFF
+        payload = data[head:]
+        self.samples += adpcm_decode4(payload, predictor, index, len(payload) * 2)
+        self.packets += 1
+
+    def poll(self, sock):
+        while True:
+            try:
+                data, _ = sock.recvfrom(2048)
+            except (BlockingIOError, socket.timeout):
+                return
+            self.handle(data)
+
+    def save(self, path):
+        with wave.open(path, 'wb') as w:
+            w.setnchannels(1)
+            w.setsampwidth(2)
+            w.setframerate(self.sample_rate)
+            w.writeframes(struct.pack('<%dh' % len(self.samples), *self.samples))
+        print(f"Uplink saved to {path}: {self.packets} packets, {self.lost} lost, "
+              f"{len(self.samples) / self.sample_rate:.1f}s @ {self.sample_rate} Hz")
+
+
+class RtpPacketizer:
+    """UDP 音频包，与 audio_rtp.c 的 audio_rtp_encode 逐字节一致"""
+
+    def __init__(self, codec, ssrc=None):
+        self.encoder = AdpcmEncoder(codec)
+        self.ssrc = random.getrandbits(32) if ssrc is None else ssrc
+        self.seq = random.getrandbits(16)
+        self.timestamp = random.getrandbits(32)
+        self.first = True
+
+    def packet(self, samples):
+        """samples 为一包的采样 (ADPCM 时数量需为 4 的倍数)"""
+        enc = self.encoder
+        header = struct.pack(RTP_HEADER_FMT, RTP_VERSION << 6, (0x80 if self.first else 0) | (RTP_PT_BASE + enc.codec),
+                             self.seq, self.timestamp, self.ssrc)
+        state = struct.pack(RTP_PAYLOAD_HEADER_FMT, enc.predictor, enc.index, 0)
+        payload = enc.encode(samples)
+        self.seq = (self.seq + 1) & 0xFFFF
+        self.timestamp = (self.timestamp + len(samples)) & 0xFFFFFFFF
+        self.first = False
+        return header + state + payload
+
+
+def negotiate(sock, codec, sample_rate, timeout=1.0):
+    """发送 hello 并等待 ack；返回选定编码，旧固件无应答时返回 None"""
+    mask = (1 << CODEC_PCM16) | (1 << CODEC_IMA_ADPCM) | (1 << CODEC_ADPCM2)
+    sock.sendall(struct.pack(HELLO_FMT, HELLO_MAGIC, STREAM_VERSION, mask, codec, 1, sample_rate, BLOCK_SAMPLES, 0))
+    sock.settimeout(timeout)
+    try:
+        data = b''
+        while len(data) < struct.calcsize(ACK_FMT):
+            chunk = sock.recv(struct.calcsize(ACK_FMT) - len(data))
+            if not chunk:
+                return None
+            data += chunk
+    except socket.timeout:
+        return None
+    finally:
+        sock.settimeout(None)
+    magic, _, chosen, status, _, _, _ = struct.unpack(ACK_FMT, data)
+    if magic != ACK_MAGIC or status != 0:
+        raise RuntimeError('codec negotiation rejected (status=%d)' % status)
+    return chosen
+
+
+def tone_pcm(seconds, sample_rate=SAMPLE_RATE):
+    """测试音: 440Hz + 1kHz 混合"""
+    n = int(seconds * sample_rate)
+    return struct.pack('<%dh' % n, *(int(9000 * math.sin(2 * math.pi * 440 * i / sample_rate) +
+                                         6000 * math.sin(2 * math.pi * 1000 * i / sample_rate)) for i in range(n)))
+
+
+def load_mp3(path):
+    from pydub import AudioSegment
+    # 加载MP3文件
+    audio = AudioSegment.from_mp3(path)
+    # 转换为PCM（raw）格式，单声道，16位，采样率44100
+    audio = audio.set_channels(1).set_frame_rate(SAMPLE_RATE).set_sample_width(2)
+    return audio.raw_data
+
+
+def stream_pcm(ip, pcm_data, codec):
+    # 创建TCP socket
+    with socket.socket(socket.AF_INET, socket.SOCK_STREAM) as sock:
+        try:
+            sock.connect((ip, ESP32_PORT))
+            print(f"Connected to {ip}:{ESP32_PORT}")
+
+            chosen = negotiate(sock, codec, SAMPLE_RATE) if codec != CODEC_PCM16 else None
+            if chosen is None:
+                # 分块发送原始PCM数据 (旧格式)
+                if codec != CODEC_PCM16:
+                    print("No codec ack from ESP32, falling back to raw PCM")
+                chunk_size = 4096
+                for i in range(0, len(pcm_data), chunk_size):
+                    chunk = pcm_data[i:i + chunk_size]
+                    sock.sendall(chunk)
+                print(f"All data sent ({len(pcm_data)} bytes raw PCM)")
+                return
+
+            encoder = AdpcmEncoder(chosen)
+            samples = struct.unpack('<%dh' % (len(pcm_data) // 2), pcm_data[:len(pcm_data) // 2 * 2])
+            sent = 0
+            start = time.time()
+            for seq, i in enumerate(range(0, len(samples), BLOCK_SAMPLES)):
+                block = encoder.encode_block(seq, samples[i:i + BLOCK_SAMPLES])
+                sock.sendall(block)
+                sent += len(block)
+            elapsed = time.time() - start
+            print(f"All data sent: codec={chosen}, {len(pcm_data)} PCM bytes -> {sent} bytes "
+                  f"({len(pcm_data) / max(sent, 1):.2f}:1, "
+                  f"{sent * 8 / (len(samples) / SAMPLE_RATE) / 1000:.0f} kbit/s, encode+send {elapsed:.1f}s)")
+        except Exception as e:
+            print(f"Error: {e}")
+
+
+def stream_udp(ip, pcm_data, codec, packet_ms=RTP_DEFAULT_PACKET_MS, uplink_path=None):
+    """按实时速度发送 RTP 格式小包；uplink_path 不为空时同时接收麦克风上行并保存为 WAV"""
+    packet_samples = max(4, int(SAMPLE_RATE * packet_ms / 1000) // 4 * 4)
+    samples = struct.unpack('<%dh' % (len(pcm_data) // 2), pcm_data[:len(pcm_data) // 2 * 2])
+    with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as sock:
+        # hello 声明采样率与编码；无应答时 ESP32 按 44.1kHz 处理，编码由负载类型决定
+        mask = (1 << CODEC_PCM16) | (1 << CODEC_IMA_ADPCM) | (1 << CODEC_ADPCM2)
+        sock.sendto(struct.pack(HELLO_FMT, HELLO_MAGIC, STREAM_VERSION, mask, codec, 1, SAMPLE_RATE, packet_samples,
+                                0), (ip, ESP32_PORT))
+        sock.settimeout(0.5)
+        try:
+            data, _ = sock.recvfrom(64)
+            magic, _, chosen, status, _, _, _ = struct.unpack(ACK_FMT, data[:struct.calcsize(ACK_FMT)])
+            if magic == ACK_MAGIC and status == 0:
+                codec = chosen
+        except (socket.timeout, struct.error):
+            print("No UDP ack from ESP32, sending anyway")
+
+        packetizer = RtpPacketizer(codec)
+        uplink = UplinkRecorder() if uplink_path else None
+        sock.setblocking(False)
+        start = time.monotonic()
+        sent = 0
+        for n, i in enumerate(range(0, len(samples) - packet_samples + 1, packet_samples)):
+            # 按采样时间节拍发送，避免突发
+            delay = start + n * packet_samples / SAMPLE_RATE - time.monotonic()
+            if uplink:
+                uplink.poll(sock)
+            if delay > 0:
+                time.sleep(delay)
+            pkt = packetizer.packet(samples[i:i + packet_samples])
+            sock.sendto(pkt, (ip, ESP32_PORT))
+            sent += len(pkt)
+        print(f"UDP stream done: codec={codec}, {packet_samples} samples/packet, "
+              f"{sent * 8 / (len(samples) / SAMPLE_RATE) / 1000:.0f} kbit/s")
+        if uplink:
+            uplink.poll(sock)
+            uplink.save(uplink_path)
+
+
 def send_audio():
+    import tkinter as tk
+    from tkinter import filedialog, simpledialog
+
     root = tk.Tk()
     root.withdraw()  # 隐藏主窗口
 
@@ -35,33 +370,39 @@ def send_audio():
         print("No IP provided")
         sys.exit(1)
 
-    ESP32_PORT = 7557
+    pcm_data = load_mp3(MP3_FILE)
+    print(f"Audio loaded: {len(pcm_data)} bytes, sample rate: {SAMPLE_RATE}")
+    stream_pcm(ESP32_IP, pcm_data, CODEC_PCM16)
 
-    # 加载MP3文件
-    audio = AudioSegment.from_mp3(MP3_FILE)
 
-    # 转换为PCM（raw）格式，单声道，16位，采样率44100
-    audio = audio.set_channels(1).set_frame_rate(SAMPLE_RATE).set_sample_width(2)
-    pcm_data = audio.raw_data
+def main():
+    parser = argparse.ArgumentParser(description='向ESP32发送音频')
+    parser.add_argument('--ip', help='ESP32 IP (省略时使用图形界面)')
+    parser.add_argument('--file', help='MP3 文件')
+    parser.add_argument('--tone', type=float, default=0, help='发送指定秒数的测试音代替文件')
+    parser.add_argument('--codec', choices=sorted(CODEC_NAMES), default='adpcm')
+    parser.add_argument('--udp', action='store_true', help='使用 UDP 低延迟传输')
+    parser.add_argument('--packet-ms', type=float, default=RTP_DEFAULT_PACKET_MS, help='UDP 每包时长')
+    parser.add_argument('--uplink-wav', help='UDP 模式下保存 ESP32 麦克风上行到 WAV 文件')
+    args = parser.parse_args()
 
-    print(f"Audio loaded: {len(pcm_data)} bytes, sample rate: {SAMPLE_RATE}")
+    if not args.ip:
+        send_audio()
+        return
 
-    # 创建TCP socket
-    with socket.socket(socket.AF_INET, socket.SOCK_STREAM) as sock:
-        try:
-            sock.connect((ESP32_IP, ESP32_PORT))
-            print(f"Connected to {ESP32_IP}:{ESP32_PORT}")
-
-            # 分块发送数据
-            chunk_size = 4096
-            for i in range(0, len(pcm_data), chunk_size):
-                chunk = pcm_data[i:i + chunk_size]
-                sock.sendall(chunk)
-                print(f"Sent {len(chunk)} bytes")
+    if args.tone > 0:
+        pcm_data = tone_pcm(args.tone)
+    elif args.file and os.path.exists(args.file):
+        pcm_data = load_mp3(args.file)
+    else:
+        print("Need --file or --tone")
+        sys.exit(1)
+    print(f"Audio loaded: {len(pcm_data)} bytes, sample rate: {SAMPLE_RATE}")
+    if args.udp:
+        stream_udp(args.ip, pcm_data, CODEC_NAMES[args.codec], args.packet_ms, args.uplink_wav)
+    else:
+        stream_pcm(args.ip, pcm_data, CODEC_NAMES[args.codec])
 
-            print("All data sent")
-        except Exception as e:
-            print(f"Error: {e}")
 
 if __name__ == '__main__':
-    send_audio()
\ No newline at end of file
+    main()
@@ -0,0 +1,343 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+接收端图传桥 (video_bridge) 测试脚本
+
+两种模式:
+  selftest  主机回环: 合成帧 -> 封包 (与 video_packetizer.c 相同格式) -> 127.0.0.1 TCP/UDP -> 重组校验
+  listen    作为主控端接收 ESP32 图传桥发出的帧 (配合串口命令 `video test <fps>` 使用合成帧源)
+
+用法:
+  python test_video_bridge.py selftest --transport udp --frames 300
+  python test_video_bridge.py listen --transport tcp --port 6556 --save out_dir
+"""
+
+import argparse
+import os
+import random
+import socket
+import struct
+import threading
+import time
+
+# 协议定义（与 video_packetizer.h 保持一致）
+TCP_SYNC_WORD = 0xAEBC1402
+TCP_FRAME_TYPE_JPEG = 0x01
+TCP_HEADER_FMT = '<IBHHI'  # sync_word, frame_type, width, height, data_len
+TCP_HEADER_SIZE = struct.calcsize(TCP_HEADER_FMT)
+
+UDP_MAGIC = 0x50325055  # "P2PU"
+UDP_PACKET_TYPE_FRAME_DATA = 0x02
+UDP_HEADER_FMT = '<IBBHIHHIHHI4s'
+UDP_HEADER_SIZE = struct.calcsize(UDP_HEADER_FMT)
+UDP_MAX_PACKET_SIZE = 1400
+UDP_PAYLOAD_SIZE = UDP_MAX_PACKET_SIZE - UDP_HEADER_SIZE
+
+TCP_DEFAULT_PORT = 6556
+UDP_DEFAULT_PORT = 6789
+
+assert TCP_HEADER_SIZE == 13 and UDP_HEADER_SIZE == 32
+
+
+def checksum(data):
+    return sum(data) & 0xFFFF
+
+
+def tcp_packet(frame, width, height):
+    return struct.pack(TCP_HEADER_FMT, TCP_SYNC_WORD, TCP_FRAME_TYPE_JPEG, width, height, len(frame)) + frame
+
+
+def udp_fragments(frame_id, frame, timestamp_ms):
+    total = (len(frame) + UDP_PAYLOAD_SIZE - 1) // UDP_PAYLOAD_SIZE
+    for i in range(total):
+        chunk = frame[i * UDP_PAYLOAD_SIZE:(i + 1) * UDP_PAYLOAD_SIZE]
+        header = struct.pack(UDP_HEADER_FMT, UDP_MAGIC, UDP_PACKET_TYPE_FRAME_DATA, 1, i, frame_id, i, total,
+                             len(frame), len(chunk), checksum(chunk), timestamp_ms & 0xFFFFFFFF, b'\0' * 4)
+        yield header + chunk
+
+
+def synthetic_frame(index, size_min=4000, size_max=30000):
+    """合成一帧: JPEG SOI/EOI 包裹的伪随机负载，首 4 字节为帧序号便于校验顺序"""
+    rng = random.Random(index)
+    body = struct.pack('<I', index) + bytes(rng.getrandbits(8) for _ in range(rng.randint(size_min, size_max)))
+    return b'\xff\xd8' + body + b'\xff\xd9'
+
+
+class Stats:
+    """按秒统计帧率与吞吐"""
+
+    def __init__(self, name):
+        self.name = name
+        self.frames = 0
+        self.bytes = 0
+        self.bad = 0
+        self.incomplete = 0
+        self.latency_ms = []
+        self._win_frames = 0
+        self._win_bytes = 0
+        self._win_start = time.time()
+
+    def add(self, size, latency_ms=None):
+        self.frames += 1
+        self.bytes += size
+        self._win_frames += 1
+        self._win_bytes += size
+        if latency_ms is not None:
+            self.latency_ms.append(latency_ms)
+        now = time.time()
+        if now - self._win_start >= 1.0:
+            dt = now - self._win_start
+            print(f"[{self.name}] {self._win_frames / dt:.1f} fps, {self._win_bytes * 8 / 1000 / dt:.0f} kbps, "
+                  f"total {self.frames} frames, bad {self.bad}, incomplete {self.incomplete}")
+            self._win_frames = 0
+            self._win_bytes = 0
+            self._win_start = now
+
+    def summary(self):
+        lat = ''
+        if self.latency_ms:
+            s = sorted(self.latency_ms)
+            lat = f", latency avg {sum(s) / len(s):.2f} ms p99 {s[int(len(s) * 0.99) - 1]:.2f} ms"
+        return (f"[{self.name}] frames {self.frames}, bytes {self.bytes}, bad {self.bad}, "
+                f"incomplete {self.incomplete}{lat}")
+
+
+class TcpReceiver:
+    """image_transfer_header_t 流接收与重同步"""
+
+    def __init__(self, stats, on_frame):
+        self.stats = stats
+        self.on_frame = on_frame
+        self.buf = bytearray()
+
+    def feed(self, data):
+        self.buf += data
+        while True:
+            if len(self.buf) < TCP_HEADER_SIZE:
+                return
+            sync, ftype, width, height, length = struct.unpack_from(TCP_HEADER_FMT, self.buf)
+            if sync != TCP_SYNC_WORD:
+                # 失步: 向后查找下一个同步字
+                idx = self.buf.find(struct.pack('<I', TCP_SYNC_WORD), 1)
+                self.stats.bad += 1
+                del self.buf[:idx if idx > 0 else len(self.buf) - 3]
+                continue
+            if len(self.buf) < TCP_HEADER_SIZE + length:
+                return
+            frame = bytes(self.buf[TCP_HEADER_SIZE:TCP_HEADER_SIZE + length])
+            del self.buf[:TCP_HEADER_SIZE + length]
+            self.on_frame(frame, width, height)
+
+
+class UdpReassembler:
+    """p2p_udp 分片重组，新帧到达时未收齐的旧帧整帧丢弃"""
+
+    def __init__(self, stats, on_frame):
+        self.stats = stats
+        self.on_frame = on_frame
+        self.frame_id = None
+        self.parts = {}
+        self.total = 0
+        self.size = 0
+
+    def feed(self, packet):
+        if len(packet) < UDP_HEADER_SIZE:
+            self.stats.bad += 1
+            return
+        (magic, ptype, _ver, _seq, frame_id, packet_id, total, frame_size, data_size, csum, _ts,
+         _res) = struct.unpack_from(UDP_HEADER_FMT, packet)
+        payload = packet[UDP_HEADER_SIZE:]
+        if magic != UDP_MAGIC or ptype != UDP_PACKET_TYPE_FRAME_DATA or len(payload) != data_size \
+                or checksum(payload) != csum:
+            self.stats.bad += 1
+            return
+        if frame_id != self.frame_id:
+            if self.frame_id is not None and len(self.parts) < self.total:
+                self.stats.incomplete += 1
+            self.frame_id = frame_id
+            self.parts = {}
+            self.total = total
+            self.size = frame_size
+        self.parts[packet_id] = payload
+        if len(self.parts) == self.total:
+            frame = b''.join(self.parts[i] for i in range(self.total))
+            self.parts = {}
+            self.total = 0
+            if len(frame) != self.size:
+                self.stats.bad += 1
+                return
+            self.on_frame(frame, 0, 0)
+
+
+def is_jpeg(frame):
+    return len(frame) >= 4 and frame[:2] == b'\xff\xd8' and frame[-2:] == b'\xff\xd9'
+
+
+def run_selftest(args):
+    """主机回环: 发送端与接收端都在本机，验证封包/重组与整帧丢弃逻辑"""
+    port = args.port or (TCP_DEFAULT_PORT if args.transport == 'tcp' else UDP_DEFAULT_PORT)
+    stats = Stats('loopback')
+    sent_at = {}
+    expected = [0]
+
+    def on_frame(frame, width, height):
+        if not is_jpeg(frame):
+            stats.bad += 1
+            return
+        index = struct.unpack_from('<I', frame, 2)[0]
+        if frame != synthetic_frame(index, args.min_size, args.max_size):
+            stats.bad += 1
+            return
+        if index < expected[0]:
+            stats.bad += 1  # 乱序
+        expected[0] = index + 1
+        stats.add(len(frame), (time.perf_counter() - sent_at.pop(index, time.perf_counter())) * 1000)
+
+    ready = threading.Event()
+    done = threading.Event()
+
+    def receiver():
+        if args.transport == 'tcp':
+            srv = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+            srv.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+            srv.bind(('127.0.0.1', port))
+            srv.listen(1)
+            ready.set()
+            conn, _ = srv.accept()
+            rx = TcpReceiver(stats, on_frame)
+            while True:
+                data = conn.recv(65536)
+                if not data:
+                    break
+                rx.feed(data)
+            conn.close()
+            srv.close()
+        else:
+            sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+            sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 1 << 20)
+            sock.bind(('127.0.0.1', port))
+            sock.settimeout(0.5)
+            ready.set()
+            rx = UdpReassembler(stats, on_frame)
+            while not done.is_set():
+                try:
+                    rx.feed(sock.recv(2048))
+                except socket.timeout:
+                    continue
+            sock.close()
+
+    t = threading.Thread(target=receiver, daemon=True)
+    t.start()
+    ready.wait()
+
+    drop_rng = random.Random(1)
+    dropped = 0
+    period = 1.0 / args.fps if args.fps > 0 else 0
+    if args.transport == 'tcp':
+        tx = socket.create_connection(('127.0.0.1', port))
+    else:
+        tx = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+
+    start = time.perf_counter()
+    for i in range(args.frames):
+        frame = synthetic_frame(i, args.min_size, args.max_size)
+        sent_at[i] = time.perf_counter()
+        if args.transport == 'tcp':
+            tx.sendall(tcp_packet(frame, 240, 188))
+        else:
+            for pkt in udp_fragments(i + 1, frame, int(time.time() * 1000)):
+                # 模拟链路丢包: 丢失分片的帧应被接收端整帧丢弃
+                if drop_rng.random() < args.loss:
+                    dropped += 1
+                    continue
+                tx.sendto(pkt, ('127.0.0.1', port))
+        if period:
+            next_t = start + (i + 1) * period
+            time.sleep(max(0.0, next_t - time.perf_counter()))
+
+    if args.transport == 'tcp':
+        tx.close()
+        t.join(timeout=5)
+    else:
+        time.sleep(0.5)
+        done.set()
+        t.join(timeout=2)
+        tx.close()
+
+    print(stats.summary())
+    if args.transport == 'udp':
+        print(f"[loopback] dropped fragments {dropped}")
+    # 无丢包时每帧都必须完整到达；有丢包时只要求没有损坏帧被交付
+    ok = stats.bad == 0 and (stats.frames == args.frames if args.loss == 0 else stats.frames > 0)
+    print('PASS' if ok else 'FAIL')
+    return 0 if ok else 1
+
+
+def run_listen(args):
+    """作为主控端接收 ESP32 图传桥发出的帧"""
+    port = args.port or (TCP_DEFAULT_PORT if args.transport == 'tcp' else UDP_DEFAULT_PORT)
+    stats = Stats(args.transport)
+    if args.save:
+        os.makedirs(args.save, exist_ok=True)
+
+    def on_frame(frame, width, height):
+        if not is_jpeg(frame):
+            stats.bad += 1
+            return
+        stats.add(len(frame))
+        if args.save:
+            with open(os.path.join(args.save, f"frame_{stats.frames:05d}.jpg"), 'wb') as f:
+                f.write(frame)
+
+    try:
+        if args.transport == 'tcp':
+            srv = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+            srv.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+            srv.bind(('0.0.0.0', port))
+            srv.listen(1)
+            print(f"TCP 监听 0.0.0.0:{port}，等待图传桥连接...")
+            while True:
+                conn, addr = srv.accept()
+                print(f"连接来自 {addr}")
+                rx = TcpReceiver(stats, on_frame)
+                while True:
+                    data = conn.recv(65536)
+                    if not data:
+                        break
+                    rx.feed(data)
+                conn.close()
+                print("连接断开，等待重连...")
+        else:
+            sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+            sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 1 << 20)
+            sock.bind(('0.0.0.0', port))
+            print(f"UDP 监听 0.0.0.0:{port}")
+            rx = UdpReassembler(stats, on_frame)
+            while True:
+                rx.feed(sock.recv(2048))
+    except KeyboardInterrupt:
+        print()
+        print(stats.summary())
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description='接收端图传桥测试')
+    parser.add_argument('mode', choices=['selftest', 'listen'])
+    parser.add_argument('--transport', choices=['tcp', 'udp'], default='tcp')
+    parser.add_argument('--port', type=int, default=0, help='端口 (默认 TCP 6556 / UDP 6789)')
+    parser.add_argument('--frames', type=int, default=200, help='selftest 帧数')
+    parser.add_argument('--fps', type=float, default=0, help='selftest 发送帧率 (0 为不限速)')
+    parser.add_argument('--loss', type=float, default=0.0, help='selftest UDP 分片丢失率')
+    parser.add_argument('--min-size', type=int, default=4000)
+    parser.add_argument('--max-size', type=int, default=30000)
+    parser.add_argument('--save', help='listen 模式下保存 JPEG 的目录')
+    args = parser.parse_args()
+
+    if args.mode == 'selftest':
+        return run_selftest(args)
+    return run_listen(args)
+
+
+if __name__ == '__main__':
+    raise SystemExit(main())
@@ -0,0 +1,363 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+接收端 USB CDC 高速流 (usb_stream_framer / usb_device_receiver) 测试与吞吐基准
+
+两种模式:
+  pty     主机回环: 将固件中的 usb_stream_framer.c 编译为共享库，以 pty 代替 CDC 端口，
+          发送端写入混合流 (图传帧 + 协议帧 + 文本行)，接收端按固件相同方式读入分帧器窗口，
+          逐帧校验并统计吞吐；--consumer-ms 模拟下游 (图传桥) 处理耗时以观察反压
+  serial  实机: 向 ESP32 的 CDC 端口发送 JPEG 帧测上行吞吐，或发送 `usb dump <kb>` 测下行吞吐
+
+用法:
+  python usb_stream_bench.py pty --mb 64
+  python usb_stream_bench.py pty --mb 16 --consumer-ms 30
+  python usb_stream_bench.py serial --port /dev/ttyACM0 --send-mb 8
+  python usb_stream_bench.py serial --port /dev/ttyACM0 --dump-kb 4096
+"""
+
+import argparse
+import ctypes
+import os
+import pty
+import queue
+import random
+import struct
+import sys
+import tempfile
+import threading
+import time
+import tty
+import zlib
+
+import host_harness
+from host_harness import REPO
+
+# 协议定义（与 usb_stream_framer.h 保持一致）
+SYNC_WORD = 0xAEBC1402
+HEADER_FMT = '<IBHHI'  # sync_word, frame_type, width, height, data_len
+HEADER_SIZE = struct.calcsize(HEADER_FMT)
+FRAME_JPEG = 0x01
+FRAME_BULK = 0x10
+MAX_FRAME = 512 * 1024
+FRAME_BUF_COUNT = 2       # USB_RX_FRAME_BUF_COUNT
+FRAME_BUF_SIZE = 256 * 1024  # USB_RX_FRAME_BUF_SIZE
+BUF_WAIT_S = 0.2          # USB_RX_BUF_WAIT_MS
+
+FRAME_TYPE_HEARTBEAT = 0x03  # tcp_common_protocol.h
+
+assert HEADER_SIZE == 13
+
+REPO_RECEIVER = os.path.join(REPO, 'components', 'Receiver')
+
+
+def crc16_modbus(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xA001 if crc & 1 else crc >> 1
+    return crc
+
+
+def protocol_frame(frame_type, payload):
+    body = bytes([1 + len(payload), frame_type]) + payload
+    return b'\xAA\x55' + body + struct.pack('<H', crc16_modbus(body))
+
+
+def stream_frame(frame_type, payload, width=0, height=0):
+    return struct.pack(HEADER_FMT, SYNC_WORD, frame_type, width, height, len(payload)) + payload
+
+
+def synthetic_payload(index, size):
+    """首 4 字节为帧序号，末 4 字节为其余内容的 CRC32"""
+    body = struct.pack('<I', index) + random.Random(index).randbytes(size - 8)
+    return body + struct.pack('<I', zlib.crc32(body))
+
+
+def check_payload(data):
+    return len(data) >= 8 and struct.unpack('<I', data[-4:])[0] == zlib.crc32(data[:-4])
+
+
+# ---------------------------------------------------------------------------
+# pty 模式: 固件分帧器 (ctypes)
+# ---------------------------------------------------------------------------
+
+GLUE_C = r'''
+#include "usb_stream_framer.h"
+size_t host_framer_size(void) { return sizeof(usb_stream_framer_t); }
+const usb_stream_stats_t* host_framer_stats(const usb_stream_framer_t* f) { return &f->stats; }
+'''
+
+
+class FrameInfo(ctypes.Structure):
+    _fields_ = [('frame_type', ctypes.c_uint8), ('width', ctypes.c_uint16), ('height', ctypes.c_uint16),
+                ('len', ctypes.c_uint32)]
+
+
+FRAME_BEGIN = ctypes.CFUNCTYPE(ctypes.c_void_p, ctypes.c_void_p, ctypes.POINTER(FrameInfo))
+FRAME_END = ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.POINTER(FrameInfo), ctypes.c_void_p)
+ON_PROTOCOL = ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.c_void_p, ctypes.c_size_t)
+ON_LINE = ctypes.CFUNCTYPE(None, ctypes.c_void_p, ctypes.c_char_p)
+
+
+class Callbacks(ctypes.Structure):
+    _fields_ = [('frame_begin', FRAME_BEGIN), ('frame_end', FRAME_END), ('on_protocol', ON_PROTOCOL),
+                ('on_line', ON_LINE), ('user', ctypes.c_void_p)]
+
+
+class Stats(ctypes.Structure):
+    _fields_ = [('rx_bytes', ctypes.c_uint64), ('payload_bytes', ctypes.c_uint64), ('copied_bytes', ctypes.c_uint64),
+                ('frames', ctypes.c_uint32), ('dropped_frames', ctypes.c_uint32),
+                ('protocol_frames', ctypes.c_uint32), ('lines', ctypes.c_uint32), ('resync_bytes', ctypes.c_uint32)]
+
+
+def build_framer_lib(workdir):
+    lib = host_harness.build_lib(workdir, 'usb_stream_framer',
+                                 [os.path.join(REPO_RECEIVER, 'Communication', 'src', 'usb_stream_framer.c'),
+                                  os.path.join(REPO_RECEIVER, 'tcp_server', 'src', 'tcp_common_protocol.c')],
+                                 glue={'glue.c': GLUE_C},
+                                 includes=[os.path.join(REPO_RECEIVER, 'Communication', 'inc'),
+                                           os.path.join(REPO_RECEIVER, 'tcp_server', 'inc')])
+    lib.host_framer_size.restype = ctypes.c_size_t
+    lib.host_framer_stats.restype = ctypes.POINTER(Stats)
+    lib.host_framer_stats.argtypes = [ctypes.c_void_p]
+    lib.usb_stream_framer_init.argtypes = [ctypes.c_void_p, ctypes.POINTER(Callbacks)]
+    lib.usb_stream_framer_window.restype = ctypes.c_size_t
+    lib.usb_stream_framer_window.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_void_p)]
+    lib.usb_stream_framer_commit.argtypes = [ctypes.c_void_p, ctypes.c_size_t]
+    return lib
+
+
+class FirmwareModel:
+    """与 usb_device_receiver.c 相同的缓冲管理: 双帧缓冲 + 空闲队列 + 下游异步归还"""
+
+    def __init__(self, lib, consumer_s):
+        self.lib = lib
+        self.consumer_s = consumer_s
+        self.buffers = [ctypes.create_string_buffer(FRAME_BUF_SIZE) for _ in range(FRAME_BUF_COUNT)]
+        self.free = queue.Queue()
+        for b in self.buffers:
+            self.free.put(ctypes.addressof(b))
+        self.downstream = queue.Queue()
+        self.frames_ok = 0
+        self.frames_bad = 0
+        self.next_index = 0
+        self.out_of_order = 0
+        self.buffer_waits = 0
+        self.lines = []
+        self.protocol = 0
+
+        self._cbs = Callbacks(FRAME_BEGIN(self._frame_begin), FRAME_END(self._frame_end),
+                              ON_PROTOCOL(self._on_protocol), ON_LINE(self._on_line), None)
+        self.framer = ctypes.create_string_buffer(lib.host_framer_size())
+        lib.usb_stream_framer_init(self.framer, ctypes.byref(self._cbs))
+        self._consumer = threading.Thread(target=self._consume, daemon=True)
+        self._consumer.start()
+
+    def _frame_begin(self, user, info):
+        if info.contents.len > FRAME_BUF_SIZE:
+            return None
+        try:
+            return self.free.get_nowait()
+        except queue.Empty:
+            pass
+        self.buffer_waits += 1
+        try:
+            return self.free.get(timeout=BUF_WAIT_S)
+        except queue.Empty:
+            return None
+
+    def _frame_end(self, user, info, data):
+        payload = ctypes.string_at(data, info.contents.len)
+        if check_payload(payload):
+            self.frames_ok += 1
+            index = struct.unpack('<I', payload[:4])[0]
+            if index < self.next_index:
+                self.out_of_order += 1
+            self.next_index = index + 1
+        else:
+            self.frames_bad += 1
+        self.downstream.put(data)
+
+    def _on_protocol(self, user, frame, length):
+        self.protocol += 1
+
+    def _on_line(self, user, line):
+        self.lines.append(line.decode(errors='replace'))
+
+    def _consume(self):
+        while True:
+            buf = self.downstream.get()
+            if self.consumer_s:
+                time.sleep(self.consumer_s)
+            self.free.put(buf)
+
+    def stats(self):
+        return self.lib.host_framer_stats(self.framer).contents
+
+    def read_from(self, fd):
+        """等同固件接收任务的一次循环: 读入分帧器窗口并提交"""
+        window = ctypes.c_void_p()
+        capacity = self.lib.usb_stream_framer_window(self.framer, ctypes.byref(window))
+        view = (ctypes.c_ubyte * capacity).from_address(window.value)
+        n = os.readv(fd, [view])
+        if n > 0:
+            self.lib.usb_stream_framer_commit(self.framer, n)
+        return n
+
+
+def build_stream(total_bytes, seed):
+    """生成混合流，返回 (消息列表, 图传帧数, 协议帧数, 文本行)"""
+    rng = random.Random(seed)
+    messages, frames, protocols, lines = [], 0, 0, []
+    size = 0
+    while size < total_bytes:
+        r = rng.random()
+        if r < 0.8:
+            length = rng.randint(2000, 200000)
+            msg = stream_frame(FRAME_JPEG, synthetic_payload(frames, length), 320, 240)
+            frames += 1
+        elif r < 0.9:
+            msg = protocol_frame(FRAME_TYPE_HEARTBEAT, bytes(rng.randrange(256) for _ in range(4)))
+            protocols += 1
+        else:
+            line = 'echo line %d' % len(lines)
+            msg = (line + '\r\n').encode()
+            lines.append(line)
+        messages.append(msg)
+        size += len(msg)
+    return messages, frames, protocols, lines
+
+
+def run_pty(args):
+    with tempfile.TemporaryDirectory() as workdir:
+        lib = build_framer_lib(workdir)
+        model = FirmwareModel(lib, args.consumer_ms / 1000.0)
+
+        messages, frames, protocols, lines = build_stream(args.mb * 1024 * 1024, args.seed)
+        total = sum(len(m) for m in messages)
+
+        master, slave = pty.openpty()
+        tty.setraw(slave)
+        tty.setraw(master)
+
+        def writer():
+            rng = random.Random(args.seed + 1)
+            for msg in messages:
+                pos = 0
+                while pos < len(msg):
+                    n = rng.randint(1, args.max_write)
+                    pos += os.write(master, msg[pos:pos + n])
+
+        received = 0
+        start = time.time()
+        t = threading.Thread(target=writer, daemon=True)
+        t.start()
+        while received < total:
+            received += model.read_from(slave)
+        elapsed = time.time() - start
+        t.join()
+        os.close(master)
+        os.close(slave)
+
+        st = model.stats()
+        direct = st.payload_bytes
+        print('pty: %.1f MB in %.2fs = %.1f MB/s' % (total / 1e6, elapsed, total / 1e6 / elapsed))
+        print('  frames ok=%d bad=%d dropped=%d (sent %d) out_of_order=%d buffer_waits=%d'
+              % (model.frames_ok, model.frames_bad, st.dropped_frames, frames, model.out_of_order,
+                 model.buffer_waits))
+        print('  protocol %d/%d lines %d/%d resync=%d' % (model.protocol, protocols, len(model.lines), len(lines),
+                                                          st.resync_bytes))
+        print('  payload direct=%d copied=%d (%.2f%% through scratch)'
+              % (direct, st.copied_bytes, 100.0 * st.copied_bytes / max(1, direct + st.copied_bytes)))
+
+        ok = (model.frames_bad == 0 and model.out_of_order == 0 and st.resync_bytes == 0
+              and model.frames_ok + st.dropped_frames == frames and model.protocol == protocols
+              and model.lines == lines)
+        if args.consumer_ms * FRAME_BUF_COUNT < BUF_WAIT_S * 1000:
+            ok = ok and st.dropped_frames == 0
+        print('PASS' if ok else 'FAIL')
+        return 0 if ok else 1
+
+
+# ---------------------------------------------------------------------------
+# serial 模式: 实机
+# ---------------------------------------------------------------------------
+
+def run_serial(args):
+    import serial  # pyserial
+
+    port = serial.Serial(args.port, baudrate=2000000, timeout=1)
+    port.dtr = True
+    port.rts = True
+    time.sleep(0.2)
+    port.reset_input_buffer()
+
+    if args.send_mb:
+        frame = synthetic_payload(0, 60000)
+        packet = stream_frame(FRAME_JPEG, frame, 320, 240)
+        count = max(1, args.send_mb * 1024 * 1024 // len(packet))
+        start = time.time()
+        for _ in range(count):
+            port.write(packet)
+        port.flush()
+        elapsed = time.time() - start
+        sent = count * len(packet)
+        print('上行: %d 帧 %.1f MB in %.2fs = %.2f MB/s' % (count, sent / 1e6, elapsed, sent / 1e6 / elapsed))
+        port.write(b'usb\r\n')
+        time.sleep(0.5)
+        print(port.read(port.in_waiting or 1).decode(errors='replace'))
+
+    if args.dump_kb:
+        port.write(('usb dump %d\r\n' % args.dump_kb).encode())
+        expected = args.dump_kb * 1024
+        buf = bytearray()
+        got = 0
+        bad = 0
+        start = None
+        deadline = time.time() + 30 + args.dump_kb / 256
+        while got < expected and time.time() < deadline:
+            buf += port.read(max(1, port.in_waiting))
+            # 跳过命令回显等文本，直到帧头
+            while True:
+                pos = buf.find(struct.pack('<I', SYNC_WORD))
+                if pos < 0 or len(buf) - pos < HEADER_SIZE:
+                    break
+                sync, ftype, _, _, length = struct.unpack_from(HEADER_FMT, buf, pos)
+                if len(buf) - pos - HEADER_SIZE < length:
+                    break
+                if start is None:
+                    start = time.time()
+                payload = bytes(buf[pos + HEADER_SIZE:pos + HEADER_SIZE + length])
+                if ftype != FRAME_BULK or payload != bytes(i & 0xFF for i in range(length)):
+                    bad += 1
+                got += length
+                del buf[:pos + HEADER_SIZE + length]
+        elapsed = time.time() - (start or time.time())
+        print('下行: %d/%d 字节 bad=%d %.2f MB/s' % (got, expected, bad, got / 1e6 / max(elapsed, 1e-6)))
+        return 0 if got == expected and bad == 0 else 1
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description='USB CDC 高速流测试')
+    sub = parser.add_subparsers(dest='mode', required=True)
+
+    p = sub.add_parser('pty', help='主机 pty 回环 (固件分帧器)')
+    p.add_argument('--mb', type=int, default=64, help='发送数据量 (MB)')
+    p.add_argument('--consumer-ms', type=float, default=0.0, help='下游每帧处理耗时 (ms)')
+    p.add_argument('--max-write', type=int, default=16384, help='发送端单次写入最大字节')
+    p.add_argument('--seed', type=int, default=1)
+
+    s = sub.add_parser('serial', help='实机 CDC 端口')
+    s.add_argument('--port', required=True)
+    s.add_argument('--send-mb', type=int, default=0, help='上行发送 JPEG 帧数据量 (MB)')
+    s.add_argument('--dump-kb', type=int, default=0, help='下行 usb dump 数据量 (KB)')
+
+    args = parser.parse_args()
+    sys.exit(run_pty(args) if args.mode == 'pty' else run_serial(args))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,355 @@
+#!/usr/bin/env python3
+# -*- coding: utf-8 -*-
+"""
+麦克风上行语音处理链 (main/app/voice_dsp.c) 主机校验与性能基准
+
+将固件 voice_dsp.c 分别按 -O3 (自动向量化) 与 -O2 -fno-tree-vectorize (标量) 编译为共享库，检查:
+  1. 抽取: 通带 1kHz 增益接近 0dB，高于语音奈奎斯特频率的 10kHz 衰减 > 40dB；
+  2. 高通: 直流与 50Hz 工频被滤除，1kHz 通过；
+  3. AGC: -34dBFS 与 -6dBFS 的语音状信号归一到目标电平附近 (相差不超过 4dB) 且不削波；
+  4. 回声消除: 随机衰减回声路径 (含 3ms 纯延迟)，单讲收敛后 ERLE > 20dB，
+     双讲期间不发散，之后的单讲段 ERLE 仍 > 15dB；整条处理链 (44.1kHz 输入) 同样收敛；
+  5. 耗时: 每帧 (约 10ms) 各环节的纳秒数、主机周期数 (x86 上为 TSC 周期) 与实时占比，向量化与标量对比。
+
+用法:
+  python voice_dsp_bench.py
+  python voice_dsp_bench.py --taps 512 --frames 2000
+"""
+
+import argparse
+import array
+import ctypes
+import math
+import os
+import random
+import sys
+import tempfile
+
+import host_harness
+from host_harness import REPO, check
+
+REPO_MAIN = os.path.join(REPO, 'main')
+
+I2S_RATE = 44100
+
+GLUE_C = r'''
+#include "voice_dsp.h"
+#include <stdlib.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+static uint64_t read_cycles(void) { return __rdtsc(); }
+#else
+static uint64_t read_cycles(void) { return 0; }
+#endif
+
+static uint64_t now_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000ull + (uint64_t)t.tv_nsec;
+}
+
+voice_dsp_t* host_dsp_create(uint32_t in_rate, uint16_t taps) {
+    voice_dsp_t* dsp = malloc(sizeof(*dsp));
+    void* storage = taps ? malloc(VOICE_AEC_STORAGE_BYTES(taps)) : NULL;
+    if (!dsp || !voice_dsp_init(dsp, in_rate, taps, storage)) return NULL;
+    return dsp;
+}
+
+uint32_t host_dsp_rate(const voice_dsp_t* dsp) { return dsp->rate; }
+uint32_t host_dsp_frame(const voice_dsp_t* dsp) { return dsp->frame_samples; }
+voice_aec_t* host_dsp_aec(voice_dsp_t* dsp) { return &dsp->aec; }
+voice_agc_t* host_dsp_agc(voice_dsp_t* dsp) { return &dsp->agc; }
+voice_hpf_t* host_dsp_hpf(voice_dsp_t* dsp) { return &dsp->hpf; }
+voice_decimator_t* host_dsp_dec(voice_dsp_t* dsp) { return &dsp->mic_dec; }
+
+// 整段按帧处理 (mic/ref 为 I2S 采样率，out 为语音采样率)
+void host_dsp_run(voice_dsp_t* dsp, const int16_t* mic, const int16_t* ref, size_t frames, int16_t* out) {
+    const size_t in = voice_dsp_input_samples(dsp);
+    for (size_t f = 0; f < frames; f++) {
+        voice_dsp_process(dsp, mic + f * in, ref ? ref + f * in : NULL, out + f * dsp->frame_samples);
+    }
+}
+
+void host_aec_run(voice_aec_t* aec, const int16_t* ref, int16_t* mic, size_t frames, size_t frame) {
+    for (size_t f = 0; f < frames; f++) {
+        voice_aec_process(aec, ref + f * frame, mic + f * frame, frame);
+    }
+}
+
+void host_agc_run(voice_agc_t* agc, int16_t* pcm, size_t frames, size_t frame) {
+    for (size_t f = 0; f < frames; f++) {
+        voice_agc_process(agc, pcm + f * frame, frame);
+    }
+}
+
+// 回声路径: 浮点 FIR 卷积 (仿真用，非固件代码)
+void host_fir(const int16_t* in, size_t n, const float* h, size_t taps, int16_t* out) {
+    for (size_t i = 0; i < n; i++) {
+        float acc = 0;
+        for (size_t k = 0; k < taps && k <= i; k++) acc += h[k] * in[i - k];
+        out[i] = (int16_t)(acc > 32767 ? 32767 : (acc < -32768 ? -32768 : acc));
+    }
+}
+
+// 各环节耗时: stage 0 抽取，1 高通，2 回声消除，3 AGC，4 整条处理链；返回每帧纳秒，cycles 为每帧周期数
+double host_bench(voice_dsp_t* dsp, int stage, const int16_t* mic, const int16_t* ref, size_t frames,
+                  double* cycles) {
+    const size_t in = voice_dsp_input_samples(dsp);
+    const size_t n = dsp->frame_samples;
+    int16_t out[VOICE_DSP_FRAME_MAX];
+    int16_t ref_out[VOICE_DSP_FRAME_MAX];
+    volatile int16_t sink = 0;
+    const uint64_t t0 = now_ns();
+    const uint64_t c0 = read_cycles();
+    for (size_t f = 0; f < frames; f++) {
+        const int16_t* m = mic + f * in;
+        const int16_t* r = ref + f * in;
+        switch (stage) {
+        case 0:
+            voice_decimator_process(&dsp->mic_dec, m, in, out);
+            break;
+        case 1:
+            for (size_t i = 0; i < n; i++) out[i] = m[i];
+            voice_hpf_process(&dsp->hpf, out, n);
+            break;
+        case 2:
+            for (size_t i = 0; i < n; i++) { out[i] = m[i]; ref_out[i] = r[i]; }
+            voice_aec_process(&dsp->aec, ref_out, out, n);
+            break;
+        case 3:
+            for (size_t i = 0; i < n; i++) out[i] = m[i];
+            voice_agc_process(&dsp->agc, out, n);
+            break;
+        default:
+            voice_dsp_process(dsp, m, r, out);
+            break;
+        }
+        sink += out[0];
+    }
+    *cycles = (double)(read_cycles() - c0) / (double)frames;
+    (void)sink;
+    return (double)(now_ns() - t0) / (double)frames;
+}
+'''
+
+
+class Stats(ctypes.Structure):
+    _fields_ = [('rate', ctypes.c_uint32), ('frame_samples', ctypes.c_uint16), ('aec_enabled', ctypes.c_bool),
+                ('erle_db', ctypes.c_float), ('agc_gain_db', ctypes.c_float), ('level_dbfs', ctypes.c_float),
+                ('double_talk_frames', ctypes.c_uint32), ('aec_bg_resets', ctypes.c_uint32)]
+
+
+def build_lib(workdir, flags):
+    name = 'voice_dsp%s' % ''.join(flags).replace('-', '_')
+    lib = host_harness.build_lib(workdir, name, [os.path.join(REPO_MAIN, 'app', 'voice_dsp.c')],
+                                 glue={'glue.c': GLUE_C}, includes=[os.path.join(REPO_MAIN, 'app', 'inc')],
+                                 cflags=flags)
+    vp = ctypes.c_void_p
+    lib.host_dsp_create.restype = vp
+    lib.host_dsp_create.argtypes = [ctypes.c_uint32, ctypes.c_uint16]
+    for name in ('host_dsp_aec', 'host_dsp_agc', 'host_dsp_hpf', 'host_dsp_dec'):
+        getattr(lib, name).restype = vp
+        getattr(lib, name).argtypes = [vp]
+    lib.host_dsp_rate.argtypes = [vp]
+    lib.host_dsp_frame.argtypes = [vp]
+    lib.host_dsp_run.argtypes = [vp, vp, vp, ctypes.c_size_t, vp]
+    lib.host_aec_run.argtypes = [vp, vp, vp, ctypes.c_size_t, ctypes.c_size_t]
+    lib.host_agc_run.argtypes = [vp, vp, ctypes.c_size_t, ctypes.c_size_t]
+    lib.host_fir.argtypes = [vp, ctypes.c_size_t, vp, ctypes.c_size_t, vp]
+    lib.host_bench.restype = ctypes.c_double
+    lib.host_bench.argtypes = [vp, ctypes.c_int, vp, vp, ctypes.c_size_t, ctypes.POINTER(ctypes.c_double)]
+    lib.voice_hpf_process.argtypes = [vp, vp, ctypes.c_size_t]
+    lib.voice_decimator_process.restype = ctypes.c_size_t
+    lib.voice_decimator_process.argtypes = [vp, vp, ctypes.c_size_t, vp]
+    lib.voice_dsp_get_stats.argtypes = [vp, ctypes.POINTER(Stats)]
+    return lib
+
+
+def addr(buf):
+    return buf.buffer_info()[0]
+
+
+def tone(freq, seconds, rate, amp=10000.0, dc=0.0):
+    return array.array('h', (int(dc + amp * math.sin(2 * math.pi * freq * i / rate)) for i in range(int(seconds * rate))))
+
+
+def speech_like(seconds, rate, level_dbfs, rng):
+    """AR(2) 共振峰噪声 + 4Hz 音节包络，按 RMS 归一到 level_dbfs"""
+    n = int(seconds * rate)
+    r, theta = 0.95, 2 * math.pi * 500 / rate
+    a1, a2 = 2 * r * math.cos(theta), -r * r
+    y1 = y2 = 0.0
+    raw = []
+    for i in range(n):
+        env = 0.2 + 0.8 * max(0.0, math.sin(2 * math.pi * 4 * i / rate + rng.random() * 0.01)) ** 2
+        y = rng.gauss(0, 1) + a1 * y1 + a2 * y2
+        y2, y1 = y1, y
+        raw.append(y * env)
+    rms = math.sqrt(sum(v * v for v in raw) / n)
+    scale = 32767 * 10 ** (level_dbfs / 20) / rms
+    return array.array('h', (max(-32768, min(32767, int(v * scale))) for v in raw))
+
+
+def rms_db(buf, start=0, end=None):
+    seg = buf[start:end]
+    if not seg:
+        return -120.0
+    p = sum(v * v for v in seg) / len(seg)
+    return 10 * math.log10(p / 32767.0 ** 2) if p > 0 else -120.0
+
+
+def echo_path(rate, rng, delay_ms=3.0, tail_ms=8.0, gain_db=-10.0):
+    """纯延迟 + 指数衰减随机冲激响应，能量归一到 gain_db"""
+    delay = int(rate * delay_ms / 1000)
+    tail = int(rate * tail_ms / 1000)
+    h = [0.0] * delay + [rng.gauss(0, 1) * math.exp(-4.0 * k / tail) for k in range(tail)]
+    norm = math.sqrt(sum(v * v for v in h))
+    g = 10 ** (gain_db / 20) / norm
+    return array.array('f', (v * g for v in h))
+
+
+def mix(*bufs):
+    return array.array('h', (max(-32768, min(32767, sum(v))) for v in zip(*bufs)))
+
+
+
+def test_decimator(lib):
+    ok = True
+    dsp = lib.host_dsp_create(I2S_RATE, 0)
+    frame = lib.host_dsp_frame(dsp)
+    for freq, lo, hi in ((1000, -0.5, 0.5), (10000, -200, -40)):
+        sig = tone(freq, 1.0, I2S_RATE)
+        dec = lib.host_dsp_dec(dsp)
+        out = array.array('h', bytes(2 * len(sig) // 3))
+        n_in = frame * 3
+        for f in range(len(sig) // n_in):
+            lib.voice_decimator_process(dec, addr(sig) + f * n_in * 2, n_in, addr(out) + f * frame * 2)
+        gain = rms_db(out, 1000, len(out) - 1000) - rms_db(sig)
+        ok &= check('decimator %5d Hz' % freq, lo <= gain <= hi, 'gain %+.1f dB' % gain)
+    return ok
+
+
+def test_hpf(lib):
+    ok = True
+    dsp = lib.host_dsp_create(I2S_RATE, 0)
+    rate = lib.host_dsp_rate(dsp)
+    for freq, dc, lo, hi in ((0, 3000, -200, -40), (50, 0, -200, -12), (1000, 0, -0.5, 0.5)):
+        sig = tone(freq, 2.0, rate, amp=10000 if freq else 0, dc=dc)
+        ref_db = rms_db(sig)
+        lib.voice_hpf_process(lib.host_dsp_hpf(dsp), addr(sig), len(sig))
+        gain = rms_db(sig, len(sig) // 2) - ref_db
+        ok &= check('hpf %5d Hz%s' % (freq, ' (DC)' if dc else ''), lo <= gain <= hi, 'gain %+.1f dB' % gain)
+    return ok
+
+
+def test_agc(lib, rng):
+    """包络跟随有声段，整段 RMS 比目标 (-18dBFS) 低几 dB；要求两种输入电平归一到相近电平"""
+    ok = True
+    levels = []
+    for level in (-34, -6):
+        dsp = lib.host_dsp_create(I2S_RATE, 0)
+        rate = lib.host_dsp_rate(dsp)
+        frame = lib.host_dsp_frame(dsp)
+        sig = speech_like(6.0, rate, level, rng)
+        frames = len(sig) // frame
+        lib.host_agc_run(lib.host_dsp_agc(dsp), addr(sig), frames, frame)
+        out_db = rms_db(sig, len(sig) // 2)
+        peak = max(abs(v) for v in sig[len(sig) // 2:])
+        levels.append(out_db)
+        ok &= check('agc input %+d dBFS' % level, -26 <= out_db <= -14 and peak < 32767,
+                    'output %.1f dBFS peak %d' % (out_db, peak))
+    spread = abs(levels[0] - levels[1])
+    ok &= check('agc 28 dB input range', spread <= 4, 'output spread %.1f dB' % spread)
+    return ok
+
+
+def test_aec(lib, rng, taps):
+    ok = True
+    dsp = lib.host_dsp_create(I2S_RATE, taps)
+    rate = lib.host_dsp_rate(dsp)
+    frame = lib.host_dsp_frame(dsp)
+    aec = lib.host_dsp_aec(dsp)
+
+    # 0~4s 单讲，4~6s 双讲，6~8s 单讲
+    far = speech_like(8.0, rate, -20, rng)
+    h = echo_path(rate, rng)
+    echo = array.array('h', bytes(2 * len(far)))
+    lib.host_fir(addr(far), len(far), addr(h), len(h), addr(echo))
+    noise = array.array('h', (int(rng.gauss(0, 10)) for _ in range(len(far))))
+    near = speech_like(2.0, rate, -26, rng)
+    near_full = array.array('h', [0] * (4 * rate)) + near + array.array('h', [0] * (len(far) - 4 * rate - len(near)))
+    mic = mix(echo, noise, near_full)
+    residual = array.array('h', mic)
+    lib.host_aec_run(aec, addr(far), addr(residual), len(far) // frame, frame)
+
+    def erle(a, b):
+        return rms_db(echo, a, b) - rms_db(array.array('h', (r - n for r, n in zip(residual[a:b], near_full[a:b]))))
+
+    e1 = erle(3 * rate, 4 * rate)
+    e2 = erle(7 * rate, 8 * rate)
+    dt = erle(4 * rate, 6 * rate)
+    st = Stats()
+    lib.voice_dsp_get_stats(dsp, ctypes.byref(st))
+    ok &= check('aec %d taps single-talk' % taps, e1 > 20, 'ERLE %.1f dB (3-4s)' % e1)
+    ok &= check('aec double-talk', dt > 10, 'ERLE %.1f dB during double talk, %d frames frozen, %d resets'
+                % (dt, st.double_talk_frames, st.aec_bg_resets))
+    ok &= check('aec after double-talk', e2 > 15, 'ERLE %.1f dB (7-8s)' % e2)
+
+    # 整条处理链: 44.1kHz 参考经回声路径进入麦克风，AGC 关闭影响后看内部 ERLE 统计
+    dsp = lib.host_dsp_create(I2S_RATE, taps)
+    far = speech_like(5.0, I2S_RATE, -20, rng)
+    h = echo_path(I2S_RATE, rng)
+    echo = array.array('h', bytes(2 * len(far)))
+    lib.host_fir(addr(far), len(far), addr(h), len(h), addr(echo))
+    in_frame = frame * 3
+    frames = len(far) // in_frame
+    out = array.array('h', bytes(2 * frames * frame))
+    lib.host_dsp_run(dsp, addr(echo), addr(far), frames, addr(out))
+    lib.voice_dsp_get_stats(dsp, ctypes.byref(st))
+    ok &= check('chain 44.1kHz -> %d Hz' % st.rate, st.erle_db > 20, 'ERLE %.1f dB, frame %d samples'
+                % (st.erle_db, st.frame_samples))
+    return ok
+
+
+def bench(lib, label, rng, taps, frames):
+    dsp = lib.host_dsp_create(I2S_RATE, taps)
+    frame = lib.host_dsp_frame(dsp)
+    rate = lib.host_dsp_rate(dsp)
+    n_in = frame * 3
+    mic = speech_like(frames * n_in / I2S_RATE + 0.01, I2S_RATE, -20, rng)
+    ref = speech_like(frames * n_in / I2S_RATE + 0.01, I2S_RATE, -20, rng)
+    frame_ns = frame * 1e9 / rate
+    print('benchmark [%s]: %d frames of %d samples @ %d Hz (%.1f ms), aec %d taps'
+          % (label, frames, frame, rate, frame_ns / 1e6, taps))
+    cycles = ctypes.c_double()
+    for stage, name in enumerate(('decimate x3', 'high-pass', 'aec (nlms)', 'agc', 'full chain')):
+        ns = lib.host_bench(dsp, stage, addr(mic), addr(ref), frames, ctypes.byref(cycles))
+        per_sample = cycles.value / frame if cycles.value else 0
+        print('  %-12s %9.0f ns/frame %10.0f cycles/frame %7.1f cycles/sample  %5.2f%% realtime'
+              % (name, ns, cycles.value, per_sample, 100 * ns / frame_ns))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='voice_dsp 主机校验与基准')
+    parser.add_argument('--taps', type=int, default=256, help='回声消除抽头数')
+    parser.add_argument('--frames', type=int, default=1000, help='基准帧数')
+    parser.add_argument('--seed', type=int, default=1)
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    with tempfile.TemporaryDirectory() as workdir:
+        lib = build_lib(workdir, ['-O3'])
+        scalar = build_lib(workdir, ['-O2', '-fno-tree-vectorize'])
+        ok = test_decimator(lib)
+        ok &= test_hpf(lib)
+        ok &= test_agc(lib, rng)
+        ok &= test_aec(lib, rng, args.taps)
+        bench(lib, '-O3 vectorized', rng, args.taps, args.frames)
+        bench(scalar, '-O2 scalar', rng, args.taps, args.frames)
+    print('PASS' if ok else 'FAIL')
+    return 0 if ok else 1
+
+
+if __name__ == '__main__':
+    sys.exit(main())